@@ -17,6 +17,7 @@
 */
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Common/b2Snapshot.h>
 #include <cstring>
 using namespace std;
 
@@ -120,3 +121,40 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 
 	return true;
 }
+
+void b2BroadPhase::SaveState(b2Snapshot* snapshot) const
+{
+	m_tree.SaveState(snapshot);
+
+	snapshot->Write(m_proxyCount);
+	snapshot->Write(m_moveCount);
+	snapshot->Write(m_moveBuffer, m_moveCount * sizeof(int32));
+}
+
+bool b2BroadPhase::RestoreState(b2SnapshotReader* reader)
+{
+	if (m_tree.RestoreState(reader) == false)
+	{
+		return false;
+	}
+
+	int32 moveCount;
+	reader->Read(&m_proxyCount);
+	if (reader->Read(&moveCount) == false || moveCount < 0)
+	{
+		return false;
+	}
+
+	if (moveCount > m_moveCapacity)
+	{
+		b2Free(m_moveBuffer);
+		while (m_moveCapacity < moveCount)
+		{
+			m_moveCapacity *= 2;
+		}
+		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	}
+
+	m_moveCount = moveCount;
+	return reader->Read(m_moveBuffer, m_moveCount * sizeof(int32));
+}
@@ -66,6 +66,9 @@ public:
 	/// Get user data from a proxy. Returns NULL if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
 
+	/// Set user data for a proxy.
+	void SetUserData(int32 proxyId, void* userData);
+
 	/// Test overlap of fat AABBs.
 	bool TestOverlap(int32 proxyIdA, int32 proxyIdB) const;
 
@@ -100,6 +103,14 @@ public:
 	/// Get the quality metric of the embedded tree.
 	float32 GetTreeQuality() const;
 
+	/// Write the tree and the move buffer to a snapshot.
+	void SaveState(b2Snapshot* snapshot) const;
+
+	/// Read back the state written by SaveState. The proxy
+	/// user data has to be set again afterwards.
+	/// @return false if the snapshot is too short.
+	bool RestoreState(b2SnapshotReader* reader);
+
 private:
 
 	friend class b2DynamicTree;
@@ -145,6 +156,11 @@ inline void* b2BroadPhase::GetUserData(int32 proxyId) const
 	return m_tree.GetUserData(proxyId);
 }
 
+inline void b2BroadPhase::SetUserData(int32 proxyId, void* userData)
+{
+	m_tree.SetUserData(proxyId, userData);
+}
+
 inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 {
 	const b2AABB& aabbA = m_tree.GetFatAABB(proxyIdA);
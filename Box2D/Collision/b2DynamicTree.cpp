@@ -17,6 +17,7 @@
 */
 
 #include <Box2D/Collision/b2DynamicTree.h>
+#include <Box2D/Common/b2Snapshot.h>
 #include <cstring>
 #ifndef SHP
 #include <cfloat>
@@ -773,3 +774,101 @@ void b2DynamicTree::RebuildBottomUp()
 
 	Validate();
 }
+
+void b2DynamicTree::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_root);
+	snapshot->Write(m_nodeCount);
+	snapshot->Write(m_nodeCapacity);
+	snapshot->Write(m_freeList);
+	snapshot->Write(m_path);
+	snapshot->Write(m_insertionCount);
+
+	// Free nodes only carry the free list link. Their other fields are stale.
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		const b2TreeNode* node = m_nodes + i;
+		snapshot->Write(node->height);
+		if (node->height == -1)
+		{
+			snapshot->Write(node->next);
+			continue;
+		}
+
+		snapshot->Write(node->aabb);
+		snapshot->Write(node->parent);
+		snapshot->Write(node->child1);
+		snapshot->Write(node->child2);
+	}
+}
+
+bool b2DynamicTree::RestoreState(b2SnapshotReader* reader)
+{
+	// Nothing is changed until the whole tree was read and checked.
+	int32 root, nodeCount, nodeCapacity, freeList, insertionCount;
+	uint32 path;
+	reader->Read(&root);
+	reader->Read(&nodeCount);
+	reader->Read(&nodeCapacity);
+	reader->Read(&freeList);
+	reader->Read(&path);
+	if (reader->Read(&insertionCount) == false || nodeCapacity <= 0 ||
+		nodeCount < 0 || nodeCount > nodeCapacity ||
+		root < b2_nullNode || root >= nodeCapacity ||
+		freeList < b2_nullNode || freeList >= nodeCapacity)
+	{
+		return false;
+	}
+
+	// Free nodes only carry the free list link, the rest is reset.
+	b2TreeNode freeNode;
+	freeNode.aabb.lowerBound.SetZero();
+	freeNode.aabb.upperBound.SetZero();
+	freeNode.userData = NULL;
+	freeNode.next = b2_nullNode;
+	freeNode.child1 = b2_nullNode;
+	freeNode.child2 = b2_nullNode;
+	freeNode.height = -1;
+
+	b2TreeNode* nodes = (b2TreeNode*)b2Alloc(nodeCapacity * sizeof(b2TreeNode));
+	for (int32 i = 0; i < nodeCapacity; ++i)
+	{
+		b2TreeNode* node = nodes + i;
+		*node = freeNode;
+
+		bool valid = reader->Read(&node->height);
+		if (node->height == -1)
+		{
+			valid = reader->Read(&node->next) && node->next >= b2_nullNode && node->next < nodeCapacity;
+		}
+		else
+		{
+			reader->Read(&node->aabb);
+			reader->Read(&node->parent);
+			reader->Read(&node->child1);
+			valid = reader->Read(&node->child2) &&
+				node->parent >= b2_nullNode && node->parent < nodeCapacity &&
+				node->child1 >= b2_nullNode && node->child1 < nodeCapacity &&
+				node->child2 >= b2_nullNode && node->child2 < nodeCapacity;
+		}
+
+		if (valid == false)
+		{
+			b2Free(nodes);
+			return false;
+		}
+	}
+
+	// The pool gets the saved capacity, AllocateNode grows it
+	// when the free list runs out.
+	b2Free(m_nodes);
+	m_nodes = nodes;
+	m_nodeCapacity = nodeCapacity;
+	m_root = root;
+	m_nodeCount = nodeCount;
+	m_freeList = freeList;
+	m_path = path;
+	m_insertionCount = insertionCount;
+
+	return true;
+}
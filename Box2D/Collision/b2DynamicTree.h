@@ -22,6 +22,9 @@
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2GrowableStack.h>
 
+class b2Snapshot;
+class b2SnapshotReader;
+
 #define b2_nullNode (-1)
 
 /// A node in the dynamic tree. The client does not interact with this directly.
@@ -83,6 +86,9 @@ public:
 	/// @return the proxy user data or 0 if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
 
+	/// Set proxy user data.
+	void SetUserData(int32 proxyId, void* userData);
+
 	/// Get the fat AABB for a proxy.
 	const b2AABB& GetFatAABB(int32 proxyId) const;
 
@@ -118,6 +124,15 @@ public:
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
+	/// Write the nodes and the free list to a snapshot. User data is not written.
+	void SaveState(b2Snapshot* snapshot) const;
+
+	/// Read back a tree written by SaveState. The user data of
+	/// every node is NULL afterwards, see SetUserData.
+	/// @return false if the snapshot is too short or inconsistent. The tree
+	/// is left unchanged then.
+	bool RestoreState(b2SnapshotReader* reader);
+
 private:
 
 	int32 AllocateNode();
@@ -154,6 +169,12 @@ inline void* b2DynamicTree::GetUserData(int32 proxyId) const
 	return m_nodes[proxyId].userData;
 }
 
+inline void b2DynamicTree::SetUserData(int32 proxyId, void* userData)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	m_nodes[proxyId].userData = userData;
+}
+
 inline const b2AABB& b2DynamicTree::GetFatAABB(int32 proxyId) const
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -124,6 +124,11 @@ typedef double float64;
 /// A body cannot sleep if its angular velocity is above this tolerance.
 #define b2_angularSleepTolerance	(2.0f / 180.0f * b2_pi)
 
+// Threading
+
+/// The maximum number of threads a world can solve on, see b2World::SetThreadCount.
+#define b2_maxThreads				8
+
 // Memory Allocation
 
 /// Implement this function to use your own memory allocator.
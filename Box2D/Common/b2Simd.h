@@ -0,0 +1,182 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SIMD_H
+#define B2_SIMD_H
+
+#include <Box2D/Common/b2Math.h>
+
+/// Four float lanes for the batched contact solver. SSE2 on x86/x64, NEON on ARM,
+/// otherwise plain arrays so the batched code still runs everywhere.
+/// Comparisons return lane masks that are only meant for b2AndW and b2SelectW.
+/// Define B2_NO_SIMD to force the plain version.
+#define b2_simdLanes	4
+
+#if !defined(B2_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define B2_SIMD_SSE2
+#include <emmintrin.h>
+#elif !defined(B2_NO_SIMD) && (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(_M_ARM) || defined(_M_ARM64))
+#define B2_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(B2_SIMD_SSE2)
+
+typedef __m128 b2FloatW;
+
+inline b2FloatW b2ZeroW() { return _mm_setzero_ps(); }
+inline b2FloatW b2SplatW(float32 a) { return _mm_set1_ps(a); }
+inline b2FloatW b2LoadW(const float32* a) { return _mm_loadu_ps(a); }
+inline void b2StoreW(float32* a, b2FloatW b) { _mm_storeu_ps(a, b); }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return _mm_add_ps(a, b); }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return _mm_sub_ps(a, b); }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return _mm_mul_ps(a, b); }
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b) { return _mm_div_ps(a, b); }
+inline b2FloatW b2SqrtW(b2FloatW a) { return _mm_sqrt_ps(a); }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return _mm_min_ps(a, b); }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return _mm_max_ps(a, b); }
+inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return _mm_cmpge_ps(a, b); }
+inline b2FloatW b2GreaterW(b2FloatW a, b2FloatW b) { return _mm_cmpgt_ps(a, b); }
+inline b2FloatW b2LessW(b2FloatW a, b2FloatW b) { return _mm_cmplt_ps(a, b); }
+inline b2FloatW b2AndW(b2FloatW a, b2FloatW b) { return _mm_and_ps(a, b); }
+
+/// mask ? a : b, per lane.
+inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+#elif defined(B2_SIMD_NEON)
+
+typedef float32x4_t b2FloatW;
+
+inline b2FloatW b2ZeroW() { return vdupq_n_f32(0.0f); }
+inline b2FloatW b2SplatW(float32 a) { return vdupq_n_f32(a); }
+inline b2FloatW b2LoadW(const float32* a) { return vld1q_f32(a); }
+inline void b2StoreW(float32* a, b2FloatW b) { vst1q_f32(a, b); }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return vaddq_f32(a, b); }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return vsubq_f32(a, b); }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return vmulq_f32(a, b); }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return vminq_f32(a, b); }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return vmaxq_f32(a, b); }
+inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+inline b2FloatW b2GreaterW(b2FloatW a, b2FloatW b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+inline b2FloatW b2LessW(b2FloatW a, b2FloatW b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+
+inline b2FloatW b2AndW(b2FloatW a, b2FloatW b)
+{
+	return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+
+/// mask ? a : b, per lane.
+inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b)
+{
+	return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+}
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b) { return vdivq_f32(a, b); }
+inline b2FloatW b2SqrtW(b2FloatW a) { return vsqrtq_f32(a); }
+#else
+// ARMv7 has no vector divide or square root, refine the estimates twice.
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b)
+{
+	b2FloatW r = vrecpeq_f32(b);
+	r = vmulq_f32(r, vrecpsq_f32(b, r));
+	r = vmulq_f32(r, vrecpsq_f32(b, r));
+	return vmulq_f32(a, r);
+}
+
+inline b2FloatW b2SqrtW(b2FloatW a)
+{
+	b2FloatW r = vrsqrteq_f32(a);
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+	// a * (1 / sqrt(a)) is NaN for a == 0.
+	return b2SelectW(b2GreaterW(a, vdupq_n_f32(0.0f)), vmulq_f32(a, r), vdupq_n_f32(0.0f));
+}
+#endif
+
+#else
+
+struct b2FloatW
+{
+	float32 x[b2_simdLanes];
+};
+
+inline b2FloatW b2SplatW(float32 a)
+{
+	b2FloatW r;
+	for (int32 i = 0; i < b2_simdLanes; ++i) r.x[i] = a;
+	return r;
+}
+
+inline b2FloatW b2ZeroW() { return b2SplatW(0.0f); }
+
+inline b2FloatW b2LoadW(const float32* a)
+{
+	b2FloatW r;
+	for (int32 i = 0; i < b2_simdLanes; ++i) r.x[i] = a[i];
+	return r;
+}
+
+inline void b2StoreW(float32* a, b2FloatW b)
+{
+	for (int32 i = 0; i < b2_simdLanes; ++i) a[i] = b.x[i];
+}
+
+#define B2_LANEWISE(name, expression) \
+	inline b2FloatW name(b2FloatW a, b2FloatW b) \
+	{ \
+		b2FloatW r; \
+		for (int32 i = 0; i < b2_simdLanes; ++i) r.x[i] = (expression); \
+		return r; \
+	}
+
+B2_LANEWISE(b2AddW, a.x[i] + b.x[i])
+B2_LANEWISE(b2SubW, a.x[i] - b.x[i])
+B2_LANEWISE(b2MulW, a.x[i] * b.x[i])
+B2_LANEWISE(b2DivW, a.x[i] / b.x[i])
+B2_LANEWISE(b2MinW, b2Min(a.x[i], b.x[i]))
+B2_LANEWISE(b2MaxW, b2Max(a.x[i], b.x[i]))
+// Masks are 1 or 0 here.
+B2_LANEWISE(b2GreaterEqualW, a.x[i] >= b.x[i] ? 1.0f : 0.0f)
+B2_LANEWISE(b2GreaterW, a.x[i] > b.x[i] ? 1.0f : 0.0f)
+B2_LANEWISE(b2LessW, a.x[i] < b.x[i] ? 1.0f : 0.0f)
+B2_LANEWISE(b2AndW, a.x[i] != 0.0f && b.x[i] != 0.0f ? 1.0f : 0.0f)
+
+#undef B2_LANEWISE
+
+inline b2FloatW b2SqrtW(b2FloatW a)
+{
+	b2FloatW r;
+	for (int32 i = 0; i < b2_simdLanes; ++i) r.x[i] = b2Sqrt(a.x[i]);
+	return r;
+}
+
+/// mask ? a : b, per lane.
+inline b2FloatW b2SelectW(b2FloatW mask, b2FloatW a, b2FloatW b)
+{
+	b2FloatW r;
+	for (int32 i = 0; i < b2_simdLanes; ++i) r.x[i] = mask.x[i] != 0.0f ? a.x[i] : b.x[i];
+	return r;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2Snapshot.h>
+#include <Box2D/Common/b2Math.h>
+#include <cstring>
+using namespace std;
+
+b2Snapshot::b2Snapshot()
+{
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+b2Snapshot::~b2Snapshot()
+{
+	if (m_data)
+	{
+		b2Free(m_data);
+	}
+}
+
+void b2Snapshot::Clear()
+{
+	m_size = 0;
+}
+
+void b2Snapshot::Grow(int32 size)
+{
+	int32 capacity = b2Max(2 * m_capacity, 1024);
+	while (capacity < size)
+	{
+		capacity *= 2;
+	}
+
+	char* oldData = m_data;
+	m_data = (char*)b2Alloc(capacity);
+	if (oldData)
+	{
+		memcpy(m_data, oldData, m_size);
+		b2Free(oldData);
+	}
+	m_capacity = capacity;
+}
+
+void b2Snapshot::SetData(const void* data, int32 size)
+{
+	Clear();
+	Write(data, size);
+}
+
+bool b2Snapshot::IsEqual(const b2Snapshot& other) const
+{
+	if (m_size != other.m_size)
+	{
+		return false;
+	}
+
+	return m_size == 0 || memcmp(m_data, other.m_data, m_size) == 0;
+}
+
+b2SnapshotReader::b2SnapshotReader(const b2Snapshot* snapshot)
+{
+	m_data = (const char*)snapshot->GetData();
+	m_size = snapshot->GetSize();
+	m_offset = 0;
+}
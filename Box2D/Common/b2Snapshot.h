@@ -0,0 +1,124 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SNAPSHOT_H
+#define B2_SNAPSHOT_H
+
+#include <Box2D/Common/b2Settings.h>
+#include <cstring>
+
+/// A growable byte buffer holding the simulation state of a world.
+/// See b2World::SaveSnapshot and b2World::RestoreSnapshot. The content
+/// is plain data without pointers, so it can be compared byte-for-byte
+/// or kept on disk. Reuse one snapshot to avoid allocations.
+class b2Snapshot
+{
+public:
+	b2Snapshot();
+	~b2Snapshot();
+
+	/// Empty the buffer. The memory is kept for the next snapshot.
+	void Clear();
+
+	/// Append bytes to the buffer.
+	void Write(const void* data, int32 size);
+
+	/// Append a value.
+	template <typename T>
+	void Write(const T& value)
+	{
+		Write(&value, sizeof(T));
+	}
+
+	/// Replace the content, e.g. with bytes that were read from a file.
+	void SetData(const void* data, int32 size);
+
+	/// Get the content.
+	const void* GetData() const { return m_data; }
+
+	/// Get the content size in bytes.
+	int32 GetSize() const { return m_size; }
+
+	/// Compare the content byte-for-byte.
+	bool IsEqual(const b2Snapshot& other) const;
+
+private:
+
+	b2Snapshot(const b2Snapshot&);
+	b2Snapshot& operator=(const b2Snapshot&);
+
+	void Grow(int32 size);
+
+	char* m_data;
+	int32 m_size;
+	int32 m_capacity;
+};
+
+/// Reads a snapshot back in the order it was written.
+class b2SnapshotReader
+{
+public:
+	b2SnapshotReader(const b2Snapshot* snapshot);
+
+	/// Copy the next bytes to data.
+	/// @return false if the snapshot is too short. The data is zeroed then.
+	bool Read(void* data, int32 size);
+
+	/// Read a value.
+	template <typename T>
+	bool Read(T* value)
+	{
+		return Read(value, sizeof(T));
+	}
+
+	/// Have all bytes been read?
+	bool IsAtEnd() const { return m_offset == m_size; }
+
+private:
+
+	const char* m_data;
+	int32 m_size;
+	int32 m_offset;
+};
+
+inline void b2Snapshot::Write(const void* data, int32 size)
+{
+	if (m_size + size > m_capacity)
+	{
+		Grow(m_size + size);
+	}
+
+	memcpy(m_data + m_size, data, size);
+	m_size += size;
+}
+
+inline bool b2SnapshotReader::Read(void* data, int32 size)
+{
+	if (m_offset + size > m_size)
+	{
+		memset(data, 0, size);
+		m_offset = m_size;
+		return false;
+	}
+
+	memcpy(data, m_data + m_offset, size);
+	m_offset += size;
+	return true;
+}
+
+#endif
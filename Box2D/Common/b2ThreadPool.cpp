@@ -0,0 +1,243 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2Math.h>
+
+static inline uint64_t b2PackRange(int32 begin, int32 end)
+{
+	return (uint64_t(uint32(begin)) << 32) | uint64_t(uint32(end));
+}
+
+static inline void b2UnpackRange(uint64_t value, int32* begin, int32* end)
+{
+	*begin = int32(value >> 32);
+	*end = int32(value & 0xffffffff);
+}
+
+int32 b2ThreadPool::GetHardwareThreadCount()
+{
+	int32 count = int32(std::thread::hardware_concurrency());
+	return count > 0 ? count : 1;
+}
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = GetHardwareThreadCount();
+	}
+	m_threadCount = b2Clamp(threadCount, 1, b2_maxThreads);
+
+	m_task = NULL;
+	m_grainSize = 1;
+	m_generation = 0;
+	m_busyCount = 0;
+	m_quit = false;
+
+	for (int32 i = 0; i < b2_maxThreads; ++i)
+	{
+		m_ranges[i].value = b2PackRange(0, 0);
+		m_threads[i] = NULL;
+	}
+
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		m_threads[i] = new std::thread(&b2ThreadPool::WorkerMain, this, i);
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_start.notify_all();
+
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		m_threads[i]->join();
+		delete m_threads[i];
+	}
+}
+
+void b2ThreadPool::ParallelFor(b2Task* task, int32 count, int32 grainSize)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	grainSize = b2Max(grainSize, 1);
+
+	// Not worth waking anybody.
+	if (m_threadCount == 1 || count <= grainSize)
+	{
+		task->Execute(0, count, 0);
+		return;
+	}
+
+	// Give each thread an equal contiguous share.
+	for (int32 i = 0; i < m_threadCount; ++i)
+	{
+		int32 begin = int32((int64_t(count) * i) / m_threadCount);
+		int32 end = int32((int64_t(count) * (i + 1)) / m_threadCount);
+		m_ranges[i].value.store(b2PackRange(begin, end), std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_grainSize = grainSize;
+		m_busyCount = m_threadCount - 1;
+		++m_generation;
+	}
+	m_start.notify_all();
+
+	Run(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_busyCount > 0)
+	{
+		m_finish.wait(lock);
+	}
+	m_task = NULL;
+}
+
+void b2ThreadPool::WorkerMain(int32 threadIndex)
+{
+	uint32 generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_quit == false && m_generation == generation)
+			{
+				m_start.wait(lock);
+			}
+
+			if (m_quit)
+			{
+				return;
+			}
+
+			generation = m_generation;
+		}
+
+		Run(threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_busyCount;
+		}
+		m_finish.notify_one();
+	}
+}
+
+void b2ThreadPool::Run(int32 threadIndex)
+{
+	int32 begin, end;
+	for (;;)
+	{
+		if (Pop(threadIndex, &begin, &end) == false && Steal(threadIndex, &begin, &end) == false)
+		{
+			return;
+		}
+
+		m_task->Execute(begin, end, threadIndex);
+	}
+}
+
+// Take grainSize items from the front of our own share.
+bool b2ThreadPool::Pop(int32 threadIndex, int32* begin, int32* end)
+{
+	std::atomic<uint64_t>& range = m_ranges[threadIndex].value;
+	uint64_t value = range.load(std::memory_order_acquire);
+	for (;;)
+	{
+		int32 b, e;
+		b2UnpackRange(value, &b, &e);
+		if (b >= e)
+		{
+			return false;
+		}
+
+		int32 n = b2Min(m_grainSize, e - b);
+		if (range.compare_exchange_weak(value, b2PackRange(b + n, e), std::memory_order_acq_rel))
+		{
+			*begin = b;
+			*end = b + n;
+			return true;
+		}
+	}
+}
+
+// Move the back half of the largest share of another thread into ours, then pop from it.
+bool b2ThreadPool::Steal(int32 threadIndex, int32* begin, int32* end)
+{
+	for (;;)
+	{
+		int32 victim = -1;
+		int32 victimSize = 0;
+		for (int32 i = 0; i < m_threadCount; ++i)
+		{
+			if (i == threadIndex)
+			{
+				continue;
+			}
+
+			int32 b, e;
+			b2UnpackRange(m_ranges[i].value.load(std::memory_order_relaxed), &b, &e);
+			if (e - b > victimSize)
+			{
+				victim = i;
+				victimSize = e - b;
+			}
+		}
+
+		if (victim == -1)
+		{
+			return false;
+		}
+
+		std::atomic<uint64_t>& range = m_ranges[victim].value;
+		uint64_t value = range.load(std::memory_order_acquire);
+		int32 b, e;
+		b2UnpackRange(value, &b, &e);
+		if (b >= e)
+		{
+			continue;
+		}
+
+		int32 n = (e - b + 1) / 2;
+		if (range.compare_exchange_strong(value, b2PackRange(b, e - n), std::memory_order_acq_rel) == false)
+		{
+			continue;
+		}
+
+		// Only this thread pops its own share while it is empty, other thieves may
+		// take from it as soon as it is published.
+		m_ranges[threadIndex].value.store(b2PackRange(e - n, e), std::memory_order_release);
+		if (Pop(threadIndex, begin, end))
+		{
+			return true;
+		}
+	}
+}
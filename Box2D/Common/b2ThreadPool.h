@@ -0,0 +1,94 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2Settings.h>
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/// Work given to b2ThreadPool::ParallelFor.
+class b2Task
+{
+public:
+	virtual ~b2Task() {}
+
+	/// Process the items [begin, end). This is called concurrently from several threads.
+	/// @param threadIndex 0 for the thread calling ParallelFor, 1 to GetThreadCount() - 1
+	/// for the workers. Use it to index per thread data.
+	virtual void Execute(int32 begin, int32 end, int32 threadIndex) = 0;
+};
+
+/// A fixed set of worker threads for the data parallel parts of a step.
+/// Each thread starts on its own contiguous share of the items, taking grainSize
+/// items at a time from the front. A thread that runs out steals the back half of
+/// the largest remaining share, so uneven items (islands of different sizes) are balanced
+/// while neighboring items mostly stay on the same thread.
+class b2ThreadPool
+{
+public:
+	/// @param threadCount the total number of threads including the calling thread,
+	/// clamped to [1, b2_maxThreads]. 0 uses the number of hardware threads.
+	b2ThreadPool(int32 threadCount);
+	~b2ThreadPool();
+
+	int32 GetThreadCount() const { return m_threadCount; }
+
+	/// Run task on the items [0, count) and return when all are done.
+	/// The calling thread takes part. Not reentrant.
+	void ParallelFor(b2Task* task, int32 count, int32 grainSize);
+
+	/// The number of threads the hardware runs concurrently, at least 1.
+	static int32 GetHardwareThreadCount();
+
+private:
+
+	// [begin, end) packed in 64 bits so owners and thieves update it with one CAS.
+	struct b2Range
+	{
+		std::atomic<uint64_t> value;
+		char padding[64 - sizeof(std::atomic<uint64_t>)];
+	};
+
+	void WorkerMain(int32 threadIndex);
+	void Run(int32 threadIndex);
+	bool Pop(int32 threadIndex, int32* begin, int32* end);
+	bool Steal(int32 threadIndex, int32* begin, int32* end);
+
+	std::thread* m_threads[b2_maxThreads];
+	int32 m_threadCount;
+
+	b2Range m_ranges[b2_maxThreads];
+
+	std::mutex m_mutex;
+	std::condition_variable m_start;
+	std::condition_variable m_finish;
+
+	b2Task* m_task;
+	int32 m_grainSize;
+	uint32 m_generation;
+	int32 m_busyCount;
+	bool m_quit;
+};
+
+#endif
@@ -154,12 +154,20 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 void b2Contact::Update(b2ContactListener* listener)
 {
 	b2Manifold oldManifold = m_manifold;
+	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+
+	UpdateManifold(oldManifold);
+	ReportUpdate(listener, oldManifold, wasTouching);
+}
 
+// The part of Update that only touches this contact, so contacts can be
+// updated on several threads.
+void b2Contact::UpdateManifold(const b2Manifold& oldManifold)
+{
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
 
 	bool touching = false;
-	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
 
 	bool sensorA = m_fixtureA->IsSensor();
 	bool sensorB = m_fixtureB->IsSensor();
@@ -196,7 +204,7 @@ void b2Contact::Update(b2ContactListener* listener)
 
 			for (int32 j = 0; j < oldManifold.pointCount; ++j)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
+				const b2ManifoldPoint* mp1 = oldManifold.points + j;
 
 				if (mp1->id.key == id2.key)
 				{
@@ -206,12 +214,6 @@ void b2Contact::Update(b2ContactListener* listener)
 				}
 			}
 		}
-
-		if (touching != wasTouching)
-		{
-			bodyA->SetAwake(true);
-			bodyB->SetAwake(true);
-		}
 	}
 
 	if (touching)
@@ -222,6 +224,19 @@ void b2Contact::Update(b2ContactListener* listener)
 	{
 		m_flags &= ~e_touchingFlag;
 	}
+}
+
+// The part of Update that wakes the bodies and calls the listener.
+void b2Contact::ReportUpdate(b2ContactListener* listener, const b2Manifold& oldManifold, bool wasTouching)
+{
+	bool touching = (m_flags & e_touchingFlag) == e_touchingFlag;
+	bool sensor = m_fixtureA->IsSensor() || m_fixtureB->IsSensor();
+
+	if (sensor == false && touching != wasTouching)
+	{
+		m_fixtureA->GetBody()->SetAwake(true);
+		m_fixtureB->GetBody()->SetAwake(true);
+	}
 
 	if (wasTouching == false && touching == true && listener)
 	{
@@ -140,6 +140,7 @@ public:
 
 protected:
 	friend class b2ContactManager;
+	friend class b2ContactUpdateTask;
 	friend class b2World;
 	friend class b2ContactSolver;
 	friend class b2Body;
@@ -182,6 +183,8 @@ protected:
 	virtual ~b2Contact() {}
 
 	void Update(b2ContactListener* listener);
+	void UpdateManifold(const b2Manifold& oldManifold);
+	void ReportUpdate(b2ContactListener* listener, const b2Manifold& oldManifold, bool wasTouching);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
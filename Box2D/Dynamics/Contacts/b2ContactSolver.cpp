@@ -23,6 +23,9 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2Simd.h>
+
+#include <cstring>
 
 #define B2_DEBUG_SOLVER 0
 
@@ -41,6 +44,48 @@ struct b2ContactPositionConstraint
 	int32 pointCount;
 };
 
+// b2_simdLanes velocity constraints that touch different bodies, one lane each.
+// A constraint with one point has zero masses and impulses for the second point.
+struct b2WideVelocityConstraint
+{
+	float32 normalX[b2_simdLanes], normalY[b2_simdLanes];
+	float32 friction[b2_simdLanes];
+	float32 invMassA[b2_simdLanes], invMassB[b2_simdLanes];
+	float32 invIA[b2_simdLanes], invIB[b2_simdLanes];
+	float32 rAX[2][b2_simdLanes], rAY[2][b2_simdLanes];
+	float32 rBX[2][b2_simdLanes], rBY[2][b2_simdLanes];
+	float32 normalImpulse[2][b2_simdLanes];
+	float32 tangentImpulse[2][b2_simdLanes];
+	float32 normalMass[2][b2_simdLanes];
+	float32 tangentMass[2][b2_simdLanes];
+	float32 velocityBias[2][b2_simdLanes];
+	float32 K11[b2_simdLanes], K12[b2_simdLanes], K22[b2_simdLanes];
+	float32 M11[b2_simdLanes], M12[b2_simdLanes], M21[b2_simdLanes], M22[b2_simdLanes];
+	float32 twoPoints[b2_simdLanes];	// 1 for the block solver, 0 for one point
+	int32 indexA[b2_simdLanes];
+	int32 indexB[b2_simdLanes];
+	int32 constraintIndex[b2_simdLanes];
+	int32 laneCount;
+};
+
+struct b2WidePositionConstraint
+{
+	float32 localPointsX[2][b2_simdLanes], localPointsY[2][b2_simdLanes];
+	float32 localNormalX[b2_simdLanes], localNormalY[b2_simdLanes];
+	float32 localPointX[b2_simdLanes], localPointY[b2_simdLanes];
+	float32 localCenterAX[b2_simdLanes], localCenterAY[b2_simdLanes];
+	float32 localCenterBX[b2_simdLanes], localCenterBY[b2_simdLanes];
+	float32 invMassA[b2_simdLanes], invMassB[b2_simdLanes];
+	float32 invIA[b2_simdLanes], invIB[b2_simdLanes];
+	float32 radiusA[b2_simdLanes], radiusB[b2_simdLanes];
+	float32 circles[b2_simdLanes];	// 1 for b2Manifold::e_circles
+	float32 faceB[b2_simdLanes];	// 1 for b2Manifold::e_faceB
+	float32 twoPoints[b2_simdLanes];
+	int32 indexA[b2_simdLanes];
+	int32 indexB[b2_simdLanes];
+	int32 laneCount;
+};
+
 b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 {
 	m_step = def->step;
@@ -51,6 +96,11 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_wideVelocityConstraints = NULL;
+	m_widePositionConstraints = NULL;
+	m_wideCount = 0;
+	m_wideOrder = NULL;
+	m_overflowCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -129,6 +179,12 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_wideOrder)
+	{
+		m_allocator->Free(m_widePositionConstraints);
+		m_allocator->Free(m_wideVelocityConstraints);
+		m_allocator->Free(m_wideOrder);
+	}
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -243,360 +299,398 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			}
 		}
 	}
+
+	if (m_step.simdContacts && m_count >= b2_simdLanes)
+	{
+		InitializeWideConstraints();
+	}
 }
 
-void b2ContactSolver::WarmStart()
+static void b2WarmStartContact(b2ContactVelocityConstraint* vc, b2Velocity* velocities)
 {
-	// Warm start.
-	for (int32 i = 0; i < m_count; ++i)
+	int32 indexA = vc->indexA;
+	int32 indexB = vc->indexB;
+	float32 mA = vc->invMassA;
+	float32 iA = vc->invIA;
+	float32 mB = vc->invMassB;
+	float32 iB = vc->invIB;
+	int32 pointCount = vc->pointCount;
+
+	b2Vec2 vA = velocities[indexA].v;
+	float32 wA = velocities[indexA].w;
+	b2Vec2 vB = velocities[indexB].v;
+	float32 wB = velocities[indexB].w;
+
+	b2Vec2 normal = vc->normal;
+	b2Vec2 tangent = b2Cross(normal, 1.0f);
+
+	for (int32 j = 0; j < pointCount; ++j)
 	{
-		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
-
-		int32 indexA = vc->indexA;
-		int32 indexB = vc->indexB;
-		float32 mA = vc->invMassA;
-		float32 iA = vc->invIA;
-		float32 mB = vc->invMassB;
-		float32 iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
-
-		b2Vec2 vA = m_velocities[indexA].v;
-		float32 wA = m_velocities[indexA].w;
-		b2Vec2 vB = m_velocities[indexB].v;
-		float32 wB = m_velocities[indexB].w;
+		b2VelocityConstraintPoint* vcp = vc->points + j;
+		b2Vec2 P = vcp->normalImpulse * normal + vcp->tangentImpulse * tangent;
+		wA -= iA * b2Cross(vcp->rA, P);
+		vA -= mA * P;
+		wB += iB * b2Cross(vcp->rB, P);
+		vB += mB * P;
+	}
 
-		b2Vec2 normal = vc->normal;
-		b2Vec2 tangent = b2Cross(normal, 1.0f);
+	velocities[indexA].v = vA;
+	velocities[indexA].w = wA;
+	velocities[indexB].v = vB;
+	velocities[indexB].w = wB;
+}
 
-		for (int32 j = 0; j < pointCount; ++j)
-		{
-			b2VelocityConstraintPoint* vcp = vc->points + j;
-			b2Vec2 P = vcp->normalImpulse * normal + vcp->tangentImpulse * tangent;
-			wA -= iA * b2Cross(vcp->rA, P);
-			vA -= mA * P;
-			wB += iB * b2Cross(vcp->rB, P);
-			vB += mB * P;
-		}
+void b2ContactSolver::WarmStart()
+{
+	if (m_wideVelocityConstraints)
+	{
+		WarmStartWide();
+		return;
+	}
 
-		m_velocities[indexA].v = vA;
-		m_velocities[indexA].w = wA;
-		m_velocities[indexB].v = vB;
-		m_velocities[indexB].w = wB;
+	// Warm start.
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2WarmStartContact(m_velocityConstraints + i, m_velocities);
 	}
 }
 
-void b2ContactSolver::SolveVelocityConstraints()
+static void b2SolveVelocityContact(b2ContactVelocityConstraint* vc, b2Velocity* velocities)
 {
-	for (int32 i = 0; i < m_count; ++i)
+	int32 indexA = vc->indexA;
+	int32 indexB = vc->indexB;
+	float32 mA = vc->invMassA;
+	float32 iA = vc->invIA;
+	float32 mB = vc->invMassB;
+	float32 iB = vc->invIB;
+	int32 pointCount = vc->pointCount;
+
+	b2Vec2 vA = velocities[indexA].v;
+	float32 wA = velocities[indexA].w;
+	b2Vec2 vB = velocities[indexB].v;
+	float32 wB = velocities[indexB].w;
+
+	b2Vec2 normal = vc->normal;
+	b2Vec2 tangent = b2Cross(normal, 1.0f);
+	float32 friction = vc->friction;
+
+	b2Assert(pointCount == 1 || pointCount == 2);
+
+	// Solve tangent constraints first because non-penetration is more important
+	// than friction.
+	for (int32 j = 0; j < pointCount; ++j)
 	{
-		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
-
-		int32 indexA = vc->indexA;
-		int32 indexB = vc->indexB;
-		float32 mA = vc->invMassA;
-		float32 iA = vc->invIA;
-		float32 mB = vc->invMassB;
-		float32 iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
-
-		b2Vec2 vA = m_velocities[indexA].v;
-		float32 wA = m_velocities[indexA].w;
-		b2Vec2 vB = m_velocities[indexB].v;
-		float32 wB = m_velocities[indexB].w;
-
-		b2Vec2 normal = vc->normal;
-		b2Vec2 tangent = b2Cross(normal, 1.0f);
-		float32 friction = vc->friction;
-
-		b2Assert(pointCount == 1 || pointCount == 2);
+		b2VelocityConstraintPoint* vcp = vc->points + j;
 
-		// Solve tangent constraints first because non-penetration is more important
-		// than friction.
-		for (int32 j = 0; j < pointCount; ++j)
-		{
-			b2VelocityConstraintPoint* vcp = vc->points + j;
-
-			// Relative velocity at contact
-			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+		// Relative velocity at contact
+		b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-			// Compute tangent force
-			float32 vt = b2Dot(dv, tangent);
-			float32 lambda = vcp->tangentMass * (-vt);
+		// Compute tangent force
+		float32 vt = b2Dot(dv, tangent);
+		float32 lambda = vcp->tangentMass * (-vt);
 
-			// b2Clamp the accumulated force
-			float32 maxFriction = friction * vcp->normalImpulse;
-			float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
-			lambda = newImpulse - vcp->tangentImpulse;
-			vcp->tangentImpulse = newImpulse;
+		// b2Clamp the accumulated force
+		float32 maxFriction = friction * vcp->normalImpulse;
+		float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+		lambda = newImpulse - vcp->tangentImpulse;
+		vcp->tangentImpulse = newImpulse;
 
-			// Apply contact impulse
-			b2Vec2 P = lambda * tangent;
+		// Apply contact impulse
+		b2Vec2 P = lambda * tangent;
 
-			vA -= mA * P;
-			wA -= iA * b2Cross(vcp->rA, P);
+		vA -= mA * P;
+		wA -= iA * b2Cross(vcp->rA, P);
 
-			vB += mB * P;
-			wB += iB * b2Cross(vcp->rB, P);
-		}
+		vB += mB * P;
+		wB += iB * b2Cross(vcp->rB, P);
+	}
 
-		// Solve normal constraints
-		if (vc->pointCount == 1)
-		{
-			b2VelocityConstraintPoint* vcp = vc->points + 0;
+	// Solve normal constraints
+	if (vc->pointCount == 1)
+	{
+		b2VelocityConstraintPoint* vcp = vc->points + 0;
 
-			// Relative velocity at contact
-			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+		// Relative velocity at contact
+		b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-			// Compute normal impulse
-			float32 vn = b2Dot(dv, normal);
-			float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
+		// Compute normal impulse
+		float32 vn = b2Dot(dv, normal);
+		float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
 
-			// b2Clamp the accumulated impulse
-			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
-			lambda = newImpulse - vcp->normalImpulse;
-			vcp->normalImpulse = newImpulse;
+		// b2Clamp the accumulated impulse
+		float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+		lambda = newImpulse - vcp->normalImpulse;
+		vcp->normalImpulse = newImpulse;
 
-			// Apply contact impulse
-			b2Vec2 P = lambda * normal;
-			vA -= mA * P;
-			wA -= iA * b2Cross(vcp->rA, P);
+		// Apply contact impulse
+		b2Vec2 P = lambda * normal;
+		vA -= mA * P;
+		wA -= iA * b2Cross(vcp->rA, P);
 
-			vB += mB * P;
-			wB += iB * b2Cross(vcp->rB, P);
-		}
-		else
+		vB += mB * P;
+		wB += iB * b2Cross(vcp->rB, P);
+	}
+	else
+	{
+		// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
+		// Build the mini LCP for this contact patch
+		//
+		// vn = A * x + b, vn >= 0, , vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+		//
+		// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
+		// b = vn0 - velocityBias
+		//
+		// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
+		// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
+		// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
+		// solution that satisfies the problem is chosen.
+		// 
+		// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
+		// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
+		//
+		// Substitute:
+		// 
+		// x = a + d
+		// 
+		// a := old total impulse
+		// x := new total impulse
+		// d := incremental impulse 
+		//
+		// For the current iteration we extend the formula for the incremental impulse
+		// to compute the new total impulse:
+		//
+		// vn = A * d + b
+		//    = A * (x - a) + b
+		//    = A * x + b - A * a
+		//    = A * x + b'
+		// b' = b - A * a;
+
+		b2VelocityConstraintPoint* cp1 = vc->points + 0;
+		b2VelocityConstraintPoint* cp2 = vc->points + 1;
+
+		b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
+		b2Assert(a.x >= 0.0f && a.y >= 0.0f);
+
+		// Relative velocity at contact
+		b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+		b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+
+		// Compute normal velocity
+		float32 vn1 = b2Dot(dv1, normal);
+		float32 vn2 = b2Dot(dv2, normal);
+
+		b2Vec2 b;
+		b.x = vn1 - cp1->velocityBias;
+		b.y = vn2 - cp2->velocityBias;
+
+		// Compute b'
+		b -= b2Mul(vc->K, a);
+
+		const float32 k_errorTol = 1e-3f;
+		B2_NOT_USED(k_errorTol);
+
+		for (;;)
 		{
-			// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
-			// Build the mini LCP for this contact patch
-			//
-			// vn = A * x + b, vn >= 0, , vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
 			//
-			// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
-			// b = vn0 - velocityBias
+			// Case 1: vn = 0
 			//
-			// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
-			// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
-			// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
-			// solution that satisfies the problem is chosen.
-			// 
-			// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
-			// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
+			// 0 = A * x + b'
 			//
-			// Substitute:
-			// 
-			// x = a + d
-			// 
-			// a := old total impulse
-			// x := new total impulse
-			// d := incremental impulse 
+			// Solve for x:
 			//
-			// For the current iteration we extend the formula for the incremental impulse
-			// to compute the new total impulse:
+			// x = - inv(A) * b'
 			//
-			// vn = A * d + b
-			//    = A * (x - a) + b
-			//    = A * x + b - A * a
-			//    = A * x + b'
-			// b' = b - A * a;
-
-			b2VelocityConstraintPoint* cp1 = vc->points + 0;
-			b2VelocityConstraintPoint* cp2 = vc->points + 1;
-
-			b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
-			b2Assert(a.x >= 0.0f && a.y >= 0.0f);
-
-			// Relative velocity at contact
-			b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-			b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
-
-			// Compute normal velocity
-			float32 vn1 = b2Dot(dv1, normal);
-			float32 vn2 = b2Dot(dv2, normal);
-
-			b2Vec2 b;
-			b.x = vn1 - cp1->velocityBias;
-			b.y = vn2 - cp2->velocityBias;
-
-			// Compute b'
-			b -= b2Mul(vc->K, a);
+			b2Vec2 x = - b2Mul(vc->normalMass, b);
 
-			const float32 k_errorTol = 1e-3f;
-			B2_NOT_USED(k_errorTol);
-
-			for (;;)
+			if (x.x >= 0.0f && x.y >= 0.0f)
 			{
-				//
-				// Case 1: vn = 0
-				//
-				// 0 = A * x + b'
-				//
-				// Solve for x:
-				//
-				// x = - inv(A) * b'
-				//
-				b2Vec2 x = - b2Mul(vc->normalMass, b);
-
-				if (x.x >= 0.0f && x.y >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
-					vn2 = b2Dot(dv2, normal);
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
+				vn2 = b2Dot(dv2, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
-				//
-				// Case 2: vn1 = 0 and x2 = 0
-				//
-				//   0 = a11 * x1 + a12 * 0 + b1' 
-				// vn2 = a21 * x1 + a22 * 0 + b2'
-				//
-				x.x = - cp1->normalMass * b.x;
-				x.y = 0.0f;
-				vn1 = 0.0f;
-				vn2 = vc->K.ex.y * x.x + b.y;
-
-				if (x.x >= 0.0f && vn2 >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
+			//
+			// Case 2: vn1 = 0 and x2 = 0
+			//
+			//   0 = a11 * x1 + a12 * 0 + b1' 
+			// vn2 = a21 * x1 + a22 * 0 + b2'
+			//
+			x.x = - cp1->normalMass * b.x;
+			x.y = 0.0f;
+			vn1 = 0.0f;
+			vn2 = vc->K.ex.y * x.x + b.y;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+			if (x.x >= 0.0f && vn2 >= 0.0f)
+			{
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
+
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
 
-				//
-				// Case 3: vn2 = 0 and x1 = 0
-				//
-				// vn1 = a11 * 0 + a12 * x2 + b1' 
-				//   0 = a21 * 0 + a22 * x2 + b2'
-				//
-				x.x = 0.0f;
-				x.y = - cp2->normalMass * b.y;
-				vn1 = vc->K.ey.x * x.y + b.x;
-				vn2 = 0.0f;
+			//
+			// Case 3: vn2 = 0 and x1 = 0
+			//
+			// vn1 = a11 * 0 + a12 * x2 + b1' 
+			//   0 = a21 * 0 + a22 * x2 + b2'
+			//
+			x.x = 0.0f;
+			x.y = - cp2->normalMass * b.y;
+			vn1 = vc->K.ey.x * x.y + b.x;
+			vn2 = 0.0f;
 
-				if (x.y >= 0.0f && vn1 >= 0.0f)
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+			if (x.y >= 0.0f && vn1 >= 0.0f)
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				// Postconditions
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
 
-					// Compute normal velocity
-					vn2 = b2Dot(dv2, normal);
+				// Compute normal velocity
+				vn2 = b2Dot(dv2, normal);
 
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
-
-				//
-				// Case 4: x1 = 0 and x2 = 0
-				// 
-				// vn1 = b1
-				// vn2 = b2;
-				x.x = 0.0f;
-				x.y = 0.0f;
-				vn1 = b.x;
-				vn2 = b.y;
-
-				if (vn1 >= 0.0f && vn2 >= 0.0f )
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+				break;
+			}
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+			//
+			// Case 4: x1 = 0 and x2 = 0
+			// 
+			// vn1 = b1
+			// vn2 = b2;
+			x.x = 0.0f;
+			x.y = 0.0f;
+			vn1 = b.x;
+			vn2 = b.y;
+
+			if (vn1 >= 0.0f && vn2 >= 0.0f )
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					break;
-				}
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
-				// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
 				break;
 			}
+
+			// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
+			break;
 		}
+	}
+
+	velocities[indexA].v = vA;
+	velocities[indexA].w = wA;
+	velocities[indexB].v = vB;
+	velocities[indexB].w = wB;
+}
+
+void b2ContactSolver::SolveVelocityConstraints()
+{
+	if (m_wideVelocityConstraints)
+	{
+		SolveVelocityConstraintsWide();
+		return;
+	}
 
-		m_velocities[indexA].v = vA;
-		m_velocities[indexA].w = wA;
-		m_velocities[indexB].v = vB;
-		m_velocities[indexB].w = wB;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2SolveVelocityContact(m_velocityConstraints + i, m_velocities);
 	}
 }
 
 void b2ContactSolver::StoreImpulses()
 {
+	// The batches hold the latest impulses.
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		const b2WideVelocityConstraint* wc = m_wideVelocityConstraints + i;
+		for (int32 lane = 0; lane < wc->laneCount; ++lane)
+		{
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + wc->constraintIndex[lane];
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				vc->points[j].normalImpulse = wc->normalImpulse[j][lane];
+				vc->points[j].tangentImpulse = wc->tangentImpulse[j][lane];
+			}
+		}
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -661,78 +755,90 @@ struct b2PositionSolverManifold
 	float32 separation;
 };
 
-// Sequential solver.
-bool b2ContactSolver::SolvePositionConstraints()
+static float32 b2SolvePositionContact(b2ContactPositionConstraint* pc, b2Position* positions)
 {
 	float32 minSeparation = 0.0f;
 
-	for (int32 i = 0; i < m_count; ++i)
+	int32 indexA = pc->indexA;
+	int32 indexB = pc->indexB;
+	b2Vec2 localCenterA = pc->localCenterA;
+	float32 mA = pc->invMassA;
+	float32 iA = pc->invIA;
+	b2Vec2 localCenterB = pc->localCenterB;
+	float32 mB = pc->invMassB;
+	float32 iB = pc->invIB;
+	int32 pointCount = pc->pointCount;
+
+	b2Vec2 cA = positions[indexA].c;
+	float32 aA = positions[indexA].a;
+
+	b2Vec2 cB = positions[indexB].c;
+	float32 aB = positions[indexB].a;
+
+	// Solve normal constraints
+	for (int32 j = 0; j < pointCount; ++j)
 	{
-		b2ContactPositionConstraint* pc = m_positionConstraints + i;
+		b2Transform xfA, xfB;
+		xfA.q.Set(aA);
+		xfB.q.Set(aB);
+		xfA.p = cA - b2Mul(xfA.q, localCenterA);
+		xfB.p = cB - b2Mul(xfB.q, localCenterB);
 
-		int32 indexA = pc->indexA;
-		int32 indexB = pc->indexB;
-		b2Vec2 localCenterA = pc->localCenterA;
-		float32 mA = pc->invMassA;
-		float32 iA = pc->invIA;
-		b2Vec2 localCenterB = pc->localCenterB;
-		float32 mB = pc->invMassB;
-		float32 iB = pc->invIB;
-		int32 pointCount = pc->pointCount;
+		b2PositionSolverManifold psm;
+		psm.Initialize(pc, xfA, xfB, j);
+		b2Vec2 normal = psm.normal;
 
-		b2Vec2 cA = m_positions[indexA].c;
-		float32 aA = m_positions[indexA].a;
+		b2Vec2 point = psm.point;
+		float32 separation = psm.separation;
 
-		b2Vec2 cB = m_positions[indexB].c;
-		float32 aB = m_positions[indexB].a;
+		b2Vec2 rA = point - cA;
+		b2Vec2 rB = point - cB;
 
-		// Solve normal constraints
-		for (int32 j = 0; j < pointCount; ++j)
-		{
-			b2Transform xfA, xfB;
-			xfA.q.Set(aA);
-			xfB.q.Set(aB);
-			xfA.p = cA - b2Mul(xfA.q, localCenterA);
-			xfB.p = cB - b2Mul(xfB.q, localCenterB);
+		// Track max constraint error.
+		minSeparation = b2Min(minSeparation, separation);
 
-			b2PositionSolverManifold psm;
-			psm.Initialize(pc, xfA, xfB, j);
-			b2Vec2 normal = psm.normal;
+		// Prevent large corrections and allow slop.
+		float32 C = b2Clamp(b2_baumgarte * (separation + b2_linearSlop), -b2_maxLinearCorrection, 0.0f);
 
-			b2Vec2 point = psm.point;
-			float32 separation = psm.separation;
+		// Compute the effective mass.
+		float32 rnA = b2Cross(rA, normal);
+		float32 rnB = b2Cross(rB, normal);
+		float32 K = mA + mB + iA * rnA * rnA + iB * rnB * rnB;
 
-			b2Vec2 rA = point - cA;
-			b2Vec2 rB = point - cB;
+		// Compute normal impulse
+		float32 impulse = K > 0.0f ? - C / K : 0.0f;
 
-			// Track max constraint error.
-			minSeparation = b2Min(minSeparation, separation);
+		b2Vec2 P = impulse * normal;
 
-			// Prevent large corrections and allow slop.
-			float32 C = b2Clamp(b2_baumgarte * (separation + b2_linearSlop), -b2_maxLinearCorrection, 0.0f);
+		cA -= mA * P;
+		aA -= iA * b2Cross(rA, P);
 
-			// Compute the effective mass.
-			float32 rnA = b2Cross(rA, normal);
-			float32 rnB = b2Cross(rB, normal);
-			float32 K = mA + mB + iA * rnA * rnA + iB * rnB * rnB;
+		cB += mB * P;
+		aB += iB * b2Cross(rB, P);
+	}
 
-			// Compute normal impulse
-			float32 impulse = K > 0.0f ? - C / K : 0.0f;
+	positions[indexA].c = cA;
+	positions[indexA].a = aA;
 
-			b2Vec2 P = impulse * normal;
+	positions[indexB].c = cB;
+	positions[indexB].a = aB;
 
-			cA -= mA * P;
-			aA -= iA * b2Cross(rA, P);
+	return minSeparation;
+}
 
-			cB += mB * P;
-			aB += iB * b2Cross(rB, P);
-		}
+// Sequential solver.
+bool b2ContactSolver::SolvePositionConstraints()
+{
+	if (m_widePositionConstraints)
+	{
+		return SolvePositionConstraintsWide();
+	}
 
-		m_positions[indexA].c = cA;
-		m_positions[indexA].a = aA;
+	float32 minSeparation = 0.0f;
 
-		m_positions[indexB].c = cB;
-		m_positions[indexB].a = aB;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		minSeparation = b2Min(minSeparation, b2SolvePositionContact(m_positionConstraints + i, m_positions));
 	}
 
 	// We can't expect minSpeparation >= -b2_linearSlop because we don't
@@ -830,3 +936,654 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 	// push the separation above -b2_linearSlop.
 	return minSeparation >= -1.5f * b2_linearSlop;
 }
+
+// Batched solver. The constraints are graph colored so that a color never has two constraints
+// on the same dynamic body, then each color is cut into batches of b2_simdLanes and every batch
+// is solved with the lanes side by side. Static and kinematic bodies can be in several lanes,
+// the solver never changes their velocity or position. The arithmetic is the same as the
+// sequential solver above, only the order of the constraints differs.
+
+// Bodies keep a 32 bit mask of the colors they are in.
+static const int32 b2_maxContactColors = 32;
+
+static inline bool b2IsFixedBody(float32 invMass, float32 invI)
+{
+	return invMass == 0.0f && invI == 0.0f;
+}
+
+void b2ContactSolver::InitializeWideConstraints()
+{
+	int32 slotCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		slotCount = b2Max(slotCount, b2Max(vc->indexA, vc->indexB) + 1);
+	}
+
+	m_wideOrder = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	uint32* bodyColors = (uint32*)m_allocator->Allocate(slotCount * sizeof(uint32));
+	int32* constraintColors = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	memset(bodyColors, 0, slotCount * sizeof(uint32));
+
+	// Greedy coloring in constraint order, the last color holds the constraints that didn't fit.
+	int32 colorCounts[b2_maxContactColors + 1];
+	memset(colorCounts, 0, sizeof(colorCounts));
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bool fixedA = b2IsFixedBody(vc->invMassA, vc->invIA);
+		bool fixedB = b2IsFixedBody(vc->invMassB, vc->invIB);
+
+		uint32 used = 0;
+		if (fixedA == false)
+		{
+			used |= bodyColors[vc->indexA];
+		}
+		if (fixedB == false)
+		{
+			used |= bodyColors[vc->indexB];
+		}
+
+		int32 color = 0;
+		while (color < b2_maxContactColors && (used & (1u << color)) != 0)
+		{
+			++color;
+		}
+
+		if (color < b2_maxContactColors)
+		{
+			if (fixedA == false)
+			{
+				bodyColors[vc->indexA] |= 1u << color;
+			}
+			if (fixedB == false)
+			{
+				bodyColors[vc->indexB] |= 1u << color;
+			}
+		}
+
+		constraintColors[i] = color;
+		++colorCounts[color];
+	}
+
+	int32 colorStarts[b2_maxContactColors + 1];
+	int32 start = 0;
+	m_wideCount = 0;
+	for (int32 color = 0; color <= b2_maxContactColors; ++color)
+	{
+		colorStarts[color] = start;
+		start += colorCounts[color];
+		if (color < b2_maxContactColors)
+		{
+			m_wideCount += (colorCounts[color] + b2_simdLanes - 1) / b2_simdLanes;
+		}
+	}
+	m_overflowCount = colorCounts[b2_maxContactColors];
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_wideOrder[colorStarts[constraintColors[i]]++] = i;
+	}
+
+	m_allocator->Free(constraintColors);
+	m_allocator->Free(bodyColors);
+
+	m_wideVelocityConstraints = (b2WideVelocityConstraint*)m_allocator->Allocate(m_wideCount * sizeof(b2WideVelocityConstraint));
+	m_widePositionConstraints = (b2WidePositionConstraint*)m_allocator->Allocate(m_wideCount * sizeof(b2WidePositionConstraint));
+	memset(m_wideVelocityConstraints, 0, m_wideCount * sizeof(b2WideVelocityConstraint));
+	memset(m_widePositionConstraints, 0, m_wideCount * sizeof(b2WidePositionConstraint));
+
+	// Batches never span two colors. Unused lanes keep zero masses and point at the body of
+	// lane 0, so they compute nothing and are not written back.
+	int32 batch = 0;
+	int32 first = 0;
+	for (int32 color = 0; color < b2_maxContactColors; ++color)
+	{
+		int32 end = first + colorCounts[color];
+		for (int32 k = first; k < end; k += b2_simdLanes)
+		{
+			b2WideVelocityConstraint* wc = m_wideVelocityConstraints + batch;
+			b2WidePositionConstraint* wp = m_widePositionConstraints + batch;
+			++batch;
+
+			wc->laneCount = b2Min(b2_simdLanes, end - k);
+			wp->laneCount = wc->laneCount;
+
+			for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+			{
+				int32 index = m_wideOrder[k + (lane < wc->laneCount ? lane : 0)];
+				b2ContactVelocityConstraint* vc = m_velocityConstraints + index;
+				b2ContactPositionConstraint* pc = m_positionConstraints + index;
+
+				wc->indexA[lane] = vc->indexA;
+				wc->indexB[lane] = vc->indexB;
+				wc->constraintIndex[lane] = index;
+				wp->indexA[lane] = pc->indexA;
+				wp->indexB[lane] = pc->indexB;
+
+				if (lane >= wc->laneCount)
+				{
+					continue;
+				}
+
+				wc->normalX[lane] = vc->normal.x;
+				wc->normalY[lane] = vc->normal.y;
+				wc->friction[lane] = vc->friction;
+				wc->invMassA[lane] = vc->invMassA;
+				wc->invMassB[lane] = vc->invMassB;
+				wc->invIA[lane] = vc->invIA;
+				wc->invIB[lane] = vc->invIB;
+				for (int32 j = 0; j < vc->pointCount; ++j)
+				{
+					b2VelocityConstraintPoint* vcp = vc->points + j;
+					wc->rAX[j][lane] = vcp->rA.x;
+					wc->rAY[j][lane] = vcp->rA.y;
+					wc->rBX[j][lane] = vcp->rB.x;
+					wc->rBY[j][lane] = vcp->rB.y;
+					wc->normalImpulse[j][lane] = vcp->normalImpulse;
+					wc->tangentImpulse[j][lane] = vcp->tangentImpulse;
+					wc->normalMass[j][lane] = vcp->normalMass;
+					wc->tangentMass[j][lane] = vcp->tangentMass;
+					wc->velocityBias[j][lane] = vcp->velocityBias;
+				}
+				wc->K11[lane] = vc->K.ex.x;
+				wc->K12[lane] = vc->K.ex.y;
+				wc->K22[lane] = vc->K.ey.y;
+				wc->M11[lane] = vc->normalMass.ex.x;
+				wc->M21[lane] = vc->normalMass.ex.y;
+				wc->M12[lane] = vc->normalMass.ey.x;
+				wc->M22[lane] = vc->normalMass.ey.y;
+				wc->twoPoints[lane] = vc->pointCount == 2 ? 1.0f : 0.0f;
+
+				for (int32 j = 0; j < pc->pointCount; ++j)
+				{
+					wp->localPointsX[j][lane] = pc->localPoints[j].x;
+					wp->localPointsY[j][lane] = pc->localPoints[j].y;
+				}
+				wp->localNormalX[lane] = pc->localNormal.x;
+				wp->localNormalY[lane] = pc->localNormal.y;
+				wp->localPointX[lane] = pc->localPoint.x;
+				wp->localPointY[lane] = pc->localPoint.y;
+				wp->localCenterAX[lane] = pc->localCenterA.x;
+				wp->localCenterAY[lane] = pc->localCenterA.y;
+				wp->localCenterBX[lane] = pc->localCenterB.x;
+				wp->localCenterBY[lane] = pc->localCenterB.y;
+				wp->invMassA[lane] = pc->invMassA;
+				wp->invMassB[lane] = pc->invMassB;
+				wp->invIA[lane] = pc->invIA;
+				wp->invIB[lane] = pc->invIB;
+				wp->radiusA[lane] = pc->radiusA;
+				wp->radiusB[lane] = pc->radiusB;
+				wp->circles[lane] = pc->type == b2Manifold::e_circles ? 1.0f : 0.0f;
+				wp->faceB[lane] = pc->type == b2Manifold::e_faceB ? 1.0f : 0.0f;
+				wp->twoPoints[lane] = pc->pointCount == 2 ? 1.0f : 0.0f;
+			}
+		}
+
+		first = end;
+	}
+}
+
+// A 2D vector per lane.
+struct b2Vec2W
+{
+	b2FloatW x, y;
+};
+
+struct b2BodyStateW
+{
+	b2Vec2W v;
+	b2FloatW w;
+};
+
+static inline b2BodyStateW b2GatherVelocities(const b2Velocity* velocities, const int32* indices)
+{
+	float32 x[b2_simdLanes], y[b2_simdLanes], w[b2_simdLanes];
+	for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+	{
+		const b2Velocity& v = velocities[indices[lane]];
+		x[lane] = v.v.x;
+		y[lane] = v.v.y;
+		w[lane] = v.w;
+	}
+
+	b2BodyStateW s;
+	s.v.x = b2LoadW(x);
+	s.v.y = b2LoadW(y);
+	s.w = b2LoadW(w);
+	return s;
+}
+
+static inline void b2ScatterVelocities(b2Velocity* velocities, const int32* indices, int32 laneCount, const b2BodyStateW& s)
+{
+	float32 x[b2_simdLanes], y[b2_simdLanes], w[b2_simdLanes];
+	b2StoreW(x, s.v.x);
+	b2StoreW(y, s.v.y);
+	b2StoreW(w, s.w);
+	for (int32 lane = 0; lane < laneCount; ++lane)
+	{
+		b2Velocity& v = velocities[indices[lane]];
+		v.v.x = x[lane];
+		v.v.y = y[lane];
+		v.w = w[lane];
+	}
+}
+
+static inline b2BodyStateW b2GatherPositions(const b2Position* positions, const int32* indices)
+{
+	float32 x[b2_simdLanes], y[b2_simdLanes], a[b2_simdLanes];
+	for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+	{
+		const b2Position& p = positions[indices[lane]];
+		x[lane] = p.c.x;
+		y[lane] = p.c.y;
+		a[lane] = p.a;
+	}
+
+	b2BodyStateW s;
+	s.v.x = b2LoadW(x);
+	s.v.y = b2LoadW(y);
+	s.w = b2LoadW(a);
+	return s;
+}
+
+static inline void b2ScatterPositions(b2Position* positions, const int32* indices, int32 laneCount, const b2BodyStateW& s)
+{
+	float32 x[b2_simdLanes], y[b2_simdLanes], a[b2_simdLanes];
+	b2StoreW(x, s.v.x);
+	b2StoreW(y, s.v.y);
+	b2StoreW(a, s.w);
+	for (int32 lane = 0; lane < laneCount; ++lane)
+	{
+		b2Position& p = positions[indices[lane]];
+		p.c.x = x[lane];
+		p.c.y = y[lane];
+		p.a = a[lane];
+	}
+}
+
+// b2Cross(a, b)
+static inline b2FloatW b2CrossW(const b2Vec2W& a, const b2Vec2W& b)
+{
+	return b2SubW(b2MulW(a.x, b.y), b2MulW(a.y, b.x));
+}
+
+// b2Dot(a, b)
+static inline b2FloatW b2DotW(const b2Vec2W& a, const b2Vec2W& b)
+{
+	return b2AddW(b2MulW(a.x, b.x), b2MulW(a.y, b.y));
+}
+
+// b2Mul(q, v) for q = (s, c)
+static inline b2Vec2W b2RotateW(const b2FloatW& s, const b2FloatW& c, const b2Vec2W& v)
+{
+	b2Vec2W r;
+	r.x = b2SubW(b2MulW(c, v.x), b2MulW(s, v.y));
+	r.y = b2AddW(b2MulW(s, v.x), b2MulW(c, v.y));
+	return r;
+}
+
+static inline b2Vec2W b2LoadVec2W(const float32* x, const float32* y)
+{
+	b2Vec2W r;
+	r.x = b2LoadW(x);
+	r.y = b2LoadW(y);
+	return r;
+}
+
+// Relative velocity at a contact point, vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA).
+static inline b2Vec2W b2RelativeVelocityW(const b2BodyStateW& A, const b2BodyStateW& B, const b2Vec2W& rA, const b2Vec2W& rB)
+{
+	b2Vec2W dv;
+	dv.x = b2AddW(b2SubW(b2SubW(B.v.x, b2MulW(B.w, rB.y)), A.v.x), b2MulW(A.w, rA.y));
+	dv.y = b2SubW(b2SubW(b2AddW(B.v.y, b2MulW(B.w, rB.x)), A.v.y), b2MulW(A.w, rA.x));
+	return dv;
+}
+
+// Apply the impulse P at rA and rB.
+static inline void b2ApplyImpulseW(b2BodyStateW& A, b2BodyStateW& B, const b2FloatW& mA, const b2FloatW& iA,
+								   const b2FloatW& mB, const b2FloatW& iB, const b2Vec2W& rA, const b2Vec2W& rB, const b2Vec2W& P)
+{
+	A.v.x = b2SubW(A.v.x, b2MulW(mA, P.x));
+	A.v.y = b2SubW(A.v.y, b2MulW(mA, P.y));
+	A.w = b2SubW(A.w, b2MulW(iA, b2CrossW(rA, P)));
+
+	B.v.x = b2AddW(B.v.x, b2MulW(mB, P.x));
+	B.v.y = b2AddW(B.v.y, b2MulW(mB, P.y));
+	B.w = b2AddW(B.w, b2MulW(iB, b2CrossW(rB, P)));
+}
+
+void b2ContactSolver::WarmStartWide()
+{
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		b2WideVelocityConstraint* wc = m_wideVelocityConstraints + i;
+
+		b2FloatW mA = b2LoadW(wc->invMassA);
+		b2FloatW iA = b2LoadW(wc->invIA);
+		b2FloatW mB = b2LoadW(wc->invMassB);
+		b2FloatW iB = b2LoadW(wc->invIB);
+
+		b2BodyStateW A = b2GatherVelocities(m_velocities, wc->indexA);
+		b2BodyStateW B = b2GatherVelocities(m_velocities, wc->indexB);
+
+		b2Vec2W normal = b2LoadVec2W(wc->normalX, wc->normalY);
+		b2Vec2W tangent;
+		tangent.x = normal.y;
+		tangent.y = b2SubW(b2ZeroW(), normal.x);
+
+		for (int32 j = 0; j < 2; ++j)
+		{
+			b2FloatW normalImpulse = b2LoadW(wc->normalImpulse[j]);
+			b2FloatW tangentImpulse = b2LoadW(wc->tangentImpulse[j]);
+			b2Vec2W rA = b2LoadVec2W(wc->rAX[j], wc->rAY[j]);
+			b2Vec2W rB = b2LoadVec2W(wc->rBX[j], wc->rBY[j]);
+
+			b2Vec2W P;
+			P.x = b2AddW(b2MulW(normalImpulse, normal.x), b2MulW(tangentImpulse, tangent.x));
+			P.y = b2AddW(b2MulW(normalImpulse, normal.y), b2MulW(tangentImpulse, tangent.y));
+			b2ApplyImpulseW(A, B, mA, iA, mB, iB, rA, rB, P);
+		}
+
+		b2ScatterVelocities(m_velocities, wc->indexA, wc->laneCount, A);
+		b2ScatterVelocities(m_velocities, wc->indexB, wc->laneCount, B);
+	}
+
+	for (int32 i = m_count - m_overflowCount; i < m_count; ++i)
+	{
+		b2WarmStartContact(m_velocityConstraints + m_wideOrder[i], m_velocities);
+	}
+}
+
+void b2ContactSolver::SolveVelocityConstraintsWide()
+{
+	b2FloatW zero = b2ZeroW();
+
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		b2WideVelocityConstraint* wc = m_wideVelocityConstraints + i;
+
+		b2FloatW mA = b2LoadW(wc->invMassA);
+		b2FloatW iA = b2LoadW(wc->invIA);
+		b2FloatW mB = b2LoadW(wc->invMassB);
+		b2FloatW iB = b2LoadW(wc->invIB);
+
+		b2BodyStateW A = b2GatherVelocities(m_velocities, wc->indexA);
+		b2BodyStateW B = b2GatherVelocities(m_velocities, wc->indexB);
+
+		b2Vec2W normal = b2LoadVec2W(wc->normalX, wc->normalY);
+		b2Vec2W tangent;
+		tangent.x = normal.y;
+		tangent.y = b2SubW(zero, normal.x);
+		b2FloatW friction = b2LoadW(wc->friction);
+
+		b2Vec2W rA[2], rB[2];
+		for (int32 j = 0; j < 2; ++j)
+		{
+			rA[j] = b2LoadVec2W(wc->rAX[j], wc->rAY[j]);
+			rB[j] = b2LoadVec2W(wc->rBX[j], wc->rBY[j]);
+		}
+
+		// Solve tangent constraints first because non-penetration is more important
+		// than friction. The second point of a one point lane has no mass and changes nothing.
+		for (int32 j = 0; j < 2; ++j)
+		{
+			b2Vec2W dv = b2RelativeVelocityW(A, B, rA[j], rB[j]);
+
+			b2FloatW vt = b2DotW(dv, tangent);
+			b2FloatW lambda = b2MulW(b2LoadW(wc->tangentMass[j]), b2SubW(zero, vt));
+
+			b2FloatW tangentImpulse = b2LoadW(wc->tangentImpulse[j]);
+			b2FloatW maxFriction = b2MulW(friction, b2LoadW(wc->normalImpulse[j]));
+			b2FloatW newImpulse = b2MaxW(b2SubW(zero, maxFriction), b2MinW(b2AddW(tangentImpulse, lambda), maxFriction));
+			lambda = b2SubW(newImpulse, tangentImpulse);
+			b2StoreW(wc->tangentImpulse[j], newImpulse);
+
+			b2Vec2W P;
+			P.x = b2MulW(lambda, tangent.x);
+			P.y = b2MulW(lambda, tangent.y);
+			b2ApplyImpulseW(A, B, mA, iA, mB, iB, rA[j], rB[j], P);
+		}
+
+		// Solve normal constraints. Both the one point solution and the block solver are
+		// computed for every lane and twoPoints picks one.
+		b2FloatW a1 = b2LoadW(wc->normalImpulse[0]);
+		b2FloatW a2 = b2LoadW(wc->normalImpulse[1]);
+
+		b2FloatW vn1 = b2DotW(b2RelativeVelocityW(A, B, rA[0], rB[0]), normal);
+		b2FloatW vn2 = b2DotW(b2RelativeVelocityW(A, B, rA[1], rB[1]), normal);
+
+		// One point
+		b2FloatW lambda = b2MulW(b2SubW(zero, b2LoadW(wc->normalMass[0])), b2SubW(vn1, b2LoadW(wc->velocityBias[0])));
+		b2FloatW singleX = b2MaxW(b2AddW(a1, lambda), zero);
+
+		// Block solver, see b2SolveVelocityContact for the four cases.
+		b2FloatW K11 = b2LoadW(wc->K11);
+		b2FloatW K12 = b2LoadW(wc->K12);
+		b2FloatW K22 = b2LoadW(wc->K22);
+
+		b2FloatW bx = b2SubW(b2SubW(vn1, b2LoadW(wc->velocityBias[0])), b2AddW(b2MulW(K11, a1), b2MulW(K12, a2)));
+		b2FloatW by = b2SubW(b2SubW(vn2, b2LoadW(wc->velocityBias[1])), b2AddW(b2MulW(K12, a1), b2MulW(K22, a2)));
+
+		// No valid case keeps the old impulses.
+		b2FloatW x1 = a1;
+		b2FloatW x2 = a2;
+
+		// Case 4: x1 = 0 and x2 = 0
+		b2FloatW valid = b2AndW(b2GreaterEqualW(bx, zero), b2GreaterEqualW(by, zero));
+		x1 = b2SelectW(valid, zero, x1);
+		x2 = b2SelectW(valid, zero, x2);
+
+		// Case 3: vn2 = 0 and x1 = 0
+		b2FloatW caseX2 = b2SubW(zero, b2MulW(b2LoadW(wc->normalMass[1]), by));
+		valid = b2AndW(b2GreaterEqualW(caseX2, zero), b2GreaterEqualW(b2AddW(b2MulW(K12, caseX2), bx), zero));
+		x1 = b2SelectW(valid, zero, x1);
+		x2 = b2SelectW(valid, caseX2, x2);
+
+		// Case 2: vn1 = 0 and x2 = 0
+		b2FloatW caseX1 = b2SubW(zero, b2MulW(b2LoadW(wc->normalMass[0]), bx));
+		valid = b2AndW(b2GreaterEqualW(caseX1, zero), b2GreaterEqualW(b2AddW(b2MulW(K12, caseX1), by), zero));
+		x1 = b2SelectW(valid, caseX1, x1);
+		x2 = b2SelectW(valid, zero, x2);
+
+		// Case 1: vn = 0
+		caseX1 = b2SubW(zero, b2AddW(b2MulW(b2LoadW(wc->M11), bx), b2MulW(b2LoadW(wc->M12), by)));
+		caseX2 = b2SubW(zero, b2AddW(b2MulW(b2LoadW(wc->M21), bx), b2MulW(b2LoadW(wc->M22), by)));
+		valid = b2AndW(b2GreaterEqualW(caseX1, zero), b2GreaterEqualW(caseX2, zero));
+		x1 = b2SelectW(valid, caseX1, x1);
+		x2 = b2SelectW(valid, caseX2, x2);
+
+		b2FloatW twoPoints = b2GreaterW(b2LoadW(wc->twoPoints), zero);
+		x1 = b2SelectW(twoPoints, x1, singleX);
+		x2 = b2SelectW(twoPoints, x2, a2);
+
+		// Apply incremental impulse
+		b2FloatW d1 = b2SubW(x1, a1);
+		b2FloatW d2 = b2SubW(x2, a2);
+		b2Vec2W P1, P2, P;
+		P1.x = b2MulW(d1, normal.x);
+		P1.y = b2MulW(d1, normal.y);
+		P2.x = b2MulW(d2, normal.x);
+		P2.y = b2MulW(d2, normal.y);
+		P.x = b2AddW(P1.x, P2.x);
+		P.y = b2AddW(P1.y, P2.y);
+
+		A.v.x = b2SubW(A.v.x, b2MulW(mA, P.x));
+		A.v.y = b2SubW(A.v.y, b2MulW(mA, P.y));
+		A.w = b2SubW(A.w, b2MulW(iA, b2AddW(b2CrossW(rA[0], P1), b2CrossW(rA[1], P2))));
+
+		B.v.x = b2AddW(B.v.x, b2MulW(mB, P.x));
+		B.v.y = b2AddW(B.v.y, b2MulW(mB, P.y));
+		B.w = b2AddW(B.w, b2MulW(iB, b2AddW(b2CrossW(rB[0], P1), b2CrossW(rB[1], P2))));
+
+		b2StoreW(wc->normalImpulse[0], x1);
+		b2StoreW(wc->normalImpulse[1], x2);
+
+		b2ScatterVelocities(m_velocities, wc->indexA, wc->laneCount, A);
+		b2ScatterVelocities(m_velocities, wc->indexB, wc->laneCount, B);
+	}
+
+	for (int32 i = m_count - m_overflowCount; i < m_count; ++i)
+	{
+		b2SolveVelocityContact(m_velocityConstraints + m_wideOrder[i], m_velocities);
+	}
+}
+
+// Rotation of each lane's angle, the same as b2Rot::Set.
+static inline void b2SinCosW(const b2FloatW& angle, b2FloatW& s, b2FloatW& c)
+{
+	float32 a[b2_simdLanes], sa[b2_simdLanes], ca[b2_simdLanes];
+	b2StoreW(a, angle);
+	for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+	{
+		sa[lane] = sinf(a[lane]);
+		ca[lane] = cosf(a[lane]);
+	}
+	s = b2LoadW(sa);
+	c = b2LoadW(ca);
+}
+
+bool b2ContactSolver::SolvePositionConstraintsWide()
+{
+	b2FloatW zero = b2ZeroW();
+	b2FloatW minSeparation = zero;
+
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		b2WidePositionConstraint* wp = m_widePositionConstraints + i;
+
+		b2FloatW mA = b2LoadW(wp->invMassA);
+		b2FloatW iA = b2LoadW(wp->invIA);
+		b2FloatW mB = b2LoadW(wp->invMassB);
+		b2FloatW iB = b2LoadW(wp->invIB);
+		b2Vec2W localCenterA = b2LoadVec2W(wp->localCenterAX, wp->localCenterAY);
+		b2Vec2W localCenterB = b2LoadVec2W(wp->localCenterBX, wp->localCenterBY);
+		b2Vec2W localNormal = b2LoadVec2W(wp->localNormalX, wp->localNormalY);
+		b2Vec2W localPoint = b2LoadVec2W(wp->localPointX, wp->localPointY);
+		b2FloatW radiusA = b2LoadW(wp->radiusA);
+		b2FloatW radiusB = b2LoadW(wp->radiusB);
+		b2FloatW circles = b2GreaterW(b2LoadW(wp->circles), zero);
+		b2FloatW faceB = b2GreaterW(b2LoadW(wp->faceB), zero);
+
+		float32 laneMask[b2_simdLanes];
+		for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+		{
+			laneMask[lane] = lane < wp->laneCount ? 1.0f : 0.0f;
+		}
+		b2FloatW usedLanes = b2GreaterW(b2LoadW(laneMask), zero);
+
+		b2BodyStateW A = b2GatherPositions(m_positions, wp->indexA);
+		b2BodyStateW B = b2GatherPositions(m_positions, wp->indexB);
+
+		for (int32 j = 0; j < 2; ++j)
+		{
+			b2FloatW active = j == 0 ? usedLanes : b2AndW(usedLanes, b2GreaterW(b2LoadW(wp->twoPoints), zero));
+
+			b2FloatW sA, cosA, sB, cosB;
+			b2SinCosW(A.w, sA, cosA);
+			b2SinCosW(B.w, sB, cosB);
+
+			b2Vec2W pA = b2RotateW(sA, cosA, localCenterA);
+			pA.x = b2SubW(A.v.x, pA.x);
+			pA.y = b2SubW(A.v.y, pA.y);
+			b2Vec2W pB = b2RotateW(sB, cosB, localCenterB);
+			pB.x = b2SubW(B.v.x, pB.x);
+			pB.y = b2SubW(B.v.y, pB.y);
+
+			// b2PositionSolverManifold: the reference face is on B for e_faceB and on A otherwise.
+			b2FloatW sRef = b2SelectW(faceB, sB, sA);
+			b2FloatW cRef = b2SelectW(faceB, cosB, cosA);
+			b2FloatW sInc = b2SelectW(faceB, sA, sB);
+			b2FloatW cInc = b2SelectW(faceB, cosA, cosB);
+			b2Vec2W pRef, pInc;
+			pRef.x = b2SelectW(faceB, pB.x, pA.x);
+			pRef.y = b2SelectW(faceB, pB.y, pA.y);
+			pInc.x = b2SelectW(faceB, pA.x, pB.x);
+			pInc.y = b2SelectW(faceB, pA.y, pB.y);
+
+			b2Vec2W planePoint = b2RotateW(sRef, cRef, localPoint);
+			planePoint.x = b2AddW(planePoint.x, pRef.x);
+			planePoint.y = b2AddW(planePoint.y, pRef.y);
+
+			b2Vec2W clipPoint = b2RotateW(sInc, cInc, b2LoadVec2W(wp->localPointsX[j], wp->localPointsY[j]));
+			clipPoint.x = b2AddW(clipPoint.x, pInc.x);
+			clipPoint.y = b2AddW(clipPoint.y, pInc.y);
+
+			b2Vec2W d;
+			d.x = b2SubW(clipPoint.x, planePoint.x);
+			d.y = b2SubW(clipPoint.y, planePoint.y);
+
+			// Circles: normalize the vector between the centers, as b2Vec2::Normalize.
+			b2FloatW length = b2SqrtW(b2AddW(b2MulW(d.x, d.x), b2MulW(d.y, d.y)));
+			b2FloatW invLength = b2DivW(b2SplatW(1.0f), length);
+			b2FloatW normalizable = b2GreaterEqualW(length, b2SplatW(b2_epsilon));
+			b2Vec2W circleNormal;
+			circleNormal.x = b2SelectW(normalizable, b2MulW(d.x, invLength), d.x);
+			circleNormal.y = b2SelectW(normalizable, b2MulW(d.y, invLength), d.y);
+
+			b2Vec2W faceNormal = b2RotateW(sRef, cRef, localNormal);
+
+			b2Vec2W normal;
+			normal.x = b2SelectW(circles, circleNormal.x, faceNormal.x);
+			normal.y = b2SelectW(circles, circleNormal.y, faceNormal.y);
+
+			b2Vec2W point;
+			b2FloatW half = b2SplatW(0.5f);
+			point.x = b2SelectW(circles, b2MulW(half, b2AddW(planePoint.x, clipPoint.x)), clipPoint.x);
+			point.y = b2SelectW(circles, b2MulW(half, b2AddW(planePoint.y, clipPoint.y)), clipPoint.y);
+
+			b2FloatW separation = b2SubW(b2SubW(b2DotW(d, normal), radiusA), radiusB);
+
+			// Ensure normal points from A to B
+			normal.x = b2SelectW(faceB, b2SubW(zero, normal.x), normal.x);
+			normal.y = b2SelectW(faceB, b2SubW(zero, normal.y), normal.y);
+
+			b2Vec2W rA, rB;
+			rA.x = b2SubW(point.x, A.v.x);
+			rA.y = b2SubW(point.y, A.v.y);
+			rB.x = b2SubW(point.x, B.v.x);
+			rB.y = b2SubW(point.y, B.v.y);
+
+			// Track max constraint error.
+			minSeparation = b2SelectW(active, b2MinW(minSeparation, separation), minSeparation);
+
+			// Prevent large corrections and allow slop.
+			b2FloatW C = b2MulW(b2SplatW(b2_baumgarte), b2AddW(separation, b2SplatW(b2_linearSlop)));
+			C = b2MaxW(b2SplatW(-b2_maxLinearCorrection), b2MinW(C, zero));
+
+			// Compute the effective mass.
+			b2FloatW rnA = b2CrossW(rA, normal);
+			b2FloatW rnB = b2CrossW(rB, normal);
+			b2FloatW K = b2AddW(b2AddW(b2AddW(mA, mB), b2MulW(b2MulW(iA, rnA), rnA)), b2MulW(b2MulW(iB, rnB), rnB));
+
+			// Compute normal impulse
+			b2FloatW solvable = b2AndW(active, b2GreaterW(K, zero));
+			b2FloatW impulse = b2SelectW(solvable, b2DivW(b2SubW(zero, C), K), zero);
+
+			b2Vec2W P;
+			P.x = b2MulW(impulse, normal.x);
+			P.y = b2MulW(impulse, normal.y);
+			b2ApplyImpulseW(A, B, mA, iA, mB, iB, rA, rB, P);
+		}
+
+		b2ScatterPositions(m_positions, wp->indexA, wp->laneCount, A);
+		b2ScatterPositions(m_positions, wp->indexB, wp->laneCount, B);
+	}
+
+	float32 separations[b2_simdLanes];
+	b2StoreW(separations, minSeparation);
+	float32 result = 0.0f;
+	for (int32 lane = 0; lane < b2_simdLanes; ++lane)
+	{
+		result = b2Min(result, separations[lane]);
+	}
+
+	for (int32 i = m_count - m_overflowCount; i < m_count; ++i)
+	{
+		result = b2Min(result, b2SolvePositionContact(m_positionConstraints + m_wideOrder[i], m_positions));
+	}
+
+	// We can't expect minSpeparation >= -b2_linearSlop because we don't
+	// push the separation above -b2_linearSlop.
+	return result >= -3.0f * b2_linearSlop;
+}
@@ -27,6 +27,8 @@ class b2Contact;
 class b2Body;
 class b2StackAllocator;
 struct b2ContactPositionConstraint;
+struct b2WideVelocityConstraint;
+struct b2WidePositionConstraint;
 
 struct b2VelocityConstraintPoint
 {
@@ -80,6 +82,13 @@ public:
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	/// Pack the constraints into batches of b2_simdLanes that touch different bodies.
+	/// Called by InitializeVelocityConstraints when the step asks for it.
+	void InitializeWideConstraints();
+	void WarmStartWide();
+	void SolveVelocityConstraintsWide();
+	bool SolvePositionConstraintsWide();
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
@@ -88,6 +97,14 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+
+	// Batched constraints, see b2World::SetSIMDContacts. The constraint indices are
+	// ordered by batch, the ones that didn't fit a batch are at the end and are solved one by one.
+	b2WideVelocityConstraint* m_wideVelocityConstraints;
+	b2WidePositionConstraint* m_widePositionConstraints;
+	int32 m_wideCount;
+	int32* m_wideOrder;
+	int32 m_overflowCount;
 };
 
 #endif
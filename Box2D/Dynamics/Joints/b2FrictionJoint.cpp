@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Snapshot.h>
 
 // Point-to-point constraint
 // Cdot = v2 - v1
@@ -249,3 +250,15 @@ void b2FrictionJoint::Dump()
 	b2Log("  jd.maxTorque = %.15lef;\n", m_maxTorque);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void b2FrictionJoint::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_linearImpulse);
+	snapshot->Write(m_angularImpulse);
+}
+
+void b2FrictionJoint::RestoreState(b2SnapshotReader* reader)
+{
+	reader->Read(&m_linearImpulse);
+	reader->Read(&m_angularImpulse);
+}
@@ -21,6 +21,7 @@
 #include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Snapshot.h>
 
 // Gear Joint:
 // C0 = (coordinate1 + ratio * coordinate2)_initial
@@ -421,3 +422,13 @@ void b2GearJoint::Dump()
 	b2Log("  jd.ratio = %.15lef;\n", m_ratio);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void b2GearJoint::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+}
+
+void b2GearJoint::RestoreState(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+}
@@ -25,6 +25,8 @@ class b2Body;
 class b2Joint;
 struct b2SolverData;
 class b2BlockAllocator;
+class b2Snapshot;
+class b2SnapshotReader;
 
 enum b2JointType
 {
@@ -163,6 +165,11 @@ protected:
 	// This returns true if the position errors are within tolerance.
 	virtual bool SolvePositionConstraints(const b2SolverData& data) = 0;
 
+	// Write and read the state that carries over between steps,
+	// such as the warm starting impulses. See b2World::SaveSnapshot.
+	virtual void SaveState(b2Snapshot* snapshot) const { B2_NOT_USED(snapshot); }
+	virtual void RestoreState(b2SnapshotReader* reader) { B2_NOT_USED(reader); }
+
 	b2JointType m_type;
 	b2Joint* m_prev;
 	b2Joint* m_next;
@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/Joints/b2MouseJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Snapshot.h>
 
 // p = attached point, m = mouse point
 // C = p - m
@@ -215,3 +216,15 @@ float32 b2MouseJoint::GetReactionTorque(float32 inv_dt) const
 {
 	return inv_dt * 0.0f;
 }
+
+void b2MouseJoint::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_targetA);
+	snapshot->Write(m_impulse);
+}
+
+void b2MouseJoint::RestoreState(b2SnapshotReader* reader)
+{
+	reader->Read(&m_targetA);
+	reader->Read(&m_impulse);
+}
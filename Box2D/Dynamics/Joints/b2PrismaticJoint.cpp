@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Snapshot.h>
 
 // Linear constraint (point-to-line)
 // d = p2 - p1 = x2 + r2 - x1 - r1
@@ -635,3 +636,17 @@ void b2PrismaticJoint::Dump()
 	b2Log("  jd.maxMotorForce = %.15lef;\n", m_maxMotorForce);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void b2PrismaticJoint::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_motorImpulse);
+	snapshot->Write(m_limitState);
+}
+
+void b2PrismaticJoint::RestoreState(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+	reader->Read(&m_motorImpulse);
+	reader->Read(&m_limitState);
+}
@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Snapshot.h>
 
 // Pulley:
 // length1 = norm(p1 - s1)
@@ -330,3 +331,13 @@ void b2PulleyJoint::Dump()
 	b2Log("  jd.ratio = %.15lef;\n", m_ratio);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void b2PulleyJoint::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+}
+
+void b2PulleyJoint::RestoreState(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+}
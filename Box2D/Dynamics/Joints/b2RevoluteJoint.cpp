@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Snapshot.h>
 
 // Point-to-point constraint
 // C = p2 - p1
@@ -502,3 +503,17 @@ void b2RevoluteJoint::Dump()
 	b2Log("  jd.maxMotorTorque = %.15lef;\n", m_maxMotorTorque);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void b2RevoluteJoint::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_motorImpulse);
+	snapshot->Write(m_limitState);
+}
+
+void b2RevoluteJoint::RestoreState(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+	reader->Read(&m_motorImpulse);
+	reader->Read(&m_limitState);
+}
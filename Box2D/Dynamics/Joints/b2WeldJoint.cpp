@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/Joints/b2WeldJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Common/b2Snapshot.h>
 
 // Point-to-point constraint
 // C = p2 - p1
@@ -328,3 +329,13 @@ void b2WeldJoint::Dump()
 	b2Log("  jd.dampingRatio = %.15lef;\n", m_dampingRatio);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void b2WeldJoint::SaveState(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+}
+
+void b2WeldJoint::RestoreState(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+}
@@ -21,10 +21,14 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Common/b2ThreadPool.h>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
+// Contacts per task of the parallel narrow phase.
+static const int32 b2_collideGrainSize = 32;
+
 b2ContactManager::b2ContactManager()
 {
 	m_contactList = NULL;
@@ -32,6 +36,14 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+	m_threadPool = NULL;
+	m_updates = NULL;
+	m_updateCapacity = 0;
+}
+
+b2ContactManager::~b2ContactManager()
+{
+	b2Free(m_updates);
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -104,6 +116,12 @@ void b2ContactManager::Destroy(b2Contact* c)
 // contact list.
 void b2ContactManager::Collide()
 {
+	if (m_threadPool && m_contactCount > b2_collideGrainSize)
+	{
+		CollideParallel();
+		return;
+	}
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
@@ -169,6 +187,189 @@ void b2ContactManager::Collide()
 	}
 }
 
+// What CollideParallel does with a contact, in contact list order.
+struct b2ContactUpdate
+{
+	enum Action
+	{
+		e_destroy,
+		e_asleep,
+		e_updateSerial,
+		e_updateParallel
+	};
+
+	b2Contact* contact;
+	Action action;
+	uint32 oldFlags;
+	b2Manifold oldManifold;
+};
+
+// At least one body must be awake and it must be dynamic or kinematic.
+static inline bool b2IsActive(const b2Body* bodyA, const b2Body* bodyB)
+{
+	bool activeA = bodyA->IsAwake() && bodyA->GetType() != b2_staticBody;
+	bool activeB = bodyB->IsAwake() && bodyB->GetType() != b2_staticBody;
+	return activeA || activeB;
+}
+
+// Computes the new manifolds of the e_updateParallel contacts.
+class b2ContactUpdateTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+
+		for (int32 i = begin; i < end; ++i)
+		{
+			b2ContactUpdate* update = updates + i;
+			if (update->action != b2ContactUpdate::e_updateParallel)
+			{
+				continue;
+			}
+
+			b2Contact* c = update->contact;
+			update->oldManifold = *c->GetManifold();
+			update->oldFlags = c->m_flags;
+			c->UpdateManifold(update->oldManifold);
+		}
+	}
+
+	b2ContactUpdate* updates;
+};
+
+// Collide with the manifolds computed on the thread pool. The same contacts are filtered,
+// destroyed and updated as in Collide, and the listener gets the same calls in the same
+// order, all from the calling thread:
+// 1. walk the contact list and decide what happens to each contact (this calls the filter),
+// 2. compute the new manifolds in parallel,
+// 3. walk the decisions in order to destroy contacts, wake bodies and call the listener.
+// In Collide a contact can wake up the bodies of the contacts after it, so the last pass
+// checks again which contacts are active and updates or reverts them to match.
+// Sensors are updated in the last pass, b2TestOverlap updates the global GJK counters.
+void b2ContactManager::CollideParallel()
+{
+	if (m_updateCapacity < m_contactCount)
+	{
+		b2Free(m_updates);
+		m_updateCapacity = b2Max(m_contactCount, 2 * m_updateCapacity);
+		m_updates = (b2ContactUpdate*)b2Alloc(m_updateCapacity * sizeof(b2ContactUpdate));
+	}
+
+	int32 updateCount = 0;
+	for (b2Contact* c = m_contactList; c; c = c->GetNext())
+	{
+		b2Fixture* fixtureA = c->GetFixtureA();
+		b2Fixture* fixtureB = c->GetFixtureB();
+		int32 indexA = c->GetChildIndexA();
+		int32 indexB = c->GetChildIndexB();
+		b2Body* bodyA = fixtureA->GetBody();
+		b2Body* bodyB = fixtureB->GetBody();
+
+		b2ContactUpdate* update = m_updates + updateCount;
+		update->contact = c;
+		update->action = b2ContactUpdate::e_destroy;
+
+		// Is this contact flagged for filtering?
+		if (c->m_flags & b2Contact::e_filterFlag)
+		{
+			// Should these bodies collide?
+			if (bodyB->ShouldCollide(bodyA) == false)
+			{
+				++updateCount;
+				continue;
+			}
+
+			// Check user filtering.
+			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+			{
+				++updateCount;
+				continue;
+			}
+
+			// Clear the filtering flag.
+			c->m_flags &= ~b2Contact::e_filterFlag;
+		}
+
+		if (b2IsActive(bodyA, bodyB) == false)
+		{
+			update->action = b2ContactUpdate::e_asleep;
+			++updateCount;
+			continue;
+		}
+
+		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+
+		// Here we destroy contacts that cease to overlap in the broad-phase.
+		if (overlap == false)
+		{
+			++updateCount;
+			continue;
+		}
+
+		// The contact persists.
+		bool sensor = fixtureA->IsSensor() || fixtureB->IsSensor();
+		update->action = sensor ? b2ContactUpdate::e_updateSerial : b2ContactUpdate::e_updateParallel;
+		++updateCount;
+	}
+
+	b2ContactUpdateTask task;
+	task.updates = m_updates;
+	m_threadPool->ParallelFor(&task, updateCount, b2_collideGrainSize);
+
+	for (int32 i = 0; i < updateCount; ++i)
+	{
+		b2ContactUpdate* update = m_updates + i;
+		b2Contact* c = update->contact;
+		b2Fixture* fixtureA = c->GetFixtureA();
+		b2Fixture* fixtureB = c->GetFixtureB();
+
+		switch (update->action)
+		{
+		case b2ContactUpdate::e_destroy:
+			Destroy(c);
+			break;
+
+		case b2ContactUpdate::e_asleep:
+			if (b2IsActive(fixtureA->GetBody(), fixtureB->GetBody()))
+			{
+				// Woken up by an earlier contact.
+				int32 proxyIdA = fixtureA->m_proxies[c->GetChildIndexA()].proxyId;
+				int32 proxyIdB = fixtureB->m_proxies[c->GetChildIndexB()].proxyId;
+				if (m_broadPhase.TestOverlap(proxyIdA, proxyIdB))
+				{
+					c->Update(m_contactListener);
+				}
+				else
+				{
+					Destroy(c);
+				}
+			}
+			break;
+
+		case b2ContactUpdate::e_updateSerial:
+			c->Update(m_contactListener);
+			break;
+
+		case b2ContactUpdate::e_updateParallel:
+			if (b2IsActive(fixtureA->GetBody(), fixtureB->GetBody()))
+			{
+				bool wasTouching = (update->oldFlags & b2Contact::e_touchingFlag) == b2Contact::e_touchingFlag;
+				c->ReportUpdate(m_contactListener, update->oldManifold, wasTouching);
+			}
+			else
+			{
+				// Put to sleep by the listener, this contact wouldn't have been updated.
+				c->m_manifold = update->oldManifold;
+				c->m_flags = update->oldFlags;
+			}
+			break;
+		}
+	}
+}
+
 void b2ContactManager::FindNewContacts()
 {
 	m_broadPhase.UpdatePairs(this);
@@ -242,13 +443,21 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
+	Insert(c);
+
 	// Contact creation may swap fixtures.
-	fixtureA = c->GetFixtureA();
-	fixtureB = c->GetFixtureB();
-	indexA = c->GetChildIndexA();
-	indexB = c->GetChildIndexB();
-	bodyA = fixtureA->GetBody();
-	bodyB = fixtureB->GetBody();
+	bodyA = c->GetFixtureA()->GetBody();
+	bodyB = c->GetFixtureB()->GetBody();
+
+	// Wake up the bodies
+	bodyA->SetAwake(true);
+	bodyB->SetAwake(true);
+}
+
+void b2ContactManager::Insert(b2Contact* c)
+{
+	b2Body* bodyA = c->GetFixtureA()->GetBody();
+	b2Body* bodyB = c->GetFixtureB()->GetBody();
 
 	// Insert into the world.
 	c->m_prev = NULL;
@@ -285,9 +494,5 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	}
 	bodyB->m_contactList = &c->m_nodeB;
 
-	// Wake up the bodies
-	bodyA->SetAwake(true);
-	bodyB->SetAwake(true);
-
 	++m_contactCount;
 }
@@ -25,21 +25,28 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2ThreadPool;
+struct b2ContactUpdate;
 
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
 	b2ContactManager();
+	~b2ContactManager();
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
 	void FindNewContacts();
 
+	// Link a new contact into the world and body contact lists.
+	void Insert(b2Contact* c);
+
 	void Destroy(b2Contact* c);
 
 	void Collide();
+	void CollideParallel();
             
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
@@ -47,6 +54,11 @@ public:
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	// Parallel narrow phase, see b2World::SetThreadCount. NULL with one thread.
+	b2ThreadPool* m_threadPool;
+	b2ContactUpdate* m_updates;
+	int32 m_updateCapacity;
 };
 
 #endif
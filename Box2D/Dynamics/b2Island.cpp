@@ -161,6 +161,8 @@ b2Island::b2Island(
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_impulses = NULL;
+	m_ownsArrays = true;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -170,14 +172,45 @@ b2Island::b2Island(
 	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
 }
 
+b2Island::b2Island(
+	b2Body** bodies, int32 bodyCount,
+	b2Contact** contacts, int32 contactCount,
+	b2Joint** joints, int32 jointCount,
+	int32 staticSlotCount,
+	b2StackAllocator* allocator,
+	b2ContactImpulse* impulses)
+{
+	m_bodyCapacity = bodyCount;
+	m_contactCapacity = contactCount;
+	m_jointCapacity = jointCount;
+	m_bodyCount = bodyCount;
+	m_contactCount = contactCount;
+	m_jointCount = jointCount;
+
+	m_allocator = allocator;
+	m_listener = NULL;
+	m_impulses = impulses;
+	m_ownsArrays = false;
+
+	m_bodies = bodies;
+	m_contacts = contacts;
+	m_joints = joints;
+
+	m_velocities = (b2Velocity*)m_allocator->Allocate((staticSlotCount + bodyCount) * sizeof(b2Velocity));
+	m_positions = (b2Position*)m_allocator->Allocate((staticSlotCount + bodyCount) * sizeof(b2Position));
+}
+
 b2Island::~b2Island()
 {
 	// Warning: the order should reverse the constructor order.
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
-	m_allocator->Free(m_joints);
-	m_allocator->Free(m_contacts);
-	m_allocator->Free(m_bodies);
+	if (m_ownsArrays)
+	{
+		m_allocator->Free(m_joints);
+		m_allocator->Free(m_contacts);
+		m_allocator->Free(m_bodies);
+	}
 }
 
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
@@ -187,9 +220,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	float32 h = step.dt;
 
 	// Integrate velocities and apply damping. Initialize the body state.
+	// The state is indexed by m_islandIndex, which is i unless the island was gathered
+	// for the parallel solver. Static bodies are only read, other islands may be using them.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
+		int32 k = b->m_islandIndex;
 
 		b2Vec2 c = b->m_sweep.c;
 		float32 a = b->m_sweep.a;
@@ -197,8 +233,11 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		float32 w = b->m_angularVelocity;
 
 		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		if (b->m_type != b2_staticBody)
+		{
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+		}
 
 		if (b->m_type == b2_dynamicBody)
 		{
@@ -217,10 +256,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			w *= b2Clamp(1.0f - h * b->m_angularDamping, 0.0f, 1.0f);
 		}
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		m_positions[k].c = c;
+		m_positions[k].a = a;
+		m_velocities[k].v = v;
+		m_velocities[k].w = w;
 	}
 
 	timer.Reset();
@@ -274,10 +313,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	// Integrate positions
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Vec2 c = m_positions[i].c;
-		float32 a = m_positions[i].a;
-		b2Vec2 v = m_velocities[i].v;
-		float32 w = m_velocities[i].w;
+		int32 k = m_bodies[i]->m_islandIndex;
+
+		b2Vec2 c = m_positions[k].c;
+		float32 a = m_positions[k].a;
+		b2Vec2 v = m_velocities[k].v;
+		float32 w = m_velocities[k].w;
 
 		// Check for large velocities
 		b2Vec2 translation = h * v;
@@ -298,10 +339,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		c += h * v;
 		a += h * w;
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		m_positions[k].c = c;
+		m_positions[k].a = a;
+		m_velocities[k].v = v;
+		m_velocities[k].w = w;
 	}
 
 	// Solve position constraints
@@ -326,14 +367,20 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		}
 	}
 
-	// Copy state buffers back to the bodies
+	// Copy state buffers back to the bodies. Static bodies did not move.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
+		if (body->m_type == b2_staticBody)
+		{
+			continue;
+		}
+
+		int32 k = body->m_islandIndex;
+		body->m_sweep.c = m_positions[k].c;
+		body->m_sweep.a = m_positions[k].a;
+		body->m_linearVelocity = m_velocities[k].v;
+		body->m_angularVelocity = m_velocities[k].w;
 		body->SynchronizeTransform();
 	}
 
@@ -375,7 +422,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			for (int32 i = 0; i < m_bodyCount; ++i)
 			{
 				b2Body* b = m_bodies[i];
-				b->SetAwake(false);
+				if (b->GetType() != b2_staticBody)
+				{
+					b->SetAwake(false);
+				}
 			}
 		}
 	}
@@ -515,7 +565,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == NULL)
+	if (m_listener == NULL && m_impulses == NULL)
 	{
 		return;
 	}
@@ -534,6 +584,14 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_impulses)
+		{
+			// Replayed by the world in island order once all islands are solved.
+			m_impulses[i] = impulse;
+		}
+		else
+		{
+			m_listener->PostSolve(c, &impulse);
+		}
 	}
 }
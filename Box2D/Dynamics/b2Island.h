@@ -28,6 +28,7 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
+struct b2ContactImpulse;
 struct b2Profile;
 
 /// This is an internal class.
@@ -36,6 +37,17 @@ class b2Island
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
 			b2StackAllocator* allocator, b2ContactListener* listener);
+
+	/// An island over bodies, contacts and joints gathered beforehand, for the parallel solver.
+	/// Static bodies can be shared by several islands solved at the same time, so they
+	/// already have their m_islandIndex in [0, staticSlotCount) and the other bodies in
+	/// [staticSlotCount, staticSlotCount + bodyCount). The contact impulses are written
+	/// to impulses instead of being reported to a listener.
+	b2Island(b2Body** bodies, int32 bodyCount,
+			b2Contact** contacts, int32 contactCount,
+			b2Joint** joints, int32 jointCount,
+			int32 staticSlotCount, b2StackAllocator* allocator, b2ContactImpulse* impulses);
+
 	~b2Island();
 
 	void Clear()
@@ -73,6 +85,8 @@ public:
 
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
+	b2ContactImpulse* m_impulses;
+	bool m_ownsArrays;
 
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
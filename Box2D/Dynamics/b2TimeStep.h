@@ -32,6 +32,12 @@ struct b2Profile
 	float32 solvePosition;
 	float32 broadphase;
 	float32 solveTOI;
+
+	// Parallel island solving, see b2World::SetThreadCount.
+	int32 islandCount;
+	int32 threadCount;
+	float32 threadSolve[b2_maxThreads];	///< time each thread spent solving islands
+	int32 threadIslands[b2_maxThreads];	///< islands solved by each thread
 };
 
 /// This is an internal structure.
@@ -43,6 +49,7 @@ struct b2TimeStep
 	int32 velocityIterations;
 	int32 positionIterations;
 	bool warmStarting;
+	bool simdContacts;	// batched contact solver, see b2World::SetSIMDContacts
 };
 
 /// This is an internal structure.
@@ -32,6 +32,8 @@
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2Snapshot.h>
 #include <new>
 
 b2World::b2World(const b2Vec2& gravity)
@@ -48,6 +50,7 @@ b2World::b2World(const b2Vec2& gravity)
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_simdContacts = false;
 
 	m_stepComplete = true;
 
@@ -61,6 +64,13 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+
+	m_threadPool = NULL;
+	m_threadStackAllocators[0] = &m_stackAllocator;
+	for (int32 i = 1; i < b2_maxThreads; ++i)
+	{
+		m_threadStackAllocators[i] = NULL;
+	}
 }
 
 b2World::~b2World()
@@ -82,6 +92,8 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	SetThreadCount(1);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -382,33 +394,169 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+void b2World::SetThreadCount(int32 threadCount)
 {
-	m_profile.solveInit = 0.0f;
-	m_profile.solveVelocity = 0.0f;
-	m_profile.solvePosition = 0.0f;
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
 
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+	if (threadCount <= 0)
+	{
+		threadCount = b2ThreadPool::GetHardwareThreadCount();
+	}
+	threadCount = b2Clamp(threadCount, 1, b2_maxThreads);
 
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	if (threadCount == GetThreadCount())
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		return;
 	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+
+	if (m_threadPool)
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
+		m_threadPool->~b2ThreadPool();
+		b2Free(m_threadPool);
+		m_threadPool = NULL;
 	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
+
+	for (int32 i = 1; i < b2_maxThreads; ++i)
 	{
-		j->m_islandFlag = false;
+		if (i < threadCount && m_threadStackAllocators[i] == NULL)
+		{
+			void* mem = b2Alloc(sizeof(b2StackAllocator));
+			m_threadStackAllocators[i] = new (mem) b2StackAllocator;
+		}
+		else if (i >= threadCount && m_threadStackAllocators[i] != NULL)
+		{
+			m_threadStackAllocators[i]->~b2StackAllocator();
+			b2Free(m_threadStackAllocators[i]);
+			m_threadStackAllocators[i] = NULL;
+		}
+	}
+
+	if (threadCount > 1)
+	{
+		void* mem = b2Alloc(sizeof(b2ThreadPool));
+		m_threadPool = new (mem) b2ThreadPool(threadCount);
+	}
+
+	m_contactManager.m_threadPool = m_threadPool;
+}
+
+int32 b2World::GetThreadCount() const
+{
+	return m_threadPool ? m_threadPool->GetThreadCount() : 1;
+}
+
+// Depth first search on the constraint graph from seed. Adds the awake bodies, the
+// touching contacts and the joints found to island.
+void b2World::BuildIsland(b2Body* seed, b2Island* island, b2Body** stack, int32 stackSize)
+{
+	int32 stackCount = 0;
+	stack[stackCount++] = seed;
+	seed->m_flags |= b2Body::e_islandFlag;
+
+	// Perform a depth first search (DFS) on the constraint graph.
+	while (stackCount > 0)
+	{
+		// Grab the next body off the stack and add it to the island.
+		b2Body* b = stack[--stackCount];
+		b2Assert(b->IsActive() == true);
+		island->Add(b);
+
+		// Make sure the body is awake.
+		b->SetAwake(true);
+
+		// To keep islands as small as possible, we don't
+		// propagate islands across static bodies.
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		// Search all contacts connected to this body.
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			b2Contact* contact = ce->contact;
+
+			// Has this contact already been added to an island?
+			if (contact->m_flags & b2Contact::e_islandFlag)
+			{
+				continue;
+			}
+
+			// Is this contact solid and touching?
+			if (contact->IsEnabled() == false ||
+				contact->IsTouching() == false)
+			{
+				continue;
+			}
+
+			// Skip sensors.
+			bool sensorA = contact->m_fixtureA->m_isSensor;
+			bool sensorB = contact->m_fixtureB->m_isSensor;
+			if (sensorA || sensorB)
+			{
+				continue;
+			}
+
+			island->Add(contact);
+			contact->m_flags |= b2Contact::e_islandFlag;
+
+			b2Body* other = ce->other;
+
+			// Was the other body already added to this island?
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
+
+		// Search all joints connect to this body.
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			if (je->joint->m_islandFlag == true)
+			{
+				continue;
+			}
+
+			b2Body* other = je->other;
+
+			// Don't simulate joints connected to inactive bodies.
+			if (other->IsActive() == false)
+			{
+				continue;
+			}
+
+			island->Add(je->joint);
+			je->joint->m_islandFlag = true;
+
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
 	}
+}
+
+// Build and solve the islands one after the other.
+void b2World::SolveIslands(const b2TimeStep& step)
+{
+	// Size the island for the worst case.
+	b2Island island(m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					m_contactManager.m_contactListener);
 
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
@@ -433,110 +581,158 @@ void b2World::Solve(const b2TimeStep& step)
 
 		// Reset island and stack.
 		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+		BuildIsland(seed, &island, stack, stackSize);
 
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
-		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			b2Assert(b->IsActive() == true);
-			island.Add(b);
-
-			// Make sure the body is awake.
-			b->SetAwake(true);
+		b2Profile profile;
+		island.Solve(&profile, step, m_gravity, m_allowSleep);
+		m_profile.solveInit += profile.solveInit;
+		m_profile.solveVelocity += profile.solveVelocity;
+		m_profile.solvePosition += profile.solvePosition;
+		++m_profile.islandCount;
+		++m_profile.threadIslands[0];
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
+		// Post solve cleanup.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			// Allow static bodies to participate in other islands.
+			b2Body* b = island.m_bodies[i];
 			if (b->GetType() == b2_staticBody)
 			{
-				continue;
+				b->m_flags &= ~b2Body::e_islandFlag;
 			}
+		}
+	}
 
-			// Search all contacts connected to this body.
-			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
-			{
-				b2Contact* contact = ce->contact;
+	m_stackAllocator.Free(stack);
 
-				// Has this contact already been added to an island?
-				if (contact->m_flags & b2Contact::e_islandFlag)
-				{
-					continue;
-				}
+	m_profile.threadSolve[0] = m_profile.solveInit + m_profile.solveVelocity + m_profile.solvePosition;
+}
 
-				// Is this contact solid and touching?
-				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
-				{
-					continue;
-				}
+// An island gathered by SolveIslandsParallel, as ranges of the gathered arrays.
+struct b2IslandRange
+{
+	int32 bodyStart, bodyCount;
+	int32 contactStart, contactCount;
+	int32 jointStart, jointCount;
+};
 
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
-				{
-					continue;
-				}
+// Solves gathered islands, each thread with its own stack allocator.
+class b2IslandSolveTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		b2Timer timer;
+		b2Profile& threadProfile = profiles[threadIndex];
 
-				island.Add(contact);
-				contact->m_flags |= b2Contact::e_islandFlag;
+		for (int32 i = begin; i < end; ++i)
+		{
+			const b2IslandRange& range = ranges[i];
+			b2Island island(bodies + range.bodyStart, range.bodyCount,
+							contacts + range.contactStart, range.contactCount,
+							joints + range.jointStart, range.jointCount,
+							staticSlotCount, allocators[threadIndex], impulses + range.contactStart);
+
+			b2Profile profile;
+			island.Solve(&profile, *step, gravity, allowSleep);
+			threadProfile.solveInit += profile.solveInit;
+			threadProfile.solveVelocity += profile.solveVelocity;
+			threadProfile.solvePosition += profile.solvePosition;
+		}
 
-				b2Body* other = ce->other;
+		threadProfile.threadSolve[0] += timer.GetMilliseconds();
+		threadProfile.threadIslands[0] += end - begin;
+	}
 
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+	const b2IslandRange* ranges;
+	b2Body** bodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	b2ContactImpulse* impulses;
+	int32 staticSlotCount;
+	b2StackAllocator** allocators;
+	b2Profile* profiles;
+};
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
-			}
+// Build all the islands on this thread, then solve them on the thread pool.
+// The islands don't share anything but static bodies, which the solver only reads.
+// Sleeping and the contact impulses only depend on the island, and PostSolve is
+// replayed in the order the islands were found, so the result is the same as SolveIslands.
+void b2World::SolveIslandsParallel(const b2TimeStep& step)
+{
+	// Worst case island used to gather each island in turn.
+	b2Island island(m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					NULL);
 
-			// Search all joints connect to this body.
-			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
-			{
-				if (je->joint->m_islandFlag == true)
-				{
-					continue;
-				}
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(b2Max(m_contactManager.m_contactCount, 1) * sizeof(b2Contact*));
+	b2Joint** joints = (b2Joint**)m_stackAllocator.Allocate(b2Max(m_jointCount, 1) * sizeof(b2Joint*));
+	b2IslandRange* ranges = (b2IslandRange*)m_stackAllocator.Allocate(b2Max(m_bodyCount, 1) * sizeof(b2IslandRange));
 
-				b2Body* other = je->other;
+	// Static bodies can be in several islands, so there may be more entries than bodies.
+	int32 bodyCapacity = b2Max(m_bodyCount, 1);
+	b2Body** bodies = (b2Body**)b2Alloc(bodyCapacity * sizeof(b2Body*));
 
-				// Don't simulate joints connected to inactive bodies.
-				if (other->IsActive() == false)
-				{
-					continue;
-				}
+	int32 islandCount = 0;
+	int32 bodyCount = 0;
+	int32 contactCount = 0;
+	int32 jointCount = 0;
 
-				island.Add(je->joint);
-				je->joint->m_islandFlag = true;
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
 
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
-			}
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+		island.Clear();
+		BuildIsland(seed, &island, stack, stackSize);
 
-		// Post solve cleanup.
+		if (bodyCount + island.m_bodyCount > bodyCapacity)
+		{
+			bodyCapacity = b2Max(2 * bodyCapacity, bodyCount + island.m_bodyCount);
+			b2Body** newBodies = (b2Body**)b2Alloc(bodyCapacity * sizeof(b2Body*));
+			memcpy(newBodies, bodies, bodyCount * sizeof(b2Body*));
+			b2Free(bodies);
+			bodies = newBodies;
+		}
+
+		b2IslandRange* range = ranges + islandCount++;
+		range->bodyStart = bodyCount;
+		range->bodyCount = island.m_bodyCount;
+		range->contactStart = contactCount;
+		range->contactCount = island.m_contactCount;
+		range->jointStart = jointCount;
+		range->jointCount = island.m_jointCount;
+
+		memcpy(bodies + bodyCount, island.m_bodies, island.m_bodyCount * sizeof(b2Body*));
+		memcpy(contacts + contactCount, island.m_contacts, island.m_contactCount * sizeof(b2Contact*));
+		memcpy(joints + jointCount, island.m_joints, island.m_jointCount * sizeof(b2Joint*));
+		bodyCount += island.m_bodyCount;
+		contactCount += island.m_contactCount;
+		jointCount += island.m_jointCount;
+
+		// Allow static bodies to participate in other islands.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
 		{
-			// Allow static bodies to participate in other islands.
 			b2Body* b = island.m_bodies[i];
 			if (b->GetType() == b2_staticBody)
 			{
@@ -545,7 +741,128 @@ void b2World::Solve(const b2TimeStep& step)
 		}
 	}
 
+	// The static bodies get the first solver slots, the same in every island,
+	// the other bodies follow in island order.
+	int32 staticSlotCount = 0;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+		if (b->GetType() == b2_staticBody && (b->m_flags & b2Body::e_islandFlag) == 0)
+		{
+			b->m_flags |= b2Body::e_islandFlag;
+			b->m_islandIndex = staticSlotCount++;
+		}
+	}
+
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange& range = ranges[i];
+		for (int32 j = 0; j < range.bodyCount; ++j)
+		{
+			b2Body* b = bodies[range.bodyStart + j];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->m_flags &= ~b2Body::e_islandFlag;
+			}
+			else
+			{
+				b->m_islandIndex = staticSlotCount + j;
+			}
+		}
+	}
+
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	b2ContactImpulse* impulses = NULL;
+	if (listener)
+	{
+		impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(b2Max(contactCount, 1) * sizeof(b2ContactImpulse));
+	}
+
+	int32 threadCount = m_threadPool->GetThreadCount();
+	b2Profile profiles[b2_maxThreads];
+	memset(profiles, 0, sizeof(profiles));
+
+	b2IslandSolveTask task;
+	task.step = &step;
+	task.gravity = m_gravity;
+	task.allowSleep = m_allowSleep;
+	task.ranges = ranges;
+	task.bodies = bodies;
+	task.contacts = contacts;
+	task.joints = joints;
+	task.impulses = impulses;
+	task.staticSlotCount = staticSlotCount;
+	task.allocators = m_threadStackAllocators;
+	task.profiles = profiles;
+
+	m_threadPool->ParallelFor(&task, islandCount, 1);
+
+	m_profile.islandCount = islandCount;
+	m_profile.threadCount = threadCount;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		// The sums over the threads, like the serial solver reports them.
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
+		m_profile.threadSolve[i] = profiles[i].threadSolve[0];
+		m_profile.threadIslands[i] = profiles[i].threadIslands[0];
+	}
+
+	// Report the impulses in island order.
+	if (listener)
+	{
+		for (int32 i = 0; i < contactCount; ++i)
+		{
+			listener->PostSolve(contacts[i], impulses + i);
+		}
+
+		m_stackAllocator.Free(impulses);
+	}
+
+	b2Free(bodies);
+	m_stackAllocator.Free(ranges);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contacts);
 	m_stackAllocator.Free(stack);
+}
+
+// Find islands, integrate and solve constraints, solve position constraints
+void b2World::Solve(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
+	m_profile.solveVelocity = 0.0f;
+	m_profile.solvePosition = 0.0f;
+	m_profile.islandCount = 0;
+	m_profile.threadCount = 1;
+	for (int32 i = 0; i < b2_maxThreads; ++i)
+	{
+		m_profile.threadSolve[i] = 0.0f;
+		m_profile.threadIslands[i] = 0;
+	}
+
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
+
+	if (m_threadPool)
+	{
+		SolveIslandsParallel(step);
+	}
+	else
+	{
+		SolveIslands(step);
+	}
 
 	{
 		b2Timer timer;
@@ -860,6 +1177,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.simdContacts = false;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -923,6 +1241,7 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.simdContacts = m_simdContacts;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
@@ -1256,6 +1575,355 @@ float32 b2World::GetTreeQuality() const
 	return m_contactManager.m_broadPhase.GetTreeQuality();
 }
 
+// Snapshot layout. The structural part comes first so that RestoreSnapshot
+// can check it before anything is changed.
+// - header: magic, version, body, joint and contact counts
+// - per body: type, active flag, fixture count and the proxy count of each fixture
+// - per joint: type
+// - per contact: body index, fixture index and child index of both fixtures
+// - world flags and time step ratio
+// - per body: flags, transform, sweep, velocity, force, sleep timer and proxies
+// - per joint: b2Joint::SaveState
+// - broad-phase tree and move buffer
+// - per contact: flags, mixed material, TOI and manifold
+static const uint32 b2_snapshotMagic = 0x62325353;
+static const int32 b2_snapshotVersion = 1;
+
+// Identifies a contact by its fixtures.
+struct b2SnapshotContactKey
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	int32 indexA;
+	int32 indexB;
+};
+
+static int32 b2FixtureIndex(const b2Fixture* fixture)
+{
+	int32 index = 0;
+	for (const b2Fixture* f = fixture->GetBody()->GetFixtureList(); f != fixture; f = f->GetNext())
+	{
+		++index;
+	}
+	return index;
+}
+
+static void b2WriteManifold(b2Snapshot* snapshot, const b2Manifold& manifold)
+{
+	// An empty manifold holds stale data from earlier steps.
+	snapshot->Write(manifold.pointCount);
+	if (manifold.pointCount == 0)
+	{
+		return;
+	}
+
+	snapshot->Write(manifold.localNormal);
+	snapshot->Write(manifold.localPoint);
+	snapshot->Write(manifold.type);
+	snapshot->Write(manifold.points, manifold.pointCount * sizeof(b2ManifoldPoint));
+}
+
+static bool b2ReadManifold(b2SnapshotReader* reader, b2Manifold* manifold)
+{
+	if (reader->Read(&manifold->pointCount) == false ||
+		manifold->pointCount < 0 || manifold->pointCount > b2_maxManifoldPoints)
+	{
+		manifold->pointCount = 0;
+		return false;
+	}
+
+	if (manifold->pointCount == 0)
+	{
+		return true;
+	}
+
+	reader->Read(&manifold->localNormal);
+	reader->Read(&manifold->localPoint);
+	reader->Read(&manifold->type);
+	return reader->Read(manifold->points, manifold->pointCount * sizeof(b2ManifoldPoint));
+}
+
+void b2World::SaveSnapshot(b2Snapshot* snapshot)
+{
+	b2Assert(IsLocked() == false);
+
+	snapshot->Clear();
+	snapshot->Write(b2_snapshotMagic);
+	snapshot->Write(b2_snapshotVersion);
+	snapshot->Write(m_bodyCount);
+	snapshot->Write(m_jointCount);
+	snapshot->Write(m_contactManager.m_contactCount);
+
+	// The island index is free outside of a time step, use it to number the bodies.
+	int32 i = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_islandIndex = i;
+		++i;
+
+		int32 type = b->m_type;
+		bool active = b->IsActive();
+		snapshot->Write(type);
+		snapshot->Write(active);
+		snapshot->Write(b->m_fixtureCount);
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			snapshot->Write(f->m_proxyCount);
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		int32 type = j->m_type;
+		snapshot->Write(type);
+	}
+
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		snapshot->Write(c->m_fixtureA->m_body->m_islandIndex);
+		snapshot->Write(b2FixtureIndex(c->m_fixtureA));
+		snapshot->Write(c->m_indexA);
+		snapshot->Write(c->m_fixtureB->m_body->m_islandIndex);
+		snapshot->Write(b2FixtureIndex(c->m_fixtureB));
+		snapshot->Write(c->m_indexB);
+	}
+
+	int32 flags = m_flags & ~e_locked;
+	snapshot->Write(flags);
+	snapshot->Write(m_inv_dt0);
+	snapshot->Write(m_stepComplete);
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		snapshot->Write(b->m_flags);
+		snapshot->Write(b->m_xf);
+		snapshot->Write(b->m_sweep);
+		snapshot->Write(b->m_linearVelocity);
+		snapshot->Write(b->m_angularVelocity);
+		snapshot->Write(b->m_force);
+		snapshot->Write(b->m_torque);
+		snapshot->Write(b->m_sleepTime);
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 k = 0; k < f->m_proxyCount; ++k)
+			{
+				snapshot->Write(f->m_proxies[k].aabb);
+				snapshot->Write(f->m_proxies[k].proxyId);
+			}
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->SaveState(snapshot);
+	}
+
+	m_contactManager.m_broadPhase.SaveState(snapshot);
+
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		snapshot->Write(c->m_flags);
+		snapshot->Write(c->m_friction);
+		snapshot->Write(c->m_restitution);
+		snapshot->Write(c->m_toiCount);
+		snapshot->Write(c->m_toi);
+		b2WriteManifold(snapshot, c->m_manifold);
+	}
+}
+
+bool b2World::RestoreSnapshot(const b2Snapshot* snapshot)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return false;
+	}
+
+	b2SnapshotReader reader(snapshot);
+
+	uint32 magic;
+	int32 version, bodyCount, jointCount, contactCount;
+	reader.Read(&magic);
+	reader.Read(&version);
+	reader.Read(&bodyCount);
+	reader.Read(&jointCount);
+	reader.Read(&contactCount);
+	if (magic != b2_snapshotMagic || version != b2_snapshotVersion ||
+		bodyCount != m_bodyCount || jointCount != m_jointCount || contactCount < 0)
+	{
+		return false;
+	}
+
+	// Check the structure before changing anything.
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(b2Max(m_bodyCount, 1) * sizeof(b2Body*));
+	b2SnapshotContactKey* keys = (b2SnapshotContactKey*)m_stackAllocator.Allocate(b2Max(contactCount, 1) * sizeof(b2SnapshotContactKey));
+
+	bool match = true;
+	int32 i = 0;
+	for (b2Body* b = m_bodyList; b && match; b = b->m_next)
+	{
+		bodies[i] = b;
+		++i;
+
+		int32 type, fixtureCount;
+		bool active;
+		reader.Read(&type);
+		reader.Read(&active);
+		reader.Read(&fixtureCount);
+		match = type == b->m_type && active == b->IsActive() && fixtureCount == b->m_fixtureCount;
+		for (b2Fixture* f = b->m_fixtureList; f && match; f = f->m_next)
+		{
+			int32 proxyCount;
+			reader.Read(&proxyCount);
+			match = proxyCount == f->m_proxyCount;
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j && match; j = j->m_next)
+	{
+		int32 type;
+		reader.Read(&type);
+		match = type == j->m_type;
+	}
+
+	for (i = 0; i < contactCount && match; ++i)
+	{
+		b2Fixture* fixtures[2] = {NULL, NULL};
+		int32 children[2];
+		for (int32 side = 0; side < 2; ++side)
+		{
+			int32 bodyIndex, fixtureIndex;
+			reader.Read(&bodyIndex);
+			reader.Read(&fixtureIndex);
+			reader.Read(&children[side]);
+			if (bodyIndex < 0 || bodyIndex >= m_bodyCount)
+			{
+				break;
+			}
+
+			b2Fixture* f = bodies[bodyIndex]->m_fixtureList;
+			for (int32 k = 0; k < fixtureIndex && f; ++k)
+			{
+				f = f->m_next;
+			}
+
+			if (fixtureIndex < 0 || f == NULL || children[side] < 0 || children[side] >= f->m_proxyCount)
+			{
+				break;
+			}
+
+			fixtures[side] = f;
+		}
+
+		match = fixtures[0] != NULL && fixtures[1] != NULL && fixtures[0]->m_body != fixtures[1]->m_body;
+		keys[i].fixtureA = fixtures[0];
+		keys[i].indexA = children[0];
+		keys[i].fixtureB = fixtures[1];
+		keys[i].indexB = children[1];
+	}
+
+	if (match == false || reader.IsAtEnd())
+	{
+		m_stackAllocator.Free(keys);
+		m_stackAllocator.Free(bodies);
+		return false;
+	}
+
+	// Rewinding a few steps usually finds the same contacts, keep them then.
+	// This comes first because destroying a contact wakes its bodies.
+	bool sameContacts = contactCount == m_contactManager.m_contactCount;
+	i = 0;
+	for (b2Contact* c = m_contactManager.m_contactList; c && sameContacts; c = c->m_next)
+	{
+		const b2SnapshotContactKey* key = keys + i;
+		sameContacts = c->m_fixtureA == key->fixtureA && c->m_indexA == key->indexA &&
+			c->m_fixtureB == key->fixtureB && c->m_indexB == key->indexB;
+		++i;
+	}
+
+	if (sameContacts == false)
+	{
+		// Remove the contacts quietly, the listener didn't see them end.
+		b2ContactListener* listener = m_contactManager.m_contactListener;
+		m_contactManager.m_contactListener = NULL;
+		while (m_contactManager.m_contactList)
+		{
+			m_contactManager.Destroy(m_contactManager.m_contactList);
+		}
+		m_contactManager.m_contactListener = listener;
+
+		// The world and body contact lists are prepended to, so inserting
+		// in reverse restores the order of all of them.
+		for (i = contactCount - 1; i >= 0; --i)
+		{
+			const b2SnapshotContactKey* key = keys + i;
+			b2Contact* c = b2Contact::Create(key->fixtureA, key->indexA, key->fixtureB, key->indexB, &m_blockAllocator);
+			b2Assert(c != NULL && c->m_fixtureA == key->fixtureA);
+			m_contactManager.Insert(c);
+		}
+	}
+
+	reader.Read(&m_flags);
+	reader.Read(&m_inv_dt0);
+	reader.Read(&m_stepComplete);
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		reader.Read(&b->m_flags);
+		reader.Read(&b->m_xf);
+		reader.Read(&b->m_sweep);
+		reader.Read(&b->m_linearVelocity);
+		reader.Read(&b->m_angularVelocity);
+		reader.Read(&b->m_force);
+		reader.Read(&b->m_torque);
+		reader.Read(&b->m_sleepTime);
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 k = 0; k < f->m_proxyCount; ++k)
+			{
+				reader.Read(&f->m_proxies[k].aabb);
+				reader.Read(&f->m_proxies[k].proxyId);
+			}
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->RestoreState(&reader);
+	}
+
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	bool valid = broadPhase->RestoreState(&reader);
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			for (int32 k = 0; k < f->m_proxyCount; ++k)
+			{
+				broadPhase->SetUserData(f->m_proxies[k].proxyId, f->m_proxies + k);
+			}
+		}
+	}
+
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		reader.Read(&c->m_flags);
+		reader.Read(&c->m_friction);
+		reader.Read(&c->m_restitution);
+		reader.Read(&c->m_toiCount);
+		reader.Read(&c->m_toi);
+		valid = b2ReadManifold(&reader, &c->m_manifold) && valid;
+	}
+
+	m_stackAllocator.Free(keys);
+	m_stackAllocator.Free(bodies);
+
+	// The structure matched, so only a truncated snapshot ends up here.
+	valid = valid && reader.IsAtEnd();
+	b2Assert(valid);
+	return valid;
+}
+
 void b2World::Dump()
 {
 	if ((m_flags & e_locked) == e_locked)
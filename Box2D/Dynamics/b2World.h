@@ -34,6 +34,9 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2Island;
+class b2ThreadPool;
+class b2Snapshot;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -157,6 +160,39 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Enable/disable the batched contact solver. Contacts are grouped so that a group never
+	/// touches the same body twice and each group is solved b2_simdLanes at a time with SSE2
+	/// or NEON. Faster for large stacks and piles. The results differ from the sequential
+	/// solver only by the order the contacts are solved in.
+	void SetSIMDContacts(bool flag) { m_simdContacts = flag; }
+	bool GetSIMDContacts() const { return m_simdContacts; }
+
+	/// Compute the contact manifolds and solve the islands on several threads. The islands
+	/// are still found on the calling thread and the contact filter and listener still get
+	/// all their calls from it, in the same order as with one thread, so the simulation
+	/// doesn't depend on the thread count. Worth it with many contacts or many islands,
+	/// e.g. lots of separate piles of debris.
+	/// @param threadCount 1 (the default) solves everything on the calling thread,
+	/// 0 uses the number of hardware threads. At most b2_maxThreads.
+	/// @warning This function is locked during callbacks.
+	void SetThreadCount(int32 threadCount);
+	int32 GetThreadCount() const;
+
+	/// Save the simulation state: body transforms, sweeps and velocities, sleep timers,
+	/// the broad-phase tree, the contacts with their manifolds and warm starting impulses,
+	/// and the joint impulses. Stepping a restored world gives bit-identical results, e.g.
+	/// to rewind a few steps and simulate them again with corrected input. The snapshot
+	/// holds no pointers so it can be compared byte-for-byte.
+	/// @warning This function is locked during callbacks.
+	void SaveSnapshot(b2Snapshot* snapshot);
+
+	/// Restore a state saved by SaveSnapshot. The world must have the same bodies,
+	/// fixtures and joints, created in the same order, as when the snapshot was saved.
+	/// Contacts are recreated as needed without calling the contact listener.
+	/// @return false if the snapshot doesn't match the world. The world is unchanged then.
+	/// @warning This function is locked during callbacks.
+	bool RestoreSnapshot(const b2Snapshot* snapshot);
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -220,6 +256,9 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveIslands(const b2TimeStep& step);
+	void SolveIslandsParallel(const b2TimeStep& step);
+	void BuildIsland(b2Body* seed, b2Island* island, b2Body** stack, int32 stackSize);
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawJoint(b2Joint* joint);
@@ -252,10 +291,15 @@ private:
 	bool m_warmStarting;
 	bool m_continuousPhysics;
 	bool m_subStepping;
+	bool m_simdContacts;
 
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	// Parallel island solving, NULL with one thread. Thread 0 uses m_stackAllocator.
+	b2ThreadPool* m_threadPool;
+	b2StackAllocator* m_threadStackAllocators[b2_maxThreads];
 };
 
 inline b2Body* b2World::GetBodyList()
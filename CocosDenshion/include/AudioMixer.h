@@ -0,0 +1,231 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef _AUDIO_MIXER_H_
+#define _AUDIO_MIXER_H_
+
+#include "Export.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace CocosDenshion {
+
+/**
+@class          AudioClip
+@brief          decoded PCM data, stored as interleaved float samples in -1.0~1.0
+*/
+class EXPORT_DLL AudioClip
+{
+public:
+    AudioClip();
+    ~AudioClip();
+
+    /**
+    @brief Load a RIFF/WAVE file, 8/16 bit PCM or 32 bit float, mono or stereo
+    @return false if the file can't be read or the format is not supported
+    */
+    bool initWithWavFile(const char* pszFilePath);
+
+    /**
+    @brief Copy interleaved float samples
+    @param nChannels 1 or 2
+    */
+    bool initWithSamples(const float* pSamples, unsigned int nFrames, unsigned int nChannels, unsigned int nSampleRate);
+
+    const float* getSamples() const { return m_pSamples; }
+    unsigned int getFrames() const { return m_nFrames; }
+    unsigned int getChannels() const { return m_nChannels; }
+    unsigned int getSampleRate() const { return m_nSampleRate; }
+
+private:
+    AudioClip(const AudioClip&);
+    AudioClip& operator=(const AudioClip&);
+
+    float*          m_pSamples;
+    unsigned int    m_nFrames;
+    unsigned int    m_nChannels;
+    unsigned int    m_nSampleRate;
+};
+
+/**
+@class          AudioSink
+@brief          receives the interleaved stereo float output of AudioMixer
+*/
+class EXPORT_DLL AudioSink
+{
+public:
+    virtual ~AudioSink() {}
+
+    virtual bool open(unsigned int nSampleRate, unsigned int nChannels) = 0;
+    virtual void write(const float* pSamples, unsigned int nFrames) = 0;
+    virtual void close() = 0;
+};
+
+/**
+@class          NullAudioSink
+@brief          discards the mixed output, only counts the frames written
+*/
+class EXPORT_DLL NullAudioSink : public AudioSink
+{
+public:
+    NullAudioSink() : m_uFramesWritten(0) {}
+
+    virtual bool open(unsigned int nSampleRate, unsigned int nChannels) { return true; }
+    virtual void write(const float* pSamples, unsigned int nFrames) { m_uFramesWritten += nFrames; }
+    virtual void close() {}
+
+    unsigned long long getFramesWritten() const { return m_uFramesWritten; }
+
+private:
+    unsigned long long m_uFramesWritten;
+};
+
+/**
+@class          WavFileAudioSink
+@brief          writes the mixed output to a 16 bit PCM .wav file
+*/
+class EXPORT_DLL WavFileAudioSink : public AudioSink
+{
+public:
+    explicit WavFileAudioSink(const char* pszFilePath);
+    virtual ~WavFileAudioSink();
+
+    virtual bool open(unsigned int nSampleRate, unsigned int nChannels);
+    virtual void write(const float* pSamples, unsigned int nFrames);
+    /** patch the RIFF sizes and close the file */
+    virtual void close();
+
+private:
+    std::string         m_path;
+    FILE*               m_pFile;
+    unsigned int        m_nChannels;
+    unsigned int        m_uDataBytes;
+    std::vector<short>  m_pcm;
+};
+
+/**
+@class          AudioMixer
+@brief          portable software mixer
+
+Mixes any number of voices into an interleaved stereo float buffer. Each voice
+has its own volume, pan and pitch; pitch and sample rate differences are
+handled with linear resampling. The inner loops use SSE or NEON when the
+compiler targets them. The mixer is not thread safe, call it from the thread
+that owns the sink.
+*/
+class EXPORT_DLL AudioMixer
+{
+public:
+    enum
+    {
+        kOutputChannels = 2,
+        kInvalidVoice = 0
+    };
+
+    explicit AudioMixer(unsigned int nSampleRate = 44100);
+    ~AudioMixer();
+
+    static AudioMixer* sharedMixer();
+    static void purgeSharedMixer();
+
+    unsigned int getSampleRate() const { return m_nSampleRate; }
+
+    /**
+    @brief Set the sink that render() writes to, the mixer takes ownership
+    @param pSink NULL to mix into nowhere
+    */
+    void setSink(AudioSink* pSink);
+    AudioSink* getSink() const { return m_pSink; }
+
+    /**
+    @brief Start a voice playing pClip, the clip must outlive the voice
+    @param fPan -1.0 (left) ~ 1.0 (right), clamped
+    @param nBus the voice is scaled by the volume of this bus (see setBusVolume)
+    @return the voice id, kInvalidVoice if pClip is NULL
+    */
+    unsigned int play(const AudioClip* pClip, bool bLoop = false, float fVolume = 1.0f, float fPan = 0.0f, float fPitch = 1.0f, unsigned int nBus = 0);
+    void stop(unsigned int nVoice);
+    void stopAll();
+    /** stop every voice playing pClip, call it before deleting a clip */
+    void stopClip(const AudioClip* pClip);
+    void pause(unsigned int nVoice);
+    void resume(unsigned int nVoice);
+    void rewind(unsigned int nVoice);
+    bool isPlaying(unsigned int nVoice) const;
+
+    /** @param fVolume 0.0~1.0 */
+    void setVolume(unsigned int nVoice, float fVolume);
+    /** @param fPan -1.0 (left) ~ 1.0 (right) */
+    void setPan(unsigned int nVoice, float fPan);
+    /** @param fPitch playback rate, 1.0 is the original pitch */
+    void setPitch(unsigned int nVoice, float fPitch);
+
+    void setBusVolume(unsigned int nBus, float fVolume);
+    float getBusVolume(unsigned int nBus) const;
+
+    unsigned int getActiveVoiceCount() const;
+
+    /**
+    @brief Mix nFrames stereo frames into pOut, overwriting it
+    @param pOut interleaved L/R, at least nFrames * 2 floats
+    */
+    void mix(float* pOut, unsigned int nFrames);
+
+    /** mix nFrames and hand them to the sink */
+    void render(unsigned int nFrames);
+
+private:
+    enum { kMaxBuses = 4 };
+
+    struct Voice
+    {
+        unsigned int        id;
+        const AudioClip*    clip;
+        double              position;   // in source frames
+        float               volume;
+        float               pan;
+        float               pitch;
+        unsigned int        bus;
+        bool                loop;
+        bool                paused;
+    };
+
+    Voice* findVoice(unsigned int nVoice);
+    const Voice* findVoice(unsigned int nVoice) const;
+    void mixVoice(Voice& voice, float* pOut, unsigned int nFrames);
+
+    unsigned int        m_nSampleRate;
+    unsigned int        m_uNextVoiceId;
+    std::vector<Voice>  m_voices;
+    float               m_fBusVolume[kMaxBuses];
+    std::vector<float>  m_scratch;
+    std::vector<float>  m_output;
+    AudioSink*          m_pSink;
+};
+
+} // end of namespace CocosDenshion
+
+#endif // _AUDIO_MIXER_H_
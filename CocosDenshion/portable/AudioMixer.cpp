@@ -0,0 +1,761 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "AudioMixer.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CD_MIXER_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(_M_ARM)
+    #define CD_MIXER_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace CocosDenshion {
+
+//////////////////////////////////////////////////////////////////////////
+// mixing kernels
+//////////////////////////////////////////////////////////////////////////
+
+// pOut[2i] += pSrc[i] * fLeft, pOut[2i+1] += pSrc[i] * fRight
+static void mixMonoToStereo(float* pOut, const float* pSrc, unsigned int nFrames, float fLeft, float fRight)
+{
+    unsigned int i = 0;
+#if defined(CD_MIXER_SSE2)
+    __m128 gain = _mm_setr_ps(fLeft, fRight, fLeft, fRight);
+    for (; i + 4 <= nFrames; i += 4)
+    {
+        __m128 s  = _mm_loadu_ps(pSrc + i);
+        __m128 lo = _mm_unpacklo_ps(s, s);
+        __m128 hi = _mm_unpackhi_ps(s, s);
+        float* o = pOut + i * 2;
+        _mm_storeu_ps(o,     _mm_add_ps(_mm_loadu_ps(o),     _mm_mul_ps(lo, gain)));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_mul_ps(hi, gain)));
+    }
+#elif defined(CD_MIXER_NEON)
+    float gainValues[4] = { fLeft, fRight, fLeft, fRight };
+    float32x4_t gain = vld1q_f32(gainValues);
+    for (; i + 4 <= nFrames; i += 4)
+    {
+        float32x4_t s = vld1q_f32(pSrc + i);
+        float32x4x2_t z = vzipq_f32(s, s);
+        float* o = pOut + i * 2;
+        vst1q_f32(o,     vmlaq_f32(vld1q_f32(o),     z.val[0], gain));
+        vst1q_f32(o + 4, vmlaq_f32(vld1q_f32(o + 4), z.val[1], gain));
+    }
+#endif
+    for (; i < nFrames; ++i)
+    {
+        pOut[i * 2]     += pSrc[i] * fLeft;
+        pOut[i * 2 + 1] += pSrc[i] * fRight;
+    }
+}
+
+// pOut[2i] += pSrc[2i] * fLeft, pOut[2i+1] += pSrc[2i+1] * fRight
+static void mixStereoToStereo(float* pOut, const float* pSrc, unsigned int nFrames, float fLeft, float fRight)
+{
+    unsigned int nSamples = nFrames * 2;
+    unsigned int i = 0;
+#if defined(CD_MIXER_SSE2)
+    __m128 gain = _mm_setr_ps(fLeft, fRight, fLeft, fRight);
+    for (; i + 4 <= nSamples; i += 4)
+    {
+        _mm_storeu_ps(pOut + i, _mm_add_ps(_mm_loadu_ps(pOut + i), _mm_mul_ps(_mm_loadu_ps(pSrc + i), gain)));
+    }
+#elif defined(CD_MIXER_NEON)
+    float gainValues[4] = { fLeft, fRight, fLeft, fRight };
+    float32x4_t gain = vld1q_f32(gainValues);
+    for (; i + 4 <= nSamples; i += 4)
+    {
+        vst1q_f32(pOut + i, vmlaq_f32(vld1q_f32(pOut + i), vld1q_f32(pSrc + i), gain));
+    }
+#endif
+    for (; i < nSamples; i += 2)
+    {
+        pOut[i]     += pSrc[i] * fLeft;
+        pOut[i + 1] += pSrc[i + 1] * fRight;
+    }
+}
+
+// clamp to -1.0~1.0 and convert to signed 16 bit, truncating toward zero in
+// every path so that a sample converts the same wherever it falls in the buffer
+static void convertToPCM16(short* pOut, const float* pSrc, unsigned int nSamples)
+{
+    unsigned int i = 0;
+#if defined(CD_MIXER_SSE2)
+    __m128 scale = _mm_set1_ps(32767.0f);
+    __m128 lo = _mm_set1_ps(-1.0f);
+    __m128 hi = _mm_set1_ps(1.0f);
+    for (; i + 8 <= nSamples; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSrc + i), lo), hi), scale);
+        __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSrc + i + 4), lo), hi), scale);
+        _mm_storeu_si128((__m128i*)(pOut + i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+    }
+#elif defined(CD_MIXER_NEON)
+    float32x4_t scale = vdupq_n_f32(32767.0f);
+    float32x4_t lo = vdupq_n_f32(-1.0f);
+    float32x4_t hi = vdupq_n_f32(1.0f);
+    for (; i + 4 <= nSamples; i += 4)
+    {
+        float32x4_t a = vmulq_f32(vminq_f32(vmaxq_f32(vld1q_f32(pSrc + i), lo), hi), scale);
+        vst1_s16(pOut + i, vqmovn_s32(vcvtq_s32_f32(a)));
+    }
+#endif
+    for (; i < nSamples; ++i)
+    {
+        float s = pSrc[i];
+        s = s < -1.0f ? -1.0f : (s > 1.0f ? 1.0f : s);
+        pOut[i] = (short)(s * 32767.0f);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// AudioClip
+//////////////////////////////////////////////////////////////////////////
+
+static unsigned int readLE32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static unsigned short readLE16(const unsigned char* p)
+{
+    return (unsigned short)(p[0] | (p[1] << 8));
+}
+
+AudioClip::AudioClip()
+: m_pSamples(NULL)
+, m_nFrames(0)
+, m_nChannels(0)
+, m_nSampleRate(0)
+{
+}
+
+AudioClip::~AudioClip()
+{
+    delete [] m_pSamples;
+}
+
+bool AudioClip::initWithSamples(const float* pSamples, unsigned int nFrames, unsigned int nChannels, unsigned int nSampleRate)
+{
+    if (! pSamples || ! nFrames || nChannels < 1 || nChannels > 2 || ! nSampleRate)
+    {
+        return false;
+    }
+
+    delete [] m_pSamples;
+    m_pSamples = new float[nFrames * nChannels];
+    memcpy(m_pSamples, pSamples, nFrames * nChannels * sizeof(float));
+    m_nFrames = nFrames;
+    m_nChannels = nChannels;
+    m_nSampleRate = nSampleRate;
+
+    return true;
+}
+
+bool AudioClip::initWithWavFile(const char* pszFilePath)
+{
+    FILE* fp = pszFilePath ? fopen(pszFilePath, "rb") : NULL;
+    if (! fp)
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> data;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size > 12)
+    {
+        data.resize(size);
+        if (fread(&data[0], 1, size, fp) != (size_t)size)
+        {
+            data.clear();
+        }
+    }
+    fclose(fp);
+
+    if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) || memcmp(&data[8], "WAVE", 4))
+    {
+        return false;
+    }
+
+    unsigned short format = 0, channels = 0, bits = 0;
+    unsigned int sampleRate = 0;
+    const unsigned char* pcm = NULL;
+    unsigned int pcmBytes = 0;
+
+    // walk the chunks, "fmt " has to come before "data"
+    size_t offset = 12;
+    while (offset + 8 <= data.size())
+    {
+        const unsigned char* chunk = &data[offset];
+        unsigned int chunkSize = readLE32(chunk + 4);
+        if (chunkSize > data.size() - offset - 8)
+        {
+            chunkSize = (unsigned int)(data.size() - offset - 8);
+        }
+
+        if (! memcmp(chunk, "fmt ", 4) && chunkSize >= 16)
+        {
+            format = readLE16(chunk + 8);
+            channels = readLE16(chunk + 10);
+            sampleRate = readLE32(chunk + 12);
+            bits = readLE16(chunk + 22);
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub format guid
+            if (format == 0xFFFE && chunkSize >= 40)
+            {
+                format = readLE16(chunk + 32);
+            }
+        }
+        else if (! memcmp(chunk, "data", 4) && format)
+        {
+            pcm = chunk + 8;
+            pcmBytes = chunkSize;
+            break;
+        }
+
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    bool supported = (format == 1 && (bits == 8 || bits == 16))     // PCM
+                  || (format == 3 && bits == 32);                   // IEEE float
+    if (! pcm || ! supported || channels < 1 || channels > 2 || ! sampleRate)
+    {
+        return false;
+    }
+
+    unsigned int frames = pcmBytes / (channels * (bits / 8));
+    if (! frames)
+    {
+        return false;
+    }
+
+    delete [] m_pSamples;
+    m_pSamples = new float[frames * channels];
+    m_nFrames = frames;
+    m_nChannels = channels;
+    m_nSampleRate = sampleRate;
+
+    unsigned int count = frames * channels;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        switch (bits)
+        {
+        case 8:
+            m_pSamples[i] = (pcm[i] - 128) / 128.0f;
+            break;
+        case 16:
+            m_pSamples[i] = (short)readLE16(pcm + i * 2) / 32768.0f;
+            break;
+        default:
+            {
+                unsigned int raw = readLE32(pcm + i * 4);
+                memcpy(&m_pSamples[i], &raw, sizeof(float));
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// WavFileAudioSink
+//////////////////////////////////////////////////////////////////////////
+
+static void writeLE32(FILE* fp, unsigned int v)
+{
+    unsigned char b[4] = { (unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+    fwrite(b, 1, 4, fp);
+}
+
+static void writeLE16(FILE* fp, unsigned short v)
+{
+    unsigned char b[2] = { (unsigned char)v, (unsigned char)(v >> 8) };
+    fwrite(b, 1, 2, fp);
+}
+
+WavFileAudioSink::WavFileAudioSink(const char* pszFilePath)
+: m_path(pszFilePath ? pszFilePath : "")
+, m_pFile(NULL)
+, m_nChannels(0)
+, m_uDataBytes(0)
+{
+}
+
+WavFileAudioSink::~WavFileAudioSink()
+{
+    close();
+}
+
+bool WavFileAudioSink::open(unsigned int nSampleRate, unsigned int nChannels)
+{
+    close();
+
+    m_pFile = fopen(m_path.c_str(), "wb");
+    if (! m_pFile)
+    {
+        return false;
+    }
+
+    m_nChannels = nChannels;
+    m_uDataBytes = 0;
+
+    // sizes are patched in close()
+    fwrite("RIFF", 1, 4, m_pFile);
+    writeLE32(m_pFile, 0);
+    fwrite("WAVEfmt ", 1, 8, m_pFile);
+    writeLE32(m_pFile, 16);
+    writeLE16(m_pFile, 1);
+    writeLE16(m_pFile, (unsigned short)nChannels);
+    writeLE32(m_pFile, nSampleRate);
+    writeLE32(m_pFile, nSampleRate * nChannels * 2);
+    writeLE16(m_pFile, (unsigned short)(nChannels * 2));
+    writeLE16(m_pFile, 16);
+    fwrite("data", 1, 4, m_pFile);
+    writeLE32(m_pFile, 0);
+
+    return true;
+}
+
+void WavFileAudioSink::write(const float* pSamples, unsigned int nFrames)
+{
+    if (! m_pFile || ! nFrames)
+    {
+        return;
+    }
+
+    unsigned int count = nFrames * m_nChannels;
+    if (m_pcm.size() < count)
+    {
+        m_pcm.resize(count);
+    }
+    convertToPCM16(&m_pcm[0], pSamples, count);
+
+    // the file is little endian, as is every platform we ship on
+    fwrite(&m_pcm[0], sizeof(short), count, m_pFile);
+    m_uDataBytes += count * sizeof(short);
+}
+
+void WavFileAudioSink::close()
+{
+    if (! m_pFile)
+    {
+        return;
+    }
+
+    fseek(m_pFile, 4, SEEK_SET);
+    writeLE32(m_pFile, 36 + m_uDataBytes);
+    fseek(m_pFile, 40, SEEK_SET);
+    writeLE32(m_pFile, m_uDataBytes);
+    fclose(m_pFile);
+    m_pFile = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// AudioMixer
+//////////////////////////////////////////////////////////////////////////
+
+static AudioMixer* s_pSharedMixer = NULL;
+
+AudioMixer* AudioMixer::sharedMixer()
+{
+    if (! s_pSharedMixer)
+    {
+        s_pSharedMixer = new AudioMixer();
+    }
+    return s_pSharedMixer;
+}
+
+void AudioMixer::purgeSharedMixer()
+{
+    delete s_pSharedMixer;
+    s_pSharedMixer = NULL;
+}
+
+AudioMixer::AudioMixer(unsigned int nSampleRate)
+: m_nSampleRate(nSampleRate)
+, m_uNextVoiceId(kInvalidVoice + 1)
+, m_pSink(NULL)
+{
+    for (int i = 0; i < kMaxBuses; ++i)
+    {
+        m_fBusVolume[i] = 1.0f;
+    }
+}
+
+AudioMixer::~AudioMixer()
+{
+    setSink(NULL);
+}
+
+void AudioMixer::setSink(AudioSink* pSink)
+{
+    if (m_pSink == pSink)
+    {
+        return;
+    }
+
+    if (m_pSink)
+    {
+        m_pSink->close();
+        delete m_pSink;
+    }
+
+    m_pSink = pSink;
+    if (m_pSink && ! m_pSink->open(m_nSampleRate, kOutputChannels))
+    {
+        delete m_pSink;
+        m_pSink = NULL;
+    }
+}
+
+AudioMixer::Voice* AudioMixer::findVoice(unsigned int nVoice)
+{
+    for (size_t i = 0; i < m_voices.size(); ++i)
+    {
+        if (m_voices[i].id == nVoice)
+        {
+            return &m_voices[i];
+        }
+    }
+    return NULL;
+}
+
+const AudioMixer::Voice* AudioMixer::findVoice(unsigned int nVoice) const
+{
+    return const_cast<AudioMixer*>(this)->findVoice(nVoice);
+}
+
+unsigned int AudioMixer::play(const AudioClip* pClip, bool bLoop, float fVolume, float fPan, float fPitch, unsigned int nBus)
+{
+    if (! pClip || ! pClip->getFrames())
+    {
+        return kInvalidVoice;
+    }
+
+    Voice voice;
+    voice.id = m_uNextVoiceId++;
+    if (m_uNextVoiceId == kInvalidVoice)
+    {
+        m_uNextVoiceId = kInvalidVoice + 1;
+    }
+    voice.clip = pClip;
+    voice.position = 0.0;
+    voice.volume = fVolume;
+    voice.pan = fPan < -1.0f ? -1.0f : (fPan > 1.0f ? 1.0f : fPan);
+    voice.pitch = fPitch > 0.0f ? fPitch : 1.0f;
+    voice.bus = nBus < kMaxBuses ? nBus : 0;
+    voice.loop = bLoop;
+    voice.paused = false;
+    m_voices.push_back(voice);
+
+    return voice.id;
+}
+
+void AudioMixer::stop(unsigned int nVoice)
+{
+    for (size_t i = 0; i < m_voices.size(); ++i)
+    {
+        if (m_voices[i].id == nVoice)
+        {
+            m_voices.erase(m_voices.begin() + i);
+            return;
+        }
+    }
+}
+
+void AudioMixer::stopAll()
+{
+    m_voices.clear();
+}
+
+void AudioMixer::stopClip(const AudioClip* pClip)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < m_voices.size(); ++i)
+    {
+        if (m_voices[i].clip != pClip)
+        {
+            m_voices[n++] = m_voices[i];
+        }
+    }
+    m_voices.resize(n);
+}
+
+void AudioMixer::pause(unsigned int nVoice)
+{
+    Voice* pVoice = findVoice(nVoice);
+    if (pVoice)
+    {
+        pVoice->paused = true;
+    }
+}
+
+void AudioMixer::resume(unsigned int nVoice)
+{
+    Voice* pVoice = findVoice(nVoice);
+    if (pVoice)
+    {
+        pVoice->paused = false;
+    }
+}
+
+void AudioMixer::rewind(unsigned int nVoice)
+{
+    Voice* pVoice = findVoice(nVoice);
+    if (pVoice)
+    {
+        pVoice->position = 0.0;
+        pVoice->paused = false;
+    }
+}
+
+bool AudioMixer::isPlaying(unsigned int nVoice) const
+{
+    const Voice* pVoice = findVoice(nVoice);
+    return pVoice && ! pVoice->paused;
+}
+
+void AudioMixer::setVolume(unsigned int nVoice, float fVolume)
+{
+    Voice* pVoice = findVoice(nVoice);
+    if (pVoice)
+    {
+        pVoice->volume = fVolume;
+    }
+}
+
+void AudioMixer::setPan(unsigned int nVoice, float fPan)
+{
+    Voice* pVoice = findVoice(nVoice);
+    if (pVoice)
+    {
+        pVoice->pan = fPan < -1.0f ? -1.0f : (fPan > 1.0f ? 1.0f : fPan);
+    }
+}
+
+void AudioMixer::setPitch(unsigned int nVoice, float fPitch)
+{
+    Voice* pVoice = findVoice(nVoice);
+    if (pVoice && fPitch > 0.0f)
+    {
+        pVoice->pitch = fPitch;
+    }
+}
+
+void AudioMixer::setBusVolume(unsigned int nBus, float fVolume)
+{
+    if (nBus < kMaxBuses)
+    {
+        m_fBusVolume[nBus] = fVolume;
+    }
+}
+
+float AudioMixer::getBusVolume(unsigned int nBus) const
+{
+    return nBus < kMaxBuses ? m_fBusVolume[nBus] : 0.0f;
+}
+
+unsigned int AudioMixer::getActiveVoiceCount() const
+{
+    unsigned int count = 0;
+    for (size_t i = 0; i < m_voices.size(); ++i)
+    {
+        if (! m_voices[i].paused)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void AudioMixer::mix(float* pOut, unsigned int nFrames)
+{
+    memset(pOut, 0, nFrames * kOutputChannels * sizeof(float));
+
+    size_t n = 0;
+    for (size_t i = 0; i < m_voices.size(); ++i)
+    {
+        Voice& voice = m_voices[i];
+        if (! voice.paused)
+        {
+            mixVoice(voice, pOut, nFrames);
+        }
+
+        // mixVoice clears the clip of a voice that ran off its end
+        if (voice.clip)
+        {
+            if (n != i)
+            {
+                m_voices[n] = voice;
+            }
+            ++n;
+        }
+    }
+    m_voices.resize(n);
+}
+
+void AudioMixer::mixVoice(Voice& voice, float* pOut, unsigned int nFrames)
+{
+    const AudioClip* pClip = voice.clip;
+    const float* pSrc = pClip->getSamples();
+    const unsigned int nChannels = pClip->getChannels();
+    const unsigned int nClipFrames = pClip->getFrames();
+
+    float gain = voice.volume * m_fBusVolume[voice.bus];
+    float fLeft  = gain * (voice.pan > 0.0f ? 1.0f - voice.pan : 1.0f);
+    float fRight = gain * (voice.pan < 0.0f ? 1.0f + voice.pan : 1.0f);
+
+    double step = (double)voice.pitch * pClip->getSampleRate() / m_nSampleRate;
+    double pos = voice.position;
+
+    // same rate, no pitch shift and on a sample boundary: mix straight from the clip
+    if (step == 1.0 && pos == floor(pos))
+    {
+        unsigned int done = 0;
+        while (done < nFrames)
+        {
+            unsigned int start = (unsigned int)pos;
+            if (start >= nClipFrames)
+            {
+                if (! voice.loop)
+                {
+                    voice.clip = NULL;
+                    return;
+                }
+                start = 0;
+            }
+
+            unsigned int count = nClipFrames - start;
+            if (count > nFrames - done)
+            {
+                count = nFrames - done;
+            }
+
+            if (nChannels == 1)
+            {
+                mixMonoToStereo(pOut + done * 2, pSrc + start, count, fLeft, fRight);
+            }
+            else
+            {
+                mixStereoToStereo(pOut + done * 2, pSrc + start * 2, count, fLeft, fRight);
+            }
+
+            done += count;
+            pos = start + count;
+        }
+
+        if (pos >= nClipFrames && ! voice.loop)
+        {
+            voice.clip = NULL;
+            return;
+        }
+        voice.position = pos;
+        return;
+    }
+
+    // resample into the scratch buffer with linear interpolation, then mix it
+    if (m_scratch.size() < nFrames * nChannels)
+    {
+        m_scratch.resize(nFrames * nChannels);
+    }
+    float* pDst = &m_scratch[0];
+
+    unsigned int produced = 0;
+    bool finished = false;
+    for (; produced < nFrames; ++produced)
+    {
+        if (pos >= nClipFrames)
+        {
+            if (! voice.loop)
+            {
+                finished = true;
+                break;
+            }
+            pos = fmod(pos, (double)nClipFrames);
+        }
+
+        unsigned int index = (unsigned int)pos;
+        float frac = (float)(pos - index);
+        unsigned int next = index + 1;
+        bool hasNext = true;
+        if (next >= nClipFrames)
+        {
+            next = 0;
+            hasNext = voice.loop;
+        }
+
+        for (unsigned int c = 0; c < nChannels; ++c)
+        {
+            float a = pSrc[index * nChannels + c];
+            float b = hasNext ? pSrc[next * nChannels + c] : 0.0f;
+            pDst[produced * nChannels + c] = a + (b - a) * frac;
+        }
+
+        pos += step;
+    }
+
+    if (nChannels == 1)
+    {
+        mixMonoToStereo(pOut, pDst, produced, fLeft, fRight);
+    }
+    else
+    {
+        mixStereoToStereo(pOut, pDst, produced, fLeft, fRight);
+    }
+
+    if (finished)
+    {
+        voice.clip = NULL;
+        return;
+    }
+    voice.position = pos;
+}
+
+void AudioMixer::render(unsigned int nFrames)
+{
+    if (m_output.size() < nFrames * kOutputChannels)
+    {
+        m_output.resize(nFrames * kOutputChannels);
+    }
+    if (! nFrames)
+    {
+        return;
+    }
+
+    mix(&m_output[0], nFrames);
+
+    if (m_pSink)
+    {
+        m_pSink->write(&m_output[0], nFrames);
+    }
+}
+
+} // end of namespace CocosDenshion
@@ -0,0 +1,184 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+// Checks of AudioMixer that need no audio device, run by ctest from
+// CocosDenshion/portable/CMakeLists.txt. Returns the number of failed checks.
+
+#include "AudioMixer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace CocosDenshion;
+
+static int s_nFailures = 0;
+
+#define CHECK(cond) \
+    do { if (! (cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); ++s_nFailures; } } while (0)
+
+static bool near(float a, float b)
+{
+    return fabsf(a - b) < 1e-5f;
+}
+
+// a mono ramp, distinct values so that misplaced samples show
+static void makeRamp(AudioClip& clip, unsigned int nFrames, unsigned int nSampleRate)
+{
+    std::vector<float> samples(nFrames);
+    for (unsigned int i = 0; i < nFrames; ++i)
+    {
+        samples[i] = (float)(i + 1) / (nFrames + 1);
+    }
+    clip.initWithSamples(&samples[0], nFrames, 1, nSampleRate);
+}
+
+static void testPan()
+{
+    AudioClip clip;
+    makeRamp(clip, 64, 44100);
+
+    // an odd frame count goes through the SIMD loop and the scalar tail
+    const unsigned int nFrames = 37;
+    std::vector<float> out(nFrames * 2);
+
+    AudioMixer mixer(44100);
+    mixer.play(&clip, false, 0.5f, -1.0f);
+    mixer.mix(&out[0], nFrames);
+    for (unsigned int i = 0; i < nFrames; ++i)
+    {
+        CHECK(near(out[i * 2], clip.getSamples()[i] * 0.5f));
+        CHECK(out[i * 2 + 1] == 0.0f);
+    }
+
+    // out of range pans are clamped when the voice starts, not only by setPan
+    mixer.stopAll();
+    mixer.play(&clip, false, 1.0f, 5.0f);
+    mixer.mix(&out[0], nFrames);
+    for (unsigned int i = 0; i < nFrames; ++i)
+    {
+        CHECK(out[i * 2] == 0.0f);
+        CHECK(near(out[i * 2 + 1], clip.getSamples()[i]));
+    }
+}
+
+static void testVoiceLifetime()
+{
+    AudioClip clip;
+    makeRamp(clip, 10, 44100);
+
+    float out[16 * 2];
+    AudioMixer mixer(44100);
+    unsigned int nOnce = mixer.play(&clip);
+    unsigned int nLoop = mixer.play(&clip, true);
+    CHECK(nOnce != AudioMixer::kInvalidVoice && nLoop != AudioMixer::kInvalidVoice);
+    CHECK(mixer.getActiveVoiceCount() == 2);
+
+    mixer.mix(out, 16);
+    CHECK(! mixer.isPlaying(nOnce));
+    CHECK(mixer.isPlaying(nLoop));
+
+    // past the end of the clip only the looping voice plays, from the start again
+    CHECK(near(out[12 * 2], clip.getSamples()[2]));
+
+    mixer.pause(nLoop);
+    CHECK(mixer.getActiveVoiceCount() == 0);
+    mixer.mix(out, 16);
+    CHECK(out[0] == 0.0f && out[31] == 0.0f);
+
+    mixer.stop(nLoop);
+    CHECK(! mixer.isPlaying(nLoop));
+    CHECK(mixer.play(NULL) == AudioMixer::kInvalidVoice);
+}
+
+static void testResampling()
+{
+    AudioClip clip;
+    makeRamp(clip, 64, 22050);
+
+    // a clip at half the output rate with a pitch of 4 advances 2 source frames per output frame
+    float out[16 * 2];
+    AudioMixer mixer(44100);
+    mixer.play(&clip, false, 1.0f, 0.0f, 4.0f);
+    mixer.mix(out, 16);
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        CHECK(near(out[i * 2], clip.getSamples()[i * 2]));
+        CHECK(near(out[i * 2 + 1], clip.getSamples()[i * 2]));
+    }
+}
+
+static void testWavRoundTrip()
+{
+    const char* pszPath = "AudioMixerTest.wav";
+
+    // 9 frames of one value put samples in the SIMD loop and in the scalar tail, which must agree
+    const unsigned int nFrames = 9;
+    float frames[nFrames * 2];
+    for (unsigned int i = 0; i < nFrames * 2; ++i)
+    {
+        frames[i] = (i & 1) ? -0.3f : 0.7f;
+    }
+    frames[0] = 2.0f;
+
+    WavFileAudioSink* pSink = new WavFileAudioSink(pszPath);
+    CHECK(pSink->open(44100, 2));
+    pSink->write(frames, nFrames);
+    pSink->close();
+    delete pSink;
+
+    AudioClip clip;
+    CHECK(clip.initWithWavFile(pszPath));
+    CHECK(clip.getChannels() == 2 && clip.getFrames() == nFrames && clip.getSampleRate() == 44100);
+    if (clip.getFrames() != nFrames)
+    {
+        return;
+    }
+
+    const float* pSamples = clip.getSamples();
+    CHECK(pSamples[0] == 32767 / 32768.0f);
+    CHECK(pSamples[2] == (short)(0.7f * 32767.0f) / 32768.0f);
+    CHECK(pSamples[3] == (short)(-0.3f * 32767.0f) / 32768.0f);
+    for (unsigned int i = 1; i < nFrames; ++i)
+    {
+        CHECK(pSamples[i * 2] == pSamples[2]);
+        CHECK(pSamples[i * 2 + 1] == pSamples[3]);
+    }
+
+    remove(pszPath);
+}
+
+int main()
+{
+    testPan();
+    testVoiceLifetime();
+    testResampling();
+    testWavRoundTrip();
+
+    if (s_nFailures)
+    {
+        printf("%d checks failed\n", s_nFailures);
+    }
+    return s_nFailures;
+}
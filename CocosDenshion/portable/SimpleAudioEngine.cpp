@@ -0,0 +1,341 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+// SimpleAudioEngine on top of the portable AudioMixer. Only .wav files are
+// decoded; the mixed output goes to whatever sink is set on
+// AudioMixer::sharedMixer() (nothing by default), one frame's worth of samples
+// per render() call.
+
+#include "SimpleAudioEngine.h"
+#include "AudioMixer.h"
+
+#include <map>
+#include <string>
+
+using namespace std;
+
+namespace CocosDenshion {
+
+enum
+{
+    kEffectsBus = 0,
+    kMusicBus = 1
+};
+
+// render() is called once per frame
+static const unsigned int kFramesPerSecond = 60;
+
+typedef map<string, AudioClip*> ClipMap;
+
+static ClipMap         s_effects;
+static AudioClip*      s_pMusic = NULL;
+static string          s_musicPath;
+static unsigned int    s_musicVoice = AudioMixer::kInvalidVoice;
+static map<unsigned int, bool> s_effectVoices;
+
+static AudioClip* loadClip(const char* pszFilePath)
+{
+    AudioClip* pClip = new AudioClip();
+    if (! pClip->initWithWavFile(pszFilePath))
+    {
+        delete pClip;
+        return NULL;
+    }
+    return pClip;
+}
+
+static AudioClip* effectClip(const char* pszFilePath)
+{
+    ClipMap::iterator it = s_effects.find(pszFilePath);
+    if (it != s_effects.end())
+    {
+        return it->second;
+    }
+
+    AudioClip* pClip = loadClip(pszFilePath);
+    if (pClip)
+    {
+        s_effects[pszFilePath] = pClip;
+    }
+    return pClip;
+}
+
+// forget the effect voices that finished on their own
+static void purgeFinishedEffects()
+{
+    AudioMixer* pMixer = AudioMixer::sharedMixer();
+    map<unsigned int, bool>::iterator it = s_effectVoices.begin();
+    while (it != s_effectVoices.end())
+    {
+        if (! pMixer->isPlaying(it->first) && ! it->second)
+        {
+            s_effectVoices.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+SimpleAudioEngine::SimpleAudioEngine()
+{
+}
+
+SimpleAudioEngine::~SimpleAudioEngine()
+{
+}
+
+SimpleAudioEngine* SimpleAudioEngine::sharedEngine()
+{
+    static SimpleAudioEngine s_SharedEngine;
+    return &s_SharedEngine;
+}
+
+void SimpleAudioEngine::end()
+{
+    AudioMixer::sharedMixer()->stopAll();
+    s_effectVoices.clear();
+    s_musicVoice = AudioMixer::kInvalidVoice;
+
+    for (ClipMap::iterator it = s_effects.begin(); it != s_effects.end(); ++it)
+    {
+        delete it->second;
+    }
+    s_effects.clear();
+
+    delete s_pMusic;
+    s_pMusic = NULL;
+    s_musicPath.clear();
+
+    AudioMixer::purgeSharedMixer();
+}
+
+void SimpleAudioEngine::setResource(const char* pszZipFileName)
+{
+}
+
+void SimpleAudioEngine::render()
+{
+    AudioMixer* pMixer = AudioMixer::sharedMixer();
+    pMixer->render(pMixer->getSampleRate() / kFramesPerSecond);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// BackgroundMusic
+//////////////////////////////////////////////////////////////////////////
+
+void SimpleAudioEngine::preloadBackgroundMusic(const char* pszFilePath)
+{
+    if (! pszFilePath || s_musicPath == pszFilePath)
+    {
+        return;
+    }
+
+    stopBackgroundMusic(true);
+    s_pMusic = loadClip(pszFilePath);
+    if (s_pMusic)
+    {
+        s_musicPath = pszFilePath;
+    }
+}
+
+void SimpleAudioEngine::playBackgroundMusic(const char* pszFilePath, bool bLoop)
+{
+    if (! pszFilePath)
+    {
+        return;
+    }
+
+    preloadBackgroundMusic(pszFilePath);
+
+    AudioMixer* pMixer = AudioMixer::sharedMixer();
+    pMixer->stop(s_musicVoice);
+    s_musicVoice = pMixer->play(s_pMusic, bLoop, 1.0f, 0.0f, 1.0f, kMusicBus);
+}
+
+void SimpleAudioEngine::stopBackgroundMusic(bool bReleaseData)
+{
+    AudioMixer::sharedMixer()->stop(s_musicVoice);
+    s_musicVoice = AudioMixer::kInvalidVoice;
+
+    if (bReleaseData)
+    {
+        delete s_pMusic;
+        s_pMusic = NULL;
+        s_musicPath.clear();
+    }
+}
+
+void SimpleAudioEngine::pauseBackgroundMusic()
+{
+    AudioMixer::sharedMixer()->pause(s_musicVoice);
+}
+
+void SimpleAudioEngine::resumeBackgroundMusic()
+{
+    AudioMixer::sharedMixer()->resume(s_musicVoice);
+}
+
+void SimpleAudioEngine::rewindBackgroundMusic()
+{
+    AudioMixer::sharedMixer()->rewind(s_musicVoice);
+}
+
+bool SimpleAudioEngine::willPlayBackgroundMusic()
+{
+    return s_pMusic != NULL;
+}
+
+bool SimpleAudioEngine::isBackgroundMusicPlaying()
+{
+    return AudioMixer::sharedMixer()->isPlaying(s_musicVoice);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// effect function
+//////////////////////////////////////////////////////////////////////////
+
+unsigned int SimpleAudioEngine::playEffect(const char* pszFilePath, bool bLoop)
+{
+    if (! pszFilePath)
+    {
+        return AudioMixer::kInvalidVoice;
+    }
+
+    purgeFinishedEffects();
+
+    unsigned int nVoice = AudioMixer::sharedMixer()->play(effectClip(pszFilePath), bLoop, 1.0f, 0.0f, 1.0f, kEffectsBus);
+    if (nVoice != AudioMixer::kInvalidVoice)
+    {
+        s_effectVoices[nVoice] = false;
+    }
+    return nVoice;
+}
+
+void SimpleAudioEngine::stopEffect(unsigned int nSoundId)
+{
+    AudioMixer::sharedMixer()->stop(nSoundId);
+    s_effectVoices.erase(nSoundId);
+}
+
+void SimpleAudioEngine::preloadEffect(const char* pszFilePath)
+{
+    if (pszFilePath)
+    {
+        effectClip(pszFilePath);
+    }
+}
+
+void SimpleAudioEngine::pauseEffect(unsigned int nSoundId)
+{
+    map<unsigned int, bool>::iterator it = s_effectVoices.find(nSoundId);
+    if (it != s_effectVoices.end())
+    {
+        AudioMixer::sharedMixer()->pause(nSoundId);
+        it->second = true;
+    }
+}
+
+void SimpleAudioEngine::resumeEffect(unsigned int nSoundId)
+{
+    map<unsigned int, bool>::iterator it = s_effectVoices.find(nSoundId);
+    if (it != s_effectVoices.end())
+    {
+        AudioMixer::sharedMixer()->resume(nSoundId);
+        it->second = false;
+    }
+}
+
+void SimpleAudioEngine::pauseAllEffects()
+{
+    for (map<unsigned int, bool>::iterator it = s_effectVoices.begin(); it != s_effectVoices.end(); ++it)
+    {
+        AudioMixer::sharedMixer()->pause(it->first);
+        it->second = true;
+    }
+}
+
+void SimpleAudioEngine::resumeAllEffects()
+{
+    for (map<unsigned int, bool>::iterator it = s_effectVoices.begin(); it != s_effectVoices.end(); ++it)
+    {
+        AudioMixer::sharedMixer()->resume(it->first);
+        it->second = false;
+    }
+}
+
+void SimpleAudioEngine::stopAllEffects()
+{
+    for (map<unsigned int, bool>::iterator it = s_effectVoices.begin(); it != s_effectVoices.end(); ++it)
+    {
+        AudioMixer::sharedMixer()->stop(it->first);
+    }
+    s_effectVoices.clear();
+}
+
+void SimpleAudioEngine::unloadEffect(const char* pszFilePath)
+{
+    if (! pszFilePath)
+    {
+        return;
+    }
+
+    ClipMap::iterator it = s_effects.find(pszFilePath);
+    if (it != s_effects.end())
+    {
+        AudioMixer::sharedMixer()->stopClip(it->second);
+        purgeFinishedEffects();
+        delete it->second;
+        s_effects.erase(it);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// volume interface
+//////////////////////////////////////////////////////////////////////////
+
+float SimpleAudioEngine::getBackgroundMusicVolume()
+{
+    return AudioMixer::sharedMixer()->getBusVolume(kMusicBus);
+}
+
+void SimpleAudioEngine::setBackgroundMusicVolume(float volume)
+{
+    volume = volume < 0.0f ? 0.0f : (volume > 1.0f ? 1.0f : volume);
+    AudioMixer::sharedMixer()->setBusVolume(kMusicBus, volume);
+}
+
+float SimpleAudioEngine::getEffectsVolume()
+{
+    return AudioMixer::sharedMixer()->getBusVolume(kEffectsBus);
+}
+
+void SimpleAudioEngine::setEffectsVolume(float volume)
+{
+    volume = volume < 0.0f ? 0.0f : (volume > 1.0f ? 1.0f : volume);
+    AudioMixer::sharedMixer()->setBusVolume(kEffectsBus, volume);
+}
+
+} // end of namespace CocosDenshion
@@ -0,0 +1,81 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// The bounding box tree is one of the spatial index types. (see cpSpatialIndex.h)
+// It's a binary tree of bounding boxes with the objects in the leaves.
+// Unlike the spatial hash it doesn't need to be tuned for the size of the objects,
+// so it handles scenes that mix very large and very small objects well.
+
+// A dynamic tree stores fattened bounding boxes in its leaves. A leaf is only moved
+// in the tree once the object's bounding box escapes the fattened one.
+// A static tree (margin of 0) keeps the boxes tight.
+
+// Velocity callback. Used to fatten the bounding boxes in the direction the objects move.
+typedef cpVect (*cpBBTreeVelocityFunc)(void *obj);
+
+// Leaves hold an object, branches hold two children.
+typedef struct cpBBTreeNode {
+	// NULL for branches.
+	CP_PRIVATE(void *obj);
+	CP_PRIVATE(cpBB bb);
+	
+	// Also links the recycled nodes.
+	CP_PRIVATE(struct cpBBTreeNode *parent);
+	CP_PRIVATE(struct cpBBTreeNode *a);
+	CP_PRIVATE(struct cpBBTreeNode *b);
+} cpBBTreeNode;
+
+typedef struct cpBBTree {
+	// The tree is a cpSpatialIndex, holds the bbfunc.
+	CP_PRIVATE(cpSpatialIndex spatialIndex);
+	
+	// How much the leaf bounding boxes are grown, as a fraction of their size.
+	CP_PRIVATE(cpFloat margin);
+	// Optional, grows the bounding boxes along the velocity of the objects.
+	CP_PRIVATE(cpBBTreeVelocityFunc velocityFunc);
+	
+	// Maps the objects to their leaves.
+	CP_PRIVATE(cpHashSet *leaves);
+	CP_PRIVATE(cpBBTreeNode *root);
+	
+	// Recycled nodes and the buffers to free on destruction.
+	CP_PRIVATE(cpBBTreeNode *pooledNodes);
+	CP_PRIVATE(cpArray *allocatedBuffers);
+} cpBBTree;
+
+// Basic allocation/destruction functions.
+// Pass a margin of 0 for a static tree, 0.1 is a good value for moving objects.
+cpBBTree *cpBBTreeAlloc(void);
+cpBBTree *cpBBTreeInit(cpBBTree *tree, cpSpatialIndexBBFunc bbfunc, cpFloat margin);
+cpBBTree *cpBBTreeNew(cpSpatialIndexBBFunc bbfunc, cpFloat margin);
+
+void cpBBTreeDestroy(cpBBTree *tree);
+void cpBBTreeFree(cpBBTree *tree);
+
+// Returns the index as a cpBBTree or NULL if it's another type of spatial index.
+cpBBTree *cpBBTreeFromIndex(cpSpatialIndex *index);
+
+void cpBBTreeSetVelocityFunc(cpBBTree *tree, cpBBTreeVelocityFunc func);
+
+// Rebuild the tree from the top down.
+// Gives a better tree than inserting the objects one by one, use it after adding many static objects.
+// cpSpatialIndexReindex() calls it.
+void cpBBTreeOptimize(cpBBTree *tree);
@@ -96,6 +96,9 @@ typedef struct cpBody{
 	
 	// Used by cpSpaceStep() to store contact graph information.
 	CP_PRIVATE(cpComponentNode node);
+	
+	// Colors already used by the body's contacts and constraints in the batched solver.
+	CP_PRIVATE(unsigned int solverColors);
 } cpBody;
 
 // Basic allocation/destruction functions
@@ -81,9 +81,10 @@ typedef struct cpSpace{
 	// Time stamp. Is incremented on every call to cpSpaceStep().
 	CP_PRIVATE(cpTimestamp stamp);
 
-	// The static and active shape spatial hashes.
-	CP_PRIVATE(cpSpaceHash *staticShapes);
-	CP_PRIVATE(cpSpaceHash *activeShapes);
+	// The static and active shape spatial indexes.
+	// Bounding box trees unless cpSpaceUseSpatialHash() was called.
+	CP_PRIVATE(cpSpatialIndex *staticShapes);
+	CP_PRIVATE(cpSpatialIndex *activeShapes);
 	
 	// List of bodies in the system.
 	CP_PRIVATE(cpArray *bodies);
@@ -120,6 +121,9 @@ typedef struct cpSpace{
 	
 	CP_PRIVATE(cpHashSet *postStepCallbacks);
 	
+	// Batched solver, NULL when using the serial one.
+	CP_PRIVATE(struct cpSolver *solver);
+	
 	cpBody staticBody;
 } cpSpace;
 
@@ -197,12 +201,29 @@ void cpSpaceActivateShapesTouchingShape(cpSpace *space, cpShape *shape);
 typedef void (*cpSpaceBodyIterator)(cpBody *body, void *data);
 void cpSpaceEachBody(cpSpace *space, cpSpaceBodyIterator func, void *data);
 
-// Spatial hash management functions.
+// Spatial index management functions.
+// Switch the space from the default bounding box trees to spatial hashes.
+// The hashes can be faster when all the shapes are about the size of a cell (dim).
+void cpSpaceUseSpatialHash(cpSpace *space, cpFloat dim, int count);
+// These only have an effect after cpSpaceUseSpatialHash(), the trees don't need tuning.
 void cpSpaceResizeStaticHash(cpSpace *space, cpFloat dim, int count);
 void cpSpaceResizeActiveHash(cpSpace *space, cpFloat dim, int count);
 void cpSpaceRehashStatic(cpSpace *space);
 
 void cpSpaceRehashShape(cpSpace *space, cpShape *shape);
 
+// Solver management functions.
+// Switch to the batched solver. The contacts and constraints are colored into batches that
+// don't share bodies, the contacts are solved 4 at a time with SIMD instructions and the
+// batches are split between threads. (the one calling cpSpaceStep() included)
+// Contacts and constraints are solved in a different order than with the serial solver,
+// so the results are close but not identical.
+// A warning is printed when fewer threads than requested could be started.
+void cpSpaceUseBatchedSolver(cpSpace *space, int threads);
+// Threads the batched solver runs on, 0 with the serial solver.
+int cpSpaceGetSolverThreadCount(cpSpace *space);
+// Go back to the default serial solver.
+void cpSpaceUseSerialSolver(cpSpace *space);
+
 // Update the space.
 void cpSpaceStep(cpSpace *space, cpFloat dt);
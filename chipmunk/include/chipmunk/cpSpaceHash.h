@@ -19,8 +19,9 @@
  * SOFTWARE.
  */
 
-// The spatial hash is Chipmunk's default (and currently only) spatial index type.
+// The spatial hash is one of the spatial index types. (see cpSpatialIndex.h)
 // Based on a chained hash table.
+// Works best when the objects are all about the size of a cell.
 
 // Used internally to track objects added to the hash
 typedef struct cpHandle{
@@ -40,16 +41,16 @@ typedef struct cpSpaceHashBin{
 } cpSpaceHashBin;
 
 // BBox callback. Called whenever the hash needs a bounding box from an object.
-typedef cpBB (*cpSpaceHashBBFunc)(void *obj);
+typedef cpSpatialIndexBBFunc cpSpaceHashBBFunc;
 
 typedef struct cpSpaceHash{
+	// The hash is a cpSpatialIndex, holds the bbfunc.
+	CP_PRIVATE(cpSpatialIndex spatialIndex);
+	
 	// Number of cells in the table.
 	CP_PRIVATE(int numcells);
 	// Dimentions of the cells.
 	CP_PRIVATE(cpFloat celldim);
-	
-	// BBox callback.
-	CP_PRIVATE(cpSpaceHashBBFunc bbfunc);
 
 	// Hashset of the handles and the recycled ones.
 	CP_PRIVATE(cpHashSet *handleSet);
@@ -74,6 +75,9 @@ cpSpaceHash *cpSpaceHashNew(cpFloat celldim, int cells, cpSpaceHashBBFunc bbfunc
 void cpSpaceHashDestroy(cpSpaceHash *hash);
 void cpSpaceHashFree(cpSpaceHash *hash);
 
+// Returns the index as a cpSpaceHash or NULL if it's another type of spatial index.
+cpSpaceHash *cpSpaceHashFromIndex(cpSpatialIndex *index);
+
 // Resize the hashtable. (Does not rehash! You must call cpSpaceHashRehash() if needed.)
 void cpSpaceHashResize(cpSpaceHash *hash, cpFloat celldim, int numcells);
 
@@ -83,7 +87,7 @@ void cpSpaceHashInsert(cpSpaceHash *hash, void *obj, cpHashValue id, cpBB _depre
 void cpSpaceHashRemove(cpSpaceHash *hash, void *obj, cpHashValue id);
 
 // Iterator function
-typedef void (*cpSpaceHashIterator)(void *obj, void *data);
+typedef cpSpatialIndexIterator cpSpaceHashIterator;
 // Iterate over the objects in the hash.
 void cpSpaceHashEach(cpSpaceHash *hash, cpSpaceHashIterator func, void *data);
 
@@ -93,7 +97,7 @@ void cpSpaceHashRehash(cpSpaceHash *hash);
 void cpSpaceHashRehashObject(cpSpaceHash *hash, void *obj, cpHashValue id);
 
 // Query callback.
-typedef void (*cpSpaceHashQueryFunc)(void *obj1, void *obj2, void *data);
+typedef cpSpatialIndexQueryFunc cpSpaceHashQueryFunc;
 // Point query the hash. A reference to the query point is passed as obj1 to the query callback.
 void cpSpaceHashPointQuery(cpSpaceHash *hash, cpVect point, cpSpaceHashQueryFunc func, void *data);
 // Query the hash for a given BBox.
@@ -106,5 +110,5 @@ void cpSpaceHashQueryRehash(cpSpaceHash *hash, cpSpaceHashQueryFunc func, void *
 // Segment Query callback.
 // Return value is uesd for early exits of the query.
 // If while traversing the grid, the raytrace function detects that an entire grid cell is beyond the hit point, it will stop the trace.
-typedef cpFloat (*cpSpaceHashSegmentQueryFunc)(void *obj1, void *obj2, void *data);
+typedef cpSpatialIndexSegmentQueryFunc cpSpaceHashSegmentQueryFunc;
 void cpSpaceHashSegmentQuery(cpSpaceHash *hash, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpaceHashSegmentQueryFunc func, void *data);
@@ -0,0 +1,155 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// cpSpatialIndex is the interface shared by the spatial indexes that a cpSpace
+// can use to find the pairs of shapes that may be colliding.
+// cpSpaceHash and cpBBTree are the two implementations.
+
+// BBox callback. Called whenever the index needs a bounding box from an object.
+typedef cpBB (*cpSpatialIndexBBFunc)(void *obj);
+// Iterator function.
+typedef void (*cpSpatialIndexIterator)(void *obj, void *data);
+// Query callback.
+typedef void (*cpSpatialIndexQueryFunc)(void *obj1, void *obj2, void *data);
+// Segment query callback.
+// Return value is used for early exits of the query.
+// Parts of the index that are beyond the returned value along the segment are skipped.
+typedef cpFloat (*cpSpatialIndexSegmentQueryFunc)(void *obj1, void *obj2, void *data);
+
+struct cpSpatialIndexClass;
+
+// Must be the first member of every spatial index struct.
+typedef struct cpSpatialIndex {
+	CP_PRIVATE(struct cpSpatialIndexClass *klass);
+	
+	// BBox callback.
+	CP_PRIVATE(cpSpatialIndexBBFunc bbfunc);
+} cpSpatialIndex;
+
+// Function table of a spatial index type.
+typedef struct cpSpatialIndexClass {
+	void (*destroy)(cpSpatialIndex *index);
+	
+	int (*count)(cpSpatialIndex *index);
+	void (*each)(cpSpatialIndex *index, cpSpatialIndexIterator func, void *data);
+	cpBool (*contains)(cpSpatialIndex *index, void *obj, cpHashValue hashid);
+	
+	void (*insert)(cpSpatialIndex *index, void *obj, cpHashValue hashid);
+	void (*remove)(cpSpatialIndex *index, void *obj, cpHashValue hashid);
+	
+	void (*reindex)(cpSpatialIndex *index);
+	void (*reindexObject)(cpSpatialIndex *index, void *obj, cpHashValue hashid);
+	void (*reindexQuery)(cpSpatialIndex *index, cpSpatialIndexQueryFunc func, void *data);
+	
+	void (*pointQuery)(cpSpatialIndex *index, cpVect point, cpSpatialIndexQueryFunc func, void *data);
+	void (*segmentQuery)(cpSpatialIndex *index, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpatialIndexSegmentQueryFunc func, void *data);
+	void (*query)(cpSpatialIndex *index, void *obj, cpBB bb, cpSpatialIndexQueryFunc func, void *data);
+} cpSpatialIndexClass;
+
+// Used by the implementations to set up the common fields.
+cpSpatialIndex *cpSpatialIndexInit(cpSpatialIndex *index, cpSpatialIndexClass *klass, cpSpatialIndexBBFunc bbfunc);
+
+// Destroy and free the index, works with any index type.
+void cpSpatialIndexFree(cpSpatialIndex *index);
+
+static inline void
+cpSpatialIndexDestroy(cpSpatialIndex *index)
+{
+	index->klass->destroy(index);
+}
+
+// Number of objects in the index.
+static inline int
+cpSpatialIndexCount(cpSpatialIndex *index)
+{
+	return index->klass->count(index);
+}
+
+// Iterate over the objects in the index.
+static inline void
+cpSpatialIndexEach(cpSpatialIndex *index, cpSpatialIndexIterator func, void *data)
+{
+	index->klass->each(index, func, data);
+}
+
+// Returns true if the object was added to the index.
+static inline cpBool
+cpSpatialIndexContains(cpSpatialIndex *index, void *obj, cpHashValue hashid)
+{
+	return index->klass->contains(index, obj, hashid);
+}
+
+// Add an object to the index.
+static inline void
+cpSpatialIndexInsert(cpSpatialIndex *index, void *obj, cpHashValue hashid)
+{
+	index->klass->insert(index, obj, hashid);
+}
+
+// Remove an object from the index.
+static inline void
+cpSpatialIndexRemove(cpSpatialIndex *index, void *obj, cpHashValue hashid)
+{
+	index->klass->remove(index, obj, hashid);
+}
+
+// Update the bounding boxes of all the objects.
+static inline void
+cpSpatialIndexReindex(cpSpatialIndex *index)
+{
+	index->klass->reindex(index);
+}
+
+// Update the bounding box of a single object. Does nothing if the object isn't in the index.
+static inline void
+cpSpatialIndexReindexObject(cpSpatialIndex *index, void *obj, cpHashValue hashid)
+{
+	index->klass->reindexObject(index, obj, hashid);
+}
+
+// Update the bounding boxes of all the objects and report the pairs that may overlap.
+// Each pair is reported once.
+static inline void
+cpSpatialIndexReindexQuery(cpSpatialIndex *index, cpSpatialIndexQueryFunc func, void *data)
+{
+	index->klass->reindexQuery(index, func, data);
+}
+
+// Point query the index. A reference to the query point is passed as obj1 to the query callback.
+static inline void
+cpSpatialIndexPointQuery(cpSpatialIndex *index, cpVect point, cpSpatialIndexQueryFunc func, void *data)
+{
+	index->klass->pointQuery(index, point, func, data);
+}
+
+// Query the index for the objects along the segment from a to b.
+static inline void
+cpSpatialIndexSegmentQuery(cpSpatialIndex *index, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpatialIndexSegmentQueryFunc func, void *data)
+{
+	index->klass->segmentQuery(index, obj, a, b, t_exit, func, data);
+}
+
+// Query the index for a given BBox. obj is never reported to itself.
+static inline void
+cpSpatialIndexQuery(cpSpatialIndex *index, void *obj, cpBB bb, cpSpatialIndexQueryFunc func, void *data)
+{
+	index->klass->query(index, obj, bb, func, data);
+}
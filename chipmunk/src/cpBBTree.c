@@ -0,0 +1,575 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+ 
+#include <stdlib.h>
+#include <math.h>
+
+#include "chipmunk_private.h"
+
+// How far ahead the velocity of the objects is used to fatten their boxes, in seconds.
+#define VELOCITY_LOOKAHEAD 0.1f
+
+static inline cpSpatialIndexClass *Klass(void);
+
+#pragma mark Misc Functions
+
+static inline cpBool nodeIsLeaf(cpBBTreeNode *node){return (node->obj != NULL);}
+
+// Half the perimeter of the box. Used as the cost of a node, unlike the area it's not 0 for segments.
+static inline cpFloat bbCost(cpBB bb){return (bb.r - bb.l) + (bb.t - bb.b);}
+
+static inline cpFloat
+bbMergedCost(cpBB a, cpBB b)
+{
+	return (cpfmax(a.r, b.r) - cpfmin(a.l, b.l)) + (cpfmax(a.t, b.t) - cpfmin(a.b, b.b));
+}
+
+// cpBBcontainsBB() is strict, an object that didn't move must fit in its own box.
+static inline cpBool
+bbContains(cpBB bb, cpBB other)
+{
+	return (bb.l <= other.l && bb.r >= other.r && bb.b <= other.b && bb.t >= other.t);
+}
+
+// Fraction along a->b where the segment enters the box, INFINITY if it misses it.
+static inline cpFloat
+bbSegmentEnter(cpBB bb, cpVect a, cpVect b)
+{
+	cpFloat idx = 1.0f/(b.x - a.x);
+	cpFloat tx1 = (bb.l == a.x ? -INFINITY : (bb.l - a.x)*idx);
+	cpFloat tx2 = (bb.r == a.x ?  INFINITY : (bb.r - a.x)*idx);
+	cpFloat txmin = cpfmin(tx1, tx2);
+	cpFloat txmax = cpfmax(tx1, tx2);
+	
+	cpFloat idy = 1.0f/(b.y - a.y);
+	cpFloat ty1 = (bb.b == a.y ? -INFINITY : (bb.b - a.y)*idy);
+	cpFloat ty2 = (bb.t == a.y ?  INFINITY : (bb.t - a.y)*idy);
+	cpFloat tymin = cpfmin(ty1, ty2);
+	cpFloat tymax = cpfmax(ty1, ty2);
+	
+	if(tymin <= txmax && txmin <= tymax){
+		cpFloat tmin = cpfmax(txmin, tymin);
+		cpFloat tmax = cpfmin(txmax, tymax);
+		
+		if(0.0f <= tmax && tmin <= 1.0f) return cpfmax(tmin, 0.0f);
+	}
+	
+	return INFINITY;
+}
+
+// The box stored in the leaf of obj.
+static inline cpBB
+fattenBB(cpBBTree *tree, void *obj, cpBB bb)
+{
+	cpFloat margin = tree->margin;
+	if(margin == 0.0f) return bb;
+	
+	cpFloat x = (bb.r - bb.l)*margin;
+	cpFloat y = (bb.t - bb.b)*margin;
+	
+	cpVect v = (tree->velocityFunc ? cpvmult(tree->velocityFunc(obj), VELOCITY_LOOKAHEAD) : cpvzero);
+	
+	return cpBBNew(
+		bb.l + cpfmin(-x, v.x),
+		bb.b + cpfmin(-y, v.y),
+		bb.r + cpfmax( x, v.x),
+		bb.t + cpfmax( y, v.y)
+	);
+}
+
+#pragma mark Node Functions
+
+static inline void
+recycleNode(cpBBTree *tree, cpBBTreeNode *node)
+{
+	node->parent = tree->pooledNodes;
+	tree->pooledNodes = node;
+}
+
+// Get a recycled or new node.
+static cpBBTreeNode *
+getEmptyNode(cpBBTree *tree)
+{
+	cpBBTreeNode *node = tree->pooledNodes;
+	
+	if(node){
+		tree->pooledNodes = node->parent;
+		return node;
+	} else {
+		// Pool is exhausted, make more
+		int count = CP_BUFFER_BYTES/sizeof(cpBBTreeNode);
+		cpAssert(count, "Buffer size is too small.");
+		
+		cpBBTreeNode *buffer = (cpBBTreeNode *)cpcalloc(1, CP_BUFFER_BYTES);
+		cpArrayPush(tree->allocatedBuffers, buffer);
+		
+		// push all but the first one, return the first instead
+		for(int i=1; i<count; i++) recycleNode(tree, buffer + i);
+		return buffer;
+	}
+}
+
+static inline void nodeSetA(cpBBTreeNode *node, cpBBTreeNode *value){node->a = value; value->parent = node;}
+static inline void nodeSetB(cpBBTreeNode *node, cpBBTreeNode *value){node->b = value; value->parent = node;}
+
+// Make a branch holding a and b.
+static cpBBTreeNode *
+branchNew(cpBBTree *tree, cpBBTreeNode *a, cpBBTreeNode *b)
+{
+	cpBBTreeNode *node = getEmptyNode(tree);
+	node->obj = NULL;
+	node->bb = cpBBmerge(a->bb, b->bb);
+	node->parent = NULL;
+	
+	nodeSetA(node, a);
+	nodeSetB(node, b);
+	
+	return node;
+}
+
+// Recycle the branches of a subtree, the leaves are owned by the leaf set.
+static void
+subtreeRecycle(cpBBTree *tree, cpBBTreeNode *node)
+{
+	if(!nodeIsLeaf(node)){
+		subtreeRecycle(tree, node->a);
+		subtreeRecycle(tree, node->b);
+		recycleNode(tree, node);
+	}
+}
+
+#pragma mark Insert/Remove
+
+// Insert the leaf into the subtree, following the cheapest child. Returns the new subtree.
+static cpBBTreeNode *
+subtreeInsert(cpBBTree *tree, cpBBTreeNode *subtree, cpBBTreeNode *leaf)
+{
+	if(subtree == NULL){
+		return leaf;
+	} else if(nodeIsLeaf(subtree)){
+		return branchNew(tree, leaf, subtree);
+	} else {
+		cpFloat cost_a = bbCost(subtree->b->bb) + bbMergedCost(subtree->a->bb, leaf->bb);
+		cpFloat cost_b = bbCost(subtree->a->bb) + bbMergedCost(subtree->b->bb, leaf->bb);
+		
+		if(cost_b < cost_a){
+			nodeSetB(subtree, subtreeInsert(tree, subtree->b, leaf));
+		} else {
+			nodeSetA(subtree, subtreeInsert(tree, subtree->a, leaf));
+		}
+		
+		subtree->bb = cpBBmerge(subtree->bb, leaf->bb);
+		return subtree;
+	}
+}
+
+static inline void
+insertLeaf(cpBBTree *tree, cpBBTreeNode *leaf)
+{
+	tree->root = subtreeInsert(tree, tree->root, leaf);
+	tree->root->parent = NULL;
+}
+
+static void
+removeLeaf(cpBBTree *tree, cpBBTreeNode *leaf)
+{
+	cpBBTreeNode *parent = leaf->parent;
+	leaf->parent = NULL;
+	
+	if(parent == NULL){
+		tree->root = NULL;
+		return;
+	}
+	
+	// Replace the parent by the sibling of the leaf.
+	cpBBTreeNode *sibling = (parent->a == leaf ? parent->b : parent->a);
+	cpBBTreeNode *node = parent->parent;
+	recycleNode(tree, parent);
+	
+	if(node == NULL){
+		tree->root = sibling;
+		sibling->parent = NULL;
+		return;
+	}
+	
+	if(node->a == parent){
+		nodeSetA(node, sibling);
+	} else {
+		nodeSetB(node, sibling);
+	}
+	
+	// Shrink the boxes of the ancestors.
+	for(; node; node = node->parent){
+		node->bb = cpBBmerge(node->a->bb, node->b->bb);
+	}
+}
+
+#pragma mark Leaf Set Functions
+
+// Equality function for the leaf set.
+static cpBool leafSetEql(void *obj, cpBBTreeNode *leaf){return (obj == leaf->obj);}
+
+// Transformation function for the leaf set.
+static void *
+leafSetTrans(void *obj, cpBBTree *tree)
+{
+	cpBBTreeNode *leaf = getEmptyNode(tree);
+	leaf->obj = obj;
+	leaf->bb = fattenBB(tree, obj, tree->spatialIndex.bbfunc(obj));
+	leaf->parent = NULL;
+	leaf->a = NULL;
+	leaf->b = NULL;
+	
+	return leaf;
+}
+
+// Moves the leaf if the object escaped its box.
+static void
+updateLeaf(cpBBTreeNode *leaf, cpBBTree *tree)
+{
+	void *obj = leaf->obj;
+	cpBB bb = tree->spatialIndex.bbfunc(obj);
+	
+	if(!bbContains(leaf->bb, bb)){
+		removeLeaf(tree, leaf);
+		leaf->bb = fattenBB(tree, obj, bb);
+		insertLeaf(tree, leaf);
+	}
+}
+
+#pragma mark Memory Management Functions
+
+cpBBTree *
+cpBBTreeAlloc(void)
+{
+	return (cpBBTree *)cpcalloc(1, sizeof(cpBBTree));
+}
+
+cpBBTree *
+cpBBTreeInit(cpBBTree *tree, cpSpatialIndexBBFunc bbfunc, cpFloat margin)
+{
+	cpSpatialIndexInit(&tree->spatialIndex, Klass(), bbfunc);
+	
+	tree->margin = margin;
+	tree->velocityFunc = NULL;
+	
+	tree->leaves = cpHashSetNew(0, (cpHashSetEqlFunc)leafSetEql, (cpHashSetTransFunc)leafSetTrans);
+	tree->root = NULL;
+	
+	tree->pooledNodes = NULL;
+	tree->allocatedBuffers = cpArrayNew(0);
+	
+	return tree;
+}
+
+cpBBTree *
+cpBBTreeNew(cpSpatialIndexBBFunc bbfunc, cpFloat margin)
+{
+	return cpBBTreeInit(cpBBTreeAlloc(), bbfunc, margin);
+}
+
+static void freeWrap(void *ptr, void *unused){cpfree(ptr);}
+
+void
+cpBBTreeDestroy(cpBBTree *tree)
+{
+	cpHashSetFree(tree->leaves);
+	
+	if(tree->allocatedBuffers) cpArrayEach(tree->allocatedBuffers, freeWrap, NULL);
+	cpArrayFree(tree->allocatedBuffers);
+}
+
+void
+cpBBTreeFree(cpBBTree *tree)
+{
+	if(tree){
+		cpBBTreeDestroy(tree);
+		cpfree(tree);
+	}
+}
+
+cpBBTree *
+cpBBTreeFromIndex(cpSpatialIndex *index)
+{
+	return (index && index->klass == Klass() ? (cpBBTree *)index : NULL);
+}
+
+void
+cpBBTreeSetVelocityFunc(cpBBTree *tree, cpBBTreeVelocityFunc func)
+{
+	tree->velocityFunc = func;
+}
+
+#pragma mark Optimize
+
+static int
+compareX(const void *a, const void *b)
+{
+	cpBB bb_a = (*(cpBBTreeNode **)a)->bb;
+	cpBB bb_b = (*(cpBBTreeNode **)b)->bb;
+	cpFloat x_a = bb_a.l + bb_a.r;
+	cpFloat x_b = bb_b.l + bb_b.r;
+	
+	return (x_a < x_b ? -1 : (x_a > x_b ? 1 : 0));
+}
+
+static int
+compareY(const void *a, const void *b)
+{
+	cpBB bb_a = (*(cpBBTreeNode **)a)->bb;
+	cpBB bb_b = (*(cpBBTreeNode **)b)->bb;
+	cpFloat y_a = bb_a.b + bb_a.t;
+	cpFloat y_b = bb_b.b + bb_b.t;
+	
+	return (y_a < y_b ? -1 : (y_a > y_b ? 1 : 0));
+}
+
+// Split the nodes in two halves along the longest axis of their bounds.
+static cpBBTreeNode *
+partitionNodes(cpBBTree *tree, cpBBTreeNode **nodes, int count)
+{
+	if(count == 1) return nodes[0];
+	
+	cpBB bb = nodes[0]->bb;
+	for(int i=1; i<count; i++) bb = cpBBmerge(bb, nodes[i]->bb);
+	
+	qsort(nodes, count, sizeof(cpBBTreeNode *), (bb.r - bb.l > bb.t - bb.b ? compareX : compareY));
+	
+	int half = count/2;
+	return branchNew(tree,
+		partitionNodes(tree, nodes, half),
+		partitionNodes(tree, nodes + half, count - half)
+	);
+}
+
+static void
+collectLeaf(cpBBTreeNode *leaf, cpBBTreeNode ***cursor)
+{
+	*((*cursor)++) = leaf;
+}
+
+void
+cpBBTreeOptimize(cpBBTree *tree)
+{
+	if(tree->root == NULL) return;
+	
+	int count = tree->leaves->entries;
+	cpBBTreeNode **nodes = (cpBBTreeNode **)cpcalloc(count, sizeof(cpBBTreeNode *));
+	cpBBTreeNode **cursor = nodes;
+	cpHashSetEach(tree->leaves, (cpHashSetIterFunc)collectLeaf, &cursor);
+	
+	subtreeRecycle(tree, tree->root);
+	tree->root = partitionNodes(tree, nodes, count);
+	tree->root->parent = NULL;
+	
+	cpfree(nodes);
+}
+
+#pragma mark Spatial Index Functions
+
+static int
+cpBBTreeCount(cpBBTree *tree)
+{
+	return tree->leaves->entries;
+}
+
+typedef struct eachContext {
+	cpSpatialIndexIterator func;
+	void *data;
+} eachContext;
+
+static void eachHelper(cpBBTreeNode *leaf, eachContext *context){context->func(leaf->obj, context->data);}
+
+static void
+cpBBTreeEach(cpBBTree *tree, cpSpatialIndexIterator func, void *data)
+{
+	eachContext context = {func, data};
+	cpHashSetEach(tree->leaves, (cpHashSetIterFunc)eachHelper, &context);
+}
+
+static cpBool
+cpBBTreeContains(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	return (cpHashSetFind(tree->leaves, hashid, obj) != NULL);
+}
+
+static void
+cpBBTreeInsert(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	cpBBTreeNode *leaf = (cpBBTreeNode *)cpHashSetInsert(tree->leaves, hashid, obj, tree);
+	if(leaf != tree->root && leaf->parent == NULL) insertLeaf(tree, leaf);
+}
+
+static void
+cpBBTreeRemove(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	cpBBTreeNode *leaf = (cpBBTreeNode *)cpHashSetRemove(tree->leaves, hashid, obj);
+	
+	if(leaf){
+		removeLeaf(tree, leaf);
+		recycleNode(tree, leaf);
+	}
+}
+
+static void
+refreshLeaf(cpBBTreeNode *leaf, cpBBTree *tree)
+{
+	leaf->bb = fattenBB(tree, leaf->obj, tree->spatialIndex.bbfunc(leaf->obj));
+}
+
+static void
+cpBBTreeReindex(cpBBTree *tree)
+{
+	cpHashSetEach(tree->leaves, (cpHashSetIterFunc)refreshLeaf, tree);
+	cpBBTreeOptimize(tree);
+}
+
+static void
+cpBBTreeReindexObject(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	cpBBTreeNode *leaf = (cpBBTreeNode *)cpHashSetFind(tree->leaves, hashid, obj);
+	
+	if(leaf){
+		removeLeaf(tree, leaf);
+		refreshLeaf(leaf, tree);
+		insertLeaf(tree, leaf);
+	}
+}
+
+#pragma mark Query Functions
+
+static void
+subtreeQuery(cpBBTreeNode *subtree, void *obj, cpBB bb, cpSpatialIndexQueryFunc func, void *data)
+{
+	if(cpBBintersects(subtree->bb, bb)){
+		if(nodeIsLeaf(subtree)){
+			if(subtree->obj != obj) func(obj, subtree->obj, data);
+		} else {
+			subtreeQuery(subtree->a, obj, bb, func, data);
+			subtreeQuery(subtree->b, obj, bb, func, data);
+		}
+	}
+}
+
+static void
+cpBBTreeQuery(cpBBTree *tree, void *obj, cpBB bb, cpSpatialIndexQueryFunc func, void *data)
+{
+	if(tree->root) subtreeQuery(tree->root, obj, bb, func, data);
+}
+
+static void
+cpBBTreePointQuery(cpBBTree *tree, cpVect point, cpSpatialIndexQueryFunc func, void *data)
+{
+	if(tree->root) subtreeQuery(tree->root, &point, cpBBNew(point.x, point.y, point.x, point.y), func, data);
+}
+
+// Visits the nearest child first so that func() can shorten the segment early.
+static cpFloat
+subtreeSegmentQuery(cpBBTreeNode *subtree, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpatialIndexSegmentQueryFunc func, void *data)
+{
+	if(nodeIsLeaf(subtree)) return func(obj, subtree->obj, data);
+	
+	cpBBTreeNode *first = subtree->a, *second = subtree->b;
+	cpFloat t_first = bbSegmentEnter(first->bb, a, b);
+	cpFloat t_second = bbSegmentEnter(second->bb, a, b);
+	
+	if(t_second < t_first){
+		cpBBTreeNode *node = first; first = second; second = node;
+		cpFloat t = t_first; t_first = t_second; t_second = t;
+	}
+	
+	if(t_first < t_exit) t_exit = cpfmin(t_exit, subtreeSegmentQuery(first, obj, a, b, t_exit, func, data));
+	if(t_second < t_exit) t_exit = cpfmin(t_exit, subtreeSegmentQuery(second, obj, a, b, t_exit, func, data));
+	
+	return t_exit;
+}
+
+static void
+cpBBTreeSegmentQuery(cpBBTree *tree, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpatialIndexSegmentQueryFunc func, void *data)
+{
+	cpBBTreeNode *root = tree->root;
+	if(root && bbSegmentEnter(root->bb, a, b) < t_exit) subtreeSegmentQuery(root, obj, a, b, t_exit, func, data);
+}
+
+// Report the overlapping leaves of a against the ones of b.
+static void
+subtreeCrossQuery(cpBBTreeNode *a, cpBBTreeNode *b, cpSpatialIndexQueryFunc func, void *data)
+{
+	if(!cpBBintersects(a->bb, b->bb)) return;
+	
+	if(nodeIsLeaf(a)){
+		if(nodeIsLeaf(b)){
+			func(a->obj, b->obj, data);
+		} else {
+			subtreeCrossQuery(a, b->a, func, data);
+			subtreeCrossQuery(a, b->b, func, data);
+		}
+	} else if(nodeIsLeaf(b) || bbCost(a->bb) > bbCost(b->bb)){
+		// Descend into the bigger subtree.
+		subtreeCrossQuery(a->a, b, func, data);
+		subtreeCrossQuery(a->b, b, func, data);
+	} else {
+		subtreeCrossQuery(a, b->a, func, data);
+		subtreeCrossQuery(a, b->b, func, data);
+	}
+}
+
+// Report the overlapping leaves in the subtree, each pair once.
+static void
+subtreeSelfQuery(cpBBTreeNode *subtree, cpSpatialIndexQueryFunc func, void *data)
+{
+	if(nodeIsLeaf(subtree)) return;
+	
+	subtreeSelfQuery(subtree->a, func, data);
+	subtreeSelfQuery(subtree->b, func, data);
+	subtreeCrossQuery(subtree->a, subtree->b, func, data);
+}
+
+static void
+cpBBTreeReindexQuery(cpBBTree *tree, cpSpatialIndexQueryFunc func, void *data)
+{
+	// Only the leaves that escaped their fattened boxes are moved.
+	cpHashSetEach(tree->leaves, (cpHashSetIterFunc)updateLeaf, tree);
+	if(tree->root) subtreeSelfQuery(tree->root, func, data);
+}
+
+#pragma mark Spatial Index Class
+
+static cpSpatialIndexClass klass = {
+	(void (*)(cpSpatialIndex *))cpBBTreeDestroy,
+	
+	(int (*)(cpSpatialIndex *))cpBBTreeCount,
+	(void (*)(cpSpatialIndex *, cpSpatialIndexIterator, void *))cpBBTreeEach,
+	(cpBool (*)(cpSpatialIndex *, void *, cpHashValue))cpBBTreeContains,
+	
+	(void (*)(cpSpatialIndex *, void *, cpHashValue))cpBBTreeInsert,
+	(void (*)(cpSpatialIndex *, void *, cpHashValue))cpBBTreeRemove,
+	
+	(void (*)(cpSpatialIndex *))cpBBTreeReindex,
+	(void (*)(cpSpatialIndex *, void *, cpHashValue))cpBBTreeReindexObject,
+	(void (*)(cpSpatialIndex *, cpSpatialIndexQueryFunc, void *))cpBBTreeReindexQuery,
+	
+	(void (*)(cpSpatialIndex *, cpVect, cpSpatialIndexQueryFunc, void *))cpBBTreePointQuery,
+	(void (*)(cpSpatialIndex *, void *, cpVect, cpVect, cpFloat, cpSpatialIndexSegmentQueryFunc, void *))cpBBTreeSegmentQuery,
+	(void (*)(cpSpatialIndex *, void *, cpBB, cpSpatialIndexQueryFunc, void *))cpBBTreeQuery,
+};
+
+static inline cpSpatialIndexClass *Klass(void){return &klass;}
@@ -0,0 +1,534 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+ 
+#include <stdlib.h>
+#include <string.h>
+
+#include "chipmunk_private.h"
+#include "cpThreadPool.h"
+#include "cpSolver.h"
+
+// Colors available to the coloring, one bit each in cpBody.solverColors.
+// What doesn't fit is solved serially after the colors, the overflow is stored as an extra color.
+#define SOLVER_COLORS 32
+#define OVERFLOW_COLOR SOLVER_COLORS
+
+// Contacts solved at the same time.
+#define LANES 4
+
+#pragma mark SIMD Lanes
+
+#if !CP_USE_DOUBLES && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+
+#include <xmmintrin.h>
+
+typedef __m128 cpLanes;
+
+static inline cpLanes lanesLoad(const cpFloat *p){return _mm_loadu_ps(p);}
+static inline void lanesStore(cpFloat *p, cpLanes a){_mm_storeu_ps(p, a);}
+static inline cpLanes lanesSplat(cpFloat f){return _mm_set1_ps(f);}
+static inline cpLanes lanesAdd(cpLanes a, cpLanes b){return _mm_add_ps(a, b);}
+static inline cpLanes lanesSub(cpLanes a, cpLanes b){return _mm_sub_ps(a, b);}
+static inline cpLanes lanesMul(cpLanes a, cpLanes b){return _mm_mul_ps(a, b);}
+static inline cpLanes lanesMin(cpLanes a, cpLanes b){return _mm_min_ps(a, b);}
+static inline cpLanes lanesMax(cpLanes a, cpLanes b){return _mm_max_ps(a, b);}
+
+#elif !CP_USE_DOUBLES && (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(_M_ARM))
+
+#include <arm_neon.h>
+
+typedef float32x4_t cpLanes;
+
+static inline cpLanes lanesLoad(const cpFloat *p){return vld1q_f32(p);}
+static inline void lanesStore(cpFloat *p, cpLanes a){vst1q_f32(p, a);}
+static inline cpLanes lanesSplat(cpFloat f){return vdupq_n_f32(f);}
+static inline cpLanes lanesAdd(cpLanes a, cpLanes b){return vaddq_f32(a, b);}
+static inline cpLanes lanesSub(cpLanes a, cpLanes b){return vsubq_f32(a, b);}
+static inline cpLanes lanesMul(cpLanes a, cpLanes b){return vmulq_f32(a, b);}
+static inline cpLanes lanesMin(cpLanes a, cpLanes b){return vminq_f32(a, b);}
+static inline cpLanes lanesMax(cpLanes a, cpLanes b){return vmaxq_f32(a, b);}
+
+#else
+
+// Plain C fallback, also used when cpFloat is a double.
+typedef struct cpLanes {cpFloat v[LANES];} cpLanes;
+
+#define LANES_OP(__name__, __expr__) \
+static inline cpLanes __name__(cpLanes a, cpLanes b){ \
+	cpLanes r; \
+	for(int i=0; i<LANES; i++) r.v[i] = (__expr__); \
+	return r; \
+}
+
+LANES_OP(lanesAdd, a.v[i] + b.v[i])
+LANES_OP(lanesSub, a.v[i] - b.v[i])
+LANES_OP(lanesMul, a.v[i]*b.v[i])
+LANES_OP(lanesMin, cpfmin(a.v[i], b.v[i]))
+LANES_OP(lanesMax, cpfmax(a.v[i], b.v[i]))
+
+static inline cpLanes lanesLoad(const cpFloat *p){cpLanes r; memcpy(r.v, p, sizeof(r.v)); return r;}
+static inline void lanesStore(cpFloat *p, cpLanes a){memcpy(p, a.v, sizeof(a.v));}
+static inline cpLanes lanesSplat(cpFloat f){cpLanes r; for(int i=0; i<LANES; i++) r.v[i] = f; return r;}
+
+#endif
+
+static inline cpLanes lanesNeg(cpLanes a){return lanesSub(lanesSplat(0.0f), a);}
+static inline cpLanes lanesClamp(cpLanes a, cpLanes min, cpLanes max){return lanesMax(lanesMin(a, max), min);}
+
+#pragma mark Batches
+
+// Contacts of LANES different arbiters stored as structures of arrays.
+typedef struct cpContactBatch {
+	cpFloat r1x[LANES], r1y[LANES], r2x[LANES], r2y[LANES];
+	cpFloat nx[LANES], ny[LANES];
+	cpFloat nMass[LANES], tMass[LANES], bounce[LANES], bias[LANES];
+	cpFloat jnAcc[LANES], jtAcc[LANES], jBias[LANES];
+	
+	// Copied from the arbiters.
+	cpFloat u[LANES], surface_vrx[LANES], surface_vry[LANES];
+	
+	// Unused lanes point to the solver's dummy body and have no contact.
+	cpBody *a[LANES], *b[LANES];
+	cpContact *contacts[LANES];
+	cpArbiter *arbiters[LANES];
+} cpContactBatch;
+
+// Velocities of the bodies of a batch.
+typedef struct cpBodyLanes {
+	cpLanes vx, vy, w;
+	cpLanes v_biasx, v_biasy, w_bias;
+	cpLanes m_inv, i_inv;
+} cpBodyLanes;
+
+struct cpSolver {
+	cpThreadPool *pool;
+	
+	// Batches sorted by color, each color starts at colorBatches[color].
+	// The overflow batches hold a single contact.
+	cpContactBatch *batches;
+	int batchCapacity;
+	int colorBatches[SOLVER_COLORS + 2];
+	
+	// Constraints sorted by color.
+	cpConstraint **constraints;
+	int constraintCapacity;
+	int colorConstraints[SOLVER_COLORS + 2];
+	
+	// Color of each contact and constraint, filled while coloring.
+	int *colors;
+	int colorCapacity;
+	
+	// Static body used by the unused lanes.
+	cpBody dummy;
+	
+	// Arguments of the current cpSolverApplyImpulses() call.
+	int iterations;
+	cpFloat eCoef;
+};
+
+// Bodies that are never written to by the impulses, they don't need to be colored.
+static inline cpBool
+bodyIsStatic(cpBody *body)
+{
+	return (body == NULL || (body->m_inv == 0.0f && body->i_inv == 0.0f));
+}
+
+static inline void
+loadBodies(cpBody **bodies, cpBodyLanes *lanes)
+{
+	cpFloat vx[LANES], vy[LANES], w[LANES];
+	cpFloat v_biasx[LANES], v_biasy[LANES], w_bias[LANES];
+	cpFloat m_inv[LANES], i_inv[LANES];
+	
+	for(int i=0; i<LANES; i++){
+		cpBody *body = bodies[i];
+		vx[i] = body->v.x; vy[i] = body->v.y; w[i] = body->w;
+		v_biasx[i] = body->v_bias.x; v_biasy[i] = body->v_bias.y; w_bias[i] = body->w_bias;
+		m_inv[i] = body->m_inv; i_inv[i] = body->i_inv;
+	}
+	
+	lanes->vx = lanesLoad(vx); lanes->vy = lanesLoad(vy); lanes->w = lanesLoad(w);
+	lanes->v_biasx = lanesLoad(v_biasx); lanes->v_biasy = lanesLoad(v_biasy); lanes->w_bias = lanesLoad(w_bias);
+	lanes->m_inv = lanesLoad(m_inv); lanes->i_inv = lanesLoad(i_inv);
+}
+
+static inline void
+storeBodies(cpBody **bodies, cpBodyLanes *lanes)
+{
+	cpFloat vx[LANES], vy[LANES], w[LANES];
+	cpFloat v_biasx[LANES], v_biasy[LANES], w_bias[LANES];
+	
+	lanesStore(vx, lanes->vx); lanesStore(vy, lanes->vy); lanesStore(w, lanes->w);
+	lanesStore(v_biasx, lanes->v_biasx); lanesStore(v_biasy, lanes->v_biasy); lanesStore(w_bias, lanes->w_bias);
+	
+	for(int i=0; i<LANES; i++){
+		cpBody *body = bodies[i];
+		
+		// Static bodies may appear in several lanes, the impulses don't change them anyway.
+		if(bodyIsStatic(body)) continue;
+		
+		body->v = cpv(vx[i], vy[i]); body->w = w[i];
+		body->v_bias = cpv(v_biasx[i], v_biasy[i]); body->w_bias = w_bias[i];
+	}
+}
+
+// Copies the contacts and arbiter values into the batch.
+static void
+loadBatch(cpContactBatch *batch)
+{
+	for(int i=0; i<LANES; i++){
+		cpContact *con = batch->contacts[i];
+		if(!con) continue;
+		
+		cpArbiter *arb = batch->arbiters[i];
+		batch->r1x[i] = con->r1.x; batch->r1y[i] = con->r1.y;
+		batch->r2x[i] = con->r2.x; batch->r2y[i] = con->r2.y;
+		batch->nx[i] = con->n.x; batch->ny[i] = con->n.y;
+		batch->nMass[i] = con->nMass; batch->tMass[i] = con->tMass;
+		batch->bounce[i] = con->bounce; batch->bias[i] = con->bias;
+		batch->jnAcc[i] = con->jnAcc; batch->jtAcc[i] = con->jtAcc; batch->jBias[i] = con->jBias;
+		batch->u[i] = arb->u;
+		batch->surface_vrx[i] = arb->surface_vr.x; batch->surface_vry[i] = arb->surface_vr.y;
+	}
+}
+
+// Copies the accumulated impulses back to the contacts.
+static void
+storeBatch(cpContactBatch *batch)
+{
+	for(int i=0; i<LANES; i++){
+		cpContact *con = batch->contacts[i];
+		if(!con) continue;
+		
+		con->jnAcc = batch->jnAcc[i]; con->jtAcc = batch->jtAcc[i]; con->jBias = batch->jBias[i];
+	}
+}
+
+// cpArbiterApplyImpulse() for one contact in each lane.
+static void
+solveBatch(cpContactBatch *batch, cpLanes eCoef)
+{
+	cpBodyLanes a, b;
+	loadBodies(batch->a, &a);
+	loadBodies(batch->b, &b);
+	
+	cpLanes zero = lanesSplat(0.0f);
+	cpLanes r1x = lanesLoad(batch->r1x), r1y = lanesLoad(batch->r1y);
+	cpLanes r2x = lanesLoad(batch->r2x), r2y = lanesLoad(batch->r2y);
+	cpLanes nx = lanesLoad(batch->nx), ny = lanesLoad(batch->ny);
+	cpLanes nMass = lanesLoad(batch->nMass);
+	
+	// Calculate the relative bias velocities.
+	cpLanes vb1x = lanesSub(a.v_biasx, lanesMul(r1y, a.w_bias));
+	cpLanes vb1y = lanesAdd(a.v_biasy, lanesMul(r1x, a.w_bias));
+	cpLanes vb2x = lanesSub(b.v_biasx, lanesMul(r2y, b.w_bias));
+	cpLanes vb2y = lanesAdd(b.v_biasy, lanesMul(r2x, b.w_bias));
+	cpLanes vbn = lanesAdd(lanesMul(lanesSub(vb2x, vb1x), nx), lanesMul(lanesSub(vb2y, vb1y), ny));
+	
+	// Calculate and clamp the bias impulse.
+	cpLanes jbn = lanesMul(lanesSub(lanesLoad(batch->bias), vbn), nMass);
+	cpLanes jbnOld = lanesLoad(batch->jBias);
+	cpLanes jBias = lanesMax(lanesAdd(jbnOld, jbn), zero);
+	lanesStore(batch->jBias, jBias);
+	jbn = lanesSub(jBias, jbnOld);
+	
+	// Apply the bias impulse.
+	cpLanes jx = lanesMul(nx, jbn), jy = lanesMul(ny, jbn);
+	a.v_biasx = lanesSub(a.v_biasx, lanesMul(jx, a.m_inv));
+	a.v_biasy = lanesSub(a.v_biasy, lanesMul(jy, a.m_inv));
+	a.w_bias = lanesSub(a.w_bias, lanesMul(a.i_inv, lanesSub(lanesMul(r1x, jy), lanesMul(r1y, jx))));
+	b.v_biasx = lanesAdd(b.v_biasx, lanesMul(jx, b.m_inv));
+	b.v_biasy = lanesAdd(b.v_biasy, lanesMul(jy, b.m_inv));
+	b.w_bias = lanesAdd(b.w_bias, lanesMul(b.i_inv, lanesSub(lanesMul(r2x, jy), lanesMul(r2y, jx))));
+	
+	// Calculate the relative velocity.
+	cpLanes vrx = lanesSub(lanesSub(b.vx, lanesMul(r2y, b.w)), lanesSub(a.vx, lanesMul(r1y, a.w)));
+	cpLanes vry = lanesSub(lanesAdd(b.vy, lanesMul(r2x, b.w)), lanesAdd(a.vy, lanesMul(r1x, a.w)));
+	cpLanes vrn = lanesAdd(lanesMul(vrx, nx), lanesMul(vry, ny));
+	
+	// Calculate and clamp the normal impulse.
+	cpLanes jn = lanesMul(lanesNeg(lanesAdd(lanesMul(lanesLoad(batch->bounce), eCoef), vrn)), nMass);
+	cpLanes jnOld = lanesLoad(batch->jnAcc);
+	cpLanes jnAcc = lanesMax(lanesAdd(jnOld, jn), zero);
+	lanesStore(batch->jnAcc, jnAcc);
+	jn = lanesSub(jnAcc, jnOld);
+	
+	// Calculate the relative tangent velocity.
+	cpLanes vrtx = lanesAdd(vrx, lanesLoad(batch->surface_vrx));
+	cpLanes vrty = lanesAdd(vry, lanesLoad(batch->surface_vry));
+	cpLanes vrt = lanesAdd(lanesMul(vrtx, lanesNeg(ny)), lanesMul(vrty, nx));
+	
+	// Calculate and clamp the friction impulse.
+	cpLanes jtMax = lanesMul(lanesLoad(batch->u), jnAcc);
+	cpLanes jt = lanesMul(lanesNeg(vrt), lanesLoad(batch->tMass));
+	cpLanes jtOld = lanesLoad(batch->jtAcc);
+	cpLanes jtAcc = lanesClamp(lanesAdd(jtOld, jt), lanesNeg(jtMax), jtMax);
+	lanesStore(batch->jtAcc, jtAcc);
+	jt = lanesSub(jtAcc, jtOld);
+	
+	// Apply the final impulse.
+	jx = lanesSub(lanesMul(nx, jn), lanesMul(ny, jt));
+	jy = lanesAdd(lanesMul(nx, jt), lanesMul(ny, jn));
+	a.vx = lanesSub(a.vx, lanesMul(jx, a.m_inv));
+	a.vy = lanesSub(a.vy, lanesMul(jy, a.m_inv));
+	a.w = lanesSub(a.w, lanesMul(a.i_inv, lanesSub(lanesMul(r1x, jy), lanesMul(r1y, jx))));
+	b.vx = lanesAdd(b.vx, lanesMul(jx, b.m_inv));
+	b.vy = lanesAdd(b.vy, lanesMul(jy, b.m_inv));
+	b.w = lanesAdd(b.w, lanesMul(b.i_inv, lanesSub(lanesMul(r2x, jy), lanesMul(r2y, jx))));
+	
+	storeBodies(batch->a, &a);
+	storeBodies(batch->b, &b);
+}
+
+#pragma mark Coloring
+
+// Picks the first color not used yet by the non static bodies and marks it as used.
+static int
+colorPair(cpBody *a, cpBody *b)
+{
+	cpBool dynamicA = !bodyIsStatic(a);
+	cpBool dynamicB = !bodyIsStatic(b);
+	
+	unsigned int used = 0;
+	if(dynamicA) used |= a->solverColors;
+	if(dynamicB) used |= b->solverColors;
+	if(used == ~0u) return OVERFLOW_COLOR;
+	
+	int color = 0;
+	while(used & (1u<<color)) color++;
+	
+	if(dynamicA) a->solverColors |= (1u<<color);
+	if(dynamicB) b->solverColors |= (1u<<color);
+	
+	return color;
+}
+
+static inline void
+resetColors(cpBody *body)
+{
+	if(body) body->solverColors = 0;
+}
+
+static void *
+growBuffer(void *buffer, int *capacity, int count, size_t size)
+{
+	if(count <= *capacity) return buffer;
+	
+	while(*capacity < count) *capacity = (*capacity ? 2*(*capacity) : 64);
+	return cprealloc(buffer, (*capacity)*size);
+}
+
+void
+cpSolverPrepare(cpSolver *solver, cpArray *arbiters, cpArray *constraints)
+{
+	int contactCount = 0;
+	for(int i=0; i<arbiters->num; i++){
+		cpArbiter *arb = (cpArbiter *)arbiters->arr[i];
+		resetColors(arb->a->body);
+		resetColors(arb->b->body);
+		contactCount += arb->numContacts;
+	}
+	
+	for(int i=0; i<constraints->num; i++){
+		cpConstraint *constraint = (cpConstraint *)constraints->arr[i];
+		resetColors(constraint->a);
+		resetColors(constraint->b);
+	}
+	
+	solver->colors = (int *)growBuffer(solver->colors, &solver->colorCapacity, contactCount + constraints->num, sizeof(int));
+	int *contactColors = solver->colors;
+	int *constraintColors = solver->colors + contactCount;
+	
+	// Color the contacts in order, so the contacts of an arbiter end up in increasing colors
+	// and are still solved one after the other like cpArbiterApplyImpulse() does.
+	int contactCounts[SOLVER_COLORS + 1] = {0};
+	for(int i=0, k=0; i<arbiters->num; i++){
+		cpArbiter *arb = (cpArbiter *)arbiters->arr[i];
+		for(int j=0; j<arb->numContacts; j++, k++){
+			int color = contactColors[k] = colorPair(arb->a->body, arb->b->body);
+			contactCounts[color]++;
+		}
+	}
+	
+	// Unlike the batches, the constraints write their static bodies back (unchanged) while the
+	// other threads read them. The ones attached to a static body are solved by thread 0 alone.
+	int constraintCounts[SOLVER_COLORS + 1] = {0};
+	for(int i=0; i<constraints->num; i++){
+		cpConstraint *constraint = (cpConstraint *)constraints->arr[i];
+		int color = constraintColors[i] = (
+			bodyIsStatic(constraint->a) || bodyIsStatic(constraint->b) ?
+			OVERFLOW_COLOR : colorPair(constraint->a, constraint->b)
+		);
+		constraintCounts[color]++;
+	}
+	
+	// Lay out the batches and constraints by color.
+	int batchCount = 0, constraintCount = 0;
+	for(int color=0; color<=OVERFLOW_COLOR; color++){
+		solver->colorBatches[color] = batchCount;
+		batchCount += (color == OVERFLOW_COLOR ? contactCounts[color] : (contactCounts[color] + LANES - 1)/LANES);
+		
+		solver->colorConstraints[color] = constraintCount;
+		constraintCount += constraintCounts[color];
+	}
+	solver->colorBatches[OVERFLOW_COLOR + 1] = batchCount;
+	solver->colorConstraints[OVERFLOW_COLOR + 1] = constraintCount;
+	
+	solver->batches = (cpContactBatch *)growBuffer(solver->batches, &solver->batchCapacity, batchCount, sizeof(cpContactBatch));
+	solver->constraints = (cpConstraint **)growBuffer(solver->constraints, &solver->constraintCapacity, constraintCount, sizeof(cpConstraint *));
+	
+	cpBody *dummy = &solver->dummy;
+	for(int i=0; i<batchCount; i++){
+		cpContactBatch *batch = solver->batches + i;
+		memset(batch, 0, sizeof(cpContactBatch));
+		for(int lane=0; lane<LANES; lane++) batch->a[lane] = batch->b[lane] = dummy;
+	}
+	
+	// Fill them, reusing the counts as cursors.
+	memset(contactCounts, 0, sizeof(contactCounts));
+	for(int i=0, k=0; i<arbiters->num; i++){
+		cpArbiter *arb = (cpArbiter *)arbiters->arr[i];
+		for(int j=0; j<arb->numContacts; j++, k++){
+			int color = contactColors[k];
+			int slot = contactCounts[color]++;
+			
+			int lane = (color == OVERFLOW_COLOR ? 0 : slot%LANES);
+			cpContactBatch *batch = solver->batches + solver->colorBatches[color] + (color == OVERFLOW_COLOR ? slot : slot/LANES);
+			
+			batch->a[lane] = arb->a->body;
+			batch->b[lane] = arb->b->body;
+			batch->contacts[lane] = arb->contacts + j;
+			batch->arbiters[lane] = arb;
+		}
+	}
+	
+	memset(constraintCounts, 0, sizeof(constraintCounts));
+	for(int i=0; i<constraints->num; i++){
+		int color = constraintColors[i];
+		solver->constraints[solver->colorConstraints[color] + constraintCounts[color]++] = (cpConstraint *)constraints->arr[i];
+	}
+}
+
+#pragma mark Solving
+
+// Range of a color handled by a thread. The overflow is solved by thread 0 alone.
+static inline void
+threadRange(const int *offsets, int color, int thread, int threads, int *start, int *end)
+{
+	int first = offsets[color];
+	int count = offsets[color + 1] - first;
+	
+	if(color == OVERFLOW_COLOR){
+		*start = first;
+		*end = (thread == 0 ? first + count : first);
+	} else {
+		*start = first + count*thread/threads;
+		*end = first + count*(thread + 1)/threads;
+	}
+}
+
+static inline cpBool
+colorIsEmpty(cpSolver *solver, int color)
+{
+	return (
+		solver->colorBatches[color] == solver->colorBatches[color + 1] &&
+		solver->colorConstraints[color] == solver->colorConstraints[color + 1]
+	);
+}
+
+static void
+solveThread(int thread, cpSolver *solver)
+{
+	cpThreadPool *pool = solver->pool;
+	int threads = cpThreadPoolGetThreadCount(pool);
+	cpLanes eCoef = lanesSplat(solver->eCoef);
+	int start, end;
+	
+	// Each thread loads and stores the batches it solves, no need to synchronize for that.
+	for(int color=0; color<=OVERFLOW_COLOR; color++){
+		threadRange(solver->colorBatches, color, thread, threads, &start, &end);
+		for(int i=start; i<end; i++) loadBatch(solver->batches + i);
+	}
+	
+	for(int i=0; i<solver->iterations; i++){
+		for(int color=0; color<=OVERFLOW_COLOR; color++){
+			if(colorIsEmpty(solver, color)) continue;
+			
+			threadRange(solver->colorBatches, color, thread, threads, &start, &end);
+			for(int j=start; j<end; j++) solveBatch(solver->batches + j, eCoef);
+			
+			threadRange(solver->colorConstraints, color, thread, threads, &start, &end);
+			for(int j=start; j<end; j++){
+				cpConstraint *constraint = solver->constraints[j];
+				constraint->klass->applyImpulse(constraint);
+			}
+			
+			cpThreadPoolBarrier(pool, thread);
+		}
+	}
+	
+	for(int color=0; color<=OVERFLOW_COLOR; color++){
+		threadRange(solver->colorBatches, color, thread, threads, &start, &end);
+		for(int i=start; i<end; i++) storeBatch(solver->batches + i);
+	}
+}
+
+void
+cpSolverApplyImpulses(cpSolver *solver, int iterations, cpFloat eCoef)
+{
+	if(!iterations) return;
+	
+	solver->iterations = iterations;
+	solver->eCoef = eCoef;
+	cpThreadPoolRun(solver->pool, (cpThreadPoolFunc)solveThread, solver);
+}
+
+#pragma mark Memory Management Functions
+
+cpSolver *
+cpSolverNew(int threads)
+{
+	cpSolver *solver = (cpSolver *)cpcalloc(1, sizeof(cpSolver));
+	solver->pool = cpThreadPoolNew(threads);
+	cpBodyInitStatic(&solver->dummy);
+	
+	return solver;
+}
+
+void
+cpSolverFree(cpSolver *solver)
+{
+	if(solver){
+		cpThreadPoolFree(solver->pool);
+		cpBodyDestroy(&solver->dummy);
+		
+		cpfree(solver->batches);
+		cpfree(solver->constraints);
+		cpfree(solver->colors);
+		cpfree(solver);
+	}
+}
+
+int
+cpSolverGetThreadCount(cpSolver *solver)
+{
+	return cpThreadPoolGetThreadCount(solver->pool);
+}
@@ -0,0 +1,39 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+ 
+// Batched impulse solver, used by cpSpaceStep() after cpSpaceUseBatchedSolver().
+// The contacts and constraints are colored so that no two of the same color share
+// a non static body. The contacts of a color are packed in batches solved 4 at a
+// time with SIMD instructions and the work of each color is split between the threads.
+
+typedef struct cpSolver cpSolver;
+
+cpSolver *cpSolverNew(int threads);
+void cpSolverFree(cpSolver *solver);
+
+int cpSolverGetThreadCount(cpSolver *solver);
+
+// Colors the arbiters and constraints of the step. Call it after they have been prestepped.
+void cpSolverPrepare(cpSolver *solver, cpArray *arbiters, cpArray *constraints);
+
+// Same as calling cpArbiterApplyImpulse() and applyImpulse() on the prepared arbiters
+// and constraints iterations times, up to the order they are solved in.
+void cpSolverApplyImpulses(cpSolver *solver, int iterations, cpFloat eCoef);
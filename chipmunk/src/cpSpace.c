@@ -25,6 +25,7 @@
 #include <math.h>
 
 #include "chipmunk_private.h"
+#include "cpSolver.h"
 
 cpTimestamp cp_contact_persistence = 3;
 
@@ -83,9 +84,12 @@ collFuncSetTrans(cpCollisionHandler *handler, void *unused)
 static cpBool alwaysCollide(cpArbiter *arb, cpSpace *space, void *data){return 1;}
 static void nothing(cpArbiter *arb, cpSpace *space, void *data){}
 
-// BBfunc callback for the spatial hash.
+// BBfunc callback for the spatial indexes.
 static cpBB shapeBBFunc(cpShape *shape){return shape->bb;}
 
+// Velocity callback for the active shape tree.
+static cpVect shapeVelocityFunc(cpShape *shape){return shape->body->v;}
+
 // Iterator functions for destructors.
 static void             freeWrap(void         *ptr, void *unused){            cpfree(ptr);}
 static void        shapeFreeWrap(cpShape      *ptr, void *unused){     cpShapeFree(ptr);}
@@ -100,8 +104,7 @@ cpSpaceAlloc(void)
 	return (cpSpace *)cpcalloc(1, sizeof(cpSpace));
 }
 
-#define DEFAULT_DIM_SIZE 100.0f
-#define DEFAULT_COUNT 1000
+#define DEFAULT_MARGIN 0.1f
 #define DEFAULT_ITERATIONS 10
 #define DEFAULT_ELASTIC_ITERATIONS 0
 
@@ -120,8 +123,11 @@ cpSpaceInit(cpSpace *space)
 	space->locked = 0;
 	space->stamp = 0;
 
-	space->staticShapes = cpSpaceHashNew(DEFAULT_DIM_SIZE, DEFAULT_COUNT, (cpSpaceHashBBFunc)shapeBBFunc);
-	space->activeShapes = cpSpaceHashNew(DEFAULT_DIM_SIZE, DEFAULT_COUNT, (cpSpaceHashBBFunc)shapeBBFunc);
+	cpBBTree *activeTree = cpBBTreeNew((cpSpatialIndexBBFunc)shapeBBFunc, DEFAULT_MARGIN);
+	cpBBTreeSetVelocityFunc(activeTree, (cpBBTreeVelocityFunc)shapeVelocityFunc);
+	
+	space->staticShapes = (cpSpatialIndex *)cpBBTreeNew((cpSpatialIndexBBFunc)shapeBBFunc, 0.0f);
+	space->activeShapes = (cpSpatialIndex *)activeTree;
 	
 	space->allocatedBuffers = cpArrayNew(0);
 	
@@ -146,6 +152,8 @@ cpSpaceInit(cpSpace *space)
 	
 	space->postStepCallbacks = NULL;
 	
+	space->solver = NULL;
+	
 	cpBodyInitStatic(&space->staticBody);
 	
 	return space;
@@ -160,8 +168,8 @@ cpSpaceNew(void)
 void
 cpSpaceDestroy(cpSpace *space)
 {
-	cpSpaceHashFree(space->staticShapes);
-	cpSpaceHashFree(space->activeShapes);
+	cpSpatialIndexFree(space->staticShapes);
+	cpSpatialIndexFree(space->activeShapes);
 	
 	cpArrayFree(space->bodies);
 	cpArrayFree(space->sleepingComponents);
@@ -182,6 +190,8 @@ cpSpaceDestroy(cpSpace *space)
 	
 	if(space->collFuncSet) cpHashSetEach(space->collFuncSet, freeWrap, NULL);
 	cpHashSetFree(space->collFuncSet);
+	
+	cpSolverFree(space->solver);
 }
 
 void
@@ -199,8 +209,8 @@ cpSpaceFreeChildren(cpSpace *space)
 	cpArray *components = space->sleepingComponents;
 	while(components->num) cpBodyActivate((cpBody *)components->arr[0]);
 	
-	cpSpaceHashEach(space->staticShapes, (cpSpaceHashIterator)&shapeFreeWrap, NULL);
-	cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)&shapeFreeWrap, NULL);
+	cpSpatialIndexEach(space->staticShapes, (cpSpatialIndexIterator)&shapeFreeWrap, NULL);
+	cpSpatialIndexEach(space->activeShapes, (cpSpatialIndexIterator)&shapeFreeWrap, NULL);
 	cpArrayEach(space->bodies,           (cpArrayIter)&bodyFreeWrap,          NULL);
 	cpArrayEach(space->constraints,      (cpArrayIter)&constraintFreeWrap,    NULL);
 }
@@ -303,7 +313,7 @@ cpSpaceAddShape(cpSpace *space, cpShape *shape)
 	cpBody *body = shape->body;
 	if(!body || cpBodyIsStatic(body)) return cpSpaceAddStaticShape(space, shape);
 	
-	cpAssert(!cpHashSetFind(space->activeShapes->handleSet, shape->hashid, shape),
+	cpAssert(!cpSpatialIndexContains(space->activeShapes, shape, shape->hashid),
 		"Cannot add the same shape more than once.");
 	cpAssertSpaceUnlocked(space);
 	
@@ -311,7 +321,7 @@ cpSpaceAddShape(cpSpace *space, cpShape *shape)
 	cpBodyAddShape(body, shape);
 	
 	cpShapeCacheBB(shape);
-	cpSpaceHashInsert(space->activeShapes, shape, shape->hashid, shape->bb);
+	cpSpatialIndexInsert(space->activeShapes, shape, shape->hashid);
 		
 	return shape;
 }
@@ -319,7 +329,7 @@ cpSpaceAddShape(cpSpace *space, cpShape *shape)
 cpShape *
 cpSpaceAddStaticShape(cpSpace *space, cpShape *shape)
 {
-	cpAssert(!cpHashSetFind(space->staticShapes->handleSet, shape->hashid, shape),
+	cpAssert(!cpSpatialIndexContains(space->staticShapes, shape, shape->hashid),
 		"Cannot add the same static shape more than once.");
 	cpAssertSpaceUnlocked(space);
 	
@@ -327,7 +337,7 @@ cpSpaceAddStaticShape(cpSpace *space, cpShape *shape)
 	
 	cpShapeCacheBB(shape);
 	cpSpaceActivateShapesTouchingShape(space, shape);
-	cpSpaceHashInsert(space->staticShapes, shape, shape->hashid, shape->bb);
+	cpSpatialIndexInsert(space->staticShapes, shape, shape->hashid);
 	
 	return shape;
 }
@@ -394,26 +404,26 @@ cpSpaceRemoveShape(cpSpace *space, cpShape *shape)
 	cpBodyActivate(body);
 	
 	cpAssertSpaceUnlocked(space);
-	cpAssertWarn(cpHashSetFind(space->activeShapes->handleSet, shape->hashid, shape),
+	cpAssertWarn(cpSpatialIndexContains(space->activeShapes, shape, shape->hashid),
 		"Cannot remove a shape that was not added to the space. (Removed twice maybe?)");
 	
 	cpBodyRemoveShape(body, shape);
 	
 	removalContext context = {space, shape};
 	cpHashSetFilter(space->contactSet, (cpHashSetFilterFunc)contactSetFilterRemovedShape, &context);
-	cpSpaceHashRemove(space->activeShapes, shape, shape->hashid);
+	cpSpatialIndexRemove(space->activeShapes, shape, shape->hashid);
 }
 
 void
 cpSpaceRemoveStaticShape(cpSpace *space, cpShape *shape)
 {
-	cpAssertWarn(cpHashSetFind(space->staticShapes->handleSet, shape->hashid, shape),
+	cpAssertWarn(cpSpatialIndexContains(space->staticShapes, shape, shape->hashid),
 		"Cannot remove a static or sleeping shape that was not added to the space. (Removed twice maybe?)");
 	cpAssertSpaceUnlocked(space);
 	
 	removalContext context = {space, shape};
 	cpHashSetFilter(space->contactSet, (cpHashSetFilterFunc)contactSetFilterRemovedShape, &context);
-	cpSpaceHashRemove(space->staticShapes, shape, shape->hashid);
+	cpSpatialIndexRemove(space->staticShapes, shape, shape->hashid);
 	
 	cpSpaceActivateShapesTouchingShape(space, shape);
 }
@@ -442,28 +452,63 @@ cpSpaceRemoveConstraint(cpSpace *space, cpConstraint *constraint)
 	cpArrayDeleteObj(space->constraints, constraint);
 }
 
-#pragma mark Spatial Hash Management
+#pragma mark Spatial Index Management
 
 static void updateBBCache(cpShape *shape, void *unused){cpShapeCacheBB(shape);}
 
+static void copyShape(cpShape *shape, cpSpatialIndex *index){cpSpatialIndexInsert(index, shape, shape->hashid);}
+
+// Move the shapes of index to a new spatial hash, frees index.
+static cpSpatialIndex *
+spatialHashForIndex(cpSpatialIndex *index, cpFloat dim, int count)
+{
+	cpSpatialIndex *hash = (cpSpatialIndex *)cpSpaceHashNew(dim, count, (cpSpaceHashBBFunc)shapeBBFunc);
+	cpSpatialIndexEach(index, (cpSpatialIndexIterator)copyShape, hash);
+	cpSpatialIndexFree(index);
+	
+	return hash;
+}
+
+void
+cpSpaceUseSpatialHash(cpSpace *space, cpFloat dim, int count)
+{
+	cpAssertSpaceUnlocked(space);
+	
+	if(cpSpaceHashFromIndex(space->staticShapes)){
+		cpSpaceResizeStaticHash(space, dim, count);
+	} else {
+		space->staticShapes = spatialHashForIndex(space->staticShapes, dim, count);
+	}
+	
+	if(cpSpaceHashFromIndex(space->activeShapes)){
+		cpSpaceResizeActiveHash(space, dim, count);
+	} else {
+		space->activeShapes = spatialHashForIndex(space->activeShapes, dim, count);
+	}
+}
+
 void
 cpSpaceResizeStaticHash(cpSpace *space, cpFloat dim, int count)
 {
-	cpSpaceHashResize(space->staticShapes, dim, count);
-	cpSpaceHashRehash(space->staticShapes);
+	cpSpaceHash *hash = cpSpaceHashFromIndex(space->staticShapes);
+	if(hash){
+		cpSpaceHashResize(hash, dim, count);
+		cpSpaceHashRehash(hash);
+	}
 }
 
 void
 cpSpaceResizeActiveHash(cpSpace *space, cpFloat dim, int count)
 {
-	cpSpaceHashResize(space->activeShapes, dim, count);
+	cpSpaceHash *hash = cpSpaceHashFromIndex(space->activeShapes);
+	if(hash) cpSpaceHashResize(hash, dim, count);
 }
 
 void 
 cpSpaceRehashStatic(cpSpace *space)
 {
-	cpSpaceHashEach(space->staticShapes, (cpSpaceHashIterator)&updateBBCache, NULL);
-	cpSpaceHashRehash(space->staticShapes);
+	cpSpatialIndexEach(space->staticShapes, (cpSpatialIndexIterator)&updateBBCache, NULL);
+	cpSpatialIndexReindex(space->staticShapes);
 }
 
 void
@@ -471,9 +516,35 @@ cpSpaceRehashShape(cpSpace *space, cpShape *shape)
 {
 	cpShapeCacheBB(shape);
 	
-	// attempt to rehash the shape in both hashes
-	cpSpaceHashRehashObject(space->activeShapes, shape, shape->hashid);
-	cpSpaceHashRehashObject(space->staticShapes, shape, shape->hashid);
+	// attempt to rehash the shape in both indexes
+	cpSpatialIndexReindexObject(space->activeShapes, shape, shape->hashid);
+	cpSpatialIndexReindexObject(space->staticShapes, shape, shape->hashid);
+}
+
+#pragma mark Solver Management
+
+void
+cpSpaceUseBatchedSolver(cpSpace *space, int threads)
+{
+	cpAssertSpaceUnlocked(space);
+	
+	cpSolverFree(space->solver);
+	space->solver = cpSolverNew(threads);
+}
+
+int
+cpSpaceGetSolverThreadCount(cpSpace *space)
+{
+	return (space->solver ? cpSolverGetThreadCount(space->solver) : 0);
+}
+
+void
+cpSpaceUseSerialSolver(cpSpace *space)
+{
+	cpAssertSpaceUnlocked(space);
+	
+	cpSolverFree(space->solver);
+	space->solver = NULL;
 }
 
 void
@@ -67,8 +67,8 @@ cpSpaceActivateBody(cpSpace *space, cpBody *body)
 	} else {
 		cpArrayPush(space->bodies, body);
 		for(cpShape *shape=body->shapesList; shape; shape=shape->next){
-			cpSpaceHashRemove(space->staticShapes, shape, shape->hashid);
-			cpSpaceHashInsert(space->activeShapes, shape, shape->hashid, shape->bb);
+			cpSpatialIndexRemove(space->staticShapes, shape, shape->hashid);
+			cpSpatialIndexInsert(space->activeShapes, shape, shape->hashid);
 		}
 	}
 }
@@ -217,8 +217,8 @@ cpSpaceProcessComponents(cpSpace *space, cpFloat dt)
 				next = body->node.next;
 				
 				for(cpShape *shape = body->shapesList; shape; shape = shape->next){
-					cpSpaceHashRemove(space->activeShapes, shape, shape->hashid);
-					cpSpaceHashInsert(space->staticShapes, shape, shape->hashid, shape->bb);
+					cpSpatialIndexRemove(space->activeShapes, shape, shape->hashid);
+					cpSpatialIndexInsert(space->staticShapes, shape, shape->hashid);
 				}
 			} while((body = next) != root);
 			
@@ -251,8 +251,8 @@ cpBodySleepWithGroup(cpBody *body, cpBody *group){
 	
 	for(cpShape *shape = body->shapesList; shape; shape = shape->next){
 		cpShapeCacheBB(shape);
-		cpSpaceHashRemove(space->activeShapes, shape, shape->hashid);
-		cpSpaceHashInsert(space->staticShapes, shape, shape->hashid, shape->bb);
+		cpSpatialIndexRemove(space->activeShapes, shape, shape->hashid);
+		cpSpatialIndexInsert(space->staticShapes, shape, shape->hashid);
 	}
 	
 	if(group){
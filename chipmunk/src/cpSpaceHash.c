@@ -84,12 +84,15 @@ handleSetTrans(void *obj, cpSpaceHash *hash)
 	return hand;
 }
 
+static inline cpSpatialIndexClass *Klass(void);
+
 cpSpaceHash*
 cpSpaceHashInit(cpSpaceHash *hash, cpFloat celldim, int numcells, cpSpaceHashBBFunc bbfunc)
 {
+	cpSpatialIndexInit(&hash->spatialIndex, Klass(), bbfunc);
+	
 	cpSpaceHashAllocTable(hash, next_prime(numcells));
 	hash->celldim = celldim;
-	hash->bbfunc = bbfunc;
 	
 	hash->handleSet = cpHashSetNew(0, (cpHashSetEqlFunc)handleSetEql, (cpHashSetTransFunc)handleSetTrans);
 	hash->pooledHandles = cpArrayNew(0);
@@ -258,7 +261,7 @@ void
 cpSpaceHashInsert(cpSpaceHash *hash, void *obj, cpHashValue hashid, cpBB _deprecated_unused)
 {
 	cpHandle *hand = (cpHandle *)cpHashSetInsert(hash->handleSet, hashid, obj, hash);
-	hashHandle(hash, hand, hash->bbfunc(obj));
+	hashHandle(hash, hand, hash->spatialIndex.bbfunc(obj));
 }
 
 void
@@ -274,7 +277,7 @@ cpSpaceHashRehashObject(cpSpaceHash *hash, void *obj, cpHashValue hashid)
 	}
 }
 
-static void handleRehashHelper(cpHandle *hand, cpSpaceHash *hash){hashHandle(hash, hand, hash->bbfunc(hand->obj));}
+static void handleRehashHelper(cpHandle *hand, cpSpaceHash *hash){hashHandle(hash, hand, hash->spatialIndex.bbfunc(hand->obj));}
 
 void
 cpSpaceHashRehash(cpSpaceHash *hash)
@@ -409,7 +412,7 @@ handleQueryRehashHelper(void *elt, void *data)
 	int n = hash->numcells;
 
 	void *obj = hand->obj;
-	cpBB bb = hash->bbfunc(obj);
+	cpBB bb = hash->spatialIndex.bbfunc(obj);
 
 	int l = floor_int(bb.l/dim);
 	int r = floor_int(bb.r/dim);
@@ -532,3 +535,36 @@ void cpSpaceHashSegmentQuery(cpSpaceHash *hash, void *obj, cpVect a, cpVect b, c
 	
 	hash->stamp++;
 }
+
+#pragma mark Spatial Index Class
+
+static int countImpl(cpSpaceHash *hash){return hash->handleSet->entries;}
+static cpBool containsImpl(cpSpaceHash *hash, void *obj, cpHashValue hashid){return cpHashSetFind(hash->handleSet, hashid, obj) != NULL;}
+static void insertImpl(cpSpaceHash *hash, void *obj, cpHashValue hashid){cpSpaceHashInsert(hash, obj, hashid, cpBBNew(0.0f, 0.0f, 0.0f, 0.0f));}
+
+static cpSpatialIndexClass klass = {
+	(void (*)(cpSpatialIndex *))cpSpaceHashDestroy,
+	
+	(int (*)(cpSpatialIndex *))countImpl,
+	(void (*)(cpSpatialIndex *, cpSpatialIndexIterator, void *))cpSpaceHashEach,
+	(cpBool (*)(cpSpatialIndex *, void *, cpHashValue))containsImpl,
+	
+	(void (*)(cpSpatialIndex *, void *, cpHashValue))insertImpl,
+	(void (*)(cpSpatialIndex *, void *, cpHashValue))cpSpaceHashRemove,
+	
+	(void (*)(cpSpatialIndex *))cpSpaceHashRehash,
+	(void (*)(cpSpatialIndex *, void *, cpHashValue))cpSpaceHashRehashObject,
+	(void (*)(cpSpatialIndex *, cpSpatialIndexQueryFunc, void *))cpSpaceHashQueryRehash,
+	
+	(void (*)(cpSpatialIndex *, cpVect, cpSpatialIndexQueryFunc, void *))cpSpaceHashPointQuery,
+	(void (*)(cpSpatialIndex *, void *, cpVect, cpVect, cpFloat, cpSpatialIndexSegmentQueryFunc, void *))cpSpaceHashSegmentQuery,
+	(void (*)(cpSpatialIndex *, void *, cpBB, cpSpatialIndexQueryFunc, void *))cpSpaceHashQuery,
+};
+
+static inline cpSpatialIndexClass *Klass(void){return &klass;}
+
+cpSpaceHash *
+cpSpaceHashFromIndex(cpSpatialIndex *index)
+{
+	return (index && index->klass == Klass() ? (cpSpaceHash *)index : NULL);
+}
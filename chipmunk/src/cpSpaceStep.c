@@ -24,6 +24,7 @@
 #include <math.h>
 
 #include "chipmunk_private.h"
+#include "cpSolver.h"
 
 #pragma mark Post Step Callback Functions
 
@@ -164,7 +165,7 @@ queryReject(cpShape *a, cpShape *b)
 		|| !(a->layers & b->layers);
 }
 
-// Callback from the spatial hash.
+// Callback from the spatial indexes.
 static void
 queryFunc(cpShape *a, cpShape *b, cpSpace *space)
 {
@@ -225,11 +226,11 @@ queryFunc(cpShape *a, cpShape *b, cpSpace *space)
 	arb->stamp = space->stamp;
 }
 
-// Iterator for active/static hash collisions.
+// Iterator for active/static index collisions.
 static void
 active2staticIter(cpShape *shape, cpSpace *space)
 {
-	cpSpaceHashQuery(space->staticShapes, shape, shape->bb, (cpSpaceHashQueryFunc)queryFunc, space);
+	cpSpatialIndexQuery(space->staticShapes, shape, shape->bb, (cpSpatialIndexQueryFunc)queryFunc, space);
 }
 
 // Hashset filter func to throw away old arbiters.
@@ -309,15 +310,15 @@ cpSpaceStep(cpSpace *space, cpFloat dt)
 	}
 	
 	// Pre-cache BBoxes and shape data.
-	cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)updateBBCache, NULL);
+	cpSpatialIndexEach(space->activeShapes, (cpSpatialIndexIterator)updateBBCache, NULL);
 	
 	cpSpaceLock(space);
 	
 	// Collide!
 	cpSpacePushFreshContactBuffer(space);
-	if(space->staticShapes->handleSet->entries)
-		cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)active2staticIter, space);
-	cpSpaceHashQueryRehash(space->activeShapes, (cpSpaceHashQueryFunc)queryFunc, space);
+	if(cpSpatialIndexCount(space->staticShapes))
+		cpSpatialIndexEach(space->activeShapes, (cpSpatialIndexIterator)active2staticIter, space);
+	cpSpatialIndexReindexQuery(space->activeShapes, (cpSpatialIndexQueryFunc)queryFunc, space);
 	
 	cpSpaceUnlock(space);
 	
@@ -341,13 +342,19 @@ cpSpaceStep(cpSpace *space, cpFloat dt)
 		constraint->klass->preStep(constraint, dt, dt_inv);
 	}
 
-	for(int i=0; i<space->elasticIterations; i++){
-		for(int j=0; j<arbiters->num; j++)
-			cpArbiterApplyImpulse((cpArbiter *)arbiters->arr[j], 1.0f);
-			
-		for(int j=0; j<constraints->num; j++){
-			cpConstraint *constraint = (cpConstraint *)constraints->arr[j];
-			constraint->klass->applyImpulse(constraint);
+	cpSolver *solver = space->solver;
+	if(solver){
+		cpSolverPrepare(solver, arbiters, constraints);
+		cpSolverApplyImpulses(solver, space->elasticIterations, 1.0f);
+	} else {
+		for(int i=0; i<space->elasticIterations; i++){
+			for(int j=0; j<arbiters->num; j++)
+				cpArbiterApplyImpulse((cpArbiter *)arbiters->arr[j], 1.0f);
+				
+			for(int j=0; j<constraints->num; j++){
+				cpConstraint *constraint = (cpConstraint *)constraints->arr[j];
+				constraint->klass->applyImpulse(constraint);
+			}
 		}
 	}
 
@@ -365,13 +372,17 @@ cpSpaceStep(cpSpace *space, cpFloat dt)
 	cpFloat elasticCoef = (space->elasticIterations ? 0.0f : 1.0f);
 	
 	// Run the impulse solver.
-	for(int i=0; i<space->iterations; i++){
-		for(int j=0; j<arbiters->num; j++)
-			cpArbiterApplyImpulse((cpArbiter *)arbiters->arr[j], elasticCoef);
-			
-		for(int j=0; j<constraints->num; j++){
-			cpConstraint *constraint = (cpConstraint *)constraints->arr[j];
-			constraint->klass->applyImpulse(constraint);
+	if(solver){
+		cpSolverApplyImpulses(solver, space->iterations, elasticCoef);
+	} else {
+		for(int i=0; i<space->iterations; i++){
+			for(int j=0; j<arbiters->num; j++)
+				cpArbiterApplyImpulse((cpArbiter *)arbiters->arr[j], elasticCoef);
+				
+			for(int j=0; j<constraints->num; j++){
+				cpConstraint *constraint = (cpConstraint *)constraints->arr[j];
+				constraint->klass->applyImpulse(constraint);
+			}
 		}
 	}
 	
@@ -0,0 +1,335 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+ 
+#include <stdlib.h>
+
+#include "chipmunk_private.h"
+#include "cpThreadPool.h"
+
+#if defined(_WIN32)
+	#include <windows.h>
+	#define CP_WIN32_THREADS 1
+	// Windows Store apps can't call CreateThread(), cpThreadPoolStore.cpp starts the workers.
+	#if defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_APP
+		#define CP_STORE_THREADS 1
+	#endif
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <pthread.h>
+	#include <sched.h>
+	#define CP_PTHREADS 1
+#endif
+
+// How many times a thread checks a barrier before yielding its time slice.
+#define BARRIER_SPINS 1000
+
+typedef struct cpThreadPoolWorker {
+	cpThreadPool *pool;
+	int index;
+} cpThreadPoolWorker;
+
+struct cpThreadPool {
+	int threadCount;
+	
+	// Function and data of the current run.
+	cpThreadPoolFunc func;
+	void *data;
+	
+	// Incremented to start a run, the workers remember the last one they did.
+	int generation;
+	// Workers that haven't finished the current run.
+	int running;
+	cpBool quit;
+	
+	// Sense reversing barrier, only accessed with the atomic functions.
+	volatile long barrierCount;
+	volatile long barrierSense;
+	int senses[CP_MAX_POOL_THREADS];
+	
+	cpThreadPoolWorker workers[CP_MAX_POOL_THREADS];
+	
+#if CP_PTHREADS
+	pthread_t threads[CP_MAX_POOL_THREADS];
+	pthread_mutex_t mutex;
+	pthread_cond_t wake, done;
+#elif CP_STORE_THREADS
+	void *threads[CP_MAX_POOL_THREADS];
+	CRITICAL_SECTION mutex;
+	CONDITION_VARIABLE wake, done;
+#elif CP_WIN32_THREADS
+	HANDLE threads[CP_MAX_POOL_THREADS];
+	CRITICAL_SECTION mutex;
+	CONDITION_VARIABLE wake, done;
+#endif
+};
+
+#pragma mark Platform Functions
+
+#if CP_PTHREADS
+
+static inline void poolLock(cpThreadPool *pool){pthread_mutex_lock(&pool->mutex);}
+static inline void poolUnlock(cpThreadPool *pool){pthread_mutex_unlock(&pool->mutex);}
+static inline void poolWait(cpThreadPool *pool, pthread_cond_t *cond){pthread_cond_wait(cond, &pool->mutex);}
+static inline void poolBroadcast(pthread_cond_t *cond){pthread_cond_broadcast(cond);}
+
+static inline long atomicDecrement(volatile long *value){return __atomic_sub_fetch(value, 1, __ATOMIC_ACQ_REL);}
+static inline long atomicLoad(volatile long *value){return __atomic_load_n(value, __ATOMIC_ACQUIRE);}
+static inline void atomicStore(volatile long *value, long v){__atomic_store_n(value, v, __ATOMIC_RELEASE);}
+static inline void yieldThread(void){sched_yield();}
+
+#elif CP_WIN32_THREADS
+
+static inline void poolLock(cpThreadPool *pool){EnterCriticalSection(&pool->mutex);}
+static inline void poolUnlock(cpThreadPool *pool){LeaveCriticalSection(&pool->mutex);}
+static inline void poolWait(cpThreadPool *pool, CONDITION_VARIABLE *cond){SleepConditionVariableCS(cond, &pool->mutex, INFINITE);}
+static inline void poolBroadcast(CONDITION_VARIABLE *cond){WakeAllConditionVariable(cond);}
+
+static inline long atomicDecrement(volatile long *value){return InterlockedDecrement(value);}
+static inline long atomicLoad(volatile long *value){return InterlockedCompareExchange(value, 0, 0);}
+static inline void atomicStore(volatile long *value, long v){InterlockedExchange(value, v);}
+#if CP_STORE_THREADS
+static inline void yieldThread(void){YieldProcessor();}
+#else
+static inline void yieldThread(void){SwitchToThread();}
+#endif
+
+#endif
+
+#pragma mark Worker Threads
+
+#if CP_PTHREADS || CP_WIN32_THREADS
+
+static void
+workerLoop(cpThreadPoolWorker *worker)
+{
+	cpThreadPool *pool = worker->pool;
+	int generation = 0;
+	
+	for(;;){
+		poolLock(pool);
+		while(pool->generation == generation && !pool->quit) poolWait(pool, &pool->wake);
+		
+		if(pool->quit){
+			poolUnlock(pool);
+			return;
+		}
+		
+		generation = pool->generation;
+		poolUnlock(pool);
+		
+		pool->func(worker->index, pool->data);
+		
+		poolLock(pool);
+		pool->running--;
+		if(pool->running == 0) poolBroadcast(&pool->done);
+		poolUnlock(pool);
+	}
+}
+
+#endif
+
+#if CP_PTHREADS
+
+static void *
+workerMain(void *worker)
+{
+	workerLoop((cpThreadPoolWorker *)worker);
+	return NULL;
+}
+
+static cpBool
+startWorker(cpThreadPool *pool, int index)
+{
+	return (pthread_create(&pool->threads[index], NULL, workerMain, &pool->workers[index]) == 0);
+}
+
+static void
+joinWorker(cpThreadPool *pool, int index)
+{
+	pthread_join(pool->threads[index], NULL);
+}
+
+#elif CP_STORE_THREADS
+
+static void
+workerMain(void *worker)
+{
+	workerLoop((cpThreadPoolWorker *)worker);
+}
+
+static cpBool
+startWorker(cpThreadPool *pool, int index)
+{
+	pool->threads[index] = cpStoreThreadStart(workerMain, &pool->workers[index]);
+	return (pool->threads[index] != NULL);
+}
+
+static void
+joinWorker(cpThreadPool *pool, int index)
+{
+	cpStoreThreadJoin(pool->threads[index]);
+}
+
+#elif CP_WIN32_THREADS
+
+static DWORD WINAPI
+workerMain(LPVOID worker)
+{
+	workerLoop((cpThreadPoolWorker *)worker);
+	return 0;
+}
+
+static cpBool
+startWorker(cpThreadPool *pool, int index)
+{
+	pool->threads[index] = CreateThread(NULL, 0, workerMain, &pool->workers[index], 0, NULL);
+	return (pool->threads[index] != NULL);
+}
+
+static void
+joinWorker(cpThreadPool *pool, int index)
+{
+	WaitForSingleObject(pool->threads[index], INFINITE);
+	CloseHandle(pool->threads[index]);
+}
+
+#endif
+
+#pragma mark Pool Functions
+
+cpThreadPool *
+cpThreadPoolNew(int threads)
+{
+	cpThreadPool *pool = (cpThreadPool *)cpcalloc(1, sizeof(cpThreadPool));
+	
+	if(threads > CP_MAX_POOL_THREADS) threads = CP_MAX_POOL_THREADS;
+	
+	pool->threadCount = 1;
+	
+#if CP_PTHREADS
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	pthread_cond_init(&pool->done, NULL);
+#elif CP_WIN32_THREADS
+	// The Ex version is the one available to Windows Store apps.
+	InitializeCriticalSectionEx(&pool->mutex, 0, 0);
+	InitializeConditionVariable(&pool->wake);
+	InitializeConditionVariable(&pool->done);
+#endif
+	
+#if CP_PTHREADS || CP_WIN32_THREADS
+	// Thread 0 is the one calling cpThreadPoolRun().
+	for(int i=1; i<threads; i++){
+		pool->workers[i].pool = pool;
+		pool->workers[i].index = i;
+		
+		if(!startWorker(pool, i)) break;
+		pool->threadCount++;
+	}
+#endif
+	
+	// Not an assertion, the solver still works, but a benchmark would silently measure a single thread.
+	if(pool->threadCount < threads){
+		cpMessage("cpThreadPoolNew: couldn't start all the threads requested, the pool runs with fewer", "pool->threadCount >= threads", __FILE__, __LINE__, 0);
+	}
+	
+	pool->barrierCount = pool->threadCount;
+	return pool;
+}
+
+void
+cpThreadPoolFree(cpThreadPool *pool)
+{
+	if(!pool) return;
+	
+#if CP_PTHREADS || CP_WIN32_THREADS
+	if(pool->threadCount > 1){
+		poolLock(pool);
+		pool->quit = cpTrue;
+		poolBroadcast(&pool->wake);
+		poolUnlock(pool);
+		
+		for(int i=1; i<pool->threadCount; i++) joinWorker(pool, i);
+	}
+#endif
+	
+#if CP_PTHREADS
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_cond_destroy(&pool->wake);
+	pthread_cond_destroy(&pool->done);
+#elif CP_WIN32_THREADS
+	DeleteCriticalSection(&pool->mutex);
+#endif
+	
+	cpfree(pool);
+}
+
+int
+cpThreadPoolGetThreadCount(cpThreadPool *pool)
+{
+	return pool->threadCount;
+}
+
+void
+cpThreadPoolRun(cpThreadPool *pool, cpThreadPoolFunc func, void *data)
+{
+	if(pool->threadCount == 1){
+		func(0, data);
+		return;
+	}
+	
+#if CP_PTHREADS || CP_WIN32_THREADS
+	poolLock(pool);
+	pool->func = func;
+	pool->data = data;
+	pool->running = pool->threadCount - 1;
+	pool->generation++;
+	poolBroadcast(&pool->wake);
+	poolUnlock(pool);
+	
+	func(0, data);
+	
+	poolLock(pool);
+	while(pool->running) poolWait(pool, &pool->done);
+	poolUnlock(pool);
+#endif
+}
+
+void
+cpThreadPoolBarrier(cpThreadPool *pool, int thread)
+{
+	if(pool->threadCount == 1) return;
+	
+#if CP_PTHREADS || CP_WIN32_THREADS
+	int sense = pool->senses[thread] = !pool->senses[thread];
+	
+	// The decrement releases what this thread wrote before the barrier. The last one in
+	// acquires it from all the others, then releases it to them with the sense.
+	if(atomicDecrement(&pool->barrierCount) == 0){
+		// Last one in, reset the count before releasing the others.
+		atomicStore(&pool->barrierCount, pool->threadCount);
+		atomicStore(&pool->barrierSense, sense);
+	} else {
+		for(int spins=0; atomicLoad(&pool->barrierSense) != sense; spins++){
+			if(spins >= BARRIER_SPINS) yieldThread();
+		}
+	}
+#endif
+}
@@ -0,0 +1,57 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+ 
+// Minimal thread pool used by the batched solver.
+// Every thread runs the same function, the calling thread being thread 0, and
+// they can synchronize with cpThreadPoolBarrier(). The workers sleep between runs.
+// Threads are available with pthreads and on Windows, Windows Store apps included.
+// Elsewhere the pool has a single thread and cpThreadPoolNew() warns when more are requested.
+
+typedef struct cpThreadPool cpThreadPool;
+typedef void (*cpThreadPoolFunc)(int thread, void *data);
+
+// Maximum number of threads of a pool, the calling one included.
+#define CP_MAX_POOL_THREADS 16
+
+cpThreadPool *cpThreadPoolNew(int threads);
+void cpThreadPoolFree(cpThreadPool *pool);
+
+int cpThreadPoolGetThreadCount(cpThreadPool *pool);
+
+// Runs func on every thread of the pool and returns once they have all finished.
+void cpThreadPoolRun(cpThreadPool *pool, cpThreadPoolFunc func, void *data);
+
+// Must be called by every thread of the current run.
+// Returns once all of them reached it, memory writes made before are then visible to all.
+void cpThreadPoolBarrier(cpThreadPool *pool, int thread);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Windows Store apps only, implemented with std::thread in cpThreadPoolStore.cpp.
+// Returns NULL when the thread couldn't be started.
+void *cpStoreThreadStart(void (*func)(void *data), void *data);
+void cpStoreThreadJoin(void *thread);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,570 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCBufferRing.h"
+#include "CCDirector.h"
+#include "CCRenderQueue.h"
+#include "ccMacros.h"
+
+#include <string.h>
+
+namespace cocos2d {
+
+static CCDynamicBuffers *g_sharedDynamicBuffers = NULL;
+
+// starting sizes, the rings grow when a frame needs more than half of them
+static const unsigned int kGeometryRingCapacity = 1024 * 1024;
+static const unsigned int kConstantRingCapacity = 256 * 1024;
+
+// a constant buffer range starts on a multiple of 16 constants and spans a multiple of 16 constants
+static const unsigned int kConstantRangeAlignment = 256;
+
+// implementation of CCD3D11BufferRingDevice
+
+CCD3D11BufferRingDevice::CCD3D11BufferRingDevice(void)
+: m_uBindFlags(0)
+, m_pBuffer(NULL)
+, m_pMappedContext(NULL)
+, m_uCompletedFence(0)
+{
+}
+
+CCD3D11BufferRingDevice::~CCD3D11BufferRingDevice(void)
+{
+	for (unsigned int i = 0; i < m_pendingFences.size(); ++i)
+	{
+		m_pendingFences[i].pQuery->Release();
+	}
+	for (unsigned int i = 0; i < m_freeQueries.size(); ++i)
+	{
+		m_freeQueries[i]->Release();
+	}
+	CC_SAFE_RELEASE_NULL_DX(m_pBuffer);
+}
+
+bool CCD3D11BufferRingDevice::initWithBindFlags(UINT uBindFlags)
+{
+	m_uBindFlags = uBindFlags;
+	return true;
+}
+
+bool CCD3D11BufferRingDevice::createBuffer(unsigned int uCapacity)
+{
+	// draws already recorded keep a reference on the previous buffer
+	CC_SAFE_RELEASE_NULL_DX(m_pBuffer);
+
+	D3D11_BUFFER_DESC bufferDesc;
+	ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = uCapacity;
+	bufferDesc.BindFlags = m_uBindFlags;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	HRESULT hr = CCID3D11Device->CreateBuffer(&bufferDesc, NULL, &m_pBuffer);
+	if (FAILED(hr))
+	{
+		CCLOG("cocos2d: CCD3D11BufferRingDevice: could not create a %u bytes buffer (0x%08x)", uCapacity, hr);
+		m_pBuffer = NULL;
+		return false;
+	}
+	return true;
+}
+
+void* CCD3D11BufferRingDevice::map(bool bDiscard)
+{
+	if (! m_pBuffer)
+	{
+		return NULL;
+	}
+
+	ID3D11DeviceContext *pContext = CCID3D11DeviceContext;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	if (FAILED(pContext->Map(m_pBuffer, 0, bDiscard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource)))
+	{
+		return NULL;
+	}
+	m_pMappedContext = pContext;
+	return mappedResource.pData;
+}
+
+void CCD3D11BufferRingDevice::unmap(void)
+{
+	if (m_pMappedContext)
+	{
+		m_pMappedContext->Unmap(m_pBuffer, 0);
+		m_pMappedContext = NULL;
+	}
+}
+
+bool CCD3D11BufferRingDevice::signalFence(unsigned int uFence)
+{
+	// a query can't be read back from a command list that is still being recorded
+	ID3D11DeviceContext *pContext = CCID3D11DeviceContext;
+	if (pContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED)
+	{
+		return false;
+	}
+
+	ID3D11Query *pQuery = NULL;
+	if (m_freeQueries.size())
+	{
+		pQuery = m_freeQueries.back();
+		m_freeQueries.pop_back();
+	}
+	else
+	{
+		D3D11_QUERY_DESC queryDesc;
+		queryDesc.Query = D3D11_QUERY_EVENT;
+		queryDesc.MiscFlags = 0;
+		if (FAILED(CCID3D11Device->CreateQuery(&queryDesc, &pQuery)))
+		{
+			return false;
+		}
+	}
+
+	pContext->End(pQuery);
+
+	ccPendingFence fence = { uFence, pQuery };
+	m_pendingFences.push_back(fence);
+	return true;
+}
+
+unsigned int CCD3D11BufferRingDevice::getCompletedFence(void)
+{
+	if (m_pendingFences.empty())
+	{
+		return m_uCompletedFence;
+	}
+
+	// the render thread of CCRenderPipeline executes and presents on the immediate context,
+	// the fences signaled before it started are still polled from here
+	CCEGLView *pView = CCDirector::sharedDirector()->getOpenGLView();
+	pView->lockImmediateContext();
+
+	// the events complete in order, stop at the first one the GPU didn't reach
+	ID3D11DeviceContext *pContext = pView->GetImmediateContext();
+	unsigned int uCompleted = 0;
+	while (uCompleted < m_pendingFences.size()
+		&& S_OK == pContext->GetData(m_pendingFences[uCompleted].pQuery, NULL, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH))
+	{
+		m_uCompletedFence = m_pendingFences[uCompleted].uFence;
+		m_freeQueries.push_back(m_pendingFences[uCompleted].pQuery);
+		++uCompleted;
+	}
+
+	pView->unlockImmediateContext();
+	m_pendingFences.erase(m_pendingFences.begin(), m_pendingFences.begin() + uCompleted);
+
+	return m_uCompletedFence;
+}
+
+// implementation of CCBufferRing
+
+CCBufferRing::CCBufferRing(void)
+: m_pDevice(NULL)
+, m_uCapacity(0)
+, m_uHead(0)
+, m_uUsed(0)
+, m_uUnfencedBytes(0)
+, m_uFirstFrame(0)
+, m_uFrameCount(0)
+, m_uNextFence(0)
+, m_uFramesSinceStarved(kMaxFramesInFlight)
+, m_bDiscardNext(true)
+, m_bMapped(false)
+, m_pDiscardListener(NULL)
+, m_pfnDiscardSelector(NULL)
+{
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+CCBufferRing::~CCBufferRing(void)
+{
+	if (m_bMapped)
+	{
+		m_pDevice->unmap();
+	}
+	CC_SAFE_RELEASE(m_pDevice);
+}
+
+bool CCBufferRing::initWithDevice(CCBufferRingDevice *pDevice, unsigned int uCapacity)
+{
+	CCAssert(pDevice && uCapacity, "");
+
+	CC_SAFE_RETAIN(pDevice);
+	CC_SAFE_RELEASE(m_pDevice);
+	m_pDevice = pDevice;
+
+	m_uCapacity = uCapacity;
+	discard();
+	return m_pDevice->createBuffer(m_uCapacity);
+}
+
+void* CCBufferRing::map(unsigned int uSize, unsigned int uAlignment, unsigned int *pOffset)
+{
+	CCAssert(! m_bMapped, "the previous range has to be unmapped first");
+	CCAssert(uAlignment && 0 == (uAlignment & (uAlignment - 1)), "the alignment has to be a power of 2");
+
+	unsigned int uStart = (m_uHead + uAlignment - 1) & ~(uAlignment - 1);
+	unsigned int uBytes = uStart - m_uHead + uSize;
+	if (uStart + uSize > m_uCapacity)
+	{
+		// the range can't straddle the end, the bytes left there are skipped
+		uStart = 0;
+		uBytes = m_uCapacity - m_uHead + uSize;
+	}
+
+	bool bDiscard = m_bDiscardNext || uSize > m_uCapacity;
+	bool bStarved = false;
+	if (! bDiscard && m_uUsed + uBytes > m_uCapacity)
+	{
+		retireFrames();
+		bDiscard = bStarved = m_uUsed + uBytes > m_uCapacity;
+	}
+
+	if (bDiscard)
+	{
+		// a frame that takes more than half of the buffer would discard it every frame,
+		// so would frames the GPU lags behind by more than the buffer holds
+		unsigned int uFrameBytes = m_tStats.uBytesThisFrame + uSize;
+		if (uSize > m_uCapacity || (bStarved && (uFrameBytes > m_uCapacity / 2 || m_uFramesSinceStarved < kMaxFramesInFlight)))
+		{
+			unsigned int uCapacity = m_uCapacity * 2;
+			while (uCapacity < uFrameBytes * 2)
+			{
+				uCapacity *= 2;
+			}
+			CCLOG("cocos2d: CCBufferRing: growing from %u to %u bytes", m_uCapacity, uCapacity);
+			if (! m_pDevice->createBuffer(uCapacity))
+			{
+				return NULL;
+			}
+			m_uCapacity = uCapacity;
+			++m_tStats.uGrows;
+		}
+		if (bStarved)
+		{
+			m_uFramesSinceStarved = 0;
+		}
+
+		// whatever was in flight stays readable in the memory the discard leaves behind
+		m_uHead = 0;
+		m_uUsed = 0;
+		m_uUnfencedBytes = 0;
+		m_uFrameCount = 0;
+		m_bDiscardNext = false;
+		uStart = 0;
+		uBytes = uSize;
+
+		++m_tStats.uDiscardsThisFrame;
+		++m_tStats.uTotalDiscards;
+	}
+	else if (0 == uStart && m_uHead)
+	{
+		++m_tStats.uWraps;
+	}
+
+	if (bDiscard && m_pDiscardListener)
+	{
+		(m_pDiscardListener->*m_pfnDiscardSelector)();
+	}
+
+	unsigned char *pData = (unsigned char*)m_pDevice->map(bDiscard);
+	if (! pData)
+	{
+		// the next map starts from a clean buffer
+		m_bDiscardNext = true;
+		return NULL;
+	}
+	m_bMapped = true;
+
+	m_uHead = uStart + uSize;
+	m_uUsed += uBytes;
+	m_uUnfencedBytes += uBytes;
+
+	++m_tStats.uAllocationsThisFrame;
+	++m_tStats.uTotalAllocations;
+	m_tStats.uBytesThisFrame += uBytes;
+
+	*pOffset = uStart;
+	return pData + uStart;
+}
+
+void CCBufferRing::unmap(void)
+{
+	if (m_bMapped)
+	{
+		m_pDevice->unmap();
+		m_bMapped = false;
+	}
+}
+
+bool CCBufferRing::upload(const void *pData, unsigned int uSize, unsigned int uAlignment, unsigned int *pOffset)
+{
+	void *pDest = map(uSize, uAlignment, pOffset);
+	if (! pDest)
+	{
+		return false;
+	}
+	memcpy(pDest, pData, uSize);
+	unmap();
+	return true;
+}
+
+void CCBufferRing::frameEnded(void)
+{
+	if (m_tStats.uBytesThisFrame > m_tStats.uPeakFrameBytes)
+	{
+		m_tStats.uPeakFrameBytes = m_tStats.uBytesThisFrame;
+	}
+	m_tStats.uAllocationsThisFrame = 0;
+	m_tStats.uBytesThisFrame = 0;
+	m_tStats.uDiscardsThisFrame = 0;
+
+	if (m_uFramesSinceStarved < kMaxFramesInFlight)
+	{
+		++m_uFramesSinceStarved;
+	}
+
+	if (m_uUnfencedBytes && m_pDevice->signalFence(m_uNextFence + 1))
+	{
+		++m_uNextFence;
+		if (m_uFrameCount < kMaxFramesInFlight)
+		{
+			ccRingFrame& frame = m_frames[(m_uFirstFrame + m_uFrameCount) % kMaxFramesInFlight];
+			frame.uFence = m_uNextFence;
+			frame.uBytes = m_uUnfencedBytes;
+			++m_uFrameCount;
+		}
+		else
+		{
+			// the newest frame now ends with this one, its bytes are freed a little later
+			ccRingFrame& frame = m_frames[(m_uFirstFrame + m_uFrameCount - 1) % kMaxFramesInFlight];
+			frame.uFence = m_uNextFence;
+			frame.uBytes += m_uUnfencedBytes;
+		}
+		m_uUnfencedBytes = 0;
+	}
+
+	// polled every frame so the device doesn't pile up fences
+	retireFrames();
+}
+
+void CCBufferRing::discard(void)
+{
+	m_bDiscardNext = true;
+}
+
+void CCBufferRing::setDiscardListener(CCObject *pTarget, SEL_CallFunc pfnSelector)
+{
+	m_pDiscardListener = pTarget;
+	m_pfnDiscardSelector = pTarget ? pfnSelector : NULL;
+}
+
+void CCBufferRing::retireFrames(void)
+{
+	if (! m_uFrameCount)
+	{
+		return;
+	}
+
+	unsigned int uCompleted = m_pDevice->getCompletedFence();
+	while (m_uFrameCount && m_frames[m_uFirstFrame].uFence <= uCompleted)
+	{
+		m_uUsed -= m_frames[m_uFirstFrame].uBytes;
+		m_uFirstFrame = (m_uFirstFrame + 1) % kMaxFramesInFlight;
+		--m_uFrameCount;
+	}
+}
+
+// implementation of CCDynamicBuffers
+
+CCDynamicBuffers::CCDynamicBuffers(void)
+: m_pGeometryRing(NULL)
+, m_pConstantRing(NULL)
+, m_pGeometryDevice(NULL)
+, m_pConstantDevice(NULL)
+, m_bConstantRanges(false)
+, m_pFallbackConstants(NULL)
+, m_uFallbackSize(0)
+{
+}
+
+CCDynamicBuffers::~CCDynamicBuffers(void)
+{
+	CCLOGINFO("cocos2d: deallocing CCDynamicBuffers.");
+	CC_SAFE_RELEASE(m_pGeometryRing);
+	CC_SAFE_RELEASE(m_pConstantRing);
+	CC_SAFE_RELEASE(m_pGeometryDevice);
+	CC_SAFE_RELEASE(m_pConstantDevice);
+	CC_SAFE_RELEASE_NULL_DX(m_pFallbackConstants);
+}
+
+CCDynamicBuffers* CCDynamicBuffers::sharedDynamicBuffers(void)
+{
+	if (! g_sharedDynamicBuffers)
+	{
+		g_sharedDynamicBuffers = new CCDynamicBuffers();
+		g_sharedDynamicBuffers->init();
+	}
+	return g_sharedDynamicBuffers;
+}
+
+void CCDynamicBuffers::purgeSharedDynamicBuffers(void)
+{
+	CC_SAFE_RELEASE_NULL(g_sharedDynamicBuffers);
+}
+
+bool CCDynamicBuffers::init(void)
+{
+	m_pGeometryDevice = new CCD3D11BufferRingDevice();
+	m_pGeometryDevice->initWithBindFlags(D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_INDEX_BUFFER);
+	m_pGeometryRing = new CCBufferRing();
+	bool bRet = m_pGeometryRing->initWithDevice(m_pGeometryDevice, kGeometryRingCapacity);
+
+	// binding a range of a constant buffer, and mapping one without discard, are D3D 11.1 options
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+	ZeroMemory(&options, sizeof(options));
+	if (SUCCEEDED(CCID3D11Device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+	{
+		m_bConstantRanges = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+	}
+
+	if (m_bConstantRanges)
+	{
+		m_pConstantDevice = new CCD3D11BufferRingDevice();
+		m_pConstantDevice->initWithBindFlags(D3D11_BIND_CONSTANT_BUFFER);
+		m_pConstantRing = new CCBufferRing();
+		bRet = m_pConstantRing->initWithDevice(m_pConstantDevice, kConstantRingCapacity) && bRet;
+	}
+	else
+	{
+		CCLOG("cocos2d: the driver can't bind constant buffer ranges, the constants are discarded on each draw");
+	}
+
+	return bRet;
+}
+
+void* CCDynamicBuffers::mapVertices(unsigned int uStride, unsigned int uCount, unsigned int *pOffset)
+{
+	return m_pGeometryRing->map(uStride * uCount, 16, pOffset);
+}
+
+void CCDynamicBuffers::unmapVertices(void)
+{
+	m_pGeometryRing->unmap();
+}
+
+void CCDynamicBuffers::bindVertices(UINT uSlot, unsigned int uStride, unsigned int uOffset)
+{
+	// fetched after the map, a ring that grew has a new buffer
+	CCRenderQueue::sharedRenderQueue()->setVertexBuffer(uSlot, m_pGeometryDevice->getBuffer(), uStride, uOffset);
+}
+
+bool CCDynamicBuffers::setVertices(UINT uSlot, const void *pVertices, unsigned int uStride, unsigned int uCount)
+{
+	unsigned int uOffset = 0;
+	if (! m_pGeometryRing->upload(pVertices, uStride * uCount, 16, &uOffset))
+	{
+		return false;
+	}
+	bindVertices(uSlot, uStride, uOffset);
+	return true;
+}
+
+bool CCDynamicBuffers::setVSConstants(UINT uSlot, const void *pData, unsigned int uSize)
+{
+	if (! m_bConstantRanges)
+	{
+		return setFallbackConstants(uSlot, pData, uSize);
+	}
+
+	// the whole range is allocated so it never goes past the end of the buffer
+	unsigned int uRange = (uSize + kConstantRangeAlignment - 1) & ~(kConstantRangeAlignment - 1);
+	unsigned int uOffset = 0;
+	void *pDest = m_pConstantRing->map(uRange, kConstantRangeAlignment, &uOffset);
+	if (! pDest)
+	{
+		return false;
+	}
+	memcpy(pDest, pData, uSize);
+	m_pConstantRing->unmap();
+
+	CCRenderQueue::sharedRenderQueue()->setVSConstants(uSlot, m_pConstantDevice->getBuffer(), uOffset / 16, uRange / 16);
+	return true;
+}
+
+bool CCDynamicBuffers::setFallbackConstants(UINT uSlot, const void *pData, unsigned int uSize)
+{
+	if (uSize > m_uFallbackSize)
+	{
+		CC_SAFE_RELEASE_NULL_DX(m_pFallbackConstants);
+		m_uFallbackSize = 0;
+
+		D3D11_BUFFER_DESC bufferDesc;
+		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+		bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		bufferDesc.ByteWidth = (uSize + 15) & ~15;
+		bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		if (FAILED(CCID3D11Device->CreateBuffer(&bufferDesc, NULL, &m_pFallbackConstants)))
+		{
+			m_pFallbackConstants = NULL;
+			return false;
+		}
+		m_uFallbackSize = bufferDesc.ByteWidth;
+	}
+
+	ID3D11DeviceContext *pContext = CCID3D11DeviceContext;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	if (FAILED(pContext->Map(m_pFallbackConstants, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+	{
+		return false;
+	}
+	memcpy(mappedResource.pData, pData, uSize);
+	pContext->Unmap(m_pFallbackConstants, 0);
+
+	CCRenderQueue::sharedRenderQueue()->setVSConstants(uSlot, m_pFallbackConstants, 0, 0);
+	return true;
+}
+
+void CCDynamicBuffers::frameEnded(void)
+{
+	m_pGeometryRing->frameEnded();
+	if (m_pConstantRing)
+	{
+		m_pConstantRing->frameEnded();
+	}
+}
+
+void CCDynamicBuffers::commandListStarted(void)
+{
+	m_pGeometryRing->discard();
+	if (m_pConstantRing)
+	{
+		m_pConstantRing->discard();
+	}
+}
+
+}//namespace cocos2d
@@ -34,6 +34,10 @@ THE SOFTWARE.
 #include "CCPointExtension.h"
 #include "CCTransition.h"
 #include "CCTextureCache.h"
+#include "CCRenderTargetPool.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
+#include "CCDynamicAtlas.h"
 //#include "CCTransition.h"
 #include "CCSpriteFrameCache.h"
 #include "CCAutoreleasePool.h"
@@ -41,10 +45,12 @@ THE SOFTWARE.
 #include "CCApplication.h"
 #include "CCLabelBMFont.h"
 #include "CCActionManager.h"
+#include "CCTweenManager.h"
 #include "CCLabelTTF.h"
 #include "CCConfiguration.h"
 #include "CCKeypadDispatcher.h"
 #include "CCGL.h"
+#include "CCDrawingPrimitives.h"
 #include "CCAnimationCache.h"
 #include "CCTouch.h"
 
@@ -105,7 +111,17 @@ bool CCDirector::init(void)
 	m_bDisplayFPS = false;
 	m_uTotalFrames = m_uFrames = 0;
 	m_pszFPS = new char[10];
-	m_pLastUpdate = new struct cc_timeval();
+
+	// frame timing
+	m_pFixedTimestep = new CCFixedTimestep();
+	m_pFixedTimestep->initWithClock(NULL);
+	m_pFixedTimestep->setFrameDeadline(m_dAnimationInterval);
+	m_bFixedTimestep = false;
+
+	m_pRenderPipeline = new CCRenderPipeline();
+	m_pRenderPipeline->init();
+
+	m_fDeltaTime = 0;
 
 	// paused ?
 	m_bPaused = false;
@@ -145,8 +161,8 @@ CCDirector::~CCDirector(void)
 	// pop the autorelease pool
 	CCPoolManager::getInstance()->pop();
 
-	// delete m_pLastUpdate
-	CC_SAFE_DELETE(m_pLastUpdate);
+	CC_SAFE_RELEASE(m_pFixedTimestep);
+	CC_SAFE_RELEASE(m_pRenderPipeline);
 
     CCKeypadDispatcher::purgeSharedDispatcher();
 
@@ -184,7 +200,18 @@ void CCDirector::drawScene(void)
 	//tick before glClear: issue #533
 	if (! m_bPaused)
 	{
-		CCScheduler::sharedScheduler()->tick(m_fDeltaTime);
+		if (m_bFixedTimestep)
+		{
+			ccTime dt = m_pFixedTimestep->getStepDelta();
+			for (unsigned int uSteps = m_pFixedTimestep->accumulate(m_fDeltaTime); uSteps > 0; --uSteps)
+			{
+				CCScheduler::sharedScheduler()->tick(dt);
+			}
+		}
+		else
+		{
+			CCScheduler::sharedScheduler()->tick(m_fDeltaTime);
+		}
 	}
 	
 	m_pobOpenGLView->clearRender(NULL);
@@ -222,28 +249,43 @@ void CCDirector::drawScene(void)
 	showProfilers();
 #endif
 
+	// primitives drawn outside of a node
+	ccDrawFlush();
+
+	// the draws still queued are issued
+	CCRenderQueue::sharedRenderQueue()->frameEnded();
+
 	//=CC_DISABLE_DEFAULT_GL_STATES();
 	m_pobOpenGLView->D3DPopMatrix();
 
 	m_uTotalFrames++;
 
-	// swap buffers
+	// the per frame counters of the render target pool start over
+	CCRenderTargetPool::sharedRenderTargetPool()->frameEnded();
+
+	// the unused textures over the memory budget are evicted
+	CCTextureCache::sharedTextureCache()->frameEnded();
+
+	// the ranges the frame took from the dynamic buffers are fenced
+	CCDynamicBuffers::sharedDynamicBuffers()->frameEnded();
+
+	// swap buffers, or hand the recorded frame to the render thread
 	if (m_pobOpenGLView)
     {
-        m_pobOpenGLView->swapBuffers();
+		if (m_pRenderPipeline->isRunning())
+		{
+			m_pRenderPipeline->submitFrame(true);
+		}
+		else
+		{
+			m_pRenderPipeline->getBackend()->present();
+		}
     }
 }
 
 void CCDirector::calculateDeltaTime(void)
 {
-    struct cc_timeval now;
-
-	if (CCTime::gettimeofdayCocos2d(&now, NULL) != 0)
-	{
-		CCLOG("error in gettimeofday");
-        m_fDeltaTime = 0;
-		return;
-	}
+	double dt = m_pFixedTimestep->measureFrame();
 
 	// new delta time
 	if (m_bNextDeltaTimeZero)
@@ -253,8 +295,7 @@ void CCDirector::calculateDeltaTime(void)
 	}
 	else
 	{
-		m_fDeltaTime = (now.tv_sec - m_pLastUpdate->tv_sec) + (now.tv_usec - m_pLastUpdate->tv_usec) / 1000000.0f;
-		m_fDeltaTime = MAX(0, m_fDeltaTime);
+		m_fDeltaTime = (ccTime)dt;
 	}
 
 #ifdef DEBUG
@@ -264,8 +305,39 @@ void CCDirector::calculateDeltaTime(void)
 		m_fDeltaTime = 1 / 60.0f;
 	}
 #endif
+}
 
-	*m_pLastUpdate = now;
+void CCDirector::setFixedTimestepEnabled(bool bEnabled)
+{
+	if (bEnabled != m_bFixedTimestep)
+	{
+		m_bFixedTimestep = bEnabled;
+
+		// don't run the time accumulated before the switch
+		m_pFixedTimestep->reset();
+	}
+}
+
+float CCDirector::getInterpolationAlpha(void)
+{
+	return m_bFixedTimestep ? m_pFixedTimestep->getInterpolationAlpha() : 1.0f;
+}
+
+void CCDirector::setFrameClock(CCFrameClock *pClock)
+{
+	m_pFixedTimestep->setClock(pClock);
+}
+
+void CCDirector::setRenderPipelined(bool bPipelined)
+{
+	if (! bPipelined)
+	{
+		m_pRenderPipeline->stop();
+	}
+	else if (! m_pRenderPipeline->start())
+	{
+		CCLOG("cocos2d: the frames are still rendered on the main thread");
+	}
 }
 
 
@@ -356,6 +428,7 @@ void CCDirector::purgeCachedData(void)
 {
     CCLabelBMFont::purgeCachedData();
 	CCTextureCache::sharedTextureCache()->removeUnusedTextures();
+	CCRenderTargetPool::sharedRenderTargetPool()->removeUnusedTargets();
 }
 
 float CCDirector::getZEye(void)
@@ -367,16 +440,19 @@ void CCDirector::setAlphaBlending(bool bOn)
 {
 	if (bOn)
 	{
-		m_pobOpenGLView->D3DBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
 	}
 	else
 	{
-		m_pobOpenGLView->D3DBlendFunc(-1, -1);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(-1, -1);
 	}
 }
 
 void CCDirector::setDepthTest(bool bOn)
 {
+	// the draws queued so far keep the depth test they were submitted with
+	CCRenderQueue::sharedRenderQueue()->flush();
+
 	if (bOn)
 	{
 		//=ccglClearDepth(1.0f);
@@ -575,15 +651,23 @@ void CCDirector::resetDirector()
 
 	// purge all managers
 	CCAnimationCache::purgeSharedAnimationCache();
+	CCDynamicAtlas::purgeSharedDynamicAtlas();
  	CCSpriteFrameCache::purgeSharedSpriteFrameCache();
 	CCActionManager::sharedManager()->purgeSharedManager();
+	CCTweenManager::purgeSharedManager();
 	CCScheduler::purgeSharedScheduler();
 	CCTextureCache::purgeSharedTextureCache();
+	CCRenderTargetPool::purgeSharedRenderTargetPool();
+	CCRenderQueue::purgeSharedRenderQueue();
+	CCDynamicBuffers::purgeSharedDynamicBuffers();
 }
 
 
 void CCDirector::purgeDirector()
 {
+	// render the queued frames and go back to rendering on this thread
+	m_pRenderPipeline->stop();
+
 	// don't release the event handlers
 	// They are needed in case the director is run again
 	CCTouchDispatcher::sharedDispatcher()->removeAllDelegates();
@@ -616,10 +700,15 @@ void CCDirector::purgeDirector()
 
 	// purge all managers
 	CCAnimationCache::purgeSharedAnimationCache();
+	CCDynamicAtlas::purgeSharedDynamicAtlas();
  	CCSpriteFrameCache::purgeSharedSpriteFrameCache();
 	CCActionManager::sharedManager()->purgeSharedManager();
+	CCTweenManager::purgeSharedManager();
 	CCScheduler::purgeSharedScheduler();
 	CCTextureCache::purgeSharedTextureCache();
+	CCRenderTargetPool::purgeSharedRenderTargetPool();
+	CCRenderQueue::purgeSharedRenderQueue();
+	CCDynamicBuffers::purgeSharedDynamicBuffers();
 	
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_MARMALADE)	
 	CCUserDefault::purgeSharedUserDefault();
@@ -689,10 +778,7 @@ void CCDirector::resume(void)
 
 	setAnimationInterval(m_dOldAnimationInterval);
 
-	if (CCTime::gettimeofdayCocos2d(m_pLastUpdate, NULL) != 0)
-	{
-		CCLOG("cocos2d: Director: Error in gettimeofday");
-	}
+	m_pFixedTimestep->reset();
 
 	m_bPaused = false;
 	m_fDeltaTime = 0;
@@ -910,10 +996,7 @@ void CCDirector::setDeviceOrientation(ccDeviceOrientation kDeviceOrientation)
 // so we now only support DisplayLinkDirector
 void CCDisplayLinkDirector::startAnimation(void)
 {
-	if (CCTime::gettimeofdayCocos2d(m_pLastUpdate, NULL) != 0)
-	{
-		CCLOG("cocos2d: DisplayLinkDirector: Error on gettimeofday");
-	}
+	m_pFixedTimestep->reset();
 
 	m_bInvalid = false;
 	CCApplication::sharedApplication().setAnimationInterval(m_dAnimationInterval);
@@ -944,6 +1027,7 @@ void CCDisplayLinkDirector::stopAnimation(void)
 void CCDisplayLinkDirector::setAnimationInterval(double dValue)
 {
 	m_dAnimationInterval = dValue;
+	m_pFixedTimestep->setFrameDeadline(dValue);
 	if (! m_bInvalid)
 	{
 		stopAnimation();
@@ -34,6 +34,8 @@ THE SOFTWARE.
 #include <cmath>
 #include "DirectXHelper.h"
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace std;
 using namespace DirectX;
@@ -45,18 +47,33 @@ using namespace DirectX;
 namespace   cocos2d {
 	static CCDrawingPrimitive *pSharedDrawingPrimitive = NULL;
 
+// points of the calls, in pixels, reused from one call to the next
+static std::vector<ccVertex2F> s_scratch;
+
+static ccVertex2F* scratchVertices(unsigned int numberOfPoints)
+{
+	if (s_scratch.size() < numberOfPoints)
+	{
+		s_scratch.resize(numberOfPoints);
+	}
+	return &s_scratch[0];
+}
+
 void ccDrawPoint(const CCPoint& point)
 {
-	ccVertex2F* vertice = new ccVertex2F[1];
-	vertice[0].x = point.x * CC_CONTENT_SCALE_FACTOR();
-	vertice[0].y = point.y * CC_CONTENT_SCALE_FACTOR();
-	CCDrawingPrimitive::Drawing(vertice, 1, DrawingPoints);	
+	ccVertex2F vertice = {point.x * CC_CONTENT_SCALE_FACTOR(), point.y * CC_CONTENT_SCALE_FACTOR()};
+	CCDrawingPrimitive::Drawing(&vertice, 1, DrawingPoints);	
 }
 
 void ccDrawPoints(const CCPoint *points, unsigned int numberOfPoints)
 {
-	ccVertex2F* vertices = new ccVertex2F[numberOfPoints];
-	for (int i=0;i<numberOfPoints;i++)
+	if (numberOfPoints == 0)
+	{
+		return;
+	}
+
+	ccVertex2F* vertices = scratchVertices(numberOfPoints);
+	for (unsigned int i=0;i<numberOfPoints;i++)
 	{
 		vertices[i].x = points[i].x * CC_CONTENT_SCALE_FACTOR();
 		vertices[i].y = points[i].y * CC_CONTENT_SCALE_FACTOR();
@@ -82,34 +99,35 @@ void ccDrawPoly(const CCPoint *poli, int numberOfPoints, bool closePolygon){
 }
 void ccDrawPoly(const CCPoint *poli, int numberOfPoints, bool closePolygon, bool fill)
 {
-	
-	if (closePolygon)
+	if (numberOfPoints <= 0)
 	{
-		ccVertex2F* vertices = new ccVertex2F[numberOfPoints+1];
-		for (int i=0;i<numberOfPoints;i++)
-		{
-			vertices[i].x = poli[i].x * CC_CONTENT_SCALE_FACTOR();
-			vertices[i].y = poli[i].y * CC_CONTENT_SCALE_FACTOR();
-		}
-		vertices[numberOfPoints].x = poli[0].x * CC_CONTENT_SCALE_FACTOR();
-		vertices[numberOfPoints].y = poli[0].y * CC_CONTENT_SCALE_FACTOR();
-		CCDrawingPrimitive::Drawing(vertices, numberOfPoints+1,DrawingPolyClosed);
-	} 
+		return;
+	}
+
+	ccVertex2F* vertices = scratchVertices(numberOfPoints);
+	for (int i=0;i<numberOfPoints;i++)
+	{
+		vertices[i].x = poli[i].x * CC_CONTENT_SCALE_FACTOR();
+		vertices[i].y = poli[i].y * CC_CONTENT_SCALE_FACTOR();
+	}
+
+	if (fill)
+	{
+		CCDrawingPrimitive::Drawing(vertices, numberOfPoints, DrawingPolyFilled);
+	}
 	else
 	{
-		ccVertex2F* vertices = new ccVertex2F[numberOfPoints];
-		for (int i=0;i<numberOfPoints;i++)
-		{
-			vertices[i].x = poli[i].x * CC_CONTENT_SCALE_FACTOR();
-			vertices[i].y = poli[i].y * CC_CONTENT_SCALE_FACTOR();
-		}
-		CCDrawingPrimitive::Drawing(vertices, numberOfPoints,DrawingPolyOpened);
+		CCDrawingPrimitive::Drawing(vertices, numberOfPoints, closePolygon ? DrawingPolyClosed : DrawingPolyOpened);
 	}
-	
 }
 
 void ccDrawCircle(const CCPoint& center, float r, float a, int segs, bool drawLineToCenter)
 {
+	if (segs <= 0)
+	{
+		return;
+	}
+
 	int additionalSegment = 1;
 	if (drawLineToCenter)
 	{
@@ -118,11 +136,7 @@ void ccDrawCircle(const CCPoint& center, float r, float a, int segs, bool drawLi
 
 	const float coef = 2.0f * (float) (M_PI) /segs;
 
-	ccVertex2F* vertices = new ccVertex2F[segs+1];
-	if( ! vertices )
-	{
-		return;
-	}
+	ccVertex2F* vertices = scratchVertices(segs+2);
 	
 	for(int i=0;i<=segs;i++)
 	{
@@ -140,7 +154,12 @@ void ccDrawCircle(const CCPoint& center, float r, float a, int segs, bool drawLi
 
 void ccDrawQuadBezier(const CCPoint& origin, const CCPoint& control, const CCPoint& destination, int segments)
 {
-	ccVertex2F* vertices = new ccVertex2F[segments + 1];
+	if (segments <= 0)
+	{
+		return;
+	}
+
+	ccVertex2F* vertices = scratchVertices(segments + 1);
 	
 	float t = 0.0f;
 	for(int i = 0; i < segments; i++)
@@ -160,7 +179,12 @@ void ccDrawQuadBezier(const CCPoint& origin, const CCPoint& control, const CCPoi
 
 void ccDrawCubicBezier(const CCPoint& origin, const CCPoint& control1, const CCPoint& control2, const CCPoint& destination, int segments)
 {
-	ccVertex2F *vertices = new ccVertex2F[segments + 1];
+	if (segments <= 0)
+	{
+		return;
+	}
+
+	ccVertex2F *vertices = scratchVertices(segments + 1);
 	
 	float t = 0;
 	for(int i = 0; i < segments; ++i)
@@ -177,356 +201,238 @@ void ccDrawCubicBezier(const CCPoint& origin, const CCPoint& control1, const CCP
 	CCDrawingPrimitive::Drawing(vertices, segments+1,DrawingPolyOpened);
 }
 
-void CCDrawingPrimitive::D3DColor4f(float red, float green, float blue, float alpha)
+unsigned int ccDrawFlush(void)
 {
+	// nothing was ever drawn, nothing to create
 	if (! pSharedDrawingPrimitive)
 	{
-		pSharedDrawingPrimitive = new CCDrawingPrimitive();
+		return 0;
 	}
 
-	pSharedDrawingPrimitive->m_currentColor.x = red;
-	pSharedDrawingPrimitive->m_currentColor.y = green;
-	pSharedDrawingPrimitive->m_currentColor.z = blue;
-	pSharedDrawingPrimitive->m_currentColor.w = alpha;
-};
+	return pSharedDrawingPrimitive->flush();
+}
 
-void CCDrawingPrimitive::Drawing(ccVertex2F *vertices, unsigned int numberOfPoints, DXDrawingType type)
+CCDrawingPrimitive* CCDrawingPrimitive::sharedDrawingPrimitive(void)
 {
-	
 	if (! pSharedDrawingPrimitive)
 	{
 		pSharedDrawingPrimitive = new CCDrawingPrimitive();
 	}
-	pSharedDrawingPrimitive->m_DarwingType = type;
-	pSharedDrawingPrimitive->m_vertexAmount = numberOfPoints;
-	pSharedDrawingPrimitive->m_vertices = vertices;
-	pSharedDrawingPrimitive->Render();
 
+	return pSharedDrawingPrimitive;
+}
+
+void CCDrawingPrimitive::D3DColor4f(float red, float green, float blue, float alpha)
+{
+	CCDrawingPrimitive *pPrimitive = sharedDrawingPrimitive();
+	pPrimitive->m_currentColor.x = red;
+	pPrimitive->m_currentColor.y = green;
+	pPrimitive->m_currentColor.z = blue;
+	pPrimitive->m_currentColor.w = alpha;
+};
+
+void CCDrawingPrimitive::Drawing(ccVertex2F *vertices, unsigned int numberOfPoints, DXDrawingType type)
+{
+	sharedDrawingPrimitive()->append(vertices, NULL, numberOfPoints, type);
 }
 
 void CCDrawingPrimitive::Drawing3D(ccVertex3F *vertices, unsigned int numberOfPoints, DXDrawingType type)
 {
+	sharedDrawingPrimitive()->append(NULL, vertices, numberOfPoints, type);
+}
 
-	if (! pSharedDrawingPrimitive)
-	{
-		pSharedDrawingPrimitive = new CCDrawingPrimitive();
-	}
-	pSharedDrawingPrimitive->m_DarwingType = type;
-	pSharedDrawingPrimitive->m_vertexAmount = numberOfPoints;
-	pSharedDrawingPrimitive->m_vertices3D = vertices;
-	pSharedDrawingPrimitive->Render3D();
+unsigned int CCDrawingPrimitive::getLastFlushPrimitives(void)
+{
+	return pSharedDrawingPrimitive ? pSharedDrawingPrimitive->m_uLastFlushPrimitives : 0;
+}
 
+unsigned int CCDrawingPrimitive::getFlushCount(void)
+{
+	return pSharedDrawingPrimitive ? pSharedDrawingPrimitive->m_uFlushCount : 0;
 }
 
 CCDrawingPrimitive::CCDrawingPrimitive()
+: m_pProgram(NULL)
+, m_uLastFlushPrimitives(0)
+, m_uFlushCount(0)
 {
-
 	InitializeShader();
-	initVertexBuffer(200);
 
+	memset(&m_projection, 0, sizeof(m_projection));
 	m_currentColor = XMFLOAT4(1.0, 1.0, 1.0, 1.0);
 }
 
 CCDrawingPrimitive::~CCDrawingPrimitive()
 {
-	// Release the vertex buffer.
-	if(m_vertexBuffer)
-	{
-		m_vertexBuffer->Release();
-		m_vertexBuffer = 0;
-	}
-	/*
-	if ( m_indexBuffer )
-	{
-		m_indexBuffer->Release();
-		m_indexBuffer = 0;
-	}
-	*/
-	if(m_matrixBuffer)
-	{
-		m_matrixBuffer->Release();
-		m_matrixBuffer = 0;
-	}
-	//*
-	// Release the layout.
-	if(m_layout)
-	{
-		m_layout->Release();
-		m_layout = 0;
-	}
-
-	// Release the pixel shader.
-	if(m_pixelShader)
-	{
-		m_pixelShader->Release();
-		m_pixelShader = 0;
-	}
-
-	// Release the vertex shader.
-	if(m_vertexShader)
-	{
-		m_vertexShader->Release();
-		m_vertexShader = 0;
-	}
-	//*/
-	m_vertices =NULL;
+	CC_SAFE_RELEASE_NULL(m_pProgram);
 }
 
-void CCDrawingPrimitive::initVertexBuffer(unsigned int numberOfPoints)
+// index in the vertices of the call of the k-th vertex its primitives take
+static inline unsigned int sourceVertex(DXDrawingType type, unsigned int k, unsigned int numberOfPoints)
 {
-
-	VertexType* verticesT = new VertexType[numberOfPoints];
-	if ( !verticesT )
-	{
-		return;
-	}
-	memset(verticesT, 0, (sizeof(VertexType) * numberOfPoints));
-	/*
-	for (int i=0; i<numberOfPoints; i++)
-	{
-		verticesT[i].position = XMFLOAT3((vertices[i]).x, (vertices[i]).y, 1.0f);
-		verticesT[i].color = m_currentColor;
-	}
-	*/
-	D3D11_BUFFER_DESC vertexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData;
-	HRESULT result;
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType)*numberOfPoints;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = verticesT;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Now create the vertex buffer.
-	result = CCID3D11Device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
-	if(FAILED(result))
-	{
-		// clean up allocated resources
-		delete[] verticesT;
-		return ;
-	}
-
-	if ( verticesT )
-	{
-		delete[] verticesT;
-		verticesT = 0;
-	}
-	/*
-	DWORD indices[] = {
-		0, 1, 2,
-		0, 2, 3,
-	};
-
-	D3D11_BUFFER_DESC indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA indexData;
-	ZeroMemory( &indexBufferDesc, sizeof(indexBufferDesc) );
-
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(DWORD) * 2 * 3;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-
-	indexData.pSysMem = indices;
-	pDevice->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
-	*/
-	D3D11_BUFFER_DESC matrixBufferDesc;
-	ZeroMemory( &matrixBufferDesc, sizeof( D3D11_BUFFER_DESC ) );
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if(FAILED(result))
-	{
-		return ;
+	switch (type)
+	{
+	case DrawingPolyOpened:
+		return k / 2 + (k & 1);
+	case DrawingPolyClosed:
+		return (k / 2 + (k & 1)) % numberOfPoints;
+	case DrawingPolyFilled:
+		// triangle fan around the first vertex
+		return k % 3 == 0 ? 0 : k / 3 + k % 3;
+	default:
+		return k;
 	}
 }
 
-void CCDrawingPrimitive::RenderVertexBuffer()
+void CCDrawingPrimitive::append(const ccVertex2F *vertices, const ccVertex3F *vertices3D, unsigned int numberOfPoints, DXDrawingType type)
 {
-	
-	VertexType* verticesTmp;
-	// Create the vertex array.
-	verticesTmp = new VertexType[m_vertexAmount];
-	if(!verticesTmp)
+	unsigned int kind = kKindLines;
+	unsigned int count = 0;
+	switch (type)
+	{
+	case DrawingPoints:
+		kind = kKindPoints;
+		count = numberOfPoints;
+		break;
+	case DrawingLines:
+		count = numberOfPoints & ~1;
+		break;
+	case DrawingTrangles:
+		kind = kKindTriangles;
+		count = numberOfPoints - numberOfPoints % 3;
+		break;
+	case DrawingPolyClosed:
+		count = numberOfPoints >= 2 ? numberOfPoints * 2 : 0;
+		break;
+	case DrawingPolyOpened:
+		count = numberOfPoints >= 2 ? (numberOfPoints - 1) * 2 : 0;
+		break;
+	case DrawingPolyFilled:
+		kind = kKindTriangles;
+		count = numberOfPoints >= 3 ? (numberOfPoints - 2) * 3 : 0;
+		break;
+	}
+
+	if (count == 0)
 	{
-		return ;
+		return;
 	}
 
-	memset(verticesTmp, 0, (sizeof(VertexType) * m_vertexAmount));
-
-	for (int i=0; i<m_vertexAmount; i++)
+	// what was batched under another projection is drawn with it first
+	XMMATRIX viewMatrix, projectionMatrix;
+	XMFLOAT4X4 projection;
+	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
+	XMStoreFloat4x4(&projection, projectionMatrix);
+	if (memcmp(&projection, &m_projection, sizeof(projection)) != 0)
 	{
-		verticesTmp[i].position = XMFLOAT3((m_vertices[i]).x, (m_vertices[i]).y, 1.0f);
-		verticesTmp[i].color = m_currentColor;
+		flush();
+		m_projection = projection;
 	}
 
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-	HRESULT result;
-	if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
-	{
-		// clean up allocated resources
-		delete[] verticesTmp;
-		return;
-	}
-	verticesPtr = (VertexType*)mappedResource.pData;
-	memcpy(verticesPtr, (void*)verticesTmp, (sizeof(VertexType) * m_vertexAmount));
-	CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
+	CCD3DCLASS->GetViewMatrix(viewMatrix);
 
-	if ( verticesTmp )
+	// a call of another kind than the previous one starts a new run, so that it is drawn over it
+	if (m_runs.empty() || m_runs.back().uKind != kind)
 	{
-		delete[] verticesTmp;
-		verticesTmp = 0;
+		ccPrimitiveRun run = {kind, 0};
+		m_runs.push_back(run);
 	}
-	
-	////////////////////////
-	unsigned int stride;
-	unsigned int offset;
-	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType); 
-	offset = 0;
-
-	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	m_runs.back().uCount += count;
 
-	//CCID3D11DeviceContext->IASetIndexBuffer( m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	size_t first = m_vertices.size();
+	m_vertices.resize(first + count);
+	VertexType *pOut = &m_vertices[first];
 
-	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-	if (m_DarwingType==DrawingPoints)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
-	} 
-	else if(m_DarwingType==DrawingLines)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-	}
-	else if(m_DarwingType==DrawingTrangles)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	}
-	else if(m_DarwingType==DrawingPolyClosed)
+	for (unsigned int k = 0; k < count; ++k, ++pOut)
 	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP);
+		unsigned int i = sourceVertex(type, k, numberOfPoints);
+		XMVECTOR position = vertices
+			? XMVectorSet(vertices[i].x, vertices[i].y, 1.0f, 1.0f)
+			: XMVectorSet(vertices3D[i].x, vertices3D[i].y, vertices3D[i].z, 1.0f);
+		XMStoreFloat3(&pOut->position, XMVector3Transform(position, viewMatrix));
+		pOut->color = m_currentColor;
 	}
-	else if(m_DarwingType==DrawingPolyOpened)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP);
-	}
-	
-	return;
 }
 
-void CCDrawingPrimitive::RenderVertexBuffer3D()
+unsigned int CCDrawingPrimitive::flush(void)
 {
-
-	VertexType* verticesTmp;
-	// Create the vertex array.
-	verticesTmp = new VertexType[m_vertexAmount];
-	if(!verticesTmp)
+	unsigned int vertexCount = m_vertices.size();
+	if (vertexCount == 0)
 	{
-		return ;
+		return 0;
 	}
 
-	memset(verticesTmp, 0, (sizeof(VertexType) * m_vertexAmount));
-
-	for (int i=0; i<m_vertexAmount; i++)
+	CCDynamicBuffers *pBuffers = CCDynamicBuffers::sharedDynamicBuffers();
+	unsigned int offset = 0;
+	VertexType *verticesPtr = (VertexType*)pBuffers->mapVertices(sizeof(VertexType), vertexCount, &offset);
+	if (! verticesPtr)
 	{
-		verticesTmp[i].position = XMFLOAT3((m_vertices3D[i]).x, (m_vertices3D[i]).y, (m_vertices3D[i]).z);
-		verticesTmp[i].color = m_currentColor;
+		m_vertices.clear();
+		m_runs.clear();
+		return 0;
 	}
 
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-	if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
-	{
-		// clean up allocated resources
-		delete[] verticesTmp;
-		return;
-	}
-	verticesPtr = (VertexType*)mappedResource.pData;
-	memcpy(verticesPtr, (void*)verticesTmp, (sizeof(VertexType) * m_vertexAmount));
-	CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
+	memcpy(verticesPtr, &m_vertices[0], sizeof(VertexType) * vertexCount);
+	pBuffers->unmapVertices();
 
-	if ( verticesTmp )
-	{
-		delete[] verticesTmp;
-		verticesTmp = 0;
-	}
+	// the vertices are already in view space
+	XMMATRIX viewMatrix = XMMatrixIdentity();
+	XMMATRIX projectionMatrix = XMLoadFloat4x4(&m_projection);
+	SetShaderParameters(viewMatrix, projectionMatrix);
 
-	////////////////////////
-	unsigned int stride;
-	unsigned int offset;
-	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType); 
-	offset = 0;
+	// the draws below start from the offset of the range
+	pBuffers->bindVertices(0, sizeof(VertexType), offset);
+	CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
+	pQueue->setProgram(m_pProgram);
 
-	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
-
-	//CCID3D11DeviceContext->IASetIndexBuffer( m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	static const D3D11_PRIMITIVE_TOPOLOGY topologies[kKindCount] = {
+		D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST,
+		D3D11_PRIMITIVE_TOPOLOGY_LINELIST,
+		D3D11_PRIMITIVE_TOPOLOGY_POINTLIST,
+	};
+	static const unsigned int verticesPerPrimitive[kKindCount] = {3, 2, 1};
 
-	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-	if (m_DarwingType==DrawingPoints)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
-	} 
-	else if(m_DarwingType==DrawingLines)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-	}
-	else if(m_DarwingType==DrawingTrangles)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	}
-	else if(m_DarwingType==DrawingPolyClosed)
+	// in the order of the calls, a run only differs from the previous one by its topology
+	unsigned int primitives = 0;
+	unsigned int start = 0;
+	for (unsigned int i = 0; i < m_runs.size(); ++i)
 	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP);
-	}
-	else if(m_DarwingType==DrawingPolyOpened)
-	{
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP);
+		const ccPrimitiveRun& run = m_runs[i];
+		if (start > 0)
+		{
+			pQueue->repeatStates();
+		}
+		pQueue->setTopology(topologies[run.uKind]);
+		pQueue->draw(run.uCount, start);
+		primitives += run.uCount / verticesPerPrimitive[run.uKind];
+		start += run.uCount;
 	}
+	m_vertices.clear();
+	m_runs.clear();
 
-	return;
+	m_uLastFlushPrimitives = primitives;
+	++m_uFlushCount;
+
+	return primitives;
 }
 
 bool CCDrawingPrimitive::InitializeShader()
 {
-	BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 	D3D11_INPUT_ELEMENT_DESC layoutDesc[] =
 	{
 		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 	};
 
-	loader->LoadShader(
+	m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 		L"CCDrawingVertexShader.cso",
 		layoutDesc,
 		ARRAYSIZE(layoutDesc),
-		&m_vertexShader,
-		&m_layout
+		L"CCDrawingPixelShader.cso"
 		);
+	CC_SAFE_RETAIN(m_pProgram);
 
-	loader->LoadShader(
-		L"CCDrawingPixelShader.cso",
-		&m_pixelShader
-		);
-
-	return true;
+	return m_pProgram != NULL;
 }
 
 void CCDrawingPrimitive::OutputShaderErrorMessage(ID3D10Blob* errorMessage,WCHAR* shaderFilename)
@@ -565,85 +471,14 @@ void CCDrawingPrimitive::OutputShaderErrorMessage(ID3D10Blob* errorMessage,WCHAR
 
 bool CCDrawingPrimitive::SetShaderParameters(XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix)
 {
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	MatrixBufferType matrices;
 	unsigned int bufferNumber;
 
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-	MatrixBufferType* dataPtr;
-	if(FAILED(CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource))){return false;}
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-	CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+	matrices.view = XMMatrixTranspose(viewMatrix);
+	matrices.projection = XMMatrixTranspose(projectionMatrix);
 	bufferNumber = 0;
-	CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
-
-	return true;
-}
-
-void CCDrawingPrimitive::RenderShader()
-{
-	// Set the vertex input layout.
-	CCID3D11DeviceContext->IASetInputLayout(m_layout);
-
-	// Set the vertex and pixel shaders that will be used to render this triangle.
-	CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
-
-	// Render the triangle.
-	//CCID3D11DeviceContext->DrawIndexed( 6, 0, 0 );
-	CCID3D11DeviceContext->Draw( m_vertexAmount, 0 );
-
-	return;
-}
-
-
-void CCDrawingPrimitive::Render()
-{
-	XMMATRIX viewMatrix, projectionMatrix;
-	bool result;
-
-	// Get the world, view, and projection matrices from the camera and d3d objects.
-	CCD3DCLASS->GetViewMatrix(viewMatrix);
-	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
-
-	// Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing.
-	RenderVertexBuffer();
-
-	// Set the shader parameters that it will use for rendering.
-	result = SetShaderParameters(viewMatrix, projectionMatrix);
-	if(!result)
-	{
-		return ;
-	}
-
-	// Now render the prepared buffers with the shader.
-	RenderShader();
-}
-
-void CCDrawingPrimitive::Render3D()
-{
-	XMMATRIX viewMatrix, projectionMatrix;
-	bool result;
-
-	// Get the world, view, and projection matrices from the camera and d3d objects.
-	CCD3DCLASS->GetViewMatrix(viewMatrix);
-	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
-
-	// Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing.
-	RenderVertexBuffer3D();
-
-	// Set the shader parameters that it will use for rendering.
-	result = SetShaderParameters(viewMatrix, projectionMatrix);
-	if(!result)
-	{
-		return ;
-	}
 
-	// Now render the prepared buffers with the shader.
-	RenderShader();
+	return CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices));
 }
 
 }//namespace   cocos2d 
@@ -0,0 +1,218 @@
+/****************************************************************************
+Copyright (c) 2010-2011 cocos2d-x.org
+Copyright (c) 2008-2010 Ricardo Quesada
+Copyright (c) 2011      Zynga Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCFixedTimestep.h"
+#include "ccMacros.h"
+#include "CCStdC.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+#include <mach/mach_time.h>
+#endif
+
+#include <string.h>
+
+namespace cocos2d {
+
+#define kDefaultTickRate		60.0
+#define kDefaultMaxSubsteps		5
+// fraction of a step the frames can be short of and still run it
+#define kStepSnap				0.02
+
+//////////////////////////////////////////////////////////////////////////
+// CCFrameClock
+//////////////////////////////////////////////////////////////////////////
+
+double CCFrameClock::now(void)
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_WIN8_METRO)
+	static double s_dPeriod = 0;
+	if (s_dPeriod == 0)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		s_dPeriod = 1.0 / (double)frequency.QuadPart;
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * s_dPeriod;
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+	static double s_dPeriod = 0;
+	if (s_dPeriod == 0)
+	{
+		mach_timebase_info_data_t info;
+		mach_timebase_info(&info);
+		s_dPeriod = 1e-9 * (double)info.numer / (double)info.denom;
+	}
+
+	return (double)mach_absolute_time() * s_dPeriod;
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#else
+	// no monotonic clock on this platform
+	struct cc_timeval now;
+	CCTime::gettimeofdayCocos2d(&now, NULL);
+	return (double)now.tv_sec + (double)now.tv_usec * 1e-6;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CCFixedTimestep
+//////////////////////////////////////////////////////////////////////////
+
+CCFixedTimestep::CCFixedTimestep(void)
+: m_pClock(NULL)
+, m_dLastTime(0)
+, m_dAccumulator(0)
+, m_dTickRate(kDefaultTickRate)
+, m_uMaxSubsteps(kDefaultMaxSubsteps)
+, m_dFrameDeadline(1.0 / kDefaultTickRate)
+{
+	resetStats();
+}
+
+CCFixedTimestep::~CCFixedTimestep(void)
+{
+	CC_SAFE_RELEASE(m_pClock);
+}
+
+bool CCFixedTimestep::initWithClock(CCFrameClock *pClock)
+{
+	setClock(pClock);
+	return true;
+}
+
+void CCFixedTimestep::setClock(CCFrameClock *pClock)
+{
+	if (pClock)
+	{
+		pClock->retain();
+	}
+	else
+	{
+		pClock = new CCFrameClock();
+	}
+
+	CC_SAFE_RELEASE(m_pClock);
+	m_pClock = pClock;
+
+	reset();
+}
+
+void CCFixedTimestep::setTickRate(double dTicksPerSecond)
+{
+	CCAssert(dTicksPerSecond > 0, "the tick rate must be positive");
+
+	// keep the same fraction of a step pending
+	m_dAccumulator *= m_dTickRate / dTicksPerSecond;
+	m_dTickRate = dTicksPerSecond;
+}
+
+void CCFixedTimestep::setMaxSubsteps(unsigned int uMaxSubsteps)
+{
+	m_uMaxSubsteps = uMaxSubsteps > 0 ? uMaxSubsteps : 1;
+}
+
+void CCFixedTimestep::reset(void)
+{
+	m_dLastTime = m_pClock->now();
+	m_dAccumulator = 0;
+}
+
+double CCFixedTimestep::measureFrame(void)
+{
+	double dNow = m_pClock->now();
+	double dt = MAX(0.0, dNow - m_dLastTime);
+	m_dLastTime = dNow;
+
+	m_tStats.uFrames++;
+	m_tStats.dLastFrameTime = dt;
+	m_tStats.dMaxFrameTime = MAX(m_tStats.dMaxFrameTime, dt);
+	m_tStats.dTotalFrameTime += dt;
+
+	unsigned int uBucket = (unsigned int)MIN(dt * 1000.0, (double)(kCCFrameTimeHistogramBuckets - 1));
+	m_tStats.uFrameTimeHistogram[uBucket]++;
+
+	if (dt > 1.5 * m_dFrameDeadline)
+	{
+		m_tStats.uMissedDeadlines++;
+	}
+
+	return dt;
+}
+
+unsigned int CCFixedTimestep::accumulate(double dt)
+{
+	m_dAccumulator += MAX(0.0, dt);
+
+	// A frame a hair shorter than a step still runs it, otherwise vsync jitter
+	// makes frames alternate between 0 and 2 steps when both rates match.
+	// The accumulator can go that much below 0, the next frame pays it back.
+	double dStep = 1.0 / m_dTickRate;
+	unsigned int uSteps = (unsigned int)(m_dAccumulator * m_dTickRate + kStepSnap);
+
+	// the steps that can't be run now are dropped, only the fraction of a step is kept
+	m_dAccumulator -= uSteps * dStep;
+	if (uSteps > m_uMaxSubsteps)
+	{
+		m_tStats.uDroppedSteps += uSteps - m_uMaxSubsteps;
+		uSteps = m_uMaxSubsteps;
+	}
+
+	m_tStats.uSteps += uSteps;
+	return uSteps;
+}
+
+void CCFixedTimestep::resetStats(void)
+{
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+double CCFixedTimestep::getFrameTimePercentile(float fPercent)
+{
+	if (m_tStats.uFrames == 0)
+	{
+		return 0;
+	}
+
+	unsigned int uTarget = (unsigned int)ceil(m_tStats.uFrames * MIN(MAX(0.0f, fPercent), 100.0f) / 100.0f);
+	unsigned int uCount = 0;
+
+	for (unsigned int i = 0; i < kCCFrameTimeHistogramBuckets - 1; ++i)
+	{
+		uCount += m_tStats.uFrameTimeHistogram[i];
+		if (uCount >= uTarget && uCount > 0)
+		{
+			return (i + 1) / 1000.0;
+		}
+	}
+
+	return m_tStats.dMaxFrameTime;
+}
+
+}//namespace cocos2d
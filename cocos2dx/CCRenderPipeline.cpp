@@ -0,0 +1,373 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCRenderPipeline.h"
+#include "CCDirector.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
+#include "ccMacros.h"
+
+#include <string.h>
+
+namespace cocos2d {
+
+// pipeline state carried from one command list to the next, a deferred context
+// starts every command list from the default state
+typedef struct _ccPipelineState
+{
+	ID3D11RenderTargetView *pRenderTarget;
+	ID3D11DepthStencilView *pDepthStencil;
+	ID3D11BlendState *pBlendState;
+	float fBlendFactor[4];
+	UINT uSampleMask;
+	ID3D11DepthStencilState *pDepthStencilState;
+	UINT uStencilRef;
+	ID3D11RasterizerState *pRasterizerState;
+	UINT uViewports;
+	D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+	UINT uScissorRects;
+	D3D11_RECT scissorRects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+} ccPipelineState;
+
+static void capturePipelineState(ID3D11DeviceContext *pContext, ccPipelineState& state)
+{
+	pContext->OMGetRenderTargets(1, &state.pRenderTarget, &state.pDepthStencil);
+	pContext->OMGetBlendState(&state.pBlendState, state.fBlendFactor, &state.uSampleMask);
+	pContext->OMGetDepthStencilState(&state.pDepthStencilState, &state.uStencilRef);
+	pContext->RSGetState(&state.pRasterizerState);
+	state.uViewports = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+	pContext->RSGetViewports(&state.uViewports, state.viewports);
+	state.uScissorRects = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+	pContext->RSGetScissorRects(&state.uScissorRects, state.scissorRects);
+}
+
+// sets the captured state on pContext and drops the references taken by capturePipelineState()
+static void applyPipelineState(ID3D11DeviceContext *pContext, ccPipelineState& state)
+{
+	pContext->OMSetRenderTargets(1, &state.pRenderTarget, state.pDepthStencil);
+	pContext->OMSetBlendState(state.pBlendState, state.fBlendFactor, state.uSampleMask);
+	pContext->OMSetDepthStencilState(state.pDepthStencilState, state.uStencilRef);
+	pContext->RSSetState(state.pRasterizerState);
+	pContext->RSSetViewports(state.uViewports, state.viewports);
+	pContext->RSSetScissorRects(state.uScissorRects, state.scissorRects);
+
+	if (state.pRenderTarget)
+	{
+		state.pRenderTarget->Release();
+	}
+	if (state.pDepthStencil)
+	{
+		state.pDepthStencil->Release();
+	}
+	if (state.pBlendState)
+	{
+		state.pBlendState->Release();
+	}
+	if (state.pDepthStencilState)
+	{
+		state.pDepthStencilState->Release();
+	}
+	if (state.pRasterizerState)
+	{
+		state.pRasterizerState->Release();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CCRenderBackend
+//////////////////////////////////////////////////////////////////////////
+
+void CCRenderBackend::execute(ID3D11DeviceContext *pContext, ID3D11CommandList *pCommands)
+{
+	pContext->ExecuteCommandList(pCommands, FALSE);
+}
+
+void CCRenderBackend::present(void)
+{
+	CCDirector::sharedDirector()->getOpenGLView()->swapBuffers();
+}
+
+void CCHeadlessRenderBackend::present(void)
+{
+	CCDirector::sharedDirector()->getOpenGLView()->GetImmediateContext()->Flush();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// CCRenderPipeline
+//////////////////////////////////////////////////////////////////////////
+
+CCRenderPipeline::CCRenderPipeline(void)
+: m_pDeferredContext(NULL)
+, m_pThread(NULL)
+, m_pPendingCommands(NULL)
+, m_bPendingPresent(false)
+, m_bExecuting(false)
+, m_bQuit(false)
+, m_pBackend(NULL)
+, m_pClock(NULL)
+{
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+CCRenderPipeline::~CCRenderPipeline(void)
+{
+	stop();
+
+	CC_SAFE_RELEASE(m_pBackend);
+	CC_SAFE_RELEASE(m_pClock);
+}
+
+bool CCRenderPipeline::init(void)
+{
+	m_pBackend = new CCRenderBackend();
+	m_pClock = new CCFrameClock();
+
+	return true;
+}
+
+bool CCRenderPipeline::start(void)
+{
+	if (isRunning())
+	{
+		return true;
+	}
+
+	CCEGLView *pView = CCDirector::sharedDirector()->getOpenGLView();
+	CCAssert(pView, "the render pipeline needs the view");
+
+	ID3D11DeviceContext *pContext = NULL;
+	HRESULT hr = pView->GetDevice()->CreateDeferredContext(0, &pContext);
+	if (SUCCEEDED(hr))
+	{
+		hr = pContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&m_pDeferredContext);
+		pContext->Release();
+	}
+	if (FAILED(hr))
+	{
+		CCLOG("cocos2d: can't create a deferred context (0x%08x), the render pipeline stays off", hr);
+		m_pDeferredContext = NULL;
+		return false;
+	}
+
+	// the first command list starts from the state the main thread rendered with
+	CCRenderQueue::sharedRenderQueue()->flush();
+	ccPipelineState state;
+	capturePipelineState(pView->GetImmediateContext(), state);
+	applyPipelineState(m_pDeferredContext, state);
+
+	pView->setRecordingContext(m_pDeferredContext);
+	CCDynamicBuffers::sharedDynamicBuffers()->commandListStarted();
+	CCRenderQueue::sharedRenderQueue()->invalidateState();
+
+	m_bQuit = false;
+	m_pThread = new std::thread(&CCRenderPipeline::renderThreadMain, this);
+
+	return true;
+}
+
+void CCRenderPipeline::stop(void)
+{
+	if (! isRunning())
+	{
+		return;
+	}
+
+	CCRenderQueue::sharedRenderQueue()->flush();
+	finish();
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_bQuit = true;
+		m_queueCondition.notify_all();
+	}
+	m_pThread->join();
+	delete m_pThread;
+	m_pThread = NULL;
+
+	// executing a command list clears the state of the immediate context
+	CCEGLView *pView = CCDirector::sharedDirector()->getOpenGLView();
+	ccPipelineState state;
+	capturePipelineState(m_pDeferredContext, state);
+	applyPipelineState(pView->GetImmediateContext(), state);
+
+	pView->setRecordingContext(NULL);
+	CCDynamicBuffers::sharedDynamicBuffers()->commandListStarted();
+	CCRenderQueue::sharedRenderQueue()->invalidateState();
+
+	m_pDeferredContext->Release();
+	m_pDeferredContext = NULL;
+}
+
+void CCRenderPipeline::submitFrame(bool bPresent)
+{
+	CCAssert(isRunning(), "the render pipeline doesn't run");
+
+	double dStart = m_pClock->now();
+
+	CCRenderQueue::sharedRenderQueue()->flush();
+	ccPipelineState state;
+	capturePipelineState(m_pDeferredContext, state);
+
+	ID3D11CommandList *pCommands = NULL;
+	HRESULT hr = m_pDeferredContext->FinishCommandList(FALSE, &pCommands);
+
+	// the next command list starts where this one ended
+	applyPipelineState(m_pDeferredContext, state);
+	CCDynamicBuffers::sharedDynamicBuffers()->commandListStarted();
+	CCRenderQueue::sharedRenderQueue()->invalidateState();
+
+	if (FAILED(hr))
+	{
+		CCLOG("cocos2d: FinishCommandList failed (0x%08x), the frame is lost", hr);
+		return;
+	}
+
+	double dRecorded = m_pClock->now();
+
+	std::unique_lock<std::mutex> lock(m_queueMutex);
+	while (m_pPendingCommands)
+	{
+		m_queueCondition.wait(lock);
+	}
+	m_pPendingCommands = pCommands;
+	m_bPendingPresent = bPresent;
+	m_queueCondition.notify_all();
+
+	if (bPresent)
+	{
+		double dWait = m_pClock->now() - dRecorded;
+
+		++m_tStats.uFramesSubmitted;
+		m_tStats.dLastRecordTime = dRecorded - dStart;
+		m_tStats.dLastSubmitWait = dWait;
+		m_tStats.dTotalSubmitWait += dWait;
+	}
+}
+
+void CCRenderPipeline::finish(void)
+{
+	if (! isRunning())
+	{
+		return;
+	}
+
+	submitFrame(false);
+	waitIdle();
+}
+
+void CCRenderPipeline::detachTargets(void)
+{
+	if (! isRunning())
+	{
+		return;
+	}
+
+	finish();
+	m_pDeferredContext->OMSetRenderTargets(0, NULL, NULL);
+}
+
+void CCRenderPipeline::setBackend(CCRenderBackend *pBackend)
+{
+	if (! pBackend)
+	{
+		pBackend = new CCRenderBackend();
+	}
+	else
+	{
+		pBackend->retain();
+	}
+
+	// the render thread may still use the old one
+	waitIdle();
+
+	CC_SAFE_RELEASE(m_pBackend);
+	m_pBackend = pBackend;
+}
+
+void CCRenderPipeline::resetStats(void)
+{
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+void CCRenderPipeline::waitIdle(void)
+{
+	std::unique_lock<std::mutex> lock(m_queueMutex);
+	while (m_pPendingCommands || m_bExecuting)
+	{
+		m_queueCondition.wait(lock);
+	}
+}
+
+void CCRenderPipeline::renderThreadMain(void)
+{
+	CCEGLView *pView = CCDirector::sharedDirector()->getOpenGLView();
+
+	std::unique_lock<std::mutex> lock(m_queueMutex);
+	for (;;)
+	{
+		while (! m_pPendingCommands && ! m_bQuit)
+		{
+			m_queueCondition.wait(lock);
+		}
+		if (! m_pPendingCommands)
+		{
+			break;
+		}
+
+		ID3D11CommandList *pCommands = m_pPendingCommands;
+		bool bPresent = m_bPendingPresent;
+		CCRenderBackend *pBackend = m_pBackend;
+		m_pPendingCommands = NULL;
+		m_bExecuting = true;
+		// the main thread can queue the next frame now
+		m_queueCondition.notify_all();
+		lock.unlock();
+
+		double dStart = m_pClock->now();
+
+		pView->lockImmediateContext();
+		pBackend->execute(pView->GetImmediateContext(), pCommands);
+		if (bPresent)
+		{
+			pBackend->present();
+		}
+		pView->unlockImmediateContext();
+		pCommands->Release();
+
+		double dReplay = m_pClock->now() - dStart;
+
+		lock.lock();
+		m_bExecuting = false;
+		if (bPresent)
+		{
+			++m_tStats.uFramesExecuted;
+			m_tStats.dLastReplayTime = dReplay;
+			m_tStats.dTotalReplayTime += dReplay;
+		}
+		m_queueCondition.notify_all();
+	}
+}
+
+}//namespace cocos2d
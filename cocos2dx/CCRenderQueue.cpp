@@ -0,0 +1,533 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCRenderQueue.h"
+#include "CCDirector.h"
+#include "CCBufferRing.h"
+#include "ccMacros.h"
+#include "BasicLoader.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace cocos2d {
+
+static CCRenderQueue *g_sharedRenderQueue = NULL;
+
+// implementation of CCRenderProgram
+
+CCRenderProgram::CCRenderProgram(void)
+: m_pVertexShader(NULL)
+, m_pPixelShader(NULL)
+, m_pInputLayout(NULL)
+, m_uId(0)
+{
+}
+
+CCRenderProgram::~CCRenderProgram(void)
+{
+	CC_SAFE_RELEASE_NULL_DX(m_pInputLayout);
+	CC_SAFE_RELEASE_NULL_DX(m_pPixelShader);
+	CC_SAFE_RELEASE_NULL_DX(m_pVertexShader);
+}
+
+bool CCRenderProgram::initWithShaders(const wchar_t *pszVertexShader, const D3D11_INPUT_ELEMENT_DESC *pLayout, UINT uElements,
+	const wchar_t *pszPixelShader, unsigned int uId)
+{
+	BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
+
+	loader->LoadShader(
+		ref new Platform::String(pszVertexShader),
+		const_cast<D3D11_INPUT_ELEMENT_DESC*>(pLayout),
+		uElements,
+		&m_pVertexShader,
+		&m_pInputLayout
+		);
+
+	loader->LoadShader(
+		ref new Platform::String(pszPixelShader),
+		&m_pPixelShader
+		);
+
+	m_uId = uId;
+	return m_pVertexShader && m_pPixelShader && m_pInputLayout;
+}
+
+// implementation of CCRenderQueue
+
+CCRenderQueue::CCRenderQueue(void)
+: m_bBlendBound(false)
+, m_nUnorderedDepth(0)
+, m_uSequence(0)
+, m_uNextProgramId(0)
+{
+	memset(&m_tPending, 0, sizeof(m_tPending));
+	m_tPending.tBlendFunc.src = CC_BLEND_SRC;
+	m_tPending.tBlendFunc.dst = CC_BLEND_DST;
+	memset(&m_tLastSubmitted, 0, sizeof(m_tLastSubmitted));
+	memset(&m_tBound, 0, sizeof(m_tBound));
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+CCRenderQueue::~CCRenderQueue(void)
+{
+	CCLOGINFO("cocos2d: deallocing CCRenderQueue.");
+	for (unsigned int i = 0; i < m_packets.size(); ++i)
+	{
+		releasePacket(m_packets[i]);
+	}
+	for (ProgramMap::iterator it = m_programs.begin(); it != m_programs.end(); ++it)
+	{
+		it->second->release();
+	}
+	for (unsigned int i = 0; i < m_sharedConstants.size(); ++i)
+	{
+		m_sharedConstants[i].pBuffer->Release();
+	}
+}
+
+CCRenderQueue* CCRenderQueue::sharedRenderQueue(void)
+{
+	if (! g_sharedRenderQueue)
+	{
+		g_sharedRenderQueue = new CCRenderQueue();
+		g_sharedRenderQueue->init();
+	}
+	return g_sharedRenderQueue;
+}
+
+void CCRenderQueue::purgeSharedRenderQueue(void)
+{
+	CC_SAFE_RELEASE_NULL(g_sharedRenderQueue);
+}
+
+bool CCRenderQueue::init(void)
+{
+	m_packets.reserve(256);
+	return true;
+}
+
+CCRenderProgram* CCRenderQueue::programWithShaders(const wchar_t *pszVertexShader, const D3D11_INPUT_ELEMENT_DESC *pLayout, UINT uElements,
+	const wchar_t *pszPixelShader)
+{
+	// the same vertex shader may be fed by different layouts
+	std::wstring key = pszVertexShader;
+	key += L'|';
+	key += pszPixelShader;
+	for (UINT i = 0; i < uElements; ++i)
+	{
+		wchar_t szElement[64];
+		swprintf_s(szElement, L"|%S%u:%u:%u:%u", pLayout[i].SemanticName, pLayout[i].SemanticIndex,
+			(unsigned int)pLayout[i].Format, pLayout[i].InputSlot, pLayout[i].AlignedByteOffset);
+		key += szElement;
+	}
+
+	ProgramMap::iterator it = m_programs.find(key);
+	if (it != m_programs.end())
+	{
+		return it->second;
+	}
+
+	CCRenderProgram *pProgram = new CCRenderProgram();
+	if (! pProgram->initWithShaders(pszVertexShader, pLayout, uElements, pszPixelShader, ++m_uNextProgramId))
+	{
+		CCLOG("cocos2d: CCRenderQueue: can't load the shaders %ls and %ls", pszVertexShader, pszPixelShader);
+		pProgram->release();
+		return NULL;
+	}
+	m_programs[key] = pProgram;
+	return pProgram;
+}
+
+ID3D11Buffer* CCRenderQueue::constantBufferWithData(const void *pData, UINT uSize)
+{
+	std::string data((const char*)pData, uSize);
+	for (unsigned int i = 0; i < m_sharedConstants.size(); ++i)
+	{
+		if (m_sharedConstants[i].data == data)
+		{
+			return m_sharedConstants[i].pBuffer;
+		}
+	}
+
+	// a constant buffer is a multiple of 16 bytes
+	std::string contents = data;
+	contents.resize((uSize + 15) & ~15, '\0');
+
+	D3D11_BUFFER_DESC bufferDesc;
+	ZeroMemory(&bufferDesc, sizeof(bufferDesc));
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	bufferDesc.ByteWidth = contents.size();
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA initData;
+	ZeroMemory(&initData, sizeof(initData));
+	initData.pSysMem = contents.data();
+
+	ccSharedConstants constants;
+	constants.data = data;
+	constants.pBuffer = NULL;
+	if (FAILED(CCID3D11Device->CreateBuffer(&bufferDesc, &initData, &constants.pBuffer)))
+	{
+		return NULL;
+	}
+	m_sharedConstants.push_back(constants);
+	return constants.pBuffer;
+}
+
+void CCRenderQueue::setProgram(CCRenderProgram *pProgram)
+{
+	m_tPending.pProgram = pProgram;
+}
+
+void CCRenderQueue::setTexture(ID3D11ShaderResourceView *pTexture)
+{
+	m_tPending.pTexture = pTexture;
+}
+
+void CCRenderQueue::setSampler(ID3D11SamplerState *pSampler)
+{
+	m_tPending.pSampler = pSampler;
+}
+
+void CCRenderQueue::setBlendFunc(int sfactor, int dfactor)
+{
+	m_tPending.tBlendFunc.src = sfactor;
+	m_tPending.tBlendFunc.dst = dfactor;
+}
+
+void CCRenderQueue::setTopology(D3D11_PRIMITIVE_TOPOLOGY eTopology)
+{
+	m_tPending.eTopology = eTopology;
+}
+
+void CCRenderQueue::setVertexBuffer(UINT uSlot, ID3D11Buffer *pBuffer, UINT uStride, UINT uOffset)
+{
+	CCAssert(uSlot < 2, "the queue binds vertex buffers to slots 0 and 1");
+	m_tPending.pVertexBuffers[uSlot] = pBuffer;
+	m_tPending.uStrides[uSlot] = uStride;
+	m_tPending.uOffsets[uSlot] = uOffset;
+}
+
+void CCRenderQueue::setIndexBuffer(ID3D11Buffer *pBuffer)
+{
+	m_tPending.pIndexBuffer = pBuffer;
+}
+
+void CCRenderQueue::setVSConstants(UINT uSlot, ID3D11Buffer *pBuffer, UINT uFirstConstant, UINT uConstants)
+{
+	m_tPending.uVSConstantsSlot = uSlot;
+	m_tPending.pVSConstants = pBuffer;
+	m_tPending.uFirstConstant = uFirstConstant;
+	m_tPending.uConstants = uConstants;
+}
+
+void CCRenderQueue::setPSConstants(ID3D11Buffer *pBuffer)
+{
+	m_tPending.pPSConstants = pBuffer;
+}
+
+void CCRenderQueue::draw(UINT uVertexCount, UINT uStartVertex)
+{
+	CCAssert(! m_tPending.pIndexBuffer, "an index buffer is set, use drawIndexed()");
+	m_tPending.uCount = uVertexCount;
+	m_tPending.uStart = uStartVertex;
+	m_tPending.nBaseVertex = 0;
+	submit();
+}
+
+void CCRenderQueue::drawIndexed(UINT uIndexCount, UINT uStartIndex, INT nBaseVertex)
+{
+	CCAssert(m_tPending.pIndexBuffer, "no index buffer is set");
+	m_tPending.uCount = uIndexCount;
+	m_tPending.uStart = uStartIndex;
+	m_tPending.nBaseVertex = nBaseVertex;
+	submit();
+}
+
+void CCRenderQueue::repeatStates(void)
+{
+	m_tPending = m_tLastSubmitted;
+}
+
+void CCRenderQueue::submit(void)
+{
+	CCAssert(m_tPending.pProgram, "a draw needs a program");
+	if (! m_tPending.pProgram)
+	{
+		resetPending();
+		return;
+	}
+
+	++m_tStats.uPackets;
+	m_tPending.uSequence = m_uSequence++;
+	m_tLastSubmitted = m_tPending;
+
+	// a packet can only wait when its constants stay where they are: a range of the
+	// constant ring is never written again before the ring is discarded, and the
+	// queue is flushed then. A whole buffer is rewritten by the next draw.
+	bool bDeferrable = ! m_tPending.pVSConstants || m_tPending.uConstants > 0;
+	if (isUnordered() && bDeferrable)
+	{
+		m_packets.push_back(m_tPending);
+		retainPacket(m_packets.back());
+	}
+	else
+	{
+		flush();
+		execute(m_tPending);
+	}
+
+	resetPending();
+}
+
+void CCRenderQueue::resetPending(void)
+{
+	ccBlendFunc tBlendFunc = m_tPending.tBlendFunc;
+	memset(&m_tPending, 0, sizeof(m_tPending));
+	m_tPending.tBlendFunc = tBlendFunc;
+}
+
+bool CCRenderQueue::countChange(ccRenderState eState, bool bChanges)
+{
+	if (bChanges)
+	{
+		++m_tStats.uChanges[eState];
+	}
+	else
+	{
+		++m_tStats.uAvoided[eState];
+	}
+	return bChanges;
+}
+
+void CCRenderQueue::execute(const ccDrawPacket& packet)
+{
+	ID3D11DeviceContext *pContext = CCID3D11DeviceContext;
+
+	if (countChange(kCCRenderStateProgram, packet.pProgram != m_tBound.pProgram))
+	{
+		pContext->IASetInputLayout(packet.pProgram->getInputLayout());
+		pContext->VSSetShader(packet.pProgram->getVertexShader(), NULL, 0);
+		pContext->PSSetShader(packet.pProgram->getPixelShader(), NULL, 0);
+		m_tBound.pProgram = packet.pProgram;
+	}
+
+	if (packet.pTexture && countChange(kCCRenderStateTexture, packet.pTexture != m_tBound.pTexture))
+	{
+		pContext->PSSetShaderResources(0, 1, &packet.pTexture);
+		m_tBound.pTexture = packet.pTexture;
+	}
+
+	if (packet.pSampler && countChange(kCCRenderStateSampler, packet.pSampler != m_tBound.pSampler))
+	{
+		pContext->PSSetSamplers(0, 1, &packet.pSampler);
+		m_tBound.pSampler = packet.pSampler;
+	}
+
+	if (countChange(kCCRenderStateBlend, ! m_bBlendBound
+		|| packet.tBlendFunc.src != m_tBound.tBlendFunc.src || packet.tBlendFunc.dst != m_tBound.tBlendFunc.dst))
+	{
+		CCD3DCLASS->D3DBlendFunc(packet.tBlendFunc.src, packet.tBlendFunc.dst);
+		m_tBound.tBlendFunc = packet.tBlendFunc;
+		m_bBlendBound = true;
+	}
+
+	if (packet.eTopology != D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED
+		&& countChange(kCCRenderStateTopology, packet.eTopology != m_tBound.eTopology))
+	{
+		pContext->IASetPrimitiveTopology(packet.eTopology);
+		m_tBound.eTopology = packet.eTopology;
+	}
+
+	for (UINT i = 0; i < 2; ++i)
+	{
+		if (packet.pVertexBuffers[i] && countChange(kCCRenderStateVertices,
+			packet.pVertexBuffers[i] != m_tBound.pVertexBuffers[i]
+			|| packet.uStrides[i] != m_tBound.uStrides[i] || packet.uOffsets[i] != m_tBound.uOffsets[i]))
+		{
+			pContext->IASetVertexBuffers(i, 1, &packet.pVertexBuffers[i], &packet.uStrides[i], &packet.uOffsets[i]);
+			m_tBound.pVertexBuffers[i] = packet.pVertexBuffers[i];
+			m_tBound.uStrides[i] = packet.uStrides[i];
+			m_tBound.uOffsets[i] = packet.uOffsets[i];
+		}
+	}
+
+	if (packet.pIndexBuffer && countChange(kCCRenderStateIndices, packet.pIndexBuffer != m_tBound.pIndexBuffer))
+	{
+		pContext->IASetIndexBuffer(packet.pIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
+		m_tBound.pIndexBuffer = packet.pIndexBuffer;
+	}
+
+	if (packet.pVSConstants && countChange(kCCRenderStateVSConstants,
+		packet.pVSConstants != m_tBound.pVSConstants || packet.uVSConstantsSlot != m_tBound.uVSConstantsSlot
+		|| packet.uFirstConstant != m_tBound.uFirstConstant || packet.uConstants != m_tBound.uConstants))
+	{
+		if (packet.uConstants)
+		{
+			// the view hands out the ID3D11DeviceContext1 it records to as an ID3D11DeviceContext
+			static_cast<ID3D11DeviceContext1*>(pContext)->VSSetConstantBuffers1(packet.uVSConstantsSlot, 1,
+				&packet.pVSConstants, &packet.uFirstConstant, &packet.uConstants);
+		}
+		else
+		{
+			pContext->VSSetConstantBuffers(packet.uVSConstantsSlot, 1, &packet.pVSConstants);
+		}
+		m_tBound.uVSConstantsSlot = packet.uVSConstantsSlot;
+		m_tBound.pVSConstants = packet.pVSConstants;
+		m_tBound.uFirstConstant = packet.uFirstConstant;
+		m_tBound.uConstants = packet.uConstants;
+	}
+
+	if (packet.pPSConstants && countChange(kCCRenderStatePSConstants, packet.pPSConstants != m_tBound.pPSConstants))
+	{
+		pContext->PSSetConstantBuffers(0, 1, &packet.pPSConstants);
+		m_tBound.pPSConstants = packet.pPSConstants;
+	}
+
+	if (packet.pIndexBuffer)
+	{
+		pContext->DrawIndexed(packet.uCount, packet.uStart, packet.nBaseVertex);
+	}
+	else
+	{
+		pContext->Draw(packet.uCount, packet.uStart);
+	}
+}
+
+bool CCRenderQueue::packetLess(const ccDrawPacket& a, const ccDrawPacket& b)
+{
+	if (a.pProgram != b.pProgram)
+	{
+		return a.pProgram->getId() < b.pProgram->getId();
+	}
+	if (a.pTexture != b.pTexture)
+	{
+		return a.pTexture < b.pTexture;
+	}
+	if (a.tBlendFunc.src != b.tBlendFunc.src)
+	{
+		return a.tBlendFunc.src < b.tBlendFunc.src;
+	}
+	if (a.tBlendFunc.dst != b.tBlendFunc.dst)
+	{
+		return a.tBlendFunc.dst < b.tBlendFunc.dst;
+	}
+	return a.uSequence < b.uSequence;
+}
+
+void CCRenderQueue::flush(void)
+{
+	if (m_packets.empty())
+	{
+		return;
+	}
+
+	// the sequence breaks the ties, the draws sharing their states keep their order
+	std::sort(m_packets.begin(), m_packets.end(), packetLess);
+
+	for (unsigned int i = 0; i < m_packets.size(); ++i)
+	{
+		execute(m_packets[i]);
+		releasePacket(m_packets[i]);
+	}
+
+	m_tStats.uSortedPackets += m_packets.size();
+	++m_tStats.uSortedRanges;
+	m_packets.clear();
+}
+
+void CCRenderQueue::retainPacket(ccDrawPacket& packet)
+{
+	// the renderers may release what they drew with before the packet is drawn
+	packet.pProgram->retain();
+	if (packet.pTexture) packet.pTexture->AddRef();
+	if (packet.pSampler) packet.pSampler->AddRef();
+	if (packet.pVertexBuffers[0]) packet.pVertexBuffers[0]->AddRef();
+	if (packet.pVertexBuffers[1]) packet.pVertexBuffers[1]->AddRef();
+	if (packet.pIndexBuffer) packet.pIndexBuffer->AddRef();
+	if (packet.pVSConstants) packet.pVSConstants->AddRef();
+	if (packet.pPSConstants) packet.pPSConstants->AddRef();
+}
+
+void CCRenderQueue::releasePacket(ccDrawPacket& packet)
+{
+	packet.pProgram->release();
+	if (packet.pTexture) packet.pTexture->Release();
+	if (packet.pSampler) packet.pSampler->Release();
+	if (packet.pVertexBuffers[0]) packet.pVertexBuffers[0]->Release();
+	if (packet.pVertexBuffers[1]) packet.pVertexBuffers[1]->Release();
+	if (packet.pIndexBuffer) packet.pIndexBuffer->Release();
+	if (packet.pVSConstants) packet.pVSConstants->Release();
+	if (packet.pPSConstants) packet.pPSConstants->Release();
+}
+
+void CCRenderQueue::beginUnordered(void)
+{
+	if (0 == m_nUnorderedDepth++)
+	{
+		listenToDiscards(true);
+	}
+}
+
+void CCRenderQueue::endUnordered(void)
+{
+	CCAssert(m_nUnorderedDepth > 0, "endUnordered() without beginUnordered()");
+	if (0 == --m_nUnorderedDepth)
+	{
+		flush();
+		listenToDiscards(false);
+	}
+}
+
+void CCRenderQueue::listenToDiscards(bool bListen)
+{
+	// a discarded ring hands out new memory, the queued draws have to read the previous one
+	CCDynamicBuffers *pBuffers = CCDynamicBuffers::sharedDynamicBuffers();
+	CCObject *pTarget = bListen ? this : NULL;
+	pBuffers->getGeometryRing()->setDiscardListener(pTarget, callfunc_selector(CCRenderQueue::flush));
+	if (pBuffers->getConstantRing())
+	{
+		pBuffers->getConstantRing()->setDiscardListener(pTarget, callfunc_selector(CCRenderQueue::flush));
+	}
+}
+
+void CCRenderQueue::invalidateState(void)
+{
+	memset(&m_tBound, 0, sizeof(m_tBound));
+	m_bBlendBound = false;
+}
+
+void CCRenderQueue::frameEnded(void)
+{
+	CCAssert(! isUnordered(), "an unordered range is still open");
+	flush();
+}
+
+void CCRenderQueue::resetStats(void)
+{
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+}//namespace cocos2d
@@ -35,6 +35,8 @@ using namespace std;
 
 namespace   cocos2d {
 
+CC_POOLED_ALLOC_IMPL(CCTimer, 64)
+
 // data structures
 
 // A list double-linked list used for "updates with priority"
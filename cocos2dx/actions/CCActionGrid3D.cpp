@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include "CCActionGrid3D.h"
 #include "CCPointExtension.h"
 #include "CCDirector.h"
+#include "effects/CCGrid.h"
 
 #include <stdlib.h>
 
@@ -91,17 +92,9 @@ namespace cocos2d
 
 	void CCWaves3D::update(ccTime time)
 	{
-		int i, j;
-		for (i = 0; i < m_sGridSize.x + 1; ++i)
-		{
-			for (j = 0; j < m_sGridSize.y + 1; ++j)
-			{
-				ccVertex3F v = originalVertex(ccg(i ,j));
-				v.z += (sinf((CGFloat)M_PI * time * m_nWaves * 2 + (v.y+v.x) * .01f) * m_fAmplitude * m_fAmplitudeRate);
-				CCLog("v.z offset is %f\n", (sinf((CGFloat)M_PI * time * m_nWaves * 2 + (v.y+v.x) * .01f) * m_fAmplitude * m_fAmplitudeRate));
-				setVertex(ccg(i, j), v);
-			}
-		}
+		tGridVertices vertices;
+		m_pTarget->getGrid()->getDeformVertices(&vertices);
+		ccGridWaves3D(&vertices, (CGFloat)M_PI * time * m_nWaves * 2, m_fAmplitude * m_fAmplitudeRate);
 	}
 
 	// implementation of CCFlipX3D
@@ -415,39 +408,9 @@ namespace cocos2d
         CC_UNUSED_PARAM(time);
 		if (m_bDirty)
 		{
-			int i, j;
-			
-			for (i = 0; i < m_sGridSize.x + 1; ++i)
-			{
-				for (j = 0; j < m_sGridSize.y + 1; ++j)
-				{
-					ccVertex3F v = originalVertex(ccg(i, j));
-					CCPoint vect = ccpSub(m_positionInPixels, ccp(v.x, v.y));
-					CGFloat r = ccpLength(vect);
-					
-					if (r < m_fRadius)
-					{
-						r = m_fRadius - r;
-						CGFloat pre_log = r / m_fRadius;
-						if ( pre_log == 0 ) 
-						{
-							pre_log = 0.001f;
-						}
-
-						float l = logf(pre_log) * m_fLensEffect;
-						float new_r = expf( l ) * m_fRadius;
-						
-						if (ccpLength(vect) > 0)
-						{
-							vect = ccpNormalize(vect);
-							CCPoint new_vect = ccpMult(vect, new_r);
-							v.z += ccpLength(new_vect) * m_fLensEffect;
-						}
-					}
-					
-					setVertex(ccg(i, j), v);
-				}
-			}
+			tGridVertices vertices;
+			m_pTarget->getGrid()->getDeformVertices(&vertices);
+			ccGridLens(&vertices, m_positionInPixels.x, m_positionInPixels.y, m_fRadius, m_fLensEffect);
 			
 			m_bDirty = false;
 		}
@@ -522,26 +485,10 @@ namespace cocos2d
 
 	void CCRipple3D::update(ccTime time)
 	{
-		int i, j;
-	
-		for (i = 0; i < (m_sGridSize.x+1); ++i)
-		{
-			for (j = 0; j < (m_sGridSize.y+1); ++j)
-			{
-				ccVertex3F v = originalVertex(ccg(i, j));
-				CCPoint vect = ccpSub(m_positionInPixels, ccp(v.x,v.y));
-				CGFloat r = ccpLength(vect);
-				
-				if (r < m_fRadius)
-				{
-					r = m_fRadius - r;
-					CGFloat rate = powf(r / m_fRadius, 2);
-					v.z += (sinf( time*(CGFloat)M_PI * m_nWaves * 2 + r * 0.1f) * m_fAmplitude * m_fAmplitudeRate * rate);
-				}
-				
-				setVertex(ccg(i, j), v);
-			}
-		}
+		tGridVertices vertices;
+		m_pTarget->getGrid()->getDeformVertices(&vertices);
+		ccGridRipple(&vertices, m_positionInPixels.x, m_positionInPixels.y, m_fRadius,
+			time * (CGFloat)M_PI * m_nWaves * 2, m_fAmplitude * m_fAmplitudeRate);
 	}
 
 	// implementation of Shaky3D
@@ -571,6 +518,7 @@ namespace cocos2d
 		{
 			m_nRandrange = range;
 			m_bShakeZ = shakeZ;
+			m_uSeed = (unsigned int)rand();
 
 			return true;
 		}
@@ -604,23 +552,9 @@ namespace cocos2d
 	void CCShaky3D::update(ccTime time)
 	{
         CC_UNUSED_PARAM(time);
-		int i, j;
-	
-		for (i = 0; i < (m_sGridSize.x+1); ++i)
-		{
-			for (j = 0; j < (m_sGridSize.y+1); ++j)
-			{
-				ccVertex3F v = originalVertex(ccg(i ,j));
-				v.x += (rand() % (m_nRandrange*2)) - m_nRandrange;
-				v.y += (rand() % (m_nRandrange*2)) - m_nRandrange;
-				if (m_bShakeZ)
-				{
-					v.z += (rand() % (m_nRandrange*2)) - m_nRandrange;
-				}
-				
-				setVertex(ccg(i, j), v);
-			}
-		}
+		tGridVertices vertices;
+		m_pTarget->getGrid()->getDeformVertices(&vertices);
+		ccGridShaky(&vertices, m_nRandrange, m_bShakeZ, &m_uSeed);
 	}
 
 	// implementation of Liquid
@@ -759,27 +693,9 @@ namespace cocos2d
 
 	void CCWaves::update(ccTime time)
 	{
-		int i, j;
-
-		for (i = 0; i < m_sGridSize.x + 1; ++i)
-		{
-			for (j = 0; j < m_sGridSize.y + 1; ++j)
-			{
-				ccVertex3F v = originalVertex(ccg(i, j));
-
-				if (m_bVertical)
-				{
-					v.x = (v.x + (sinf(time * (CGFloat)M_PI * m_nWaves * 2 + v.y * .01f) * m_fAmplitude * m_fAmplitudeRate));
-				}
-
-				if (m_bHorizontal)
-				{
-                    v.y = (v.y + (sinf(time * (CGFloat)M_PI * m_nWaves * 2 + v.x * .01f) * m_fAmplitude * m_fAmplitudeRate));
-				}
-
-				setVertex(ccg(i, j), v);
-			}
-		}
+		tGridVertices vertices;
+		m_pTarget->getGrid()->getDeformVertices(&vertices);
+		ccGridWaves(&vertices, time * (CGFloat)M_PI * m_nWaves * 2, m_fAmplitude * m_fAmplitudeRate, m_bVertical, m_bHorizontal);
 	}
 
 	// implementation of Twirl
@@ -851,32 +767,13 @@ namespace cocos2d
 
 	void CCTwirl::update(ccTime time)
 	{
-		int i, j;
-		CCPoint	c = m_positionInPixels;
-		
-		for (i = 0; i < (m_sGridSize.x+1); ++i)
-		{
-			for (j = 0; j < (m_sGridSize.y+1); ++j)
-			{
-				ccVertex3F v = originalVertex(ccg(i ,j));
-				
-				CCPoint	avg = ccp(i-(m_sGridSize.x/2.0f), j-(m_sGridSize.y/2.0f));
-				CGFloat r = ccpLength(avg);
-				
-				CGFloat amp = 0.1f * m_fAmplitude * m_fAmplitudeRate;
-				CGFloat a = r * cosf( (CGFloat)M_PI/2.0f + time * (CGFloat)M_PI * m_nTwirls * 2 ) * amp;
-				
-				CCPoint	d;
-				
-				d.x = sinf(a) * (v.y-c.y) + cosf(a) * (v.x-c.x);
-				d.y = cosf(a) * (v.y-c.y) - sinf(a) * (v.x-c.x);
-				
-				v.x = c.x + d.x;
-				v.y = c.y + d.y;
-
-				setVertex(ccg(i ,j), v);
-			}
-		}
+		// the angle of a vertex is this times its distance to the middle of the grid
+		CGFloat amp = 0.1f * m_fAmplitude * m_fAmplitudeRate;
+		CGFloat a = cosf( (CGFloat)M_PI/2.0f + time * (CGFloat)M_PI * m_nTwirls * 2 ) * amp;
+
+		tGridVertices vertices;
+		m_pTarget->getGrid()->getDeformVertices(&vertices);
+		ccGridTwirl(&vertices, m_sGridSize.x, m_sGridSize.y, m_positionInPixels.x, m_positionInPixels.y, a);
 	}
 
 } // end of namespace cocos2d
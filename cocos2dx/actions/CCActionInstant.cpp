@@ -29,6 +29,15 @@
 #include "CCSprite.h"
 
 namespace cocos2d {
+
+CC_POOLED_ALLOC_IMPL(CCShow, 64)
+CC_POOLED_ALLOC_IMPL(CCHide, 64)
+CC_POOLED_ALLOC_IMPL(CCPlace, 64)
+CC_POOLED_ALLOC_IMPL(CCCallFunc, 64)
+CC_POOLED_ALLOC_IMPL(CCCallFuncN, 64)
+CC_POOLED_ALLOC_IMPL(CCCallFuncND, 64)
+CC_POOLED_ALLOC_IMPL(CCCallFuncO, 64)
+
 //
 // InstantAction
 //
@@ -34,6 +34,23 @@ THE SOFTWARE.
 
 namespace cocos2d {
 
+// the actions created and thrown away most often come from slabs
+CC_POOLED_ALLOC_IMPL(CCSequence, 64)
+CC_POOLED_ALLOC_IMPL(CCRepeat, 64)
+CC_POOLED_ALLOC_IMPL(CCRepeatForever, 64)
+CC_POOLED_ALLOC_IMPL(CCSpawn, 64)
+CC_POOLED_ALLOC_IMPL(CCRotateTo, 64)
+CC_POOLED_ALLOC_IMPL(CCRotateBy, 64)
+CC_POOLED_ALLOC_IMPL(CCMoveTo, 64)
+CC_POOLED_ALLOC_IMPL(CCMoveBy, 64)
+CC_POOLED_ALLOC_IMPL(CCScaleTo, 64)
+CC_POOLED_ALLOC_IMPL(CCScaleBy, 64)
+CC_POOLED_ALLOC_IMPL(CCFadeIn, 64)
+CC_POOLED_ALLOC_IMPL(CCFadeOut, 64)
+CC_POOLED_ALLOC_IMPL(CCFadeTo, 64)
+CC_POOLED_ALLOC_IMPL(CCTintTo, 64)
+CC_POOLED_ALLOC_IMPL(CCDelayTime, 64)
+
 //
 // IntervalAction
 //
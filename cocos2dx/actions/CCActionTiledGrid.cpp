@@ -66,6 +66,7 @@ namespace cocos2d
 		{
 			m_nRandrange = nRange;
 			m_bShakeZ = bShakeZ;
+			m_uSeed = (unsigned int)rand();
 
 			return true;
 		}
@@ -99,37 +100,9 @@ namespace cocos2d
 	void CCShakyTiles3D::update(ccTime time)
 	{
         CC_UNUSED_PARAM(time);
-		int i, j;
-	
-		for (i = 0; i < m_sGridSize.x; ++i)
-		{
-			for (j = 0; j < m_sGridSize.y; ++j)
-			{
-				ccQuad3 coords = originalTile(ccg(i, j));
-
-				// X
-				coords.bl.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-				coords.br.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-				coords.tl.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-				coords.tr.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-
-				// Y
-				coords.bl.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-				coords.br.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-				coords.tl.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-				coords.tr.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-
-				if (m_bShakeZ)
-				{
-					coords.bl.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-					coords.br.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-					coords.tl.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-					coords.tr.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-				}
-							
-				setTile(ccg(i, j), coords);
-			}
-		}
+		tGridVertices vertices;
+		m_pTarget->getGrid()->getDeformVertices(&vertices);
+		ccGridShaky(&vertices, m_nRandrange, m_bShakeZ, &m_uSeed);
 	}
 
 	// implementation of CCShatteredTiles3D
@@ -0,0 +1,799 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCTweenManager.h"
+#include "CCScheduler.h"
+#include "CCNode.h"
+#include "CCProtocols.h"
+#include "CCActionInterval.h"
+#include "CCActionEase.h"
+#include "ccMacros.h"
+
+#include <float.h>
+#include <math.h>
+
+namespace cocos2d {
+
+static CCTweenManager *gSharedTweenManager = NULL;
+
+// number of floats animated for each ccTweenProperty
+static const unsigned int s_uComponents[kCCTweenPropertyCount] = { 2, 2, 1, 1, 3 };
+
+static inline float bounceTime(float time)
+{
+	if (time < 1 / 2.75f)
+	{
+		return 7.5625f * time * time;
+	}
+	else if (time < 2 / 2.75f)
+	{
+		time -= 1.5f / 2.75f;
+		return 7.5625f * time * time + 0.75f;
+	}
+	else if (time < 2.5f / 2.75f)
+	{
+		time -= 2.25f / 2.75f;
+		return 7.5625f * time * time + 0.9375f;
+	}
+
+	time -= 2.625f / 2.75f;
+	return 7.5625f * time * time + 0.984375f;
+}
+
+// same curves as the CCActionEase actions
+static inline float easeTime(ccTweenEase eEase, float fParam, float time)
+{
+	const float fPI_X_2 = (float)M_PI * 2.0f;
+
+	switch (eEase)
+	{
+	case kCCTweenEaseIn:
+		return powf(time, fParam);
+	case kCCTweenEaseOut:
+		return powf(time, 1 / fParam);
+	case kCCTweenEaseInOut:
+		{
+			int sign = ((int)fParam % 2 == 0) ? -1 : 1;
+			time *= 2;
+			if (time < 1)
+			{
+				return 0.5f * powf(time, fParam);
+			}
+			return sign * 0.5f * (powf(time - 2, fParam) + sign * 2);
+		}
+	case kCCTweenEaseExponentialIn:
+		return time == 0 ? 0 : powf(2, 10 * (time - 1)) - 0.001f;
+	case kCCTweenEaseExponentialOut:
+		return time == 1 ? 1 : (-powf(2, -10 * time) + 1);
+	case kCCTweenEaseExponentialInOut:
+		time /= 0.5f;
+		if (time < 1)
+		{
+			return 0.5f * powf(2, 10 * (time - 1));
+		}
+		return 0.5f * (-powf(2, 10 * (time - 1)) + 2);
+	case kCCTweenEaseSineIn:
+		return -1 * cosf(time * (float)M_PI_2) + 1;
+	case kCCTweenEaseSineOut:
+		return sinf(time * (float)M_PI_2);
+	case kCCTweenEaseSineInOut:
+		return -0.5f * (cosf((float)M_PI * time) - 1);
+	case kCCTweenEaseElasticIn:
+		if (time == 0 || time == 1)
+		{
+			return time;
+		}
+		time = time - 1;
+		return -powf(2, 10 * time) * sinf((time - fParam / 4) * fPI_X_2 / fParam);
+	case kCCTweenEaseElasticOut:
+		if (time == 0 || time == 1)
+		{
+			return time;
+		}
+		return powf(2, -10 * time) * sinf((time - fParam / 4) * fPI_X_2 / fParam) + 1;
+	case kCCTweenEaseElasticInOut:
+		if (time == 0 || time == 1)
+		{
+			return time;
+		}
+		time = time * 2 - 1;
+		if (time < 0)
+		{
+			return -0.5f * powf(2, 10 * time) * sinf((time - fParam / 4) * fPI_X_2 / fParam);
+		}
+		return powf(2, -10 * time) * sinf((time - fParam / 4) * fPI_X_2 / fParam) * 0.5f + 1;
+	case kCCTweenEaseBounceIn:
+		return 1 - bounceTime(1 - time);
+	case kCCTweenEaseBounceOut:
+		return bounceTime(time);
+	case kCCTweenEaseBounceInOut:
+		if (time < 0.5f)
+		{
+			return (1 - bounceTime(1 - time * 2)) * 0.5f;
+		}
+		return bounceTime(time * 2 - 1) * 0.5f + 0.5f;
+	case kCCTweenEaseBackIn:
+		{
+			const float overshoot = 1.70158f;
+			return time * time * ((overshoot + 1) * time - overshoot);
+		}
+	case kCCTweenEaseBackOut:
+		{
+			const float overshoot = 1.70158f;
+			time = time - 1;
+			return time * time * ((overshoot + 1) * time + overshoot) + 1;
+		}
+	case kCCTweenEaseBackInOut:
+		{
+			const float overshoot = 1.70158f * 1.525f;
+			time = time * 2;
+			if (time < 1)
+			{
+				return (time * time * ((overshoot + 1) * time - overshoot)) / 2;
+			}
+			time = time - 2;
+			return (time * time * ((overshoot + 1) * time + overshoot)) / 2 + 1;
+		}
+	default:
+		return time;
+	}
+}
+
+// default parameter of the curves, as in the CCActionEase actions
+static float defaultEaseParam(ccTweenEase eEase, float fParam)
+{
+	if (fParam != 0)
+	{
+		return fParam;
+	}
+
+	switch (eEase)
+	{
+	case kCCTweenEaseIn:
+	case kCCTweenEaseOut:
+	case kCCTweenEaseInOut:
+		return 1.0f;
+	case kCCTweenEaseElasticIn:
+	case kCCTweenEaseElasticOut:
+		return 0.3f;
+	case kCCTweenEaseElasticInOut:
+		return 0.3f * 1.5f;
+	default:
+		return fParam;
+	}
+}
+
+// maps an ease action to its curve, false if it is not one of the CCActionEase curves
+static bool easeFromAction(CCActionEase *pEase, ccTweenEase *pCurve, float *pParam)
+{
+	*pParam = 0;
+
+	if (dynamic_cast<CCEaseIn*>(pEase))
+	{
+		*pCurve = kCCTweenEaseIn;
+		*pParam = ((CCEaseRateAction*)pEase)->getRate();
+	}
+	else if (dynamic_cast<CCEaseOut*>(pEase))
+	{
+		*pCurve = kCCTweenEaseOut;
+		*pParam = ((CCEaseRateAction*)pEase)->getRate();
+	}
+	else if (dynamic_cast<CCEaseInOut*>(pEase))
+	{
+		*pCurve = kCCTweenEaseInOut;
+		*pParam = ((CCEaseRateAction*)pEase)->getRate();
+	}
+	else if (dynamic_cast<CCEaseExponentialIn*>(pEase))    *pCurve = kCCTweenEaseExponentialIn;
+	else if (dynamic_cast<CCEaseExponentialOut*>(pEase))   *pCurve = kCCTweenEaseExponentialOut;
+	else if (dynamic_cast<CCEaseExponentialInOut*>(pEase)) *pCurve = kCCTweenEaseExponentialInOut;
+	else if (dynamic_cast<CCEaseSineIn*>(pEase))           *pCurve = kCCTweenEaseSineIn;
+	else if (dynamic_cast<CCEaseSineOut*>(pEase))          *pCurve = kCCTweenEaseSineOut;
+	else if (dynamic_cast<CCEaseSineInOut*>(pEase))        *pCurve = kCCTweenEaseSineInOut;
+	else if (dynamic_cast<CCEaseElasticIn*>(pEase))
+	{
+		*pCurve = kCCTweenEaseElasticIn;
+		*pParam = ((CCEaseElastic*)pEase)->getPeriod();
+	}
+	else if (dynamic_cast<CCEaseElasticOut*>(pEase))
+	{
+		*pCurve = kCCTweenEaseElasticOut;
+		*pParam = ((CCEaseElastic*)pEase)->getPeriod();
+	}
+	else if (dynamic_cast<CCEaseElasticInOut*>(pEase))
+	{
+		*pCurve = kCCTweenEaseElasticInOut;
+		*pParam = ((CCEaseElastic*)pEase)->getPeriod();
+	}
+	else if (dynamic_cast<CCEaseBounceIn*>(pEase))         *pCurve = kCCTweenEaseBounceIn;
+	else if (dynamic_cast<CCEaseBounceOut*>(pEase))        *pCurve = kCCTweenEaseBounceOut;
+	else if (dynamic_cast<CCEaseBounceInOut*>(pEase))      *pCurve = kCCTweenEaseBounceInOut;
+	else if (dynamic_cast<CCEaseBackIn*>(pEase))           *pCurve = kCCTweenEaseBackIn;
+	else if (dynamic_cast<CCEaseBackOut*>(pEase))          *pCurve = kCCTweenEaseBackOut;
+	else if (dynamic_cast<CCEaseBackInOut*>(pEase))        *pCurve = kCCTweenEaseBackInOut;
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+CCTweenManager* CCTweenManager::sharedManager(void)
+{
+	if (! gSharedTweenManager)
+	{
+		gSharedTweenManager = new CCTweenManager();
+		if (! gSharedTweenManager->init())
+		{
+			CC_SAFE_DELETE(gSharedTweenManager);
+		}
+	}
+
+	return gSharedTweenManager;
+}
+
+CCTweenManager* CCTweenManager::existingManager(void)
+{
+	return gSharedTweenManager;
+}
+
+void CCTweenManager::purgeSharedManager(void)
+{
+	if (gSharedTweenManager)
+	{
+		CCScheduler::sharedScheduler()->unscheduleUpdateForTarget(gSharedTweenManager);
+		CC_SAFE_RELEASE_NULL(gSharedTweenManager);
+	}
+}
+
+CCTweenManager::CCTweenManager(void)
+: m_uNextID(0)
+{
+	CCAssert(gSharedTweenManager == NULL, "");
+}
+
+CCTweenManager::~CCTweenManager(void)
+{
+	CCLOGINFO("cocos2d: deallocing %p", this);
+
+	removeAllTweens();
+}
+
+bool CCTweenManager::init(void)
+{
+	CCScheduler::sharedScheduler()->scheduleUpdateForTarget(this, 0, false);
+	return true;
+}
+
+unsigned int CCTweenManager::addTween(ccTweenProperty eProperty, CCNode *pTarget, CCRGBAProtocol *pRGBA,
+	const float *pFrom, const float *pDelta, ccTime duration, ccTweenEase eEase, float fEaseParam)
+{
+	CCAssert(pTarget != NULL, "");
+
+	tTween tween;
+	tween.pTarget = pTarget;
+	tween.pRGBA = pRGBA;
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		tween.from[i] = i < s_uComponents[eProperty] ? pFrom[i] : 0;
+		tween.delta[i] = i < s_uComponents[eProperty] ? pDelta[i] : 0;
+	}
+	tween.elapsed = 0;
+	// prevent division by 0, as CCActionInterval does
+	tween.duration = duration == 0 ? FLT_EPSILON : duration;
+	tween.easeParam = defaultEaseParam(eEase, fEaseParam);
+	tween.uID = ++m_uNextID;
+	tween.eEase = eEase;
+	tween.bFirstTick = true;
+	tween.bRemoved = false;
+
+	std::map<CCNode*, tTargetInfo>::iterator it = m_targets.find(pTarget);
+	if (it == m_targets.end())
+	{
+		// tweens added to a node that is not running wait for onEnter, like actions
+		tTargetInfo info = { 0, ! pTarget->getIsRunning() };
+		it = m_targets.insert(std::make_pair(pTarget, info)).first;
+	}
+	++it->second.uCount;
+	tween.bPaused = it->second.bPaused;
+
+	pTarget->retain();
+	m_tweens[eProperty].push_back(tween);
+
+	return tween.uID;
+}
+
+unsigned int CCTweenManager::runAction(CCAction *pAction, CCNode *pTarget)
+{
+	CCActionInterval *pInterval = dynamic_cast<CCActionInterval*>(pAction);
+	ccTweenEase eEase = kCCTweenEaseLinear;
+	float fEaseParam = 0;
+
+	CCActionEase *pEase = dynamic_cast<CCActionEase*>(pAction);
+	if (pEase)
+	{
+		pInterval = easeFromAction(pEase, &eEase, &fEaseParam) ? pEase->getInnerAction() : NULL;
+	}
+
+	ccTweenProperty eProperty = kCCTweenPropertyCount;
+	CCRGBAProtocol *pRGBA = NULL;
+	float from[3] = { 0, 0, 0 };
+	float delta[3] = { 0, 0, 0 };
+
+	if (pInterval)
+	{
+		CCMoveTo *pMove = NULL;
+		CCScaleTo *pScale = NULL;
+		CCRotateTo *pRotateTo = NULL;
+		CCRotateBy *pRotateBy = NULL;
+		CCTintTo *pTintTo = NULL;
+		CCTintBy *pTintBy = NULL;
+		CCFadeTo *pFadeTo = NULL;
+
+		if ((pMove = dynamic_cast<CCMoveTo*>(pInterval)) != NULL)
+		{
+			pMove->startWithTarget(pTarget);
+			eProperty = kCCTweenPosition;
+			from[0] = pMove->m_startPosition.x;
+			from[1] = pMove->m_startPosition.y;
+			delta[0] = pMove->m_delta.x;
+			delta[1] = pMove->m_delta.y;
+		}
+		else if ((pScale = dynamic_cast<CCScaleTo*>(pInterval)) != NULL)
+		{
+			pScale->startWithTarget(pTarget);
+			eProperty = kCCTweenScale;
+			from[0] = pScale->m_fStartScaleX;
+			from[1] = pScale->m_fStartScaleY;
+			delta[0] = pScale->m_fDeltaX;
+			delta[1] = pScale->m_fDeltaY;
+		}
+		else if ((pRotateTo = dynamic_cast<CCRotateTo*>(pInterval)) != NULL)
+		{
+			pRotateTo->startWithTarget(pTarget);
+			eProperty = kCCTweenRotation;
+			from[0] = pRotateTo->m_fStartAngle;
+			delta[0] = pRotateTo->m_fDiffAngle;
+		}
+		else if ((pRotateBy = dynamic_cast<CCRotateBy*>(pInterval)) != NULL)
+		{
+			pRotateBy->startWithTarget(pTarget);
+			eProperty = kCCTweenRotation;
+			from[0] = pRotateBy->m_fStartAngle;
+			delta[0] = pRotateBy->m_fAngle;
+		}
+		else if ((pRGBA = dynamic_cast<CCRGBAProtocol*>(pTarget)) != NULL)
+		{
+			if (dynamic_cast<CCFadeIn*>(pInterval))
+			{
+				eProperty = kCCTweenOpacity;
+				from[0] = 0;
+				delta[0] = 255;
+			}
+			else if (dynamic_cast<CCFadeOut*>(pInterval))
+			{
+				eProperty = kCCTweenOpacity;
+				from[0] = 255;
+				delta[0] = -255;
+			}
+			else if ((pFadeTo = dynamic_cast<CCFadeTo*>(pInterval)) != NULL)
+			{
+				pFadeTo->startWithTarget(pTarget);
+				eProperty = kCCTweenOpacity;
+				from[0] = pFadeTo->m_fromOpacity;
+				delta[0] = (float)pFadeTo->m_toOpacity - pFadeTo->m_fromOpacity;
+			}
+			else if ((pTintTo = dynamic_cast<CCTintTo*>(pInterval)) != NULL)
+			{
+				pTintTo->startWithTarget(pTarget);
+				eProperty = kCCTweenColor;
+				from[0] = pTintTo->m_from.r;
+				from[1] = pTintTo->m_from.g;
+				from[2] = pTintTo->m_from.b;
+				delta[0] = (float)pTintTo->m_to.r - pTintTo->m_from.r;
+				delta[1] = (float)pTintTo->m_to.g - pTintTo->m_from.g;
+				delta[2] = (float)pTintTo->m_to.b - pTintTo->m_from.b;
+			}
+			else if ((pTintBy = dynamic_cast<CCTintBy*>(pInterval)) != NULL)
+			{
+				pTintBy->startWithTarget(pTarget);
+				eProperty = kCCTweenColor;
+				from[0] = pTintBy->m_fromR;
+				from[1] = pTintBy->m_fromG;
+				from[2] = pTintBy->m_fromB;
+				delta[0] = pTintBy->m_deltaR;
+				delta[1] = pTintBy->m_deltaG;
+				delta[2] = pTintBy->m_deltaB;
+			}
+		}
+	}
+
+	if (eProperty == kCCTweenPropertyCount)
+	{
+		pTarget->runAction(pAction);
+		return 0;
+	}
+
+	return addTween(eProperty, pTarget, pRGBA, from, delta, pInterval->getDuration(), eEase, fEaseParam);
+}
+
+unsigned int CCTweenManager::moveTo(CCNode *pTarget, ccTime duration, const CCPoint& position, ccTweenEase eEase, float fEaseParam)
+{
+	const CCPoint& start = pTarget->getPosition();
+	float from[2] = { start.x, start.y };
+	float delta[2] = { position.x - start.x, position.y - start.y };
+	return addTween(kCCTweenPosition, pTarget, NULL, from, delta, duration, eEase, fEaseParam);
+}
+
+unsigned int CCTweenManager::moveBy(CCNode *pTarget, ccTime duration, const CCPoint& delta, ccTweenEase eEase, float fEaseParam)
+{
+	const CCPoint& start = pTarget->getPosition();
+	float from[2] = { start.x, start.y };
+	float d[2] = { delta.x, delta.y };
+	return addTween(kCCTweenPosition, pTarget, NULL, from, d, duration, eEase, fEaseParam);
+}
+
+unsigned int CCTweenManager::scaleTo(CCNode *pTarget, ccTime duration, float sx, float sy, ccTweenEase eEase, float fEaseParam)
+{
+	float from[2] = { pTarget->getScaleX(), pTarget->getScaleY() };
+	float delta[2] = { sx - from[0], sy - from[1] };
+	return addTween(kCCTweenScale, pTarget, NULL, from, delta, duration, eEase, fEaseParam);
+}
+
+unsigned int CCTweenManager::rotateTo(CCNode *pTarget, ccTime duration, float fAngle, ccTweenEase eEase, float fEaseParam)
+{
+	// shortest way, as CCRotateTo
+	float fStart = pTarget->getRotation();
+	fStart = fStart > 0 ? fmodf(fStart, 360.0f) : fmodf(fStart, -360.0f);
+
+	float fDiff = fAngle - fStart;
+	if (fDiff > 180)
+	{
+		fDiff -= 360;
+	}
+	if (fDiff < -180)
+	{
+		fDiff += 360;
+	}
+
+	return addTween(kCCTweenRotation, pTarget, NULL, &fStart, &fDiff, duration, eEase, fEaseParam);
+}
+
+unsigned int CCTweenManager::rotateBy(CCNode *pTarget, ccTime duration, float fDeltaAngle, ccTweenEase eEase, float fEaseParam)
+{
+	float fStart = pTarget->getRotation();
+	return addTween(kCCTweenRotation, pTarget, NULL, &fStart, &fDeltaAngle, duration, eEase, fEaseParam);
+}
+
+unsigned int CCTweenManager::fadeTo(CCNode *pTarget, ccTime duration, CCubyte opacity, ccTweenEase eEase, float fEaseParam)
+{
+	CCRGBAProtocol *pRGBA = dynamic_cast<CCRGBAProtocol*>(pTarget);
+	if (! pRGBA)
+	{
+		return 0;
+	}
+
+	float fFrom = pRGBA->getOpacity();
+	float fDelta = opacity - fFrom;
+	return addTween(kCCTweenOpacity, pTarget, pRGBA, &fFrom, &fDelta, duration, eEase, fEaseParam);
+}
+
+unsigned int CCTweenManager::tintTo(CCNode *pTarget, ccTime duration, const ccColor3B& color, ccTweenEase eEase, float fEaseParam)
+{
+	CCRGBAProtocol *pRGBA = dynamic_cast<CCRGBAProtocol*>(pTarget);
+	if (! pRGBA)
+	{
+		return 0;
+	}
+
+	const ccColor3B& start = pRGBA->getColor();
+	float from[3] = { (float)start.r, (float)start.g, (float)start.b };
+	float delta[3] = { (float)color.r - start.r, (float)color.g - start.g, (float)color.b - start.b };
+	return addTween(kCCTweenColor, pTarget, pRGBA, from, delta, duration, eEase, fEaseParam);
+}
+
+void CCTweenManager::removeTween(unsigned int uTweenID)
+{
+	for (int p = 0; p < kCCTweenPropertyCount; ++p)
+	{
+		std::vector<tTween>& tweens = m_tweens[p];
+		for (unsigned int i = 0; i < tweens.size(); ++i)
+		{
+			tTween& tween = tweens[i];
+			if (tween.uID == uTweenID && ! tween.bRemoved)
+			{
+				// the target is released when the arrays are compacted
+				tween.bRemoved = true;
+
+				std::map<CCNode*, tTargetInfo>::iterator it = m_targets.find(tween.pTarget);
+				if (it != m_targets.end() && --it->second.uCount == 0)
+				{
+					m_targets.erase(it);
+				}
+				return;
+			}
+		}
+	}
+}
+
+void CCTweenManager::removeAllTweensFromTarget(CCNode *pTarget)
+{
+	std::map<CCNode*, tTargetInfo>::iterator it = m_targets.find(pTarget);
+	if (it == m_targets.end())
+	{
+		return;
+	}
+	m_targets.erase(it);
+
+	for (int p = 0; p < kCCTweenPropertyCount; ++p)
+	{
+		std::vector<tTween>& tweens = m_tweens[p];
+		for (unsigned int i = 0; i < tweens.size(); ++i)
+		{
+			if (tweens[i].pTarget == pTarget)
+			{
+				tweens[i].bRemoved = true;
+			}
+		}
+	}
+}
+
+void CCTweenManager::removeAllTweens(void)
+{
+	for (int p = 0; p < kCCTweenPropertyCount; ++p)
+	{
+		std::vector<tTween> tweens;
+		tweens.swap(m_tweens[p]);
+		for (unsigned int i = 0; i < tweens.size(); ++i)
+		{
+			tweens[i].pTarget->release();
+		}
+	}
+	m_targets.clear();
+}
+
+unsigned int CCTweenManager::numberOfRunningTweensInTarget(CCNode *pTarget)
+{
+	std::map<CCNode*, tTargetInfo>::iterator it = m_targets.find(pTarget);
+	return it != m_targets.end() ? it->second.uCount : 0;
+}
+
+unsigned int CCTweenManager::numberOfRunningTweens(void)
+{
+	unsigned int uCount = 0;
+	std::map<CCNode*, tTargetInfo>::iterator it;
+	for (it = m_targets.begin(); it != m_targets.end(); ++it)
+	{
+		uCount += it->second.uCount;
+	}
+	return uCount;
+}
+
+void CCTweenManager::pauseTarget(CCNode *pTarget)
+{
+	std::map<CCNode*, tTargetInfo>::iterator it = m_targets.find(pTarget);
+	if (it == m_targets.end() || it->second.bPaused)
+	{
+		return;
+	}
+	it->second.bPaused = true;
+
+	for (int p = 0; p < kCCTweenPropertyCount; ++p)
+	{
+		std::vector<tTween>& tweens = m_tweens[p];
+		for (unsigned int i = 0; i < tweens.size(); ++i)
+		{
+			if (tweens[i].pTarget == pTarget)
+			{
+				tweens[i].bPaused = true;
+			}
+		}
+	}
+}
+
+void CCTweenManager::resumeTarget(CCNode *pTarget)
+{
+	std::map<CCNode*, tTargetInfo>::iterator it = m_targets.find(pTarget);
+	if (it == m_targets.end() || ! it->second.bPaused)
+	{
+		return;
+	}
+	it->second.bPaused = false;
+
+	for (int p = 0; p < kCCTweenPropertyCount; ++p)
+	{
+		std::vector<tTween>& tweens = m_tweens[p];
+		for (unsigned int i = 0; i < tweens.size(); ++i)
+		{
+			if (tweens[i].pTarget == pTarget)
+			{
+				tweens[i].bPaused = false;
+			}
+		}
+	}
+}
+
+float CCTweenManager::ease(ccTweenEase eEase, float fParam, float time)
+{
+	return easeTime(eEase, defaultEaseParam(eEase, fParam), time);
+}
+
+void CCTweenManager::update(ccTime dt)
+{
+	for (int p = 0; p < kCCTweenPropertyCount; ++p)
+	{
+		updateProperty((ccTweenProperty)p, dt);
+	}
+
+	for (int p = 0; p < kCCTweenPropertyCount; ++p)
+	{
+		compact((ccTweenProperty)p);
+	}
+}
+
+void CCTweenManager::updateProperty(ccTweenProperty eProperty, ccTime dt)
+{
+	std::vector<tTween>& tweens = m_tweens[eProperty];
+	const unsigned int uCount = (unsigned int)tweens.size();
+	if (uCount == 0)
+	{
+		return;
+	}
+
+	if (m_times.size() < uCount)
+	{
+		m_times.resize(uCount);
+		m_values.resize(uCount * 3);
+	}
+
+	tTween *pTweens = &tweens[0];
+	float *pTimes = &m_times[0];
+	float *pValues = &m_values[0];
+	bool bEased = false;
+
+	// time, a negative value marks the tweens that are not updated this frame
+	for (unsigned int i = 0; i < uCount; ++i)
+	{
+		tTween& tween = pTweens[i];
+		if (tween.bPaused || tween.bRemoved)
+		{
+			pTimes[i] = -1;
+			continue;
+		}
+
+		if (tween.bFirstTick)
+		{
+			tween.bFirstTick = false;
+		}
+		else
+		{
+			tween.elapsed += dt;
+		}
+
+		float t = tween.elapsed / tween.duration;
+		pTimes[i] = t < 1 ? t : 1;
+		bEased |= tween.eEase != kCCTweenEaseLinear;
+	}
+
+	// curves
+	if (bEased)
+	{
+		for (unsigned int i = 0; i < uCount; ++i)
+		{
+			if (pTweens[i].eEase != kCCTweenEaseLinear && pTimes[i] >= 0)
+			{
+				pTimes[i] = easeTime(pTweens[i].eEase, pTweens[i].easeParam, pTimes[i]);
+			}
+		}
+	}
+
+	// values
+	const unsigned int uComponents = s_uComponents[eProperty];
+	for (unsigned int i = 0; i < uCount; ++i)
+	{
+		const tTween& tween = pTweens[i];
+		for (unsigned int c = 0; c < uComponents; ++c)
+		{
+			pValues[i * 3 + c] = tween.from[c] + tween.delta[c] * pTimes[i];
+		}
+	}
+
+	// write back, the setters may add tweens so don't keep pointers into the array
+	for (unsigned int i = 0; i < uCount; ++i)
+	{
+		if (m_times[i] < 0)
+		{
+			continue;
+		}
+
+		const float *v = &m_values[i * 3];
+		CCNode *pTarget = tweens[i].pTarget;
+		switch (eProperty)
+		{
+		case kCCTweenPosition:
+			pTarget->setPosition(ccp(v[0], v[1]));
+			break;
+		case kCCTweenScale:
+			pTarget->setScaleX(v[0]);
+			pTarget->setScaleY(v[1]);
+			break;
+		case kCCTweenRotation:
+			pTarget->setRotation(v[0]);
+			break;
+		case kCCTweenOpacity:
+			tweens[i].pRGBA->setOpacity((CCubyte)v[0]);
+			break;
+		case kCCTweenColor:
+			tweens[i].pRGBA->setColor(ccc3((CCubyte)v[0], (CCubyte)v[1], (CCubyte)v[2]));
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void CCTweenManager::compact(ccTweenProperty eProperty)
+{
+	std::vector<tTween>& tweens = m_tweens[eProperty];
+
+	// keep the order, a later tween on the same property wins as with actions
+	unsigned int uKept = 0;
+	unsigned int uCount = (unsigned int)tweens.size();
+	for (unsigned int i = 0; i < uCount; ++i)
+	{
+		tTween& tween = tweens[i];
+		bool bDone = ! tween.bRemoved && ! tween.bPaused && ! tween.bFirstTick && tween.elapsed >= tween.duration;
+		if (! tween.bRemoved && ! bDone)
+		{
+			if (uKept != i)
+			{
+				tweens[uKept] = tween;
+			}
+			++uKept;
+			continue;
+		}
+
+		if (bDone)
+		{
+			std::map<CCNode*, tTargetInfo>::iterator it = m_targets.find(tween.pTarget);
+			if (it != m_targets.end() && --it->second.uCount == 0)
+			{
+				m_targets.erase(it);
+			}
+		}
+
+		// may delete the node, which can't touch the tweens any more
+		CCNode *pTarget = tween.pTarget;
+		tween.pTarget = NULL;
+		tween.bRemoved = true;
+		pTarget->release();
+
+		// a release may have added tweens
+		uCount = (unsigned int)tweens.size();
+	}
+
+	tweens.resize(uKept);
+}
+
+}//namespace cocos2d
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "CCAtlasNode.h"
 #include "CCTextureAtlas.h"
 #include "CCDirector.h"
+#include "CCRenderQueue.h"
 
 namespace   cocos2d {
 
@@ -125,14 +126,14 @@ void CCAtlasNode::draw()
 	bool newBlend = m_tBlendFunc.src != CC_BLEND_SRC || m_tBlendFunc.dst != CC_BLEND_DST;
 	if(newBlend) 
 	{
-		CCD3DCLASS->D3DBlendFunc( m_tBlendFunc.src, m_tBlendFunc.dst );
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc( m_tBlendFunc.src, m_tBlendFunc.dst );
 	}
 
 	m_pTextureAtlas->drawNumberOfQuads(m_uQuadsToDraw, 0);
 
 	if( newBlend )
 	{
-		CCD3DCLASS->D3DBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
 	}
 
 }
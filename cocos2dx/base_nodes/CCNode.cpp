@@ -28,13 +28,17 @@ THE SOFTWARE.
 #include "CCNode.h"
 #include "CCPointExtension.h"
 #include "support/TransformUtils.h"
+#include "support/CCNodeTagIndex.h"
 #include "CCCamera.h"
 #include "effects/CCGrid.h"
 #include "CCDirector.h"
 #include "CCScheduler.h"
 #include "CCTouch.h"
 #include "CCActionManager.h"
+#include "CCTweenManager.h"
 #include "CCScriptSupport.h"
+#include "CCDrawingPrimitives.h"
+#include "CCRenderQueue.h"
 
 #if CC_COCOSNODE_RENDER_SUBPIXEL
 #define RENDER_IN_SUBPIXEL
@@ -44,6 +48,9 @@ THE SOFTWARE.
 
 namespace   cocos2d {
 
+static unsigned int s_uTagIndexThreshold = CC_NODE_TAG_INDEX_THRESHOLD;
+static unsigned int s_uTransformEpoch = 0;
+
 CCNode::CCNode(void)
 : m_nZOrder(0)
 , m_fVertexZ(0.0f)
@@ -60,6 +67,7 @@ CCNode::CCNode(void)
 , m_pCamera(NULL)
 , m_pGrid(NULL)
 , m_bIsVisible(true)
+, m_bIsOrderIndependent(false)
 , m_tAnchorPoint(CCPointZero)
 , m_tAnchorPointInPixels(CCPointZero)
 , m_tContentSize(CCSizeZero)
@@ -77,6 +85,10 @@ CCNode::CCNode(void)
 , m_bIsTransformGLDirty(true)
 #endif
 , m_nScriptHandler(0)
+, m_pTagIndex(NULL)
+, m_pIdlePool(NULL)
+, m_uTransformEpoch(0)
+, m_uSubtreeEpoch(0)
 {
     // nothing
 }
@@ -105,6 +117,8 @@ CCNode::~CCNode(void)
 	// children
 	CC_SAFE_RELEASE(m_pChildren);
 
+	CC_SAFE_DELETE(m_pTagIndex);
+
 }
 
 void CCNode::arrayMakeObjectsPerformSelector(CCArray* pArray, callbackFunc func)
@@ -132,6 +146,7 @@ void CCNode::setSkewX(float newSkewX)
 {
 	m_fSkewX = newSkewX;
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #if CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -147,6 +162,7 @@ void CCNode::setSkewY(float newSkewY)
 	m_fSkewY = newSkewY;
 
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #if CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -190,6 +206,7 @@ void CCNode::setRotation(float newRotation)
 {
 	m_fRotation = newRotation;
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -207,6 +224,7 @@ void CCNode::setScale(float scale)
 {
 	m_fScaleX = m_fScaleY = scale;
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -223,6 +241,7 @@ void CCNode::setScaleX(float newScaleX)
 {
 	m_fScaleX = newScaleX;
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -239,6 +258,7 @@ void CCNode::setScaleY(float newScaleY)
 {
 	m_fScaleY = newScaleY;
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -264,6 +284,7 @@ void CCNode::setPosition(const CCPoint& newPosition)
 	}
 
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -283,6 +304,7 @@ void CCNode::setPositionInPixels(const CCPoint& newPosition)
 	}
 
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 
 #if CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
@@ -385,6 +407,18 @@ void CCNode::setIsVisible(bool var)
 	m_bIsVisible = var;
 }
 
+/// isOrderIndependent getter
+bool CCNode::getIsOrderIndependent()
+{
+	return m_bIsOrderIndependent;
+}
+
+/// isOrderIndependent setter
+void CCNode::setIsOrderIndependent(bool var)
+{
+	m_bIsOrderIndependent = var;
+}
+
 
 /// anchorPoint getter
 const CCPoint& CCNode::getAnchorPoint()
@@ -399,6 +433,7 @@ void CCNode::setAnchorPoint(const CCPoint& point)
 		m_tAnchorPoint = point;
 		m_tAnchorPointInPixels = ccp( m_tContentSizeInPixels.width * m_tAnchorPoint.x, m_tContentSizeInPixels.height * m_tAnchorPoint.y );
 		m_bIsTransformDirty = m_bIsInverseDirty = true;
+		markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 		m_bIsTransformGLDirty = true;
 #endif
@@ -434,6 +469,7 @@ void CCNode::setContentSize(const CCSize& size)
 
 		m_tAnchorPointInPixels = ccp( m_tContentSizeInPixels.width * m_tAnchorPoint.x, m_tContentSizeInPixels.height * m_tAnchorPoint.y );
 		m_bIsTransformDirty = m_bIsInverseDirty = true;
+		markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 		m_bIsTransformGLDirty = true;
 #endif
@@ -457,6 +493,7 @@ void CCNode::setContentSizeInPixels(const CCSize& size)
 
 		m_tAnchorPointInPixels = ccp(m_tContentSizeInPixels.width * m_tAnchorPoint.x, m_tContentSizeInPixels.height * m_tAnchorPoint.y);
 		m_bIsTransformDirty = m_bIsInverseDirty = true;
+		markTransformChanged();
 
 #if CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 		m_bIsTransformGLDirty = true;
@@ -498,6 +535,7 @@ void CCNode::setIsRelativeAnchorPoint(bool newValue)
 {
 	m_bIsRelativeAnchorPoint = newValue;
 	m_bIsTransformDirty = m_bIsInverseDirty = true;
+	markTransformChanged();
 #ifdef CC_NODE_TRANSFORM_USING_AFFINE_MATRIX
 	m_bIsTransformGLDirty = true;
 #endif
@@ -512,6 +550,12 @@ int CCNode::getTag()
 /// tag setter
 void CCNode::setTag(int var)
 {
+	if (m_pParent && m_pParent->m_pTagIndex && m_nTag != var)
+	{
+		m_pParent->m_pTagIndex->remove(m_nTag);
+		m_pParent->m_pTagIndex->add(var, this);
+	}
+
 	m_nTag = var;
 }
 
@@ -578,6 +622,21 @@ CCNode* CCNode::getChildByTag(int aTag)
 {
 	CCAssert( aTag != kCCNodeTagInvalid, "Invalid tag");
 
+	if (m_pTagIndex)
+	{
+		CCNode *pNode = NULL;
+		if (! m_pTagIndex->lookup(aTag, pNode))
+		{
+			return NULL;
+		}
+
+		if (pNode)
+		{
+			return pNode;
+		}
+		// shared tag or not cached yet, scan for the first one
+	}
+
 	if(m_pChildren && m_pChildren->count() > 0)
 	{
         CCObject* child;
@@ -585,12 +644,28 @@ CCNode* CCNode::getChildByTag(int aTag)
         {
             CCNode* pNode = (CCNode*) child;
 			if(pNode && pNode->m_nTag == aTag)
+			{
+				if (m_pTagIndex)
+				{
+					m_pTagIndex->resolve(aTag, pNode);
+				}
 				return pNode;
+			}
 		}
 	}
 	return NULL;
 }
 
+void CCNode::setTagIndexThreshold(unsigned int uThreshold)
+{
+	s_uTagIndexThreshold = uThreshold;
+}
+
+unsigned int CCNode::getTagIndexThreshold(void)
+{
+	return s_uTagIndexThreshold;
+}
+
 /* "add" logic MUST only be on this method
 * If a class want's to extend the 'addChild' behaviour it only needs
 * to override this method
@@ -609,7 +684,24 @@ void CCNode::addChild(CCNode *child, int zOrder, int tag)
 
 	child->m_nTag = tag;
 
+	if (m_pTagIndex)
+	{
+		m_pTagIndex->add(tag, child);
+	}
+	else if (s_uTagIndexThreshold > 0 && m_pChildren->count() > s_uTagIndexThreshold)
+	{
+		m_pTagIndex = new CCNodeTagIndex();
+
+		CCObject* pObject;
+		CCARRAY_FOREACH(m_pChildren, pObject)
+		{
+			CCNode* pNode = (CCNode*) pObject;
+			m_pTagIndex->add(pNode->m_nTag, pNode);
+		}
+	}
+
 	child->setParent(this);
+	child->markTransformChanged();
 
 	if( m_bIsRunning )
 	{
@@ -694,12 +786,15 @@ void CCNode::removeAllChildrenWithCleanup(bool cleanup)
 				}
 				// set parent nil at the end
 				pNode->setParent(NULL);
+				pNode->markTransformChanged();
 			}
 		}
 		
 		m_pChildren->removeAllObjects();
+		markChildrenChanged();
 	}
-	
+
+	CC_SAFE_DELETE(m_pTagIndex);
 }
 
 void CCNode::detachChild(CCNode *child, bool doCleanup)
@@ -722,7 +817,14 @@ void CCNode::detachChild(CCNode *child, bool doCleanup)
 	// set parent nil at the end
 	child->setParent(NULL);
 
+	if (m_pTagIndex)
+	{
+		m_pTagIndex->remove(child->m_nTag);
+	}
+
 	m_pChildren->removeObject(child);
+	child->markTransformChanged();
+	markChildrenChanged();
 }
 
 
@@ -762,6 +864,7 @@ void CCNode::reorderChild(CCNode *child, int zOrder)
 
 	insertChild(child, zOrder);
 	child->release();
+	markChildrenChanged();
 }
 
  void CCNode::draw()
@@ -789,6 +892,11 @@ void CCNode::visit()
 
 	this->transform();
 
+	if (m_bIsOrderIndependent)
+	{
+		CCRenderQueue::sharedRenderQueue()->beginUnordered();
+	}
+
     CCNode* pNode = NULL;
     unsigned int i = 0;
 
@@ -813,6 +921,8 @@ void CCNode::visit()
 
 	// self draw
 	this->draw();
+	// the primitives it drew stay under its children
+	ccDrawFlush();
 
 	// draw children zOrder >= 0
     if (m_pChildren && m_pChildren->count() > 0)
@@ -828,6 +938,11 @@ void CCNode::visit()
 		}		
 	}
 
+	if (m_bIsOrderIndependent)
+	{
+		CCRenderQueue::sharedRenderQueue()->endUnordered();
+	}
+
  	if (m_pGrid && m_pGrid->isActive())
  	{
  		m_pGrid->afterDraw(this);
@@ -988,6 +1103,11 @@ CCAction * CCNode::runAction(CCAction* action)
 void CCNode::stopAllActions()
 {
 	CCActionManager::sharedManager()->removeAllActionsFromTarget(this);
+
+	if (CCTweenManager *pTweens = CCTweenManager::existingManager())
+	{
+		pTweens->removeAllTweensFromTarget(this);
+	}
 }
 
 void CCNode::stopAction(CCAction* action)
@@ -1060,12 +1180,22 @@ void CCNode::resumeSchedulerAndActions()
 {
 	CCScheduler::sharedScheduler()->resumeTarget(this);
 	CCActionManager::sharedManager()->resumeTarget(this);
+
+	if (CCTweenManager *pTweens = CCTweenManager::existingManager())
+	{
+		pTweens->resumeTarget(this);
+	}
 }
 
 void CCNode::pauseSchedulerAndActions()
 {
 	CCScheduler::sharedScheduler()->pauseTarget(this);
 	CCActionManager::sharedManager()->pauseTarget(this);
+
+	if (CCTweenManager *pTweens = CCTweenManager::existingManager())
+	{
+		pTweens->pauseTarget(this);
+	}
 }
 
 CCAffineTransform CCNode::nodeToParentTransform(void)
@@ -1133,6 +1263,40 @@ CCAffineTransform CCNode::nodeToWorldTransform()
 	return t;
 }
 
+unsigned int CCNode::getTransformEpoch(void)
+{
+	return s_uTransformEpoch;
+}
+
+unsigned int CCNode::getWorldTransformEpoch(void)
+{
+	// a sum changes whenever one of its terms does, even once the counter wrapped
+	unsigned int uEpoch = m_uSubtreeEpoch;
+	for (CCNode *pNode = m_pParent; pNode; pNode = pNode->m_pParent)
+	{
+		uEpoch += pNode->m_uTransformEpoch;
+	}
+	return uEpoch;
+}
+
+void CCNode::markTransformChanged(void)
+{
+	m_uTransformEpoch = ++s_uTransformEpoch;
+	for (CCNode *pNode = this; pNode; pNode = pNode->m_pParent)
+	{
+		pNode->m_uSubtreeEpoch = s_uTransformEpoch;
+	}
+}
+
+void CCNode::markChildrenChanged(void)
+{
+	++s_uTransformEpoch;
+	for (CCNode *pNode = this; pNode; pNode = pNode->m_pParent)
+	{
+		pNode->m_uSubtreeEpoch = s_uTransformEpoch;
+	}
+}
+
 CCAffineTransform CCNode::worldToNodeTransform(void)
 {
 	return CCAffineTransformInvert(this->nodeToWorldTransform());
@@ -0,0 +1,349 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCNodePool.h"
+#include "CCCamera.h"
+#include "CCProtocols.h"
+#include "CCSpriteFrame.h"
+#include "CCTextureCache.h"
+#include "ccMacros.h"
+#include <algorithm>
+
+namespace cocos2d {
+
+////////////////////////////////////////////////////////
+//
+// CCNodePool
+//
+////////////////////////////////////////////////////////
+CCNodePool::CCNodePool(void)
+: m_uMaxSize(0)
+, m_bPrototypeKnown(false)
+, m_tAnchorPoint(CCPointZero)
+, m_bIsRelativeAnchorPoint(true)
+, m_tColor(ccWHITE)
+, m_cOpacity(255)
+{
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+CCNodePool::~CCNodePool(void)
+{
+	CCLOGINFO("cocos2d: deallocing CCNodePool.");
+
+	// the nodes in use stay alive as long as their parents retain them
+	for (unsigned int i = 0; i < m_nodes.size(); ++i)
+	{
+		m_nodes[i]->m_pIdlePool = NULL;
+		m_nodes[i]->release();
+	}
+}
+
+bool CCNodePool::initWithCapacity(unsigned int uPrefill, unsigned int uMaxSize)
+{
+	CCAssert(uMaxSize == 0 || uPrefill <= uMaxSize, "CCNodePool: can't prefill more nodes than the pool holds");
+
+	m_uMaxSize = uMaxSize;
+
+	// acquire() and recycle() must not allocate once the pool is full
+	unsigned int uReserve = uMaxSize ? uMaxSize : uPrefill;
+	m_nodes.reserve(uReserve);
+	m_idleNodes.reserve(uReserve);
+
+	prefill(uPrefill);
+	return m_idleNodes.size() == uPrefill;
+}
+
+CCNode* CCNodePool::acquire(void)
+{
+	CCNode *pNode = NULL;
+	if (! m_idleNodes.empty())
+	{
+		pNode = m_idleNodes.back();
+		m_idleNodes.pop_back();
+		pNode->m_pIdlePool = NULL;
+		++m_tStats.uHits;
+	}
+	else if (isFull())
+	{
+		++m_tStats.uRefusals;
+		return NULL;
+	}
+	else
+	{
+		pNode = newNode();
+		if (! pNode)
+		{
+			return NULL;
+		}
+		++m_tStats.uMisses;
+	}
+
+	++m_tStats.uInUse;
+	if (m_tStats.uInUse > m_tStats.uPeakInUse)
+	{
+		m_tStats.uPeakInUse = m_tStats.uInUse;
+	}
+	return pNode;
+}
+
+void CCNodePool::recycle(CCNode *pNode)
+{
+	CCAssert(pNode != NULL, "CCNodePool: recycle a NULL node");
+	CCAssert(pNode->m_pIdlePool == NULL, "CCNodePool: the node was already recycled");
+	CCAssert(m_tStats.uInUse > 0, "CCNodePool: the node wasn't acquired from this pool");
+
+	if (pNode->getParent())
+	{
+		pNode->removeFromParentAndCleanup(true);
+	}
+	else
+	{
+		pNode->cleanup();
+	}
+	--m_tStats.uInUse;
+
+	// the pool was made smaller while the node was in use
+	if (m_uMaxSize && m_nodes.size() > m_uMaxSize)
+	{
+		m_nodes.erase(std::find(m_nodes.begin(), m_nodes.end(), pNode));
+		pNode->release();
+		return;
+	}
+
+	resetNode(pNode);
+	pNode->m_pIdlePool = this;
+	m_idleNodes.push_back(pNode);
+}
+
+void CCNodePool::prefill(unsigned int uCount)
+{
+	while (m_idleNodes.size() < uCount && ! isFull())
+	{
+		CCNode *pNode = newNode();
+		if (! pNode)
+		{
+			break;
+		}
+		pNode->m_pIdlePool = this;
+		m_idleNodes.push_back(pNode);
+	}
+}
+
+void CCNodePool::removeIdleNodes(void)
+{
+	for (unsigned int i = 0; i < m_idleNodes.size(); ++i)
+	{
+		CCNode *pNode = m_idleNodes[i];
+		m_nodes.erase(std::find(m_nodes.begin(), m_nodes.end(), pNode));
+		pNode->m_pIdlePool = NULL;
+		pNode->release();
+	}
+	m_idleNodes.clear();
+}
+
+void CCNodePool::setMaxSize(unsigned int uMaxSize)
+{
+	m_uMaxSize = uMaxSize;
+
+	// the nodes in use are released when they are recycled
+	while (m_uMaxSize && m_nodes.size() > m_uMaxSize && ! m_idleNodes.empty())
+	{
+		CCNode *pNode = m_idleNodes.back();
+		m_idleNodes.pop_back();
+		m_nodes.erase(std::find(m_nodes.begin(), m_nodes.end(), pNode));
+		pNode->m_pIdlePool = NULL;
+		pNode->release();
+	}
+
+	if (m_uMaxSize)
+	{
+		m_nodes.reserve(m_uMaxSize);
+		m_idleNodes.reserve(m_uMaxSize);
+	}
+}
+
+void CCNodePool::resetStats(void)
+{
+	unsigned int uInUse = m_tStats.uInUse;
+	memset(&m_tStats, 0, sizeof(m_tStats));
+	m_tStats.uInUse = uInUse;
+	m_tStats.uPeakInUse = uInUse;
+}
+
+void CCNodePool::resetNode(CCNode *pNode)
+{
+	pNode->setPosition(CCPointZero);
+	pNode->setRotation(0);
+	pNode->setScale(1);
+	pNode->setSkewX(0);
+	pNode->setSkewY(0);
+	pNode->setVertexZ(0);
+	pNode->setAnchorPoint(m_tAnchorPoint);
+	pNode->setIsRelativeAnchorPoint(m_bIsRelativeAnchorPoint);
+	pNode->setIsVisible(true);
+	pNode->setTag(kCCNodeTagInvalid);
+	pNode->setUserData(NULL);
+	pNode->setGrid(NULL);
+
+	// getCamera() creates the camera, a new node has none
+	CC_SAFE_RELEASE_NULL(pNode->m_pCamera);
+
+	CCRGBAProtocol *pRGBAProtocol = dynamic_cast<CCRGBAProtocol*>(pNode);
+	if (pRGBAProtocol)
+	{
+		pRGBAProtocol->setColor(m_tColor);
+		pRGBAProtocol->setOpacity(m_cOpacity);
+	}
+}
+
+CCNode* CCNodePool::newNode(void)
+{
+	CCNode *pNode = createNode();
+	if (! pNode)
+	{
+		return NULL;
+	}
+
+	if (! m_bPrototypeKnown)
+	{
+		m_bPrototypeKnown = true;
+		m_tAnchorPoint = pNode->getAnchorPoint();
+		m_bIsRelativeAnchorPoint = pNode->getIsRelativeAnchorPoint();
+
+		CCRGBAProtocol *pRGBAProtocol = dynamic_cast<CCRGBAProtocol*>(pNode);
+		if (pRGBAProtocol)
+		{
+			m_tColor = pRGBAProtocol->getColor();
+			m_cOpacity = pRGBAProtocol->getOpacity();
+		}
+	}
+
+	m_nodes.push_back(pNode);
+	++m_tStats.uCreated;
+	return pNode;
+}
+
+bool CCNodePool::isFull(void)
+{
+	return m_uMaxSize && m_nodes.size() >= m_uMaxSize;
+}
+
+////////////////////////////////////////////////////////
+//
+// CCSpritePool
+//
+////////////////////////////////////////////////////////
+CCSpritePool::CCSpritePool(void)
+: m_pSpriteFrame(NULL)
+{
+	m_tBlendFunc.src = CC_BLEND_SRC;
+	m_tBlendFunc.dst = CC_BLEND_DST;
+}
+
+CCSpritePool::~CCSpritePool(void)
+{
+	CC_SAFE_RELEASE(m_pSpriteFrame);
+}
+
+CCSpritePool* CCSpritePool::poolWithFile(const char *pszFileName, unsigned int uPrefill, unsigned int uMaxSize)
+{
+	CCSpritePool *pPool = new CCSpritePool();
+	if (pPool && pPool->initWithFile(pszFileName, uPrefill, uMaxSize))
+	{
+		pPool->autorelease();
+		return pPool;
+	}
+	CC_SAFE_DELETE(pPool);
+	return NULL;
+}
+
+CCSpritePool* CCSpritePool::poolWithSpriteFrame(CCSpriteFrame *pSpriteFrame, unsigned int uPrefill, unsigned int uMaxSize)
+{
+	CCSpritePool *pPool = new CCSpritePool();
+	if (pPool && pPool->initWithSpriteFrame(pSpriteFrame, uPrefill, uMaxSize))
+	{
+		pPool->autorelease();
+		return pPool;
+	}
+	CC_SAFE_DELETE(pPool);
+	return NULL;
+}
+
+bool CCSpritePool::initWithFile(const char *pszFileName, unsigned int uPrefill, unsigned int uMaxSize)
+{
+	CCAssert(pszFileName != NULL, "");
+
+	CCTexture2D *pTexture = CCTextureCache::sharedTextureCache()->addImage(pszFileName);
+	if (! pTexture)
+	{
+		return false;
+	}
+
+	CCRect rect = CCRectZero;
+	rect.size = pTexture->getContentSize();
+	return initWithSpriteFrame(CCSpriteFrame::frameWithTexture(pTexture, rect), uPrefill, uMaxSize);
+}
+
+bool CCSpritePool::initWithSpriteFrame(CCSpriteFrame *pSpriteFrame, unsigned int uPrefill, unsigned int uMaxSize)
+{
+	CCAssert(pSpriteFrame != NULL, "");
+
+	pSpriteFrame->retain();
+	CC_SAFE_RELEASE(m_pSpriteFrame);
+	m_pSpriteFrame = pSpriteFrame;
+
+	return initWithCapacity(uPrefill, uMaxSize);
+}
+
+CCNode* CCSpritePool::createNode(void)
+{
+	CCSprite *pSprite = new CCSprite();
+	if (! pSprite->initWithSpriteFrame(m_pSpriteFrame))
+	{
+		pSprite->release();
+		return NULL;
+	}
+
+	// what init picked for the texture, the same for every sprite of the pool
+	m_tBlendFunc = pSprite->getBlendFunc();
+	return pSprite;
+}
+
+void CCSpritePool::resetNode(CCNode *pNode)
+{
+	CCSprite *pSprite = (CCSprite*)pNode;
+
+	if (! pSprite->isFrameDisplayed(m_pSpriteFrame))
+	{
+		pSprite->setDisplayFrame(m_pSpriteFrame);
+	}
+	pSprite->setFlipX(false);
+	pSprite->setFlipY(false);
+	pSprite->setBlendFunc(m_tBlendFunc);
+
+	CCNodePool::resetNode(pNode);
+}
+
+}//namespace cocos2d
@@ -30,52 +30,64 @@ namespace cocos2d
 CCPoolManager	g_PoolManager;
 
 CCAutoreleasePool::CCAutoreleasePool(void)
+: m_uCount(0)
 {
-	m_pManagedObjectArray = new CCMutableArray<CCObject*>();
 }
 
 CCAutoreleasePool::~CCAutoreleasePool(void)
 {
-	CC_SAFE_DELETE(m_pManagedObjectArray);
+	clear();
+
+	CCPoolManager::getInstance()->m_tStats.uCapacity -= capacity();
+	for (unsigned int i = 0; i < m_chunks.size(); ++i)
+	{
+		delete [] m_chunks[i];
+	}
+	m_chunks.clear();
 }
 
 void CCAutoreleasePool::addObject(CCObject* pObject)
 {
-	m_pManagedObjectArray->addObject(pObject);
+	CCAssert(pObject->m_uReference > 0, "reference count should greater than 0");
 
-	CCAssert(pObject->m_uReference > 1, "reference count should greager than 1");
+	if (m_uCount == capacity())
+	{
+		m_chunks.push_back(new CCObject*[kChunkSize]);
+		CCPoolManager::getInstance()->m_tStats.uCapacity += kChunkSize;
+	}
 
-	pObject->release(); // no ref count, in this case autorelease pool added.
+	// the pool takes over the reference of the caller, no retain here
+	pObject->m_uAutoreleasePoolIndex = m_uCount;
+	*slotAtIndex(m_uCount++) = pObject;
 }
 
-void CCAutoreleasePool::removeObject(CCObject* pObject)
+bool CCAutoreleasePool::removeObject(CCObject* pObject)
 {
-	m_pManagedObjectArray->removeObject(pObject, false);
+	unsigned int uIndex = pObject->m_uAutoreleasePoolIndex;
+	if (uIndex >= m_uCount || *slotAtIndex(uIndex) != pObject)
+	{
+		return false;
+	}
+
+	// leave a hole, clear() skips it
+	*slotAtIndex(uIndex) = NULL;
+	return true;
 }
 
 void CCAutoreleasePool::clear()
 {
-	if(m_pManagedObjectArray->count() > 0)
+	// newest first; objects autoreleased by a destructor meanwhile take the freed slots and go too
+	while (m_uCount > 0)
 	{
-		//CCAutoreleasePool* pReleasePool;
-#ifdef _DEBUG
-		int nIndex = m_pManagedObjectArray->count() - 1;
-#endif
-		CCMutableArray<CCObject*>::CCMutableArrayRevIterator it;
-		for(it = m_pManagedObjectArray->rbegin(); it != m_pManagedObjectArray->rend(); ++it)
-		{
-			if(!*it)
-				break;
+		CCObject **pSlot = slotAtIndex(--m_uCount);
+		CCObject *pObject = *pSlot;
+		*pSlot = NULL;
 
-			(*it)->m_bManaged = false;
-			//(*it)->release();
-			//delete (*it);
-#ifdef _DEBUG
-			nIndex--;
-#endif
+		if (pObject)
+		{
+			pObject->m_bManaged = false;
+			pObject->release();
 		}
-
-		m_pManagedObjectArray->removeAllObjects();
 	}
 }
 
@@ -95,6 +107,7 @@ CCPoolManager::CCPoolManager()
 {
 	m_pReleasePoolStack = new CCMutableArray<CCAutoreleasePool*>();	
         m_pCurReleasePool = 0;
+	memset(&m_tStats, 0, sizeof(m_tStats));
 }
 
 CCPoolManager::~CCPoolManager()
@@ -144,7 +157,23 @@ void CCPoolManager::pop()
 
  	int nCount = m_pReleasePoolStack->count();
 
+	if (m_pCurReleasePool->count() > m_tStats.uPeakPoolSize)
+	{
+		m_tStats.uPeakPoolSize = m_pCurReleasePool->count();
+	}
+
 	m_pCurReleasePool->clear();
+
+	// the bottom pool is popped once per frame by the director
+	if (nCount == 1)
+	{
+		m_tStats.uObjectsLastFrame = m_tStats.uObjectsThisFrame;
+		if (m_tStats.uObjectsThisFrame > m_tStats.uPeakObjectsPerFrame)
+		{
+			m_tStats.uPeakObjectsPerFrame = m_tStats.uObjectsThisFrame;
+		}
+		m_tStats.uObjectsThisFrame = 0;
+	}
  
   	if(nCount > 1)
   	{
@@ -165,12 +194,21 @@ void CCPoolManager::removeObject(CCObject* pObject)
 {
 	CCAssert(m_pCurReleasePool, "current auto release pool should not be null");
 
-	m_pCurReleasePool->removeObject(pObject);
+	// usually found in the current pool, but the object may have been autoreleased before a push()
+	CCMutableArray<CCAutoreleasePool*>::CCMutableArrayRevIterator it;
+	for (it = m_pReleasePoolStack->rbegin(); it != m_pReleasePoolStack->rend(); ++it)
+	{
+		if ((*it)->removeObject(pObject))
+		{
+			break;
+		}
+	}
 }
 
 void CCPoolManager::addObject(CCObject* pObject)
 {
 	getCurReleasePool()->addObject(pObject);
+	++m_tStats.uObjectsThisFrame;
 }
 
 
@@ -47,6 +47,7 @@ CCObject::CCObject(void)
 	// when the object is created, the refrence count of it is 1
 	m_uReference = 1;
 	m_bManaged = false;
+	m_uAutoreleasePoolIndex = 0;
 }
 
 CCObject::~CCObject(void)
@@ -25,14 +25,20 @@ THE SOFTWARE.
 #include "CCGrabber.h"
 #include "ccMacros.h"
 #include "CCTexture2D.h"
+#include "CCRenderTargetPool.h"
 #include "platform/platform.h"
 #include "CCDirector.h"
+#include "CCDrawingPrimitives.h"
+#include "CCRenderQueue.h"
 
 namespace cocos2d
 {
 	CCGrabber::CCGrabber(void)
 		: m_fbo(0)
 		, m_oldFBO(0)
+		, m_renderTargetView(NULL)
+		, m_depthStencilView(NULL)
+		, m_depthStencil(NULL)
 	{
 
 	}
@@ -41,10 +47,25 @@ namespace cocos2d
 	{
 		Initialize(CCDirector::sharedDirector()->getOpenGLView()->GetDevice(), pTexture);
 	}
+
+	void CCGrabber::grab(CCRenderTarget *pTarget)
+	{
+		CCAssert(pTarget->getDepthStencilView(), "CCGrabber needs a kCCRenderTargetUsageColorDepth target");
+
+		// the target keeps its own references, the ones taken here are dropped in the destructor
+		m_renderTargetView = pTarget->getRenderTargetView();
+		m_renderTargetView->AddRef();
+		m_depthStencilView = pTarget->getDepthStencilView();
+		m_depthStencilView->AddRef();
+	}
 	
 	void CCGrabber::beforeRender(CCTexture2D *pTexture)
 	{
+		// the draws queued so far go to the previous target, and binding the texture
+		// as the target takes it off the pixel shader
+		CCRenderQueue::sharedRenderQueue()->flush();
 		CCID3D11DeviceContext->OMSetRenderTargets(1, &m_renderTargetView, m_depthStencilView);
+		CCRenderQueue::sharedRenderQueue()->invalidateState();
 		CCD3DCLASS->D3DClearColor(0.0f,0.0f,0.0f,1.0f);
 		CCD3DCLASS->clearRender(m_renderTargetView);
 		CCID3D11DeviceContext->ClearDepthStencilView(m_depthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
@@ -52,6 +73,10 @@ namespace cocos2d
 
 	void CCGrabber::afterRender(cocos2d::CCTexture2D *pTexture)
 	{
+		// the primitives drawn since beforeRender() go to the grabbed texture
+		ccDrawFlush();
+		CCRenderQueue::sharedRenderQueue()->flush();
+
 		CCEGLView* eglView = CCDirector::sharedDirector()->getOpenGLView();
 		eglView->SetBackBufferRenderTarget();
 	}
@@ -69,7 +94,7 @@ namespace cocos2d
 		}
 		if (m_depthStencilView) {
 			m_depthStencilView->Release();
-			m_renderTargetView = 0;
+			m_depthStencilView = 0;
 		}
 		CCLOGINFO("cocos2d: deallocing %p", this);
 	}
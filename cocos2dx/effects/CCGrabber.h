@@ -32,6 +32,7 @@ THE SOFTWARE.
 namespace cocos2d 
 {
 	class CCTexture2D;
+	class CCRenderTarget;
 
 	/** FBO class that grabs the the contents of the screen */
 	class CCGrabber : public CCObject
@@ -41,6 +42,8 @@ namespace cocos2d
 		~CCGrabber(void);
 
 		void grab(CCTexture2D *pTexture);
+		/** renders into the views of a pooled target instead of creating new ones */
+		void grab(CCRenderTarget *pTarget);
 		void beforeRender(CCTexture2D *pTexture);
 		void afterRender(CCTexture2D *pTexture);
 
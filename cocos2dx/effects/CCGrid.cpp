@@ -26,12 +26,15 @@ THE SOFTWARE.
 #include "effects/CCGrid.h"
 #include "CCDirector.h"
 #include "effects/CCGrabber.h"
+#include "CCRenderTargetPool.h"
 #include "support/ccUtils.h"
 #include "CCGL.h"
 #include "CCPointExtension.h"
 #include "CCFileUtils.h"
 #include "DirectXHelper.h"
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace std;
 using namespace DirectX;
@@ -40,6 +43,27 @@ namespace cocos2d
 {
 	// implementation of CCGridBase
 
+	CCGridBase::CCGridBase(void)
+		: m_bActive(false)
+		, m_nReuseGrid(0)
+		, m_pTexture(NULL)
+		, m_pGrabber(NULL)
+		, m_pRenderTarget(NULL)
+		, m_bIsTextureFlipped(false)
+		, m_texCoordBuffer(NULL)
+		, m_indexBuffer(NULL)
+		, m_indexCount(0)
+		, m_vertexCount(0)
+		, m_pProgram(NULL)
+		, m_pTexCoordinates(NULL)
+		, m_pVertices(NULL)
+		, m_pOriginalVertices(NULL)
+		, m_pIndices(NULL)
+		, m_pOriginalSoA(NULL)
+		, m_uSoAStride(0)
+	{
+	}
+
 	CCGridBase* CCGridBase::gridWithSize(const ccGridSize& gridSize)
 	{
 		CCGridBase *pGridBase = new CCGridBase();
@@ -99,7 +123,14 @@ namespace cocos2d
 		m_pGrabber = new CCGrabber();
 		if (m_pGrabber)
 		{
-			m_pGrabber->grab(m_pTexture);
+			if (m_pRenderTarget && m_pRenderTarget->getTexture() == m_pTexture)
+			{
+				m_pGrabber->grab(m_pRenderTarget);
+			}
+			else
+			{
+				m_pGrabber->grab(m_pTexture);
+			}
 		}
 		else
 		{
@@ -125,31 +156,15 @@ namespace cocos2d
 		// we only use rgba8888
 		CCTexture2DPixelFormat format = kCCTexture2DPixelFormat_RGBA8888;
 
-		void *data = calloc((int)(POTWide * POTHigh * 4), 1);
-		if (! data)
-		{
-			CCLOG("cocos2d: CCGrid: not enough memory.");
-			this->release();
-			return false;
-		}
-
-		CCTexture2D *pTexture = new CCTexture2D();
-		pTexture->initWithData(data, format, POTWide, POTHigh, m_winSize);
-
-		free(data);
-
-		if (! pTexture)
+		// grids come and go with every grid action, so the full screen target is pooled
+		m_pRenderTarget = CCRenderTargetPool::sharedRenderTargetPool()->acquire(POTWide, POTHigh, format, kCCRenderTargetUsageColorDepth);
+		if (! m_pRenderTarget)
 		{
 			CCLOG("cocos2d: CCGrid: error creating texture");
-			delete this;
 			return false;
 		}
 
-		initWithSize(gridSize, pTexture, false);
-
-		pTexture->release();
-
-		return true;
+		return initWithSize(gridSize, m_pRenderTarget->getTexture(), false);
 	}
 
 	CCGridBase::~CCGridBase(void)
@@ -159,18 +174,21 @@ namespace cocos2d
 		setActive(false);
 		CC_SAFE_RELEASE(m_pTexture);
 		CC_SAFE_RELEASE(m_pGrabber);
+		if (m_pRenderTarget)
+		{
+			CCRenderTargetPool::sharedRenderTargetPool()->recycle(m_pRenderTarget);
+			m_pRenderTarget = NULL;
+		}
 
 		CC_SAFE_FREE(m_pTexCoordinates);
 		CC_SAFE_FREE(m_pVertices);
 		CC_SAFE_FREE(m_pIndices);
 		CC_SAFE_FREE(m_pOriginalVertices);
+		CC_SAFE_FREE(m_pOriginalSoA);
 
-		CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
+		CC_SAFE_RELEASE_NULL_DX(m_texCoordBuffer);
 		CC_SAFE_RELEASE_NULL_DX(m_indexBuffer);
-		CC_SAFE_RELEASE_NULL_DX(m_matrixBuffer);
-		CC_SAFE_RELEASE_NULL_DX(m_layout);
-		CC_SAFE_RELEASE_NULL_DX(m_pixelShader);
-		CC_SAFE_RELEASE_NULL_DX(m_vertexShader);
+		CC_SAFE_RELEASE_NULL(m_pProgram);
 	}
 
 	// properties
@@ -306,183 +324,110 @@ namespace cocos2d
 		CCAssert(0, "");
 	}
 	
-	void CCGridBase::initVertexBuffer()
+	void CCGridBase::getDeformVertices(tGridVertices *psVertices)
 	{
-		CCAssert(0, "");
+		psVertices->x = m_pOriginalSoA;
+		psVertices->y = m_pOriginalSoA + m_uSoAStride;
+		psVertices->z = m_pOriginalSoA + m_uSoAStride * 2;
+		psVertices->count = m_vertexCount;
+		psVertices->out = (float*)m_pVertices;
 	}
 
-	void CCGridBase::RenderVertexBuffer()
-	{
-		CCAssert(0, "");
-	}
-	
-	void CCGrid3D::initVertexBuffer()
+	void CCGridBase::updateOriginalSoA(void)
 	{
-		m_indexCount = m_sGridSize.x * m_sGridSize.y * 6;
-		unsigned long* indices;
-		indices = new unsigned long[m_indexCount];
-		if(!indices)
+		unsigned int count = m_vertexCount;
+		unsigned int stride = (count + 3) & ~3;
+		if (stride != m_uSoAStride)
 		{
-			return ;
+			CC_SAFE_FREE(m_pOriginalSoA);
+			m_pOriginalSoA = (CCfloat*)malloc(stride * 3 * sizeof(CCfloat));
+			m_uSoAStride = stride;
 		}
-		memset(indices, 0, (sizeof(unsigned long) * m_indexCount));
 
-		m_vertexCount = (m_sGridSize.x+1) * (m_sGridSize.y+1);
-		
-		float *vertArray = (float*)m_pVertices;
-		float *texArray = (float*)m_pTexCoordinates;
-		CCushort *idxArray = m_pIndices;
-
-		for (int x = 0; x < m_sGridSize.x; ++x)
+		if (! m_pOriginalSoA || count == 0)
 		{
-			for (int y = 0; y < m_sGridSize.y; ++y)
-			{
-				int idx = (y * m_sGridSize.x) + x;
-
-				unsigned long tempidx[6] = {idxArray[6*idx], idxArray[6*idx+1], idxArray[6*idx+2], idxArray[6*idx+3], idxArray[6*idx+4], idxArray[6*idx+5]};
-				memcpy(&indices[6*idx], tempidx, 6*sizeof(unsigned long));
-			}
+			return;
 		}
 
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		ZeroMemory( &vertexBufferDesc, sizeof(vertexBufferDesc) );
-
-		// Set up the description of the static vertex buffer.
-		vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-		vertexBufferDesc.ByteWidth = sizeof(VertexType)*m_vertexCount;
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		// Now create the vertex buffer.
-		if(FAILED(CCID3D11Device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer)))
+		// the padding repeats the last vertex, the kernels read whole groups of 4
+		const CCfloat *vertArray = (const CCfloat*)m_pOriginalVertices;
+		for (unsigned int i = 0; i < stride; ++i)
 		{
-			delete[] indices;
-			return ;
+			const CCfloat *v = &vertArray[(i < count ? i : count - 1) * 3];
+			m_pOriginalSoA[i] = v[0];
+			m_pOriginalSoA[stride + i] = v[1];
+			m_pOriginalSoA[stride * 2 + i] = v[2];
 		}
-
-		D3D11_BUFFER_DESC indexBufferDesc;
-		D3D11_SUBRESOURCE_DATA indexData;
-		ZeroMemory( &indexBufferDesc, sizeof(indexBufferDesc) );
-
-		indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-		indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-
-		indexData.pSysMem = indices;
-		CCID3D11Device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
-
-		CC_SAFE_DELETE_ARRAY(indices);
 	}
 
-	void CCGrid3D::RenderVertexBuffer()
+	void CCGridBase::initVertexBuffer()
 	{
-		m_vertexCount = (m_sGridSize.x+1) * (m_sGridSize.y+1);
-		VertexType* vertices = new VertexType[m_vertexCount];
+		CC_SAFE_RELEASE_NULL_DX(m_texCoordBuffer);
+		CC_SAFE_RELEASE_NULL_DX(m_indexBuffer);
+
+		D3D11_BUFFER_DESC bufferDesc;
+		D3D11_SUBRESOURCE_DATA bufferData;
+		ZeroMemory( &bufferDesc, sizeof(bufferDesc) );
+		ZeroMemory( &bufferData, sizeof(bufferData) );
 
-		if ( !vertices )
+		// texture coordinates and indices only change with the grid,
+		// the positions are written to the geometry ring every frame
+		bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		bufferDesc.ByteWidth = sizeof(CCfloat) * 2 * m_vertexCount;
+		bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bufferData.pSysMem = m_pTexCoordinates;
+		if(FAILED(CCID3D11Device->CreateBuffer(&bufferDesc, &bufferData, &m_texCoordBuffer)))
 		{
 			return ;
 		}
 
-		memset(vertices, 0, (sizeof(VertexType) * m_vertexCount));
-		float *vertArray = (float*)m_pVertices;
-		float *texArray = (float*)m_pTexCoordinates;
+		bufferDesc.ByteWidth = sizeof(CCushort) * m_indexCount;
+		bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		bufferData.pSysMem = m_pIndices;
+		CCID3D11Device->CreateBuffer(&bufferDesc, &bufferData, &m_indexBuffer);
+	}
 
-		for (int x = 0; x < m_sGridSize.x+1; ++x)
+	void CCGridBase::RenderVertexBuffer()
+	{
+		if (! m_texCoordBuffer || ! m_indexBuffer)
 		{
-			for (int y = 0; y < m_sGridSize.y+1; ++y)
-			{
-				int idx = (y * (m_sGridSize.x+1)) + x;
-
-				vertices[idx].position = XMFLOAT3(vertArray[3*idx], vertArray[3*idx+1], vertArray[3*idx+2]);
-				vertices[idx].texture = XMFLOAT2(texArray[2*idx], texArray[2*idx+1]);
-			}
+			return;
 		}
 
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		VertexType* verticesPtr;
-
-		// Lock the vertex buffer so it can be written to.
-		if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+		// the actions deform m_pVertices in place, it only has to be copied
+		if (! CCDynamicBuffers::sharedDynamicBuffers()->setVertices(0, m_pVertices, sizeof(ccVertex3F), m_vertexCount))
 		{
 			return ;
 		}
-		// Get a pointer to the data in the vertex buffer.
-		verticesPtr = (VertexType*)mappedResource.pData;
-		// Copy the data into the vertex buffer.
-		memcpy(verticesPtr, vertices, (sizeof(VertexType) * m_vertexCount));
-		// Unlock the vertex buffer.
-		CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
-
-		CC_SAFE_DELETE_ARRAY(vertices);
-
-		////////////////////////
-		unsigned int stride;
-		unsigned int offset;
-		// Set vertex buffer stride and offset.
-		stride = sizeof(VertexType); 
-		offset = 0;
 
-		// Set the vertex buffer to active in the input assembler so it can be rendered.
-		CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+		CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
+		pQueue->setVertexBuffer(1, m_texCoordBuffer, sizeof(CCfloat) * 2, 0);
 
-		CCID3D11DeviceContext->IASetIndexBuffer( m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+		pQueue->setIndexBuffer(m_indexBuffer);
 
 		// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-		return;
+		pQueue->setTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	}
 
 	bool CCGridBase::InitializeShader()
 	{
-		HRESULT result;
-		ID3D10Blob* errorMessage;
-		D3D11_BUFFER_DESC matrixBufferDesc;
-		// Initialize the pointers this function will use to null.
-		errorMessage = 0;
-
-		BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 		D3D11_INPUT_ELEMENT_DESC layoutDesc[] = 
 		{
 			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 			//{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 		};
 
-		loader->LoadShader(
+		m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 			L"CCGridVertexShader.cso",
 			layoutDesc,
 			ARRAYSIZE(layoutDesc),
-			&m_vertexShader,
-			&m_layout
+			L"CCGridPixelShader.cso"
 			);
+		CC_SAFE_RETAIN(m_pProgram);
 
-		loader->LoadShader(
-			L"CCGridPixelShader.cso",
-			&m_pixelShader
-			);
-
-		// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-		matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-		matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-		matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		matrixBufferDesc.MiscFlags = 0;
-		matrixBufferDesc.StructureByteStride = 0;
-
-		// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-		result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-		if(FAILED(result))
-		{
-			return false;
-		}
-
-		return true;
+		// the matrices go to the constant ring of CCDynamicBuffers
+		return m_pProgram != NULL;
 	}
 
 	void CCGridBase::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
@@ -521,51 +466,34 @@ namespace cocos2d
 
 	bool CCGridBase::SetShaderParameters(XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
 	{
-		HRESULT result;
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		MatrixBufferType* dataPtr;
+		MatrixBufferType matrices;
 		unsigned int bufferNumber;
 
 		// Transpose the matrices to prepare them for the shader.
-		viewMatrix = XMMatrixTranspose(viewMatrix);
-		projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-		// Lock the constant buffer so it can be written to.
-		result = CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-		if(FAILED(result))
-		{
-			return false;
-		}
-
-		// Get a pointer to the data in the constant buffer.
-		dataPtr = (MatrixBufferType*)mappedResource.pData;
-
-		// Copy the matrices into the constant buffer.
-		dataPtr->view = viewMatrix;
-		dataPtr->projection = projectionMatrix;
-
-		// Unlock the constant buffer.
-		CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+		matrices.view = XMMatrixTranspose(viewMatrix);
+		matrices.projection = XMMatrixTranspose(projectionMatrix);
 
 		// Set the position of the constant buffer in the vertex shader.
 		bufferNumber = 0;
 
-		// Now set the constant buffer in the vertex shader with the updated values.
-		CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
+		// Copy the matrices to the constant ring and bind their range.
+		if(!CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices)))
+		{
+			return false;
+		}
 
 		// Set shader texture resource in the pixel shader.
-		CCID3D11DeviceContext->PSSetShaderResources(0, 1, &texture);
+		CCRenderQueue::sharedRenderQueue()->setTexture(texture);
 
 		return true;
 	}
 
 	void CCGridBase::RenderShader()
 	{
-		CCID3D11DeviceContext->IASetInputLayout(m_layout);
-		CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-		CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
-		CCID3D11DeviceContext->PSSetSamplers(0, 1, m_pTexture->GetSamplerState());
-		CCID3D11DeviceContext->DrawIndexed( m_indexCount, 0, 0 );
+		CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
+		pQueue->setProgram(m_pProgram);
+		pQueue->setSampler(*m_pTexture->GetSamplerState());
+		pQueue->drawIndexed( m_indexCount, 0, 0 );
 	}
 
 	void CCGridBase::Render()
@@ -657,6 +585,14 @@ namespace cocos2d
 
 		int x, y, i;
 
+		CC_SAFE_FREE(m_pVertices);
+		CC_SAFE_FREE(m_pOriginalVertices);
+		CC_SAFE_FREE(m_pTexCoordinates);
+		CC_SAFE_FREE(m_pIndices);
+
+		m_vertexCount = (m_sGridSize.x+1) * (m_sGridSize.y+1);
+		m_indexCount = m_sGridSize.x * m_sGridSize.y * 6;
+
 		m_pVertices = malloc((m_sGridSize.x+1) * (m_sGridSize.y+1) * sizeof(ccVertex3F));
 		m_pOriginalVertices = malloc((m_sGridSize.x+1) * (m_sGridSize.y+1) * sizeof(ccVertex3F));
 		m_pTexCoordinates = malloc((m_sGridSize.x+1) * (m_sGridSize.y+1) * sizeof(CCPoint));
@@ -717,6 +653,7 @@ namespace cocos2d
 		}
 
 		memcpy(m_pOriginalVertices, m_pVertices, (m_sGridSize.x+1) * (m_sGridSize.y+1) * sizeof(ccVertex3F));
+		updateOriginalSoA();
 	}
 
 	ccVertex3F CCGrid3D::vertex(const ccGridSize& pos)
@@ -753,6 +690,7 @@ namespace cocos2d
 		if (m_nReuseGrid > 0)
 		{
 			memcpy(m_pOriginalVertices, m_pVertices, (m_sGridSize.x+1) * (m_sGridSize.y+1) * sizeof(ccVertex3F));
+			updateOriginalSoA();
 			--m_nReuseGrid;
 		}
 	}
@@ -818,6 +756,14 @@ namespace cocos2d
 
 		int numQuads = m_sGridSize.x * m_sGridSize.y;
 
+		CC_SAFE_FREE(m_pVertices);
+		CC_SAFE_FREE(m_pOriginalVertices);
+		CC_SAFE_FREE(m_pTexCoordinates);
+		CC_SAFE_FREE(m_pIndices);
+
+		m_vertexCount = numQuads * 4;
+		m_indexCount = numQuads * 6;
+
 		m_pVertices = malloc(numQuads * 12 * sizeof(CCfloat));
 		m_pOriginalVertices = malloc(numQuads * 12 * sizeof(CCfloat));
 		m_pTexCoordinates = malloc(numQuads * 8 * sizeof(CCfloat));
@@ -883,6 +829,7 @@ namespace cocos2d
 		}
 
 		memcpy(m_pOriginalVertices, m_pVertices, numQuads * 12 * sizeof(CCfloat));
+		updateOriginalSoA();
 	}
 
 	void CCTiledGrid3D::setTile(const ccGridSize& pos, const ccQuad3& coords)
@@ -921,135 +868,9 @@ namespace cocos2d
 			int numQuads = m_sGridSize.x * m_sGridSize.y;
 
 			memcpy(m_pOriginalVertices, m_pVertices, numQuads * 12 * sizeof(CCfloat));
+			updateOriginalSoA();
 			--m_nReuseGrid;
 		}
 	}
 
-	void CCTiledGrid3D::initVertexBuffer()
-	{
-		m_indexCount = m_sGridSize.x * m_sGridSize.y * 6;
-		unsigned long* indices;
-		indices = new unsigned long[m_indexCount];
-		if(!indices)
-		{
-			return ;
-		}
-		memset(indices, 0, (sizeof(unsigned long) * m_indexCount));
-
-		m_vertexCount = (m_sGridSize.x+1) * (m_sGridSize.y+1) * 4;
-		
-		float *vertArray = (float*)m_pVertices;
-		float *texArray = (float*)m_pTexCoordinates;
-		CCushort *idxArray = m_pIndices;
-
-		for (int x = 0; x < m_sGridSize.x; ++x)
-		{
-			for (int y = 0; y < m_sGridSize.y; ++y)
-			{
-				int idx = (y * m_sGridSize.x) + x;
-
-				unsigned long tempidx[6] = {idxArray[6*idx], idxArray[6*idx+1], idxArray[6*idx+2], idxArray[6*idx+3], idxArray[6*idx+4], idxArray[6*idx+5]};
-				memcpy(&indices[6*idx], tempidx, 6*sizeof(unsigned long));
-			}
-		}
-
-		D3D11_BUFFER_DESC vertexBufferDesc;
-		ZeroMemory( &vertexBufferDesc, sizeof(vertexBufferDesc) );
-
-		// Set up the description of the static vertex buffer.
-		vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-		vertexBufferDesc.ByteWidth = sizeof(VertexType)*m_vertexCount;
-		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-		vertexBufferDesc.MiscFlags = 0;
-		vertexBufferDesc.StructureByteStride = 0;
-
-		// Now create the vertex buffer.
-		if(FAILED(CCID3D11Device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer)))
-		{
-			return ;
-		}
-
-		D3D11_BUFFER_DESC indexBufferDesc;
-		D3D11_SUBRESOURCE_DATA indexData;
-		ZeroMemory( &indexBufferDesc, sizeof(indexBufferDesc) );
-
-		indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-		indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
-		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-		indexBufferDesc.CPUAccessFlags = 0;
-		indexBufferDesc.MiscFlags = 0;
-
-		indexData.pSysMem = indices;
-		CCID3D11Device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
-
-		CC_SAFE_DELETE_ARRAY(indices);
-	}
-
-	void CCTiledGrid3D::RenderVertexBuffer()
-	{
-		m_vertexCount = (m_sGridSize.x+1) * (m_sGridSize.y+1) * 4;
-		VertexType* vertices = new VertexType[m_vertexCount];
-
-		if ( !vertices )
-		{
-			return ;
-		}
-
-		memset(vertices, 0, (sizeof(VertexType) * m_vertexCount));
-		float *vertArray = (float*)m_pVertices;
-		float *texArray = (float*)m_pTexCoordinates;
-
-		for (int x = 0; x < m_sGridSize.x; ++x)
-		{
-			for (int y = 0; y < m_sGridSize.y; ++y)
-			{
-				int idx = (y * m_sGridSize.x) + x;
-				vertices[4*idx].position = XMFLOAT3(vertArray[12*idx], vertArray[12*idx+1], vertArray[12*idx+2]);
-				vertices[4*idx+1].position = XMFLOAT3(vertArray[12*idx+3], vertArray[12*idx+4], vertArray[12*idx+5]);
-				vertices[4*idx+2].position = XMFLOAT3(vertArray[12*idx+6], vertArray[12*idx+7], vertArray[12*idx+8]);
-				vertices[4*idx+3].position = XMFLOAT3(vertArray[12*idx+9], vertArray[12*idx+10], vertArray[12*idx+11]);
-				
-				vertices[4*idx].texture = XMFLOAT2(texArray[8*idx], texArray[8*idx+1]);
-				vertices[4*idx+1].texture = XMFLOAT2(texArray[8*idx+2], texArray[8*idx+3]);
-				vertices[4*idx+2].texture = XMFLOAT2(texArray[8*idx+4], texArray[8*idx+5]);
-				vertices[4*idx+3].texture = XMFLOAT2(texArray[8*idx+6], texArray[8*idx+7]);
-			}
-		}
-
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		VertexType* verticesPtr;
-
-		// Lock the vertex buffer so it can be written to.
-		if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
-		{
-			return;
-		}
-		// Get a pointer to the data in the vertex buffer.
-		verticesPtr = (VertexType*)mappedResource.pData;
-		// Copy the data into the vertex buffer.
-		memcpy(verticesPtr, vertices, (sizeof(VertexType) * m_vertexCount));
-		// Unlock the vertex buffer.
-		CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
-
-		CC_SAFE_DELETE_ARRAY(vertices);
-
-		////////////////////////
-		unsigned int stride;
-		unsigned int offset;
-		// Set vertex buffer stride and offset.
-		stride = sizeof(VertexType); 
-		offset = 0;
-
-		// Set the vertex buffer to active in the input assembler so it can be rendered.
-		CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
-
-		CCID3D11DeviceContext->IASetIndexBuffer( m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
-
-		// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-		CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-		return;
-	}
-
 } // end of namespace cocos2d
@@ -30,18 +30,22 @@ THE SOFTWARE.
 #include "CCCamera.h"
 #include "ccTypes.h"
 #include "CCTexture2D.h"
+#include "ccGridKernels.h"
 #include <fstream>
 
 namespace cocos2d
 {
 	class CCTexture2D;
 	class CCGrabber;
+	class CCRenderTarget;
+	class CCRenderProgram;
 
 	/** Base class for other
 	*/
 	class CCGridBase : public CCObject
 	{
 	public:
+		CCGridBase(void);
 		virtual ~CCGridBase(void);
 
 		/** wheter or not the grid is active */
@@ -73,6 +77,11 @@ namespace cocos2d
 		virtual void reuse(void);
 		virtual void calculateVertexPoints(void);
 
+		/** the original vertices split in x, y and z arrays, and the deformed vertices to write,
+		 for the kernels of ccGridKernels.h
+		 */
+		void getDeformVertices(tGridVertices *psVertices);
+
 	public:
 		static CCGridBase* gridWithSize(const ccGridSize& gridSize, CCTexture2D *texture, bool flipped);
 		static CCGridBase* gridWithSize(const ccGridSize& gridSize);
@@ -81,6 +90,8 @@ namespace cocos2d
 
 	protected:
 		void applyLandscape(void);
+		/** copies the original vertices to m_pOriginalSoA, call it whenever they change */
+		void updateOriginalSoA(void);
 		
 	protected:
 		bool m_bActive;
@@ -89,11 +100,14 @@ namespace cocos2d
 		CCTexture2D *m_pTexture;
 		CCPoint m_obStep;
 		CCGrabber *m_pGrabber;
+		// set when the grid renders the whole screen into a pooled target
+		CCRenderTarget *m_pRenderTarget;
 		bool m_bIsTextureFlipped;
 		CCSize m_winSize;
 
 	protected:
-		ID3D11Buffer *m_vertexBuffer;
+		// positions go to the geometry ring every frame, texture coordinates and indices only change with the grid
+		ID3D11Buffer *m_texCoordBuffer;
 		ID3D11Buffer* m_indexBuffer;
 		int m_indexCount, m_vertexCount;
 		
@@ -101,10 +115,7 @@ namespace cocos2d
 		virtual void RenderVertexBuffer();
 		void Render();
 
-		ID3D11VertexShader* m_vertexShader;
-		ID3D11PixelShader* m_pixelShader;
-		ID3D11InputLayout* m_layout;
-		ID3D11Buffer* m_matrixBuffer;
+		CCRenderProgram* m_pProgram;
 
 		void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 		bool InitializeShader();
@@ -116,17 +127,14 @@ namespace cocos2d
 			DirectX::XMMATRIX view;
 			DirectX::XMMATRIX projection;
 		};
-		struct VertexType
-		{
-			DirectX::XMFLOAT3 position;
-			//XMFLOAT4 color;
-			DirectX::XMFLOAT2 texture;
-		};
 
 		CCvoid *m_pTexCoordinates;
 		CCvoid *m_pVertices;
 		CCvoid *m_pOriginalVertices;
 		CCushort *m_pIndices;
+		// x, y then z of the original vertices, each padded to a multiple of 4 with the last vertex
+		CCfloat *m_pOriginalSoA;
+		unsigned int m_uSoAStride;
 	};
 
 	/**
@@ -151,10 +159,6 @@ namespace cocos2d
 	public:
 		static CCGrid3D* gridWithSize(const ccGridSize& gridSize, CCTexture2D *pTexture, bool bFlipped);
 		static CCGrid3D* gridWithSize(const ccGridSize& gridSize);
-		void initVertexBuffer();
-		void RenderVertexBuffer();
-		//void Render();
-		
 	};
 
 	/**
@@ -180,10 +184,6 @@ namespace cocos2d
 	public:
 		static CCTiledGrid3D* gridWithSize(const ccGridSize& gridSize, CCTexture2D *pTexture, bool bFlipped);
 		static CCTiledGrid3D* gridWithSize(const ccGridSize& gridSize);
-		void initVertexBuffer();
-		void RenderVertexBuffer();
-		//void Render();
-
 	};
 }
 
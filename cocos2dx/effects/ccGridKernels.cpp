@@ -0,0 +1,411 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include <math.h>
+
+#include "ccGridKernels.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CC_GRID_SSE2 1
+#elif defined(_M_ARM) || defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CC_GRID_NEON 1
+#endif
+
+namespace   cocos2d {
+
+#define kPi					3.14159265358979323846f
+#define kHalfPi				1.57079632679489661923f
+#define kInvTwoPi			0.15915494309189533577f
+// 2 pi = kTwoPiHigh + kTwoPiLow, kTwoPiHigh has few enough bits for k * kTwoPiHigh to be exact
+#define kTwoPiHigh			6.28125f
+#define kTwoPiLow			0.00193530717958647692f
+
+//////////////////////////////////////////////////////////////////////////
+// 4 floats at a time
+//////////////////////////////////////////////////////////////////////////
+
+#if CC_GRID_SSE2
+
+typedef __m128 v4f;
+typedef __m128 v4m;
+typedef __m128i v4i;
+
+static inline v4f v4Load(const float *p) { return _mm_loadu_ps(p); }
+static inline void v4Store(float *p, v4f a) { _mm_storeu_ps(p, a); }
+static inline v4f v4Set(float f) { return _mm_set1_ps(f); }
+static inline v4f v4Add(v4f a, v4f b) { return _mm_add_ps(a, b); }
+static inline v4f v4Sub(v4f a, v4f b) { return _mm_sub_ps(a, b); }
+static inline v4f v4Mul(v4f a, v4f b) { return _mm_mul_ps(a, b); }
+static inline v4f v4Sqrt(v4f a) { return _mm_sqrt_ps(a); }
+static inline v4f v4Floor(v4f a)
+{
+	// truncation, minus 1 where it rounded up
+	v4f t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+}
+static inline v4f v4Round(v4f a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+static inline v4m v4Less(v4f a, v4f b) { return _mm_cmplt_ps(a, b); }
+static inline v4f v4Select(v4m m, v4f a, v4f b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline bool v4Any(v4m m) { return _mm_movemask_ps(m) != 0; }
+
+static inline v4i v4RandomInit(const unsigned int *seeds) { return _mm_loadu_si128((const __m128i*)seeds); }
+static inline void v4RandomSave(v4i state, unsigned int *seeds) { _mm_storeu_si128((__m128i*)seeds, state); }
+// xorshift32 on each lane, [0, 1) from its top 24 bits
+static inline v4f v4Random(v4i *pState)
+{
+	v4i x = *pState;
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+	*pState = x;
+	return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+}
+
+#elif CC_GRID_NEON
+
+typedef float32x4_t v4f;
+typedef uint32x4_t v4m;
+typedef uint32x4_t v4i;
+
+static inline v4f v4Load(const float *p) { return vld1q_f32(p); }
+static inline void v4Store(float *p, v4f a) { vst1q_f32(p, a); }
+static inline v4f v4Set(float f) { return vdupq_n_f32(f); }
+static inline v4f v4Add(v4f a, v4f b) { return vaddq_f32(a, b); }
+static inline v4f v4Sub(v4f a, v4f b) { return vsubq_f32(a, b); }
+static inline v4f v4Mul(v4f a, v4f b) { return vmulq_f32(a, b); }
+static inline v4f v4Sqrt(v4f a)
+{
+	// ARMv7 has no vector square root: a times its reciprocal square root, refined twice, 0 stays 0
+	float32x4_t e = vrsqrteq_f32(a);
+	e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a, e), e));
+	e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a, e), e));
+	return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, e));
+}
+static inline v4f v4Floor(v4f a)
+{
+	float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(a));
+	return vsubq_f32(t, vbslq_f32(vcgtq_f32(t, a), vdupq_n_f32(1.0f), vdupq_n_f32(0.0f)));
+}
+static inline v4f v4Round(v4f a) { return v4Floor(vaddq_f32(a, vdupq_n_f32(0.5f))); }
+static inline v4m v4Less(v4f a, v4f b) { return vcltq_f32(a, b); }
+static inline v4f v4Select(v4m m, v4f a, v4f b) { return vbslq_f32(m, a, b); }
+static inline bool v4Any(v4m m)
+{
+	uint32x2_t t = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+	return (vget_lane_u32(t, 0) | vget_lane_u32(t, 1)) != 0;
+}
+
+static inline v4i v4RandomInit(const unsigned int *seeds) { return vld1q_u32(seeds); }
+static inline void v4RandomSave(v4i state, unsigned int *seeds) { vst1q_u32(seeds, state); }
+static inline v4f v4Random(v4i *pState)
+{
+	v4i x = *pState;
+	x = veorq_u32(x, vshlq_n_u32(x, 13));
+	x = veorq_u32(x, vshrq_n_u32(x, 17));
+	x = veorq_u32(x, vshlq_n_u32(x, 5));
+	*pState = x;
+	return vmulq_f32(vcvtq_f32_u32(vshrq_n_u32(x, 8)), vdupq_n_f32(1.0f / 16777216.0f));
+}
+
+#else
+
+typedef struct { float f[4]; } v4f;
+typedef struct { bool b[4]; } v4m;
+typedef struct { unsigned int u[4]; } v4i;
+
+#define V4_EACH(expr)	for (int l = 0; l < 4; ++l) { expr; }
+
+static inline v4f v4Load(const float *p) { v4f r; V4_EACH(r.f[l] = p[l]); return r; }
+static inline void v4Store(float *p, v4f a) { V4_EACH(p[l] = a.f[l]); }
+static inline v4f v4Set(float f) { v4f r; V4_EACH(r.f[l] = f); return r; }
+static inline v4f v4Add(v4f a, v4f b) { v4f r; V4_EACH(r.f[l] = a.f[l] + b.f[l]); return r; }
+static inline v4f v4Sub(v4f a, v4f b) { v4f r; V4_EACH(r.f[l] = a.f[l] - b.f[l]); return r; }
+static inline v4f v4Mul(v4f a, v4f b) { v4f r; V4_EACH(r.f[l] = a.f[l] * b.f[l]); return r; }
+static inline v4f v4Sqrt(v4f a) { v4f r; V4_EACH(r.f[l] = sqrtf(a.f[l])); return r; }
+static inline v4f v4Floor(v4f a) { v4f r; V4_EACH(r.f[l] = floorf(a.f[l])); return r; }
+static inline v4f v4Round(v4f a) { v4f r; V4_EACH(r.f[l] = floorf(a.f[l] + 0.5f)); return r; }
+static inline v4m v4Less(v4f a, v4f b) { v4m r; V4_EACH(r.b[l] = a.f[l] < b.f[l]); return r; }
+static inline v4f v4Select(v4m m, v4f a, v4f b) { v4f r; V4_EACH(r.f[l] = m.b[l] ? a.f[l] : b.f[l]); return r; }
+static inline bool v4Any(v4m m) { return m.b[0] || m.b[1] || m.b[2] || m.b[3]; }
+
+static inline v4i v4RandomInit(const unsigned int *seeds) { v4i r; V4_EACH(r.u[l] = seeds[l]); return r; }
+static inline void v4RandomSave(v4i state, unsigned int *seeds) { V4_EACH(seeds[l] = state.u[l]); }
+static inline v4f v4Random(v4i *pState)
+{
+	v4f r;
+	for (int l = 0; l < 4; ++l)
+	{
+		unsigned int x = pState->u[l];
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		pState->u[l] = x;
+		r.f[l] = (float)(x >> 8) * (1.0f / 16777216.0f);
+	}
+	return r;
+}
+
+#endif
+
+// sines of 4 angles
+static inline v4f v4Sin(v4f x)
+{
+	// brought in [-pi, pi]
+	v4f k = v4Round(v4Mul(x, v4Set(kInvTwoPi)));
+	x = v4Sub(v4Sub(x, v4Mul(k, v4Set(kTwoPiHigh))), v4Mul(k, v4Set(kTwoPiLow)));
+
+	// then in [-pi/2, pi/2], sin(x) = sin(pi - x) = sin(-pi - x)
+	x = v4Select(v4Less(v4Set(kHalfPi), x), v4Sub(v4Set(kPi), x), x);
+	x = v4Select(v4Less(x, v4Set(-kHalfPi)), v4Sub(v4Set(-kPi), x), x);
+
+	// Taylor series up to x^11, its error is below 1e-7 there
+	v4f x2 = v4Mul(x, x);
+	v4f p = v4Set(-1.0f / 39916800.0f);
+	p = v4Add(v4Mul(p, x2), v4Set(1.0f / 362880.0f));
+	p = v4Add(v4Mul(p, x2), v4Set(-1.0f / 5040.0f));
+	p = v4Add(v4Mul(p, x2), v4Set(1.0f / 120.0f));
+	p = v4Add(v4Mul(p, x2), v4Set(-1.0f / 6.0f));
+	p = v4Add(v4Mul(p, x2), v4Set(1.0f));
+	return v4Mul(p, x);
+}
+
+// how many of the 4 vertices at i are in the grid
+static inline unsigned int laneCount(const tGridVertices *psVertices, unsigned int i)
+{
+	return psVertices->count - i < 4 ? psVertices->count - i : 4;
+}
+
+// writes the first n lanes as x, y, z triplets
+static inline void storeTriplets(float *out, v4f x, v4f y, v4f z, unsigned int n)
+{
+	float tx[4], ty[4], tz[4];
+	v4Store(tx, x);
+	v4Store(ty, y);
+	v4Store(tz, z);
+
+	for (unsigned int l = 0; l < n; ++l, out += 3)
+	{
+		out[0] = tx[l];
+		out[1] = ty[l];
+		out[2] = tz[l];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// deformers
+//////////////////////////////////////////////////////////////////////////
+
+void ccGridWaves3D(const tGridVertices *psVertices, float phase, float amplitude)
+{
+	const v4f vPhase = v4Set(phase);
+	const v4f vAmplitude = v4Set(amplitude);
+	const v4f vScale = v4Set(0.01f);
+
+	for (unsigned int i = 0; i < psVertices->count; i += 4)
+	{
+		v4f x = v4Load(psVertices->x + i);
+		v4f y = v4Load(psVertices->y + i);
+		v4f z = v4Load(psVertices->z + i);
+
+		z = v4Add(z, v4Mul(v4Sin(v4Add(vPhase, v4Mul(v4Add(x, y), vScale))), vAmplitude));
+
+		storeTriplets(psVertices->out + i * 3, x, y, z, laneCount(psVertices, i));
+	}
+}
+
+void ccGridWaves(const tGridVertices *psVertices, float phase, float amplitude, bool bVertical, bool bHorizontal)
+{
+	const v4f vPhase = v4Set(phase);
+	const v4f vAmplitude = v4Set(amplitude);
+	const v4f vScale = v4Set(0.01f);
+
+	for (unsigned int i = 0; i < psVertices->count; i += 4)
+	{
+		v4f x = v4Load(psVertices->x + i);
+		v4f y = v4Load(psVertices->y + i);
+		v4f z = v4Load(psVertices->z + i);
+
+		if (bVertical)
+		{
+			x = v4Add(x, v4Mul(v4Sin(v4Add(vPhase, v4Mul(y, vScale))), vAmplitude));
+		}
+
+		// from the x just moved, as CCWaves always did
+		if (bHorizontal)
+		{
+			y = v4Add(y, v4Mul(v4Sin(v4Add(vPhase, v4Mul(x, vScale))), vAmplitude));
+		}
+
+		storeTriplets(psVertices->out + i * 3, x, y, z, laneCount(psVertices, i));
+	}
+}
+
+void ccGridRipple(const tGridVertices *psVertices, float centerX, float centerY, float radius, float phase, float amplitude)
+{
+	const v4f vCenterX = v4Set(centerX);
+	const v4f vCenterY = v4Set(centerY);
+	const v4f vRadius = v4Set(radius);
+	const v4f vInvRadius = v4Set(radius > 0 ? 1.0f / radius : 0.0f);
+	const v4f vPhase = v4Set(phase);
+	const v4f vAmplitude = v4Set(amplitude);
+	const v4f vScale = v4Set(0.1f);
+	const v4f vZero = v4Set(0.0f);
+
+	for (unsigned int i = 0; i < psVertices->count; i += 4)
+	{
+		v4f x = v4Load(psVertices->x + i);
+		v4f y = v4Load(psVertices->y + i);
+		v4f z = v4Load(psVertices->z + i);
+
+		v4f dx = v4Sub(vCenterX, x);
+		v4f dy = v4Sub(vCenterY, y);
+		v4f r = v4Sqrt(v4Add(v4Mul(dx, dx), v4Mul(dy, dy)));
+		v4m inside = v4Less(r, vRadius);
+		if (v4Any(inside))
+		{
+			r = v4Sub(vRadius, r);
+			v4f rate = v4Mul(r, vInvRadius);
+			v4f offset = v4Mul(v4Mul(v4Sin(v4Add(vPhase, v4Mul(r, vScale))), vAmplitude), v4Mul(rate, rate));
+			z = v4Add(z, v4Select(inside, offset, vZero));
+		}
+
+		storeTriplets(psVertices->out + i * 3, x, y, z, laneCount(psVertices, i));
+	}
+}
+
+void ccGridLens(const tGridVertices *psVertices, float centerX, float centerY, float radius, float lensEffect)
+{
+	const v4f vCenterX = v4Set(centerX);
+	const v4f vCenterY = v4Set(centerY);
+	const v4f vRadius = v4Set(radius);
+
+	for (unsigned int i = 0; i < psVertices->count; i += 4)
+	{
+		v4f x = v4Load(psVertices->x + i);
+		v4f y = v4Load(psVertices->y + i);
+		v4f z = v4Load(psVertices->z + i);
+
+		v4f dx = v4Sub(vCenterX, x);
+		v4f dy = v4Sub(vCenterY, y);
+		v4f r = v4Sqrt(v4Add(v4Mul(dx, dx), v4Mul(dy, dy)));
+		if (v4Any(v4Less(r, vRadius)))
+		{
+			// the power is left to powf, only the few vertices under the lens get there
+			float tr[4], tz[4];
+			v4Store(tr, r);
+			v4Store(tz, z);
+			for (int l = 0; l < 4; ++l)
+			{
+				if (tr[l] < radius && tr[l] > 0)
+				{
+					float rate = (radius - tr[l]) / radius;
+					tz[l] += powf(rate > 0 ? rate : 0.001f, lensEffect) * radius * lensEffect;
+				}
+			}
+			z = v4Load(tz);
+		}
+
+		storeTriplets(psVertices->out + i * 3, x, y, z, laneCount(psVertices, i));
+	}
+}
+
+void ccGridTwirl(const tGridVertices *psVertices, unsigned int gridWidth, unsigned int gridHeight, float centerX, float centerY, float angle)
+{
+	const v4f vCenterX = v4Set(centerX);
+	const v4f vCenterY = v4Set(centerY);
+	const v4f vAngle = v4Set(angle);
+	const v4f vHalfPi = v4Set(kHalfPi);
+
+	// vertex k is at column k / (gridHeight + 1), row k % (gridHeight + 1)
+	unsigned int column = 0, row = 0;
+	for (unsigned int i = 0; i < psVertices->count; i += 4)
+	{
+		float cells[2][4];
+		for (int l = 0; l < 4; ++l)
+		{
+			cells[0][l] = column - gridWidth / 2.0f;
+			cells[1][l] = row - gridHeight / 2.0f;
+			if (++row > gridHeight)
+			{
+				row = 0;
+				++column;
+			}
+		}
+
+		v4f x = v4Load(psVertices->x + i);
+		v4f y = v4Load(psVertices->y + i);
+		v4f z = v4Load(psVertices->z + i);
+
+		v4f gx = v4Load(cells[0]);
+		v4f gy = v4Load(cells[1]);
+		v4f a = v4Mul(v4Sqrt(v4Add(v4Mul(gx, gx), v4Mul(gy, gy))), vAngle);
+		v4f s = v4Sin(a);
+		v4f c = v4Sin(v4Add(a, vHalfPi));
+
+		v4f dx = v4Sub(x, vCenterX);
+		v4f dy = v4Sub(y, vCenterY);
+		x = v4Add(vCenterX, v4Add(v4Mul(s, dy), v4Mul(c, dx)));
+		y = v4Add(vCenterY, v4Sub(v4Mul(c, dy), v4Mul(s, dx)));
+
+		storeTriplets(psVertices->out + i * 3, x, y, z, laneCount(psVertices, i));
+	}
+}
+
+void ccGridShaky(const tGridVertices *psVertices, int range, bool bShakeZ, unsigned int *pSeed)
+{
+	// 4 generators seeded from the one state, none of them 0
+	unsigned int seeds[4];
+	for (int l = 0; l < 4; ++l)
+	{
+		*pSeed = *pSeed * 1664525u + 1013904223u;
+		seeds[l] = *pSeed | 1u;
+	}
+	v4i state = v4RandomInit(seeds);
+
+	const v4f vSpan = v4Set((float)(range > 0 ? range * 2 : 0));
+	const v4f vRange = v4Set((float)(range > 0 ? range : 0));
+
+	for (unsigned int i = 0; i < psVertices->count; i += 4)
+	{
+		v4f x = v4Load(psVertices->x + i);
+		v4f y = v4Load(psVertices->y + i);
+		v4f z = v4Load(psVertices->z + i);
+
+		x = v4Add(x, v4Sub(v4Floor(v4Mul(v4Random(&state), vSpan)), vRange));
+		y = v4Add(y, v4Sub(v4Floor(v4Mul(v4Random(&state), vSpan)), vRange));
+		if (bShakeZ)
+		{
+			z = v4Add(z, v4Sub(v4Floor(v4Mul(v4Random(&state), vSpan)), vRange));
+		}
+
+		storeTriplets(psVertices->out + i * 3, x, y, z, laneCount(psVertices, i));
+	}
+
+	v4RandomSave(state, seeds);
+	*pSeed ^= seeds[0];
+}
+
+}//namespace   cocos2d
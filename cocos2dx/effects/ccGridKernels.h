@@ -0,0 +1,74 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __EFFECTS_CCGRIDKERNELS_H__
+#define __EFFECTS_CCGRIDKERNELS_H__
+
+/*
+	Deformers of the grid actions, 4 vertices at a time with SSE2 or NEON.
+
+	They read the original vertices as separate x, y and z arrays and write
+	the deformed ones as x, y, z triplets, the layout CCGrid3D and
+	CCTiledGrid3D upload. The sines are a polynomial approximation, within
+	1e-6 of sinf.
+*/
+
+namespace   cocos2d {
+
+/** vertices of a grid, see CCGridBase::getDeformVertices() */
+typedef struct sGridVertices {
+	/** the original vertices, readable up to count rounded up to a multiple of 4 */
+	const float *x;
+	const float *y;
+	const float *z;
+	unsigned int count;
+	/** count x, y, z triplets the deformed vertices are written to */
+	float *out;
+} tGridVertices;
+
+/** CCWaves3D: z += sin(phase + (x + y) / 100) * amplitude */
+void ccGridWaves3D(const tGridVertices *psVertices, float phase, float amplitude);
+
+/** CCWaves: x += sin(phase + y / 100) * amplitude when bVertical, y += sin(phase + x / 100) * amplitude when bHorizontal */
+void ccGridWaves(const tGridVertices *psVertices, float phase, float amplitude, bool bVertical, bool bHorizontal);
+
+/** CCRipple3D: within radius of the center, z += sin(phase + d / 10) * amplitude * (d / radius)^2, d being radius minus the distance */
+void ccGridRipple(const tGridVertices *psVertices, float centerX, float centerY, float radius, float phase, float amplitude);
+
+/** CCLens3D: within radius of the center, z += (d / radius)^lensEffect * radius * lensEffect, d being radius minus the distance */
+void ccGridLens(const tGridVertices *psVertices, float centerX, float centerY, float radius, float lensEffect);
+
+/** CCTwirl: rotates x and y around the center by angle times the distance of the vertex to the middle of the grid,
+	in grid cells. The vertices are those of a CCGrid3D of gridWidth x gridHeight cells.
+*/
+void ccGridTwirl(const tGridVertices *psVertices, unsigned int gridWidth, unsigned int gridHeight, float centerX, float centerY, float angle);
+
+/** CCShaky3D and CCShakyTiles3D: adds whole random offsets in [-range, range) to x and y, and to z when bShakeZ.
+	pSeed is the state of the random generator, updated on return.
+*/
+void ccGridShaky(const tGridVertices *psVertices, int range, bool bShakeZ, unsigned int *pSeed);
+
+}//namespace   cocos2d
+
+#endif // __EFFECTS_CCGRIDKERNELS_H__
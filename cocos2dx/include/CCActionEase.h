@@ -54,6 +54,9 @@ public:
 	/** creates the action */
 	static CCActionEase* actionWithAction(CCActionInterval *pAction);
 
+	/** the eased action */
+	inline CCActionInterval* getInnerAction(void) { return m_pOther; }
+
 protected:
 	CCActionInterval *m_pOther;
 };
@@ -170,6 +170,8 @@ namespace cocos2d
 	protected:
 		int m_nRandrange;
 		bool m_bShakeZ;
+		// state of the generator the offsets come from
+		unsigned int m_uSeed;
 	};
 
 	/** @brief CCLiquid action */
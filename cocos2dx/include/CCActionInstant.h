@@ -54,6 +54,7 @@ namespace cocos2d {
 	*/
 	class CC_DLL CCShow : public CCActionInstant
 	{
+		CC_POOLED_ALLOC(CCShow)
 	public:
 		CCShow(){}
 		virtual ~CCShow(){}
@@ -74,6 +75,7 @@ namespace cocos2d {
 	*/
 	class CC_DLL CCHide : public CCActionInstant
 	{
+		CC_POOLED_ALLOC(CCHide)
 	public:
 		CCHide(){}
 		virtual ~CCHide(){}
@@ -156,6 +158,7 @@ namespace cocos2d {
 	*/
 	class CC_DLL CCPlace : public CCActionInstant //<NSCopying>
 	{
+		CC_POOLED_ALLOC(CCPlace)
 	public:
 		CCPlace(){}
 		virtual ~CCPlace(){}
@@ -174,6 +177,7 @@ namespace cocos2d {
 	*/
 	class CC_DLL CCCallFunc : public CCActionInstant //<NSCopying>
 	{
+		CC_POOLED_ALLOC(CCCallFunc)
 	public:
 		CCCallFunc()
             : m_pSelectorTarget(NULL)
@@ -246,6 +250,7 @@ namespace cocos2d {
 	*/
 	class CC_DLL CCCallFuncN : public CCCallFunc
 	{
+		CC_POOLED_ALLOC(CCCallFuncN)
 	public:
 		CCCallFuncN(){}
 		virtual ~CCCallFuncN(){}
@@ -271,6 +276,7 @@ namespace cocos2d {
 	*/
 	class CC_DLL CCCallFuncND : public CCCallFuncN
 	{
+		CC_POOLED_ALLOC(CCCallFuncND)
 	public:
 
 		/** creates the action with the callback and the data to pass as an argument */
@@ -293,6 +299,7 @@ namespace cocos2d {
     */
     class CC_DLL CCCallFuncO : public CCCallFunc
     {
+    	CC_POOLED_ALLOC(CCCallFuncO)
     public:
         CCCallFuncO();
         virtual ~CCCallFuncO();
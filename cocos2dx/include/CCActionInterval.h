@@ -35,6 +35,8 @@ THE SOFTWARE.
 
 namespace cocos2d {
 
+class CCTweenManager;
+
 /** 
 @brief An interval action is an action that takes place within a certain period of time.
 It has an start time, and a finish time. The finish time is the parameter
@@ -88,6 +90,7 @@ protected:
  */
 class CC_DLL CCSequence : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCSequence)
 public:
 	~CCSequence(void);
 
@@ -121,6 +124,7 @@ protected:
  */
 class CC_DLL CCRepeat : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCRepeat)
 public:
 	~CCRepeat(void);
 
@@ -166,6 +170,7 @@ To repeat the an action for a limited number of times use the Repeat action.
 */
 class CC_DLL CCRepeatForever : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCRepeatForever)
 public:
 	CCRepeatForever()
 		: m_pInnerAction(NULL)
@@ -208,6 +213,7 @@ protected:
  */
 class CC_DLL CCSpawn : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCSpawn)
 public:
 	~CCSpawn(void);
 
@@ -242,6 +248,7 @@ protected:
 */ 
 class CC_DLL CCRotateTo : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCRotateTo)
 public:
 	/** initializes the action */
 	bool initWithDuration(ccTime duration, float fDeltaAngle);
@@ -255,6 +262,8 @@ public:
 	static CCRotateTo* actionWithDuration(ccTime duration, float fDeltaAngle);
 
 protected:
+	friend class CCTweenManager;
+
 	float m_fDstAngle;
 	float m_fStartAngle;
 	float m_fDiffAngle;
@@ -264,6 +273,7 @@ protected:
 */
 class CC_DLL CCRotateBy : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCRotateBy)
 public:
 	/** initializes the action */
     bool initWithDuration(ccTime duration, float fDeltaAngle);
@@ -278,6 +288,8 @@ public:
 	static CCRotateBy* actionWithDuration(ccTime duration, float fDeltaAngle);
 
 protected:
+	friend class CCTweenManager;
+
 	float m_fAngle;
 	float m_fStartAngle;
 };
@@ -286,6 +298,7 @@ protected:
 */
 class CC_DLL CCMoveTo : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCMoveTo)
 public:
 	/** initializes the action */
 	bool initWithDuration(ccTime duration, const CCPoint& position);
@@ -299,6 +312,8 @@ public:
 	static CCMoveTo* actionWithDuration(ccTime duration, const CCPoint& position);
 
 protected:
+	friend class CCTweenManager;
+
 	CCPoint m_endPosition;
 	CCPoint m_startPosition;
 	CCPoint m_delta;
@@ -310,6 +325,7 @@ protected:
 */ 
 class CC_DLL CCMoveBy : public CCMoveTo
 {
+	CC_POOLED_ALLOC(CCMoveBy)
 public:
 	/** initializes the action */
 	bool initWithDuration(ccTime duration, const CCPoint& position);
@@ -452,6 +468,7 @@ public:
  */
 class CC_DLL CCScaleTo : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCScaleTo)
 public:
 	/** initializes the action with the same scale factor for X and Y */
 	bool initWithDuration(ccTime duration, float s);
@@ -470,6 +487,8 @@ public:
 	/** creates the action with and X factor and a Y factor */
 	static CCScaleTo* actionWithDuration(ccTime duration, float sx, float sy);
 protected:
+	friend class CCTweenManager;
+
 	float m_fScaleX;
 	float m_fScaleY;
 	float m_fStartScaleX;
@@ -484,6 +503,7 @@ protected:
 */
 class CC_DLL CCScaleBy : public CCScaleTo
 {
+	CC_POOLED_ALLOC(CCScaleBy)
 public:
     virtual void startWithTarget(CCNode *pTarget);
 	virtual CCActionInterval* reverse(void);
@@ -521,6 +541,7 @@ protected:
  */
 class CC_DLL CCFadeIn : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCFadeIn)
 public:
     virtual void update(ccTime time);
 	virtual CCActionInterval* reverse(void);
@@ -536,6 +557,7 @@ public:
 */
 class CC_DLL CCFadeOut : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCFadeOut)
 public:
 	virtual void update(ccTime time);
 	virtual CCActionInterval* reverse(void);
@@ -551,6 +573,7 @@ public:
  */
 class CC_DLL CCFadeTo : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCFadeTo)
 public:
 	/** initializes the action with duration and opacity */
 	bool initWithDuration(ccTime duration, CCubyte opacity);
@@ -564,6 +587,8 @@ public:
 	static CCFadeTo* actionWithDuration(ccTime duration, CCubyte opacity);
 
 protected:
+	friend class CCTweenManager;
+
 	CCubyte m_toOpacity;
 	CCubyte m_fromOpacity;
 };
@@ -574,6 +599,7 @@ protected:
 */
 class CC_DLL CCTintTo : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCTintTo)
 public:
 	/** initializes the action with duration and color */
 	bool initWithDuration(ccTime duration, CCubyte red, CCubyte green, CCubyte blue);
@@ -587,6 +613,8 @@ public:
 	static CCTintTo* actionWithDuration(ccTime duration, CCubyte red, CCubyte green, CCubyte blue);
 
 protected:
+	friend class CCTweenManager;
+
 	ccColor3B m_to;
 	ccColor3B m_from;
 };
@@ -610,6 +638,8 @@ public:
 	static CCTintBy* actionWithDuration(ccTime duration, CCshort deltaRed, CCshort deltaGreen, CCshort deltaBlue);
 
 protected:
+	friend class CCTweenManager;
+
 	CCshort m_deltaR;
 	CCshort m_deltaG;
 	CCshort m_deltaB;
@@ -623,6 +653,7 @@ protected:
 */
 class CC_DLL CCDelayTime : public CCActionInterval
 {
+	CC_POOLED_ALLOC(CCDelayTime)
 public:
 	virtual void update(ccTime time);
 	virtual CCActionInterval* reverse(void);
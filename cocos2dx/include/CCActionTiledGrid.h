@@ -48,6 +48,8 @@ namespace cocos2d
 	protected:
 		int m_nRandrange;
 		bool m_bShakeZ;
+		// state of the generator the offsets come from
+		unsigned int m_uSeed;
 	};
 
 	/** @brief CCShatteredTiles3D action */
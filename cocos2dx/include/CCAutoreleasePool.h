@@ -27,24 +27,60 @@ THE SOFTWARE.
 #include "CCObject.h"
 #include "CCMutableArray.h"
 
+#include <vector>
+
 namespace cocos2d {
+
+/** counters of the autorelease pools, a frame ends when the bottom pool is popped */
+typedef struct _ccAutoreleasePoolStats
+{
+	//! objects autoreleased since the last frame ended
+	unsigned int uObjectsThisFrame;
+	//! objects autoreleased during the last complete frame
+	unsigned int uObjectsLastFrame;
+	//! most objects autoreleased in a single frame
+	unsigned int uPeakObjectsPerFrame;
+	//! most objects held by a single pool at once
+	unsigned int uPeakPoolSize;
+	//! slots allocated by all the pools
+	unsigned int uCapacity;
+} ccAutoreleasePoolStats;
+
+/** @brief Holds the autoreleased objects until clear() releases them.
+
+Objects are kept in fixed size chunks that are reused after clear(), so a pool
+stops allocating once it has grown to the size of a typical frame. Each object
+remembers its slot, which makes removeObject() O(1).
+*/
 class CC_DLL CCAutoreleasePool : public CCObject
 {
-	CCMutableArray<CCObject*>*	m_pManagedObjectArray;	
+	std::vector<CCObject**>	m_chunks;
+	unsigned int			m_uCount;
 public:
 	CCAutoreleasePool(void);
 	~CCAutoreleasePool(void);
 
 	void addObject(CCObject *pObject);
-	void removeObject(CCObject *pObject);
+	/** returns false if pObject is not held by this pool */
+	bool removeObject(CCObject *pObject);
 
 	void clear();
+
+	/** number of slots used since the last clear() */
+	inline unsigned int count(void) { return m_uCount; }
+	inline unsigned int capacity(void) { return (unsigned int)m_chunks.size() * kChunkSize; }
+
+	enum { kChunkSize = 1024 };
+
+private:
+	inline CCObject** slotAtIndex(unsigned int uIndex) { return &m_chunks[uIndex / kChunkSize][uIndex % kChunkSize]; }
 };
 
 class CC_DLL CCPoolManager
 {
 	CCMutableArray<CCAutoreleasePool*>*	m_pReleasePoolStack;	
 	CCAutoreleasePool*					m_pCurReleasePool;
+	ccAutoreleasePoolStats				m_tStats;
 
 	CCAutoreleasePool* getCurReleasePool();
 public:
@@ -57,6 +93,8 @@ public:
 	void removeObject(CCObject* pObject);
 	void addObject(CCObject* pObject);
 
+	inline const ccAutoreleasePoolStats& getStats(void) { return m_tStats; }
+
 	static CCPoolManager* getInstance();
 
 	friend class CCAutoreleasePool;
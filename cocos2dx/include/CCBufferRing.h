@@ -0,0 +1,268 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCBUFFER_RING_H__
+#define __CCBUFFER_RING_H__
+
+#include "CCObject.h"
+#include <d3d11_1.h>
+#include <vector>
+
+namespace cocos2d {
+
+/** counters of a CCBufferRing, sizes are in bytes */
+typedef struct _ccBufferRingStats
+{
+	//! sub-allocations made in the current frame
+	unsigned int uAllocationsThisFrame;
+	//! bytes they took, alignment padding included
+	unsigned int uBytesThisFrame;
+	//! maps that discarded the whole buffer in the current frame
+	unsigned int uDiscardsThisFrame;
+	//! totals since the ring was created
+	unsigned int uTotalAllocations;
+	unsigned int uTotalDiscards;
+	//! times the allocations went on from the start of the buffer
+	unsigned int uWraps;
+	//! times the buffer was created again larger
+	unsigned int uGrows;
+	unsigned int uPeakFrameBytes;
+} ccBufferRingStats;
+
+/** @brief What a CCBufferRing needs from the GPU: one CPU writable buffer and fences.
+CCD3D11BufferRingDevice implements it over a D3D11 dynamic buffer, another
+implementation can stand in for the device to run a ring without a GPU.
+*/
+class CC_DLL CCBufferRingDevice : public CCObject
+{
+public:
+	/** Creates the buffer, releasing the previous one. The GPU may still read
+	the previous one, it has to stay alive until it is done.
+	*/
+	virtual bool createBuffer(unsigned int uCapacity) = 0;
+
+	/** Maps the whole buffer for writing.
+	@param bDiscard true: the GPU goes on reading the previous contents while new
+	memory is handed out. false: the same memory, the ring doesn't write to the
+	bytes the GPU may still read.
+	*/
+	virtual void* map(bool bDiscard) = 0;
+	virtual void unmap(void) = 0;
+
+	/** Queues fence uFence after the commands submitted so far, fences are increasing.
+	@return false if the fence can't be tracked, e.g. while recording a command list
+	*/
+	virtual bool signalFence(unsigned int uFence) = 0;
+	/** the highest fence the GPU went past, 0 if none */
+	virtual unsigned int getCompletedFence(void) = 0;
+};
+
+/** @brief CCBufferRingDevice over a D3D11 dynamic buffer.
+The buffer is mapped on the context rendering is recorded to, the fences are
+event queries polled without flushing.
+*/
+class CC_DLL CCD3D11BufferRingDevice : public CCBufferRingDevice
+{
+public:
+	CCD3D11BufferRingDevice(void);
+	virtual ~CCD3D11BufferRingDevice(void);
+
+	/** uBindFlags is D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_INDEX_BUFFER, or D3D11_BIND_CONSTANT_BUFFER */
+	bool initWithBindFlags(UINT uBindFlags);
+
+	inline ID3D11Buffer* getBuffer(void) { return m_pBuffer; }
+
+	virtual bool createBuffer(unsigned int uCapacity);
+	virtual void* map(bool bDiscard);
+	virtual void unmap(void);
+	virtual bool signalFence(unsigned int uFence);
+	virtual unsigned int getCompletedFence(void);
+
+protected:
+	typedef struct _ccPendingFence
+	{
+		unsigned int uFence;
+		ID3D11Query *pQuery;
+	} ccPendingFence;
+
+	UINT m_uBindFlags;
+	ID3D11Buffer *m_pBuffer;
+	ID3D11DeviceContext *m_pMappedContext;
+	//! oldest first
+	std::vector<ccPendingFence> m_pendingFences;
+	//! queries done with, to be issued again
+	std::vector<ID3D11Query*> m_freeQueries;
+	unsigned int m_uCompletedFence;
+};
+
+/** @brief Per frame linear allocator over one large dynamic buffer.
+
+Renderers used to own a small dynamic buffer each and to map it with
+D3D11_MAP_WRITE_DISCARD on every draw, every discard makes the driver rename the
+buffer. The ring hands out consecutive ranges of a single buffer instead, mapped
+without discard: nothing the GPU may still read is overwritten since the ranges
+of a frame are only reused once the fence queued after that frame has passed.
+The buffer is only discarded when the allocations catch up with the ranges in
+flight, and created again twice as large when a single frame doesn't fit or when
+that happens again within a few frames.
+
+A range is valid until the end of the frame, draw from it right away.
+*/
+class CC_DLL CCBufferRing : public CCObject
+{
+public:
+	CCBufferRing(void);
+	virtual ~CCBufferRing(void);
+
+	/** The ring retains pDevice */
+	bool initWithDevice(CCBufferRingDevice *pDevice, unsigned int uCapacity);
+
+	/** Allocates uSize bytes aligned on uAlignment and maps them for writing.
+	Call unmap() once written, before anything is drawn from the buffer.
+	@param pOffset receives the offset of the range in the buffer
+	@return NULL if the device failed, nothing is mapped then
+	*/
+	void* map(unsigned int uSize, unsigned int uAlignment, unsigned int *pOffset);
+	void unmap(void);
+
+	/** map(), copy and unmap() */
+	bool upload(const void *pData, unsigned int uSize, unsigned int uAlignment, unsigned int *pOffset);
+
+	/** Fences the ranges allocated since the last call, called by CCDynamicBuffers after each frame */
+	void frameEnded(void);
+
+	/** The next map() discards the buffer and starts over at its beginning.
+	Needed when a new command list starts to be recorded: a deferred context has
+	to discard a dynamic buffer before it maps it without discard.
+	*/
+	void discard(void);
+
+	/** The selector is called right before the buffer is discarded, while the draws
+	that read the previous contents can still be issued. pTarget isn't retained,
+	NULL removes the listener.
+	*/
+	void setDiscardListener(CCObject *pTarget, SEL_CallFunc pfnSelector);
+
+	inline unsigned int getCapacity(void) { return m_uCapacity; }
+	inline CCBufferRingDevice* getDevice(void) { return m_pDevice; }
+
+	inline const ccBufferRingStats& getStats(void) { return m_tStats; }
+
+protected:
+	/** frees the ranges of the frames whose fence has passed */
+	void retireFrames(void);
+
+	typedef struct _ccRingFrame
+	{
+		unsigned int uFence;
+		unsigned int uBytes;
+	} ccRingFrame;
+
+	enum
+	{
+		//! the frames tracked at once, older ones are merged into the newest
+		kMaxFramesInFlight = 8,
+	};
+
+	CCBufferRingDevice *m_pDevice;
+	unsigned int m_uCapacity;
+	//! where the next range starts
+	unsigned int m_uHead;
+	//! bytes the GPU may still read, from the oldest frame in flight to the head
+	unsigned int m_uUsed;
+	//! bytes allocated since the last fence
+	unsigned int m_uUnfencedBytes;
+	ccRingFrame m_frames[kMaxFramesInFlight];
+	unsigned int m_uFirstFrame;
+	unsigned int m_uFrameCount;
+	unsigned int m_uNextFence;
+	//! frames since the allocations last caught up with the ranges in flight
+	unsigned int m_uFramesSinceStarved;
+	bool m_bDiscardNext;
+	bool m_bMapped;
+	CCObject *m_pDiscardListener;
+	SEL_CallFunc m_pfnDiscardSelector;
+	ccBufferRingStats m_tStats;
+};
+
+/** @brief Singleton holding the rings the node renderers take their per draw data from.
+
+The vertices go to a geometry ring, bound with an offset, and the per draw shader
+constants (the matrices) are packed into a constant ring and bound by range with
+VSSetConstantBuffers1. Drivers that can't bind a constant buffer range get the
+constants through a single buffer discarded on each draw, like before.
+The bindings are pending states of the next draw of the CCRenderQueue.
+*/
+class CC_DLL CCDynamicBuffers : public CCObject
+{
+public:
+	CCDynamicBuffers(void);
+	virtual ~CCDynamicBuffers(void);
+
+	static CCDynamicBuffers* sharedDynamicBuffers(void);
+	static void purgeSharedDynamicBuffers(void);
+
+	bool init(void);
+
+	inline CCBufferRing* getGeometryRing(void) { return m_pGeometryRing; }
+	inline CCBufferRing* getConstantRing(void) { return m_pConstantRing; }
+
+	/** Maps room for uCount vertices of uStride bytes, bind them with bindVertices() once unmapped
+	@return NULL if nothing could be mapped
+	*/
+	void* mapVertices(unsigned int uStride, unsigned int uCount, unsigned int *pOffset);
+	void unmapVertices(void);
+	void bindVertices(UINT uSlot, unsigned int uStride, unsigned int uOffset);
+
+	/** Copies the vertices and sets them on input slot uSlot */
+	bool setVertices(UINT uSlot, const void *pVertices, unsigned int uStride, unsigned int uCount);
+
+	/** Copies uSize bytes of constants and sets them on vertex shader slot uSlot */
+	bool setVSConstants(UINT uSlot, const void *pData, unsigned int uSize);
+
+	/** whether the constants are packed into the constant ring */
+	inline bool isConstantRangeSupported(void) { return m_bConstantRanges; }
+
+	/** Called by CCDirector after each frame: fences the ranges of the frame */
+	void frameEnded(void);
+
+	/** Called when a new command list starts to be recorded, see CCBufferRing::discard() */
+	void commandListStarted(void);
+
+protected:
+	bool setFallbackConstants(UINT uSlot, const void *pData, unsigned int uSize);
+
+	CCBufferRing *m_pGeometryRing;
+	CCBufferRing *m_pConstantRing;
+	CCD3D11BufferRingDevice *m_pGeometryDevice;
+	CCD3D11BufferRingDevice *m_pConstantDevice;
+	bool m_bConstantRanges;
+	//! constants of the drivers without ranges
+	ID3D11Buffer *m_pFallbackConstants;
+	unsigned int m_uFallbackSize;
+};
+
+}//namespace cocos2d
+
+#endif // __CCBUFFER_RING_H__
@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "CCGeometry.h"
 #include "CCEGLView.h"
 #include "CCGL.h"
+#include "CCFixedTimestep.h"
+#include "CCRenderPipeline.h"
 
 namespace   cocos2d {
 
@@ -196,6 +198,45 @@ public:
 	inline bool isNextDeltaTimeZero(void) { return m_bNextDeltaTimeZero; }
 	void setNextDeltaTimeZero(bool bNextDeltaTimeZero);
 
+	/** Whether or not the scheduler is ticked with a fixed delta time */
+	inline bool isFixedTimestepEnabled(void) { return m_bFixedTimestep; }
+	/** In fixed timestep mode the scheduler is ticked with getFixedTimestep()->getStepDelta()
+	 as many times as fit in the time elapsed, up to getMaxSubsteps() times per frame, instead
+	 of once with the duration of the last frame.
+	 Nodes can smooth their rendering with getInterpolationAlpha().
+	 */
+	void setFixedTimestepEnabled(bool bEnabled);
+
+	/** Measures the frames and holds the fixed timestep settings (tick rate, max substeps) */
+	inline CCFixedTimestep* getFixedTimestep(void) { return m_pFixedTimestep; }
+
+	/** How far the displayed frame is between the last fixed step and the next one, 0 ~ 1.
+	 Render at previousState + (currentState - previousState) * alpha.
+	 Always 1 when the fixed timestep mode is off.
+	 */
+	float getInterpolationAlpha(void);
+
+	/** Frame time histogram and missed deadlines, kept in both modes */
+	inline const ccFramePacingStats& getFramePacingStats(void) { return m_pFixedTimestep->getStats(); }
+
+	/** Replaces the clock measuring the frames, NULL restores the default monotonic one.
+	 Useful to drive the director with a CCManualFrameClock in tests.
+	 */
+	void setFrameClock(CCFrameClock *pClock);
+
+	/** delta time of the last frame, as measured by the frame clock */
+	inline ccTime getDeltaTime(void) { return m_fDeltaTime; }
+
+	/** Whether or not the frames are executed and presented on a render thread */
+	inline bool isRenderPipelined(void) { return m_pRenderPipeline->isRunning(); }
+	/** In pipelined mode each frame is recorded into a command list that a render
+	 thread executes and presents while the next frame is updated. See CCRenderPipeline
+	 for what the recording captures.
+	 */
+	void setRenderPipelined(bool bPipelined);
+
+	inline CCRenderPipeline* getRenderPipeline(void) { return m_pRenderPipeline; }
+
 	/** Whether or not the Director is paused */
 	inline bool isPaused(void) { return m_bPaused; }
     
@@ -445,8 +486,12 @@ protected:
 	/* scheduled scenes */
 	CCMutableArray<CCScene*> *m_pobScenesStack;
 	
-	/* last time the main loop was updated */
-	struct cc_timeval *m_pLastUpdate;
+	/* measures the frames, and splits them into fixed steps in fixed timestep mode */
+	CCFixedTimestep *m_pFixedTimestep;
+	bool m_bFixedTimestep;
+
+	/* records the frames and renders them on its thread in pipelined mode */
+	CCRenderPipeline *m_pRenderPipeline;
 
 	/* delta time since last tick to main loop */
 	ccTime m_fDeltaTime;
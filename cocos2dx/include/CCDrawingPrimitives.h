@@ -28,6 +28,7 @@ THE SOFTWARE.
 #ifndef __CCDRAWING_PRIMITIVES__
 #define __CCDRAWING_PRIMITIVES__
 #include <fstream>
+#include <vector>
 #include "cocos2d.h"	
 /**
  @file
@@ -42,7 +43,13 @@ THE SOFTWARE.
  You can change the color, width and other property by calling the
  glColor4ub(), glLineWidth(), glPointSize().
  
- @warning These functions draws the Line, Point, Polygon, immediately. They aren't batched. If you are going to make a game that depends on these primitives, I suggest creating a batch.
+ The primitives are batched: each call appends its points, lines or triangles,
+ in the color and transform current at the time of the call, and ccDrawFlush()
+ draws everything appended since the last flush in the order of the calls, with
+ one draw call per run of consecutive calls drawing the same kind of primitive
+ (filled polygons are triangles, the other shapes lines). CCNode::visit() flushes
+ after the draw() of each node and CCDirector after each frame, so a draw() only
+ has to flush by itself when it issues other draws after its primitives.
  */
 
 #include "CCGeometry.h"	// for CCPoint
@@ -82,50 +89,47 @@ void CC_DLL ccDrawQuadBezier(const CCPoint& origin, const CCPoint& control, cons
  */
 void CC_DLL ccDrawCubicBezier(const CCPoint& origin, const CCPoint& control1, const CCPoint& control2, const CCPoint& destination, int segments);
 
+/** draws the primitives batched since the last flush, returns how many there were */
+unsigned int CC_DLL ccDrawFlush(void);
+
 enum DXDrawingType
 {
 	DrawingPoints  = 0,
 	DrawingLines   = 1,
 	DrawingTrangles  = 2,
 	DrawingPolyClosed  = 3,
-	DrawingPolyOpened  = 4
+	DrawingPolyOpened  = 4,
+	// triangle fan around the first vertex
+	DrawingPolyFilled  = 5
 };
 
+class CCRenderProgram;
+
 class CC_DLL CCDrawingPrimitive
 {
 public:
 	static void D3DColor4f(float red, float green, float blue, float alpha);
+	/** appends vertices in points, transformed by the current matrix, to the batch */
 	static void Drawing(ccVertex2F *vertices, unsigned int numberOfPoints, DXDrawingType Type);
 	static void Drawing3D(ccVertex3F *vertices, unsigned int numberOfPoints, DXDrawingType Type);
 
+	/** primitives drawn by the last flush that had any */
+	static unsigned int getLastFlushPrimitives(void);
+	/** flushes that drew something since the start */
+	static unsigned int getFlushCount(void);
+
+	static CCDrawingPrimitive* sharedDrawingPrimitive(void);
+
 	CCDrawingPrimitive();
 	~CCDrawingPrimitive();
 
-	void initVertexBuffer(unsigned int numberOfPoints);
 	bool InitializeShader();
-
-	void RenderVertexBuffer();
-	void RenderVertexBuffer3D();
+	/** vertices or vertices3D, the other one is NULL */
+	void append(const ccVertex2F *vertices, const ccVertex3F *vertices3D, unsigned int numberOfPoints, DXDrawingType type);
+	unsigned int flush(void);
 	bool SetShaderParameters(DirectX::XMMATRIX &viewMatrix, DirectX::XMMATRIX &projectionMatrix);
-	void RenderShader();
-	void Render();
-	void Render3D();
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage,WCHAR* shaderFilename);
 
-	//BOOL initialized;
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11Buffer* m_vertexBuffer;
-	//ID3D11Buffer* m_indexBuffer;
-	ID3D11Buffer* m_matrixBuffer;
-
-	DXDrawingType  m_DarwingType;
-	int	m_vertexAmount;
-	ccVertex2F *m_vertices;
-	ccVertex3F *m_vertices3D;
-	DirectX::XMFLOAT4 m_currentColor;
-
 	struct MatrixBufferType
 	{
 		DirectX::XMMATRIX view;
@@ -138,6 +142,33 @@ public:
 		DirectX::XMFLOAT4 color;
 	};
 
+	enum
+	{
+		kKindTriangles,
+		kKindLines,
+		kKindPoints,
+		kKindCount
+	};
+
+	// consecutive vertices of one kind, drawn with a single draw call
+	typedef struct _ccPrimitiveRun
+	{
+		unsigned int uKind;
+		unsigned int uCount;
+	} ccPrimitiveRun;
+
+	CCRenderProgram* m_pProgram;
+
+	// vertices waiting for the flush in the order of the calls, already transformed by
+	// the matrix of their call, copied into the geometry ring of CCDynamicBuffers by flush()
+	std::vector<VertexType> m_vertices;
+	std::vector<ccPrimitiveRun> m_runs;
+	// the projection they are drawn with, a new one flushes them first
+	DirectX::XMFLOAT4X4 m_projection;
+	DirectX::XMFLOAT4 m_currentColor;
+
+	unsigned int m_uLastFlushPrimitives;
+	unsigned int m_uFlushCount;
 };
 
 }//namespace   cocos2d 
@@ -0,0 +1,177 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCDYNAMIC_ATLAS_H__
+#define __CCDYNAMIC_ATLAS_H__
+
+#include "CCObject.h"
+#include "CCTexture2D.h"
+#include "support/CCMaxRectsPacker.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cocos2d {
+
+class CCSpriteFrame;
+class CCImage;
+
+/** counters of a CCDynamicAtlas, areas are in pixels */
+typedef struct _ccDynamicAtlasStats
+{
+	unsigned int uPages;
+	//! images packed on the pages
+	unsigned int uImages;
+	//! images too big for a page, or added when no page had room, loaded as their own texture
+	unsigned int uFallbacks;
+	//! area of the packed images, gutters included
+	unsigned int uUsedArea;
+	//! area of all the pages
+	unsigned int uPageArea;
+	//! uUsedArea / uPageArea
+	float fEfficiency;
+	//! memory of the pages
+	unsigned int uPageBytes;
+	//! memory the packed images would use as their own textures
+	unsigned int uStandaloneBytes;
+	//! totals since the atlas was created
+	unsigned int uRepacks;
+	unsigned int uEvictions;
+} ccDynamicAtlasStats;
+
+/** @brief Singleton packing small images into shared RGBA8888 pages at runtime.
+
+Each image loaded on its own is a texture switch, which breaks the batching of
+the sprites. addImage() copies the image to a free spot of a page and returns
+a sprite frame pointing to it, so sprites made of unrelated images share their
+texture as if they came from a packed sprite sheet. The frame is also added to
+CCSpriteFrameCache under the image path.
+
+The images are placed with the MaxRects algorithm and get a one pixel gutter
+repeating their edges, so linear filtering doesn't bleed the neighbours in.
+The pages have their alpha premultiplied.
+
+When no page has room and getMaxPages() are in use, the atlas tries in order to:
+- pack again a page with enough free space left by removeImage(), into a new texture
+- evict the least recently used page that no sprite uses anymore
+- load the image with CCTextureCache, as if there was no atlas
+A sprite keeps the texture of its page, the memory of a repacked or evicted page
+is only freed once no sprite uses it.
+*/
+class CC_DLL CCDynamicAtlas : public CCObject
+{
+public:
+	CCDynamicAtlas();
+	virtual ~CCDynamicAtlas();
+
+	static CCDynamicAtlas* sharedDynamicAtlas(void);
+	static void purgeSharedDynamicAtlas(void);
+
+	/** Returns the frame of an image, packing it on a page the first time.
+	NULL if the image can't be loaded.
+	*/
+	CCSpriteFrame* addImage(const char *path);
+
+	/** Frees the spot of an image so that a repack can reuse it, and removes its frame from CCSpriteFrameCache.
+	The sprites still showing it keep their pixels until the page is packed again.
+	*/
+	void removeImage(const char *path);
+
+	/** Releases the pages no sprite uses anymore, with their images */
+	void removeUnusedPages(void);
+
+	/** Releases every page and fallback texture */
+	void removeAllImages(void);
+
+	/** size of the pages in pixels, 1024 by default. Only the pages created later have the new size. */
+	inline unsigned int getPageSize(void) { return m_uPageSize; }
+	void setPageSize(unsigned int uPageSize);
+
+	/** pages created before the images are repacked or evicted, 4 by default */
+	inline unsigned int getMaxPages(void) { return m_uMaxPages; }
+	inline void setMaxPages(unsigned int uMaxPages) { m_uMaxPages = uMaxPages > 0 ? uMaxPages : 1; }
+
+	/** images with a side longer than this get their own texture, 256 by default */
+	inline unsigned int getMaxImageSize(void) { return m_uMaxImageSize; }
+	inline void setMaxImageSize(unsigned int uMaxImageSize) { m_uMaxImageSize = uMaxImageSize; }
+
+	/** page the image is packed on, NULL if it isn't on a page */
+	CCTexture2D* pageForImage(const char *path);
+
+	const ccDynamicAtlasStats& getStats(void);
+
+	/** Output to CCLOG the counters and the pages */
+	void dumpStats(void);
+
+protected:
+	struct Page
+	{
+		CCTexture2D *pTexture;
+		CCMaxRectsPacker packer;
+		unsigned int uImages;
+		unsigned int uLastUsed;
+		//! removeImage() freed spots of the page
+		bool bHoles;
+	};
+
+	struct Entry
+	{
+		CCSpriteFrame *pFrame;
+		//! NULL for a fallback
+		Page *pPage;
+		//! spot on the page, gutter included
+		unsigned int x, y, w, h;
+		//! name of the frame in CCSpriteFrameCache
+		std::string name;
+	};
+
+	typedef std::map<std::string, Entry> EntryMap;
+
+	Page* createPage(void);
+	void releasePage(Page *pPage);
+	// places a w x h spot, making room if needed
+	Page* allocate(unsigned int w, unsigned int h, unsigned int &x, unsigned int &y);
+	bool repackPage(Page *pPage);
+	// creates the frame of an entry, or moves it to the new spot after a repack
+	void setEntryFrame(Entry &entry);
+	// releases the frame of an entry and removes it from CCSpriteFrameCache
+	void releaseEntry(Entry &entry);
+	// frame of a whole texture of CCTextureCache, pImage NULL loads it from the file
+	CCSpriteFrame* addFallback(const std::string& key, const char *path, CCImage *pImage);
+	// true when only the atlas and the frames of its images retain the page
+	bool isPageUnused(Page *pPage);
+
+	EntryMap m_entries;
+	std::vector<Page*> m_pages;
+	unsigned int m_uPageSize;
+	unsigned int m_uMaxPages;
+	unsigned int m_uMaxImageSize;
+	unsigned int m_uClock;
+	ccDynamicAtlasStats m_tStats;
+};
+
+}//namespace cocos2d
+
+#endif // __CCDYNAMIC_ATLAS_H__
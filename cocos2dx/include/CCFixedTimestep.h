@@ -0,0 +1,155 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCFIXED_TIMESTEP_H__
+#define __CCFIXED_TIMESTEP_H__
+
+#include "CCObject.h"
+#include "ccTypes.h"
+
+namespace cocos2d {
+
+/** number of 1 ms buckets of ccFramePacingStats::uFrameTimeHistogram */
+#define kCCFrameTimeHistogramBuckets 64
+
+/** frame pacing counters of a CCFixedTimestep, times are in seconds */
+typedef struct _ccFramePacingStats
+{
+	//! frames measured since the last reset
+	unsigned int uFrames;
+	//! frames longer than 1.5 times the deadline, at least one vsync was missed
+	unsigned int uMissedDeadlines;
+	//! fixed steps run
+	unsigned int uSteps;
+	//! fixed steps skipped because of the max substeps clamp
+	unsigned int uDroppedSteps;
+	double dLastFrameTime;
+	double dMaxFrameTime;
+	double dTotalFrameTime;
+	//! uFrameTimeHistogram[i] counts the frames that took i to i+1 ms, the last bucket also counts the slower ones
+	unsigned int uFrameTimeHistogram[kCCFrameTimeHistogramBuckets];
+} ccFramePacingStats;
+
+/** @brief Monotonic high resolution clock measuring the frames.
+Unlike CCTime::gettimeofdayCocos2d it doesn't follow the wall clock, so it never
+jumps or goes backwards. Subclass it to drive the frame timing from a test.
+*/
+class CC_DLL CCFrameClock : public CCObject
+{
+public:
+	/** seconds since an arbitrary origin */
+	virtual double now(void);
+};
+
+/** @brief Clock that only moves when told to */
+class CC_DLL CCManualFrameClock : public CCFrameClock
+{
+public:
+	CCManualFrameClock(void) : m_dTime(0) {}
+
+	virtual double now(void) { return m_dTime; }
+
+	inline void advance(double dSeconds) { m_dTime += dSeconds; }
+	inline void setTime(double dSeconds) { m_dTime = dSeconds; }
+
+protected:
+	double m_dTime;
+};
+
+/** @brief Measures the frames and turns them into fixed simulation steps.
+
+The duration of each frame is added to an accumulator and accumulate() returns
+how many steps of getStepDelta() fit in it. What is left is less than a step,
+getInterpolationAlpha() gives it as a fraction of a step so that rendering can
+blend between the last two simulated states.
+
+When a frame is so long that more than getMaxSubsteps() steps are due, the
+extra steps are dropped instead of being caught up on the next frames: the
+simulation slows down instead of spiraling into ever longer frames.
+
+CCDirector measures every frame with one, see CCDirector::setFixedTimestepEnabled().
+*/
+class CC_DLL CCFixedTimestep : public CCObject
+{
+public:
+	CCFixedTimestep(void);
+	virtual ~CCFixedTimestep(void);
+
+	/** pClock NULL uses a CCFrameClock */
+	bool initWithClock(CCFrameClock *pClock);
+
+	inline CCFrameClock* getClock(void) { return m_pClock; }
+	/** NULL restores a CCFrameClock. The next frame is measured from the new clock's now(). */
+	void setClock(CCFrameClock *pClock);
+
+	/** steps per second, 60 by default */
+	inline double getTickRate(void) { return m_dTickRate; }
+	void setTickRate(double dTicksPerSecond);
+	inline ccTime getStepDelta(void) { return (ccTime)(1.0 / m_dTickRate); }
+
+	/** most steps run for a single frame, 5 by default */
+	inline unsigned int getMaxSubsteps(void) { return m_uMaxSubsteps; }
+	void setMaxSubsteps(unsigned int uMaxSubsteps);
+
+	/** expected duration of a frame in seconds, used to count the missed deadlines */
+	inline double getFrameDeadline(void) { return m_dFrameDeadline; }
+	inline void setFrameDeadline(double dSeconds) { m_dFrameDeadline = dSeconds; }
+
+	/** Reads the clock and adds the frame to the stats.
+	@return the time since the previous call (or reset()), in seconds
+	*/
+	double measureFrame(void);
+
+	/** Adds dt seconds to the accumulator.
+	@return the number of steps to run for this frame, at most getMaxSubsteps()
+	*/
+	unsigned int accumulate(double dt);
+
+	/** how far the time is between the last step and the next one, 0 ~ 1 */
+	inline float getInterpolationAlpha(void) { return m_dAccumulator > 0 ? (float)(m_dAccumulator * m_dTickRate) : 0.0f; }
+
+	/** Empties the accumulator and measures the next frame from now. Used after a pause. */
+	void reset(void);
+
+	inline const ccFramePacingStats& getStats(void) { return m_tStats; }
+	void resetStats(void);
+
+	/** Frame time under which fPercent (0 ~ 100) of the measured frames are, with a 1 ms resolution.
+	Frames slower than the histogram count as dMaxFrameTime.
+	*/
+	double getFrameTimePercentile(float fPercent);
+
+protected:
+	CCFrameClock *m_pClock;
+	double m_dLastTime;
+	double m_dAccumulator;
+	double m_dTickRate;
+	unsigned int m_uMaxSubsteps;
+	double m_dFrameDeadline;
+	ccFramePacingStats m_tStats;
+};
+
+}//namespace cocos2d
+
+#endif // __CCFIXED_TIMESTEP_H__
@@ -161,6 +161,7 @@ All features from CCLayer are valid, plus the following new features:
 - RGB colors
 */
 class CCDXLayerColor;
+class CCRenderProgram;
 class CC_DLL CCLayerColor : public CCLayer , public CCRGBAProtocol, public CCBlendProtocol
 {
 protected:
@@ -214,18 +215,13 @@ protected:
 class CC_DLL CCDXLayerColor
 {
 public:
-	ID3D11Buffer *m_vertexBuffer;
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11Buffer* m_matrixBuffer;
+	CCRenderProgram* m_pProgram;
 
 	CCDXLayerColor();
 	~CCDXLayerColor();
 	void FreeBuffer();
 	void setIsInit(bool isInit);
-	void initVertexBuffer();
-	void RenderVertexBuffer(ccVertex2F* squareVertices,ccColor4B* squareColors);
+	bool RenderVertexBuffer(ccVertex2F* squareVertices,ccColor4B* squareColors);
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 	bool InitializeShader();
 	bool SetShaderParameters(DirectX::XMMATRIX &viewMatrix,DirectX::XMMATRIX &projectionMatrix);
@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include "CCMenuItem.h"
 #include "CCLayer.h"
 
+#include <vector>
+
 namespace cocos2d{
 
 	typedef enum  
@@ -57,6 +59,8 @@ namespace cocos2d{
 		CCMenu()
 			: m_cOpacity(0)
 			, m_pSelectedItem(NULL)
+			, m_uItemBoundsEpoch(0)
+			, m_bItemBoundsValid(false)
 		{}
 		virtual ~CCMenu(){}
 
@@ -112,6 +116,9 @@ namespace cocos2d{
 		virtual void ccTouchCancelled(CCTouch *touch, CCEvent* event);
 		virtual void ccTouchMoved(CCTouch* touch, CCEvent* event);
 
+		/** union of the world bounding boxes of the items */
+		virtual bool getTouchBounds(CCRect& rect);
+
         /**
         @since v0.99.5
         override onExit
@@ -123,8 +130,17 @@ namespace cocos2d{
 
 	protected:
 		CCMenuItem* itemForTouch(CCTouch * touch);
+		/** computes the world bounding boxes of the items again if the menu, its items or an ancestor moved */
+		void updateItemBounds(void);
+
 		tCCMenuState m_eState;
 		CCMenuItem *m_pSelectedItem;		
+
+		//! world bounding box of each child, in points, in the children order
+		std::vector<CCRect> m_tItemBounds;
+		CCRect m_tItemBoundsUnion;
+		unsigned int m_uItemBoundsEpoch;
+		bool m_bItemBoundsValid;
 	};
 }
 
@@ -41,6 +41,8 @@ namespace   cocos2d {
 	class CCAction;
 	class CCRGBAProtocol;
 	class CCLabelProtocol;
+	class CCNodeTagIndex;
+	class CCNodePool;
 
 	enum {
 		kCCNodeTagInvalid = -1,
@@ -194,6 +196,12 @@ namespace   cocos2d {
         /** Whether of not the node is visible. Default is true */
         CC_PROPERTY(bool, m_bIsVisible, IsVisible)
 
+        /** Whether the draws of the node and of its children may be reordered to share their
+         shader, texture and blend states, see CCRenderQueue. Only for nodes whose children
+         don't overlap, or don't blend. Default is false
+         */
+        CC_PROPERTY(bool, m_bIsOrderIndependent, IsOrderIndependent)
+
         /** anchorPoint is the point around which all transformations and positioning manipulations take place.
          It's like a pin in the node where it is "attached" to its parent.
          The anchorPoint is normalized, like a percentage. (0,0) means the bottom-left corner and (1,1) means the top-right corner.
@@ -258,6 +266,19 @@ namespace   cocos2d {
 
         int m_nScriptHandler;
 
+		//! children by tag, built past getTagIndexThreshold() children
+		CCNodeTagIndex *m_pTagIndex;
+
+		//! the pool the node sits idle in, NULL while it is in use or not pooled
+		CCNodePool *m_pIdlePool;
+
+		//! getTransformEpoch() at the last change of the transform or of the parent of the node
+		unsigned int m_uTransformEpoch;
+		//! getTransformEpoch() at the last change of the node or of its descendants
+		unsigned int m_uSubtreeEpoch;
+
+		friend class CCNodePool;
+
 	private:
 
 		//! lazy allocs
@@ -271,6 +292,11 @@ namespace   cocos2d {
 
 		void detachChild(CCNode *child, bool doCleanup);
 
+		//! bumps the epochs of the node and the subtree epochs of its ancestors
+		void markTransformChanged(void);
+		//! bumps the subtree epochs of the node and of its ancestors
+		void markChildrenChanged(void);
+
 		typedef void (CCNode::*callbackFunc)(void);
 
 		void arrayMakeObjectsPerformSelector(CCArray* pArray, callbackFunc func);
@@ -367,6 +393,13 @@ namespace   cocos2d {
          */
 		CCNode * getChildByTag(int tag);
 
+		/** Nodes having more children than this index them by tag, which makes
+		getChildByTag and removeChildByTag O(1). 0 disables the index for the nodes
+		that don't have one yet. Default is CC_NODE_TAG_INDEX_THRESHOLD.
+		*/
+		static void setTagIndexThreshold(unsigned int uThreshold);
+		static unsigned int getTagIndexThreshold(void);
+
 		/** Reorders a child according to a new z value.
          * The child MUST be already added.
          */
@@ -540,6 +573,19 @@ namespace   cocos2d {
          */
 		CCAffineTransform worldToNodeTransform(void);
 
+		/** Counter bumped whenever a node is moved, scaled, rotated, skewed or resized,
+		and when children are added, removed or reordered. When it didn't change, no
+		node moved at all.
+		*/
+		static unsigned int getTransformEpoch(void);
+
+		/** Changes when the node or one of its descendants may have moved in world space:
+		a transform change of the node, of an ancestor or of a descendant, or children
+		added, removed or reordered below it. Caches of world space positions compare it
+		to know when they have to be computed again. It walks up the ancestors.
+		*/
+		unsigned int getWorldTransformEpoch(void);
+
 		/** Converts a Point to node (local) space coordinates. The result is in Points.
          @since v0.7.1
          */
@@ -0,0 +1,155 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCNODE_POOL_H__
+#define __CCNODE_POOL_H__
+
+#include "CCNode.h"
+#include "CCSprite.h"
+#include <vector>
+
+namespace cocos2d {
+
+/** counters of a CCNodePool */
+typedef struct _ccNodePoolStats
+{
+	//! acquire() calls served with an idle node
+	unsigned int uHits;
+	//! acquire() calls that had to create a node
+	unsigned int uMisses;
+	//! acquire() calls that returned NULL since the pool was full
+	unsigned int uRefusals;
+	//! nodes created, prefilled ones included
+	unsigned int uCreated;
+	unsigned int uInUse;
+	unsigned int uPeakInUse;
+} ccNodePoolStats;
+
+/** @brief Recycles the nodes of a kind that are spawned and removed often, e.g. bullets or enemies.
+
+Creating a node runs its init, the texture cache lookup, the quad setup, and
+removing it with cleanup frees it with its actions. The pool creates the nodes
+once instead: acquire() hands out an idle node, reset to the state it was created
+in, and recycle() takes it back. Neither allocates once the pool is prefilled.
+
+The pool retains every node it created, the ones in use included: acquire() doesn't
+retain the node for the caller, who only adds it to a parent. The pool grows by one
+node when acquire() finds no idle node, up to getMaxSize() nodes.
+
+Subclasses implement createNode(), and extend resetNode() when their nodes have
+state of their own to reset. See CCSpritePool.
+*/
+class CC_DLL CCNodePool : public CCObject
+{
+public:
+	CCNodePool(void);
+	virtual ~CCNodePool(void);
+
+	/** Creates uPrefill nodes right away
+	@param uMaxSize the pool never holds more nodes, 0 means no limit
+	*/
+	bool initWithCapacity(unsigned int uPrefill, unsigned int uMaxSize);
+
+	/** An idle node, or a new one when none is idle
+	@return NULL when the pool holds getMaxSize() nodes and none is idle
+	*/
+	CCNode* acquire(void);
+
+	/** Takes back a node returned by acquire(). It is removed from its parent,
+	its actions and scheduled selectors are stopped, it is reset and becomes idle.
+	A node must be recycled once per acquire().
+	*/
+	void recycle(CCNode *pNode);
+
+	/** Creates nodes until uCount are idle, within the size limit */
+	void prefill(unsigned int uCount);
+
+	/** Releases the idle nodes, the nodes in use are not affected */
+	void removeIdleNodes(void);
+
+	inline unsigned int getMaxSize(void) { return m_uMaxSize; }
+	void setMaxSize(unsigned int uMaxSize);
+	inline unsigned int getIdleCount(void) { return (unsigned int)m_idleNodes.size(); }
+
+	inline const ccNodePoolStats& getStats(void) { return m_tStats; }
+	void resetStats(void);
+
+protected:
+	/** A new node with a retain count of 1, not autoreleased. NULL if it can't be created */
+	virtual CCNode* createNode(void) = 0;
+
+	/** Puts back the transform, visibility, tag, user data, color and opacity of
+	the node, as the first node the pool created had them
+	*/
+	virtual void resetNode(CCNode *pNode);
+
+	/** creates and retains a node, records the prototype state from the first one */
+	CCNode* newNode(void);
+	bool isFull(void);
+
+	//! every node created, retained
+	std::vector<CCNode*> m_nodes;
+	//! the idle ones among them, not retained again
+	std::vector<CCNode*> m_idleNodes;
+	unsigned int m_uMaxSize;
+	bool m_bPrototypeKnown;
+	CCPoint m_tAnchorPoint;
+	bool m_bIsRelativeAnchorPoint;
+	ccColor3B m_tColor;
+	CCubyte m_cOpacity;
+	ccNodePoolStats m_tStats;
+};
+
+/** @brief CCNodePool of CCSprite showing a sprite frame.
+A recycled sprite also gets back the frame, the flips and the blend function.
+*/
+class CC_DLL CCSpritePool : public CCNodePool
+{
+public:
+	CCSpritePool(void);
+	virtual ~CCSpritePool(void);
+
+	/** The sprites show the whole image, see CCNodePool::initWithCapacity() */
+	static CCSpritePool* poolWithFile(const char *pszFileName, unsigned int uPrefill, unsigned int uMaxSize);
+	static CCSpritePool* poolWithSpriteFrame(CCSpriteFrame *pSpriteFrame, unsigned int uPrefill, unsigned int uMaxSize);
+
+	bool initWithFile(const char *pszFileName, unsigned int uPrefill, unsigned int uMaxSize);
+	bool initWithSpriteFrame(CCSpriteFrame *pSpriteFrame, unsigned int uPrefill, unsigned int uMaxSize);
+
+	/** acquire(), cast */
+	inline CCSprite* acquireSprite(void) { return (CCSprite*)acquire(); }
+
+	inline CCSpriteFrame* getSpriteFrame(void) { return m_pSpriteFrame; }
+
+protected:
+	virtual CCNode* createNode(void);
+	virtual void resetNode(CCNode *pNode);
+
+	CCSpriteFrame *m_pSpriteFrame;
+	ccBlendFunc m_tBlendFunc;
+};
+
+}//namespace cocos2d
+
+#endif // __CCNODE_POOL_H__
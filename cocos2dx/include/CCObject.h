@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include "CCCommon.h"
 #include "ccTypes.h"
+#include "CCSlabAllocator.h"
 
 namespace   cocos2d {
 class CCZone;
@@ -53,6 +54,8 @@ protected:
     unsigned int		m_uReference;
     // is the object autoreleased
     bool		m_bManaged;		
+    // slot in the autorelease pool, valid while m_bManaged is set
+    unsigned int		m_uAutoreleasePoolIndex;
 public:
     CCObject(void);
     virtual ~CCObject(void);
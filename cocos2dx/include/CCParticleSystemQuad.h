@@ -33,6 +33,7 @@ THE SOFTWARE.
 namespace cocos2d {
 
 class CCDXParticleSystemQuad;
+class CCRenderProgram;
 class CCSpriteFrame;
 /** @brief CCParticleSystemQuad is a subclass of CCParticleSystem
 
@@ -100,19 +101,15 @@ public:
 	CCDXParticleSystemQuad();
 	~CCDXParticleSystemQuad();
 
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_inputLayout;
-	ID3D11Buffer* m_matrixBuffer;
+	CCRenderProgram* m_pProgram;
 	ID3D11Buffer* m_indexBuffer;
-	ID3D11Buffer* m_vertexBuffer;
 
 	void FreeBuffer();
 	void setIsInit(bool isInit);
 	bool InitializeShader();
 
-	void initVertexAndIndexBuffer(unsigned short* indices,unsigned int uTotalParticles);
-	void RenderVertexBuffer(ccV2F_C4B_T2F_Quad *quad,unsigned int uTotalParticles);
+	void initIndexBuffer(unsigned short* indices,unsigned int uTotalParticles);
+	bool RenderVertexBuffer(ccV2F_C4B_T2F_Quad *quad,unsigned int particleIdx);
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 	bool SetShaderParameters(DirectX::XMMATRIX &viewMatrix, DirectX::XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture);
 	void RenderShader(unsigned int particleIdx,CCTexture2D* texture);
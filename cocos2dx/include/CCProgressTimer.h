@@ -30,6 +30,7 @@ THE SOFTWARE.
 namespace cocos2d
 {
 	class CCDXProgressTimer;
+	class CCRenderProgram;
 /** Types of progress
  @since v0.99.1
  */
@@ -103,16 +104,12 @@ protected:
 class CC_DLL CCDXProgressTimer
 {
 public:
-	ID3D11Buffer *m_vertexBuffer;
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11Buffer* m_matrixBuffer;
+	CCRenderProgram* m_pProgram;
 
 	CCDXProgressTimer();
 	~CCDXProgressTimer();
 	void FreeBuffer();
-	void initVertexBuffer(ccV2F_C4B_T2F *vertexData,int& vertexDataCount,CCProgressTimerType eType);
+	bool initVertexBuffer(ccV2F_C4B_T2F *vertexData,int& vertexDataCount,CCProgressTimerType eType);
 	void setIsInit(bool isInit);
 	void RenderVertexBuffer();
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
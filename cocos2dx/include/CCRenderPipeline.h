@@ -0,0 +1,158 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCRENDER_PIPELINE_H__
+#define __CCRENDER_PIPELINE_H__
+
+#include "CCObject.h"
+#include "CCFixedTimestep.h"
+#include <d3d11_1.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace cocos2d {
+
+/** counters of a CCRenderPipeline, times are in seconds */
+typedef struct _ccRenderPipelineStats
+{
+	//! frames handed to the render thread
+	unsigned int uFramesSubmitted;
+	//! frames executed by the render thread
+	unsigned int uFramesExecuted;
+	//! time the main thread spent closing the recording of the last frame
+	double dLastRecordTime;
+	//! time the main thread waited for the render thread to take the previous frame
+	double dLastSubmitWait;
+	double dTotalSubmitWait;
+	//! time the render thread spent executing and presenting the last frame
+	double dLastReplayTime;
+	double dTotalReplayTime;
+} ccRenderPipelineStats;
+
+/** @brief Where the recorded frames end up.
+The default one executes them on the immediate context and presents the swap chain.
+Both methods are called on the render thread when the pipeline runs, on the main
+thread otherwise.
+*/
+class CC_DLL CCRenderBackend : public CCObject
+{
+public:
+	virtual void execute(ID3D11DeviceContext *pContext, ID3D11CommandList *pCommands);
+	virtual void present(void);
+};
+
+/** @brief Backend that never shows the frames.
+The commands are executed and flushed to the GPU but nothing is presented, so
+the frame rate isn't capped by the vsync. Used to measure the CPU throughput.
+*/
+class CC_DLL CCHeadlessRenderBackend : public CCRenderBackend
+{
+public:
+	virtual void present(void);
+};
+
+/** @brief Renders frame N-1 on a render thread while frame N is updated.
+
+While the pipeline runs, CCEGLView::GetDeviceContext() returns a deferred
+context: everything the nodes draw is recorded into a command list instead of
+being sent to the driver. At the end of the frame the list is closed and handed
+to the render thread, which executes and presents it while the main thread goes
+on with the next tick. At most one frame waits in the queue, submitFrame()
+blocks while the render thread hasn't taken the previous one.
+
+What is captured: a command list is an immutable snapshot of the frame. The
+vertices, colors, texture coordinates and matrices a node draws are copied into
+it when draw() runs, and it keeps a reference on every texture, buffer and state
+it uses. So once visit() returned, the main thread can move, remove or release
+nodes and textures freely. What isn't: the immediate context itself. Reading a
+render target back (CCRenderTexture::saveBuffer) needs finish() first, and code
+using the immediate context directly, like the Direct2D text rendering, has to
+hold CCEGLView::lockImmediateContext().
+
+The pipeline state (render targets, viewport, blending, depth and rasterizer
+states) is carried from one command list to the next, the nodes see the same
+state as when they render directly.
+*/
+class CC_DLL CCRenderPipeline : public CCObject
+{
+public:
+	CCRenderPipeline(void);
+	virtual ~CCRenderPipeline(void);
+
+	bool init(void);
+
+	inline bool isRunning(void) { return m_pThread != NULL; }
+
+	/** Starts recording into a deferred context and the render thread.
+	@return false if the device can't create a deferred context
+	*/
+	bool start(void);
+	/** Executes the queued frames and stops the render thread, the main thread renders directly again */
+	void stop(void);
+
+	/** Closes the recording of the current frame and queues it for the render thread.
+	@param bPresent false only executes the commands, see finish()
+	*/
+	void submitFrame(bool bPresent);
+
+	/** Executes everything recorded so far and waits until the render thread is idle.
+	Does nothing when the pipeline doesn't run.
+	*/
+	void finish(void);
+
+	/** finish() and unbind the render targets of the deferred context, so the swap chain can be resized */
+	void detachTargets(void);
+
+	/** the backend the frames are executed and presented with, a CCRenderBackend by default */
+	inline CCRenderBackend* getBackend(void) { return m_pBackend; }
+	/** NULL restores a CCRenderBackend */
+	void setBackend(CCRenderBackend *pBackend);
+
+	/** The counters are updated by both threads, read them on the main thread between frames */
+	inline const ccRenderPipelineStats& getStats(void) { return m_tStats; }
+	void resetStats(void);
+
+protected:
+	void renderThreadMain(void);
+	/** waits until the render thread has nothing queued nor executing */
+	void waitIdle(void);
+
+	ID3D11DeviceContext1 *m_pDeferredContext;
+	std::thread *m_pThread;
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCondition;
+	//! the frame waiting for the render thread, NULL if none
+	ID3D11CommandList *m_pPendingCommands;
+	bool m_bPendingPresent;
+	bool m_bExecuting;
+	bool m_bQuit;
+	CCRenderBackend *m_pBackend;
+	CCFrameClock *m_pClock;
+	ccRenderPipelineStats m_tStats;
+};
+
+}//namespace cocos2d
+
+#endif // __CCRENDER_PIPELINE_H__
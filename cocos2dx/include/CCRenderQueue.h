@@ -0,0 +1,238 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCRENDER_QUEUE_H__
+#define __CCRENDER_QUEUE_H__
+
+#include "CCObject.h"
+#include "ccTypes.h"
+#include <d3d11_1.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cocos2d {
+
+/** the pipeline states the queue binds, see ccRenderQueueStats */
+typedef enum
+{
+	kCCRenderStateProgram,
+	kCCRenderStateTexture,
+	kCCRenderStateSampler,
+	kCCRenderStateBlend,
+	kCCRenderStateTopology,
+	kCCRenderStateVertices,
+	kCCRenderStateIndices,
+	kCCRenderStateVSConstants,
+	kCCRenderStatePSConstants,
+	kCCRenderStateCount,
+} ccRenderState;
+
+/** counters of the CCRenderQueue since it was created or since resetStats() */
+typedef struct _ccRenderQueueStats
+{
+	//! draws submitted
+	unsigned int uPackets;
+	//! the ones that were queued and sorted
+	unsigned int uSortedPackets;
+	//! sorted ranges drawn
+	unsigned int uSortedRanges;
+	//! binds issued, per ccRenderState
+	unsigned int uChanges[kCCRenderStateCount];
+	//! binds skipped since the state was bound already, per ccRenderState
+	unsigned int uAvoided[kCCRenderStateCount];
+} ccRenderQueueStats;
+
+/** @brief A vertex shader, its input layout and a pixel shader, shared by the renderers drawing with them.
+Created by CCRenderQueue::programWithShaders(), retain it to keep it.
+*/
+class CC_DLL CCRenderProgram : public CCObject
+{
+public:
+	CCRenderProgram(void);
+	virtual ~CCRenderProgram(void);
+
+	bool initWithShaders(const wchar_t *pszVertexShader, const D3D11_INPUT_ELEMENT_DESC *pLayout, UINT uElements,
+		const wchar_t *pszPixelShader, unsigned int uId);
+
+	inline ID3D11VertexShader* getVertexShader(void) { return m_pVertexShader; }
+	inline ID3D11PixelShader* getPixelShader(void) { return m_pPixelShader; }
+	inline ID3D11InputLayout* getInputLayout(void) { return m_pInputLayout; }
+	/** small and unique, the queue sorts on it */
+	inline unsigned int getId(void) { return m_uId; }
+
+protected:
+	ID3D11VertexShader *m_pVertexShader;
+	ID3D11PixelShader *m_pPixelShader;
+	ID3D11InputLayout *m_pInputLayout;
+	unsigned int m_uId;
+};
+
+/** @brief Singleton the node renderers submit their draws to.
+
+A renderer sets the states of its draw, then calls draw() or drawIndexed(): the
+states are taken as a draw packet and the pending states start over, but for the
+blend function which stays until it is set again. A packet only binds the states
+that differ from the ones bound by the previous packet. A NULL texture, sampler
+or pixel shader constant buffer leaves the bound one.
+
+Between beginUnordered() and endUnordered() the packets are queued, then sorted
+on program, texture and blend function, the order they were submitted in breaking
+ties, and drawn at the end of the range. CCNode opens such a range around the
+nodes whose setIsOrderIndependent(true) was called. Packets whose vertex shader
+constants don't come from the constant ring of CCDynamicBuffers can't wait: the
+packets queued before them are drawn first, then they are.
+
+Whatever changes the render target, the viewport or the depth test has to flush()
+first. Code that binds states by itself, or binds a texture as the render target,
+has to call invalidateState() after.
+*/
+class CC_DLL CCRenderQueue : public CCObject
+{
+public:
+	CCRenderQueue(void);
+	virtual ~CCRenderQueue(void);
+
+	static CCRenderQueue* sharedRenderQueue(void);
+	static void purgeSharedRenderQueue(void);
+
+	bool init(void);
+
+	/** The program of the shaders, loaded with BasicLoader the first time they are asked for
+	@return NULL if the shaders can't be loaded, not retained
+	*/
+	CCRenderProgram* programWithShaders(const wchar_t *pszVertexShader, const D3D11_INPUT_ELEMENT_DESC *pLayout, UINT uElements,
+		const wchar_t *pszPixelShader);
+
+	/** An immutable constant buffer holding uSize bytes of pData, one per content.
+	For constants taking a few values, e.g. flags, so that draws with the same values bind the same buffer.
+	*/
+	ID3D11Buffer* constantBufferWithData(const void *pData, UINT uSize);
+
+	// pending states of the next draw
+
+	void setProgram(CCRenderProgram *pProgram);
+	void setTexture(ID3D11ShaderResourceView *pTexture);
+	void setSampler(ID3D11SamplerState *pSampler);
+	/** CC_* factors like CCEGLView::D3DBlendFunc(), -1 and -1 disable blending. Nothing is
+	bound until a draw, setting it back after a draw costs nothing.
+	*/
+	void setBlendFunc(int sfactor, int dfactor);
+	void setTopology(D3D11_PRIMITIVE_TOPOLOGY eTopology);
+	/** uSlot is 0 or 1 */
+	void setVertexBuffer(UINT uSlot, ID3D11Buffer *pBuffer, UINT uStride, UINT uOffset);
+	/** 16 bit indices */
+	void setIndexBuffer(ID3D11Buffer *pBuffer);
+	/** uConstants 0 binds the whole buffer, otherwise the range of uConstants 16 byte constants from uFirstConstant */
+	void setVSConstants(UINT uSlot, ID3D11Buffer *pBuffer, UINT uFirstConstant, UINT uConstants);
+	void setPSConstants(ID3D11Buffer *pBuffer);
+
+	/** submits the pending states with a Draw() */
+	void draw(UINT uVertexCount, UINT uStartVertex);
+	/** submits the pending states with a DrawIndexed() */
+	void drawIndexed(UINT uIndexCount, UINT uStartIndex, INT nBaseVertex);
+
+	/** the pending states become the ones of the last draw, for a renderer drawing again right after */
+	void repeatStates(void);
+
+	/** Opens a range whose packets may be drawn in any order. Ranges nest, the outermost one draws them */
+	void beginUnordered(void);
+	void endUnordered(void);
+	inline bool isUnordered(void) { return m_nUnorderedDepth > 0; }
+
+	/** draws the queued packets */
+	void flush(void);
+
+	/** forgets the states bound, they are all bound by the next packet */
+	void invalidateState(void);
+
+	/** Called by CCDirector after each frame was drawn, draws what is still queued */
+	void frameEnded(void);
+
+	inline const ccRenderQueueStats& getStats(void) { return m_tStats; }
+	void resetStats(void);
+
+protected:
+	typedef struct _ccDrawPacket
+	{
+		CCRenderProgram *pProgram;
+		ID3D11ShaderResourceView *pTexture;
+		ID3D11SamplerState *pSampler;
+		ccBlendFunc tBlendFunc;
+		D3D11_PRIMITIVE_TOPOLOGY eTopology;
+		ID3D11Buffer *pVertexBuffers[2];
+		UINT uStrides[2];
+		UINT uOffsets[2];
+		ID3D11Buffer *pIndexBuffer;
+		UINT uVSConstantsSlot;
+		ID3D11Buffer *pVSConstants;
+		UINT uFirstConstant;
+		UINT uConstants;
+		ID3D11Buffer *pPSConstants;
+		//! vertices, or indices when there's an index buffer
+		UINT uCount;
+		UINT uStart;
+		INT nBaseVertex;
+		//! submission order
+		unsigned int uSequence;
+	} ccDrawPacket;
+
+	void submit(void);
+	void execute(const ccDrawPacket& packet);
+	/** counts the bind, or the one avoided when bChanges is false */
+	bool countChange(ccRenderState eState, bool bChanges);
+	/** program, texture, blend function, then submission order */
+	static bool packetLess(const ccDrawPacket& a, const ccDrawPacket& b);
+	void retainPacket(ccDrawPacket& packet);
+	void releasePacket(ccDrawPacket& packet);
+	void resetPending(void);
+	void listenToDiscards(bool bListen);
+
+	ccDrawPacket m_tPending;
+	ccDrawPacket m_tLastSubmitted;
+	//! bound by the last packet, NULL or 0 when unknown
+	ccDrawPacket m_tBound;
+	bool m_bBlendBound;
+	//! queued in the unordered range
+	std::vector<ccDrawPacket> m_packets;
+	int m_nUnorderedDepth;
+	unsigned int m_uSequence;
+
+	typedef std::map<std::wstring, CCRenderProgram*> ProgramMap;
+	ProgramMap m_programs;
+	unsigned int m_uNextProgramId;
+
+	typedef struct _ccSharedConstants
+	{
+		std::string data;
+		ID3D11Buffer *pBuffer;
+	} ccSharedConstants;
+	std::vector<ccSharedConstants> m_sharedConstants;
+
+	ccRenderQueueStats m_tStats;
+};
+
+}//namespace cocos2d
+
+#endif // __CCRENDER_QUEUE_H__
@@ -0,0 +1,150 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCRENDER_TARGET_POOL_H__
+#define __CCRENDER_TARGET_POOL_H__
+
+#include "CCObject.h"
+#include "CCMutableArray.h"
+#include "CCTexture2D.h"
+
+namespace cocos2d {
+
+/** what a pooled render target is created for */
+typedef enum
+{
+	//! color buffer only, used by CCRenderTexture
+	kCCRenderTargetUsageColor = 0,
+	//! color buffer plus a depth/stencil buffer, used by the grid effects
+	kCCRenderTargetUsageColorDepth = 1,
+} CCRenderTargetUsage;
+
+/** counters of a CCRenderTargetPool, sizes are in bytes */
+typedef struct _ccRenderTargetPoolStats
+{
+	//! targets created in the current frame
+	unsigned int uAllocationsThisFrame;
+	//! targets handed out again in the current frame
+	unsigned int uReusesThisFrame;
+	//! totals since the pool was created
+	unsigned int uTotalAllocations;
+	unsigned int uTotalReuses;
+	unsigned int uEvictions;
+	//! memory of the idle targets kept by the pool
+	unsigned int uPooledBytes;
+	//! memory of the targets currently handed out
+	unsigned int uInUseBytes;
+	unsigned int uPeakBytes;
+} ccRenderTargetPoolStats;
+
+/** @brief A texture that can be rendered to, with its views.
+Only CCRenderTargetPool creates them.
+*/
+class CC_DLL CCRenderTarget : public CCObject
+{
+public:
+	CCRenderTarget();
+	virtual ~CCRenderTarget();
+
+	bool initWithSize(unsigned int uWidth, unsigned int uHeight, CCTexture2DPixelFormat eFormat, CCRenderTargetUsage eUsage);
+
+	inline CCTexture2D* getTexture(void) { return m_pTexture; }
+	inline ID3D11RenderTargetView* getRenderTargetView(void) { return m_pRenderTargetView; }
+	/** NULL unless the usage is kCCRenderTargetUsageColorDepth */
+	inline ID3D11DepthStencilView* getDepthStencilView(void) { return m_pDepthStencilView; }
+	inline unsigned int getSizeInBytes(void) { return m_uBytes; }
+
+	bool matches(unsigned int uWidth, unsigned int uHeight, CCTexture2DPixelFormat eFormat, CCRenderTargetUsage eUsage);
+
+	/** a target can only be recycled once nothing but the target retains its texture */
+	inline bool isTextureShared(void) { return m_pTexture->retainCount() > 1; }
+
+protected:
+	friend class CCRenderTargetPool;
+
+	CCTexture2D *m_pTexture;
+	ID3D11RenderTargetView *m_pRenderTargetView;
+	ID3D11Texture2D *m_pDepthStencil;
+	ID3D11DepthStencilView *m_pDepthStencilView;
+	CCRenderTargetUsage m_eUsage;
+	unsigned int m_uBytes;
+	unsigned int m_uLastUsedFrame;
+};
+
+/** @brief Singleton that recycles render targets.
+
+Full screen transitions and grid effects need a render target every time they
+start. Creating the D3D textures and views each time causes allocation spikes,
+so the targets are kept here after use and handed out again to the next
+request of the same size, format and usage.
+
+Idle targets are evicted, least recently used first, when the pool holds more
+than getMemoryLimit() bytes.
+*/
+class CC_DLL CCRenderTargetPool : public CCObject
+{
+public:
+	CCRenderTargetPool();
+	virtual ~CCRenderTargetPool();
+
+	static CCRenderTargetPool* sharedRenderTargetPool(void);
+	static void purgeSharedRenderTargetPool(void);
+
+	/** Returns a render target cleared to transparent black, its texture with the
+	default tex parameters (see CCTexture2D::setAntiAliasTexParameters()).
+	The caller owns the returned target and has to give it back with recycle().
+	Sizes are in pixels.
+	*/
+	CCRenderTarget* acquire(unsigned int uWidth, unsigned int uHeight, CCTexture2DPixelFormat eFormat, CCRenderTargetUsage eUsage);
+
+	/** Gives a target obtained with acquire() back to the pool */
+	void recycle(CCRenderTarget *pTarget);
+
+	/** Called by CCDirector after each frame: resets the per frame counters */
+	void frameEnded(void);
+
+	/** bytes the idle targets may use before the least recently used are released */
+	inline unsigned int getMemoryLimit(void) { return m_uMemoryLimit; }
+	void setMemoryLimit(unsigned int uBytes);
+
+	/** Releases every idle target. Targets in use are not affected. */
+	void removeUnusedTargets(void);
+
+	inline const ccRenderTargetPoolStats& getStats(void) { return m_tStats; }
+
+	/** Output to CCLOG the counters and the idle targets */
+	void dumpStats(void);
+
+protected:
+	void trimToLimit(unsigned int uLimit);
+
+	CCMutableArray<CCRenderTarget*> *m_pIdleTargets;
+	unsigned int m_uMemoryLimit;
+	unsigned int m_uFrame;
+	ccRenderTargetPoolStats m_tStats;
+};
+
+}//namespace cocos2d
+
+#endif // __CCRENDER_TARGET_POOL_H__
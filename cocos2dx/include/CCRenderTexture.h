@@ -31,6 +31,8 @@ THE SOFTWARE.
 
 namespace cocos2d {
 
+class CCRenderTarget;
+
 typedef enum eImageFormat
 {
 	kCCImageFormatJPG       = 0,
@@ -44,6 +46,8 @@ scenes or objects to render them, and call end. For convienience, render texture
 adds a sprite as it's display child with the results, so you can simply add
 the render texture to your scene and treat it like any other CocosNode.
 There are also functions for saving the render texture to disk in PNG or JPG format.
+The texture and its render target view come from CCRenderTargetPool and go
+back to it when the render texture is destroyed.
 
 @since v0.8.1
 */
@@ -118,10 +122,11 @@ protected:
 	CCImage				*m_pUITextureImage;
     CCenum				m_ePixelFormat;
 
-	// render to texture
+	// render to texture, owned by m_pRenderTarget
+	CCRenderTarget*			m_pRenderTarget;
 	ID3D11RenderTargetView* m_renderTargetView;
 public:
-	bool Initialize(ID3D11Device*, int, int);
+	/** gives the render target back to CCRenderTargetPool */
 	void Shutdown();
 	void CopyResource();
 	void SetRenderTarget(ID3D11DeviceContext*, ID3D11DepthStencilView*);
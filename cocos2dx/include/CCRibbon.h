@@ -34,6 +34,7 @@ namespace cocos2d {
 
 class CCRibbonSegment;
 class CCDXRibbonSegment;
+class CCRenderProgram;
 /**
 * @brief A CCRibbon is a dynamically generated list of polygons drawn as a single or series
 * of triangle strips. The primary use of CCRibbon is as the drawing class of Motion Streak,
@@ -125,19 +126,13 @@ public:
 class CC_DLL CCDXRibbonSegment
 {
 public:
-	ID3D11Buffer *m_vertexBuffer;
-
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11Buffer* m_matrixBuffer;
+	CCRenderProgram* m_pProgram;
 
 	CCDXRibbonSegment();
 	~CCDXRibbonSegment();
 	void FreeBuffer();
 	void setIsInit(bool isInit);
-	void initVertexBuffer();
-	void RenderVertexBuffer(CCfloat* verts,CCfloat* coords,CCubyte* colors);
+	bool RenderVertexBuffer(CCfloat* verts,CCfloat* coords,CCubyte* colors);
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 	bool InitializeShader();
 	bool SetShaderParameters(DirectX::XMMATRIX &viewMatrix, DirectX::XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture);
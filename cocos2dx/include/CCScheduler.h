@@ -38,6 +38,7 @@ namespace   cocos2d {
 /** @brief Light weight timer */
 class CC_DLL CCTimer : public CCObject
 {
+	CC_POOLED_ALLOC(CCTimer)
 public:
 	CCTimer(void);
 
@@ -0,0 +1,165 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCSLAB_ALLOCATOR_H__
+#define __CCSLAB_ALLOCATOR_H__
+
+#include "ccConfig.h"
+#include "CCPlatformMacros.h"
+
+#include <stddef.h>
+
+namespace cocos2d {
+
+/** @brief Hands out fixed size blocks carved from larger slabs.
+
+Freed blocks go to a free list and are reused by the next allocation, so
+classes that are created and destroyed by the thousand every second stop
+hitting the heap once their working set has been reached. Slabs are never
+returned to the system while the allocator lives, and the allocators of the
+pooled classes live until the process exits.
+
+Each pooled class has its own allocator (see CC_POOLED_ALLOC), which also
+keeps the live and peak object counts of that class. A subclass that doesn't
+declare its own pool inherits operator new but has a different size; those
+requests are passed on to the global operator new.
+
+CCSlabAllocator is not thread safe, use CCThreadSafeSlabAllocator for classes
+that are created by worker threads.
+*/
+class CC_DLL CCSlabAllocator
+{
+public:
+	CCSlabAllocator(const char *pszName, size_t uObjectSize, unsigned int uObjectsPerSlab);
+	virtual ~CCSlabAllocator(void);
+
+	void* allocate(size_t uSize);
+	void deallocate(void *p, size_t uSize);
+
+	inline const char* getName(void) { return m_pszName; }
+	inline size_t getObjectSize(void) { return m_uObjectSize; }
+	/** objects allocated from the slabs and not freed yet */
+	inline unsigned int getLiveCount(void) { return m_uLiveCount; }
+	inline unsigned int getPeakCount(void) { return m_uPeakCount; }
+	inline unsigned int getTotalAllocations(void) { return m_uTotalAllocations; }
+	/** allocations of subclasses that went to the global operator new */
+	inline unsigned int getFallbackCount(void) { return m_uFallbackCount; }
+	inline unsigned int getSlabCount(void) { return m_uSlabCount; }
+	/** bytes reserved by the slabs */
+	inline unsigned int getCapacityInBytes(void) { return m_uSlabCount * m_uObjectsPerSlab * (unsigned int)m_uStride; }
+
+	/** all the allocators, in creation order */
+	static CCSlabAllocator* firstAllocator(void);
+	inline CCSlabAllocator* nextAllocator(void) { return m_pNext; }
+
+	/** Output to CCLOG the counters of every allocator */
+	static void dumpAllocators(void);
+
+protected:
+	virtual void lock(void) {}
+	virtual void unlock(void) {}
+
+private:
+	CCSlabAllocator(const CCSlabAllocator&);
+	CCSlabAllocator& operator=(const CCSlabAllocator&);
+
+	void addSlab(void);
+
+	const char *m_pszName;
+	size_t m_uObjectSize;
+	size_t m_uStride;
+	unsigned int m_uObjectsPerSlab;
+	void *m_pFreeList;
+	void *m_pSlabs;
+	unsigned int m_uSlabCount;
+	unsigned int m_uLiveCount;
+	unsigned int m_uPeakCount;
+	unsigned int m_uTotalAllocations;
+	unsigned int m_uFallbackCount;
+	CCSlabAllocator *m_pNext;
+};
+
+/** @brief CCSlabAllocator guarded by a mutex */
+class CC_DLL CCThreadSafeSlabAllocator : public CCSlabAllocator
+{
+public:
+	CCThreadSafeSlabAllocator(const char *pszName, size_t uObjectSize, unsigned int uObjectsPerSlab);
+	virtual ~CCThreadSafeSlabAllocator(void);
+
+protected:
+	virtual void lock(void);
+	virtual void unlock(void);
+
+	//! a std::mutex, created in the .cpp so that this header doesn't include <mutex>
+	void *m_pMutex;
+};
+
+}//namespace cocos2d
+
+#if CC_ENABLE_POOLED_ALLOCATION
+
+/** CC_POOLED_ALLOC declares the operator new/delete of a class that takes its
+ memory from its own CCSlabAllocator. Put it in the class declaration, it
+ leaves the access as public. The operators and the allocator are defined in
+ the .cpp with CC_POOLED_ALLOC_IMPL or CC_POOLED_ALLOC_IMPL_THREADSAFE.
+
+ The allocator is created by the first pooledAllocator() call, or during static
+ initialization if nothing asked for it before, so that no thread races to create
+ it. It is never destroyed: objects freed by static destructors or after main()
+ still find it alive.
+ */
+#define CC_POOLED_ALLOC(className) \
+public: static void* operator new(size_t uSize); \
+public: static void operator delete(void *p, size_t uSize); \
+public: static cocos2d::CCSlabAllocator* pooledAllocator(void);
+
+#define CC_POOLED_ALLOC_IMPL_WITH(className, allocatorClass, objectsPerSlab) \
+static cocos2d::CCSlabAllocator *s_p##className##Allocator = NULL; \
+cocos2d::CCSlabAllocator* className::pooledAllocator(void) \
+{ \
+	if (! s_p##className##Allocator) \
+	{ \
+		s_p##className##Allocator = new allocatorClass(#className, sizeof(className), objectsPerSlab); \
+	} \
+	return s_p##className##Allocator; \
+} \
+void* className::operator new(size_t uSize) { return className::pooledAllocator()->allocate(uSize); } \
+void className::operator delete(void *p, size_t uSize) { className::pooledAllocator()->deallocate(p, uSize); } \
+static cocos2d::CCSlabAllocator *s_p##className##AllocatorAtStartup = className::pooledAllocator();
+
+#define CC_POOLED_ALLOC_IMPL(className, objectsPerSlab) \
+	CC_POOLED_ALLOC_IMPL_WITH(className, cocos2d::CCSlabAllocator, objectsPerSlab)
+
+#define CC_POOLED_ALLOC_IMPL_THREADSAFE(className, objectsPerSlab) \
+	CC_POOLED_ALLOC_IMPL_WITH(className, cocos2d::CCThreadSafeSlabAllocator, objectsPerSlab)
+
+#else
+
+#define CC_POOLED_ALLOC(className)
+#define CC_POOLED_ALLOC_IMPL(className, objectsPerSlab)
+#define CC_POOLED_ALLOC_IMPL_THREADSAFE(className, objectsPerSlab)
+
+#endif // CC_ENABLE_POOLED_ALLOCATION
+
+#endif // __CCSLAB_ALLOCATOR_H__
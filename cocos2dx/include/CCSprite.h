@@ -45,6 +45,7 @@ class CCPoint;
 class CCSize;
 class CCTexture2D;
 class CCDXSprite;
+class CCRenderProgram;
 struct transformValues_;
 
 #define CCSpriteIndexNotInitialized 0xffffffff 	/// CCSprite invalid index on the CCSpriteBatchode
@@ -94,6 +95,7 @@ typedef enum {
 */
 class CC_DLL CCSprite : public CCNode, public CCTextureProtocol, public CCRGBAProtocol
 {
+	CC_POOLED_ALLOC(CCSprite)
 	/** Opacity: conforms to CCRGBAProtocol protocol */
 	CC_PROPERTY(CCubyte, m_nOpacity, Opacity)
 	/** Color: conforms with CCRGBAProtocol protocol */
@@ -412,13 +414,9 @@ private:
 
 	bool mIsInit;
 public:
-	ID3D11Buffer *m_vertexBuffer;
 	ID3D11Buffer* m_indexBuffer;
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11Buffer* m_matrixBuffer;
-	ID3D11Buffer* m_textureColorBuffer;
+	//! shared by the sprites, see CCRenderQueue::programWithShaders()
+	CCRenderProgram* m_pProgram;
 
 	CCDXSprite();
 	~CCDXSprite();
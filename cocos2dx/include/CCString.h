@@ -32,6 +32,7 @@ namespace cocos2d {
 
 	class CC_DLL CCString : public CCObject
 	{
+		CC_POOLED_ALLOC(CCString)
 	public:
 		std::string m_sString;
 	public:
@@ -37,6 +37,8 @@ THE SOFTWARE.
 
 namespace   cocos2d {
 class CCImage;
+struct sMipmapChain;
+struct sTexturePayload;
 
 //CONSTANTS:
 
@@ -65,6 +67,14 @@ typedef enum {
 	kCCTexture2DPixelFormat_PVRTC4,
 	//! 2-bit PVRTC-compressed texture: PVRTC2
 	kCCTexture2DPixelFormat_PVRTC2,
+	//! 4-bit block compressed texture: BC1 (DXT1)
+	kCCTexture2DPixelFormat_BC1,
+	//! 8-bit block compressed texture with explicit alpha: BC2 (DXT3)
+	kCCTexture2DPixelFormat_BC2,
+	//! 8-bit block compressed texture with interpolated alpha: BC3 (DXT5)
+	kCCTexture2DPixelFormat_BC3,
+	//! 8-bit block compressed texture: BC7, needs a feature level 11 device
+	kCCTexture2DPixelFormat_BC7,
 
 	//! Default texture format: RGBA8888
 	kCCTexture2DPixelFormat_Default = kCCTexture2DPixelFormat_RGBA8888,
@@ -107,6 +117,8 @@ class CC_DLL CCTexture2D : public CCObject
 	CC_PROPERTY_READONLY(unsigned int, m_uPixelsWide, PixelsWide)
 	/** hight in pixels */
 	CC_PROPERTY_READONLY(unsigned int, m_uPixelsHigh, PixelsHigh)
+	/** mip levels, 1 when the texture has no mipmaps */
+	CC_PROPERTY_READONLY(unsigned int, m_uMipmapCount, MipmapCount)
 
 	/** texture name */
 	CC_PROPERTY_READONLY(CCuint, m_uName, Name)
@@ -117,11 +129,12 @@ class CC_DLL CCTexture2D : public CCObject
 	CC_PROPERTY(CCfloat, m_fMaxS, MaxS)
 	/** texture max T */
 	CC_PROPERTY(CCfloat, m_fMaxT, MaxT)
-	/** whether or not the texture has their Alpha premultiplied */
-	CC_PROPERTY_READONLY(bool, m_bHasPremultipliedAlpha, HasPremultipliedAlpha);
+	/** whether or not the texture has their Alpha premultiplied, set it when the pixels are written with updateWithData() */
+	CC_PROPERTY(bool, m_bHasPremultipliedAlpha, HasPremultipliedAlpha);
 	CC_PROPERTY(ccResolutionType, m_eResolutionType, ResolutionType);
 public:
 
+	/** the resource the texture is drawn with, fetching it marks the texture as used in the current frame */
 	ID3D11ShaderResourceView* getTextureResource();
 	ID3D11SamplerState** GetSamplerState();
 
@@ -137,6 +150,11 @@ public:
 	/** Intializes with a texture2d with data */
 	bool initWithData(const void* data, CCTexture2DPixelFormat pixelFormat, unsigned int pixelsWide, unsigned int pixelsHigh, const CCSize& contentSize);
 
+	/** Intializes a texture2d with a mip chain, levels[0] is pixelsWide x pixelsHigh and each next level halves the sizes.
+	The block compressed formats are uploaded as they are, when the device can't sample them BC1, BC2 and BC3 are decoded on the CPU.
+	*/
+	bool initWithMipmaps(const void** levels, unsigned int levelCount, CCTexture2DPixelFormat pixelFormat, unsigned int pixelsWide, unsigned int pixelsHigh, const CCSize& contentSize);
+
 	/**
 	Drawing extensions to make it easy to draw basic quads using a CCTexture2D object.
 	These functions require CC_TEXTURE_2D and both CC_VERTEX_ARRAY and CC_TEXTURE_COORD_ARRAY client states to be enabled.
@@ -155,6 +173,35 @@ public:
 
 	bool initWithImage(CCImage *uiImage, ccResolutionType resolution);
 
+	/** Initializes a texture from a UIImage object and uploads all its mip levels.
+	bMipmaps builds them with the box filter, see CCTextureCache::setMipmapsEnabled() for the other options.
+	*/
+	bool initWithImage(CCImage *uiImage, ccResolutionType resolution, bool bMipmaps);
+
+	/** Initializes a texture from the RGBA8888 levels of a mip chain.
+	They are converted to the default alpha pixel format when hasAlpha is true, uploaded as RGB888 otherwise.
+	imageSize is the content size, the top level may be bigger because of the POT rounding.
+	*/
+	bool initWithMipmapChain(struct sMipmapChain *pChain, bool hasAlpha, const CCSize& imageSize);
+
+	/** Initializes a texture from levels already in their pixel format, see payloadForImage() and ccTexturePayloadRead().
+	The levels must be as big as pixelFormat, width and height say, payloads read from a file are checked against them.
+	*/
+	bool initWithPayload(const struct sTexturePayload *pPayload);
+
+	/** Converts an image the way initWithImage() uploads it: padded to textureSizeForImageSize(), premultiplied,
+	expanded to 32 bits and repacked to the default alpha pixel format. Release pPayload with ccTexturePayloadDestroy.
+	*/
+	static bool payloadForImage(CCImage *uiImage, struct sTexturePayload *pPayload);
+
+	/** Converts the levels of a mip chain the way initWithMipmapChain() uploads them.
+	The levels that keep 32 bits aren't copied, pPayload points to those of pChain and must be destroyed first.
+	*/
+	static void payloadForMipmapChain(struct sMipmapChain *pChain, bool hasAlpha, const CCSize& imageSize, struct sTexturePayload *pPayload);
+
+	/** size of the texture an image is uploaded to: its own size, or the next powers of 2 when the device doesn't support NPOT textures */
+	static void textureSizeForImageSize(unsigned int width, unsigned int height, unsigned int *pPixelsWide, unsigned int *pPixelsHigh);
+
 	/**
 	Extensions to make it easy to create a CCTexture2D object from a string of text.
 	Note that the generated textures are of type A8 - use the blending mode (CC_SRC_ALPHA, CC_ONE_MINUS_SRC_ALPHA).
@@ -179,6 +226,11 @@ public:
     /** Initializes a texture from a PVR file */
 	bool initWithPVRFile(const char* file);
 
+	/** Initializes a texture from a BC1, BC2, BC3 or BC7 DDS file, with its mip chain.
+	Files ending with .gz or .ccz are inflated first.
+	*/
+	bool initWithDDSFile(const char* file);
+
 	/** sets the min filter, mag filter, wrap s and wrap t texture parameters.
 	If the texture size is NPOT (non power of 2), then in can only use CC_CLAMP_TO_EDGE in CC_TEXTURE_WRAP_{S,T}.
 	@since v0.8
@@ -204,14 +256,33 @@ public:
 
 	/** Generates mipmap images for the texture.
 	It only works if the texture size is POT (power of 2).
+	The levels are rendered by the GPU from the top one, which is copied to a new texture
+	with the whole chain. Formats the device can't generate mips for keep their single level.
 	@since v0.99.0
 	*/
 	void generateMipmap();
 
+	/** Replaces a region of the top level.
+	data has the pixel format of the texture with tightly packed rows, the block compressed formats can't be updated.
+	*/
+	bool updateWithData(const void *data, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+	/** Copies a region of the top level of pSource to (x, y) on the GPU. Both textures must have the same pixel format. */
+	void copyRegion(CCTexture2D *pSource, unsigned int sourceX, unsigned int sourceY, unsigned int width, unsigned int height, unsigned int x, unsigned int y);
+
 	/** returns the bits-per-pixel of the in-memory OpenGL texture
 	@since v1.0
 	*/
     unsigned int bitsPerPixelForFormat();  
+
+	/** bytes of GPU memory used by the texture, mip levels included */
+	unsigned int getMemorySize();
+
+	/** frame the texture was last drawn in, the least recently drawn textures are evicted first by CCTextureCache */
+	inline unsigned int getLastUsedFrame(void) { return m_uLastUsedFrame; }
+
+	/** frame the drawn textures are stamped with, advanced by CCTextureCache::frameEnded() */
+	static void setCurrentFrame(unsigned int uFrame);
     
 	/** sets the default pixel format for UIImagescontains alpha channel.
 	If the UIImage contains alpha channel, then the options are:
@@ -246,11 +317,11 @@ public:
 	static void PVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied);
 
 private:
-	bool initPremultipliedATextureWithImage(CCImage * image, unsigned int pixelsWide, unsigned int pixelsHigh);
-    
     // By default PVR images are treated as if they don't have the alpha channel premultiplied
     bool m_bPVRHaveAlphaPremultiplied;
 
+	unsigned int m_uLastUsedFrame;
+
 
 
 
@@ -35,6 +35,7 @@ THE SOFTWARE.
 namespace   cocos2d {
 class CCTexture2D;
 class CCDXTextureAtlas;
+class CCRenderProgram;
 /** @brief A class that implements a Texture Atlas.
 Supported features:
 * The atlas file can be a PVRTC, PNG or any other fomrat supported by Texture2D
@@ -164,19 +165,15 @@ private:
 class CC_DLL CCDXTextureAtlas
 {
 public:
-	ID3D11Buffer *m_vertexBuffer;
 	ID3D11Buffer* m_indexBuffer;
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11Buffer* m_matrixBuffer;
+	CCRenderProgram* m_pProgram;
 
 	CCDXTextureAtlas();
 	~CCDXTextureAtlas();
 	void FreeBuffer();
 	void setIsInit(bool isInit);
 	void initVertexBuffer(unsigned short* indices,unsigned int capacity);
-	void RenderVertexBuffer(ccV3F_C4B_T2F_Quad* quads,unsigned int capacity);
+	void RenderVertexBuffer(ccV3F_C4B_T2F_Quad* quads,unsigned int n, unsigned int start);
 	void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename);
 	bool InitializeShader();
 	bool SetShaderParameters( DirectX::XMMATRIX &viewMatrix, DirectX::XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture);
@@ -195,6 +192,8 @@ private:
 		DirectX::XMFLOAT2 texture;
 	};
 	bool mIsInit;
+	// quads the index buffer has room for, the indices are the same for every atlas
+	unsigned int m_uIndexCapacity;
 };
 }//namespace   cocos2d 
 
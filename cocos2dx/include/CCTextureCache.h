@@ -28,9 +28,11 @@ THE SOFTWARE.
 #define __CCTEXTURE_CACHE_H__
 
 #include <string>
+#include <set>
 #include "CCObject.h"
 #include "CCMutableDictionary.h"
 #include "CCTexture2D.h"
+#include "support/image_support/ccMipmap.h"
 
 
 #if CC_ENABLE_CACHE_TEXTTURE_DATA
@@ -41,6 +43,22 @@ THE SOFTWARE.
 namespace   cocos2d {
 class CCLock;
 class CCImage;
+class CCSpriteFrame;
+
+/** residency counters of CCTextureCache, sizes are in bytes */
+typedef struct _ccTextureResidencyStats
+{
+	//! memory of the cached textures, measured at the end of each frame
+	unsigned int uCurrentBytes;
+	unsigned int uPeakBytes;
+	//! textures removed to get under the budget, and their memory
+	unsigned int uEvictions;
+	unsigned int uEvictedBytes;
+	//! evicted textures that had to be loaded again
+	unsigned int uReloads;
+	//! frames that ended over the budget because the textures in use alone exceed it
+	unsigned int uOverBudgetFrames;
+} ccTextureResidencyStats;
 
 /** @brief Singleton that handles the loading of textures
 * Once the texture is loaded, the next time it will return
@@ -51,11 +69,34 @@ class CC_DLL CCTextureCache : public CCObject
 protected:
 	CCMutableDictionary<std::string, CCTexture2D*> * m_pTextures;
 	//pthread_mutex_t				*m_pDictLock;
-
+	bool m_bMipmapsEnabled;
+	ccMipmapFilter m_eMipmapFilter;
+	bool m_bMipmapDiskCacheEnabled;
+	bool m_bDecodedImageCacheEnabled;
+	bool m_bDecodedImageCacheCompressed;
+
+	unsigned int m_uMemoryBudget;
+	unsigned int m_uFrame;
+	ccTextureResidencyStats m_tResidencyStats;
+	// keys of the evicted textures, to count and prefetch the reloads
+	std::set<std::string> m_evictedKeys;
+
+	// sums the memory of the cached textures into m_tResidencyStats
+	void measureResidency(void);
+	// evicts the unused textures, least recently drawn first, until they take at most uBytes
+	void trimToBudget(unsigned int uBytes);
+	// m_pTextures->setObject, counting the reloads of evicted textures
+	void cacheTexture(CCTexture2D *texture, const std::string& key);
 
 private:
 	// @todo void addImageWithAsyncObject(CCAsyncObject* async);
     void addImageAsyncCallBack(ccTime dt);
+	// initWithImage, with the mip chain when bMipmaps
+	void initTextureWithImage(CCTexture2D *texture, CCImage *image, ccResolutionType resolution, const std::string& fullpath, bool bMipmaps);
+	// what the payloads of the images are converted with, part of their key
+	unsigned int payloadSettings(bool bMipmaps);
+	// the texture of an image from the payload an earlier launch cached, NULL when there is none
+	CCTexture2D* addImageFromPayloadCache(const std::string& fullpath, const std::string& pathKey, bool bMipmaps);
 
 public:
 
@@ -76,10 +117,15 @@ public:
 	* If the file image was not previously loaded, it will create a new CCTexture2D
 	*  object and it will return it. It will use the filename as a key.
 	* Otherwise it will return a reference of a previosly loaded image.
-	* Supported image extensions: .png, .bmp, .tiff, .jpeg, .pvr, .gif
+	* Supported image extensions: .png, .bmp, .tiff, .jpeg, .pvr, .dds, .gif
 	*/
 	CCTexture2D* addImage(const char* fileimage);
 
+	/** Same as addImage(const char*), bMipmaps overrides isMipmapsEnabled() for this image.
+	It only applies to the PNG and JPEG files when the texture isn't in the cache yet.
+	*/
+	CCTexture2D* addImage(const char* fileimage, bool bMipmaps);
+
 	/* Returns a Texture2D object given a file image
 	* If the file image was not previously loaded, it will create a new CCTexture2D object and it will return it.
 	* Otherwise it will load a texture in a new thread, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
@@ -90,6 +136,50 @@ public:
 	
 	void addImageAsync(const char *path, CCObject *target, SEL_CallFuncO selector);
 
+	/** Same as addImageAsync(const char*, CCObject*, SEL_CallFuncO), bMipmaps overrides isMipmapsEnabled() for this image.
+	The mip levels are built by the loading threads, only the upload is left to the main thread.
+	*/
+	void addImageAsync(const char *path, CCObject *target, SEL_CallFuncO selector, bool bMipmaps);
+
+	/** Packs a small PNG or JPEG image on a shared page instead of giving it its own texture, see CCDynamicAtlas::addImage().
+	Sprites made of the returned frames can be drawn in one batch.
+	*/
+	CCSpriteFrame* addImageToAtlas(const char *path);
+
+	/** Whether the textures loaded from PNG and JPEG files from now on get all their mip levels, false by default.
+	Scaled down sprites then sample a level of about their size instead of skipping texels.
+	The levels are built on the CPU and take a third more memory.
+	*/
+	inline bool isMipmapsEnabled(void) { return m_bMipmapsEnabled; }
+	inline void setMipmapsEnabled(bool bEnabled) { m_bMipmapsEnabled = bEnabled; }
+
+	/** filter the mip levels are built with, kCCMipmapFilter_Box by default */
+	inline ccMipmapFilter getMipmapFilter(void) { return m_eMipmapFilter; }
+	inline void setMipmapFilter(ccMipmapFilter filter) { m_eMipmapFilter = filter; }
+
+	/** Whether the built mip levels are saved to CCFileUtils::getWriteablePath() and read back next time, false by default.
+	Worth it with the Kaiser filter, the box one is about as fast as reading the file.
+	A <image>.mips file next to the image is read first, so the levels can also be shipped with the game.
+	The files are checked against the image they were built from, a changed image builds them again.
+	*/
+	inline bool isMipmapDiskCacheEnabled(void) { return m_bMipmapDiskCacheEnabled; }
+	inline void setMipmapDiskCacheEnabled(bool bEnabled) { m_bMipmapDiskCacheEnabled = bEnabled; }
+
+	/** Whether the PNG and JPEG files are only decoded the first time, false by default.
+	The levels are then saved to CCFileUtils::getWriteablePath() premultiplied, padded and in their pixel format, mip levels
+	included, and the next launches upload them straight from a mapping of the file.
+	The files are keyed by the path, size and date of the image and by the default alpha pixel format and mipmap settings,
+	changing any of them converts the image again.
+	*/
+	inline bool isDecodedImageCacheEnabled(void) { return m_bDecodedImageCacheEnabled; }
+	inline void setDecodedImageCacheEnabled(bool bEnabled) { m_bDecodedImageCacheEnabled = bEnabled; }
+
+	/** Whether the cached levels are deflated, false by default.
+	The files get about as small as the images but are inflated instead of being mapped, still faster than decoding.
+	*/
+	inline bool isDecodedImageCacheCompressed(void) { return m_bDecodedImageCacheCompressed; }
+	inline void setDecodedImageCacheCompressed(bool bCompressed) { m_bDecodedImageCacheCompressed = bCompressed; }
+
 	/* Returns a Texture2D object given an CGImageRef image
 	* If the image was not previously loaded, it will create a new CCTexture2D object and it will return it.
 	* Otherwise it will return a reference of a previously loaded image
@@ -141,6 +231,24 @@ public:
 	*/
 	void dumpCachedTextureInfo();
 
+	/** Bytes the cached textures may use before the unused ones are evicted, least recently drawn first.
+	A texture is unused when only the cache retains it, like for removeUnusedTextures().
+	Evicted textures are loaded again by the next addImage() or addImageAsync() of their file.
+	0, the default, never evicts.
+	*/
+	inline unsigned int getMemoryBudget(void) { return m_uMemoryBudget; }
+	void setMemoryBudget(unsigned int uBytes);
+
+	/** Called by CCDirector after each frame: measures the cached textures and evicts the unused ones over the budget */
+	void frameEnded(void);
+
+	/** Loads the evicted PNG and JPEG textures again with addImageAsync(), before showing a scene that needs them */
+	void reloadEvictedTexturesAsync(void);
+
+	inline const ccTextureResidencyStats& getResidencyStats(void) { return m_tResidencyStats; }
+	/** resets the peak and the counters, the current bytes are kept */
+	void resetResidencyStats(void);
+
 #ifdef CC_SUPPORT_PVRTC
 	/** Returns a Texture2D object given an PVRTC RAW filename
 	* If the file image was not previously loaded, it will create a new CCTexture2D
@@ -159,6 +267,12 @@ public:
 	*/
 	CCTexture2D* addPVRImage(const char* filename);
 
+	/** Returns a Texture2D object given a DDS filename, BC1, BC2, BC3 or BC7 compressed
+	* If the file image was not previously loaded, it will create a new CCTexture2D
+	*  object and it will return it. Otherwise it will return a reference of a previosly loaded image
+	*/
+	CCTexture2D* addDDSImage(const char* filename);
+
     /** Reload all textures
     It's only useful when the value of CC_ENABLE_CACHE_TEXTTURE_DATA is 1
     */
@@ -30,8 +30,9 @@ THE SOFTWARE.
 
 namespace cocos2d {
 
-class CCTouch : public CCObject
+class CC_DLL CCTouch : public CCObject
 {
+    CC_POOLED_ALLOC(CCTouch)
 public:
     CCTouch() {}
     CCTouch(float x, float y) :  m_point(x, y), m_prevPoint(x, y) {}
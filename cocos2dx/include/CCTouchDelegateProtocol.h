@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "CCObject.h"
 #include "ccConfig.h"
+#include "CCGeometry.h"
 
 namespace   cocos2d {
 
@@ -53,6 +54,16 @@ public:
 	virtual void ccTouchEnded(CCTouch *pTouch, CCEvent *pEvent) {CC_UNUSED_PARAM(pTouch); CC_UNUSED_PARAM(pEvent);}
 	virtual void ccTouchCancelled(CCTouch *pTouch, CCEvent *pEvent) {CC_UNUSED_PARAM(pTouch); CC_UNUSED_PARAM(pEvent);}
 
+	/** Returns true and the world space rect, in points, out of which ccTouchBegan never claims
+	 a touch nor does anything else. With CCTouchDispatcher::setHitTestIndexEnabled the touches
+	 beginning outside of it are not offered to the delegate.
+	 When the delegate is a CCNode, it is asked again only when its getWorldTransformEpoch()
+	 changes, so it has to follow from the transforms of the node, its ancestors and its
+	 descendants. Other delegates are asked on every beginning touch. By default the delegate
+	 is offered every touch.
+	 */
+	virtual bool getTouchBounds(CCRect& rect) {CC_UNUSED_PARAM(rect); return false;}
+
 	// optional
  	virtual void ccTouchesBegan(CCSet *pTouches, CCEvent *pEvent) {CC_UNUSED_PARAM(pTouches); CC_UNUSED_PARAM(pEvent);}
  	virtual void ccTouchesMoved(CCSet *pTouches, CCEvent *pEvent) {CC_UNUSED_PARAM(pTouches); CC_UNUSED_PARAM(pEvent);}
@@ -73,6 +73,7 @@ public:
 };
 
 class CCTouchHandler;
+class CCTouchHitIndex;
 struct _ccCArray;
 /** @brief CCTouchDispatcher.
  Singleton that handles all the touch events.
@@ -100,7 +101,7 @@ public:
         , m_pStandardHandlers(NULL)
 		, m_pHandlersToAdd(NULL)
 		, m_pHandlersToRemove(NULL)
-		
+		, m_pHitIndex(NULL)
 	{}
 
 public:
@@ -132,6 +133,14 @@ public:
     the higher the priority */
 	void setPriority(int nPriority, CCTouchDelegate *pDelegate);
 
+	/** Whether a beginning touch is offered only to the targeted delegates whose
+	 CCTouchDelegate::getTouchBounds() contain it, found with a grid of the bounds.
+	 The delivery order and the swallowing are the same. Default: false.
+	 A CCMenu subclass claiming touches out of its items has to return false from getTouchBounds.
+	 */
+	bool isHitTestIndexEnabled(void);
+	void setHitTestIndexEnabled(bool bEnabled);
+
 	void touches(CCSet *pTouches, CCEvent *pEvent, unsigned int uIndex);
 
 	virtual void touchesBegan(CCSet* touches, CCEvent* pEvent);
@@ -162,6 +171,7 @@ protected:
 	struct _ccCArray *m_pHandlersToRemove;
 	bool m_bToQuit;
 	bool m_bDispatchEvents;
+	CCTouchHitIndex *m_pHitIndex;
 
 	// 4, 1 for each type of event
 	struct ccTouchHandlerHelperData m_sHandlerHelperData[ccTouchMax];
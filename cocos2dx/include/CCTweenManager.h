@@ -0,0 +1,182 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __ACTION_CCTWEEN_MANAGER_H__
+#define __ACTION_CCTWEEN_MANAGER_H__
+
+#include "CCObject.h"
+#include "CCGeometry.h"
+#include "ccTypes.h"
+
+#include <vector>
+#include <map>
+
+namespace cocos2d {
+
+class CCNode;
+class CCAction;
+class CCActionInterval;
+class CCRGBAProtocol;
+
+/** curves of the tweens, the same as the CCActionEase actions */
+typedef enum
+{
+	kCCTweenEaseLinear,
+	//! rate in the parameter
+	kCCTweenEaseIn,
+	kCCTweenEaseOut,
+	kCCTweenEaseInOut,
+	kCCTweenEaseExponentialIn,
+	kCCTweenEaseExponentialOut,
+	kCCTweenEaseExponentialInOut,
+	kCCTweenEaseSineIn,
+	kCCTweenEaseSineOut,
+	kCCTweenEaseSineInOut,
+	//! period in the parameter
+	kCCTweenEaseElasticIn,
+	kCCTweenEaseElasticOut,
+	kCCTweenEaseElasticInOut,
+	kCCTweenEaseBounceIn,
+	kCCTweenEaseBounceOut,
+	kCCTweenEaseBounceInOut,
+	kCCTweenEaseBackIn,
+	kCCTweenEaseBackOut,
+	kCCTweenEaseBackInOut,
+} ccTweenEase;
+
+/** node property animated by a tween */
+typedef enum
+{
+	kCCTweenPosition,
+	kCCTweenScale,
+	kCCTweenRotation,
+	kCCTweenOpacity,
+	kCCTweenColor,
+
+	kCCTweenPropertyCount
+} ccTweenProperty;
+
+/** @brief CCTweenManager runs simple interval actions in bulk.
+
+Move, scale, rotate, fade and tint tweens, with or without an ease curve, are
+kept in one contiguous array per property. Every frame each array is updated
+in three tight loops (time, ease, value) and the results are written back to
+the nodes in one pass, without the virtual step()/update() calls and the
+per action allocations of CCActionManager.
+
+Tweens can be started with moveTo(), scaleTo()... or from an existing action
+with runAction(), which falls back to CCNode::runAction() for the actions it
+doesn't handle. CCNode::stopAllActions() and the pause/resume of a node apply
+to its tweens as well.
+
+A tween retains its target until it is done.
+@since v1.0.1
+*/
+class CC_DLL CCTweenManager : public CCObject
+{
+public:
+	CCTweenManager(void);
+	~CCTweenManager(void);
+	bool init(void);
+
+	/** returns a shared instance of the CCTweenManager */
+	static CCTweenManager* sharedManager(void);
+	/** purges the shared tween manager, the remaining tweens are dropped */
+	static void purgeSharedManager(void);
+	/** the shared instance if it was created, NULL otherwise */
+	static CCTweenManager* existingManager(void);
+
+	/** Runs pAction on pTarget as a tween when it is a move, scale, rotate, fade or tint action,
+	 optionally wrapped in one CCActionEase. Other actions are given to pTarget->runAction().
+	 @return the id of the tween, 0 if the action was run by CCActionManager
+	 */
+	unsigned int runAction(CCAction *pAction, CCNode *pTarget);
+
+	/** each call returns the id of the tween, fEaseParam is the rate or the period of the curve */
+	unsigned int moveTo(CCNode *pTarget, ccTime duration, const CCPoint& position, ccTweenEase eEase = kCCTweenEaseLinear, float fEaseParam = 0);
+	unsigned int moveBy(CCNode *pTarget, ccTime duration, const CCPoint& delta, ccTweenEase eEase = kCCTweenEaseLinear, float fEaseParam = 0);
+	unsigned int scaleTo(CCNode *pTarget, ccTime duration, float sx, float sy, ccTweenEase eEase = kCCTweenEaseLinear, float fEaseParam = 0);
+	unsigned int rotateTo(CCNode *pTarget, ccTime duration, float fAngle, ccTweenEase eEase = kCCTweenEaseLinear, float fEaseParam = 0);
+	unsigned int rotateBy(CCNode *pTarget, ccTime duration, float fDeltaAngle, ccTweenEase eEase = kCCTweenEaseLinear, float fEaseParam = 0);
+	/** pTarget has to conform to CCRGBAProtocol, 0 is returned otherwise */
+	unsigned int fadeTo(CCNode *pTarget, ccTime duration, CCubyte opacity, ccTweenEase eEase = kCCTweenEaseLinear, float fEaseParam = 0);
+	/** pTarget has to conform to CCRGBAProtocol, 0 is returned otherwise */
+	unsigned int tintTo(CCNode *pTarget, ccTime duration, const ccColor3B& color, ccTweenEase eEase = kCCTweenEaseLinear, float fEaseParam = 0);
+
+	/** Removes a tween, it stays where it was */
+	void removeTween(unsigned int uTweenID);
+	void removeAllTweensFromTarget(CCNode *pTarget);
+	void removeAllTweens(void);
+
+	unsigned int numberOfRunningTweensInTarget(CCNode *pTarget);
+	unsigned int numberOfRunningTweens(void);
+
+	void pauseTarget(CCNode *pTarget);
+	void resumeTarget(CCNode *pTarget);
+
+	/** The value of the curve at time, 0 <= time <= 1 */
+	static float ease(ccTweenEase eEase, float fParam, float time);
+
+protected:
+	struct tTween
+	{
+		CCNode *pTarget;
+		CCRGBAProtocol *pRGBA;
+		float from[3];
+		float delta[3];
+		float elapsed;
+		float duration;
+		float easeParam;
+		unsigned int uID;
+		ccTweenEase eEase;
+		// like CCActionInterval, the first update doesn't advance the time
+		bool bFirstTick;
+		bool bPaused;
+		bool bRemoved;
+	};
+
+	struct tTargetInfo
+	{
+		unsigned int uCount;
+		bool bPaused;
+	};
+
+	unsigned int addTween(ccTweenProperty eProperty, CCNode *pTarget, CCRGBAProtocol *pRGBA,
+		const float *pFrom, const float *pDelta, ccTime duration, ccTweenEase eEase, float fEaseParam);
+	void update(ccTime dt);
+	void updateProperty(ccTweenProperty eProperty, ccTime dt);
+	void compact(ccTweenProperty eProperty);
+
+protected:
+	std::vector<tTween> m_tweens[kCCTweenPropertyCount];
+	std::map<CCNode*, tTargetInfo> m_targets;
+	// per frame scratch: eased times, then the values
+	std::vector<float> m_times;
+	std::vector<float> m_values;
+	unsigned int m_uNextID;
+};
+
+}//namespace cocos2d
+
+#endif // __ACTION_CCTWEEN_MANAGER_H__
@@ -275,6 +275,40 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_LABELATLAS_DEBUG_DRAW 0
 #endif
 
+/** @def CC_RENDER_TARGET_POOL_MEMORY_LIMIT
+ Number of bytes the idle render targets kept by CCRenderTargetPool may use.
+ Above it the least recently used targets are released.
+ It can be changed at runtime with CCRenderTargetPool::setMemoryLimit.
+
+ Default is 32 MB, enough for the two full screen targets of a cross fade on
+ a 1920x1080 display.
+ */
+#ifndef CC_RENDER_TARGET_POOL_MEMORY_LIMIT
+#define CC_RENDER_TARGET_POOL_MEMORY_LIMIT (32 * 1024 * 1024)
+#endif
+
+/** @def CC_NODE_TAG_INDEX_THRESHOLD
+ Number of children above which a node indexes them by tag, so that
+ getChildByTag doesn't scan them all. It can be changed at runtime with
+ CCNode::setTagIndexThreshold.
+
+ To disable set it to 0. Default is 32.
+ */
+#ifndef CC_NODE_TAG_INDEX_THRESHOLD
+#define CC_NODE_TAG_INDEX_THRESHOLD 32
+#endif
+
+/** @def CC_ENABLE_POOLED_ALLOCATION
+ If enabled, the classes declared with CC_POOLED_ALLOC (actions, sprites, touches,
+ strings and timers) are allocated from per class slabs instead of the heap.
+ See CCSlabAllocator.
+
+ To enable set it to 1. Disabled by default.
+ */
+#ifndef CC_ENABLE_POOLED_ALLOCATION
+#define CC_ENABLE_POOLED_ALLOCATION 0
+#endif
+
 /** @def CC_ENABLE_PROFILERS
  If enabled, will activate various profilers withing cocos2d. This statistical data will be output to the console
  once per second showing average time (in milliseconds) required to execute the specific routine(s).
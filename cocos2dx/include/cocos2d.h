@@ -41,11 +41,14 @@ THE SOFTWARE.
 #include "CCAnimation.h"
 #include "CCAnimationCache.h"
 #include "CCActionManager.h"
+#include "CCTweenManager.h"
 #include "CCCamera.h"
 #include "CCActionCamera.h"
 #include "CCProtocols.h"
 #include "CCNode.h"
 #include "CCDirector.h"
+#include "CCFixedTimestep.h"
+#include "CCRenderPipeline.h"
 #include "CCUserDefault.h"
 #include "CCActionInstant.h"
 #include "CCActionInterval.h"
@@ -60,8 +63,10 @@ THE SOFTWARE.
 #include "CCParticleExamples.h"
 #include "CCScene.h"
 #include "CCSprite.h"
+#include "CCNodePool.h"
 #include "CCSpriteFrameCache.h"
 #include "CCTextureCache.h"
+#include "CCDynamicAtlas.h"
 #include "CCTransition.h"
 #include "CCTextureAtlas.h"
 #include "CCLabelAtlas.h"
@@ -77,6 +82,9 @@ THE SOFTWARE.
 #include "CCTMXObjectGroup.h"
 #include "CCTMXXMLParser.h"
 #include "CCRenderTexture.h"
+#include "CCRenderTargetPool.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 #include "CCMotionStreak.h"
 #include "CCActionPageTurn3D.h"
 #include "CCTransitionPageTurn.h"
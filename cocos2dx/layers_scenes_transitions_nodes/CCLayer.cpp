@@ -36,6 +36,8 @@ THE SOFTWARE.
 #include "DirectXHelper.h"
 #include <fstream>
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace std;
 using namespace DirectX;
@@ -523,18 +525,18 @@ void CCLayerColor::draw()
 	bool newBlend = false;
 	if( m_tBlendFunc.src != CC_BLEND_SRC || m_tBlendFunc.dst != CC_BLEND_DST ) {
 		newBlend = true;
-		CCD3DCLASS->D3DBlendFunc(m_tBlendFunc.src, m_tBlendFunc.dst);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(m_tBlendFunc.src, m_tBlendFunc.dst);
 	}
 	else if( m_cOpacity != 255 ) {
 		newBlend = true;
-		CCD3DCLASS->D3DBlendFunc(CC_SRC_ALPHA, CC_ONE_MINUS_SRC_ALPHA);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_SRC_ALPHA, CC_ONE_MINUS_SRC_ALPHA);
 	}
 	mDXLayerColor.Render(m_pSquareVertices,m_pSquareColors);
 	//=glDrawArrays(CC_TRIANGLE_STRIP, 0, 4);
 
 	if( newBlend )
 	{
-		CCD3DCLASS->D3DBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
 	}
 	/*=
 	// restore default GL state
@@ -546,11 +548,7 @@ void CCLayerColor::draw()
 
 CCDXLayerColor::CCDXLayerColor()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_matrixBuffer = 0;
-	m_vertexBuffer = 0;
+	m_pProgram = NULL;
 	mIsInit = FALSE;
 }
 CCDXLayerColor::~CCDXLayerColor()
@@ -559,33 +557,13 @@ CCDXLayerColor::~CCDXLayerColor()
 }
 void CCDXLayerColor::FreeBuffer()
 {
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_matrixBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_layout);
-	CC_SAFE_RELEASE_NULL_DX(m_pixelShader);
-	CC_SAFE_RELEASE_NULL_DX(m_vertexShader);
+	CC_SAFE_RELEASE_NULL(m_pProgram);
 }
 void CCDXLayerColor::setIsInit(bool isInit)
 {
 	mIsInit = isInit;
 }
 
-
-void CCDXLayerColor::initVertexBuffer()
-{
-	D3D11_BUFFER_DESC vertexBufferDesc;
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType)*4;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-	// Now create the vertex buffer.
-	CCID3D11Device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer);
-}
-
 void CCDXLayerColor::RenderVertexBuffer(ccVertex2F* squareVertices,ccColor4B* squareColors)
 {
 	// Create the vertex array.
@@ -601,80 +579,35 @@ void CCDXLayerColor::RenderVertexBuffer(ccVertex2F* squareVertices,ccColor4B* sq
 	verticesTmp[2].color = DirectX::XMFLOAT4(squareColors[2].r/255.0f, squareColors[2].g/255.0f, squareColors[2].b/255.0f, squareColors[2].a/255.0f);
 	verticesTmp[3].color = DirectX::XMFLOAT4(squareColors[3].r/255.0f, squareColors[3].g/255.0f, squareColors[3].b/255.0f, squareColors[3].a/255.0f);
 
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-	if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+	// Copy the vertices to the shared ring and set them active in the input assembler.
+	if(!CCDynamicBuffers::sharedDynamicBuffers()->setVertices(0, verticesTmp, sizeof(VertexType), 4))
 	{
-		return ;
+		return false;
 	}
-	verticesPtr = (VertexType*)mappedResource.pData;
-	memcpy(verticesPtr, (void*)verticesTmp, (sizeof(VertexType) * 4));
-	CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
-
 
 	////////////////////////
-	unsigned int stride;
-	unsigned int offset;
-	stride = sizeof(VertexType); 
-	offset = 0;
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
-	CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	CCRenderQueue::sharedRenderQueue()->setTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
-	return;
+	return true;
 }
 
 bool CCDXLayerColor::InitializeShader()
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	//ID3D10Blob* vertexShaderBuffer;
-	//ID3D10Blob* pixelShaderBuffer;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-	//D3D11_SAMPLER_DESC samplerDesc;
-
-
-	// Initialize the pointers this function will use to null.
-	errorMessage = 0;
-	//vertexShaderBuffer = 0;
-	//pixelShaderBuffer = 0;
-
-		 BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 		 D3D11_INPUT_ELEMENT_DESC layoutDesc[] = 
 		 {
 			 { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 			 { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 		 };
 
-		 loader->LoadShader(
+		 m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 			 L"CCLayerColorVertexShader.cso",
 			 layoutDesc,
 			 ARRAYSIZE(layoutDesc),
-			 &m_vertexShader,
-			 &m_layout
+			 L"CCLayerColorPixelShader.cso"
 			 );
+		 CC_SAFE_RETAIN(m_pProgram);
 
-		 loader->LoadShader(
-			 L"CCLayerColorPixelShader.cso",
-			 &m_pixelShader
-			 );
-
-
-	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	return true;
+	return m_pProgram != NULL;
 }
 
 void CCDXLayerColor::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
@@ -715,48 +648,25 @@ void CCDXLayerColor::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwn
 
 bool CCDXLayerColor::SetShaderParameters(XMMATRIX &viewMatrix,XMMATRIX &projectionMatrix)
 {
-	HRESULT result;
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
+	MatrixBufferType matrices;
 	unsigned int bufferNumber;
 
 
 	// Transpose the matrices to prepare them for the shader.
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-	// Lock the constant buffer so it can be written to.
-	result = CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	// Get a pointer to the data in the constant buffer.
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-
-	// Copy the matrices into the constant buffer.
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-
-	// Unlock the constant buffer.
-	CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+	matrices.view = XMMatrixTranspose(viewMatrix);
+	matrices.projection = XMMatrixTranspose(projectionMatrix);
 
 	// Set the position of the constant buffer in the vertex shader.
 	bufferNumber = 0;
 
-	// Now set the constant buffer in the vertex shader with the updated values.
-	CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
-
-	return true;
+	// Copy the matrices to the shared constant ring and set them in the vertex shader.
+	return CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices));
 }
 
 void CCDXLayerColor::RenderShader()
 {
-	CCID3D11DeviceContext->IASetInputLayout(m_layout);
-	CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
-	CCID3D11DeviceContext->Draw(4,0);
+	CCRenderQueue::sharedRenderQueue()->setProgram(m_pProgram);
+	CCRenderQueue::sharedRenderQueue()->draw(4,0);
 }
 
 
@@ -766,14 +676,16 @@ void CCDXLayerColor::Render(ccVertex2F* squareVertices,ccColor4B* squareColors)
 	{
 		mIsInit = TRUE;
 		FreeBuffer();
-		initVertexBuffer();
 		InitializeShader();
 	}
 	
 	XMMATRIX viewMatrix, projectionMatrix;
 	CCD3DCLASS->GetViewMatrix(viewMatrix);
 	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
-	RenderVertexBuffer(squareVertices,squareColors);
+	if(!RenderVertexBuffer(squareVertices,squareColors))
+	{
+		return;
+	}
 	SetShaderParameters(viewMatrix, projectionMatrix);
 	RenderShader();
 }
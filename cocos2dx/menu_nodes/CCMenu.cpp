@@ -585,17 +585,85 @@ namespace cocos2d{
 		return m_tColor;
 	}
 
+	bool CCMenu::getTouchBounds(CCRect& rect)
+	{
+		updateItemBounds();
+		rect = m_tItemBoundsUnion;
+		return true;
+	}
+
+	void CCMenu::updateItemBounds(void)
+	{
+		// the menu, its items or an ancestor moved
+		unsigned int uEpoch = getWorldTransformEpoch();
+		if (m_bItemBoundsValid && m_uItemBoundsEpoch == uEpoch)
+		{
+			return;
+		}
+
+		m_uItemBoundsEpoch = uEpoch;
+		m_bItemBoundsValid = true;
+		m_tItemBounds.clear();
+		m_tItemBoundsUnion = CCRectZero;
+
+		float fScale = CC_CONTENT_SCALE_FACTOR();
+		float fMinX = 0, fMinY = 0, fMaxX = 0, fMaxY = 0;
+
+        if (m_pChildren && m_pChildren->count() > 0)
+		{
+            CCObject* pObject = NULL;
+            CCARRAY_FOREACH(m_pChildren, pObject)
+            {
+                CCNode* pChild = (CCNode*) pObject;
+
+				// the same box as itemForTouch tests, from pixels in the item space to points in the world
+				CCSize size = ((CCMenuItem*)pChild)->rect().size;
+				CCRect r = CCRectApplyAffineTransform(CCRectMake(0, 0, size.width * fScale, size.height * fScale),
+													  pChild->nodeToWorldTransform());
+				// a little margin so that rounding never makes a touch on the edge miss
+				r = CCRectMake(r.origin.x / fScale - 1, r.origin.y / fScale - 1, r.size.width / fScale + 2, r.size.height / fScale + 2);
+				m_tItemBounds.push_back(r);
+
+				if (m_tItemBounds.size() == 1)
+				{
+					fMinX = CCRect::CCRectGetMinX(r);
+					fMinY = CCRect::CCRectGetMinY(r);
+					fMaxX = CCRect::CCRectGetMaxX(r);
+					fMaxY = CCRect::CCRectGetMaxY(r);
+				}
+				else
+				{
+					fMinX = MIN(fMinX, CCRect::CCRectGetMinX(r));
+					fMinY = MIN(fMinY, CCRect::CCRectGetMinY(r));
+					fMaxX = MAX(fMaxX, CCRect::CCRectGetMaxX(r));
+					fMaxY = MAX(fMaxY, CCRect::CCRectGetMaxY(r));
+				}
+            }
+
+			m_tItemBoundsUnion = CCRectMake(fMinX, fMinY, fMaxX - fMinX, fMaxY - fMinY);
+		}
+	}
+
 	CCMenuItem* CCMenu::itemForTouch(CCTouch *touch)
 	{
 		CCPoint touchLocation = touch->locationInView();
 		touchLocation = CCDirector::sharedDirector()->convertToGL(touchLocation);
 
+		// rules the items out by their cached world box before converting the touch to their space
+		updateItemBounds();
+		unsigned int uItem = 0;
+
         if (m_pChildren && m_pChildren->count() > 0)
 		{
             CCObject* pObject = NULL;
             CCARRAY_FOREACH(m_pChildren, pObject)
             {
                 CCNode* pChild = dynamic_cast<CCNode*>(pObject);
+                if (uItem < m_tItemBounds.size() && ! CCRect::CCRectContainsPoint(m_tItemBounds[uItem++], touchLocation))
+                {
+                    continue;
+                }
+
                 if (pChild && pChild->getIsVisible() && ((CCMenuItem*)pChild)->getIsEnabled())
                 {
                     CCPoint local = pChild->convertToNodeSpace(touchLocation);
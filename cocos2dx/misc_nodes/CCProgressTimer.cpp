@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "CCFileUtils.h"
 #include "DirectXHelper.h"
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace std;
 using namespace DirectX;
@@ -578,7 +580,7 @@ void CCProgressTimer::draw(void)
     bool newBlend = (bf.src != CC_BLEND_SRC || bf.dst != CC_BLEND_DST) ? true : false;
 	if (newBlend) 
 	{
-		CCD3DCLASS->D3DBlendFunc(bf.src, bf.dst);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(bf.src, bf.dst);
 	}
 	
 	///	========================================================================
@@ -606,18 +608,14 @@ void CCProgressTimer::draw(void)
 	mDXProgressTimer.Render(m_pVertexData,m_nVertexDataCount,m_eType,m_pSprite);
 	if( newBlend )
     {
-		CCD3DCLASS->D3DBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
     }
 }
 
 
 CCDXProgressTimer::CCDXProgressTimer()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_matrixBuffer = 0;
-	m_vertexBuffer = 0;
+	m_pProgram = NULL;
 	mIsInit = FALSE;
 }
 CCDXProgressTimer::~CCDXProgressTimer()
@@ -626,11 +624,7 @@ CCDXProgressTimer::~CCDXProgressTimer()
 }
 void CCDXProgressTimer::FreeBuffer()
 {
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_matrixBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_layout);
-	CC_SAFE_RELEASE_NULL_DX(m_pixelShader);
-	CC_SAFE_RELEASE_NULL_DX(m_vertexShader);
+	CC_SAFE_RELEASE_NULL(m_pProgram);
 }
 
 void CCDXProgressTimer::setIsInit(bool isInit)
@@ -640,16 +634,12 @@ void CCDXProgressTimer::setIsInit(bool isInit)
 
 void CCDXProgressTimer::RenderVertexBuffer()
 {
-	unsigned int stride = sizeof(VertexType); 
-	unsigned int offset = 0;
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
-	CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	// the vertices were bound by initVertexBuffer
+	CCRenderQueue::sharedRenderQueue()->setTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 }
 
-void CCDXProgressTimer::initVertexBuffer(ccV2F_C4B_T2F *vertexData,int& vertexDataCount,CCProgressTimerType eType)
+bool CCDXProgressTimer::initVertexBuffer(ccV2F_C4B_T2F *vertexData,int& vertexDataCount,CCProgressTimerType eType)
 {
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
-
 	int tmpVertexDataCount = vertexDataCount;
 	if(eType == kCCProgressTimerTypeRadialCCW || eType == kCCProgressTimerTypeRadialCW)
 	{
@@ -678,7 +668,7 @@ void CCDXProgressTimer::initVertexBuffer(ccV2F_C4B_T2F *vertexData,int& vertexDa
 	VertexType* vertices = new VertexType[tmpVertexDataCount];
 	if (!vertices)
 	{
-		return;
+		return false;
 	}
 	memset(vertices, 0, (sizeof(VertexType) * tmpVertexDataCount));
 	if(eType == kCCProgressTimerTypeRadialCCW || eType == kCCProgressTimerTypeRadialCW)
@@ -760,43 +750,15 @@ void CCDXProgressTimer::initVertexBuffer(ccV2F_C4B_T2F *vertexData,int& vertexDa
 	}
 	vertexDataCount = tmpVertexDataCount;
 
-	D3D11_BUFFER_DESC vertexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexDataTmp;
-	HRESULT result;
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType)*tmpVertexDataCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the vertex data.
-	vertexDataTmp.pSysMem = vertices;
-	vertexDataTmp.SysMemPitch = 0;
-	vertexDataTmp.SysMemSlicePitch = 0;
-
-	// Now create the vertex buffer.
-	result = CCID3D11Device->CreateBuffer(&vertexBufferDesc, &vertexDataTmp, &m_vertexBuffer);
-	if(FAILED(result))
-	{
-		CC_SAFE_DELETE_ARRAY(vertices);
-		return ;
-	}
+	// Copy the vertices to the shared ring and set them active in the input assembler.
+	bool bRet = CCDynamicBuffers::sharedDynamicBuffers()->setVertices(0, vertices, sizeof(VertexType), tmpVertexDataCount);
 
 	CC_SAFE_DELETE_ARRAY(vertices);
+	return bRet;
 }
 
 bool CCDXProgressTimer::InitializeShader()
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-	// Initialize the pointers this function will use to null.
-	errorMessage = 0;
-
-	BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 	D3D11_INPUT_ELEMENT_DESC layoutDesc[] = 
 	{
 		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -804,35 +766,15 @@ bool CCDXProgressTimer::InitializeShader()
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 	};
 
-	loader->LoadShader(
+	m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 		L"CCProgressTimerVertexShader.cso",
 		layoutDesc,
 		ARRAYSIZE(layoutDesc),
-		&m_vertexShader,
-		&m_layout
-		);
-
-	loader->LoadShader(
-		L"CCProgressTimerPixelShader.cso",
-		&m_pixelShader
+		L"CCProgressTimerPixelShader.cso"
 		);
+	CC_SAFE_RETAIN(m_pProgram);
 
-	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	return true;
+	return m_pProgram != NULL;
 }
 
 void CCDXProgressTimer::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
@@ -873,52 +815,35 @@ void CCDXProgressTimer::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND
 
 bool CCDXProgressTimer::SetShaderParameters(XMMATRIX &viewMatrix,XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
 {
-	HRESULT result;
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
+	MatrixBufferType matrices;
 	unsigned int bufferNumber;
 
 
 	// Transpose the matrices to prepare them for the shader.
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-	// Lock the constant buffer so it can be written to.
-	result = CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	// Get a pointer to the data in the constant buffer.
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-
-	// Copy the matrices into the constant buffer.
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-
-	// Unlock the constant buffer.
-	CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+	matrices.view = XMMatrixTranspose(viewMatrix);
+	matrices.projection = XMMatrixTranspose(projectionMatrix);
 
 	// Set the position of the constant buffer in the vertex shader.
 	bufferNumber = 0;
 
-	// Now set the constant buffer in the vertex shader with the updated values.
-	CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
+	// Copy the matrices to the shared constant ring and set them in the vertex shader.
+	if(!CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices)))
+	{
+		return false;
+	}
 
 	// Set shader texture resource in the pixel shader.
-	CCID3D11DeviceContext->PSSetShaderResources(0, 1, &texture);
+	CCRenderQueue::sharedRenderQueue()->setTexture(texture);
 
 	return true;
 }
 
 void CCDXProgressTimer::RenderShader(int& vertexDataCount,CCSprite *pSprite)
 {
-	CCID3D11DeviceContext->IASetInputLayout(m_layout);
-	CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetSamplers(0, 1, pSprite->getTexture()->GetSamplerState());
-	CCID3D11DeviceContext->Draw(vertexDataCount,0);
+	CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
+	pQueue->setProgram(m_pProgram);
+	pQueue->setSampler(*pSprite->getTexture()->GetSamplerState());
+	pQueue->draw(vertexDataCount,0);
 	return;
 }
 
@@ -931,7 +856,10 @@ void CCDXProgressTimer::Render(ccV2F_C4B_T2F *vertexData,int& vertexDataCount,CC
 		FreeBuffer();
 		InitializeShader();
 	}
-	initVertexBuffer(vertexData,vertexDataCount,eType);
+	if(!initVertexBuffer(vertexData,vertexDataCount,eType))
+	{
+		return;
+	}
 	XMMATRIX viewMatrix, projectionMatrix;
 
 	// Get the world, view, and projection matrices from the camera and d3d objects.
@@ -0,0 +1,295 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCRenderTargetPool.h"
+#include "CCDirector.h"
+#include "ccConfig.h"
+#include "ccMacros.h"
+#include "CCGL.h"
+
+namespace cocos2d {
+
+static CCRenderTargetPool *g_sharedRenderTargetPool = NULL;
+
+static unsigned int bytesPerPixelForFormat(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_R8G8_UNORM:
+		return 2;
+	case DXGI_FORMAT_A8_UNORM:
+		return 1;
+	default:
+		return 4;
+	}
+}
+
+// implementation of CCRenderTarget
+
+CCRenderTarget::CCRenderTarget()
+: m_pTexture(NULL)
+, m_pRenderTargetView(NULL)
+, m_pDepthStencil(NULL)
+, m_pDepthStencilView(NULL)
+, m_eUsage(kCCRenderTargetUsageColor)
+, m_uBytes(0)
+, m_uLastUsedFrame(0)
+{
+}
+
+CCRenderTarget::~CCRenderTarget()
+{
+	CC_SAFE_RELEASE_NULL_DX(m_pDepthStencilView);
+	CC_SAFE_RELEASE_NULL_DX(m_pDepthStencil);
+	CC_SAFE_RELEASE_NULL_DX(m_pRenderTargetView);
+	CC_SAFE_RELEASE(m_pTexture);
+}
+
+bool CCRenderTarget::initWithSize(unsigned int uWidth, unsigned int uHeight, CCTexture2DPixelFormat eFormat, CCRenderTargetUsage eUsage)
+{
+	bool bRet = false;
+	ID3D11Resource *pResource = NULL;
+	do
+	{
+		CC_BREAK_IF(0 == uWidth || 0 == uHeight);
+
+		void *data = calloc(uWidth * uHeight * 4, 1);
+		CC_BREAK_IF(! data);
+
+		m_pTexture = new CCTexture2D();
+		m_pTexture->initWithData(data, eFormat, uWidth, uHeight, CCSizeMake((float)uWidth, (float)uHeight));
+		free(data);
+		CC_BREAK_IF(! m_pTexture->getTextureResource());
+
+		ID3D11Device *pDevice = CCID3D11Device;
+		m_pTexture->getTextureResource()->GetResource(&pResource);
+
+		D3D11_TEXTURE2D_DESC texDesc;
+		((ID3D11Texture2D*)pResource)->GetDesc(&texDesc);
+
+		D3D11_RENDER_TARGET_VIEW_DESC rtvDesc;
+		ZeroMemory(&rtvDesc, sizeof(D3D11_RENDER_TARGET_VIEW_DESC));
+		rtvDesc.Format = texDesc.Format;
+		rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+		rtvDesc.Texture2D.MipSlice = 0;
+		CC_BREAK_IF(FAILED(pDevice->CreateRenderTargetView(pResource, &rtvDesc, &m_pRenderTargetView)));
+
+		m_uBytes = uWidth * uHeight * bytesPerPixelForFormat(texDesc.Format);
+
+		if (kCCRenderTargetUsageColorDepth == eUsage)
+		{
+			CD3D11_TEXTURE2D_DESC depthStencilDesc(DXGI_FORMAT_D24_UNORM_S8_UINT, uWidth, uHeight, 1, 1, D3D11_BIND_DEPTH_STENCIL);
+			CC_BREAK_IF(FAILED(pDevice->CreateTexture2D(&depthStencilDesc, NULL, &m_pDepthStencil)));
+
+			CD3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc(D3D11_DSV_DIMENSION_TEXTURE2D);
+			CC_BREAK_IF(FAILED(pDevice->CreateDepthStencilView(m_pDepthStencil, &dsvDesc, &m_pDepthStencilView)));
+
+			// D24S8
+			m_uBytes += uWidth * uHeight * 4;
+		}
+
+		m_eUsage = eUsage;
+		bRet = true;
+	} while (0);
+
+	CC_SAFE_RELEASE_NULL_DX(pResource);
+	return bRet;
+}
+
+bool CCRenderTarget::matches(unsigned int uWidth, unsigned int uHeight, CCTexture2DPixelFormat eFormat, CCRenderTargetUsage eUsage)
+{
+	return m_eUsage == eUsage
+		&& m_pTexture->getPixelFormat() == eFormat
+		&& m_pTexture->getPixelsWide() == uWidth
+		&& m_pTexture->getPixelsHigh() == uHeight;
+}
+
+// implementation of CCRenderTargetPool
+
+CCRenderTargetPool* CCRenderTargetPool::sharedRenderTargetPool(void)
+{
+	if (! g_sharedRenderTargetPool)
+	{
+		g_sharedRenderTargetPool = new CCRenderTargetPool();
+	}
+	return g_sharedRenderTargetPool;
+}
+
+void CCRenderTargetPool::purgeSharedRenderTargetPool(void)
+{
+	CC_SAFE_RELEASE_NULL(g_sharedRenderTargetPool);
+}
+
+CCRenderTargetPool::CCRenderTargetPool()
+: m_uMemoryLimit(CC_RENDER_TARGET_POOL_MEMORY_LIMIT)
+, m_uFrame(0)
+{
+	m_pIdleTargets = new CCMutableArray<CCRenderTarget*>();
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+CCRenderTargetPool::~CCRenderTargetPool()
+{
+	CCLOGINFO("cocos2d: deallocing CCRenderTargetPool.");
+	CC_SAFE_RELEASE(m_pIdleTargets);
+}
+
+CCRenderTarget* CCRenderTargetPool::acquire(unsigned int uWidth, unsigned int uHeight, CCTexture2DPixelFormat eFormat, CCRenderTargetUsage eUsage)
+{
+	CCRenderTarget *pTarget = NULL;
+
+	// most recently recycled first, it is the most likely to still be resident
+	for (int i = (int)m_pIdleTargets->count() - 1; i >= 0; --i)
+	{
+		CCRenderTarget *pIdle = m_pIdleTargets->getObjectAtIndex(i);
+		if (pIdle->matches(uWidth, uHeight, eFormat, eUsage) && ! pIdle->isTextureShared())
+		{
+			pTarget = pIdle;
+			pTarget->retain();
+			m_pIdleTargets->removeObjectAtIndex(i);
+			m_tStats.uPooledBytes -= pTarget->getSizeInBytes();
+			break;
+		}
+	}
+
+	if (pTarget)
+	{
+		// the last user may have set other tex parameters, a new target has the default sampler
+		pTarget->getTexture()->setAntiAliasTexParameters();
+
+		// a new target starts out zeroed, so does a recycled one
+		const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		ID3D11DeviceContext *pContext = CCID3D11DeviceContext;
+		pContext->ClearRenderTargetView(pTarget->getRenderTargetView(), clearColor);
+		if (pTarget->getDepthStencilView())
+		{
+			pContext->ClearDepthStencilView(pTarget->getDepthStencilView(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+		}
+
+		++m_tStats.uReusesThisFrame;
+		++m_tStats.uTotalReuses;
+	}
+	else
+	{
+		pTarget = new CCRenderTarget();
+		if (! pTarget->initWithSize(uWidth, uHeight, eFormat, eUsage))
+		{
+			CCLOG("cocos2d: CCRenderTargetPool: could not create a %ux%u render target", uWidth, uHeight);
+			CC_SAFE_RELEASE(pTarget);
+			return NULL;
+		}
+
+		++m_tStats.uAllocationsThisFrame;
+		++m_tStats.uTotalAllocations;
+	}
+
+	pTarget->m_uLastUsedFrame = m_uFrame;
+	m_tStats.uInUseBytes += pTarget->getSizeInBytes();
+	if (m_tStats.uInUseBytes + m_tStats.uPooledBytes > m_tStats.uPeakBytes)
+	{
+		m_tStats.uPeakBytes = m_tStats.uInUseBytes + m_tStats.uPooledBytes;
+	}
+
+	return pTarget;
+}
+
+void CCRenderTargetPool::recycle(CCRenderTarget *pTarget)
+{
+	if (! pTarget)
+	{
+		return;
+	}
+
+	// the target may come from a pool purged since it was acquired
+	m_tStats.uInUseBytes -= MIN(m_tStats.uInUseBytes, pTarget->getSizeInBytes());
+	m_tStats.uPooledBytes += pTarget->getSizeInBytes();
+	pTarget->m_uLastUsedFrame = m_uFrame;
+
+	m_pIdleTargets->addObject(pTarget);
+	pTarget->release();
+
+	trimToLimit(m_uMemoryLimit);
+}
+
+void CCRenderTargetPool::frameEnded(void)
+{
+	++m_uFrame;
+	m_tStats.uAllocationsThisFrame = 0;
+	m_tStats.uReusesThisFrame = 0;
+}
+
+void CCRenderTargetPool::setMemoryLimit(unsigned int uBytes)
+{
+	m_uMemoryLimit = uBytes;
+	trimToLimit(m_uMemoryLimit);
+}
+
+void CCRenderTargetPool::removeUnusedTargets(void)
+{
+	trimToLimit(0);
+}
+
+void CCRenderTargetPool::trimToLimit(unsigned int uLimit)
+{
+	while (m_tStats.uPooledBytes > uLimit && m_pIdleTargets->count())
+	{
+		// idle targets are appended as they are recycled, so the front is the least recently used
+		CCRenderTarget *pTarget = m_pIdleTargets->getObjectAtIndex(0);
+		m_tStats.uPooledBytes -= pTarget->getSizeInBytes();
+		++m_tStats.uEvictions;
+		m_pIdleTargets->removeObjectAtIndex(0);
+	}
+}
+
+void CCRenderTargetPool::dumpStats(void)
+{
+	CCLOG("cocos2d: CCRenderTargetPool: %u idle targets, %u KB idle, %u KB in use, %u KB peak, limit %u KB",
+		m_pIdleTargets->count(),
+		m_tStats.uPooledBytes / 1024,
+		m_tStats.uInUseBytes / 1024,
+		m_tStats.uPeakBytes / 1024,
+		m_uMemoryLimit / 1024);
+	CCLOG("cocos2d: CCRenderTargetPool: this frame %u allocations, %u reuses; total %u allocations, %u reuses, %u evictions",
+		m_tStats.uAllocationsThisFrame,
+		m_tStats.uReusesThisFrame,
+		m_tStats.uTotalAllocations,
+		m_tStats.uTotalReuses,
+		m_tStats.uEvictions);
+
+	CCMutableArray<CCRenderTarget*>::CCMutableArrayIterator it;
+	for (it = m_pIdleTargets->begin(); it != m_pIdleTargets->end(); ++it)
+	{
+		CCTexture2D *pTexture = (*it)->getTexture();
+		CCLOG("cocos2d: \t%u x %u, %u KB, last used %u frames ago%s",
+			pTexture->getPixelsWide(),
+			pTexture->getPixelsHigh(),
+			(*it)->getSizeInBytes() / 1024,
+			m_uFrame - (*it)->m_uLastUsedFrame,
+			(*it)->isTextureShared() ? ", texture still referenced" : "");
+	}
+}
+
+}//namespace cocos2d
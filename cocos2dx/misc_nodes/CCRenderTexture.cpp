@@ -25,6 +25,7 @@ THE SOFTWARE.
 
 #include "CCConfiguration.h"
 #include "CCRenderTexture.h"
+#include "CCRenderTargetPool.h"
 #include "CCDirector.h"
 #include "platform/platform.h"
 #include "CCImage.h"
@@ -32,6 +33,8 @@ THE SOFTWARE.
 #include "CCTextureCache.h"
 #include "CCFileUtils.h"
 #include "CCGL.h"
+#include "CCDrawingPrimitives.h"
+#include "CCRenderQueue.h"
 
 namespace cocos2d { 
 
@@ -43,6 +46,8 @@ CCRenderTexture::CCRenderTexture()
 , m_pTexture(0)
 , m_pUITextureImage(NULL)
 , m_ePixelFormat(kCCTexture2DPixelFormat_RGBA8888)
+, m_pRenderTarget(NULL)
+, m_renderTargetView(NULL)
 {
 }
 
@@ -109,25 +114,18 @@ bool CCRenderTexture::initWithWidthAndHeight(int w, int h, CCTexture2DPixelForma
         unsigned int powW = w;//=ccNextPOT(w);
         unsigned int powH = h;//=ccNextPOT(h);
 
-        void *data = malloc((int)(powW * powH * 4));
-        CC_BREAK_IF(! data);
-
-        memset(data, 0, (int)(powW * powH * 4));
         m_ePixelFormat = eFormat;
 
-        m_pTexture = new CCTexture2D();
-        CC_BREAK_IF(! m_pTexture);
-
-		m_pTexture->initWithData(data, (CCTexture2DPixelFormat)m_ePixelFormat, powW, powH, CCSizeMake((float)w, (float)h));
-		free( data );
+        m_pRenderTarget = CCRenderTargetPool::sharedRenderTargetPool()->acquire(powW, powH, eFormat, kCCRenderTargetUsageColor);
+        CC_BREAK_IF(! m_pRenderTarget);
 
-		Initialize(CCID3D11Device, powW, powH);
+        m_pTexture = m_pRenderTarget->getTexture();
+        m_renderTargetView = m_pRenderTarget->getRenderTargetView();
 
         m_pTexture->setAliasTexParameters();
 
         m_pSprite = CCSprite::spriteWithTexture(m_pTexture);
 
-		m_pTexture->release();
 		//=m_pSprite->setScaleY(-1);
 		this->addChild(m_pSprite);
 
@@ -142,9 +140,14 @@ bool CCRenderTexture::initWithWidthAndHeight(int w, int h, CCTexture2DPixelForma
 
 void CCRenderTexture::begin()
 {
+	// the draws queued so far go to the previous target, and binding the texture
+	// as the target takes it off the pixel shader
+	CCRenderQueue::sharedRenderQueue()->flush();
+
 	// Save the current matrix
 	CCD3DCLASS->D3DPushMatrix();
 	SetRenderTarget(CCD3DCLASS->GetDeviceContext(), CCD3DCLASS->GetDepthStencilView());
+	CCRenderQueue::sharedRenderQueue()->invalidateState();
 
 	const CCSize& texSize = m_pTexture->getContentSizeInPixels();
 
@@ -172,7 +175,10 @@ void CCRenderTexture::beginWithClear(float r, float g, float b, float a)
 
 void CCRenderTexture::end(bool bIsTOCacheTexture)
 {
-	
+	// the primitives drawn since begin() go to the texture
+	ccDrawFlush();
+	CCRenderQueue::sharedRenderQueue()->flush();
+
 	// Restore the original matrix and viewport
 	CCD3DCLASS->D3DPopMatrix();
 	CCD3DCLASS->SetBackBufferRenderTarget();
@@ -331,12 +337,17 @@ bool CCRenderTexture::getUIImageFromBuffer(CCImage *pImage, int x, int y, int nW
 
 		eglView->GetDeviceContext()->CopyResource(pStagingTexture, tmpResource);
 
-		eglView->GetDeviceContext()->Map(pStagingTexture, 0, D3D11_MAP_READ, 0, &Subresource);
+		// with the render pipeline the copy is only recorded, run it before reading
+		CCDirector::sharedDirector()->getRenderPipeline()->finish();
+		eglView->lockImmediateContext();
+
+		eglView->GetImmediateContext()->Map(pStagingTexture, 0, D3D11_MAP_READ, 0, &Subresource);
 
 		//void* pData = Subresource.pData;
 		memcpy(pTempData,Subresource.pData,sizeof(byte)*nReadBufferWidth * nReadBufferHeight * 4);
 
-		eglView->GetDeviceContext()->Unmap(pStagingTexture, 0);
+		eglView->GetImmediateContext()->Unmap(pStagingTexture, 0);
+		eglView->unlockImmediateContext();
 
 		if ( pStagingTexture )
 		{
@@ -478,11 +489,16 @@ void CCRenderTexture::CopyResource()
 
 	eglView->GetDeviceContext()->CopyResource(pStagingTexture, tmpResource);
 
-	eglView->GetDeviceContext()->Map(pStagingTexture, 0, D3D11_MAP_READ, 0, &Subresource);
+	// with the render pipeline the copy is only recorded, run it before reading
+	CCDirector::sharedDirector()->getRenderPipeline()->finish();
+	eglView->lockImmediateContext();
+
+	eglView->GetImmediateContext()->Map(pStagingTexture, 0, D3D11_MAP_READ, 0, &Subresource);
 
 	void* pData = Subresource.pData;
 
-	eglView->GetDeviceContext()->Unmap(pStagingTexture, 0);
+	eglView->GetImmediateContext()->Unmap(pStagingTexture, 0);
+	eglView->unlockImmediateContext();
 
 	if ( pStagingTexture )
 	{
@@ -492,42 +508,15 @@ void CCRenderTexture::CopyResource()
 	
 }
 
-bool CCRenderTexture::Initialize(ID3D11Device* device, int textureWidth, int textureHeight)
-{
-	HRESULT result;
-	D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc;
-
-	ID3D11ShaderResourceView* tmpShaderResourceView=m_pTexture->getTextureResource();
-	ID3D11Resource* tmpResource;
-	tmpShaderResourceView->GetResource(&tmpResource);
-
-	D3D11_TEXTURE2D_DESC pDesc;
-	((ID3D11Texture2D*)tmpResource)->GetDesc(&pDesc);
-	ZeroMemory(&renderTargetViewDesc,sizeof(D3D11_RENDER_TARGET_VIEW_DESC));
-	// Setup the description of the render target view.
-	renderTargetViewDesc.Format = pDesc.Format;//textureDesc.Format;
-	renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-	renderTargetViewDesc.Texture2D.MipSlice = 0;
-
-	// Create the render target view.
-	result = device->CreateRenderTargetView(tmpResource, &renderTargetViewDesc, &m_renderTargetView);
-
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	return true;
-}
-
 void CCRenderTexture::Shutdown()
 {
-
-	if(m_renderTargetView)
+	if (m_pRenderTarget)
 	{
-		m_renderTargetView->Release();
-		m_renderTargetView = 0;
+		CCRenderTargetPool::sharedRenderTargetPool()->recycle(m_pRenderTarget);
+		m_pRenderTarget = NULL;
 	}
+	m_renderTargetView = NULL;
+	m_pTexture = NULL;
 
 	return;
 }
@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include "DirectXHelper.h"
 #include <fstream>
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace std;
 using namespace DirectX;
@@ -271,7 +273,7 @@ void CCRibbon::draw()
         bool newBlend = ( m_tBlendFunc.src != CC_BLEND_SRC || m_tBlendFunc.dst != CC_BLEND_DST ) ? true : false;
         if( newBlend )
         {
-            CCD3DCLASS->D3DBlendFunc( m_tBlendFunc.src, m_tBlendFunc.dst );
+            CCRenderQueue::sharedRenderQueue()->setBlendFunc( m_tBlendFunc.src, m_tBlendFunc.dst );
         }
 
 		if(m_pSegments && m_pSegments->count() > 0)
@@ -287,7 +289,7 @@ void CCRibbon::draw()
 
 		if( newBlend )
 		{
-			CCD3DCLASS->D3DBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+			CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
 		}
 
 	}
@@ -428,11 +430,7 @@ void CCRibbonSegment::draw(float curTime, float fadeTime, const ccColor4B& color
 
 CCDXRibbonSegment::CCDXRibbonSegment()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_matrixBuffer = 0;
-	m_vertexBuffer = 0;
+	m_pProgram = NULL;
 	mIsInit = FALSE;
 }
 CCDXRibbonSegment::~CCDXRibbonSegment()
@@ -441,11 +439,7 @@ CCDXRibbonSegment::~CCDXRibbonSegment()
 }
 void CCDXRibbonSegment::FreeBuffer()
 {
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_matrixBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_layout);
-	CC_SAFE_RELEASE_NULL_DX(m_pixelShader);
-	CC_SAFE_RELEASE_NULL_DX(m_vertexShader);
+	CC_SAFE_RELEASE_NULL(m_pProgram);
 }
 
 void CCDXRibbonSegment::setIsInit(bool isInit)
@@ -453,89 +447,35 @@ void CCDXRibbonSegment::setIsInit(bool isInit)
 	mIsInit = isInit;
 }
 
-void CCDXRibbonSegment::RenderVertexBuffer(CCfloat* verts,CCfloat* coords,CCubyte* colors)
+bool CCDXRibbonSegment::RenderVertexBuffer(CCfloat* verts,CCfloat* coords,CCubyte* colors)
 {
-	VertexType* verticesTmp;
-	// Create the vertex array.
-	verticesTmp = new VertexType[100];
+	// The vertices are written straight to the shared ring.
+	unsigned int offset;
+	VertexType* verticesTmp = (VertexType*)CCDynamicBuffers::sharedDynamicBuffers()->mapVertices(sizeof(VertexType), 100, &offset);
 	if(!verticesTmp)
 	{
-		return ;
+		return false;
 	}
-	memset(verticesTmp,0,sizeof(VertexType)*100);
 
+	// in one pass and in order, the mapped memory is write combined
 	for ( int i=0; i<100; i++ )
 	{
+		verticesTmp[i].position = XMFLOAT3(verts[i*3], verts[i*3+1], verts[i*3+2]);
 		verticesTmp[i].color = XMFLOAT4(colors[i*4]/255.f, colors[i*4+1]/255.f, colors[i*4+2]/255.f, colors[i*4+3]/255.f);
-	}
-	for ( int i=0; i<100; i++ )
-	{
 		verticesTmp[i].texture = XMFLOAT2(coords[i*2], coords[i*2+1]);
-		verticesTmp[i].position = XMFLOAT3(verts[i*3], verts[i*3+1], verts[i*3+2]);
-	}
-
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-	if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
-	{
-		delete[] verticesTmp;
-		return;
 	}
-	verticesPtr = (VertexType*)mappedResource.pData;
-	memcpy(verticesPtr, (void*)verticesTmp, (sizeof(VertexType) * 100));
-	CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
 
-	if ( verticesTmp )
-	{
-		delete[] verticesTmp;
-		verticesTmp = 0;
-	}
+	CCDynamicBuffers::sharedDynamicBuffers()->unmapVertices();
 
 	////////////////////////
-	unsigned int stride;
-	unsigned int offset;
-	stride = sizeof(VertexType); 
-	offset = 0;
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
-	CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	CCDynamicBuffers::sharedDynamicBuffers()->bindVertices(0, sizeof(VertexType), offset);
+	CCRenderQueue::sharedRenderQueue()->setTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
-	return;
-}
-
-void CCDXRibbonSegment::initVertexBuffer()
-{
-	D3D11_BUFFER_DESC vertexBufferDesc;
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType)*100;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Now create the vertex buffer.
-	if(FAILED(CCID3D11Device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer)))
-	{
-		return ;
-	}
+	return true;
 }
 
 bool CCDXRibbonSegment::InitializeShader()
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	//ID3D10Blob* vertexShaderBuffer;
-	//ID3D10Blob* pixelShaderBuffer;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-	//D3D11_SAMPLER_DESC samplerDesc;
-
-	// Initialize the pointers this function will use to null.
-	errorMessage = 0;
-	//vertexShaderBuffer = 0;
-	//pixelShaderBuffer = 0;
-
-	BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 	D3D11_INPUT_ELEMENT_DESC layoutDesc[] = 
 	{
 		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -543,36 +483,15 @@ bool CCDXRibbonSegment::InitializeShader()
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 	};
 
-	loader->LoadShader(
+	m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 		L"CCRibbonSegmentVertexShader.cso",
 		layoutDesc,
 		ARRAYSIZE(layoutDesc),
-		&m_vertexShader,
-		&m_layout
+		L"CCRibbonSegmentPixelShader.cso"
 		);
+	CC_SAFE_RETAIN(m_pProgram);
 
-	loader->LoadShader(
-		L"CCRibbonSegmentPixelShader.cso",
-		&m_pixelShader
-		);
-
-
-	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	return true;
+	return m_pProgram != NULL;
 }
 
 void CCDXRibbonSegment::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
@@ -613,35 +532,26 @@ void CCDXRibbonSegment::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND
 
 bool CCDXRibbonSegment::SetShaderParameters(XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
 {
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
+	MatrixBufferType matrices;
 	unsigned int bufferNumber;
 
 	// Transpose the matrices to prepare them for the shader.
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-	// Lock the constant buffer so it can be written to.
-	if(FAILED(CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource))){return false;}
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-	CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+	matrices.view = XMMatrixTranspose(viewMatrix);
+	matrices.projection = XMMatrixTranspose(projectionMatrix);
 
 	bufferNumber = 0;
-	CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
-	CCID3D11DeviceContext->PSSetShaderResources(0, 1, &texture);
+	if(!CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices))){return false;}
+	CCRenderQueue::sharedRenderQueue()->setTexture(texture);
 
 	return true;
 }
 
 void CCDXRibbonSegment::RenderShader(unsigned int begin,unsigned int end,CCTexture2D* texture)
 {
-	CCID3D11DeviceContext->IASetInputLayout(m_layout);
-	CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetSamplers(0, 1, texture->GetSamplerState());
-	CCID3D11DeviceContext->Draw((end - begin)*2,begin*2);
+	CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
+	pQueue->setProgram(m_pProgram);
+	pQueue->setSampler(*texture->GetSamplerState());
+	pQueue->draw((end - begin)*2,begin*2);
 
 	return;
 }
@@ -654,7 +564,6 @@ void CCDXRibbonSegment::Render(CCfloat* verts,CCfloat* coords,CCubyte* colors,un
 	{
 		mIsInit = TRUE;
 		FreeBuffer();
-		initVertexBuffer();
 		InitializeShader();
 	}
 	
@@ -665,7 +574,10 @@ void CCDXRibbonSegment::Render(CCfloat* verts,CCfloat* coords,CCubyte* colors,un
 	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
 
 	// Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing.
-	RenderVertexBuffer(verts,coords,colors);
+	if(!RenderVertexBuffer(verts,coords,colors))
+	{
+		return;
+	}
 
 	// Set the shader parameters that it will use for rendering.
 	SetShaderParameters(viewMatrix, projectionMatrix, texture->getTextureResource());
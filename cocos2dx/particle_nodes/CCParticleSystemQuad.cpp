@@ -33,6 +33,8 @@ THE SOFTWARE.
 #include "CCFileUtils.h"
 #include "DirectXHelper.h"
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace std;
 using namespace DirectX;
@@ -320,7 +322,7 @@ void CCParticleSystemQuad::draw()
     bool newBlend = (m_tBlendFunc.src != CC_BLEND_SRC || m_tBlendFunc.dst != CC_BLEND_DST) ? true : false;
 	if( newBlend ) 
 	{
-		CCD3DCLASS->D3DBlendFunc( m_tBlendFunc.src, m_tBlendFunc.dst );
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc( m_tBlendFunc.src, m_tBlendFunc.dst );
 	}
 
     CCAssert( m_uParticleIdx == m_uParticleCount, "Abnormal error in particle quad");
@@ -330,7 +332,7 @@ void CCParticleSystemQuad::draw()
 	// restore blend state
 	if( newBlend )
 	{
-		CCD3DCLASS->D3DBlendFunc( CC_BLEND_SRC, CC_BLEND_DST );
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc( CC_BLEND_SRC, CC_BLEND_DST );
 	}
 
 #if CC_USES_VBO
@@ -344,12 +346,8 @@ void CCParticleSystemQuad::draw()
 
 CCDXParticleSystemQuad::CCDXParticleSystemQuad()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_inputLayout = 0;
-	m_matrixBuffer = 0;
+	m_pProgram = NULL;
 	m_indexBuffer = 0;
-	m_vertexBuffer = 0;
 	//there is no any allocated memory yet
 	m_uMaxTotalParticles = 0;
 
@@ -361,12 +359,8 @@ CCDXParticleSystemQuad::~CCDXParticleSystemQuad()
 }
 void CCDXParticleSystemQuad::FreeBuffer()
 {
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
 	CC_SAFE_RELEASE_NULL_DX(m_indexBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_matrixBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_inputLayout);
-	CC_SAFE_RELEASE_NULL_DX(m_pixelShader);
-	CC_SAFE_RELEASE_NULL_DX(m_vertexShader);
+	CC_SAFE_RELEASE_NULL(m_pProgram);
 }
 
 void CCDXParticleSystemQuad::setIsInit(bool isInit)
@@ -374,32 +368,10 @@ void CCDXParticleSystemQuad::setIsInit(bool isInit)
 	m_bIsInit = isInit;
 }
 
-void CCDXParticleSystemQuad::initVertexAndIndexBuffer(unsigned short* indices, unsigned int uTotalParticles)
+void CCDXParticleSystemQuad::initIndexBuffer(unsigned short* indices, unsigned int uTotalParticles)
 {
-	int vertexCount = uTotalParticles * 4;
+	// the vertices go to the shared geometry ring, only the indices are kept here
 	//CCLog("Last indxCount:%d)", uTotalParticles*6);
-	D3D11_BUFFER_DESC vertexBufferDesc;
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType)*vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	if(m_vertexBuffer)
-	{
-		m_vertexBuffer->Release();
-		m_vertexBuffer = 0;
-	}
-
-	// Now create the vertex buffer.
-	if(FAILED(CCID3D11Device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer)))
-	{
-		return ;
-	}
-
 	D3D11_BUFFER_DESC indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA indexData;
 	ZeroMemory( &indexBufferDesc, sizeof(indexBufferDesc) );
@@ -427,17 +399,16 @@ void CCDXParticleSystemQuad::initVertexAndIndexBuffer(unsigned short* indices, u
 	}
 }
 
-void CCDXParticleSystemQuad::RenderVertexBuffer(ccV2F_C4B_T2F_Quad *quad,unsigned int uTotalParticles)
+bool CCDXParticleSystemQuad::RenderVertexBuffer(ccV2F_C4B_T2F_Quad *quad,unsigned int particleIdx)
 {
-	VertexType* verticesTmp;
-	// Create the vertex array.
-	verticesTmp = new VertexType[uTotalParticles * 4];
+	// Only the live particles are drawn, their vertices are written straight to the shared ring.
+	unsigned int offset;
+	VertexType* verticesTmp = (VertexType*)CCDynamicBuffers::sharedDynamicBuffers()->mapVertices(sizeof(VertexType), particleIdx * 4, &offset);
 	if(!verticesTmp)
 	{
-		return ;
+		return false;
 	}
-	ZeroMemory(verticesTmp,sizeof(VertexType)*uTotalParticles * 4);
-	for ( int i=0; i<uTotalParticles; i++ )
+	for ( unsigned int i=0; i<particleIdx; i++ )
 	{
 		verticesTmp[4*i+0].position = XMFLOAT2(quad->tl.vertices.x, quad->tl.vertices.y);
 		verticesTmp[4*i+1].position = XMFLOAT2(quad->tr.vertices.x, quad->tr.vertices.y);
@@ -457,51 +428,22 @@ void CCDXParticleSystemQuad::RenderVertexBuffer(ccV2F_C4B_T2F_Quad *quad,unsigne
 		quad++;
 	}
 
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-	HRESULT result;
-	
-	result = CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if(FAILED(result))
-	{
-		// clean up allocated resources
-		delete[] verticesTmp;
-		return ;
-	}
-	verticesPtr = (VertexType*)mappedResource.pData;
-	memcpy(verticesPtr, (void*)verticesTmp, (sizeof(VertexType) * uTotalParticles * 4));
-	CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
-
-	if ( verticesTmp )
-	{
-		delete[] verticesTmp;
-		verticesTmp = 0;
-	}
+	CCDynamicBuffers::sharedDynamicBuffers()->unmapVertices();
 
 	////////////////////////
-	unsigned int stride;
-	unsigned int offset;
-	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType); 
-	offset = 0;
-
 	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	CCDynamicBuffers::sharedDynamicBuffers()->bindVertices(0, sizeof(VertexType), offset);
 
-	CCID3D11DeviceContext->IASetIndexBuffer( m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+	CCRenderQueue::sharedRenderQueue()->setIndexBuffer(m_indexBuffer);
 
 	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-	CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	CCRenderQueue::sharedRenderQueue()->setTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-	return;
+	return true;
 }
 
 bool CCDXParticleSystemQuad::InitializeShader()
 {
-	HRESULT result;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-
-	 BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 	 D3D11_INPUT_ELEMENT_DESC layoutDesc[] = 
 	 {
 		 { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -509,35 +451,15 @@ bool CCDXParticleSystemQuad::InitializeShader()
 		 { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 	 };
 
-	 loader->LoadShader(
+	 m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 		 L"CCParticleVertexShader.cso",
 		 layoutDesc,
 		 ARRAYSIZE(layoutDesc),
-		 &m_vertexShader,
-		 &m_inputLayout
+		 L"CCParticlePixelShader.cso"
 		 );
+	 CC_SAFE_RETAIN(m_pProgram);
 
-	 loader->LoadShader(
-		 L"CCParticlePixelShader.cso",
-		 &m_pixelShader
-		 );	
-
-	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	return true;
+	return m_pProgram != NULL;
 }
 
 void CCDXParticleSystemQuad::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
@@ -576,58 +498,40 @@ void CCDXParticleSystemQuad::OutputShaderErrorMessage(ID3D10Blob* errorMessage,
 
 bool CCDXParticleSystemQuad::SetShaderParameters(XMMATRIX &viewMatrix,XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
 {
-	HRESULT result;
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
+	MatrixBufferType matrices;
 	unsigned int bufferNumber;
 
 	// Transpose the matrices to prepare them for the shader.
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-	// Lock the constant buffer so it can be written to.
-	result = CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	// Get a pointer to the data in the constant buffer.
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-
-	// Copy the matrices into the constant buffer.
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-
-	// Unlock the constant buffer.
-	CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+	matrices.view = XMMatrixTranspose(viewMatrix);
+	matrices.projection = XMMatrixTranspose(projectionMatrix);
 
 	// Set the position of the constant buffer in the vertex shader.
 	bufferNumber = 0;
 
-	// Now set the constant buffer in the vertex shader with the updated values.
-	CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
+	// Copy the matrices to the shared constant ring and set them in the vertex shader.
+	if(!CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices)))
+	{
+		return false;
+	}
 
 	// Set shader texture resource in the pixel shader.
-	CCID3D11DeviceContext->PSSetShaderResources(0, 1, &texture);
+	CCRenderQueue::sharedRenderQueue()->setTexture(texture);
 
 	return true;
 }
 
 void CCDXParticleSystemQuad::RenderShader(unsigned int particleIdx,CCTexture2D* texture)
 {
-	// Set the vertex input layout.
-	CCID3D11DeviceContext->IASetInputLayout(m_inputLayout);
+	CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
 
-	// Set the vertex and pixel shaders that will be used to render this triangle.
-	CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
+	// Set the vertex input layout and the shaders that will be used to render this triangle.
+	pQueue->setProgram(m_pProgram);
 
 	// Set the sampler state in the pixel shader.
-	CCID3D11DeviceContext->PSSetSamplers(0, 1, texture->GetSamplerState());
+	pQueue->setSampler(*texture->GetSamplerState());
 	//CCLog("CCDXParticleSystemQuad:RenderShader(idx:%d, m_indexCount:)",particleIdx);
 	// Render the triangle.
-	CCID3D11DeviceContext->DrawIndexed((particleIdx*6),0, 0 );
+	pQueue->drawIndexed((particleIdx*6),0, 0 );
 
 	return;
 }
@@ -640,21 +544,24 @@ void CCDXParticleSystemQuad::Render(ccV2F_C4B_T2F_Quad *quad,unsigned short* ind
 		m_bIsInit = TRUE;
 		FreeBuffer();
 		m_uMaxTotalParticles = uTotalParticles;
-		initVertexAndIndexBuffer(indices, uTotalParticles);
+		initIndexBuffer(indices, uTotalParticles);
 		InitializeShader();
 	}
 	
 	if(m_uMaxTotalParticles < uTotalParticles)
 	{
 		m_uMaxTotalParticles = uTotalParticles;
-		initVertexAndIndexBuffer(indices, uTotalParticles);
+		initIndexBuffer(indices, uTotalParticles);
 	}
 	
+	if(0 == particleIdx || !RenderVertexBuffer(quad, particleIdx))
+	{
+		return;
+	}
 	
 	XMMATRIX viewMatrix, projectionMatrix;
 	CCD3DCLASS->GetViewMatrix(viewMatrix);
 	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
-	RenderVertexBuffer(quad, uTotalParticles);
 	SetShaderParameters(viewMatrix, projectionMatrix, texture->getTextureResource());
 	RenderShader(particleIdx, texture);
 }
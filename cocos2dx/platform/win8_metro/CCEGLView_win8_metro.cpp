@@ -67,6 +67,7 @@ CCEGLView::CCEGLView()
 
     m_d3dDevice = DirectXRender::SharedDXRender()->m_d3dDevice.Get();
     m_d3dContext = DirectXRender::SharedDXRender()->m_d3dContext.Get();
+    m_d3dImmediateContext = m_d3dContext;
     m_swapChain = DirectXRender::SharedDXRender()->m_swapChain.Get();
     m_renderTargetView = DirectXRender::SharedDXRender()->m_renderTargetView.Get();
     m_depthStencilView = DirectXRender::SharedDXRender()->m_depthStencilView.Get();
@@ -78,6 +79,12 @@ CCEGLView::CCEGLView()
 
 CCEGLView::~CCEGLView()
 {
+	BlendStateMap::iterator it = m_blendStates.begin();
+	for ( ; it != m_blendStates.end(); ++it)
+	{
+		it->second->Release();
+	}
+	m_blendStates.clear();
 }
 
 ID3D11Device* CCEGLView::GetDevice()
@@ -90,6 +97,26 @@ ID3D11DeviceContext* CCEGLView::GetDeviceContext()
     return m_d3dContext;
 }
 
+ID3D11DeviceContext* CCEGLView::GetImmediateContext()
+{
+    return m_d3dImmediateContext;
+}
+
+void CCEGLView::setRecordingContext(ID3D11DeviceContext1* pContext)
+{
+    m_d3dContext = pContext ? pContext : m_d3dImmediateContext;
+}
+
+void CCEGLView::lockImmediateContext()
+{
+    m_immediateContextMutex.lock();
+}
+
+void CCEGLView::unlockImmediateContext()
+{
+    m_immediateContextMutex.unlock();
+}
+
 ID3D11DepthStencilView* CCEGLView::GetDepthStencilView()
 {
     return m_depthStencilView;
@@ -520,8 +547,15 @@ void CCEGLView::D3DDepthFunc(int func)
 	dss1->Release();
 }
 
-void CCEGLView::D3DBlendFunc(int sfactor, int dfactor)
+ID3D11BlendState* CCEGLView::getBlendState(int sfactor, int dfactor)
 {
+	int key = ((sfactor & 0xffff) << 16) | (dfactor & 0xffff);
+	BlendStateMap::iterator it = m_blendStates.find(key);
+	if (it != m_blendStates.end())
+	{
+		return it->second;
+	}
+
 	int sfactor2 = sfactor;
 	int dfactor2 = dfactor;
 	switch(sfactor)
@@ -548,57 +582,44 @@ void CCEGLView::D3DBlendFunc(int sfactor, int dfactor)
 	case CC_ONE_MINUS_DST_ALPHA:	dfactor2=D3D11_BLEND_INV_DEST_ALPHA; dfactor=D3D11_BLEND_INV_DEST_ALPHA;break;
 	}
 
-	ID3D11BlendState* dbs0;
-	ID3D11BlendState* dbs1;
 	D3D11_BLEND_DESC dbd;
-	float blendFactor[4]={0.0f,0.0f,0.0f,0.0f};
-	UINT sref;
-	m_d3dContext->OMGetBlendState(&dbs0,blendFactor,&sref);
-
-	if(dbs0)
-		dbs0->GetDesc(&dbd);
+	ZeroMemory(&dbd,sizeof(D3D11_BLEND_DESC));
+	if ( (sfactor==-1) && (dfactor==-1) )
+	{
+		dbd.RenderTarget[0].BlendEnable = FALSE;
+		sfactor = dfactor = D3D11_BLEND_ONE;
+		sfactor2 = dfactor2 = D3D11_BLEND_ONE;
+	}
 	else
 	{
-		ZeroMemory(&dbd,sizeof(D3D11_BLEND_DESC));
-		sref = 0;
+		dbd.RenderTarget[0].BlendEnable = TRUE;
 	}
-
-	if ( (dbd.RenderTarget[0].SrcBlend != (D3D11_BLEND)sfactor)|| (dbd.RenderTarget[0].DestBlend != (D3D11_BLEND)dfactor) )
+	dbd.AlphaToCoverageEnable = FALSE;
+	dbd.IndependentBlendEnable = FALSE;
+	dbd.RenderTarget[0].SrcBlend = (D3D11_BLEND)sfactor;
+	dbd.RenderTarget[0].DestBlend = (D3D11_BLEND)dfactor;
+	dbd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+	dbd.RenderTarget[0].SrcBlendAlpha = (D3D11_BLEND)sfactor2;
+	dbd.RenderTarget[0].DestBlendAlpha = (D3D11_BLEND)dfactor2;
+	dbd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+	dbd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+	for (int i = 1; i < 8; ++i)
 	{
-		if ( (sfactor==-1) && (dfactor==-1) )
-		{
-			dbd.RenderTarget[0].BlendEnable = FALSE;
-			sfactor = dfactor = D3D11_BLEND_ONE;
-			sfactor2 = dfactor2 = D3D11_BLEND_ONE;
-		}
-		else
-		{
-			dbd.RenderTarget[0].BlendEnable = TRUE;
-		}
-		dbd.AlphaToCoverageEnable = FALSE;
-		dbd.IndependentBlendEnable = FALSE;
-		dbd.RenderTarget[0].SrcBlend = (D3D11_BLEND)sfactor;
-		dbd.RenderTarget[0].DestBlend = (D3D11_BLEND)dfactor;
-		dbd.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-		dbd.RenderTarget[0].SrcBlendAlpha = (D3D11_BLEND)sfactor2;
-		dbd.RenderTarget[0].DestBlendAlpha = (D3D11_BLEND)dfactor2;
-		dbd.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-		dbd.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-		memcpy( &dbd.RenderTarget[1], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
-		memcpy( &dbd.RenderTarget[2], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
-		memcpy( &dbd.RenderTarget[3], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
-		memcpy( &dbd.RenderTarget[4], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
-		memcpy( &dbd.RenderTarget[5], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
-		memcpy( &dbd.RenderTarget[6], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
-		memcpy( &dbd.RenderTarget[7], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
+		memcpy( &dbd.RenderTarget[i], &dbd.RenderTarget[0], sizeof( D3D11_RENDER_TARGET_BLEND_DESC ) );
 	}
 
-	if(FAILED(m_d3dDevice->CreateBlendState(&dbd,&dbs1)))
+	// a handful of pairs are used, each state object is created once
+	ID3D11BlendState* dbs = NULL;
+	if(FAILED(m_d3dDevice->CreateBlendState(&dbd,&dbs)))
 		exit(-1);
-	m_d3dContext->OMSetBlendState(dbs1, blendFactor, 0xffffffff);
-	if(dbs0)
-		dbs0->Release();
-	dbs1->Release();
+	m_blendStates[key] = dbs;
+	return dbs;
+}
+
+void CCEGLView::D3DBlendFunc(int sfactor, int dfactor)
+{
+	float blendFactor[4]={0.0f,0.0f,0.0f,0.0f};
+	m_d3dContext->OMSetBlendState(getBlendState(sfactor, dfactor), blendFactor, 0xffffffff);
 }
 
 void CCEGLView::clearRender(ID3D11RenderTargetView* renderTargetView)
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include <stack>
 #include <vector>
 #include <map>
+#include <mutex>
 
 NS_CC_BEGIN;
 
@@ -131,7 +132,16 @@ public:
     virtual ~CCEGLView();
 
     ID3D11Device* GetDevice();
+	/** the context rendering is recorded to: the immediate context, or the deferred
+	 context of the CCRenderPipeline while it runs */
 	ID3D11DeviceContext* GetDeviceContext();
+	ID3D11DeviceContext* GetImmediateContext();
+	/** pContext NULL goes back to rendering on the immediate context */
+	void setRecordingContext(ID3D11DeviceContext1* pContext);
+	/** Serializes the direct use of the immediate context (readbacks, Direct2D)
+	 with the render thread of the CCRenderPipeline */
+	void lockImmediateContext();
+	void unlockImmediateContext();
 	ID3D11DepthStencilView* GetDepthStencilView();
 
     CCSize  getSize();
@@ -171,6 +181,8 @@ public:
 	void D3DScale(float x, float y, float z);
 	void D3DMultMatrix(const float *m);
 	void D3DBlendFunc(int sfactor, int dfactor);
+	/** the blend state of a pair of CC_* factors, -1 and -1 for no blending, owned by the view */
+	ID3D11BlendState* getBlendState(int sfactor, int dfactor);
 	void D3DViewport(int x, int y, int width, int height);
 	void D3DScissor(int x,int y,int w,int h);
 	void D3DMatrixMode(int matrixMode);
@@ -198,6 +210,8 @@ protected:
 private:
     ID3D11Device1*           m_d3dDevice;
     ID3D11DeviceContext1*    m_d3dContext;
+    ID3D11DeviceContext1*    m_d3dImmediateContext;
+    std::mutex               m_immediateContextMutex;
     IDXGISwapChain1*         m_swapChain;
     ID3D11RenderTargetView*  m_renderTargetView;
     ID3D11DepthStencilView*  m_depthStencilView;
@@ -206,6 +220,8 @@ private:
     SetMap              m_pSets;
     typedef std::map<int, CCTouch*> TouchMap;
     TouchMap            m_pTouches;
+    typedef std::map<int, ID3D11BlendState*> BlendStateMap;
+    BlendStateMap       m_blendStates;
 
     EGLTouchDelegate*   m_pDelegate;
 	
@@ -24,6 +24,7 @@ THE SOFTWARE.
 #include "DXTextPainter.h"
 #include "FontLoader.h"
 #include "CCCommon.h"
+#include "CCEGLView.h"
 
 using namespace Microsoft::WRL;
 using namespace Windows::UI::Core;
@@ -50,6 +51,13 @@ static float GetResolutionScale()
 	return (float)GetResolutionScaleInt() / 100.0;
 }
 
+// holds CCEGLView::lockImmediateContext() for the scope
+struct ImmediateContextLock
+{
+	ImmediateContextLock() { cocos2d::CCEGLView::sharedOpenGLView().lockImmediateContext(); }
+	~ImmediateContextLock() { cocos2d::CCEGLView::sharedOpenGLView().unlockImmediateContext(); }
+};
+
 DXTextPainter::DXTextPainter()
 : m_fontLoader()
 , m_dwriteFactory()
@@ -326,6 +334,9 @@ Platform::Array<byte>^  DXTextPainter::DrawTextToImage(Platform::String^ text, W
 		return nullptr;
 	}
 
+	// Direct2D renders with the immediate context, which the render thread may be using
+	ImmediateContextLock immediateContextLock;
+
 	//Render
 	m_d2dContext->SetTarget(m_d2dTargetBitmap.Get());
 
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "exception\CCException.h"
 #include "CCEGLView.h"
 #include "CCApplication.h"
+#include "CCDirector.h"
 
 using namespace Windows::UI::Core;
 using namespace Windows::Foundation;
@@ -241,6 +242,9 @@ void DirectXRender::UpdateForWindowSizeChange()
     if (m_window->Bounds.Width  != m_windowBounds.Width ||
         m_window->Bounds.Height != m_windowBounds.Height)
     {
+        // the render thread must be idle and nothing may still reference the back buffer
+        cocos2d::CCDirector::sharedDirector()->getRenderPipeline()->detachTargets();
+
         m_d2dContext->SetTarget(nullptr);
         m_d2dTargetBitmap = nullptr;
         m_renderTargetView = nullptr;
@@ -41,12 +41,16 @@ THE SOFTWARE.
 #include "DirectXHelper.h"
 #include <string.h>
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace std;
 using namespace DirectX;
 
 namespace   cocos2d {
 
+CC_POOLED_ALLOC_IMPL(CCSprite, 32)
+
 #if CC_SPRITEBATCHNODE_RENDER_SUBPIXEL
 #define RENDER_IN_SUBPIXEL
 #else
@@ -660,14 +664,14 @@ void CCSprite::draw(void)
 	bool newBlend = m_sBlendFunc.src != CC_BLEND_SRC || m_sBlendFunc.dst != CC_BLEND_DST;
 	if (newBlend)
 	{
-		CCD3DCLASS->D3DBlendFunc(m_sBlendFunc.src, m_sBlendFunc.dst);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(m_sBlendFunc.src, m_sBlendFunc.dst);
 	}
 
 	mDXSprite.Render(m_pobTexture,m_sQuad);
 
 	if( newBlend )
 	{
-		CCD3DCLASS->D3DBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+		CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
 	}
 	
 	
@@ -1089,13 +1093,8 @@ CCTexture2D* CCSprite::getTexture(void)
 
 CCDXSprite::CCDXSprite()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_matrixBuffer = 0;
+	m_pProgram = NULL;
 	m_indexBuffer = 0;
-	m_vertexBuffer = 0;
-	m_textureColorBuffer = 0;
 
 	mIsInit = FALSE;
 }
@@ -1107,13 +1106,8 @@ CCDXSprite::~CCDXSprite()
 
 void CCDXSprite::FreeBuffer()
 {
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
 	CC_SAFE_RELEASE_NULL_DX(m_indexBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_matrixBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_textureColorBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_layout);
-	CC_SAFE_RELEASE_NULL_DX(m_pixelShader);
-	CC_SAFE_RELEASE_NULL_DX(m_vertexShader);
+	CC_SAFE_RELEASE_NULL(m_pProgram);
 }
 void CCDXSprite::setIsInit(bool isInit)
 {
@@ -1122,25 +1116,8 @@ void CCDXSprite::setIsInit(bool isInit)
 
 void CCDXSprite::initVertexBuffer()
 {
-
-	D3D11_BUFFER_DESC vertexBufferDesc;
-	HRESULT result;
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType)*4;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
+	// the vertices go to the shared geometry ring, only the indices are kept here
 	ID3D11Device* pDevice=CCDirector::sharedDirector()->getOpenGLView()->GetDevice();
-	// Now create the vertex buffer.
-	result = pDevice->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer);
-	if(FAILED(result))
-	{
-		return ;
-	}
 
     CCushort indices[] = {
 		0, 1, 2,
@@ -1181,39 +1158,19 @@ void CCDXSprite::RenderVertexBuffer(ccV3F_C4B_T2F_Quad quad)
 	verticesTmp[2].color = XMFLOAT4(quad.br.colors.r/255.0f, quad.br.colors.g/255.0f, quad.br.colors.b/255.0f, quad.br.colors.a/255.0f);
 	verticesTmp[3].color = XMFLOAT4(quad.bl.colors.r/255.0f, quad.bl.colors.g/255.0f, quad.bl.colors.b/255.0f, quad.bl.colors.a/255.0f);
 
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-	if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource))){return ;}
-	verticesPtr = (VertexType*)mappedResource.pData;
-	memcpy(verticesPtr, (void*)verticesTmp, (sizeof(VertexType) * 4));
-	CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
+	// Copy the vertices to the shared ring and set them active in the input assembler so they can be rendered.
+	if(!CCDynamicBuffers::sharedDynamicBuffers()->setVertices(0, verticesTmp, sizeof(VertexType), 4)){return ;}
 
-	////////////////////////
-	unsigned int stride;
-	unsigned int offset;
-	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType); 
-	offset = 0;
-
-	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
-
-	CCID3D11DeviceContext->IASetIndexBuffer( m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+	CCRenderQueue::sharedRenderQueue()->setIndexBuffer(m_indexBuffer);
 
 	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-	CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	CCRenderQueue::sharedRenderQueue()->setTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 	return;
 }
 
 bool CCDXSprite::InitializeShader()
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	errorMessage = 0;
-
-
-	BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 	D3D11_INPUT_ELEMENT_DESC layoutDesc[] = 
 	{
 		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -1221,49 +1178,15 @@ bool CCDXSprite::InitializeShader()
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 	};
 
-	loader->LoadShader(
+	m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 		L"CCSpriteVertexShader.cso",
 		layoutDesc,
 		ARRAYSIZE(layoutDesc),
-		&m_vertexShader,
-		&m_layout
-		);
-
-	loader->LoadShader(
-		L"CCSpritePixelShader.cso",
-		&m_pixelShader
+		L"CCSpritePixelShader.cso"
 		);
+	CC_SAFE_RETAIN(m_pProgram);
 
-	D3D11_BUFFER_DESC matrixBufferDesc;
-	ZeroMemory( &matrixBufferDesc, sizeof( D3D11_BUFFER_DESC ) );
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	D3D11_BUFFER_DESC textureColorBufferDesc;
-	ZeroMemory( &textureColorBufferDesc, sizeof( D3D11_BUFFER_DESC ) );
-	textureColorBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	textureColorBufferDesc.ByteWidth = sizeof(TextureColorType);
-	textureColorBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	//textureColorBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	textureColorBufferDesc.MiscFlags = 0;
-	textureColorBufferDesc.StructureByteStride = 0;
-	result = CCID3D11Device->CreateBuffer(&textureColorBufferDesc, NULL, &m_textureColorBuffer);
-	if(FAILED(result))
-	{
-		return false;
-	}
-	return true;
+	return m_pProgram != NULL;
 }
 
 void CCDXSprite::OutputShaderErrorMessage(ID3D10Blob* errorMessage,WCHAR* shaderFilename)
@@ -1304,52 +1227,39 @@ void CCDXSprite::OutputShaderErrorMessage(ID3D10Blob* errorMessage,WCHAR* shader
 
 bool CCDXSprite::SetShaderParameters( XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
 {
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	unsigned int bufferNumber;
 
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-	MatrixBufferType* dataPtr;
-	if(FAILED(CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource))){return false;}
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-	CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+	MatrixBufferType matrices;
+	matrices.view = XMMatrixTranspose(viewMatrix);
+	matrices.projection = XMMatrixTranspose(projectionMatrix);
 	bufferNumber = 0;
-	CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
+	if(!CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices))){return false;}
 
+	// one buffer per value of the flag, shared by all the sprites
 	TextureColorType tc;
 	ZeroMemory(&tc, sizeof(tc));
 	tc.istexture[0] = (texture ? TRUE : FALSE);
-	CCID3D11DeviceContext->UpdateSubresource(m_textureColorBuffer, 0, 0, &tc, 0, 0);
-	bufferNumber = 0;
-	CCID3D11DeviceContext->PSSetConstantBuffers(bufferNumber, 1, &m_textureColorBuffer);
+	CCRenderQueue::sharedRenderQueue()->setPSConstants(CCRenderQueue::sharedRenderQueue()->constantBufferWithData(&tc, sizeof(tc)));
 
-	if ( texture )
-	{
-		CCID3D11DeviceContext->PSSetShaderResources(0, 1, &texture);
-	}
+	CCRenderQueue::sharedRenderQueue()->setTexture(texture);
 
 	return true;
 }
 
 void CCDXSprite::RenderShader(CCTexture2D *texture)
 {
-	// Set the vertex input layout.
-	CCID3D11DeviceContext->IASetInputLayout(m_layout);
+	CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
 
-	// Set the vertex and pixel shaders that will be used to render this triangle.
-	CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
+	// Set the vertex input layout and the shaders that will be used to render this triangle.
+	pQueue->setProgram(m_pProgram);
 	if ( texture )
 	{
 		// Set the sampler state in the pixel shader.
-		CCID3D11DeviceContext->PSSetSamplers(0, 1, texture->GetSamplerState());
+		pQueue->setSampler(*texture->GetSamplerState());
 	}
 
 	// Render the triangle.
-	CCID3D11DeviceContext->DrawIndexed( 6, 0, 0 );
+	pQueue->drawIndexed( 6, 0, 0 );
 
 	return;
 }
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "CCTextureCache.h"
 #include "CCPointExtension.h"
 #include "CCDirector.h"
+#include "CCRenderQueue.h"
 
 namespace cocos2d
 {
@@ -141,6 +142,7 @@ namespace cocos2d
 		transform();
 
 		draw();
+		ccDrawFlush();
 
 		if (m_pGrid && m_pGrid->isActive())
 		{
@@ -278,12 +280,12 @@ namespace cocos2d
 		bool newBlend = m_blendFunc.src != CC_BLEND_SRC || m_blendFunc.dst != CC_BLEND_DST;
 		if (newBlend)
 		{
-			CCD3DCLASS->D3DBlendFunc(m_blendFunc.src, m_blendFunc.dst);
+			CCRenderQueue::sharedRenderQueue()->setBlendFunc(m_blendFunc.src, m_blendFunc.dst);
 		}
 		m_pobTextureAtlas->drawQuads();
 		if (newBlend)
 		{
-			CCD3DCLASS->D3DBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+			CCRenderQueue::sharedRenderQueue()->setBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
 		}
 	}
 
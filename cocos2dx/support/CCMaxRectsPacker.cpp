@@ -0,0 +1,199 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCMaxRectsPacker.h"
+
+namespace   cocos2d {
+
+static inline bool rectContains(unsigned int ax, unsigned int ay, unsigned int aw, unsigned int ah, unsigned int bx, unsigned int by, unsigned int bw, unsigned int bh)
+{
+	return bx >= ax && by >= ay && bx + bw <= ax + aw && by + bh <= ay + ah;
+}
+
+CCMaxRectsPacker::CCMaxRectsPacker(void)
+: m_uWidth(0)
+, m_uHeight(0)
+, m_uUsedArea(0)
+{
+}
+
+void CCMaxRectsPacker::init(unsigned int uWidth, unsigned int uHeight)
+{
+	m_uWidth = uWidth;
+	m_uHeight = uHeight;
+	m_uUsedArea = 0;
+
+	Rect bin = { 0, 0, uWidth, uHeight };
+	m_freeRects.clear();
+	m_freeRects.push_back(bin);
+}
+
+bool CCMaxRectsPacker::insert(unsigned int uWidth, unsigned int uHeight, unsigned int &x, unsigned int &y)
+{
+	if (uWidth == 0 || uHeight == 0)
+	{
+		return false;
+	}
+
+	// the free rectangle leaving the shortest leftover side, then the longest one
+	int nBest = -1;
+	unsigned int uBestShort = 0xffffffff;
+	unsigned int uBestLong = 0xffffffff;
+	for (unsigned int i = 0; i < m_freeRects.size(); ++i)
+	{
+		const Rect &freeRect = m_freeRects[i];
+		if (freeRect.w < uWidth || freeRect.h < uHeight)
+		{
+			continue;
+		}
+
+		unsigned int dw = freeRect.w - uWidth;
+		unsigned int dh = freeRect.h - uHeight;
+		unsigned int uShort = dw < dh ? dw : dh;
+		unsigned int uLong = dw < dh ? dh : dw;
+		if (uShort < uBestShort || (uShort == uBestShort && uLong < uBestLong))
+		{
+			nBest = (int)i;
+			uBestShort = uShort;
+			uBestLong = uLong;
+		}
+	}
+
+	if (nBest < 0)
+	{
+		return false;
+	}
+
+	Rect used = { m_freeRects[nBest].x, m_freeRects[nBest].y, uWidth, uHeight };
+	splitFreeRects(used);
+	pruneFreeRects();
+
+	x = used.x;
+	y = used.y;
+	m_uUsedArea += uWidth * uHeight;
+	return true;
+}
+
+void CCMaxRectsPacker::remove(unsigned int x, unsigned int y, unsigned int uWidth, unsigned int uHeight)
+{
+	Rect freeRect = { x, y, uWidth, uHeight };
+	m_newRects.clear();
+	m_newRects.push_back(freeRect);
+	pruneFreeRects();
+
+	m_uUsedArea -= uWidth * uHeight;
+}
+
+void CCMaxRectsPacker::splitFreeRects(const Rect &used)
+{
+	m_newRects.clear();
+
+	unsigned int i = 0;
+	while (i < m_freeRects.size())
+	{
+		Rect freeRect = m_freeRects[i];
+		if (used.x >= freeRect.x + freeRect.w || used.x + used.w <= freeRect.x
+			|| used.y >= freeRect.y + freeRect.h || used.y + used.h <= freeRect.y)
+		{
+			++i;
+			continue;
+		}
+
+		// the free space left of, right of, above and below the used rectangle
+		if (used.x > freeRect.x)
+		{
+			Rect r = { freeRect.x, freeRect.y, used.x - freeRect.x, freeRect.h };
+			m_newRects.push_back(r);
+		}
+		if (used.x + used.w < freeRect.x + freeRect.w)
+		{
+			Rect r = { used.x + used.w, freeRect.y, freeRect.x + freeRect.w - used.x - used.w, freeRect.h };
+			m_newRects.push_back(r);
+		}
+		if (used.y > freeRect.y)
+		{
+			Rect r = { freeRect.x, freeRect.y, freeRect.w, used.y - freeRect.y };
+			m_newRects.push_back(r);
+		}
+		if (used.y + used.h < freeRect.y + freeRect.h)
+		{
+			Rect r = { freeRect.x, used.y + used.h, freeRect.w, freeRect.y + freeRect.h - used.y - used.h };
+			m_newRects.push_back(r);
+		}
+
+		m_freeRects[i] = m_freeRects.back();
+		m_freeRects.pop_back();
+	}
+}
+
+void CCMaxRectsPacker::pruneFreeRects(void)
+{
+	// the rectangles of m_freeRects don't contain each other already,
+	// only the new ones have to be compared to them and to each other
+	unsigned int uOld = m_freeRects.size();
+	for (unsigned int i = 0; i < m_newRects.size(); ++i)
+	{
+		const Rect &r = m_newRects[i];
+		bool bContained = false;
+		for (unsigned int j = 0; j < m_freeRects.size() && ! bContained; ++j)
+		{
+			const Rect &other = m_freeRects[j];
+			bContained = rectContains(other.x, other.y, other.w, other.h, r.x, r.y, r.w, r.h);
+		}
+		for (unsigned int j = i + 1; j < m_newRects.size() && ! bContained; ++j)
+		{
+			const Rect &other = m_newRects[j];
+			bContained = rectContains(other.x, other.y, other.w, other.h, r.x, r.y, r.w, r.h);
+		}
+
+		if (! bContained)
+		{
+			m_freeRects.push_back(r);
+		}
+	}
+
+	for (unsigned int i = 0; i < uOld; )
+	{
+		const Rect &r = m_freeRects[i];
+		bool bContained = false;
+		for (unsigned int j = uOld; j < m_freeRects.size() && ! bContained; ++j)
+		{
+			const Rect &other = m_freeRects[j];
+			bContained = rectContains(other.x, other.y, other.w, other.h, r.x, r.y, r.w, r.h);
+		}
+
+		if (bContained)
+		{
+			// keeps the new ones at the end
+			m_freeRects.erase(m_freeRects.begin() + i);
+			--uOld;
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+}//namespace   cocos2d 
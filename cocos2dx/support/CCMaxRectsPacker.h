@@ -0,0 +1,79 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __SUPPORT_CCMAX_RECTS_PACKER_H__
+#define __SUPPORT_CCMAX_RECTS_PACKER_H__
+
+#include <vector>
+
+namespace   cocos2d {
+
+/** @brief Packs rectangles into a bin with the MaxRects algorithm, best short side fit.
+The free space is kept as the list of the largest free rectangles, which may overlap.
+Used by CCDynamicAtlas to place the images on its pages.
+*/
+class CCMaxRectsPacker
+{
+public:
+	CCMaxRectsPacker(void);
+
+	/** empties the bin and sets its size */
+	void init(unsigned int uWidth, unsigned int uHeight);
+
+	/** @return false if there is no room for a uWidth x uHeight rectangle, its top left corner otherwise */
+	bool insert(unsigned int uWidth, unsigned int uHeight, unsigned int &x, unsigned int &y);
+
+	/** Gives back a rectangle returned by insert().
+	It isn't merged with its free neighbours, a bin with many holes has to be packed again.
+	*/
+	void remove(unsigned int x, unsigned int y, unsigned int uWidth, unsigned int uHeight);
+
+	inline unsigned int getWidth(void) { return m_uWidth; }
+	inline unsigned int getHeight(void) { return m_uHeight; }
+	/** area of the inserted rectangles */
+	inline unsigned int getUsedArea(void) { return m_uUsedArea; }
+	/** used area over the bin area, 0 ~ 1 */
+	inline float getOccupancy(void) { return m_uWidth * m_uHeight > 0 ? (float)m_uUsedArea / (float)(m_uWidth * m_uHeight) : 0.0f; }
+
+private:
+	struct Rect
+	{
+		unsigned int x, y, w, h;
+	};
+
+	// splits the free rectangles overlapping the used one
+	void splitFreeRects(const Rect &used);
+	// adds the rectangles of m_newRects to the free ones, dropping those contained in another one
+	void pruneFreeRects(void);
+
+	std::vector<Rect> m_freeRects;
+	std::vector<Rect> m_newRects;
+	unsigned int m_uWidth;
+	unsigned int m_uHeight;
+	unsigned int m_uUsedArea;
+};
+
+}//namespace   cocos2d 
+
+#endif // __SUPPORT_CCMAX_RECTS_PACKER_H__
@@ -0,0 +1,213 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCNodeTagIndex.h"
+#include "CCNode.h"
+
+#include <string.h>
+
+namespace   cocos2d {
+
+#define kMinCapacity	16
+
+// Fibonacci hashing, consecutive tags spread over the whole table
+static inline unsigned int hashTag(int nTag, unsigned int uMask)
+{
+	unsigned int h = (unsigned int)nTag * 2654435769u;
+	return (h ^ (h >> 16)) & uMask;
+}
+
+CCNodeTagIndex::CCNodeTagIndex(void)
+: m_pEntries(NULL)
+, m_uCapacity(0)
+, m_uCount(0)
+{
+}
+
+CCNodeTagIndex::~CCNodeTagIndex(void)
+{
+	delete [] m_pEntries;
+}
+
+int CCNodeTagIndex::find(int nTag)
+{
+	if (m_uCapacity == 0)
+	{
+		return -1;
+	}
+
+	unsigned int uMask = m_uCapacity - 1;
+	for (unsigned int i = hashTag(nTag, uMask); ; i = (i + 1) & uMask)
+	{
+		Entry &entry = m_pEntries[i];
+		if (entry.uChildren == 0)
+		{
+			return -1;
+		}
+		if (entry.nTag == nTag)
+		{
+			return (int)i;
+		}
+	}
+}
+
+void CCNodeTagIndex::rehash(unsigned int uCapacity)
+{
+	Entry *pOld = m_pEntries;
+	unsigned int uOldCapacity = m_uCapacity;
+
+	m_pEntries = new Entry[uCapacity];
+	memset(m_pEntries, 0, sizeof(Entry) * uCapacity);
+	m_uCapacity = uCapacity;
+
+	unsigned int uMask = uCapacity - 1;
+	for (unsigned int i = 0; i < uOldCapacity; ++i)
+	{
+		if (pOld[i].uChildren == 0)
+		{
+			continue;
+		}
+
+		unsigned int j = hashTag(pOld[i].nTag, uMask);
+		while (m_pEntries[j].uChildren != 0)
+		{
+			j = (j + 1) & uMask;
+		}
+		m_pEntries[j] = pOld[i];
+	}
+
+	delete [] pOld;
+}
+
+void CCNodeTagIndex::add(int nTag, CCNode *pChild)
+{
+	if (nTag == kCCNodeTagInvalid)
+	{
+		return;
+	}
+
+	int nSlot = find(nTag);
+	if (nSlot >= 0)
+	{
+		Entry &entry = m_pEntries[nSlot];
+		entry.uChildren++;
+		// which one comes first depends on the z order, leave it to a scan
+		entry.pChild = NULL;
+		return;
+	}
+
+	// keep the load under 1/2, probes stay short
+	if ((m_uCount + 1) * 2 > m_uCapacity)
+	{
+		rehash(m_uCapacity ? m_uCapacity * 2 : kMinCapacity);
+	}
+
+	unsigned int uMask = m_uCapacity - 1;
+	unsigned int i = hashTag(nTag, uMask);
+	while (m_pEntries[i].uChildren != 0)
+	{
+		i = (i + 1) & uMask;
+	}
+
+	m_pEntries[i].nTag = nTag;
+	m_pEntries[i].uChildren = 1;
+	m_pEntries[i].pChild = pChild;
+	m_uCount++;
+}
+
+void CCNodeTagIndex::remove(int nTag)
+{
+	int nSlot = find(nTag);
+	if (nSlot < 0)
+	{
+		return;
+	}
+
+	Entry &entry = m_pEntries[nSlot];
+	if (--entry.uChildren > 0)
+	{
+		// the one left is found by the next scan
+		entry.pChild = NULL;
+		return;
+	}
+
+	// backward shift deletion: pull the following entries of the cluster back
+	// so that no lookup stops early on the hole, without tombstones
+	unsigned int uMask = m_uCapacity - 1;
+	unsigned int i = (unsigned int)nSlot;
+	unsigned int j = i;
+	for (;;)
+	{
+		j = (j + 1) & uMask;
+		if (m_pEntries[j].uChildren == 0)
+		{
+			break;
+		}
+
+		// move it unless its home slot lies cyclically in (i, j]
+		unsigned int k = hashTag(m_pEntries[j].nTag, uMask);
+		if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j)))
+		{
+			m_pEntries[i] = m_pEntries[j];
+			i = j;
+		}
+	}
+
+	m_pEntries[i].uChildren = 0;
+	m_pEntries[i].pChild = NULL;
+	m_uCount--;
+}
+
+void CCNodeTagIndex::clear(void)
+{
+	if (m_pEntries)
+	{
+		memset(m_pEntries, 0, sizeof(Entry) * m_uCapacity);
+	}
+	m_uCount = 0;
+}
+
+bool CCNodeTagIndex::lookup(int nTag, CCNode *&pChild)
+{
+	int nSlot = find(nTag);
+	if (nSlot < 0)
+	{
+		pChild = NULL;
+		return false;
+	}
+
+	pChild = m_pEntries[nSlot].pChild;
+	return true;
+}
+
+void CCNodeTagIndex::resolve(int nTag, CCNode *pChild)
+{
+	int nSlot = find(nTag);
+	if (nSlot >= 0 && m_pEntries[nSlot].uChildren == 1)
+	{
+		m_pEntries[nSlot].pChild = pChild;
+	}
+}
+
+}//namespace   cocos2d 
@@ -0,0 +1,75 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __SUPPORT_CCNODE_TAG_INDEX_H__
+#define __SUPPORT_CCNODE_TAG_INDEX_H__
+
+namespace   cocos2d {
+
+class CCNode;
+
+/** @brief Open addressing hash from a tag to the children of a node having it.
+Used by CCNode::getChildByTag once a node has many children, see CCNode::setTagIndexThreshold().
+
+Only a unique tag maps to its child. When several children share a tag, lookup()
+tells so and CCNode scans its children to keep returning the first one in z order.
+*/
+class CCNodeTagIndex
+{
+public:
+	CCNodeTagIndex(void);
+	~CCNodeTagIndex(void);
+
+	void add(int nTag, CCNode *pChild);
+	void remove(int nTag);
+	void clear(void);
+
+	/** @return false if no child has the tag.
+	True otherwise, with pChild NULL if the child has to be found by a scan.
+	*/
+	bool lookup(int nTag, CCNode *&pChild);
+
+	/** caches the child found by a scan, when it is the only one with the tag */
+	void resolve(int nTag, CCNode *pChild);
+
+private:
+	struct Entry
+	{
+		int nTag;
+		//! children having the tag, 0 for an empty slot
+		unsigned int uChildren;
+		CCNode *pChild;
+	};
+
+	int find(int nTag);
+	void rehash(unsigned int uCapacity);
+
+	Entry *m_pEntries;
+	unsigned int m_uCapacity;
+	unsigned int m_uCount;
+};
+
+}//namespace   cocos2d 
+
+#endif // __SUPPORT_CCNODE_TAG_INDEX_H__
@@ -26,6 +26,8 @@ THE SOFTWARE.
 
 #if CC_ENABLE_PROFILERS
 
+#include "CCAutoreleasePool.h"
+
 namespace cocos2d
 {
 	using namespace std;
@@ -88,6 +90,18 @@ namespace cocos2d
 			CCLog(pszDescription);
 			delete pszDescription;
 		}
+
+		displayAutoreleasePoolStats();
+	}
+
+	void CCProfiler::displayAutoreleasePoolStats()
+	{
+		const ccAutoreleasePoolStats& stats = CCPoolManager::getInstance()->getStats();
+		CCLog("autorelease pool: %u objects last frame, %u peak per frame, %u peak pool size, %u slots",
+			stats.uObjectsLastFrame,
+			stats.uPeakObjectsPerFrame,
+			stats.uPeakPoolSize,
+			stats.uCapacity);
 	}
 
 	// implementation of CCProfilingTimer
@@ -44,6 +44,8 @@ namespace cocos2d
 	public:
 		~CCProfiler(void);
 		void displayTimers(void);
+		/** objects autoreleased per frame and pool sizes, see CCPoolManager::getStats() */
+		void displayAutoreleasePoolStats(void);
 		bool init(void);
 
 	public:
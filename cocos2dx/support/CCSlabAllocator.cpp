@@ -0,0 +1,221 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCSlabAllocator.h"
+#include "ccMacros.h"
+#include "CCTouch.h"
+#include "CCString.h"
+
+#include <stdlib.h>
+#include <new>
+#include <mutex>
+
+namespace cocos2d {
+
+// same alignment as malloc
+static const size_t kSlabAlignment = 2 * sizeof(void*);
+
+static CCSlabAllocator *s_pFirstAllocator = NULL;
+
+static inline size_t alignSize(size_t uSize)
+{
+	return (uSize + kSlabAlignment - 1) & ~(kSlabAlignment - 1);
+}
+
+CCSlabAllocator::CCSlabAllocator(const char *pszName, size_t uObjectSize, unsigned int uObjectsPerSlab)
+: m_pszName(pszName)
+, m_uObjectSize(uObjectSize)
+, m_uStride(alignSize(uObjectSize < sizeof(void*) ? sizeof(void*) : uObjectSize))
+, m_uObjectsPerSlab(uObjectsPerSlab > 0 ? uObjectsPerSlab : 1)
+, m_pFreeList(NULL)
+, m_pSlabs(NULL)
+, m_uSlabCount(0)
+, m_uLiveCount(0)
+, m_uPeakCount(0)
+, m_uTotalAllocations(0)
+, m_uFallbackCount(0)
+, m_pNext(NULL)
+{
+	// the allocators of the pooled classes are created during static initialization
+	// or before, by the first object of their class, while a single thread runs
+	CCSlabAllocator **ppLast = &s_pFirstAllocator;
+	while (*ppLast)
+	{
+		ppLast = &(*ppLast)->m_pNext;
+	}
+	*ppLast = this;
+}
+
+CCSlabAllocator::~CCSlabAllocator(void)
+{
+	CCSlabAllocator **ppAllocator = &s_pFirstAllocator;
+	while (*ppAllocator && *ppAllocator != this)
+	{
+		ppAllocator = &(*ppAllocator)->m_pNext;
+	}
+	if (*ppAllocator)
+	{
+		*ppAllocator = m_pNext;
+	}
+
+	CCAssert(m_uLiveCount == 0, "CCSlabAllocator: objects allocated from the slabs are still alive");
+
+	while (m_pSlabs)
+	{
+		void *pNext = *(void**)m_pSlabs;
+		free(m_pSlabs);
+		m_pSlabs = pNext;
+	}
+	m_pFreeList = NULL;
+	m_uSlabCount = 0;
+}
+
+void CCSlabAllocator::addSlab(void)
+{
+	// the first block of a slab links it to the previous slab
+	char *pSlab = (char*)malloc(kSlabAlignment + m_uStride * m_uObjectsPerSlab);
+	if (! pSlab)
+	{
+		return;
+	}
+
+	*(void**)pSlab = m_pSlabs;
+	m_pSlabs = pSlab;
+	++m_uSlabCount;
+
+	// push the blocks in reverse so they are handed out in address order
+	char *pBlock = pSlab + kSlabAlignment + m_uStride * (m_uObjectsPerSlab - 1);
+	for (unsigned int i = 0; i < m_uObjectsPerSlab; ++i)
+	{
+		*(void**)pBlock = m_pFreeList;
+		m_pFreeList = pBlock;
+		pBlock -= m_uStride;
+	}
+}
+
+void* CCSlabAllocator::allocate(size_t uSize)
+{
+	if (uSize != m_uObjectSize)
+	{
+		lock();
+		++m_uFallbackCount;
+		unlock();
+		return ::operator new(uSize);
+	}
+
+	lock();
+
+	if (! m_pFreeList)
+	{
+		addSlab();
+	}
+
+	void *p = m_pFreeList;
+	if (p)
+	{
+		m_pFreeList = *(void**)p;
+
+		++m_uTotalAllocations;
+		if (++m_uLiveCount > m_uPeakCount)
+		{
+			m_uPeakCount = m_uLiveCount;
+		}
+	}
+
+	unlock();
+
+	if (! p)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void CCSlabAllocator::deallocate(void *p, size_t uSize)
+{
+	if (! p)
+	{
+		return;
+	}
+
+	if (uSize != m_uObjectSize)
+	{
+		::operator delete(p);
+		return;
+	}
+
+	lock();
+	*(void**)p = m_pFreeList;
+	m_pFreeList = p;
+	--m_uLiveCount;
+	unlock();
+}
+
+CCSlabAllocator* CCSlabAllocator::firstAllocator(void)
+{
+	return s_pFirstAllocator;
+}
+
+void CCSlabAllocator::dumpAllocators(void)
+{
+	for (CCSlabAllocator *pAllocator = s_pFirstAllocator; pAllocator; pAllocator = pAllocator->m_pNext)
+	{
+		CCLOG("cocos2d: %s: %u live, %u peak, %u allocations, %u fallbacks, %u slabs (%u KB), %u bytes each",
+			pAllocator->m_pszName,
+			pAllocator->m_uLiveCount,
+			pAllocator->m_uPeakCount,
+			pAllocator->m_uTotalAllocations,
+			pAllocator->m_uFallbackCount,
+			pAllocator->m_uSlabCount,
+			pAllocator->getCapacityInBytes() / 1024,
+			(unsigned int)pAllocator->m_uObjectSize);
+	}
+}
+
+CCThreadSafeSlabAllocator::CCThreadSafeSlabAllocator(const char *pszName, size_t uObjectSize, unsigned int uObjectsPerSlab)
+: CCSlabAllocator(pszName, uObjectSize, uObjectsPerSlab)
+, m_pMutex(new std::mutex())
+{
+}
+
+CCThreadSafeSlabAllocator::~CCThreadSafeSlabAllocator(void)
+{
+	delete (std::mutex*)m_pMutex;
+}
+
+void CCThreadSafeSlabAllocator::lock(void)
+{
+	((std::mutex*)m_pMutex)->lock();
+}
+
+void CCThreadSafeSlabAllocator::unlock(void)
+{
+	((std::mutex*)m_pMutex)->unlock();
+}
+
+// header only classes, created from the input and loader threads as well
+CC_POOLED_ALLOC_IMPL_THREADSAFE(CCTouch, 64)
+CC_POOLED_ALLOC_IMPL_THREADSAFE(CCString, 128)
+
+}//namespace cocos2d
@@ -0,0 +1,894 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include <string.h>
+
+#include "ccBCn.h"
+
+namespace   cocos2d {
+
+/*
+	Layout of the blocks, all the fields are little endian:
+
+	color block (BC1, and the second half of BC2 / BC3), 8 bytes
+		2 bytes		color0, R5G6B5
+		2 bytes		color1, R5G6B5
+		4 bytes		2 bits palette index per pixel, pixel i = y * 4 + x at bit 2 * i
+	In BC1 color0 <= color1 selects the 3 colors palette where index 3 is transparent black.
+	BC2 and BC3 always use the 4 colors palette.
+
+	BC2 alpha, 8 bytes: 4 bits per pixel, pixel i at bit 4 * i
+
+	BC3 alpha, 8 bytes
+		1 byte		alpha0
+		1 byte		alpha1
+		6 bytes		3 bits palette index per pixel, pixel i at bit 3 * i
+	alpha0 > alpha1 interpolates 6 values between them, otherwise 4 values plus 0 and 255.
+*/
+
+static inline unsigned int readUInt16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static inline unsigned int readUInt32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static inline void writeUInt16(unsigned char *p, unsigned int v)
+{
+	p[0] = (unsigned char)(v & 0xff);
+	p[1] = (unsigned char)((v >> 8) & 0xff);
+}
+
+static inline void writeUInt32(unsigned char *p, unsigned int v)
+{
+	writeUInt16(p, v & 0xffff);
+	writeUInt16(p + 2, v >> 16);
+}
+
+static inline int clampByte(int v)
+{
+	return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+unsigned int ccBCnBlockBytes(ccBCnFormat format)
+{
+	switch (format)
+	{
+	case kCCBCnFormat_BC1:
+		return 8;
+	case kCCBCnFormat_BC2:
+	case kCCBCnFormat_BC3:
+	case kCCBCnFormat_BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+unsigned int ccBCnLevelBytes(ccBCnFormat format, unsigned int width, unsigned int height)
+{
+	unsigned int blocksWide = (width + 3) / 4;
+	unsigned int blocksHigh = (height + 3) / 4;
+
+	return (blocksWide > 0 ? blocksWide : 1) * (blocksHigh > 0 ? blocksHigh : 1) * ccBCnBlockBytes(format);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// decoding
+//////////////////////////////////////////////////////////////////////////
+
+static inline void expand565(unsigned int c, int *rgb)
+{
+	int r = (c >> 11) & 0x1f;
+	int g = (c >> 5) & 0x3f;
+	int b = c & 0x1f;
+
+	// rounded like the hardware does, bit replication is off by one for some values
+	rgb[0] = (r * 255 + 15) / 31;
+	rgb[1] = (g * 255 + 31) / 63;
+	rgb[2] = (b * 255 + 15) / 31;
+}
+
+/* palette of a color block, as RGBA */
+static void colorPalette(const unsigned char *block, bool bAllowTransparent, unsigned char palette[4][4])
+{
+	unsigned int c0 = readUInt16(block);
+	unsigned int c1 = readUInt16(block + 2);
+	int rgb0[3], rgb1[3];
+
+	expand565(c0, rgb0);
+	expand565(c1, rgb1);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		palette[0][i] = (unsigned char)rgb0[i];
+		palette[1][i] = (unsigned char)rgb1[i];
+
+		if (c0 > c1 || ! bAllowTransparent)
+		{
+			palette[2][i] = (unsigned char)((2 * rgb0[i] + rgb1[i]) / 3);
+			palette[3][i] = (unsigned char)((rgb0[i] + 2 * rgb1[i]) / 3);
+		}
+		else
+		{
+			palette[2][i] = (unsigned char)((rgb0[i] + rgb1[i]) / 2);
+			palette[3][i] = 0;
+		}
+	}
+
+	palette[0][3] = palette[1][3] = palette[2][3] = 255;
+	palette[3][3] = (c0 > c1 || ! bAllowTransparent) ? 255 : 0;
+}
+
+static void alphaPalette(unsigned int a0, unsigned int a1, unsigned char palette[8])
+{
+	palette[0] = (unsigned char)a0;
+	palette[1] = (unsigned char)a1;
+
+	if (a0 > a1)
+	{
+		for (unsigned int i = 2; i < 8; ++i)
+		{
+			palette[i] = (unsigned char)(((8 - i) * a0 + (i - 1) * a1) / 7);
+		}
+	}
+	else
+	{
+		for (unsigned int i = 2; i < 6; ++i)
+		{
+			palette[i] = (unsigned char)(((6 - i) * a0 + (i - 1) * a1) / 5);
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+/* decodes a block into 16 RGBA pixels */
+static void decodeBlock(ccBCnFormat format, const unsigned char *block, unsigned char pixels[16][4])
+{
+	const unsigned char *colorBlock = (format == kCCBCnFormat_BC1) ? block : block + 8;
+	unsigned char palette[4][4];
+
+	colorPalette(colorBlock, format == kCCBCnFormat_BC1, palette);
+
+	unsigned int indices = readUInt32(colorBlock + 4);
+	for (int i = 0; i < 16; ++i)
+	{
+		memcpy(pixels[i], palette[(indices >> (2 * i)) & 3], 4);
+	}
+
+	if (format == kCCBCnFormat_BC2)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			pixels[i][3] = (unsigned char)(((block[i / 2] >> (4 * (i & 1))) & 0xf) * 17);
+		}
+	}
+	else if (format == kCCBCnFormat_BC3)
+	{
+		unsigned char alphas[8];
+		alphaPalette(block[0], block[1], alphas);
+
+		// 48 bits of indices, read as two runs of 24 bits
+		for (int half = 0; half < 2; ++half)
+		{
+			const unsigned char *p = block + 2 + 3 * half;
+			unsigned int bits = p[0] | (p[1] << 8) | (p[2] << 16);
+
+			for (int i = 0; i < 8; ++i)
+			{
+				pixels[8 * half + i][3] = alphas[(bits >> (3 * i)) & 7];
+			}
+		}
+	}
+}
+
+bool ccBCnDecode(ccBCnFormat format, const unsigned char *blocks, unsigned int width, unsigned int height, unsigned char *rgba)
+{
+	if (format != kCCBCnFormat_BC1 && format != kCCBCnFormat_BC2 && format != kCCBCnFormat_BC3)
+	{
+		return false;
+	}
+
+	unsigned int blockBytes = ccBCnBlockBytes(format);
+	unsigned char pixels[16][4];
+
+	for (unsigned int by = 0; by < height; by += 4)
+	{
+		for (unsigned int bx = 0; bx < width; bx += 4)
+		{
+			decodeBlock(format, blocks, pixels);
+			blocks += blockBytes;
+
+			for (unsigned int y = 0; y < 4 && by + y < height; ++y)
+			{
+				for (unsigned int x = 0; x < 4 && bx + x < width; ++x)
+				{
+					memcpy(rgba + ((by + y) * width + bx + x) * 4, pixels[y * 4 + x], 4);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// encoding
+//////////////////////////////////////////////////////////////////////////
+
+static inline unsigned int pack565(const float *rgb)
+{
+	int r = clampByte((int)(rgb[0] + 0.5f));
+	int g = clampByte((int)(rgb[1] + 0.5f));
+	int b = clampByte((int)(rgb[2] + 0.5f));
+
+	return (((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255);
+}
+
+static inline int colorDistance(const unsigned char *a, const unsigned char *b)
+{
+	int dr = a[0] - b[0];
+	int dg = a[1] - b[1];
+	int db = a[2] - b[2];
+
+	return dr * dr + dg * dg + db * db;
+}
+
+/* for each pixel the closest of the first count palette entries, returns the total error */
+static int pickColorIndices(const unsigned char pixels[16][4], const bool *used, const unsigned char palette[4][4], int count, unsigned char *indices)
+{
+	int error = 0;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		if (! used[i])
+		{
+			continue;
+		}
+
+		int best = 0;
+		int bestDistance = colorDistance(pixels[i], palette[0]);
+		for (int j = 1; j < count; ++j)
+		{
+			int distance = colorDistance(pixels[i], palette[j]);
+			if (distance < bestDistance)
+			{
+				best = j;
+				bestDistance = distance;
+			}
+		}
+
+		indices[i] = (unsigned char)best;
+		error += bestDistance;
+	}
+
+	return error;
+}
+
+/* endpoints along the principal axis of the used pixels, color0 gets the larger projection */
+static void fitEndpoints(const unsigned char pixels[16][4], const bool *used, float *endpoint0, float *endpoint1)
+{
+	float mean[3] = { 0, 0, 0 };
+	float minimum[3] = { 255, 255, 255 };
+	float maximum[3] = { 0, 0, 0 };
+	int count = 0;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		if (! used[i])
+		{
+			continue;
+		}
+
+		for (int c = 0; c < 3; ++c)
+		{
+			mean[c] += pixels[i][c];
+			minimum[c] = pixels[i][c] < minimum[c] ? pixels[i][c] : minimum[c];
+			maximum[c] = pixels[i][c] > maximum[c] ? pixels[i][c] : maximum[c];
+		}
+		++count;
+	}
+
+	for (int c = 0; c < 3; ++c)
+	{
+		mean[c] /= count;
+	}
+
+	// covariance of the colors
+	float cov[6] = { 0, 0, 0, 0, 0, 0 };
+	for (int i = 0; i < 16; ++i)
+	{
+		if (! used[i])
+		{
+			continue;
+		}
+
+		float r = pixels[i][0] - mean[0];
+		float g = pixels[i][1] - mean[1];
+		float b = pixels[i][2] - mean[2];
+
+		cov[0] += r * r;
+		cov[1] += r * g;
+		cov[2] += r * b;
+		cov[3] += g * g;
+		cov[4] += g * b;
+		cov[5] += b * b;
+	}
+
+	// principal axis by power iteration, starting along the bounding box diagonal
+	float axis[3] = { maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2] };
+	for (int iteration = 0; iteration < 8; ++iteration)
+	{
+		float x = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+		float y = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+		float z = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+		float largest = x * x > y * y ? x : y;
+		largest = largest * largest > z * z ? largest : z;
+
+		if (largest * largest < 1e-12f)
+		{
+			break;
+		}
+
+		axis[0] = x / largest;
+		axis[1] = y / largest;
+		axis[2] = z / largest;
+	}
+
+	float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+	if (length < 1e-12f)
+	{
+		// flat block
+		for (int c = 0; c < 3; ++c)
+		{
+			endpoint0[c] = endpoint1[c] = mean[c];
+		}
+		return;
+	}
+
+	float lowest = 0, highest = 0;
+	bool first = true;
+	for (int i = 0; i < 16; ++i)
+	{
+		if (! used[i])
+		{
+			continue;
+		}
+
+		float t = (pixels[i][0] - mean[0]) * axis[0] + (pixels[i][1] - mean[1]) * axis[1] + (pixels[i][2] - mean[2]) * axis[2];
+		if (first || t < lowest)
+		{
+			lowest = t;
+		}
+		if (first || t > highest)
+		{
+			highest = t;
+		}
+		first = false;
+	}
+
+	for (int c = 0; c < 3; ++c)
+	{
+		endpoint0[c] = mean[c] + axis[c] * highest / length;
+		endpoint1[c] = mean[c] + axis[c] * lowest / length;
+	}
+}
+
+/* Least squares endpoints for the given indices, false when they don't constrain both.
+   weights[j] is how much of color0 palette entry j holds. */
+static bool refitEndpoints(const unsigned char pixels[16][4], const bool *used, const unsigned char *indices, const float *weights, float *endpoint0, float *endpoint1)
+{
+	float aa = 0, ab = 0, bb = 0;
+	float ax[3] = { 0, 0, 0 };
+	float bx[3] = { 0, 0, 0 };
+
+	for (int i = 0; i < 16; ++i)
+	{
+		if (! used[i])
+		{
+			continue;
+		}
+
+		float a = weights[indices[i]];
+		float b = 1.0f - a;
+
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < 3; ++c)
+		{
+			ax[c] += a * pixels[i][c];
+			bx[c] += b * pixels[i][c];
+		}
+	}
+
+	float det = aa * bb - ab * ab;
+	if (det < 1e-6f)
+	{
+		return false;
+	}
+
+	for (int c = 0; c < 3; ++c)
+	{
+		endpoint0[c] = (ax[c] * bb - bx[c] * ab) / det;
+		endpoint1[c] = (bx[c] * aa - ax[c] * ab) / det;
+	}
+
+	return true;
+}
+
+/* Quantizes the endpoints and picks the indices, returns the error.
+   bTransparentMode builds the 3 colors palette, which needs color0 <= color1. */
+static int buildColorBlock(const unsigned char pixels[16][4], const bool *used, const float *endpoint0, const float *endpoint1, bool bTransparentMode, unsigned char *block, unsigned char *indices)
+{
+	unsigned int c0 = pack565(endpoint0);
+	unsigned int c1 = pack565(endpoint1);
+
+	if (bTransparentMode ? c0 > c1 : c0 < c1)
+	{
+		unsigned int c = c0;
+		c0 = c1;
+		c1 = c;
+	}
+
+	writeUInt16(block, c0);
+	writeUInt16(block + 2, c1);
+
+	unsigned char palette[4][4];
+	colorPalette(block, true, palette);
+
+	// c0 == c1 is the 3 colors palette whatever the mode, its entry 3 must not be picked
+	int count = (bTransparentMode || c0 == c1) ? 3 : 4;
+	return pickColorIndices(pixels, used, palette, count, indices);
+}
+
+static void encodeColorBlock(const unsigned char pixels[16][4], bool bAllowTransparent, unsigned char *block)
+{
+	bool used[16];
+	bool transparent = false;
+	bool any = false;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		used[i] = ! bAllowTransparent || pixels[i][3] >= 128;
+		transparent = transparent || ! used[i];
+		any = any || used[i];
+	}
+
+	if (! any)
+	{
+		// fully transparent: 3 colors palette, every pixel on index 3
+		writeUInt16(block, 0);
+		writeUInt16(block + 2, 0);
+		writeUInt32(block + 4, 0xffffffff);
+		return;
+	}
+
+	static const float s_weights4[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	static const float s_weights3[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+	const float *weights = transparent ? s_weights3 : s_weights4;
+
+	float endpoint0[3], endpoint1[3];
+	unsigned char indices[16];
+	fitEndpoints(pixels, used, endpoint0, endpoint1);
+	int error = buildColorBlock(pixels, used, endpoint0, endpoint1, transparent, block, indices);
+
+	// One least squares pass on the chosen indices, kept when it lowers the error.
+	// The indices refer to the endpoints as written, so a swap above doesn't matter.
+	unsigned char refined[8];
+	unsigned char refinedIndices[16];
+	if (refitEndpoints(pixels, used, indices, weights, endpoint0, endpoint1))
+	{
+		int refinedError = buildColorBlock(pixels, used, endpoint0, endpoint1, transparent, refined, refinedIndices);
+		if (refinedError < error)
+		{
+			memcpy(block, refined, 4);
+			memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	unsigned int bits = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		bits |= (unsigned int)(used[i] ? indices[i] : 3) << (2 * i);
+	}
+	writeUInt32(block + 4, bits);
+}
+
+static void encodeExplicitAlphaBlock(const unsigned char pixels[16][4], unsigned char *block)
+{
+	memset(block, 0, 8);
+
+	for (int i = 0; i < 16; ++i)
+	{
+		block[i / 2] |= (unsigned char)(((pixels[i][3] * 15 + 127) / 255) << (4 * (i & 1)));
+	}
+}
+
+/* picks the alpha indices for a0 / a1, returns the error */
+static int pickAlphaIndices(const unsigned char pixels[16][4], unsigned int a0, unsigned int a1, unsigned char *indices)
+{
+	unsigned char palette[8];
+	alphaPalette(a0, a1, palette);
+
+	int error = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		int best = 0;
+		int bestDistance = 256 * 256;
+		for (int j = 0; j < 8; ++j)
+		{
+			int d = pixels[i][3] - palette[j];
+			if (d * d < bestDistance)
+			{
+				best = j;
+				bestDistance = d * d;
+			}
+		}
+
+		indices[i] = (unsigned char)best;
+		error += bestDistance;
+	}
+
+	return error;
+}
+
+static void encodeInterpolatedAlphaBlock(const unsigned char pixels[16][4], unsigned char *block)
+{
+	// 6 interpolated values over the whole range
+	unsigned int lowest = 255, highest = 0;
+	// 4 interpolated values over the range without 0 and 255, which are in the palette anyway
+	unsigned int innerLowest = 255, innerHighest = 0;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		unsigned int a = pixels[i][3];
+
+		lowest = a < lowest ? a : lowest;
+		highest = a > highest ? a : highest;
+		if (a != 0 && a != 255)
+		{
+			innerLowest = a < innerLowest ? a : innerLowest;
+			innerHighest = a > innerHighest ? a : innerHighest;
+		}
+	}
+
+	unsigned char indices[16];
+	unsigned char innerIndices[16];
+	unsigned int a0 = highest, a1 = lowest;
+	int error = pickAlphaIndices(pixels, a0, a1, indices);
+
+	if (innerLowest > innerHighest)
+	{
+		// only 0 and 255
+		innerLowest = innerHighest = 0;
+	}
+	int innerError = pickAlphaIndices(pixels, innerLowest, innerHighest, innerIndices);
+	if (innerError < error)
+	{
+		a0 = innerLowest;
+		a1 = innerHighest;
+		memcpy(indices, innerIndices, sizeof(indices));
+	}
+
+	block[0] = (unsigned char)a0;
+	block[1] = (unsigned char)a1;
+	for (int half = 0; half < 2; ++half)
+	{
+		unsigned int bits = 0;
+		for (int i = 0; i < 8; ++i)
+		{
+			bits |= (unsigned int)indices[8 * half + i] << (3 * i);
+		}
+
+		block[2 + 3 * half] = (unsigned char)(bits & 0xff);
+		block[3 + 3 * half] = (unsigned char)((bits >> 8) & 0xff);
+		block[4 + 3 * half] = (unsigned char)((bits >> 16) & 0xff);
+	}
+}
+
+bool ccBCnEncode(ccBCnFormat format, const unsigned char *rgba, unsigned int width, unsigned int height, unsigned char *out)
+{
+	if (format != kCCBCnFormat_BC1 && format != kCCBCnFormat_BC2 && format != kCCBCnFormat_BC3)
+	{
+		return false;
+	}
+
+	unsigned int blockBytes = ccBCnBlockBytes(format);
+	unsigned char pixels[16][4];
+
+	for (unsigned int by = 0; by < height; by += 4)
+	{
+		for (unsigned int bx = 0; bx < width; bx += 4)
+		{
+			// the blocks crossing the right or bottom edge repeat the last column / row
+			for (unsigned int y = 0; y < 4; ++y)
+			{
+				unsigned int sy = by + y < height ? by + y : height - 1;
+				for (unsigned int x = 0; x < 4; ++x)
+				{
+					unsigned int sx = bx + x < width ? bx + x : width - 1;
+					memcpy(pixels[y * 4 + x], rgba + (sy * width + sx) * 4, 4);
+				}
+			}
+
+			switch (format)
+			{
+			case kCCBCnFormat_BC1:
+				encodeColorBlock(pixels, true, out);
+				break;
+			case kCCBCnFormat_BC2:
+				encodeExplicitAlphaBlock(pixels, out);
+				encodeColorBlock(pixels, false, out + 8);
+				break;
+			default:
+				encodeInterpolatedAlphaBlock(pixels, out);
+				encodeColorBlock(pixels, false, out + 8);
+				break;
+			}
+			out += blockBytes;
+		}
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// DDS
+//////////////////////////////////////////////////////////////////////////
+
+/*
+	"DDS " followed by the 124 bytes DDS_HEADER, with offsets:
+		4	flags
+		8	height
+		12	width
+		16	pitch or linear size
+		24	mipmap count
+		72	DDS_PIXELFORMAT, 32 bytes: size, flags, fourCC, ...
+		104	caps
+	A DX10 fourCC adds the 20 bytes DDS_HEADER_DXT10:
+		0	dxgi format
+		4	resource dimension
+		8	misc flags
+		12	array size
+		16	misc flags 2, alpha mode in its low 3 bits
+*/
+#define DDS_MAGIC				0x20534444
+#define DDS_HEADER_SIZE			124
+#define DDS_PIXELFORMAT_SIZE	32
+#define DDS_HEADER_DX10_SIZE	20
+
+#define DDSD_CAPS				0x1
+#define DDSD_HEIGHT				0x2
+#define DDSD_WIDTH				0x4
+#define DDSD_PIXELFORMAT		0x1000
+#define DDSD_MIPMAPCOUNT		0x20000
+#define DDSD_LINEARSIZE			0x80000
+#define DDSD_DEPTH				0x800000
+#define DDPF_FOURCC				0x4
+#define DDSCAPS_COMPLEX			0x8
+#define DDSCAPS_TEXTURE			0x1000
+#define DDSCAPS_MIPMAP			0x400000
+#define DDSCAPS2_CUBEMAP		0x200
+#define DDS_DIMENSION_TEXTURE2D	3
+#define DDS_ALPHA_MODE_PREMULTIPLIED	2
+
+#define DDS_FOURCC(a, b, c, d)	((unsigned int)(a) | ((unsigned int)(b) << 8) | ((unsigned int)(c) << 16) | ((unsigned int)(d) << 24))
+
+bool ccDDSParse(const unsigned char *buffer, unsigned long bufSize, tDDSInfo *psInfo)
+{
+	if (! buffer || bufSize < 4 + DDS_HEADER_SIZE || readUInt32(buffer) != DDS_MAGIC)
+	{
+		return false;
+	}
+
+	const unsigned char *header = buffer + 4;
+	const unsigned char *pixelFormat = header + 72;
+	unsigned int headerBytes = 4 + DDS_HEADER_SIZE;
+
+	if (readUInt32(header) != DDS_HEADER_SIZE || readUInt32(pixelFormat) != DDS_PIXELFORMAT_SIZE)
+	{
+		return false;
+	}
+
+	// volumes and cube maps aren't 2D textures
+	if ((readUInt32(header + 4) & DDSD_DEPTH) || (readUInt32(header + 108) & DDSCAPS2_CUBEMAP))
+	{
+		return false;
+	}
+
+	if (! (readUInt32(pixelFormat + 4) & DDPF_FOURCC))
+	{
+		return false;
+	}
+
+	psInfo->premultipliedAlpha = false;
+
+	unsigned int fourCC = readUInt32(pixelFormat + 8);
+	if (fourCC == DDS_FOURCC('D', 'X', 'T', '1'))
+	{
+		psInfo->format = kCCBCnFormat_BC1;
+	}
+	else if (fourCC == DDS_FOURCC('D', 'X', 'T', '2') || fourCC == DDS_FOURCC('D', 'X', 'T', '3'))
+	{
+		psInfo->format = kCCBCnFormat_BC2;
+		psInfo->premultipliedAlpha = (fourCC == DDS_FOURCC('D', 'X', 'T', '2'));
+	}
+	else if (fourCC == DDS_FOURCC('D', 'X', 'T', '4') || fourCC == DDS_FOURCC('D', 'X', 'T', '5'))
+	{
+		psInfo->format = kCCBCnFormat_BC3;
+		psInfo->premultipliedAlpha = (fourCC == DDS_FOURCC('D', 'X', 'T', '4'));
+	}
+	else if (fourCC == DDS_FOURCC('D', 'X', '1', '0'))
+	{
+		if (bufSize < headerBytes + DDS_HEADER_DX10_SIZE)
+		{
+			return false;
+		}
+
+		const unsigned char *header10 = buffer + headerBytes;
+		headerBytes += DDS_HEADER_DX10_SIZE;
+
+		if (readUInt32(header10 + 4) != DDS_DIMENSION_TEXTURE2D || readUInt32(header10 + 12) > 1)
+		{
+			return false;
+		}
+
+		// the UNORM_SRGB variants follow the UNORM ones, the TYPELESS ones precede them
+		unsigned int dxgiFormat = readUInt32(header10);
+		switch (dxgiFormat)
+		{
+		case kCCBCnFormat_BC1 - 1:
+		case kCCBCnFormat_BC1:
+		case kCCBCnFormat_BC1 + 1:
+			psInfo->format = kCCBCnFormat_BC1;
+			break;
+		case kCCBCnFormat_BC2 - 1:
+		case kCCBCnFormat_BC2:
+		case kCCBCnFormat_BC2 + 1:
+			psInfo->format = kCCBCnFormat_BC2;
+			break;
+		case kCCBCnFormat_BC3 - 1:
+		case kCCBCnFormat_BC3:
+		case kCCBCnFormat_BC3 + 1:
+			psInfo->format = kCCBCnFormat_BC3;
+			break;
+		case kCCBCnFormat_BC7 - 1:
+		case kCCBCnFormat_BC7:
+		case kCCBCnFormat_BC7 + 1:
+			psInfo->format = kCCBCnFormat_BC7;
+			break;
+		default:
+			return false;
+		}
+
+		psInfo->premultipliedAlpha = ((readUInt32(header10 + 16) & 0x7) == DDS_ALPHA_MODE_PREMULTIPLIED);
+	}
+	else
+	{
+		return false;
+	}
+
+	psInfo->width = readUInt32(header + 12);
+	psInfo->height = readUInt32(header + 8);
+	if (psInfo->width == 0 || psInfo->height == 0 || psInfo->width > 16384 || psInfo->height > 16384)
+	{
+		return false;
+	}
+
+	unsigned int mipmapCount = (readUInt32(header + 4) & DDSD_MIPMAPCOUNT) ? readUInt32(header + 24) : 1;
+	mipmapCount = mipmapCount > 0 ? mipmapCount : 1;
+
+	psInfo->data = buffer + headerBytes;
+	psInfo->dataLength = 0;
+	psInfo->mipmapCount = 0;
+
+	unsigned long available = bufSize - headerBytes;
+	unsigned int width = psInfo->width;
+	unsigned int height = psInfo->height;
+	while (psInfo->mipmapCount < mipmapCount)
+	{
+		unsigned int levelBytes = ccBCnLevelBytes(psInfo->format, width, height);
+		if (psInfo->dataLength + levelBytes > available)
+		{
+			break;
+		}
+
+		psInfo->dataLength += levelBytes;
+		psInfo->mipmapCount++;
+
+		if (width == 1 && height == 1)
+		{
+			break;
+		}
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	return psInfo->mipmapCount > 0;
+}
+
+unsigned int ccDDSHeaderBytes(ccBCnFormat format)
+{
+	return 4 + DDS_HEADER_SIZE + (format == kCCBCnFormat_BC7 ? DDS_HEADER_DX10_SIZE : 0);
+}
+
+unsigned int ccDDSWriteHeader(ccBCnFormat format, unsigned int width, unsigned int height, unsigned int mipmapCount, bool premultipliedAlpha, unsigned char *out)
+{
+	unsigned int headerBytes = ccDDSHeaderBytes(format);
+	memset(out, 0, headerBytes);
+
+	unsigned int flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+	unsigned int caps = DDSCAPS_TEXTURE;
+	if (mipmapCount > 1)
+	{
+		flags |= DDSD_MIPMAPCOUNT;
+		caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	}
+
+	unsigned char *header = out + 4;
+	writeUInt32(out, DDS_MAGIC);
+	writeUInt32(header, DDS_HEADER_SIZE);
+	writeUInt32(header + 4, flags);
+	writeUInt32(header + 8, height);
+	writeUInt32(header + 12, width);
+	writeUInt32(header + 16, ccBCnLevelBytes(format, width, height));
+	writeUInt32(header + 24, mipmapCount);
+	writeUInt32(header + 104, caps);
+
+	unsigned char *pixelFormat = header + 72;
+	writeUInt32(pixelFormat, DDS_PIXELFORMAT_SIZE);
+	writeUInt32(pixelFormat + 4, DDPF_FOURCC);
+
+	switch (format)
+	{
+	case kCCBCnFormat_BC1:
+		writeUInt32(pixelFormat + 8, DDS_FOURCC('D', 'X', 'T', '1'));
+		break;
+	case kCCBCnFormat_BC2:
+		writeUInt32(pixelFormat + 8, premultipliedAlpha ? DDS_FOURCC('D', 'X', 'T', '2') : DDS_FOURCC('D', 'X', 'T', '3'));
+		break;
+	case kCCBCnFormat_BC3:
+		writeUInt32(pixelFormat + 8, premultipliedAlpha ? DDS_FOURCC('D', 'X', 'T', '4') : DDS_FOURCC('D', 'X', 'T', '5'));
+		break;
+	default:
+		{
+			unsigned char *header10 = out + 4 + DDS_HEADER_SIZE;
+			writeUInt32(pixelFormat + 8, DDS_FOURCC('D', 'X', '1', '0'));
+			writeUInt32(header10, format);
+			writeUInt32(header10 + 4, DDS_DIMENSION_TEXTURE2D);
+			writeUInt32(header10 + 12, 1);
+			writeUInt32(header10 + 16, premultipliedAlpha ? DDS_ALPHA_MODE_PREMULTIPLIED : 0);
+		}
+		break;
+	}
+
+	return headerBytes;
+}
+
+}//namespace   cocos2d 
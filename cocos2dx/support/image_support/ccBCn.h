@@ -0,0 +1,98 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __SUPPORT_IMAGE_SUPPORT_CCBCN_H__
+#define __SUPPORT_IMAGE_SUPPORT_CCBCN_H__
+
+/*
+	Block compression (BCn / DXTn) codec and DDS container helpers.
+
+	It only depends on the C runtime, so the offline tools can build it
+	outside of the engine, see tools/ddsencoder.
+*/
+
+namespace   cocos2d {
+
+/** block compressed formats, the values are the matching DXGI_FORMAT_BCn_UNORM */
+typedef enum {
+	kCCBCnFormat_Invalid = 0,
+	//! DXT1: 4 bits per pixel, opaque or 1 bit alpha
+	kCCBCnFormat_BC1 = 71,
+	//! DXT3: 8 bits per pixel, explicit 4 bits alpha
+	kCCBCnFormat_BC2 = 74,
+	//! DXT5: 8 bits per pixel, interpolated alpha
+	kCCBCnFormat_BC3 = 77,
+	//! 8 bits per pixel, best quality, needs a feature level 11 device
+	kCCBCnFormat_BC7 = 98,
+} ccBCnFormat;
+
+/** size of a 4x4 block: 8 bytes for BC1, 16 for the others */
+unsigned int ccBCnBlockBytes(ccBCnFormat format);
+
+/** size of a width x height level, partial blocks on the right and bottom edges are whole blocks */
+unsigned int ccBCnLevelBytes(ccBCnFormat format, unsigned int width, unsigned int height);
+
+/** Compresses a RGBA8888 image (rows of width * 4 bytes) into ccBCnLevelBytes() bytes of out.
+	BC1 keeps the pixels with alpha < 128 transparent, the others are opaque.
+	@return false for BC7, which can't be encoded
+*/
+bool ccBCnEncode(ccBCnFormat format, const unsigned char *rgba, unsigned int width, unsigned int height, unsigned char *out);
+
+/** Decompresses a level into RGBA8888 (rows of width * 4 bytes).
+	This is the CPU fallback for the devices which can't sample the format, and what the tests compare against.
+	@return false for BC7, which can't be decoded
+*/
+bool ccBCnDecode(ccBCnFormat format, const unsigned char *blocks, unsigned int width, unsigned int height, unsigned char *rgba);
+
+/** what ccDDSParse found in a DDS file */
+typedef struct sDDSInfo {
+	ccBCnFormat format;
+	unsigned int width;
+	unsigned int height;
+	/** levels whose data is in the file, at least 1 */
+	unsigned int mipmapCount;
+	/** DXT2 / DXT4, or a DX10 header with the premultiplied alpha mode */
+	bool premultipliedAlpha;
+	/** top level, the smaller levels follow it */
+	const unsigned char *data;
+	unsigned int dataLength;
+} tDDSInfo;
+
+/** Reads the header of a DDS file in memory. Only 2D BC1, BC2, BC3 and BC7 textures are supported.
+	When the file is truncated, mipmapCount only counts the complete levels.
+*/
+bool ccDDSParse(const unsigned char *buffer, unsigned long bufSize, tDDSInfo *psInfo);
+
+/** bytes written by ccDDSWriteHeader: 128, or 148 for BC7 which needs a DX10 header */
+unsigned int ccDDSHeaderBytes(ccBCnFormat format);
+
+/** writes the magic and the header of a DDS file, the levels go right after it
+	premultipliedAlpha picks DXT2 / DXT4 for BC2 / BC3, BC1 has no such variant
+	@return the bytes written, ccDDSHeaderBytes(format)
+*/
+unsigned int ccDDSWriteHeader(ccBCnFormat format, unsigned int width, unsigned int height, unsigned int mipmapCount, bool premultipliedAlpha, unsigned char *out);
+
+}//namespace   cocos2d 
+
+#endif // __SUPPORT_IMAGE_SUPPORT_CCBCN_H__
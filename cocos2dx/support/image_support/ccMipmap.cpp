@@ -0,0 +1,587 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ccMipmap.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CC_MIPMAP_SSE2 1
+#elif defined(_M_ARM) || defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CC_MIPMAP_NEON 1
+#endif
+
+namespace   cocos2d {
+
+/*
+	Layout of a mip chain file, all the fields are 32 bits little endian:
+
+		4 bytes		"CCMP"
+		version		kFileVersion
+		width		top level
+		height
+		levelCount
+		filter		ccMipmapFilter
+		premultipliedAlpha
+		key			hash of the above and of the top level pixels
+	then the levels 1 to levelCount - 1, RGBA8888, without padding.
+*/
+
+#define kFileVersion		1
+#define kFileHeaderBytes	32
+
+// half width of the Kaiser window, in pixels of the smaller level
+#define kKaiserRadius		2.0
+#define kKaiserAlpha		4.0
+#define kPi					3.14159265358979323846
+
+static inline unsigned int readUInt32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static inline void writeUInt32(unsigned char *p, unsigned int v)
+{
+	p[0] = (unsigned char)(v & 0xFF);
+	p[1] = (unsigned char)((v >> 8) & 0xFF);
+	p[2] = (unsigned char)((v >> 16) & 0xFF);
+	p[3] = (unsigned char)((v >> 24) & 0xFF);
+}
+
+unsigned int ccMipmapLevelCount(unsigned int width, unsigned int height)
+{
+	unsigned int size = width > height ? width : height;
+	unsigned int count = 1;
+	while (size > 1 && count < kCCMipmapMaxLevels)
+	{
+		size >>= 1;
+		++count;
+	}
+
+	return count;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// box filter
+//////////////////////////////////////////////////////////////////////////
+
+// average of the cols x rows pixels at (x, y), the odd edges average 3 pixels instead of 2
+static void boxPixel(const unsigned char *src, unsigned int width, unsigned int x, unsigned int cols, unsigned int y, unsigned int rows, bool premultipliedAlpha, unsigned char *out)
+{
+	unsigned int sum[4] = { 0, 0, 0, 0 };
+	unsigned int weighted[3] = { 0, 0, 0 };
+	unsigned int count = cols * rows;
+
+	for (unsigned int j = 0; j < rows; ++j)
+	{
+		const unsigned char *p = src + ((y + j) * width + x) * 4;
+		for (unsigned int i = 0; i < cols; ++i, p += 4)
+		{
+			sum[0] += p[0];
+			sum[1] += p[1];
+			sum[2] += p[2];
+			sum[3] += p[3];
+			weighted[0] += p[0] * p[3];
+			weighted[1] += p[1] * p[3];
+			weighted[2] += p[2] * p[3];
+		}
+	}
+
+	out[3] = (unsigned char)((sum[3] + count / 2) / count);
+	for (int c = 0; c < 3; ++c)
+	{
+		if (premultipliedAlpha || sum[3] == 0)
+		{
+			out[c] = (unsigned char)((sum[c] + count / 2) / count);
+		}
+		else
+		{
+			out[c] = (unsigned char)((weighted[c] + sum[3] / 2) / sum[3]);
+		}
+	}
+}
+
+// 2x2 averages of a row pair of premultiplied pixels into count pixels, returns how many it did
+static unsigned int boxRowSIMD(const unsigned char *row0, const unsigned char *row1, unsigned int count, unsigned char *out)
+{
+	unsigned int done = 0;
+
+#if CC_MIPMAP_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i two = _mm_set1_epi16(2);
+	// 4 source pixels of each row give 2 pixels
+	for (; done + 2 <= count; done += 2, row0 += 16, row1 += 16, out += 8)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)row0);
+		__m128i b = _mm_loadu_si128((const __m128i*)row1);
+		// 16 bits lanes, the vertical sums of the pixels 0 1 and 2 3
+		__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+		__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+		lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+		hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+		__m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), two), 2);
+		_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(sum, sum));
+	}
+#elif CC_MIPMAP_NEON
+	for (; done + 2 <= count; done += 2, row0 += 16, row1 += 16, out += 8)
+	{
+		uint8x16_t a = vld1q_u8(row0);
+		uint8x16_t b = vld1q_u8(row1);
+		uint16x8_t lo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+		uint16x8_t hi = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+		uint16x8_t sum = vcombine_u16(vadd_u16(vget_low_u16(lo), vget_high_u16(lo)), vadd_u16(vget_low_u16(hi), vget_high_u16(hi)));
+		// rounding shift: (sum + 2) >> 2
+		vst1_u8(out, vrshrn_n_u16(sum, 2));
+	}
+#endif
+
+	return done;
+}
+
+static void boxDownsample(const unsigned char *src, unsigned int width, unsigned int height, bool premultipliedAlpha, unsigned char *dst)
+{
+	unsigned int dstWidth = width > 1 ? width / 2 : 1;
+	unsigned int dstHeight = height > 1 ? height / 2 : 1;
+
+	for (unsigned int y = 0; y < dstHeight; ++y)
+	{
+		unsigned int rows = height == 1 ? 1 : ((height & 1) && y == dstHeight - 1 ? 3 : 2);
+		unsigned char *out = dst + y * dstWidth * 4;
+		unsigned int x = 0;
+
+		// the straight alpha pixels are weighted, which the vector path doesn't do
+		if (premultipliedAlpha && rows == 2 && width > 1)
+		{
+			unsigned int evenCount = (width & 1) ? dstWidth - 1 : dstWidth;
+			const unsigned char *row0 = src + 2 * y * width * 4;
+			x = boxRowSIMD(row0, row0 + width * 4, evenCount, out);
+		}
+
+		for (; x < dstWidth; ++x)
+		{
+			unsigned int cols = width == 1 ? 1 : ((width & 1) && x == dstWidth - 1 ? 3 : 2);
+			boxPixel(src, width, 2 * x, cols, 2 * y, rows, premultipliedAlpha, out + x * 4);
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Kaiser filter
+//////////////////////////////////////////////////////////////////////////
+
+// modified Bessel function of the first kind, order 0
+static double bessel0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; ++k)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+		{
+			break;
+		}
+	}
+
+	return sum;
+}
+
+static double kaiserSinc(double x)
+{
+	double t = x / kKaiserRadius;
+	if (t <= -1.0 || t >= 1.0)
+	{
+		return 0.0;
+	}
+
+	double sinc = x == 0.0 ? 1.0 : sin(kPi * x) / (kPi * x);
+	return sinc * bessel0(kKaiserAlpha * sqrt(1.0 - t * t)) / bessel0(kKaiserAlpha);
+}
+
+/*
+	Taps of the filter along one axis: out[i] is the sum of weights[i * tapCount + k]
+	times the source pixel MIN(MAX(first[i] + k, 0), size - 1).
+*/
+typedef struct sKaiserTaps {
+	unsigned int tapCount;
+	int *first;
+	float *weights;
+} tKaiserTaps;
+
+static void kaiserTaps(unsigned int size, unsigned int dstSize, tKaiserTaps *psTaps)
+{
+	double scale = (double)size / dstSize;
+	double radius = kKaiserRadius * scale;
+
+	psTaps->tapCount = (unsigned int)ceil(2.0 * radius) + 1;
+	psTaps->first = new int[dstSize];
+	psTaps->weights = new float[dstSize * psTaps->tapCount];
+
+	for (unsigned int i = 0; i < dstSize; ++i)
+	{
+		double center = (i + 0.5) * scale;
+		int first = (int)floor(center - radius);
+		float *weights = psTaps->weights + i * psTaps->tapCount;
+
+		double total = 0.0;
+		for (unsigned int k = 0; k < psTaps->tapCount; ++k)
+		{
+			weights[k] = (float)kaiserSinc((first + (int)k + 0.5 - center) / scale);
+			total += weights[k];
+		}
+		for (unsigned int k = 0; k < psTaps->tapCount; ++k)
+		{
+			weights[k] = (float)(weights[k] / total);
+		}
+
+		psTaps->first[i] = first;
+	}
+}
+
+static inline int clampIndex(int i, unsigned int size)
+{
+	return i < 0 ? 0 : (i >= (int)size ? (int)size - 1 : i);
+}
+
+static void kaiserDownsample(const unsigned char *src, unsigned int width, unsigned int height, bool premultipliedAlpha, unsigned char *dst)
+{
+	unsigned int dstWidth = width > 1 ? width / 2 : 1;
+	unsigned int dstHeight = height > 1 ? height / 2 : 1;
+
+	// the colors are filtered premultiplied, the negative lobes would make straight alpha pixels bleed
+	float *pixels = new float[width * height * 4];
+	for (unsigned int i = 0; i < width * height; ++i)
+	{
+		float alpha = premultipliedAlpha ? 1.0f : src[i * 4 + 3] / 255.0f;
+		pixels[i * 4 + 0] = src[i * 4 + 0] * alpha;
+		pixels[i * 4 + 1] = src[i * 4 + 1] * alpha;
+		pixels[i * 4 + 2] = src[i * 4 + 2] * alpha;
+		pixels[i * 4 + 3] = src[i * 4 + 3];
+	}
+
+	tKaiserTaps horizontal, vertical;
+	kaiserTaps(width, dstWidth, &horizontal);
+	kaiserTaps(height, dstHeight, &vertical);
+
+	// horizontal pass: dstWidth x height
+	float *half = new float[dstWidth * height * 4];
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		const float *row = pixels + y * width * 4;
+		for (unsigned int x = 0; x < dstWidth; ++x)
+		{
+			const float *weights = horizontal.weights + x * horizontal.tapCount;
+			float sum[4] = { 0, 0, 0, 0 };
+			for (unsigned int k = 0; k < horizontal.tapCount; ++k)
+			{
+				const float *p = row + clampIndex(horizontal.first[x] + (int)k, width) * 4;
+				sum[0] += weights[k] * p[0];
+				sum[1] += weights[k] * p[1];
+				sum[2] += weights[k] * p[2];
+				sum[3] += weights[k] * p[3];
+			}
+			memcpy(half + (y * dstWidth + x) * 4, sum, sizeof(sum));
+		}
+	}
+
+	// vertical pass, back to bytes
+	for (unsigned int y = 0; y < dstHeight; ++y)
+	{
+		const float *weights = vertical.weights + y * vertical.tapCount;
+		for (unsigned int x = 0; x < dstWidth; ++x)
+		{
+			float sum[4] = { 0, 0, 0, 0 };
+			for (unsigned int k = 0; k < vertical.tapCount; ++k)
+			{
+				const float *p = half + (clampIndex(vertical.first[y] + (int)k, height) * dstWidth + x) * 4;
+				sum[0] += weights[k] * p[0];
+				sum[1] += weights[k] * p[1];
+				sum[2] += weights[k] * p[2];
+				sum[3] += weights[k] * p[3];
+			}
+
+			// the ringing can't make the colors brighter than the alpha allows
+			float alpha = sum[3] < 0.0f ? 0.0f : (sum[3] > 255.0f ? 255.0f : sum[3]);
+			unsigned char *out = dst + (y * dstWidth + x) * 4;
+			for (int c = 0; c < 3; ++c)
+			{
+				float color = sum[c] < 0.0f ? 0.0f : (sum[c] > alpha ? alpha : sum[c]);
+				if (! premultipliedAlpha)
+				{
+					color = alpha > 0.0f ? color * 255.0f / alpha : 0.0f;
+				}
+				out[c] = (unsigned char)(color + 0.5f);
+			}
+			out[3] = (unsigned char)(alpha + 0.5f);
+		}
+	}
+
+	delete [] horizontal.first;
+	delete [] horizontal.weights;
+	delete [] vertical.first;
+	delete [] vertical.weights;
+	delete [] half;
+	delete [] pixels;
+}
+
+void ccMipmapDownsample(ccMipmapFilter filter, const unsigned char *src, unsigned int width, unsigned int height, bool premultipliedAlpha, unsigned char *dst)
+{
+	if (filter == kCCMipmapFilter_Kaiser)
+	{
+		kaiserDownsample(src, width, height, premultipliedAlpha, dst);
+	}
+	else
+	{
+		boxDownsample(src, width, height, premultipliedAlpha, dst);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// mip chain
+//////////////////////////////////////////////////////////////////////////
+
+bool ccMipmapChainInit(tMipmapChain *psChain, const unsigned char *pixels, unsigned int bytesPerPixel, unsigned int width, unsigned int height, unsigned int levelWidth, unsigned int levelHeight, bool premultipliedAlpha)
+{
+	memset(psChain, 0, sizeof(tMipmapChain));
+
+	if (! pixels || (bytesPerPixel != 3 && bytesPerPixel != 4) || width > levelWidth || height > levelHeight || levelWidth == 0 || levelHeight == 0)
+	{
+		return false;
+	}
+
+	unsigned char *level = new unsigned char[levelWidth * levelHeight * 4];
+	if (width != levelWidth || height != levelHeight)
+	{
+		memset(level, 0, levelWidth * levelHeight * 4);
+	}
+
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		const unsigned char *in = pixels + y * width * bytesPerPixel;
+		unsigned char *out = level + y * levelWidth * 4;
+		if (bytesPerPixel == 4)
+		{
+			memcpy(out, in, width * 4);
+		}
+		else
+		{
+			for (unsigned int x = 0; x < width; ++x, in += 3, out += 4)
+			{
+				out[0] = in[0];
+				out[1] = in[1];
+				out[2] = in[2];
+				out[3] = 255;
+			}
+		}
+	}
+
+	psChain->width = levelWidth;
+	psChain->height = levelHeight;
+	psChain->levelCount = 1;
+	psChain->premultipliedAlpha = premultipliedAlpha;
+	psChain->levels[0] = level;
+	return true;
+}
+
+void ccMipmapChainGenerate(tMipmapChain *psChain, ccMipmapFilter filter)
+{
+	unsigned int levelCount = ccMipmapLevelCount(psChain->width, psChain->height);
+	unsigned int width = psChain->width;
+	unsigned int height = psChain->height;
+
+	for (unsigned int i = 1; i < levelCount; ++i)
+	{
+		unsigned int levelWidth = width > 1 ? width / 2 : 1;
+		unsigned int levelHeight = height > 1 ? height / 2 : 1;
+
+		if (! psChain->levels[i])
+		{
+			psChain->levels[i] = new unsigned char[levelWidth * levelHeight * 4];
+		}
+		ccMipmapDownsample(filter, psChain->levels[i - 1], width, height, psChain->premultipliedAlpha, psChain->levels[i]);
+
+		width = levelWidth;
+		height = levelHeight;
+	}
+
+	psChain->levelCount = levelCount;
+}
+
+void ccMipmapChainDestroy(tMipmapChain *psChain)
+{
+	for (unsigned int i = 0; i < kCCMipmapMaxLevels; ++i)
+	{
+		delete [] psChain->levels[i];
+		psChain->levels[i] = NULL;
+	}
+
+	psChain->levelCount = 0;
+}
+
+// FNV-1a over 32 bits words
+static unsigned int chainKey(const tMipmapChain *psChain, ccMipmapFilter filter)
+{
+	unsigned int hash = 2166136261u;
+	unsigned int fields[4] = { psChain->width, psChain->height, (unsigned int)filter, psChain->premultipliedAlpha ? 1u : 0u };
+	for (int i = 0; i < 4; ++i)
+	{
+		hash = (hash ^ fields[i]) * 16777619u;
+	}
+
+	const unsigned char *p = psChain->levels[0];
+	unsigned int words = psChain->width * psChain->height;
+	for (unsigned int i = 0; i < words; ++i, p += 4)
+	{
+		unsigned int word;
+		memcpy(&word, p, 4);
+		hash = (hash ^ word) * 16777619u;
+	}
+
+	return hash;
+}
+
+bool ccMipmapChainWrite(const tMipmapChain *psChain, ccMipmapFilter filter, const char *path)
+{
+	if (! psChain->levels[0] || psChain->levelCount < 2)
+	{
+		return false;
+	}
+
+	FILE *fp = fopen(path, "wb");
+	if (! fp)
+	{
+		return false;
+	}
+
+	unsigned char header[kFileHeaderBytes];
+	memcpy(header, "CCMP", 4);
+	writeUInt32(header + 4, kFileVersion);
+	writeUInt32(header + 8, psChain->width);
+	writeUInt32(header + 12, psChain->height);
+	writeUInt32(header + 16, psChain->levelCount);
+	writeUInt32(header + 20, (unsigned int)filter);
+	writeUInt32(header + 24, psChain->premultipliedAlpha ? 1 : 0);
+	writeUInt32(header + 28, chainKey(psChain, filter));
+
+	bool bRet = fwrite(header, kFileHeaderBytes, 1, fp) == 1;
+
+	unsigned int width = psChain->width;
+	unsigned int height = psChain->height;
+	for (unsigned int i = 1; bRet && i < psChain->levelCount; ++i)
+	{
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		bRet = fwrite(psChain->levels[i], width * height * 4, 1, fp) == 1;
+	}
+
+	bRet = fclose(fp) == 0 && bRet;
+	if (! bRet)
+	{
+		// don't leave a truncated file behind
+		remove(path);
+	}
+
+	return bRet;
+}
+
+bool ccMipmapChainRead(tMipmapChain *psChain, ccMipmapFilter filter, const char *path)
+{
+	if (! psChain->levels[0])
+	{
+		return false;
+	}
+
+	FILE *fp = fopen(path, "rb");
+	if (! fp)
+	{
+		return false;
+	}
+
+	bool bRet = false;
+	do 
+	{
+		unsigned char header[kFileHeaderBytes];
+		if (fread(header, kFileHeaderBytes, 1, fp) != 1 || memcmp(header, "CCMP", 4) != 0 || readUInt32(header + 4) != kFileVersion)
+		{
+			break;
+		}
+
+		unsigned int levelCount = readUInt32(header + 16);
+		if (readUInt32(header + 8) != psChain->width || readUInt32(header + 12) != psChain->height || readUInt32(header + 20) != (unsigned int)filter
+			|| readUInt32(header + 24) != (psChain->premultipliedAlpha ? 1u : 0u) || levelCount != ccMipmapLevelCount(psChain->width, psChain->height))
+		{
+			break;
+		}
+
+		// checked last, the hash reads the whole top level
+		if (readUInt32(header + 28) != chainKey(psChain, filter))
+		{
+			break;
+		}
+
+		unsigned char *levels[kCCMipmapMaxLevels] = { 0 };
+		unsigned int width = psChain->width;
+		unsigned int height = psChain->height;
+		unsigned int i = 1;
+		for (; i < levelCount; ++i)
+		{
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+
+			levels[i] = new unsigned char[width * height * 4];
+			if (fread(levels[i], width * height * 4, 1, fp) != 1)
+			{
+				break;
+			}
+		}
+
+		if (i < levelCount)
+		{
+			for (unsigned int j = 1; j <= i; ++j)
+			{
+				delete [] levels[j];
+			}
+			break;
+		}
+
+		for (i = 1; i < levelCount; ++i)
+		{
+			delete [] psChain->levels[i];
+			psChain->levels[i] = levels[i];
+		}
+
+		psChain->levelCount = levelCount;
+		bRet = true;
+	} while (0);
+
+	fclose(fp);
+	return bRet;
+}
+
+}//namespace   cocos2d 
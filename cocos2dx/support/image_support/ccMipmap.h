@@ -0,0 +1,91 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __SUPPORT_IMAGE_SUPPORT_CCMIPMAP_H__
+#define __SUPPORT_IMAGE_SUPPORT_CCMIPMAP_H__
+
+/*
+	Mip chain generation for RGBA8888 images, and the files they are cached in.
+
+	Like ccBCn it only depends on the C runtime, tools/ddsencoder builds its
+	mip levels with it.
+*/
+
+namespace   cocos2d {
+
+/** D3D11_REQ_MIP_LEVELS: a 16384 x 16384 texture has 15 levels */
+#define kCCMipmapMaxLevels 15
+
+typedef enum {
+	//! 2x2 average, vectorized with SSE2 or NEON
+	kCCMipmapFilter_Box,
+	//! Kaiser windowed sinc over 8 x 8 pixels: keeps the small levels sharper but is 30 times slower than the box, cache its chains
+	kCCMipmapFilter_Kaiser,
+} ccMipmapFilter;
+
+/** RGBA8888 levels of a texture, each level is half the size of the previous one, at least 1 x 1 */
+typedef struct sMipmapChain {
+	unsigned int width;
+	unsigned int height;
+	unsigned int levelCount;
+	/** the colors are multiplied by the alpha, as CCImage loads the PNG files */
+	bool premultipliedAlpha;
+	/** rows of width * 4 bytes, allocated with new[] */
+	unsigned char *levels[kCCMipmapMaxLevels];
+} tMipmapChain;
+
+/** number of levels of a full chain, down to 1 x 1 */
+unsigned int ccMipmapLevelCount(unsigned int width, unsigned int height);
+
+/** Writes the next level of a width x height RGBA8888 image into dst, MAX(width / 2, 1) x MAX(height / 2, 1) pixels.
+	Straight alpha colors are weighted by their alpha, so the transparent pixels don't bleed into the visible ones.
+	The odd last row or column is folded into the previous one.
+*/
+void ccMipmapDownsample(ccMipmapFilter filter, const unsigned char *src, unsigned int width, unsigned int height, bool premultipliedAlpha, unsigned char *dst);
+
+/** Sets the top level of psChain from an image of 3 (RGB888) or 4 (RGBA8888) bytes per pixel.
+	The level is levelWidth x levelHeight, the image is copied to its top left corner and the rest is transparent.
+	The other levels are left empty, see ccMipmapChainGenerate and ccMipmapChainRead.
+*/
+bool ccMipmapChainInit(tMipmapChain *psChain, const unsigned char *pixels, unsigned int bytesPerPixel, unsigned int width, unsigned int height, unsigned int levelWidth, unsigned int levelHeight, bool premultipliedAlpha);
+
+/** builds all the levels below the top one */
+void ccMipmapChainGenerate(tMipmapChain *psChain, ccMipmapFilter filter);
+
+/** deletes the levels */
+void ccMipmapChainDestroy(tMipmapChain *psChain);
+
+/** Writes the levels below the top one to a file. The top level is the image the
+	file is generated from, it is hashed into the header instead of being stored.
+*/
+bool ccMipmapChainWrite(const tMipmapChain *psChain, ccMipmapFilter filter, const char *path);
+
+/** Reads the levels ccMipmapChainWrite saved for the same top level and filter.
+	@return false if the file is missing, truncated or was generated from another image
+*/
+bool ccMipmapChainRead(tMipmapChain *psChain, ccMipmapFilter filter, const char *path);
+
+}//namespace   cocos2d 
+
+#endif // __SUPPORT_IMAGE_SUPPORT_CCMIPMAP_H__
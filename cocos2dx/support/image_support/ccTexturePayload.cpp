@@ -0,0 +1,463 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "ccTexturePayload.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace   cocos2d {
+
+/*
+	Layout of a payload file, all the fields are 32 bits little endian:
+
+		4 bytes		"CCTP"
+		version		kFileVersion
+		key			ccTexturePayloadKey
+		pixelFormat
+		width
+		height
+		contentWidth
+		contentHeight
+		premultipliedAlpha
+		levelCount
+		compressed	1 when the levels are deflated
+		storedBytes	bytes after the header
+		levelBytes	kCCMipmapMaxLevels of them, 0 past levelCount
+	padded with zeros to kFileHeaderBytes, so that the levels of a mapped
+	file stay aligned, then the levels without padding, or their zlib stream.
+*/
+
+#define kFileVersion		1
+#define kFileHeaderBytes	128
+#define kFileFieldCount		12
+
+static inline unsigned int readUInt32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static inline void writeUInt32(unsigned char *p, unsigned int v)
+{
+	p[0] = (unsigned char)(v & 0xFF);
+	p[1] = (unsigned char)((v >> 8) & 0xFF);
+	p[2] = (unsigned char)((v >> 16) & 0xFF);
+	p[3] = (unsigned char)((v >> 24) & 0xFF);
+}
+
+static inline unsigned int hashBytes(unsigned int hash, const void *data, unsigned int length)
+{
+	const unsigned char *p = (const unsigned char*)data;
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		hash = (hash ^ p[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// file mapping
+//////////////////////////////////////////////////////////////////////////
+
+// read only view of a whole file, NULL when it can't be mapped
+static unsigned char* mapFile(const char *path, unsigned int *pBytes)
+{
+	unsigned char *view = NULL;
+
+#if defined(_WIN32)
+	wchar_t wszPath[MAX_PATH];
+	if (MultiByteToWideChar(CP_UTF8, 0, path, -1, wszPath, MAX_PATH) == 0)
+	{
+		return NULL;
+	}
+
+	HANDLE hFile = CreateFile2(wszPath, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+
+	FILE_STANDARD_INFO info;
+	if (GetFileInformationByHandleEx(hFile, FileStandardInfo, &info, sizeof(info)) && info.EndOfFile.QuadPart > 0 && info.EndOfFile.HighPart == 0)
+	{
+		HANDLE hMapping = CreateFileMappingFromApp(hFile, NULL, PAGE_READONLY, 0, NULL);
+		if (hMapping)
+		{
+			// the view keeps the mapping alive
+			view = (unsigned char*)MapViewOfFileFromApp(hMapping, FILE_MAP_READ, 0, 0);
+			CloseHandle(hMapping);
+			*pBytes = info.EndOfFile.LowPart;
+		}
+	}
+
+	CloseHandle(hFile);
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0 && (unsigned long long)info.st_size <= 0xFFFFFFFFull)
+	{
+		void *p = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED)
+		{
+			view = (unsigned char*)p;
+			*pBytes = (unsigned int)info.st_size;
+		}
+	}
+
+	close(fd);
+#endif
+
+	return view;
+}
+
+static void unmapFile(unsigned char *view, unsigned int bytes)
+{
+#if defined(_WIN32)
+	(void)bytes;
+	UnmapViewOfFile(view);
+#else
+	munmap(view, bytes);
+#endif
+}
+
+// the whole file in a new[] buffer, when it can't be mapped
+static unsigned char* readFile(const char *path, unsigned int *pBytes)
+{
+	FILE *fp = fopen(path, "rb");
+	if (! fp)
+	{
+		return NULL;
+	}
+
+	unsigned char *data = NULL;
+	long size = (fseek(fp, 0, SEEK_END) == 0) ? ftell(fp) : -1;
+	if (size > 0 && fseek(fp, 0, SEEK_SET) == 0)
+	{
+		data = new unsigned char[size];
+		if (fread(data, size, 1, fp) == 1)
+		{
+			*pBytes = (unsigned int)size;
+		}
+		else
+		{
+			delete [] data;
+			data = NULL;
+		}
+	}
+
+	fclose(fp);
+	return data;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// payload
+//////////////////////////////////////////////////////////////////////////
+
+void ccTexturePayloadInit(tTexturePayload *psPayload)
+{
+	memset(psPayload, 0, sizeof(tTexturePayload));
+}
+
+void ccTexturePayloadDestroy(tTexturePayload *psPayload)
+{
+	for (unsigned int i = 0; i < kCCMipmapMaxLevels; ++i)
+	{
+		if (psPayload->ownedLevels & (1u << i))
+		{
+			delete [] psPayload->levels[i];
+		}
+	}
+
+	if (psPayload->mapped)
+	{
+		unmapFile(psPayload->storage, psPayload->storageBytes);
+	}
+	else
+	{
+		delete [] psPayload->storage;
+	}
+
+	ccTexturePayloadInit(psPayload);
+}
+
+unsigned int ccTexturePayloadKey(const char *sourcePath, unsigned int settings)
+{
+	struct stat info;
+	if (stat(sourcePath, &info) != 0)
+	{
+		return 0;
+	}
+
+	// FNV-1a, the file isn't read: checking its content would cost about as much as decoding it
+	unsigned long long size = (unsigned long long)info.st_size;
+	long long mtime = (long long)info.st_mtime;
+	unsigned int hash = hashBytes(2166136261u, sourcePath, (unsigned int)strlen(sourcePath));
+	hash = hashBytes(hash, &size, sizeof(size));
+	hash = hashBytes(hash, &mtime, sizeof(mtime));
+	hash = hashBytes(hash, &settings, sizeof(settings));
+
+	// 0 stands for no key
+	return hash ? hash : 1;
+}
+
+// deflates the levels to fp, returns the number of bytes written or 0
+static unsigned int deflateLevels(const tTexturePayload *psPayload, FILE *fp)
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK)
+	{
+		return 0;
+	}
+
+	unsigned char buffer[16384];
+	unsigned int written = 0;
+	bool bRet = true;
+	for (unsigned int i = 0; bRet && i < psPayload->levelCount; ++i)
+	{
+		stream.next_in = psPayload->levels[i];
+		stream.avail_in = psPayload->levelBytes[i];
+		int flush = (i + 1 == psPayload->levelCount) ? Z_FINISH : Z_NO_FLUSH;
+
+		int status;
+		do
+		{
+			stream.next_out = buffer;
+			stream.avail_out = sizeof(buffer);
+			status = deflate(&stream, flush);
+
+			unsigned int count = (unsigned int)(sizeof(buffer) - stream.avail_out);
+			if (status == Z_STREAM_ERROR || (count > 0 && fwrite(buffer, count, 1, fp) != 1))
+			{
+				bRet = false;
+				break;
+			}
+			written += count;
+		} while (stream.avail_out == 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+	}
+
+	deflateEnd(&stream);
+	return bRet ? written : 0;
+}
+
+bool ccTexturePayloadWrite(const tTexturePayload *psPayload, unsigned int key, bool bCompress, const char *path)
+{
+	if (psPayload->levelCount == 0 || psPayload->levelCount > kCCMipmapMaxLevels || key == 0)
+	{
+		return false;
+	}
+
+	FILE *fp = fopen(path, "wb");
+	if (! fp)
+	{
+		return false;
+	}
+
+	unsigned int fields[kFileFieldCount] = { 0, kFileVersion, key, psPayload->pixelFormat, psPayload->width, psPayload->height,
+		psPayload->contentWidth, psPayload->contentHeight, psPayload->premultipliedAlpha ? 1u : 0u, psPayload->levelCount, bCompress ? 1u : 0u, 0 };
+
+	unsigned int totalBytes = 0;
+	for (unsigned int i = 0; i < psPayload->levelCount; ++i)
+	{
+		totalBytes += psPayload->levelBytes[i];
+	}
+
+	unsigned char header[kFileHeaderBytes];
+	memset(header, 0, kFileHeaderBytes);
+
+	// the header is written again once the size of the zlib stream is known
+	bool bRet = fwrite(header, kFileHeaderBytes, 1, fp) == 1;
+	if (bRet && bCompress)
+	{
+		fields[11] = deflateLevels(psPayload, fp);
+		bRet = fields[11] > 0;
+	}
+	else
+	{
+		for (unsigned int i = 0; bRet && i < psPayload->levelCount; ++i)
+		{
+			bRet = fwrite(psPayload->levels[i], psPayload->levelBytes[i], 1, fp) == 1;
+		}
+		fields[11] = totalBytes;
+	}
+
+	if (bRet)
+	{
+		memcpy(header, "CCTP", 4);
+		for (unsigned int i = 1; i < kFileFieldCount; ++i)
+		{
+			writeUInt32(header + i * 4, fields[i]);
+		}
+		for (unsigned int i = 0; i < psPayload->levelCount; ++i)
+		{
+			writeUInt32(header + (kFileFieldCount + i) * 4, psPayload->levelBytes[i]);
+		}
+
+		bRet = fseek(fp, 0, SEEK_SET) == 0 && fwrite(header, kFileHeaderBytes, 1, fp) == 1;
+	}
+
+	bRet = fclose(fp) == 0 && bRet;
+	if (! bRet)
+	{
+		// don't leave a truncated file behind
+		remove(path);
+	}
+
+	return bRet;
+}
+
+bool ccTexturePayloadRead(tTexturePayload *psPayload, unsigned int key, const char *path)
+{
+	if (key == 0)
+	{
+		return false;
+	}
+
+	unsigned int fileBytes = 0;
+	bool bMapped = true;
+	unsigned char *file = mapFile(path, &fileBytes);
+	if (! file)
+	{
+		bMapped = false;
+		file = readFile(path, &fileBytes);
+	}
+
+	if (! file)
+	{
+		return false;
+	}
+
+	bool bRet = false;
+	unsigned char *storage = NULL;
+	do 
+	{
+		if (fileBytes < kFileHeaderBytes || memcmp(file, "CCTP", 4) != 0 || readUInt32(file + 4) != kFileVersion || readUInt32(file + 8) != key)
+		{
+			break;
+		}
+
+		unsigned int levelCount = readUInt32(file + 36);
+		unsigned int storedBytes = readUInt32(file + 44);
+		if (levelCount == 0 || levelCount > kCCMipmapMaxLevels || storedBytes != fileBytes - kFileHeaderBytes)
+		{
+			break;
+		}
+
+		unsigned int levelBytes[kCCMipmapMaxLevels];
+		unsigned long long totalBytes = 0;
+		for (unsigned int i = 0; i < levelCount; ++i)
+		{
+			levelBytes[i] = readUInt32(file + (kFileFieldCount + i) * 4);
+			totalBytes += levelBytes[i];
+		}
+
+		const unsigned char *levels = file + kFileHeaderBytes;
+		if (readUInt32(file + 40) != 0)
+		{
+			// inflated in a buffer of their own, the file isn't needed afterwards
+			if (totalBytes == 0 || totalBytes > 0xFFFFFFFFull)
+			{
+				break;
+			}
+
+			storage = new unsigned char[(size_t)totalBytes];
+			uLongf length = (uLongf)totalBytes;
+			if (uncompress(storage, &length, levels, storedBytes) != Z_OK || length != totalBytes)
+			{
+				break;
+			}
+			levels = storage;
+		}
+		else if (totalBytes != storedBytes)
+		{
+			break;
+		}
+
+		ccTexturePayloadDestroy(psPayload);
+		psPayload->pixelFormat = readUInt32(file + 12);
+		psPayload->width = readUInt32(file + 16);
+		psPayload->height = readUInt32(file + 20);
+		psPayload->contentWidth = readUInt32(file + 24);
+		psPayload->contentHeight = readUInt32(file + 28);
+		psPayload->premultipliedAlpha = readUInt32(file + 32) != 0;
+		psPayload->levelCount = levelCount;
+		for (unsigned int i = 0; i < levelCount; ++i)
+		{
+			psPayload->levels[i] = (unsigned char*)levels;
+			psPayload->levelBytes[i] = levelBytes[i];
+			levels += levelBytes[i];
+		}
+
+		if (storage)
+		{
+			psPayload->storage = storage;
+			psPayload->storageBytes = (unsigned int)totalBytes;
+			storage = NULL;
+		}
+		else
+		{
+			// the levels point into the file
+			psPayload->storage = file;
+			psPayload->storageBytes = fileBytes;
+			psPayload->mapped = bMapped;
+			file = NULL;
+		}
+
+		bRet = true;
+	} while (0);
+
+	delete [] storage;
+	if (file)
+	{
+		if (bMapped)
+		{
+			unmapFile(file, fileBytes);
+		}
+		else
+		{
+			delete [] file;
+		}
+	}
+
+	return bRet;
+}
+
+}//namespace   cocos2d
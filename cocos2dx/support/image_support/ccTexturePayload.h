@@ -0,0 +1,89 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __SUPPORT_IMAGE_SUPPORT_CCTEXTUREPAYLOAD_H__
+#define __SUPPORT_IMAGE_SUPPORT_CCTEXTUREPAYLOAD_H__
+
+#include "ccMipmap.h"
+
+/*
+	Texture levels already converted to the pixel format they are uploaded in,
+	and the files CCTextureCache keeps them in so that the next launches skip
+	the PNG and JPEG decoding.
+
+	Besides the C runtime it only depends on zlib and on the file mapping of
+	the platform.
+*/
+
+namespace   cocos2d {
+
+/** levels of a texture, ready for CCTexture2D::initWithMipmaps() */
+typedef struct sTexturePayload {
+	/** CCTexture2DPixelFormat of the levels */
+	unsigned int pixelFormat;
+	/** size of the top level */
+	unsigned int width;
+	unsigned int height;
+	/** size of the image, smaller than the top level when it was padded to powers of 2 */
+	unsigned int contentWidth;
+	unsigned int contentHeight;
+	bool premultipliedAlpha;
+	unsigned int levelCount;
+	unsigned char *levels[kCCMipmapMaxLevels];
+	unsigned int levelBytes[kCCMipmapMaxLevels];
+	/** bit i is set when levels[i] was allocated with new[] for the payload, the others belong to storage or to someone else */
+	unsigned int ownedLevels;
+	/** what ccTexturePayloadRead loaded the file in, NULL otherwise */
+	unsigned char *storage;
+	unsigned int storageBytes;
+	/** true when storage is a read only view of the file */
+	bool mapped;
+} tTexturePayload;
+
+/** empty payload */
+void ccTexturePayloadInit(tTexturePayload *psPayload);
+
+/** releases the owned levels and the storage, and empties the payload */
+void ccTexturePayloadDestroy(tTexturePayload *psPayload);
+
+/** Key of the payload converted from a source file: hash of its path, size and modification time, and of settings,
+	which stands for whatever else changes the conversion.
+	@return 0 when the source can't be found
+*/
+unsigned int ccTexturePayloadKey(const char *sourcePath, unsigned int settings);
+
+/** Writes the levels to a file, deflated at the fastest level when bCompress is true.
+	Uncompressed files are bigger but are mapped instead of being read.
+*/
+bool ccTexturePayloadWrite(const tTexturePayload *psPayload, unsigned int key, bool bCompress, const char *path);
+
+/** Loads a file ccTexturePayloadWrite saved with the same key. The levels of an uncompressed file point into a
+	read only mapping of it, which lasts until ccTexturePayloadDestroy.
+	@return false if the file is missing, truncated or has another key
+*/
+bool ccTexturePayloadRead(tTexturePayload *psPayload, unsigned int key, const char *path);
+
+}//namespace   cocos2d 
+
+#endif // __SUPPORT_IMAGE_SUPPORT_CCTEXTUREPAYLOAD_H__
@@ -0,0 +1,576 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCDynamicAtlas.h"
+#include "CCSpriteFrame.h"
+#include "CCSpriteFrameCache.h"
+#include "CCTextureCache.h"
+#include "CCFileUtils.h"
+#include "CCImage.h"
+#include "CCDirector.h"
+#include "CCConfiguration.h"
+#include "ccMacros.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string.h>
+
+namespace cocos2d {
+
+#define kDefaultPageSize		1024
+#define kDefaultMaxPages		4
+#define kDefaultMaxImageSize	256
+// pixels around each image repeating its edges
+#define kGutter					1
+
+static CCDynamicAtlas *g_sharedDynamicAtlas = NULL;
+
+// Copies an RGB or RGBA image to an RGBA slot with a gutter, premultiplying the alpha if needed
+static unsigned char* slotPixelsForImage(CCImage *pImage)
+{
+	unsigned int w = pImage->getWidth();
+	unsigned int h = pImage->getHeight();
+	unsigned int bpp = pImage->hasAlpha() ? 4 : 3;
+	bool bPremultiply = pImage->hasAlpha() && ! pImage->isPremultipliedAlpha();
+	unsigned int slotWidth = w + 2 * kGutter;
+	unsigned int slotHeight = h + 2 * kGutter;
+
+	unsigned char *pSlot = new unsigned char[slotWidth * slotHeight * 4];
+	const unsigned char *pSrc = pImage->getData();
+	for (unsigned int y = 0; y < h; ++y)
+	{
+		unsigned char *pDst = pSlot + ((y + kGutter) * slotWidth + kGutter) * 4;
+		for (unsigned int x = 0; x < w; ++x, pSrc += bpp, pDst += 4)
+		{
+			unsigned int a = bpp == 4 ? pSrc[3] : 255;
+			if (bPremultiply)
+			{
+				pDst[0] = (unsigned char)((pSrc[0] * a + 127) / 255);
+				pDst[1] = (unsigned char)((pSrc[1] * a + 127) / 255);
+				pDst[2] = (unsigned char)((pSrc[2] * a + 127) / 255);
+			}
+			else
+			{
+				pDst[0] = pSrc[0];
+				pDst[1] = pSrc[1];
+				pDst[2] = pSrc[2];
+			}
+			pDst[3] = (unsigned char)a;
+		}
+	}
+
+	// the gutter repeats the edges, the corners included
+	for (unsigned int y = kGutter; y < kGutter + h; ++y)
+	{
+		unsigned int *pRow = (unsigned int*)(pSlot + y * slotWidth * 4);
+		for (unsigned int x = 0; x < kGutter; ++x)
+		{
+			pRow[x] = pRow[kGutter];
+			pRow[slotWidth - 1 - x] = pRow[kGutter + w - 1];
+		}
+	}
+	for (unsigned int y = 0; y < kGutter; ++y)
+	{
+		memcpy(pSlot + y * slotWidth * 4, pSlot + kGutter * slotWidth * 4, slotWidth * 4);
+		memcpy(pSlot + (slotHeight - 1 - y) * slotWidth * 4, pSlot + (kGutter + h - 1) * slotWidth * 4, slotWidth * 4);
+	}
+
+	return pSlot;
+}
+
+static CCTexture2D* createPageTexture(unsigned int uSize)
+{
+	unsigned char *pZeros = (unsigned char*)calloc(uSize * uSize * 4, 1);
+	if (! pZeros)
+	{
+		return NULL;
+	}
+
+	CCTexture2D *pTexture = new CCTexture2D();
+	bool bRet = pTexture->initWithData(pZeros, kCCTexture2DPixelFormat_RGBA8888, uSize, uSize, CCSizeMake((float)uSize, (float)uSize));
+	free(pZeros);
+	if (! bRet)
+	{
+		pTexture->release();
+		return NULL;
+	}
+
+	pTexture->setHasPremultipliedAlpha(true);
+	return pTexture;
+}
+
+CCDynamicAtlas* CCDynamicAtlas::sharedDynamicAtlas(void)
+{
+	if (! g_sharedDynamicAtlas)
+	{
+		g_sharedDynamicAtlas = new CCDynamicAtlas();
+	}
+	return g_sharedDynamicAtlas;
+}
+
+void CCDynamicAtlas::purgeSharedDynamicAtlas(void)
+{
+	CC_SAFE_RELEASE_NULL(g_sharedDynamicAtlas);
+}
+
+CCDynamicAtlas::CCDynamicAtlas()
+: m_uPageSize(kDefaultPageSize)
+, m_uMaxPages(kDefaultMaxPages)
+, m_uMaxImageSize(kDefaultMaxImageSize)
+, m_uClock(0)
+{
+	memset(&m_tStats, 0, sizeof(m_tStats));
+}
+
+CCDynamicAtlas::~CCDynamicAtlas()
+{
+	CCLOGINFO("cocos2d: deallocing CCDynamicAtlas.");
+	removeAllImages();
+}
+
+void CCDynamicAtlas::setPageSize(unsigned int uPageSize)
+{
+	unsigned int maxTextureSize = CCConfiguration::sharedConfiguration()->getMaxTextureSize();
+	m_uPageSize = MIN(MAX(uPageSize, 64), maxTextureSize);
+}
+
+CCSpriteFrame* CCDynamicAtlas::addImage(const char *path)
+{
+	CCAssert(path != NULL, "CCDynamicAtlas: path MUST not be NULL");
+
+	// same key as CCTextureCache, so that both find the -hd images
+	std::string key = path;
+	CCFileUtils::removeSuffixFromFile(key);
+	key = CCFileUtils::fullPathFromRelativePath(key.c_str());
+
+	++m_uClock;
+	EntryMap::iterator it = m_entries.find(key);
+	if (it != m_entries.end())
+	{
+		if (it->second.pPage)
+		{
+			it->second.pPage->uLastUsed = m_uClock;
+		}
+		return it->second.pFrame;
+	}
+
+	std::string lowerCase(path);
+	for (unsigned int i = 0; i < lowerCase.length(); ++i)
+	{
+		lowerCase[i] = tolower(lowerCase[i]);
+	}
+
+	// the compressed textures can't be copied to a page
+	if (std::string::npos != lowerCase.find(".pvr") || std::string::npos != lowerCase.find(".dds"))
+	{
+		return addFallback(key, path, NULL);
+	}
+
+	CCImage image;
+	CCFileData data(key.c_str(), "rb");
+	unsigned long nSize = data.getSize();
+	unsigned char *pBuffer = data.getBuffer();
+	bool bJpg = std::string::npos != lowerCase.find(".jpg") || std::string::npos != lowerCase.find(".jpeg");
+	if (! pBuffer || ! image.initWithImageData((void*)pBuffer, nSize, bJpg ? CCImage::kFmtJpg : CCImage::kFmtPng))
+	{
+		CCLOG("cocos2d: CCDynamicAtlas: couldn't load %s", path);
+		return NULL;
+	}
+
+	unsigned int w = image.getWidth();
+	unsigned int h = image.getHeight();
+	Page *pPage = NULL;
+	unsigned int x = 0;
+	unsigned int y = 0;
+	if (w <= m_uMaxImageSize && h <= m_uMaxImageSize && w + 2 * kGutter <= m_uPageSize && h + 2 * kGutter <= m_uPageSize)
+	{
+		pPage = allocate(w + 2 * kGutter, h + 2 * kGutter, x, y);
+	}
+	if (! pPage)
+	{
+		return addFallback(key, path, &image);
+	}
+
+	unsigned char *pSlot = slotPixelsForImage(&image);
+	pPage->pTexture->updateWithData(pSlot, x, y, w + 2 * kGutter, h + 2 * kGutter);
+	delete [] pSlot;
+
+	Entry &entry = m_entries[key];
+	entry.pFrame = NULL;
+	entry.pPage = pPage;
+	entry.x = x;
+	entry.y = y;
+	entry.w = w + 2 * kGutter;
+	entry.h = h + 2 * kGutter;
+	entry.name = path;
+	setEntryFrame(entry);
+
+	pPage->uImages++;
+	pPage->uLastUsed = m_uClock;
+	return entry.pFrame;
+}
+
+CCSpriteFrame* CCDynamicAtlas::addFallback(const std::string& key, const char *path, CCImage *pImage)
+{
+	CCTextureCache *pCache = CCTextureCache::sharedTextureCache();
+	CCTexture2D *pTexture = pImage ? pCache->addUIImage(pImage, key.c_str()) : pCache->addImage(path);
+	if (! pTexture)
+	{
+		return NULL;
+	}
+
+	CCSize size = pTexture->getContentSize();
+	Entry &entry = m_entries[key];
+	entry.pFrame = CCSpriteFrame::frameWithTexture(pTexture, CCRectMake(0, 0, size.width, size.height));
+	entry.pFrame->retain();
+	entry.pPage = NULL;
+	entry.x = entry.y = entry.w = entry.h = 0;
+	entry.name = path;
+	CCSpriteFrameCache::sharedSpriteFrameCache()->addSpriteFrame(entry.pFrame, path);
+	return entry.pFrame;
+}
+
+void CCDynamicAtlas::setEntryFrame(Entry &entry)
+{
+	CCRect rect = CC_RECT_PIXELS_TO_POINTS(CCRectMake((float)(entry.x + kGutter), (float)(entry.y + kGutter), (float)(entry.w - 2 * kGutter), (float)(entry.h - 2 * kGutter)));
+	if (entry.pFrame)
+	{
+		// a repack moves the images, the frames already handed out follow them
+		entry.pFrame->setTexture(entry.pPage->pTexture);
+		entry.pFrame->setRect(rect);
+		return;
+	}
+
+	entry.pFrame = CCSpriteFrame::frameWithTexture(entry.pPage->pTexture, rect);
+	entry.pFrame->retain();
+	CCSpriteFrameCache::sharedSpriteFrameCache()->addSpriteFrame(entry.pFrame, entry.name.c_str());
+}
+
+void CCDynamicAtlas::releaseEntry(Entry &entry)
+{
+	// the frame cache may have another frame under that name by now
+	CCSpriteFrameCache *pFrameCache = CCSpriteFrameCache::sharedSpriteFrameCache();
+	if (pFrameCache->spriteFrameByName(entry.name.c_str()) == entry.pFrame)
+	{
+		pFrameCache->removeSpriteFrameByName(entry.name.c_str());
+	}
+	CC_SAFE_RELEASE_NULL(entry.pFrame);
+}
+
+CCDynamicAtlas::Page* CCDynamicAtlas::createPage(void)
+{
+	CCTexture2D *pTexture = createPageTexture(m_uPageSize);
+	if (! pTexture)
+	{
+		return NULL;
+	}
+
+	Page *pPage = new Page();
+	pPage->pTexture = pTexture;
+	pPage->packer.init(m_uPageSize, m_uPageSize);
+	pPage->uImages = 0;
+	pPage->uLastUsed = m_uClock;
+	pPage->bHoles = false;
+	m_pages.push_back(pPage);
+	return pPage;
+}
+
+void CCDynamicAtlas::releasePage(Page *pPage)
+{
+	EntryMap::iterator it = m_entries.begin();
+	while (it != m_entries.end())
+	{
+		if (it->second.pPage == pPage)
+		{
+			releaseEntry(it->second);
+			m_entries.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	m_pages.erase(std::find(m_pages.begin(), m_pages.end(), pPage));
+	pPage->pTexture->release();
+	delete pPage;
+}
+
+bool CCDynamicAtlas::isPageUnused(Page *pPage)
+{
+	// the atlas and the frames of the images retain the texture, the sprites too
+	return pPage->pTexture->retainCount() <= 1 + pPage->uImages;
+}
+
+CCDynamicAtlas::Page* CCDynamicAtlas::allocate(unsigned int w, unsigned int h, unsigned int &x, unsigned int &y)
+{
+	// the most recently created pages are the emptiest
+	for (int i = (int)m_pages.size() - 1; i >= 0; --i)
+	{
+		if (m_pages[i]->packer.insert(w, h, x, y))
+		{
+			return m_pages[i];
+		}
+	}
+
+	Page *pPage = NULL;
+	if (m_pages.size() < m_uMaxPages)
+	{
+		pPage = createPage();
+	}
+
+	// packing again the page with the most free space, if removeImage() left holes in it
+	if (! pPage)
+	{
+		Page *pBest = NULL;
+		unsigned int uBestFree = w * h;
+		for (unsigned int i = 0; i < m_pages.size(); ++i)
+		{
+			CCMaxRectsPacker &packer = m_pages[i]->packer;
+			unsigned int uFree = packer.getWidth() * packer.getHeight() - packer.getUsedArea();
+			if (m_pages[i]->bHoles && uFree >= uBestFree)
+			{
+				pBest = m_pages[i];
+				uBestFree = uFree;
+			}
+		}
+
+		if (pBest && repackPage(pBest) && pBest->packer.insert(w, h, x, y))
+		{
+			return pBest;
+		}
+	}
+
+	// then evicting the least recently used page no sprite shows
+	if (! pPage)
+	{
+		Page *pOldest = NULL;
+		for (unsigned int i = 0; i < m_pages.size(); ++i)
+		{
+			if ((! pOldest || m_pages[i]->uLastUsed < pOldest->uLastUsed) && isPageUnused(m_pages[i]))
+			{
+				pOldest = m_pages[i];
+			}
+		}
+
+		if (pOldest)
+		{
+			CCLOGINFO("cocos2d: CCDynamicAtlas: evicting a page of %u images", pOldest->uImages);
+			releasePage(pOldest);
+			m_tStats.uEvictions++;
+			pPage = createPage();
+		}
+	}
+
+	if (pPage && pPage->packer.insert(w, h, x, y))
+	{
+		return pPage;
+	}
+	return NULL;
+}
+
+static bool compareSpotHeight(const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b)
+{
+	return a.first > b.first;
+}
+
+bool CCDynamicAtlas::repackPage(Page *pPage)
+{
+	// the images of the page, tallest first: they pack tighter in that order
+	std::vector<Entry*> entries;
+	std::vector<std::pair<unsigned int, unsigned int> > order;
+	for (EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		if (it->second.pPage == pPage)
+		{
+			order.push_back(std::make_pair(it->second.h, (unsigned int)entries.size()));
+			entries.push_back(&it->second);
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), compareSpotHeight);
+
+	unsigned int uSize = pPage->pTexture->getPixelsWide();
+	CCMaxRectsPacker packer;
+	packer.init(uSize, uSize);
+	std::vector<unsigned int> spots(entries.size() * 2);
+	for (unsigned int i = 0; i < order.size(); ++i)
+	{
+		Entry *pEntry = entries[order[i].second];
+		if (! packer.insert(pEntry->w, pEntry->h, spots[order[i].second * 2], spots[order[i].second * 2 + 1]))
+		{
+			return false;
+		}
+	}
+
+	CCTexture2D *pTexture = createPageTexture(uSize);
+	if (! pTexture)
+	{
+		return false;
+	}
+
+	// the images are copied on the GPU, the sprites showing the old texture keep it
+	for (unsigned int i = 0; i < entries.size(); ++i)
+	{
+		Entry *pEntry = entries[i];
+		pTexture->copyRegion(pPage->pTexture, pEntry->x, pEntry->y, pEntry->w, pEntry->h, spots[i * 2], spots[i * 2 + 1]);
+		pEntry->x = spots[i * 2];
+		pEntry->y = spots[i * 2 + 1];
+	}
+
+	pPage->pTexture->release();
+	pPage->pTexture = pTexture;
+	pPage->packer = packer;
+	pPage->bHoles = false;
+
+	for (unsigned int i = 0; i < entries.size(); ++i)
+	{
+		setEntryFrame(*entries[i]);
+	}
+
+	m_tStats.uRepacks++;
+	return true;
+}
+
+void CCDynamicAtlas::removeImage(const char *path)
+{
+	std::string key = path;
+	CCFileUtils::removeSuffixFromFile(key);
+	key = CCFileUtils::fullPathFromRelativePath(key.c_str());
+
+	EntryMap::iterator it = m_entries.find(key);
+	if (it == m_entries.end())
+	{
+		return;
+	}
+
+	Entry &entry = it->second;
+	if (entry.pPage)
+	{
+		entry.pPage->packer.remove(entry.x, entry.y, entry.w, entry.h);
+		entry.pPage->uImages--;
+		entry.pPage->bHoles = true;
+	}
+	releaseEntry(entry);
+	m_entries.erase(it);
+}
+
+void CCDynamicAtlas::removeUnusedPages(void)
+{
+	for (int i = (int)m_pages.size() - 1; i >= 0; --i)
+	{
+		if (isPageUnused(m_pages[i]))
+		{
+			releasePage(m_pages[i]);
+		}
+	}
+}
+
+void CCDynamicAtlas::removeAllImages(void)
+{
+	for (EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		releaseEntry(it->second);
+	}
+	m_entries.clear();
+
+	while (! m_pages.empty())
+	{
+		releasePage(m_pages.back());
+	}
+}
+
+CCTexture2D* CCDynamicAtlas::pageForImage(const char *path)
+{
+	std::string key = path;
+	CCFileUtils::removeSuffixFromFile(key);
+	key = CCFileUtils::fullPathFromRelativePath(key.c_str());
+
+	EntryMap::iterator it = m_entries.find(key);
+	return it != m_entries.end() && it->second.pPage ? it->second.pPage->pTexture : NULL;
+}
+
+const ccDynamicAtlasStats& CCDynamicAtlas::getStats(void)
+{
+	m_tStats.uPages = m_pages.size();
+	m_tStats.uImages = 0;
+	m_tStats.uUsedArea = 0;
+	m_tStats.uPageArea = 0;
+	m_tStats.uPageBytes = 0;
+	m_tStats.uStandaloneBytes = 0;
+	m_tStats.uFallbacks = 0;
+
+	for (unsigned int i = 0; i < m_pages.size(); ++i)
+	{
+		CCMaxRectsPacker &packer = m_pages[i]->packer;
+		m_tStats.uUsedArea += packer.getUsedArea();
+		m_tStats.uPageArea += packer.getWidth() * packer.getHeight();
+		m_tStats.uPageBytes += m_pages[i]->pTexture->getMemorySize();
+	}
+
+	for (EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		if (it->second.pPage)
+		{
+			unsigned int w, h;
+			CCTexture2D::textureSizeForImageSize(it->second.w - 2 * kGutter, it->second.h - 2 * kGutter, &w, &h);
+			m_tStats.uStandaloneBytes += w * h * 4;
+			m_tStats.uImages++;
+		}
+		else
+		{
+			m_tStats.uFallbacks++;
+		}
+	}
+
+	m_tStats.fEfficiency = m_tStats.uPageArea > 0 ? (float)m_tStats.uUsedArea / (float)m_tStats.uPageArea : 0.0f;
+	return m_tStats;
+}
+
+void CCDynamicAtlas::dumpStats(void)
+{
+	const ccDynamicAtlasStats& stats = getStats();
+	CCLOG("cocos2d: CCDynamicAtlas: %u pages, %u images, %.1f%% packed, %u KB of pages for %u KB of separate textures",
+		stats.uPages,
+		stats.uImages,
+		stats.fEfficiency * 100.0f,
+		stats.uPageBytes / 1024,
+		stats.uStandaloneBytes / 1024);
+	CCLOG("cocos2d: CCDynamicAtlas: %u fallbacks, %u repacks, %u evictions",
+		stats.uFallbacks,
+		stats.uRepacks,
+		stats.uEvictions);
+
+	for (unsigned int i = 0; i < m_pages.size(); ++i)
+	{
+		Page *pPage = m_pages[i];
+		CCLOG("cocos2d: \t%u x %u, %u images, %.1f%% packed%s",
+			pPage->packer.getWidth(),
+			pPage->packer.getHeight(),
+			pPage->uImages,
+			pPage->packer.getOccupancy() * 100.0f,
+			isPageUnused(pPage) ? ", unused" : "");
+	}
+}
+
+}//namespace cocos2d
@@ -42,12 +42,18 @@ THE SOFTWARE.
 #include "platform/CCPlatformMacros.h"
 #include "CCTexturePVR.h"
 #include "CCDirector.h"
+#include "CCFileUtils.h"
+#include "support/image_support/ccBCn.h"
+#include "support/image_support/ccMipmap.h"
+#include "support/image_support/ccTexturePayload.h"
+#include "support/zip_support/ZipUtils.h"
 
 #if CC_ENABLE_CACHE_TEXTTURE_DATA
     #include "CCTextureCache.h"
 #endif
 
 #include <fstream>
+#include <cctype>
 using namespace std;
 
 namespace   cocos2d {
@@ -65,19 +71,30 @@ static CCTexture2DPixelFormat g_defaultAlphaPixelFormat = kCCTexture2DPixelForma
 // By default PVR images are treated as if they don't have the alpha channel premultiplied
 static bool PVRHaveAlphaPremultiplied_ = false;
 
+// frame the textures drawn now are stamped with
+static unsigned int s_uCurrentFrame = 0;
+
 ID3D11ShaderResourceView* CCTexture2D::getTextureResource()
 {
+	m_uLastUsedFrame = s_uCurrentFrame;
 	return m_pTextureResource;
 }
 
+void CCTexture2D::setCurrentFrame(unsigned int uFrame)
+{
+	s_uCurrentFrame = uFrame;
+}
+
 CCTexture2D::CCTexture2D()
 : m_uPixelsWide(0)
 , m_uPixelsHigh(0)
+, m_uMipmapCount(0)
 , m_uName(0)
 , m_fMaxS(0.0)
 , m_fMaxT(0.0)
 , m_bHasPremultipliedAlpha(false)
 , m_bPVRHaveAlphaPremultiplied(true)
+, m_uLastUsedFrame(s_uCurrentFrame)
 {
 	m_pTextureResource=0;
 	m_sampleState = 0;
@@ -121,6 +138,11 @@ unsigned int CCTexture2D::getPixelsHigh()
 	return m_uPixelsHigh;
 }
 
+unsigned int CCTexture2D::getMipmapCount()
+{
+	return m_uMipmapCount;
+}
+
 CCuint CCTexture2D::getName()
 {
 	return m_uName;
@@ -187,91 +209,272 @@ bool CCTexture2D::getHasPremultipliedAlpha()
 	return m_bHasPremultipliedAlpha;
 }
 
-bool CCTexture2D::initWithData(const void *data, CCTexture2DPixelFormat pixelFormat, unsigned int pixelsWide, unsigned int pixelsHigh, const CCSize& contentSize)
+void CCTexture2D::setHasPremultipliedAlpha(bool var)
+{
+	m_bHasPremultipliedAlpha = var;
+}
+
+static ccBCnFormat bcnFormatForPixelFormat(CCTexture2DPixelFormat pixelFormat)
 {
-	int formatTmp = DXGI_FORMAT_R8G8B8A8_UNORM;
-	int dataSizeByte = 4;
-	/*==
-	glPixelStorei(CC_UNPACK_ALIGNMENT,1);
-	glGenTextures(1, &m_uName);
-	glBindTexture(CC_TEXTURE_2D, m_uName);
-	==*/
-	this->setAntiAliasTexParameters();
-	
-	// Specify OpenGL texture image
+	switch(pixelFormat)
+	{
+	case kCCTexture2DPixelFormat_BC1:
+		return kCCBCnFormat_BC1;
+	case kCCTexture2DPixelFormat_BC2:
+		return kCCBCnFormat_BC2;
+	case kCCTexture2DPixelFormat_BC3:
+		return kCCBCnFormat_BC3;
+	case kCCTexture2DPixelFormat_BC7:
+		return kCCBCnFormat_BC7;
+	default:
+		return kCCBCnFormat_Invalid;
+	}
+}
+
+// DXGI format of a pixel format, with the size of its pixels, or of its 4x4 blocks when it is block compressed
+static bool dxgiFormatForPixelFormat(CCTexture2DPixelFormat pixelFormat, DXGI_FORMAT *pFormat, unsigned int *pBytes, bool *pBlockCompressed)
+{
+	*pBlockCompressed = false;
+
 	switch(pixelFormat)
 	{
 	case kCCTexture2DPixelFormat_RGBA8888:
-		formatTmp = DXGI_FORMAT_R8G8B8A8_UNORM;
-		dataSizeByte = 4;
-		//info.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		*pFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+		*pBytes = 4;
 		//=glTexImage2D(CC_TEXTURE_2D, 0, CC_RGBA, (GLsizei)pixelsWide, (GLsizei)pixelsHigh, 0, CC_RGBA, CC_UNSIGNED_BYTE, data);
 		break;
 	case kCCTexture2DPixelFormat_RGB888:
-		dataSizeByte = 4;
-		formatTmp = DXGI_FORMAT_R8G8B8A8_UNORM;
-		//info.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		// expanded to 32 bits by payloadForImage
+		*pFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+		*pBytes = 4;
 		//=glTexImage2D(CC_TEXTURE_2D, 0, CC_RGB, (GLsizei)pixelsWide, (GLsizei)pixelsHigh, 0, CC_RGB, CC_UNSIGNED_BYTE, data);
 		break;
 	case kCCTexture2DPixelFormat_RGBA4444:
-		dataSizeByte = 4;
-		formatTmp = DXGI_FORMAT_R8G8B8A8_UNORM;
-		//info.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		*pFormat = DXGI_FORMAT_B4G4R4A4_UNORM;
+		*pBytes = 2;
 		//=glTexImage2D(CC_TEXTURE_2D, 0, CC_RGBA, (GLsizei)pixelsWide, (GLsizei)pixelsHigh, 0, CC_RGBA, CC_UNSIGNED_SHORT_4_4_4_4, data);
 		break;
 	case kCCTexture2DPixelFormat_RGB5A1:
-		dataSizeByte = 2;
-		formatTmp = DXGI_FORMAT_B5G5R5A1_UNORM;
-		//info.Format = DXGI_FORMAT_B5G5R5A1_UNORM;
+		*pFormat = DXGI_FORMAT_B5G5R5A1_UNORM;
+		*pBytes = 2;
 		//=glTexImage2D(CC_TEXTURE_2D, 0, CC_RGBA, (GLsizei)pixelsWide, (GLsizei)pixelsHigh, 0, CC_RGBA, CC_UNSIGNED_SHORT_5_5_5_1, data);
 		break;
 	case kCCTexture2DPixelFormat_RGB565:
-		dataSizeByte = 2;
-		formatTmp = DXGI_FORMAT_B5G6R5_UNORM;
-		//info.Format = DXGI_FORMAT_B5G6R5_UNORM;
+		*pFormat = DXGI_FORMAT_B5G6R5_UNORM;
+		*pBytes = 2;
 		//=glTexImage2D(CC_TEXTURE_2D, 0, CC_RGB, (GLsizei)pixelsWide, (GLsizei)pixelsHigh, 0, CC_RGB, CC_UNSIGNED_SHORT_5_6_5, data);
 		break;
 	case kCCTexture2DPixelFormat_AI88:
-		dataSizeByte = 2;
-		formatTmp = DXGI_FORMAT_R8G8_UNORM;
-		//info.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		*pFormat = DXGI_FORMAT_R8G8_UNORM;
+		*pBytes = 2;
 		//=glTexImage2D(CC_TEXTURE_2D, 0, CC_LUMINANCE_ALPHA, (GLsizei)pixelsWide, (GLsizei)pixelsHigh, 0, CC_LUMINANCE_ALPHA, CC_UNSIGNED_BYTE, data);
 		break;
 	case kCCTexture2DPixelFormat_A8:
-		dataSizeByte = 1;
-		formatTmp = DXGI_FORMAT_A8_UNORM;
-		//info.Format = DXGI_FORMAT_A8_UNORM;
+		*pFormat = DXGI_FORMAT_A8_UNORM;
+		*pBytes = 1;
 		//=glTexImage2D(CC_TEXTURE_2D, 0, CC_ALPHA, (GLsizei)pixelsWide, (GLsizei)pixelsHigh, 0, CC_ALPHA, CC_UNSIGNED_BYTE, data);
 		break;
+	case kCCTexture2DPixelFormat_BC1:
+	case kCCTexture2DPixelFormat_BC2:
+	case kCCTexture2DPixelFormat_BC3:
+	case kCCTexture2DPixelFormat_BC7:
+		*pFormat = (DXGI_FORMAT)bcnFormatForPixelFormat(pixelFormat);
+		*pBytes = ccBCnBlockBytes(bcnFormatForPixelFormat(pixelFormat));
+		*pBlockCompressed = true;
+		break;
 	default:
-		CCAssert(0, "NSInternalInconsistencyException");
+		return false;
+	}
+
+	return true;
+}
+
+// RGBA8888 copy of a level the device can't sample, NULL when there is no CPU decoder for the format
+static unsigned char* decodeLevel(const void *data, CCTexture2DPixelFormat pixelFormat, unsigned int width, unsigned int height)
+{
+	unsigned char *pixels = new unsigned char[width * height * 4];
+
+	if (pixelFormat == kCCTexture2DPixelFormat_RGBA4444)
+	{
+		// "AAAARRRRGGGGBBBB" to "RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA"
+		const unsigned short *inPixel16 = (const unsigned short*)data;
+		for (unsigned int i = 0; i < width * height; ++i, ++inPixel16)
+		{
+			pixels[i * 4 + 0] = (unsigned char)(((*inPixel16 >> 8) & 0xF) * 17);
+			pixels[i * 4 + 1] = (unsigned char)(((*inPixel16 >> 4) & 0xF) * 17);
+			pixels[i * 4 + 2] = (unsigned char)(((*inPixel16 >> 0) & 0xF) * 17);
+			pixels[i * 4 + 3] = (unsigned char)(((*inPixel16 >> 12) & 0xF) * 17);
+		}
+	}
+	else if (! ccBCnDecode(bcnFormatForPixelFormat(pixelFormat), (const unsigned char*)data, width, height, pixels))
+	{
+		CC_SAFE_DELETE_ARRAY(pixels);
+	}
+
+	return pixels;
+}
+
+// RGBA8888 pixels converted to a 16 bits format, NULL when the format keeps 32 bits
+static unsigned char* repackPixels(const unsigned char *data, unsigned int length, CCTexture2DPixelFormat pixelFormat)
+{
+	const unsigned int *inPixel32 = (const unsigned int*)data;
+	unsigned short *outPixel16 = NULL;
+	unsigned char *tempData = NULL;
+
+	if(pixelFormat == kCCTexture2DPixelFormat_RGB565) {
+		//Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRGGGGGGBBBBB"
+		tempData = new unsigned char[length * 2];
+		outPixel16 = (unsigned short*)tempData;
+
+		for(unsigned int i = 0; i < length; ++i, ++inPixel32)
+		{
+			*outPixel16++ = 
+				((((*inPixel32 >> 0) & 0xFF) >> 3) << 11) |  // R
+				((((*inPixel32 >> 8) & 0xFF) >> 2) << 5) |   // G
+				((((*inPixel32 >> 16) & 0xFF) >> 3) << 0);   // B
+		}
+	}
+	else if (pixelFormat == kCCTexture2DPixelFormat_RGBA4444) {
+		//Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "AAAARRRRGGGGBBBB", DXGI_FORMAT_B4G4R4A4_UNORM
+		tempData = new unsigned char[length * 2];
+		outPixel16 = (unsigned short*)tempData;
+
+		for(unsigned int i = 0; i < length; ++i, ++inPixel32)
+		{
+			*outPixel16++ = 
+			((((*inPixel32 >> 24) & 0xFF) >> 4) << 12) | // A
+			((((*inPixel32 >> 0) & 0xFF) >> 4) << 8) | // R
+			((((*inPixel32 >> 8) & 0xFF) >> 4) << 4) | // G
+			((((*inPixel32 >> 16) & 0xFF) >> 4) << 0); // B
+		}
+	}
+	else if (pixelFormat == kCCTexture2DPixelFormat_RGB5A1) {
+		//Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "ARRRRRGGGGGBBBBB", DXGI_FORMAT_B5G5R5A1_UNORM
+		tempData = new unsigned char[length * 2];
+		outPixel16 = (unsigned short*)tempData;
+
+		for(unsigned int i = 0; i < length; ++i, ++inPixel32)
+		{
+ 			*outPixel16++ = 
+			((((*inPixel32 >> 24) & 0xFF) >> 7) << 15) | // A
+			((((*inPixel32 >> 0) & 0xFF) >> 3) << 10) | // R
+			((((*inPixel32 >> 8) & 0xFF) >> 3) << 5) | // G
+			((((*inPixel32 >> 16) & 0xFF) >> 3) << 0); // B
+		}
+	}
+
+	return tempData;
+}
+
+bool CCTexture2D::initWithData(const void *data, CCTexture2DPixelFormat pixelFormat, unsigned int pixelsWide, unsigned int pixelsHigh, const CCSize& contentSize)
+{
+	return initWithMipmaps(&data, 1, pixelFormat, pixelsWide, pixelsHigh, contentSize);
+}
+
+bool CCTexture2D::initWithMipmaps(const void** levels, unsigned int levelCount, CCTexture2DPixelFormat pixelFormat, unsigned int pixelsWide, unsigned int pixelsHigh, const CCSize& contentSize)
+{
+	CCAssert(levelCount > 0 && levelCount <= D3D11_REQ_MIP_LEVELS, "CCTexture2D: invalid number of mip levels");
 
+	DXGI_FORMAT format;
+	unsigned int bytes;
+	bool bBlockCompressed;
+	/*==
+	glPixelStorei(CC_UNPACK_ALIGNMENT,1);
+	glGenTextures(1, &m_uName);
+	glBindTexture(CC_TEXTURE_2D, m_uName);
+	==*/
+	this->setAntiAliasTexParameters();
+
+	if (! dxgiFormatForPixelFormat(pixelFormat, &format, &bytes, &bBlockCompressed))
+	{
+		CCAssert(0, "NSInternalInconsistencyException");
+		return false;
 	}
+
 	ID3D11Device *pdevice = CCDirector::sharedDirector()->getOpenGLView()->GetDevice();
-	ID3D11Texture2D *tex;
-	D3D11_TEXTURE2D_DESC tdesc;
-	D3D11_SUBRESOURCE_DATA tbsd;
-	tbsd.pSysMem = data;
-	tbsd.SysMemPitch = pixelsWide*dataSizeByte;
-	tbsd.SysMemSlicePitch = pixelsWide*pixelsHigh*dataSizeByte; // Not needed since this is a 2d texture
+	UINT formatSupport = 0;
+	if (FAILED(pdevice->CheckFormatSupport(format, &formatSupport)))
+	{
+		formatSupport = 0;
+	}
 
+	// B4G4R4A4 needs DXGI 1.2, BC7 a feature level 11 device, and the block compressed textures
+	// must have whole blocks at the top level: decode what can't be sampled on the CPU
+	unsigned char *decodedLevels[D3D11_REQ_MIP_LEVELS] = { 0 };
+	if (! (formatSupport & D3D11_FORMAT_SUPPORT_TEXTURE2D) || (bBlockCompressed && ((pixelsWide & 3) || (pixelsHigh & 3))))
+	{
+		unsigned int width = pixelsWide;
+		unsigned int height = pixelsHigh;
+		for (unsigned int i = 0; i < levelCount; ++i)
+		{
+			decodedLevels[i] = decodeLevel(levels[i], pixelFormat, width, height);
+			if (! decodedLevels[i])
+			{
+				CCLOG("cocos2d: CCTexture2D: the device can't sample the pixel format %d", pixelFormat);
+				for (unsigned int j = 0; j < i; ++j)
+				{
+					CC_SAFE_DELETE_ARRAY(decodedLevels[j]);
+				}
+				return false;
+			}
+
+			width = MAX(width >> 1, 1);
+			height = MAX(height >> 1, 1);
+		}
+
+		CCLOG("cocos2d: CCTexture2D: pixel format %d decoded to RGBA8888", pixelFormat);
+		pixelFormat = kCCTexture2DPixelFormat_RGBA8888;
+		dxgiFormatForPixelFormat(pixelFormat, &format, &bytes, &bBlockCompressed);
+		formatSupport = D3D11_FORMAT_SUPPORT_TEXTURE2D | D3D11_FORMAT_SUPPORT_RENDER_TARGET;
+	}
+
+	D3D11_SUBRESOURCE_DATA tbsd[D3D11_REQ_MIP_LEVELS];
+	unsigned int width = pixelsWide;
+	unsigned int height = pixelsHigh;
+	for (unsigned int i = 0; i < levelCount; ++i)
+	{
+		// the pitch of a block compressed level is the size of a row of blocks
+		unsigned int rows = bBlockCompressed ? MAX((height + 3) / 4, 1) : height;
+		tbsd[i].pSysMem = decodedLevels[i] ? decodedLevels[i] : levels[i];
+		tbsd[i].SysMemPitch = (bBlockCompressed ? MAX((width + 3) / 4, 1) : width) * bytes;
+		tbsd[i].SysMemSlicePitch = tbsd[i].SysMemPitch * rows; // Not needed since this is a 2d texture
+
+		width = MAX(width >> 1, 1);
+		height = MAX(height >> 1, 1);
+	}
+
+	ID3D11Texture2D *tex = NULL;
+	D3D11_TEXTURE2D_DESC tdesc;
 	tdesc.Width = pixelsWide;
 	tdesc.Height = pixelsHigh;
-	tdesc.MipLevels = 1;
+	tdesc.MipLevels = levelCount;
 	tdesc.ArraySize = 1;
 
 	tdesc.SampleDesc.Count = 1;
 	tdesc.SampleDesc.Quality = 0;
 	tdesc.Usage = D3D11_USAGE_DEFAULT;
-	tdesc.Format = (DXGI_FORMAT)formatTmp;
-	tdesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	tdesc.Format = format;
+	// CCRenderTexture and CCGrabber draw into the textures, the compressed ones can't be rendered to
+	tdesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	if (formatSupport & D3D11_FORMAT_SUPPORT_RENDER_TARGET)
+	{
+		tdesc.BindFlags |= D3D11_BIND_RENDER_TARGET;
+	}
 
 	tdesc.CPUAccessFlags = 0;
 	tdesc.MiscFlags = 0;
-	
-	if(FAILED(pdevice->CreateTexture2D(&tdesc,&tbsd,&tex)))
+
+	HRESULT hr = pdevice->CreateTexture2D(&tdesc, tbsd, &tex);
+
+	for (unsigned int i = 0; i < levelCount; ++i)
 	{
-		// e_fail
+		CC_SAFE_DELETE_ARRAY(decodedLevels[i]);
+	}
+
+	if (FAILED(hr))
+	{
+		CCLOG("cocos2d: CCTexture2D: can't create a %u x %u texture of pixel format %d", pixelsWide, pixelsHigh, pixelFormat);
+		return false;
 	}
 
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
@@ -286,6 +489,13 @@ bool CCTexture2D::initWithData(const void *data, CCTexture2DPixelFormat pixelFor
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.MipLevels = desc.MipLevels;
 
+	// a reloaded texture drops its previous resource
+	if (m_pTextureResource)
+	{
+		m_pTextureResource->Release();
+		m_pTextureResource = 0;
+	}
+
 	// Create the shader resource view.
 	pdevice->CreateShaderResourceView( tex, &srvDesc, &m_pTextureResource );
 	m_uName = (CCuint)m_pTextureResource;
@@ -298,6 +508,7 @@ bool CCTexture2D::initWithData(const void *data, CCTexture2DPixelFormat pixelFor
 	m_tContentSize = contentSize;
 	m_uPixelsWide = pixelsWide;
 	m_uPixelsHigh = pixelsHigh;
+	m_uMipmapCount = levelCount;
 	m_ePixelFormat = pixelFormat;
 	m_fMaxS = contentSize.width / (float)(pixelsWide);
 	m_fMaxT = contentSize.height / (float)(pixelsHigh);
@@ -325,6 +536,11 @@ bool CCTexture2D::initWithImage(CCImage * uiImage)
 }
 
 bool CCTexture2D::initWithImage(CCImage * uiImage, ccResolutionType resolution)
+{
+	return initWithImage(uiImage, resolution, false);
+}
+
+bool CCTexture2D::initWithImage(CCImage *uiImage, ccResolutionType resolution, bool bMipmaps)
 {
 	unsigned int POTWide, POTHigh;
 
@@ -337,18 +553,7 @@ bool CCTexture2D::initWithImage(CCImage * uiImage, ccResolutionType resolution)
 
 	CCConfiguration *conf = CCConfiguration::sharedConfiguration();
 
-#if CC_TEXTURE_NPOT_SUPPORT
-	if( conf->isSupportsNPOT() ) 
-	{
-		POTWide = uiImage->getWidth();
-		POTHigh = uiImage->getHeight();
-	}
-	else 
-#endif
-	{
-		POTWide = ccNextPOT(uiImage->getWidth());
-		POTHigh = ccNextPOT(uiImage->getHeight());
-	}
+	textureSizeForImageSize(uiImage->getWidth(), uiImage->getHeight(), &POTWide, &POTHigh);
 
 	unsigned maxTextureSize = conf->getMaxTextureSize();
 	if( POTHigh > maxTextureSize || POTWide > maxTextureSize ) 
@@ -360,17 +565,54 @@ bool CCTexture2D::initWithImage(CCImage * uiImage, ccResolutionType resolution)
 
 	m_eResolutionType = resolution;
 
+	if (bMipmaps)
+	{
+		tMipmapChain chain;
+		if (! ccMipmapChainInit(&chain, uiImage->getData(), uiImage->hasAlpha() ? 4 : 3, uiImage->getWidth(), uiImage->getHeight(), POTWide, POTHigh, uiImage->isPremultipliedAlpha()))
+		{
+			CCLOG("cocos2d: CCTexture2D: can't build the mip chain of a %d bits per component image", uiImage->getBitsPerComponent());
+			return false;
+		}
+
+		ccMipmapChainGenerate(&chain, kCCMipmapFilter_Box);
+		bool bRet = initWithMipmapChain(&chain, uiImage->hasAlpha(), CCSizeMake((float)(uiImage->getWidth()), (float)(uiImage->getHeight())));
+		ccMipmapChainDestroy(&chain);
+		return bRet;
+	}
+
 	// always load premultiplied images
-	return initPremultipliedATextureWithImage(uiImage, POTWide, POTHigh);
+	tTexturePayload payload;
+	bool bRet = payloadForImage(uiImage, &payload) && initWithPayload(&payload);
+	ccTexturePayloadDestroy(&payload);
+	return bRet;
 }
-bool CCTexture2D::initPremultipliedATextureWithImage(CCImage *image, unsigned int POTWide, unsigned int POTHigh)
+
+void CCTexture2D::textureSizeForImageSize(unsigned int width, unsigned int height, unsigned int *pPixelsWide, unsigned int *pPixelsHigh)
 {
+#if CC_TEXTURE_NPOT_SUPPORT
+	if( CCConfiguration::sharedConfiguration()->isSupportsNPOT() ) 
+	{
+		*pPixelsWide = width;
+		*pPixelsHigh = height;
+	}
+	else 
+#endif
+	{
+		*pPixelsWide = ccNextPOT(width);
+		*pPixelsHigh = ccNextPOT(height);
+	}
+}
+
+bool CCTexture2D::payloadForImage(CCImage *image, struct sTexturePayload *pPayload)
+{
+	ccTexturePayloadInit(pPayload);
+
+	unsigned int POTWide, POTHigh;
+	textureSizeForImageSize(image->getWidth(), image->getHeight(), &POTWide, &POTHigh);
+
 	unsigned char*			data = NULL;
 	unsigned char*			tempData =NULL;
-	unsigned int*			inPixel32 = NULL;
-	unsigned short*			outPixel16 = NULL;
 	bool					hasAlpha;
-	CCSize					imageSize;
 	CCTexture2DPixelFormat	pixelFormat;
 
 	hasAlpha = image->hasAlpha();
@@ -396,8 +638,6 @@ bool CCTexture2D::initPremultipliedATextureWithImage(CCImage *image, unsigned in
 	}
 
 
-	imageSize = CCSizeMake((float)(image->getWidth()), (float)(image->getHeight()));
-
 	switch(pixelFormat) {          
 		case kCCTexture2DPixelFormat_RGBA8888:
 		case kCCTexture2DPixelFormat_RGBA4444:
@@ -471,62 +711,13 @@ bool CCTexture2D::initPremultipliedATextureWithImage(CCImage *image, unsigned in
 	}
 
 	// Repack the pixel data into the right format
-
-	if(pixelFormat == kCCTexture2DPixelFormat_RGB565) {
-		//Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRGGGGGGBBBBB"
-		tempData = new unsigned char[POTHigh * POTWide * 2];
-		inPixel32 = (unsigned int*)data;
-		outPixel16 = (unsigned short*)tempData;
-
-		unsigned int length = POTWide * POTHigh;
-		for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-		{
-			*outPixel16++ = 
-				((((*inPixel32 >> 0) & 0xFF) >> 3) << 11) |  // R
-				((((*inPixel32 >> 8) & 0xFF) >> 2) << 5) |   // G
-				((((*inPixel32 >> 16) & 0xFF) >> 3) << 0);   // B
-		}
-
-		delete [] data;
-		data = tempData;
-	}
-	else if (pixelFormat == kCCTexture2DPixelFormat_RGBA4444) {
-		//Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRGGGGBBBBAAAA"
-		tempData = new unsigned char[POTHigh * POTWide * 2];
-		inPixel32 = (unsigned int*)data;
-		outPixel16 = (unsigned short*)tempData;
-
-		unsigned int length = POTWide * POTHigh;
-		for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-		{
-			*outPixel16++ = 
-			((((*inPixel32 >> 0) & 0xFF) >> 4) << 12) | // R
-			((((*inPixel32 >> 8) & 0xFF) >> 4) << 8) | // G
-			((((*inPixel32 >> 16) & 0xFF) >> 4) << 4) | // B
-			((((*inPixel32 >> 24) & 0xFF) >> 4) << 0); // A
-		}
-
+	unsigned int bytesPerPixel = 4;
+	tempData = repackPixels(data, POTWide * POTHigh, pixelFormat);
+	if (tempData)
+	{
 		delete [] data;
 		data = tempData;
-	}
-	else if (pixelFormat == kCCTexture2DPixelFormat_RGB5A1) {
-		//Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRGGGGGBBBBBA"
-		tempData = new unsigned char[POTHigh * POTWide * 2];
-		inPixel32 = (unsigned int*)data;
-		outPixel16 = (unsigned short*)tempData;
-
-		unsigned int length = POTWide * POTHigh;
-		for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-		{
- 			*outPixel16++ = 
-			((((*inPixel32 >> 0) & 0xFF) >> 3) << 11) | // R
-			((((*inPixel32 >> 8) & 0xFF) >> 3) << 6) | // G
-			((((*inPixel32 >> 16) & 0xFF) >> 3) << 1) | // B
-			((((*inPixel32 >> 24) & 0xFF) >> 7) << 0); // A
-		}
-
-		delete []data;
-		data = tempData;
+		bytesPerPixel = 2;
 	}
 	else if (pixelFormat == kCCTexture2DPixelFormat_A8)
 	{
@@ -551,17 +742,123 @@ bool CCTexture2D::initPremultipliedATextureWithImage(CCImage *image, unsigned in
 		*/
 	}
 
-	if (data)
+	if (! data)
 	{
-		this->initWithData(data, pixelFormat, POTWide, POTHigh, imageSize);
+		return false;
+	}
 
-		// should be after calling super init
-		m_bHasPremultipliedAlpha = image->isPremultipliedAlpha();
+	pPayload->pixelFormat = pixelFormat;
+	pPayload->width = POTWide;
+	pPayload->height = POTHigh;
+	pPayload->contentWidth = image->getWidth();
+	pPayload->contentHeight = image->getHeight();
+	pPayload->premultipliedAlpha = image->isPremultipliedAlpha();
+	pPayload->levelCount = 1;
+	pPayload->levels[0] = data;
+	pPayload->levelBytes[0] = POTWide * POTHigh * bytesPerPixel;
+	pPayload->ownedLevels = 1;
+	return true;
+}
 
-		//CGContextRelease(context);
-		delete [] data;
+bool CCTexture2D::initWithMipmapChain(struct sMipmapChain *pChain, bool hasAlpha, const CCSize& imageSize)
+{
+	tTexturePayload payload;
+	payloadForMipmapChain(pChain, hasAlpha, imageSize, &payload);
+	bool bRet = initWithPayload(&payload);
+	ccTexturePayloadDestroy(&payload);
+	return bRet;
+}
+
+void CCTexture2D::payloadForMipmapChain(struct sMipmapChain *pChain, bool hasAlpha, const CCSize& imageSize, struct sTexturePayload *pPayload)
+{
+	CCAssert(pChain != NULL && pChain->levelCount > 0, "CCTexture2D: empty mip chain");
+
+	ccTexturePayloadInit(pPayload);
+
+	CCTexture2DPixelFormat pixelFormat = hasAlpha ? g_defaultAlphaPixelFormat : kCCTexture2DPixelFormat_RGB888;
+	if (pixelFormat == kCCTexture2DPixelFormat_A8)
+	{
+		// same as payloadForImage, A8 can't be converted to
+		pixelFormat = kCCTexture2DPixelFormat_RGBA8888;
+	}
+
+	pPayload->pixelFormat = pixelFormat;
+	pPayload->width = pChain->width;
+	pPayload->height = pChain->height;
+	pPayload->contentWidth = (unsigned int)imageSize.width;
+	pPayload->contentHeight = (unsigned int)imageSize.height;
+	pPayload->premultipliedAlpha = pChain->premultipliedAlpha;
+	pPayload->levelCount = pChain->levelCount;
+
+	unsigned int width = pChain->width;
+	unsigned int height = pChain->height;
+	for (unsigned int i = 0; i < pChain->levelCount; ++i)
+	{
+		unsigned char *repacked = repackPixels(pChain->levels[i], width * height, pixelFormat);
+		if (repacked)
+		{
+			pPayload->levels[i] = repacked;
+			pPayload->levelBytes[i] = width * height * 2;
+			pPayload->ownedLevels |= 1u << i;
+		}
+		else
+		{
+			// the 32 bits levels are the chain's
+			pPayload->levels[i] = pChain->levels[i];
+			pPayload->levelBytes[i] = width * height * 4;
+		}
+
+		width = MAX(width >> 1, 1);
+		height = MAX(height >> 1, 1);
 	}
-	return true;
+}
+
+bool CCTexture2D::initWithPayload(const struct sTexturePayload *pPayload)
+{
+	CCAssert(pPayload != NULL && pPayload->levelCount > 0 && pPayload->levelCount <= kCCMipmapMaxLevels, "CCTexture2D: empty payload");
+
+	unsigned maxTextureSize = CCConfiguration::sharedConfiguration()->getMaxTextureSize();
+	if (pPayload->width > maxTextureSize || pPayload->height > maxTextureSize)
+	{
+		CCLOG("cocos2d: WARNING: Image (%u x %u) is bigger than the supported %u x %u", pPayload->width, pPayload->height, maxTextureSize, maxTextureSize);
+		return false;
+	}
+
+	CCTexture2DPixelFormat pixelFormat = (CCTexture2DPixelFormat)pPayload->pixelFormat;
+	DXGI_FORMAT format;
+	unsigned int bytes;
+	bool bBlockCompressed;
+	if (! dxgiFormatForPixelFormat(pixelFormat, &format, &bytes, &bBlockCompressed))
+	{
+		CCLOG("cocos2d: CCTexture2D: payload of unknown pixel format %u", pPayload->pixelFormat);
+		return false;
+	}
+
+	// the payload may come from a file, the device must not read past its levels
+	const void *levels[kCCMipmapMaxLevels];
+	unsigned int width = pPayload->width;
+	unsigned int height = pPayload->height;
+	for (unsigned int i = 0; i < pPayload->levelCount; ++i)
+	{
+		unsigned int expected = bBlockCompressed ? ((width + 3) / 4) * ((height + 3) / 4) * bytes : width * height * bytes;
+		if (pPayload->levels[i] == NULL || pPayload->levelBytes[i] != expected)
+		{
+			CCLOG("cocos2d: CCTexture2D: level %u of the payload is %u bytes instead of %u", i, pPayload->levelBytes[i], expected);
+			return false;
+		}
+
+		levels[i] = pPayload->levels[i];
+		width = MAX(width >> 1, 1);
+		height = MAX(height >> 1, 1);
+	}
+
+	bool bRet = initWithMipmaps(levels, pPayload->levelCount, pixelFormat, pPayload->width, pPayload->height,
+		CCSizeMake((float)pPayload->contentWidth, (float)pPayload->contentHeight));
+
+	// should be after calling super init
+	m_bHasPremultipliedAlpha = pPayload->premultipliedAlpha;
+
+	return bRet;
 }
 
 // implementation CCTexture2D (Text)
@@ -704,6 +1001,80 @@ bool CCTexture2D::initWithPVRFile(const char* file)
     return bRet;
 }
 
+bool CCTexture2D::initWithDDSFile(const char* file)
+{
+	unsigned char *pData = NULL;
+	unsigned long nSize = 0;
+
+	std::string lowerCase(file);
+	for (unsigned int i = 0; i < lowerCase.length(); ++i)
+	{
+		lowerCase[i] = tolower(lowerCase[i]);
+	}
+
+	if (lowerCase.find(".ccz") != std::string::npos)
+	{
+		int nLen = ZipUtils::ccInflateCCZFile(file, &pData);
+		nSize = nLen > 0 ? nLen : 0;
+	}
+	else if (lowerCase.find(".gz") != std::string::npos)
+	{
+		int nLen = ZipUtils::ccInflateGZipFile(file, &pData);
+		nSize = nLen > 0 ? nLen : 0;
+	}
+	else
+	{
+		pData = CCFileUtils::getFileData(file, "rb", &nSize);
+	}
+
+	tDDSInfo info;
+	bool bRet = pData && ccDDSParse(pData, nSize, &info);
+	if (bRet)
+	{
+		CCTexture2DPixelFormat pixelFormat = kCCTexture2DPixelFormat_BC1;
+		switch (info.format)
+		{
+		case kCCBCnFormat_BC2:
+			pixelFormat = kCCTexture2DPixelFormat_BC2;
+			break;
+		case kCCBCnFormat_BC3:
+			pixelFormat = kCCTexture2DPixelFormat_BC3;
+			break;
+		case kCCBCnFormat_BC7:
+			pixelFormat = kCCTexture2DPixelFormat_BC7;
+			break;
+		default:
+			break;
+		}
+
+		// the levels follow each other, down to 1x1 or what the file has
+		const void *levels[D3D11_REQ_MIP_LEVELS];
+		unsigned int levelCount = MIN(info.mipmapCount, (unsigned int)D3D11_REQ_MIP_LEVELS);
+		const unsigned char *level = info.data;
+		unsigned int width = info.width;
+		unsigned int height = info.height;
+		for (unsigned int i = 0; i < levelCount; ++i)
+		{
+			levels[i] = level;
+			level += ccBCnLevelBytes(info.format, width, height);
+			width = MAX(width >> 1, 1);
+			height = MAX(height >> 1, 1);
+		}
+
+		bRet = initWithMipmaps(levels, levelCount, pixelFormat, info.width, info.height,
+			CCSizeMake((float)info.width, (float)info.height));
+		m_bHasPremultipliedAlpha = info.premultipliedAlpha;
+	}
+
+	if (! bRet)
+	{
+		CCLOG("cocos2d: Couldn't load DDS image %s", file);
+	}
+
+	CC_SAFE_DELETE_ARRAY(pData);
+	return bRet;
+}
+
 void CCTexture2D::PVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
 {
     PVRHaveAlphaPremultiplied_ = haveAlphaPremultiplied;
@@ -721,6 +1092,118 @@ void CCTexture2D::generateMipmap()
 	CCAssert( m_uPixelsWide == ccNextPOT(m_uPixelsWide) && m_uPixelsHigh == ccNextPOT(m_uPixelsHigh), "Mimpap texture only works in POT textures");
 	//glBindTexture( GL_TEXTURE_2D, this->m_uName );
 	//ccglGenerateMipmap(GL_TEXTURE_2D);
+	if (! m_pTextureResource)
+	{
+		return;
+	}
+
+	ID3D11Device *pdevice = CCID3D11Device;
+	ID3D11DeviceContext *pcontext = CCID3D11DeviceContext;
+
+	ID3D11Resource *res = NULL;
+	m_pTextureResource->GetResource(&res);
+	ID3D11Texture2D *tex = (ID3D11Texture2D*)res;
+	D3D11_TEXTURE2D_DESC desc;
+	tex->GetDesc(&desc);
+
+	// already created for it, the levels are rendered again from the top one
+	if (desc.MiscFlags & D3D11_RESOURCE_MISC_GENERATE_MIPS)
+	{
+		pcontext->GenerateMips(m_pTextureResource);
+		tex->Release();
+		return;
+	}
+
+	UINT formatSupport = 0;
+	if (FAILED(pdevice->CheckFormatSupport(desc.Format, &formatSupport)) || ! (formatSupport & D3D11_FORMAT_SUPPORT_MIP_AUTOGEN))
+	{
+		CCLOG("cocos2d: CCTexture2D: the device can't generate the mipmaps of pixel format %d", m_ePixelFormat);
+		tex->Release();
+		return;
+	}
+
+	// GenerateMips needs a render target texture made for it, the top level is copied to one
+	D3D11_TEXTURE2D_DESC mipDesc = desc;
+	mipDesc.MipLevels = ccMipmapLevelCount(desc.Width, desc.Height);
+	mipDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	mipDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+	ID3D11Texture2D *mipTex = NULL;
+	ID3D11ShaderResourceView *mipView = NULL;
+	if (FAILED(pdevice->CreateTexture2D(&mipDesc, NULL, &mipTex)) || FAILED(pdevice->CreateShaderResourceView(mipTex, NULL, &mipView)))
+	{
+		CCLOG("cocos2d: CCTexture2D: can't create the %u levels of a %u x %u texture", mipDesc.MipLevels, desc.Width, desc.Height);
+		CC_SAFE_RELEASE_NULL_DX(mipTex);
+		tex->Release();
+		return;
+	}
+
+	pcontext->CopySubresourceRegion(mipTex, 0, 0, 0, 0, tex, 0, NULL);
+	pcontext->GenerateMips(mipView);
+
+	tex->Release();
+	mipTex->Release();
+	m_pTextureResource->Release();
+	m_pTextureResource = mipView;
+	m_uName = (CCuint)m_pTextureResource;
+	m_uMipmapCount = mipDesc.MipLevels;
+}
+
+bool CCTexture2D::updateWithData(const void *data, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	CCAssert(x + width <= m_uPixelsWide && y + height <= m_uPixelsHigh, "CCTexture2D: the region is out of the texture");
+
+	DXGI_FORMAT format;
+	unsigned int bytes;
+	bool bBlockCompressed;
+	if (! m_pTextureResource || ! dxgiFormatForPixelFormat(m_ePixelFormat, &format, &bytes, &bBlockCompressed) || bBlockCompressed)
+	{
+		CCLOG("cocos2d: CCTexture2D: can't update a texture of pixel format %d", m_ePixelFormat);
+		return false;
+	}
+
+	ID3D11Resource *res = NULL;
+	m_pTextureResource->GetResource(&res);
+
+	D3D11_BOX box;
+	box.left = x;
+	box.top = y;
+	box.front = 0;
+	box.right = x + width;
+	box.bottom = y + height;
+	box.back = 1;
+	CCID3D11DeviceContext->UpdateSubresource(res, 0, &box, data, width * bytes, width * height * bytes);
+
+	res->Release();
+	return true;
+}
+
+void CCTexture2D::copyRegion(CCTexture2D *pSource, unsigned int sourceX, unsigned int sourceY, unsigned int width, unsigned int height, unsigned int x, unsigned int y)
+{
+	CCAssert(pSource && pSource->m_ePixelFormat == m_ePixelFormat, "CCTexture2D: the textures must have the same pixel format");
+	CCAssert(x + width <= m_uPixelsWide && y + height <= m_uPixelsHigh, "CCTexture2D: the region is out of the texture");
+
+	if (! m_pTextureResource || ! pSource->m_pTextureResource)
+	{
+		return;
+	}
+
+	ID3D11Resource *dst = NULL;
+	ID3D11Resource *src = NULL;
+	m_pTextureResource->GetResource(&dst);
+	pSource->m_pTextureResource->GetResource(&src);
+
+	D3D11_BOX box;
+	box.left = sourceX;
+	box.top = sourceY;
+	box.front = 0;
+	box.right = sourceX + width;
+	box.bottom = sourceY + height;
+	box.back = 1;
+	CCID3D11DeviceContext->CopySubresourceRegion(dst, 0, x, y, 0, src, 0, &box);
+
+	src->Release();
+	dst->Release();
 }
 
 void CCTexture2D::setTexParameters(ccTexParams *texParams)
@@ -913,6 +1396,14 @@ unsigned int CCTexture2D::bitsPerPixelForFormat()
         case kCCTexture2DPixelFormat_RGB888:
             ret = 24;
             break;
+		case kCCTexture2DPixelFormat_BC1:
+			ret = 4;
+			break;
+		case kCCTexture2DPixelFormat_BC2:
+		case kCCTexture2DPixelFormat_BC3:
+		case kCCTexture2DPixelFormat_BC7:
+			ret = 8;
+			break;
 		default:
 			ret = -1;
 			CCAssert(false, "illegal pixel format");
@@ -922,4 +1413,27 @@ unsigned int CCTexture2D::bitsPerPixelForFormat()
 	return ret;
 }
 
+unsigned int CCTexture2D::getMemorySize()
+{
+	DXGI_FORMAT format;
+	unsigned int bytes;
+	bool bBlockCompressed;
+	if (! dxgiFormatForPixelFormat(m_ePixelFormat, &format, &bytes, &bBlockCompressed))
+	{
+		return 0;
+	}
+
+	unsigned int size = 0;
+	unsigned int width = m_uPixelsWide;
+	unsigned int height = m_uPixelsHigh;
+	for (unsigned int i = 0; i < m_uMipmapCount; ++i)
+	{
+		size += bBlockCompressed ? ccBCnLevelBytes(bcnFormatForPixelFormat(m_ePixelFormat), width, height) : width * height * bytes;
+		width = MAX(width >> 1, 1);
+		height = MAX(height >> 1, 1);
+	}
+
+	return size;
+}
+
 }//namespace   cocos2d 
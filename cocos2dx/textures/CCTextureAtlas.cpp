@@ -36,6 +36,8 @@ THE SOFTWARE.
 #include <stdlib.h>
 #include <fstream>
 #include "BasicLoader.h"
+#include "CCBufferRing.h"
+#include "CCRenderQueue.h"
 
 using namespace DirectX;
 using namespace std;
@@ -440,12 +442,9 @@ void CCTextureAtlas::SetColor(UINT r,UINT g,UINT b,UINT a)
 
 CCDXTextureAtlas::CCDXTextureAtlas()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_matrixBuffer = 0;
+	m_pProgram = NULL;
 	m_indexBuffer = 0;
-	m_vertexBuffer = 0;
+	m_uIndexCapacity = 0;
 
 	mIsInit = FALSE;
 }
@@ -455,27 +454,27 @@ CCDXTextureAtlas::~CCDXTextureAtlas()
 }
 void CCDXTextureAtlas::FreeBuffer()
 {
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
 	CC_SAFE_RELEASE_NULL_DX(m_indexBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_matrixBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_layout);
-	CC_SAFE_RELEASE_NULL_DX(m_pixelShader);
-	CC_SAFE_RELEASE_NULL_DX(m_vertexShader);
+	m_uIndexCapacity = 0;
+	CC_SAFE_RELEASE_NULL(m_pProgram);
 }
 void CCDXTextureAtlas::setIsInit(bool isInit)
 {
 	mIsInit = isInit;
 }
 
-void CCDXTextureAtlas::RenderVertexBuffer(ccV3F_C4B_T2F_Quad* quads,unsigned int capacity)
+void CCDXTextureAtlas::RenderVertexBuffer(ccV3F_C4B_T2F_Quad* quads,unsigned int n, unsigned int start)
 {
-	VertexType* verticesTmp = new VertexType[4*capacity];
+	// only the quads drawn are written, straight to the shared ring
+	unsigned int offset;
+	VertexType* verticesTmp = (VertexType*)CCDynamicBuffers::sharedDynamicBuffers()->mapVertices(sizeof(VertexType), 4*n, &offset);
 	if(!verticesTmp)
 	{
 		return ;
 	}
+	quads += start;
 
-	for ( int i=0; i<capacity; i++ )
+	for ( unsigned int i=0; i<n; i++ )
 	{
 		verticesTmp[4*i+0].position = XMFLOAT3(quads[i].tl.vertices.x, quads[i].tl.vertices.y, quads[i].tl.vertices.z);
 		verticesTmp[4*i+1].position = XMFLOAT3(quads[i].tr.vertices.x, quads[i].tr.vertices.y, quads[i].tr.vertices.z);
@@ -493,51 +492,26 @@ void CCDXTextureAtlas::RenderVertexBuffer(ccV3F_C4B_T2F_Quad* quads,unsigned int
 		verticesTmp[4*i+3].color = XMFLOAT4(quads[i].bl.colors.r/255.f, quads[i].bl.colors.g/255.f, quads[i].bl.colors.b/255.f, quads[i].bl.colors.a/255.f);
 	}
 
-	D3D11_MAPPED_SUBRESOURCE mappedResourceVertex;
-	VertexType* verticesPtr;
-	if(FAILED(CCID3D11DeviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResourceVertex))){return ;}
-	verticesPtr = (VertexType*)mappedResourceVertex.pData;
-	memcpy(verticesPtr, (void*)verticesTmp, (sizeof(VertexType) * 4 * capacity));
-	CCID3D11DeviceContext->Unmap(m_vertexBuffer, 0);
+	CCDynamicBuffers::sharedDynamicBuffers()->unmapVertices();
 
-	if ( verticesTmp )
-	{
-		delete[] verticesTmp;
-		verticesTmp = 0;
-	}
 	////////////////////////
-	unsigned int stride;
-	unsigned int offset;
-	stride = sizeof(VertexType); 
-	offset = 0;
-	CCID3D11DeviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
-	CCID3D11DeviceContext->IASetIndexBuffer( m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+	CCDynamicBuffers::sharedDynamicBuffers()->bindVertices(0, sizeof(VertexType), offset);
+	CCRenderQueue::sharedRenderQueue()->setIndexBuffer(m_indexBuffer);
 
-	CCID3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	CCRenderQueue::sharedRenderQueue()->setTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 	return;
 }
 
 void CCDXTextureAtlas::initVertexBuffer(unsigned short* indices,unsigned int capacity)
 {
-	CC_SAFE_RELEASE_NULL_DX(m_indexBuffer);
-	CC_SAFE_RELEASE_NULL_DX(m_vertexBuffer);
-	D3D11_BUFFER_DESC vertexBufferDesc;
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType)*4 * capacity;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Now create the vertex buffer.
-	if(FAILED(CCID3D11Device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer)))
+	// the index buffer of the largest atlas serves the smaller ones
+	if ( m_indexBuffer && capacity <= m_uIndexCapacity )
 	{
 		return ;
 	}
-
+	CC_SAFE_RELEASE_NULL_DX(m_indexBuffer);
+	m_uIndexCapacity = 0;
 
 	D3D11_BUFFER_DESC indexBufferDesc;
 	ZeroMemory( &indexBufferDesc, sizeof(indexBufferDesc) );
@@ -550,23 +524,14 @@ void CCDXTextureAtlas::initVertexBuffer(unsigned short* indices,unsigned int cap
 
 	D3D11_SUBRESOURCE_DATA iinitData;
 	iinitData.pSysMem = indices;
-	CCID3D11Device->CreateBuffer(&indexBufferDesc, &iinitData, &m_indexBuffer);
+	if(SUCCEEDED(CCID3D11Device->CreateBuffer(&indexBufferDesc, &iinitData, &m_indexBuffer)))
+	{
+		m_uIndexCapacity = capacity;
+	}
 }
 
 bool CCDXTextureAtlas::InitializeShader()
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	//ID3D10Blob* vertexShaderBuffer;
-	//ID3D10Blob* pixelShaderBuffer;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-
-	// Initialize the pointers this function will use to null.
-	errorMessage = 0;
-	//vertexShaderBuffer = 0;
-	//pixelShaderBuffer = 0;
-
-	BasicLoader^ loader = ref new BasicLoader(CCID3D11Device);
 	D3D11_INPUT_ELEMENT_DESC layoutDesc[] = 
 	{
 		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -574,35 +539,15 @@ bool CCDXTextureAtlas::InitializeShader()
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 	};
 
-	loader->LoadShader(
+	m_pProgram = CCRenderQueue::sharedRenderQueue()->programWithShaders(
 		L"CCTextureAtlasVertexShader.cso",
 		layoutDesc,
 		ARRAYSIZE(layoutDesc),
-		&m_vertexShader,
-		&m_layout
+		L"CCTextureAtlasPixelShader.cso"
 		);
+	CC_SAFE_RETAIN(m_pProgram);
 
-	loader->LoadShader(
-		L"CCTextureAtlasPixelShader.cso",
-		&m_pixelShader
-		);
-
-	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
-	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
-	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	matrixBufferDesc.MiscFlags = 0;
-	matrixBufferDesc.StructureByteStride = 0;
-
-	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class.
-	result = CCID3D11Device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
-	if(FAILED(result))
-	{
-		return false;
-	}
-
-	return true;
+	return m_pProgram != NULL;
 }
 
 void CCDXTextureAtlas::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
@@ -643,34 +588,27 @@ void CCDXTextureAtlas::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND h
 
 bool CCDXTextureAtlas::SetShaderParameters( XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, ID3D11ShaderResourceView* texture)
 {
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	MatrixBufferType* dataPtr;
+	MatrixBufferType matrices;
 	unsigned int bufferNumber;
 
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
-
-	if(FAILED(CCID3D11DeviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource))){return false;}
-	dataPtr = (MatrixBufferType*)mappedResource.pData;
-	dataPtr->view = viewMatrix;
-	dataPtr->projection = projectionMatrix;
-	CCID3D11DeviceContext->Unmap(m_matrixBuffer, 0);
+	matrices.view = XMMatrixTranspose(viewMatrix);
+	matrices.projection = XMMatrixTranspose(projectionMatrix);
 
 	bufferNumber = 0;
-	CCID3D11DeviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
+	if(!CCDynamicBuffers::sharedDynamicBuffers()->setVSConstants(bufferNumber, &matrices, sizeof(matrices))){return false;}
 
-	CCID3D11DeviceContext->PSSetShaderResources(0, 1, &texture);
+	CCRenderQueue::sharedRenderQueue()->setTexture(texture);
 
 	return true;
 }
 
 void CCDXTextureAtlas::RenderShader(CCTexture2D* texture,unsigned int n, unsigned int start)
 {
-	CCID3D11DeviceContext->IASetInputLayout(m_layout);
-	CCID3D11DeviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetShader(m_pixelShader, NULL, 0);
-	CCID3D11DeviceContext->PSSetSamplers(0, 1, texture->GetSamplerState());
-	CCID3D11DeviceContext->DrawIndexed(n*6, start*6, 0 );
+	CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
+	pQueue->setProgram(m_pProgram);
+	pQueue->setSampler(*texture->GetSamplerState());
+	// the vertices of quad start are the first ones in the ring
+	pQueue->drawIndexed(n*6, start*6, -(INT)(start*4) );
 
 	return;
 }
@@ -692,7 +630,7 @@ void CCDXTextureAtlas::Render(ccV3F_C4B_T2F_Quad* quads,unsigned short* indices,
 	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
 
 	// Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing.
-	RenderVertexBuffer(quads,capacity);
+	RenderVertexBuffer(quads,n,start);
 
 	// Set the shader parameters that it will use for rendering.
 	SetShaderParameters(viewMatrix, projectionMatrix, texture->getTextureResource());
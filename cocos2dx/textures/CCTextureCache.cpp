@@ -25,11 +25,15 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include <stack>
+#include <algorithm>
+#include <vector>
 #include <string>
 #include <cctype>
 #include <queue>
+#include <string.h>
 #include "CCTextureCache.h"
 #include "CCTexture2D.h"
+#include "CCDynamicAtlas.h"
 #include "ccMacros.h"
 #include "CCData.h"
 #include "CCDirector.h"
@@ -37,10 +41,14 @@ THE SOFTWARE.
 #include "CCFileUtils.h"
 #include "CCImage.h"
 #include "support/ccUtils.h"
+#include "support/image_support/ccTexturePayload.h"
 #include "CCScheduler.h"
 //#include "pthread.h"
 #include "CCThread.h"
 //#include "semaphore.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace std;
 
@@ -51,26 +59,46 @@ typedef struct _AsyncStruct
 	std::string			filename;
 	CCObject	*target;
 	SEL_CallFuncO		selector;
+	bool				bMipmaps;
+	ccMipmapFilter		mipmapFilter;
+	//! where the mip chain is cached, empty when it isn't
+	std::string			mipmapCachePath;
+	//! where the converted levels are cached, empty when they aren't
+	std::string			payloadCachePath;
+	unsigned int		payloadSettings;
+	bool				bCompressPayload;
 } AsyncStruct;
 
 typedef struct _ImageInfo
 {
 	AsyncStruct *asyncStruct;
+	//! NULL when the file couldn't be loaded
 	CCImage		*image;
 	CCImage::EImageFormat imageType;
+	//! NULL without mipmaps
+	tMipmapChain *mipmaps;
+	//! NULL without the decoded image cache, may point to the levels of mipmaps
+	tTexturePayload *payload;
 } ImageInfo;
 
-//static pthread_t s_loadingThread;
+// at most that many loading threads, one less than the cores otherwise
+#define kMaxLoadingThreads	4
 
-//static pthread_mutex_t		s_asyncStructQueueMutex;
-//static pthread_mutex_t      s_ImageInfoMutex;
+static std::thread *s_pLoadingThreads[kMaxLoadingThreads];
+static unsigned int s_uLoadingThreadCount = 0;
 
-//static sem_t s_sem;
+static std::mutex		s_asyncStructQueueMutex;
+static std::mutex      s_ImageInfoMutex;
+
+static std::condition_variable s_sleepCondition;
 static bool need_quit;
 
 static std::queue<AsyncStruct*>		*s_pAsyncStructQueue;
 static std::queue<ImageInfo*>		*s_pImageQueue;
 
+// requests whose texture isn't in the cache yet, the callback is scheduled meanwhile
+static unsigned int s_uAsyncRefCount = 0;
+
 static CCImage::EImageFormat computeImageFormatType(string& filename)
 {
 	CCImage::EImageFormat ret = CCImage::kFmtUnKnown;
@@ -87,57 +115,150 @@ static CCImage::EImageFormat computeImageFormatType(string& filename)
 	return ret;
 }
 
-static void* loadImage(void* data)
+// file the mip chain or the payload of an image is cached in, the writable path isn't read on the loading threads
+static std::string cacheFilePath(const std::string& fullpath, const char *extension)
+{
+	// FNV-1a, two images of the same name in different folders get different files
+	unsigned int hash = 2166136261u;
+	for (unsigned int i = 0; i < fullpath.length(); ++i)
+	{
+		hash = (hash ^ (unsigned char)fullpath[i]) * 16777619u;
+	}
+
+	size_t pos = fullpath.find_last_of("/\\");
+	std::string name = (pos == std::string::npos) ? fullpath : fullpath.substr(pos + 1);
+
+	char suffix[32];
+	sprintf(suffix, ".%08x%s", hash, extension);
+	return CCFileUtils::getWriteablePath() + name + suffix;
+}
+
+static inline std::string mipmapCachePath(const std::string& fullpath)
 {
-/*
-	// create autorelease pool for iOS
-	CCThread thread;
-	thread.createAutoreleasePool();
+	return cacheFilePath(fullpath, ".mips");
+}
 
-    AsyncStruct *pAsyncStruct = NULL;
+static inline std::string payloadCachePath(const std::string& fullpath)
+{
+	return cacheFilePath(fullpath, ".cctex");
+}
+
+// Mip chain of an image, NULL if it can't have one. Runs on the loading threads.
+static tMipmapChain* buildMipmapChain(CCImage *pImage, const std::string& fullpath, ccMipmapFilter filter, const std::string& cachePath)
+{
+	unsigned int POTWide, POTHigh;
+	CCTexture2D::textureSizeForImageSize(pImage->getWidth(), pImage->getHeight(), &POTWide, &POTHigh);
 
+	tMipmapChain *pChain = new tMipmapChain();
+	if (! ccMipmapChainInit(pChain, pImage->getData(), pImage->hasAlpha() ? 4 : 3, pImage->getWidth(), pImage->getHeight(), POTWide, POTHigh, pImage->isPremultipliedAlpha()))
+	{
+		CCLOG("cocos2d: CCTextureCache: can't build the mip chain of %s", fullpath.c_str());
+		delete pChain;
+		return NULL;
+	}
+
+	if (cachePath.empty()
+		|| ! (ccMipmapChainRead(pChain, filter, (fullpath + ".mips").c_str()) || ccMipmapChainRead(pChain, filter, cachePath.c_str())))
+	{
+		ccMipmapChainGenerate(pChain, filter);
+
+		if (! cachePath.empty() && ! ccMipmapChainWrite(pChain, filter, cachePath.c_str()))
+		{
+			CCLOG("cocos2d: CCTextureCache: can't write %s", cachePath.c_str());
+		}
+	}
+
+	return pChain;
+}
+
+// Converts an image, or its mip chain when it has one, and saves the payload for the next launches.
+// key 0 doesn't save it. Runs on the loading threads too.
+static bool buildPayload(CCImage *pImage, tMipmapChain *pMipmaps, unsigned int key, bool bCompress, const std::string& cachePath, tTexturePayload *pPayload)
+{
+	if (pMipmaps)
+	{
+		CCTexture2D::payloadForMipmapChain(pMipmaps, pImage->hasAlpha(), CCSizeMake((float)(pImage->getWidth()), (float)(pImage->getHeight())), pPayload);
+	}
+	else if (! CCTexture2D::payloadForImage(pImage, pPayload))
+	{
+		return false;
+	}
+
+	if (key != 0 && ! ccTexturePayloadWrite(pPayload, key, bCompress, cachePath.c_str()))
+	{
+		CCLOG("cocos2d: CCTextureCache: can't write %s", cachePath.c_str());
+	}
+
+	return true;
+}
+
+static void loadImage(void)
+{
 	while (true)
 	{
-		// wait for rendering thread to ask for loading if s_pAsyncStructQueue is empty
-		sem_wait(&s_sem);
+		AsyncStruct *pAsyncStruct = NULL;
+		{
+			// wait for rendering thread to ask for loading if s_pAsyncStructQueue is empty
+			std::unique_lock<std::mutex> lock(s_asyncStructQueueMutex);
+			while (s_pAsyncStructQueue->empty() && ! need_quit)
+			{
+				s_sleepCondition.wait(lock);
+			}
 
-		std::queue<AsyncStruct*> *pQueue = s_pAsyncStructQueue;
+			if (need_quit)
+			{
+				break;
+			}
 
-		pthread_mutex_lock(&s_asyncStructQueueMutex);// get async struct from queue
-        if (pQueue->empty())
-        {
-            pthread_mutex_unlock(&s_asyncStructQueueMutex);
-	if (need_quit)
-		break;
-	else
-		continue;
-        }
-        else
-        {
-            pAsyncStruct = pQueue->front();
-            pQueue->pop();
-            pthread_mutex_unlock(&s_asyncStructQueueMutex);
-        }		
+			pAsyncStruct = s_pAsyncStructQueue->front();
+			s_pAsyncStructQueue->pop();
+		}
 
 		const char *filename = pAsyncStruct->filename.c_str();
 
+		// a payload cached by an earlier launch replaces the decoding
+		tTexturePayload *pPayload = NULL;
+		unsigned int payloadKey = 0;
+		bool bPayloadLoaded = false;
+		if (! pAsyncStruct->payloadCachePath.empty())
+		{
+			pPayload = new tTexturePayload();
+			ccTexturePayloadInit(pPayload);
+			payloadKey = ccTexturePayloadKey(filename, pAsyncStruct->payloadSettings);
+			bPayloadLoaded = ccTexturePayloadRead(pPayload, payloadKey, pAsyncStruct->payloadCachePath.c_str());
+		}
+
 		// compute image type
 		CCImage::EImageFormat imageType = computeImageFormatType(pAsyncStruct->filename);
+		CCImage *pImage = NULL;
 		if (imageType == CCImage::kFmtUnKnown)
 		{
 			CCLOG("unsupportted format %s",filename);
-			delete pAsyncStruct;
-			
-			continue;
 		}
-		
-        // generate image			
-		CCImage *pImage = new CCImage();
-		if (! pImage->initWithImageFileThreadSafe(filename, imageType))
+		else if (! bPayloadLoaded)
+		{
+			// generate image
+			pImage = new CCImage();
+			if (! pImage->initWithImageFileThreadSafe(filename, imageType))
+			{
+				CC_SAFE_DELETE(pImage);
+				CCLOG("can not load %s", filename);
+			}
+		}
+
+		// the mip levels are built here, the main thread only uploads them
+		tMipmapChain *pMipmaps = NULL;
+		if (pImage && pAsyncStruct->bMipmaps)
+		{
+			pMipmaps = buildMipmapChain(pImage, pAsyncStruct->filename, pAsyncStruct->mipmapFilter, pAsyncStruct->mipmapCachePath);
+		}
+
+		// so is the conversion
+		if (pPayload && ! bPayloadLoaded
+			&& ! (pImage && buildPayload(pImage, pMipmaps, payloadKey, pAsyncStruct->bCompressPayload, pAsyncStruct->payloadCachePath, pPayload)))
 		{
-			delete pImage;
-			CCLOG("can not load %s", filename);
-			continue;
+			ccTexturePayloadDestroy(pPayload);
+			CC_SAFE_DELETE(pPayload);
 		}
 
 		// generate image info
@@ -145,14 +266,75 @@ static void* loadImage(void* data)
 		pImageInfo->asyncStruct = pAsyncStruct;
 		pImageInfo->image = pImage;
 		pImageInfo->imageType = imageType;
+		pImageInfo->mipmaps = pMipmaps;
+		pImageInfo->payload = pPayload;
 
 		// put the image info into the queue
-		pthread_mutex_lock(&s_ImageInfoMutex);
+		std::lock_guard<std::mutex> lock(s_ImageInfoMutex);
 		s_pImageQueue->push(pImageInfo);
-		pthread_mutex_unlock(&s_ImageInfoMutex);	
 	}
-*/	
-	return 0;
+}
+
+static void deleteImageInfo(ImageInfo *pImageInfo)
+{
+	// before the mip chain, it may point to its levels
+	if (pImageInfo->payload)
+	{
+		ccTexturePayloadDestroy(pImageInfo->payload);
+		delete pImageInfo->payload;
+	}
+
+	if (pImageInfo->mipmaps)
+	{
+		ccMipmapChainDestroy(pImageInfo->mipmaps);
+		delete pImageInfo->mipmaps;
+	}
+
+	delete pImageInfo->image;
+	delete pImageInfo->asyncStruct;
+	delete pImageInfo;
+}
+
+// joins the loading threads and drops what they didn't finish
+static void stopLoadingThreads(void)
+{
+	if (s_uLoadingThreadCount == 0)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_asyncStructQueueMutex);
+		need_quit = true;
+	}
+	s_sleepCondition.notify_all();
+
+	for (unsigned int i = 0; i < s_uLoadingThreadCount; ++i)
+	{
+		s_pLoadingThreads[i]->join();
+		CC_SAFE_DELETE(s_pLoadingThreads[i]);
+	}
+	s_uLoadingThreadCount = 0;
+
+	while (! s_pAsyncStructQueue->empty())
+	{
+		AsyncStruct *pAsyncStruct = s_pAsyncStructQueue->front();
+		s_pAsyncStructQueue->pop();
+		CC_SAFE_RELEASE(pAsyncStruct->target);
+		delete pAsyncStruct;
+	}
+
+	while (! s_pImageQueue->empty())
+	{
+		ImageInfo *pImageInfo = s_pImageQueue->front();
+		s_pImageQueue->pop();
+		CC_SAFE_RELEASE(pImageInfo->asyncStruct->target);
+		deleteImageInfo(pImageInfo);
+	}
+
+	CC_SAFE_DELETE(s_pAsyncStructQueue);
+	CC_SAFE_DELETE(s_pImageQueue);
+	s_uAsyncRefCount = 0;
 }
 
 // implementation CCTextureCache
@@ -169,17 +351,24 @@ CCTextureCache * CCTextureCache::sharedTextureCache()
 }
 
 CCTextureCache::CCTextureCache()
+: m_bMipmapsEnabled(false)
+, m_eMipmapFilter(kCCMipmapFilter_Box)
+, m_bMipmapDiskCacheEnabled(false)
+, m_bDecodedImageCacheEnabled(false)
+, m_bDecodedImageCacheCompressed(false)
+, m_uMemoryBudget(0)
+, m_uFrame(0)
 {
 	CCAssert(g_sharedTextureCache == NULL, "Attempted to allocate a second instance of a singleton.");
 	
 	m_pTextures = new CCMutableDictionary<std::string, CCTexture2D*>();
+	memset(&m_tResidencyStats, 0, sizeof(m_tResidencyStats));
 }
 
 CCTextureCache::~CCTextureCache()
 {
 	CCLOGINFO("cocos2d: deallocing CCTextureCache.");
-	need_quit = true;
-	//sem_post(&s_sem);
+	stopLoadingThreads();
 	CC_SAFE_RELEASE(m_pTextures);
 }
 
@@ -198,9 +387,13 @@ char * CCTextureCache::description()
 
 void CCTextureCache::addImageAsync(const char *path, CCObject *target, SEL_CallFuncO selector)
 {
-	//TODO
+	addImageAsync(path, target, selector, m_bMipmapsEnabled);
+}
+
+void CCTextureCache::addImageAsync(const char *path, CCObject *target, SEL_CallFuncO selector, bool bMipmaps)
+{
 	CCAssert(path != NULL, "TextureCache: fileimage MUST not be NULL");	
-/*
+
 	CCTexture2D *texture = NULL;
 
 	// optimization
@@ -228,96 +421,237 @@ void CCTextureCache::addImageAsync(const char *path, CCObject *target, SEL_CallF
 	}
 
 	// lazy init
-	static bool firstRun = true;
-	if (firstRun)
-	{		     
-        s_pAsyncStructQueue = new queue<AsyncStruct*>();
-	    s_pImageQueue = new queue<ImageInfo*>();		
+	if (s_uLoadingThreadCount == 0)
+	{
+		s_pAsyncStructQueue = new queue<AsyncStruct*>();
+		s_pImageQueue = new queue<ImageInfo*>();
+		need_quit = false;
 
-		pthread_mutex_init(&s_asyncStructQueueMutex, NULL);
-		sem_init(&s_sem, 0, 0);
-		pthread_mutex_init(&s_ImageInfoMutex, NULL);
-		pthread_create(&s_loadingThread, NULL, loadImage, NULL);
+		// hardware_concurrency() is 0 when it isn't known
+		unsigned int cores = std::thread::hardware_concurrency();
+		s_uLoadingThreadCount = MIN(MAX(cores, 2) - 1, kMaxLoadingThreads);
+		for (unsigned int i = 0; i < s_uLoadingThreadCount; ++i)
+		{
+			s_pLoadingThreads[i] = new std::thread(loadImage);
+		}
+	}
 
+	if (0 == s_uAsyncRefCount)
+	{
 		CCScheduler::sharedScheduler()->scheduleSelector(schedule_selector(CCTextureCache::addImageAsyncCallBack), this, 0, false);
-		need_quit = false;
-		firstRun = false;
 	}
+	++s_uAsyncRefCount;
 
 	// generate async struct
 	AsyncStruct *data = new AsyncStruct();
 	data->filename = fullpath.c_str();
 	data->target = target;
 	data->selector = selector;
+	data->bMipmaps = bMipmaps;
+	data->mipmapFilter = m_eMipmapFilter;
+	if (bMipmaps && m_bMipmapDiskCacheEnabled)
+	{
+		data->mipmapCachePath = mipmapCachePath(fullpath);
+	}
+	data->payloadSettings = payloadSettings(bMipmaps);
+	data->bCompressPayload = m_bDecodedImageCacheCompressed;
+	if (m_bDecodedImageCacheEnabled)
+	{
+		data->payloadCachePath = payloadCachePath(fullpath);
+	}
 
 	// add async struct into queue
-	pthread_mutex_lock(&s_asyncStructQueueMutex);
-	s_pAsyncStructQueue->push(data);
-	pthread_mutex_unlock(&s_asyncStructQueueMutex);
+	{
+		std::lock_guard<std::mutex> lock(s_asyncStructQueueMutex);
+		s_pAsyncStructQueue->push(data);
+	}
 
-	sem_post(&s_sem);
-*/
+	s_sleepCondition.notify_one();
 }
 
 void CCTextureCache::addImageAsyncCallBack(ccTime dt)
 {
-	//TODO
-/*
+	CC_UNUSED_PARAM(dt);
+
 	// the image is generated in loading thread
 	std::queue<ImageInfo*> *imagesQueue = s_pImageQueue;
 
-	pthread_mutex_lock(&s_ImageInfoMutex);
-	if (imagesQueue->empty())
+	ImageInfo *pImageInfo = NULL;
 	{
-		pthread_mutex_unlock(&s_ImageInfoMutex);
-	}
-	else
-	{
-		ImageInfo *pImageInfo = imagesQueue->front();
+		// a texture per frame, so that the uploads don't all land in the same frame
+		std::lock_guard<std::mutex> lock(s_ImageInfoMutex);
+		if (imagesQueue->empty())
+		{
+			return;
+		}
+
+		pImageInfo = imagesQueue->front();
 		imagesQueue->pop();
-		pthread_mutex_unlock(&s_ImageInfoMutex);
+	}
 
-		AsyncStruct *pAsyncStruct = pImageInfo->asyncStruct;
-		CCImage *pImage = pImageInfo->image;
+	AsyncStruct *pAsyncStruct = pImageInfo->asyncStruct;
+	CCImage *pImage = pImageInfo->image;
 
-		CCObject *target = pAsyncStruct->target;
-		SEL_CallFuncO selector = pAsyncStruct->selector;
-		const char* filename = pAsyncStruct->filename.c_str();
+	CCObject *target = pAsyncStruct->target;
+	SEL_CallFuncO selector = pAsyncStruct->selector;
+	const char* filename = pAsyncStruct->filename.c_str();
 
+	// a file loaded meanwhile by addImage() is kept
+	CCTexture2D *texture = m_pTextures->objectForKey(pAsyncStruct->filename);
+	if (! texture && (pImage || pImageInfo->payload))
+	{
 		// generate texture in render thread
-		CCTexture2D *texture = new CCTexture2D();
-		texture->initWithImage(pImage);
-
-#if CC_ENABLE_CACHE_TEXTTURE_DATA
-        // cache the texture file name
-		if (pImageInfo->imageType == CCImage::kFmtJpg)
+		texture = new CCTexture2D();
+		bool bRet = false;
+		if (pImageInfo->payload)
+		{
+			bRet = texture->initWithPayload(pImageInfo->payload);
+		}
+		else if (pImageInfo->mipmaps)
 		{
-			VolatileTexture::addImageTexture(texture, filename, CCImage::kFmtJpg);
+			bRet = texture->initWithMipmapChain(pImageInfo->mipmaps, pImage->hasAlpha(), CCSizeMake((float)(pImage->getWidth()), (float)(pImage->getHeight())));
 		}
 		else
 		{
-			VolatileTexture::addImageTexture(texture, filename, CCImage::kFmtPng);
+			// initWithImage releases the texture when it fails, the extra reference keeps it for the else below
+			texture->retain();
+			bRet = texture->initWithImage(pImage);
+			if (bRet)
+			{
+				texture->release();
+			}
 		}
-#endif
 
-		// cache the texture
-		m_pTextures->setObject(texture, filename);
-		texture->autorelease();
+		if (bRet)
+		{
+#if CC_ENABLE_CACHE_TEXTTURE_DATA
+			// cache the texture file name
+			VolatileTexture::addImageTexture(texture, filename, pImageInfo->imageType);
+#endif
 
-		if (target && selector)
+			// cache the texture
+			cacheTexture(texture, pAsyncStruct->filename);
+			texture->autorelease();
+		}
+		else
 		{
-			(target->*selector)(texture);
-			target->release();
-		}		
+			CCLOG("cocos2d: Couldn't add image:%s in CCTextureCache", filename);
+			texture->release();
+			texture = NULL;
+		}
+	}
 
-		delete pImage;
-		delete pAsyncStruct;
-		delete pImageInfo;
+	if (target && selector && texture)
+	{
+		(target->*selector)(texture);
+	}
+	CC_SAFE_RELEASE(target);
+
+	deleteImageInfo(pImageInfo);
+
+	if (--s_uAsyncRefCount == 0)
+	{
+		CCScheduler::sharedScheduler()->unscheduleSelector(schedule_selector(CCTextureCache::addImageAsyncCallBack), this);
 	}
-*/
 }
 
 CCTexture2D * CCTextureCache::addImage(const char * path)
+{
+	return addImage(path, m_bMipmapsEnabled);
+}
+
+unsigned int CCTextureCache::payloadSettings(bool bMipmaps)
+{
+	// the NPOT support decides the padding
+	unsigned int uWide, uHigh;
+	CCTexture2D::textureSizeForImageSize(3, 3, &uWide, &uHigh);
+
+	unsigned int settings = (unsigned int)CCTexture2D::defaultAlphaPixelFormat();
+	settings |= (uWide == 3 ? 1u : 0u) << 8;
+	if (bMipmaps)
+	{
+		settings |= (1u << 9) | ((unsigned int)m_eMipmapFilter << 10);
+	}
+
+	return settings;
+}
+
+CCTexture2D* CCTextureCache::addImageFromPayloadCache(const std::string& fullpath, const std::string& pathKey, bool bMipmaps)
+{
+	std::string filename = fullpath;
+	CCImage::EImageFormat imageType = computeImageFormatType(filename);
+	if (imageType == CCImage::kFmtUnKnown)
+	{
+		return NULL;
+	}
+
+	tTexturePayload payload;
+	ccTexturePayloadInit(&payload);
+	if (! ccTexturePayloadRead(&payload, ccTexturePayloadKey(fullpath.c_str(), payloadSettings(bMipmaps)), payloadCachePath(fullpath).c_str()))
+	{
+		return NULL;
+	}
+
+	CCTexture2D *texture = new CCTexture2D();
+	bool bRet = texture->initWithPayload(&payload);
+	ccTexturePayloadDestroy(&payload);
+	if (! bRet)
+	{
+		// decoded again
+		texture->release();
+		return NULL;
+	}
+
+	ccResolutionType resolution;
+	CCFileUtils::fullPathFromRelativePath(fullpath.c_str(), &resolution);
+	texture->setResolutionType(resolution);
+
+#if CC_ENABLE_CACHE_TEXTTURE_DATA
+	// cache the texture file name
+	VolatileTexture::addImageTexture(texture, fullpath.c_str(), imageType);
+#endif
+
+	cacheTexture(texture, pathKey);
+	texture->autorelease();
+	return texture;
+}
+
+void CCTextureCache::initTextureWithImage(CCTexture2D *texture, CCImage *image, ccResolutionType resolution, const std::string& fullpath, bool bMipmaps)
+{
+	tMipmapChain *pMipmaps = NULL;
+	if (bMipmaps)
+	{
+		pMipmaps = buildMipmapChain(image, fullpath, m_eMipmapFilter, m_bMipmapDiskCacheEnabled ? mipmapCachePath(fullpath) : std::string());
+	}
+
+	tTexturePayload payload;
+	ccTexturePayloadInit(&payload);
+	if (m_bDecodedImageCacheEnabled
+		&& buildPayload(image, pMipmaps, ccTexturePayloadKey(fullpath.c_str(), payloadSettings(bMipmaps)), m_bDecodedImageCacheCompressed, payloadCachePath(fullpath), &payload))
+	{
+		texture->initWithPayload(&payload);
+		texture->setResolutionType(resolution);
+		ccTexturePayloadDestroy(&payload);
+
+		if (pMipmaps)
+		{
+			ccMipmapChainDestroy(pMipmaps);
+			delete pMipmaps;
+		}
+	}
+	else if (pMipmaps)
+	{
+		texture->initWithMipmapChain(pMipmaps, image->hasAlpha(), CCSizeMake((float)(image->getWidth()), (float)(image->getHeight())));
+		ccMipmapChainDestroy(pMipmaps);
+		delete pMipmaps;
+	}
+	else
+	{
+		texture->initWithImage(image, resolution);
+	}
+}
+
+CCTexture2D * CCTextureCache::addImage(const char * path, bool bMipmaps)
 {
 	CCAssert(path != NULL, "TextureCache: fileimage MUST not be NULL");
 
@@ -350,6 +684,14 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
 			{
 				texture = this->addPVRImage(fullpath.c_str());
 			}
+			else if (std::string::npos != lowerCase.find(".dds"))
+			{
+				texture = this->addDDSImage(fullpath.c_str());
+			}
+			else if (m_bDecodedImageCacheEnabled && (texture = addImageFromPayloadCache(fullpath, pathKey, bMipmaps)) != NULL)
+			{
+				// converted by an earlier launch, the image isn't decoded
+			}
 			// Issue #886: TEMPORARY FIX FOR TRANSPARENT JPEGS IN IOS4
 			else if (std::string::npos != lowerCase.find(".jpg") || std::string::npos != lowerCase.find(".jpeg"))
 			{
@@ -362,7 +704,7 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
                 ccResolutionType resolution;
                 fullpath = CCFileUtils::fullPathFromRelativePath(fullpath.c_str(), &resolution);
 				texture = new CCTexture2D();
-				texture->initWithImage(&image, resolution);
+				initTextureWithImage(texture, &image, resolution, fullpath, bMipmaps);
 
 				if( texture )
 				{
@@ -371,7 +713,7 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
                     VolatileTexture::addImageTexture(texture, fullpath.c_str(), CCImage::kFmtJpg);
 #endif
 
-					m_pTextures->setObject(texture, pathKey);
+					cacheTexture(texture, pathKey);
 					// autorelease prevents possible crash in multithreaded environments
 					texture->autorelease();
 				}
@@ -392,7 +734,7 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
                 ccResolutionType resolution;
                 fullpath = CCFileUtils::fullPathFromRelativePath(fullpath.c_str(), &resolution);
 				texture = new CCTexture2D();
-				texture->initWithImage(&image, resolution);
+				initTextureWithImage(texture, &image, resolution, fullpath, bMipmaps);
 
 				if( texture )
 				{
@@ -401,7 +743,7 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
                     VolatileTexture::addImageTexture(texture, fullpath.c_str(), CCImage::kFmtPng);
 #endif
 
-					m_pTextures->setObject(texture, pathKey);
+					cacheTexture(texture, pathKey);
 					// autorelease prevents possible crash in multithreaded environments
 					texture->autorelease();
 				}
@@ -443,7 +785,7 @@ CCTexture2D* CCTextureCache::addPVRTCImage(const char* path, int bpp, bool hasAl
 	if( texture->initWithPVRTCData(data->bytes(), 0, bpp, hasAlpha, width,
                                    (bpp==2 ? kCCTexture2DPixelFormat_PVRTC2 : kCCTexture2DPixelFormat_PVRTC4)))
 	{
-		m_pTextures->setObject(texture, temp);
+		cacheTexture(texture, temp);
 		texture->autorelease();
 	}
 	else
@@ -479,7 +821,7 @@ CCTexture2D * CCTextureCache::addPVRImage(const char* path)
         // cache the texture file name
         VolatileTexture::addImageTexture(tex, fullpath.c_str(), CCImage::kFmtRawData);
 #endif
-		m_pTextures->setObject(tex, key);
+		cacheTexture(tex, key);
 		tex->autorelease();
 	}
 	else
@@ -490,6 +832,47 @@ CCTexture2D * CCTextureCache::addPVRImage(const char* path)
 	return tex;
 }
 
+CCTexture2D * CCTextureCache::addDDSImage(const char* path)
+{
+	CCAssert(path != NULL, "TextureCache: fileimage MUST not be nill");
+
+	CCTexture2D * tex;
+	std::string key(path);
+    // remove possible -HD suffix to prevent caching the same image twice (issue #1040)
+    CCFileUtils::removeSuffixFromFile(key);
+    
+	if( (tex = m_pTextures->objectForKey(key)) ) 
+	{
+		return tex;
+	}
+
+    // Split up directory and filename
+    std::string fullpath = CCFileUtils::fullPathFromRelativePath(key.c_str());
+	tex = new CCTexture2D();
+	if( tex->initWithDDSFile(fullpath.c_str()) )
+	{
+#if CC_ENABLE_CACHE_TEXTTURE_DATA
+        // cache the texture file name
+        VolatileTexture::addImageTexture(tex, fullpath.c_str(), CCImage::kFmtRawData);
+#endif
+		cacheTexture(tex, key);
+		tex->autorelease();
+	}
+	else
+	{
+		CCLOG("cocos2d: Couldn't add DDSImage:%s in CCTextureCache",key.c_str());
+		tex->release();
+		tex = NULL;
+	}
+
+	return tex;
+}
+
+CCSpriteFrame* CCTextureCache::addImageToAtlas(const char *path)
+{
+	return CCDynamicAtlas::sharedDynamicAtlas()->addImage(path);
+}
+
 CCTexture2D* CCTextureCache::addUIImage(CCImage *image, const char *key)
 {
 	CCAssert(image != NULL, "TextureCache: image MUST not be nill");
@@ -519,7 +902,7 @@ CCTexture2D* CCTextureCache::addUIImage(CCImage *image, const char *key)
 
 		if(key && texture)
 		{
-			m_pTextures->setObject(texture, forKey);
+			cacheTexture(texture, forKey);
 			texture->autorelease();
 		}
 		else
@@ -584,6 +967,123 @@ CCTexture2D* CCTextureCache::textureForKey(const char* key)
 	return m_pTextures->objectForKey(strKey);
 }
 
+void CCTextureCache::cacheTexture(CCTexture2D *texture, const std::string& key)
+{
+	m_pTextures->setObject(texture, key);
+
+	std::set<std::string>::iterator it = m_evictedKeys.find(key);
+	if (it != m_evictedKeys.end())
+	{
+		m_evictedKeys.erase(it);
+		m_tResidencyStats.uReloads++;
+	}
+}
+
+void CCTextureCache::setMemoryBudget(unsigned int uBytes)
+{
+	m_uMemoryBudget = uBytes;
+	if (uBytes > 0)
+	{
+		measureResidency();
+		trimToBudget(uBytes);
+	}
+}
+
+void CCTextureCache::frameEnded(void)
+{
+	// the textures drawn from now on belong to the next frame
+	CCTexture2D::setCurrentFrame(++m_uFrame);
+
+	measureResidency();
+	if (m_uMemoryBudget > 0 && m_tResidencyStats.uCurrentBytes > m_uMemoryBudget)
+	{
+		trimToBudget(m_uMemoryBudget);
+		if (m_tResidencyStats.uCurrentBytes > m_uMemoryBudget)
+		{
+			m_tResidencyStats.uOverBudgetFrames++;
+		}
+	}
+}
+
+void CCTextureCache::measureResidency(void)
+{
+	unsigned int uBytes = 0;
+	CCTexture2D *texture;
+	m_pTextures->begin();
+	while ((texture = m_pTextures->next()))
+	{
+		uBytes += texture->getMemorySize();
+	}
+	m_pTextures->end();
+
+	m_tResidencyStats.uCurrentBytes = uBytes;
+	m_tResidencyStats.uPeakBytes = MAX(m_tResidencyStats.uPeakBytes, uBytes);
+}
+
+void CCTextureCache::trimToBudget(unsigned int uBytes)
+{
+	if (m_tResidencyStats.uCurrentBytes <= uBytes)
+	{
+		return;
+	}
+
+	// the textures only the cache retains, least recently drawn first
+	std::vector<std::pair<unsigned int, std::string> > candidates;
+	std::string key;
+	CCTexture2D *texture;
+	m_pTextures->begin();
+	while ((texture = m_pTextures->next(&key)))
+	{
+		if (texture->retainCount() == 1)
+		{
+			candidates.push_back(std::make_pair(texture->getLastUsedFrame(), key));
+		}
+	}
+	m_pTextures->end();
+	std::sort(candidates.begin(), candidates.end());
+
+	for (unsigned int i = 0; i < candidates.size() && m_tResidencyStats.uCurrentBytes > uBytes; ++i)
+	{
+		texture = m_pTextures->objectForKey(candidates[i].second);
+		unsigned int uTextureBytes = texture->getMemorySize();
+		CCLOGINFO("cocos2d: CCTextureCache: evicting %s, last drawn %u frames ago", candidates[i].second.c_str(), m_uFrame - candidates[i].first);
+
+		m_pTextures->removeObjectForKey(candidates[i].second);
+		m_evictedKeys.insert(candidates[i].second);
+
+		m_tResidencyStats.uCurrentBytes -= uTextureBytes;
+		m_tResidencyStats.uEvictions++;
+		m_tResidencyStats.uEvictedBytes += uTextureBytes;
+	}
+}
+
+void CCTextureCache::reloadEvictedTexturesAsync(void)
+{
+	// addImageAsync only loads PNG and JPEG files
+	std::set<std::string> keys(m_evictedKeys);
+	for (std::set<std::string>::iterator it = keys.begin(); it != keys.end(); ++it)
+	{
+		std::string lowerCase(*it);
+		for (unsigned int i = 0; i < lowerCase.length(); ++i)
+		{
+			lowerCase[i] = tolower(lowerCase[i]);
+		}
+
+		if (std::string::npos != lowerCase.find(".png") || std::string::npos != lowerCase.find(".jpg") || std::string::npos != lowerCase.find(".jpeg"))
+		{
+			addImageAsync(it->c_str(), NULL, NULL);
+		}
+	}
+}
+
+void CCTextureCache::resetResidencyStats(void)
+{
+	unsigned int uCurrentBytes = m_tResidencyStats.uCurrentBytes;
+	memset(&m_tResidencyStats, 0, sizeof(m_tResidencyStats));
+	m_tResidencyStats.uCurrentBytes = uCurrentBytes;
+	m_tResidencyStats.uPeakBytes = uCurrentBytes;
+}
+
 void CCTextureCache::reloadAllTextures()
 {
 #if CC_ENABLE_CACHE_TEXTTURE_DATA
@@ -602,21 +1102,30 @@ void CCTextureCache::dumpCachedTextureInfo()
 	{
 		CCTexture2D *tex = m_pTextures->objectForKey(*iter);
 		unsigned int bpp = tex->bitsPerPixelForFormat();
-        // Each texture takes up width * height * bytesPerPixel bytes.
-		unsigned int bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
+        // what the texture takes up on the GPU, mip levels included
+		unsigned int bytes = tex->getMemorySize();
 		totalBytes += bytes;
 		count++;
-		CCLOG("cocos2d: \"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB",
+		CCLOG("cocos2d: \"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp, %lu mips => %lu KB, drawn %lu frames ago",
 			   (*iter).c_str(),
 			   (long)tex->retainCount(),
 			   (long)tex->getName(),
 			   (long)tex->getPixelsWide(),
 			   (long)tex->getPixelsHigh(),
 			   (long)bpp,
-			   (long)bytes / 1024);
+			   (long)tex->getMipmapCount(),
+			   (long)bytes / 1024,
+			   (long)(m_uFrame - tex->getLastUsedFrame()));
 	}
 
 	CCLOG("cocos2d: CCTextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
+	CCLOG("cocos2d: CCTextureCache residency: budget %u KB, peak %u KB, %u evictions for %u KB, %u reloads, %u frames over budget",
+		m_uMemoryBudget / 1024,
+		m_tResidencyStats.uPeakBytes / 1024,
+		m_tResidencyStats.uEvictions,
+		m_tResidencyStats.uEvictedBytes / 1024,
+		m_tResidencyStats.uReloads,
+		m_tResidencyStats.uOverBudgetFrames);
 }
 
 #if CC_ENABLE_CACHE_TEXTTURE_DATA
@@ -765,6 +1274,10 @@ void VolatileTexture::reloadAllTextures()
                     vt->texture->initWithPVRFile(vt->m_strFileName.c_str());
                     CCTexture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
                 } 
+                else if (std::string::npos != lowerCase.find(".dds"))
+                {
+                    vt->texture->initWithDDSFile(vt->m_strFileName.c_str());
+                }
                 else 
                 {
                     CCFileData data(vt->m_strFileName.c_str(), "rb");
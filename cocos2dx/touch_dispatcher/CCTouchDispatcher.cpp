@@ -25,12 +25,14 @@ THE SOFTWARE.
 
 #include "CCTouchDispatcher.h"
 #include "CCTouchHandler.h"
+#include "CCTouchHitIndex.h"
 #include "CCMutableArray.h"
 #include "CCSet.h"
 #include "CCTouch.h"
 #include "CCTexture2D.h"
 #include "support/data_support/ccCArray.h"
 #include "ccMacros.h"
+#include "CCDirector.h"
 #include <algorithm>
 
 /**
@@ -53,6 +55,23 @@ void CCTouchDispatcher::setDispatchEvents(bool bDispatchEvents)
 	m_bDispatchEvents = bDispatchEvents;
 }
 
+bool CCTouchDispatcher::isHitTestIndexEnabled(void)
+{
+	return m_pHitIndex != NULL;
+}
+
+void CCTouchDispatcher::setHitTestIndexEnabled(bool bEnabled)
+{
+	if (bEnabled && ! m_pHitIndex)
+	{
+		m_pHitIndex = new CCTouchHitIndex();
+	}
+	else if (! bEnabled)
+	{
+		CC_SAFE_DELETE(m_pHitIndex);
+	}
+}
+
 static CCTouchDispatcher *pSharedDispatcher = NULL;
 
 CCTouchDispatcher* CCTouchDispatcher::sharedDispatcher(void)
@@ -108,6 +127,8 @@ CCTouchDispatcher::~CCTouchDispatcher(void)
 
 	ccCArrayFree(m_pHandlersToRemove);
 	m_pHandlersToRemove = NULL;	
+
+	CC_SAFE_DELETE(m_pHitIndex);
 }
 
 //
@@ -137,6 +158,11 @@ void CCTouchDispatcher::forceAddHandler(CCTouchHandler *pHandler, CCMutableArray
  	}
 
 	pArray->insertObjectAtIndex(pHandler, u);
+
+	if (m_pHitIndex)
+	{
+		m_pHitIndex->invalidate();
+	}
 }
 
 void CCTouchDispatcher::addStandardDelegate(CCTouchDelegate *pDelegate, int nPriority)
@@ -213,6 +239,11 @@ void CCTouchDispatcher::forceRemoveDelegate(CCTouchDelegate *pDelegate)
 			break;
 		}
 	}
+
+	if (m_pHitIndex)
+	{
+		m_pHitIndex->invalidate();
+	}
 }
 
 void CCTouchDispatcher::removeDelegate(CCTouchDelegate *pDelegate)
@@ -247,6 +278,11 @@ void CCTouchDispatcher::forceRemoveAllDelegates(void)
 {
  	m_pStandardHandlers->removeAllObjects();
  	m_pTargetedHandlers->removeAllObjects();
+
+	if (m_pHitIndex)
+	{
+		m_pHitIndex->invalidate();
+	}
 }
 
 void CCTouchDispatcher::removeAllDelegates(void)
@@ -304,6 +340,11 @@ CCTouchHandler* CCTouchDispatcher::findHandler(CCMutableArray<CCTouchHandler*> *
 void CCTouchDispatcher::rearrangeHandlers(CCMutableArray<CCTouchHandler*> *pArray)
 {
 	std::sort(pArray->begin(), pArray->end(), less);
+
+	if (m_pHitIndex)
+	{
+		m_pHitIndex->invalidate();
+	}
 }
 
 void CCTouchDispatcher::setPriority(int nPriority, CCTouchDelegate *pDelegate)
@@ -350,9 +391,21 @@ void CCTouchDispatcher::touches(CCSet *pTouches, CCEvent *pEvent, unsigned int u
 		for (setIter = pTouches->begin(); setIter != pTouches->end(); ++setIter)
 		{
 			pTouch = (CCTouch *)(*setIter);
+
+			// shortlist the handlers that can claim it, a handler may have moved nodes for the previous touch
+			bool bHitTest = (uIndex == CCTOUCHBEGAN && m_pHitIndex);
+			CCPoint tHitPoint = CCPointZero;
+			if (bHitTest)
+			{
+				tHitPoint = CCDirector::sharedDirector()->convertToGL(pTouch->locationInView());
+				m_pHitIndex->update(m_pTargetedHandlers);
+				m_pHitIndex->query(tHitPoint);
+			}
+
 			CCTargetedTouchHandler *pHandler;
 			CCMutableArray<CCTouchHandler*>::CCMutableArrayIterator arrayIter;
-			for (arrayIter = m_pTargetedHandlers->begin(); arrayIter != m_pTargetedHandlers->end(); ++arrayIter)
+			unsigned int uHandler = 0;
+			for (arrayIter = m_pTargetedHandlers->begin(); arrayIter != m_pTargetedHandlers->end(); ++arrayIter, ++uHandler)
 			/*for (unsigned int i = 0; i < m_pTargetedHandlers->num; ++i)*/
 			{
                 pHandler = (CCTargetedTouchHandler *)(*arrayIter);
@@ -365,6 +418,23 @@ void CCTouchDispatcher::touches(CCSet *pTouches, CCEvent *pEvent, unsigned int u
 				bool bClaimed = false;
 				if (uIndex == CCTOUCHBEGAN)
 				{
+					if (bHitTest && ! m_pHitIndex)
+					{
+						// a delegate turned the index off, offer the touch to all the next ones
+						bHitTest = false;
+					}
+					else if (bHitTest && m_pHitIndex->isStale())
+					{
+						// a delegate moved nodes, bin the handlers that moved again
+						m_pHitIndex->update(m_pTargetedHandlers);
+						m_pHitIndex->query(tHitPoint);
+					}
+
+					if (bHitTest && ! m_pHitIndex->isCandidate(uHandler))
+					{
+						continue;
+					}
+
 					bClaimed = pHandler->getDelegate()->ccTouchBegan(pTouch, pEvent);
 
 					if (bClaimed)
@@ -0,0 +1,278 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCTouchHitIndex.h"
+#include "CCTouchHandler.h"
+#include "CCNode.h"
+#include "ccMacros.h"
+
+#include <math.h>
+
+namespace   cocos2d {
+
+// at most kMaxSide x kMaxSide cells
+#define kMaxSide	32
+
+CCTouchHitIndex::CCTouchHitIndex(void)
+: m_tArea(CCRectZero)
+, m_uSide(0)
+, m_fCellWidth(1)
+, m_fCellHeight(1)
+, m_uStamp(0)
+, m_uEpoch(0)
+, m_uUnkeyed(0)
+, m_bValid(false)
+{
+}
+
+bool CCTouchHitIndex::isStale(void)
+{
+	return ! m_bValid || m_uEpoch != CCNode::getTransformEpoch();
+}
+
+void CCTouchHitIndex::cellRange(const CCRect& tRect, unsigned int& x0, unsigned int& y0, unsigned int& x1, unsigned int& y1)
+{
+	float fMax = (float)(m_uSide - 1);
+	x0 = (unsigned int)MIN(fMax, MAX(0.0f, (CCRect::CCRectGetMinX(tRect) - m_tArea.origin.x) / m_fCellWidth));
+	y0 = (unsigned int)MIN(fMax, MAX(0.0f, (CCRect::CCRectGetMinY(tRect) - m_tArea.origin.y) / m_fCellHeight));
+	x1 = (unsigned int)MIN(fMax, MAX(0.0f, (CCRect::CCRectGetMaxX(tRect) - m_tArea.origin.x) / m_fCellWidth));
+	y1 = (unsigned int)MIN(fMax, MAX(0.0f, (CCRect::CCRectGetMaxY(tRect) - m_tArea.origin.y) / m_fCellHeight));
+}
+
+void CCTouchHitIndex::fetchBounds(Entry& entry, CCTouchHandler *pHandler)
+{
+	entry.bBounded = pHandler && pHandler->getDelegate()->getTouchBounds(entry.tBounds);
+	entry.uEpoch = entry.pNode ? entry.pNode->getWorldTransformEpoch() : 0;
+}
+
+void CCTouchHitIndex::rebuild(CCMutableArray<CCTouchHandler*> *pHandlers)
+{
+	m_uEpoch = CCNode::getTransformEpoch();
+	m_bValid = true;
+	m_uUnkeyed = 0;
+
+	m_tEntries.resize(pHandlers->count());
+	for (unsigned int i = 0; i < m_tEntries.size(); ++i)
+	{
+		Entry &entry = m_tEntries[i];
+		CCTouchHandler *pHandler = pHandlers->getObjectAtIndex(i);
+
+		entry.uStamp = 0;
+		entry.pNode = pHandler ? dynamic_cast<CCNode*>(pHandler->getDelegate()) : NULL;
+		if (pHandler && ! entry.pNode)
+		{
+			m_uUnkeyed++;
+		}
+		fetchBounds(entry, pHandler);
+	}
+
+	m_uStamp = 1;
+	binAll();
+}
+
+void CCTouchHitIndex::update(CCMutableArray<CCTouchHandler*> *pHandlers)
+{
+	if (! m_bValid)
+	{
+		rebuild(pHandlers);
+		return;
+	}
+
+	unsigned int uEpoch = CCNode::getTransformEpoch();
+	if (uEpoch == m_uEpoch && m_uUnkeyed == 0)
+	{
+		return;
+	}
+	m_uEpoch = uEpoch;
+
+	// only the handlers whose delegate, its ancestors or descendants moved are binned again
+	bool bLeftArea = false;
+	for (unsigned int i = 0; i < m_tEntries.size(); ++i)
+	{
+		Entry &entry = m_tEntries[i];
+		if (entry.pNode && entry.pNode->getWorldTransformEpoch() == entry.uEpoch)
+		{
+			continue;
+		}
+
+		unbin(i);
+		fetchBounds(entry, pHandlers->getObjectAtIndex(i));
+		if (! entry.bBounded)
+		{
+			continue;
+		}
+
+		const CCRect &r = entry.tBounds;
+		if (m_uSide == 0
+			|| CCRect::CCRectGetMinX(r) < CCRect::CCRectGetMinX(m_tArea) || CCRect::CCRectGetMaxX(r) > CCRect::CCRectGetMaxX(m_tArea)
+			|| CCRect::CCRectGetMinY(r) < CCRect::CCRectGetMinY(m_tArea) || CCRect::CCRectGetMaxY(r) > CCRect::CCRectGetMaxY(m_tArea))
+		{
+			bLeftArea = true;
+		}
+		else
+		{
+			bin(i);
+		}
+	}
+
+	// the grid is sized for the area the handlers cover
+	if (bLeftArea)
+	{
+		binAll();
+	}
+}
+
+void CCTouchHitIndex::binAll(void)
+{
+	unsigned int uBounded = 0;
+	float fMinX = 0, fMinY = 0, fMaxX = 0, fMaxY = 0;
+
+	for (unsigned int i = 0; i < m_tEntries.size(); ++i)
+	{
+		if (! m_tEntries[i].bBounded)
+		{
+			continue;
+		}
+
+		const CCRect &r = m_tEntries[i].tBounds;
+		if (uBounded == 0)
+		{
+			fMinX = CCRect::CCRectGetMinX(r);
+			fMinY = CCRect::CCRectGetMinY(r);
+			fMaxX = CCRect::CCRectGetMaxX(r);
+			fMaxY = CCRect::CCRectGetMaxY(r);
+		}
+		else
+		{
+			fMinX = MIN(fMinX, CCRect::CCRectGetMinX(r));
+			fMinY = MIN(fMinY, CCRect::CCRectGetMinY(r));
+			fMaxX = MAX(fMaxX, CCRect::CCRectGetMaxX(r));
+			fMaxY = MAX(fMaxY, CCRect::CCRectGetMaxY(r));
+		}
+		uBounded++;
+	}
+
+	m_uSide = 0;
+	if (uBounded == 0)
+	{
+		m_tCells.clear();
+		return;
+	}
+
+	// about one handler per cell when they are spread out
+	m_uSide = (unsigned int)ceilf(sqrtf((float)uBounded));
+	m_uSide = MIN(MAX(m_uSide, 1u), (unsigned int)kMaxSide);
+	m_tArea = CCRectMake(fMinX, fMinY, fMaxX - fMinX, fMaxY - fMinY);
+	m_fCellWidth = m_tArea.size.width > 0 ? m_tArea.size.width / m_uSide : 1.0f;
+	m_fCellHeight = m_tArea.size.height > 0 ? m_tArea.size.height / m_uSide : 1.0f;
+
+	m_tCells.resize(m_uSide * m_uSide);
+	for (unsigned int c = 0; c < m_tCells.size(); ++c)
+	{
+		m_tCells[c].clear();
+	}
+
+	for (unsigned int i = 0; i < m_tEntries.size(); ++i)
+	{
+		if (m_tEntries[i].bBounded)
+		{
+			bin(i);
+		}
+	}
+}
+
+void CCTouchHitIndex::bin(unsigned int uIndex)
+{
+	Entry &entry = m_tEntries[uIndex];
+	cellRange(entry.tBounds, entry.x0, entry.y0, entry.x1, entry.y1);
+
+	for (unsigned int y = entry.y0; y <= entry.y1; ++y)
+	{
+		for (unsigned int x = entry.x0; x <= entry.x1; ++x)
+		{
+			m_tCells[y * m_uSide + x].push_back(uIndex);
+		}
+	}
+}
+
+void CCTouchHitIndex::unbin(unsigned int uIndex)
+{
+	Entry &entry = m_tEntries[uIndex];
+	if (! entry.bBounded || m_uSide == 0)
+	{
+		return;
+	}
+
+	for (unsigned int y = entry.y0; y <= entry.y1; ++y)
+	{
+		for (unsigned int x = entry.x0; x <= entry.x1; ++x)
+		{
+			// the order of a cell doesn't matter
+			std::vector<unsigned int> &cell = m_tCells[y * m_uSide + x];
+			for (unsigned int k = 0; k < cell.size(); ++k)
+			{
+				if (cell[k] == uIndex)
+				{
+					cell[k] = cell.back();
+					cell.pop_back();
+					break;
+				}
+			}
+		}
+	}
+}
+
+void CCTouchHitIndex::query(const CCPoint& tPoint)
+{
+	if (++m_uStamp == 0)
+	{
+		// wrapped, forget the old stamps
+		for (unsigned int i = 0; i < m_tEntries.size(); ++i)
+		{
+			m_tEntries[i].uStamp = 0;
+		}
+		m_uStamp = 1;
+	}
+
+	if (m_uSide == 0)
+	{
+		return;
+	}
+
+	// a point out of the grid falls in a border cell and its handlers reject it
+	unsigned int x, y, x1, y1;
+	cellRange(CCRectMake(tPoint.x, tPoint.y, 0, 0), x, y, x1, y1);
+
+	const std::vector<unsigned int> &cell = m_tCells[y * m_uSide + x];
+	for (unsigned int i = 0; i < cell.size(); ++i)
+	{
+		Entry &entry = m_tEntries[cell[i]];
+		if (CCRect::CCRectContainsPoint(entry.tBounds, tPoint))
+		{
+			entry.uStamp = m_uStamp;
+		}
+	}
+}
+
+}//namespace   cocos2d 
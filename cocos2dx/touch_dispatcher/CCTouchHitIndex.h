@@ -0,0 +1,108 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __TOUCH_DISPATCHER_CCTOUCH_HIT_INDEX_H__
+#define __TOUCH_DISPATCHER_CCTOUCH_HIT_INDEX_H__
+
+#include "CCGeometry.h"
+#include "CCMutableArray.h"
+
+#include <vector>
+
+namespace   cocos2d {
+
+class CCTouchHandler;
+class CCNode;
+
+/** @brief Uniform grid of the touch bounds of the targeted handlers, in world space.
+Used by CCTouchDispatcher to offer a beginning touch only to the handlers that can claim it,
+see CCTouchDelegate::getTouchBounds(). The handlers without bounds are always offered it.
+*/
+class CCTouchHitIndex
+{
+public:
+	CCTouchHitIndex(void);
+
+	/** asks the delegates of pHandlers for their bounds, the handlers are then known by their index */
+	void rebuild(CCMutableArray<CCTouchHandler*> *pHandlers);
+
+	/** asks again for the bounds of the delegates that moved since the last update and bins them
+	again, or rebuilds the grid if the handlers were invalidated or one left the grid area
+	*/
+	void update(CCMutableArray<CCTouchHandler*> *pHandlers);
+
+	/** the handlers were added, removed or reordered */
+	inline void invalidate(void) { m_bValid = false; }
+
+	/** whether a node moved since the last update */
+	bool isStale(void);
+
+	/** finds the handlers that can claim a touch beginning at tPoint, in points */
+	void query(const CCPoint& tPoint);
+
+	/** after query(), whether the uIndex-th handler has to be offered the touch */
+	inline bool isCandidate(unsigned int uIndex)
+	{
+		return uIndex >= m_tEntries.size() || ! m_tEntries[uIndex].bBounded || m_tEntries[uIndex].uStamp == m_uStamp;
+	}
+
+private:
+	struct Entry
+	{
+		CCRect tBounds;
+		bool bBounded;
+		//! m_uStamp of the last query the bounds contained
+		unsigned int uStamp;
+		//! the delegate when it is a node, NULL otherwise
+		CCNode *pNode;
+		//! getWorldTransformEpoch() of pNode when the bounds were asked
+		unsigned int uEpoch;
+		//! cells the handler is in
+		unsigned int x0, y0, x1, y1;
+	};
+
+	void fetchBounds(Entry& entry, CCTouchHandler *pHandler);
+	void binAll(void);
+	void bin(unsigned int uIndex);
+	void unbin(unsigned int uIndex);
+	void cellRange(const CCRect& tRect, unsigned int& x0, unsigned int& y0, unsigned int& x1, unsigned int& y1);
+
+	std::vector<Entry> m_tEntries;
+	//! indices of the bounded handlers overlapping each cell, row by row
+	std::vector< std::vector<unsigned int> > m_tCells;
+	CCRect m_tArea;
+	unsigned int m_uSide;
+	float m_fCellWidth;
+	float m_fCellHeight;
+
+	unsigned int m_uStamp;
+	unsigned int m_uEpoch;
+	//! bounded delegates that aren't nodes, asked for their bounds on every update
+	unsigned int m_uUnkeyed;
+	bool m_bValid;
+};
+
+}//namespace   cocos2d 
+
+#endif // __TOUCH_DISPATCHER_CCTOUCH_HIT_INDEX_H__
@@ -498,6 +498,9 @@ void GLESDebugDraw::Render()
 	XMMATRIX viewMatrix, projectionMatrix;
 	bool result;
 
+	// the queued draws go first
+	CCRenderQueue::sharedRenderQueue()->flush();
+
 	// Get the world, view, and projection matrices from the camera and d3d objects.
 	CCD3DCLASS->GetViewMatrix(viewMatrix);
 	CCD3DCLASS->GetProjectionMatrix(projectionMatrix);
@@ -514,4 +517,7 @@ void GLESDebugDraw::Render()
 
 	// Now render the prepared buffers with the shader.
 	RenderShader();
+
+	// the states were bound without the render queue
+	CCRenderQueue::sharedRenderQueue()->invalidateState();
 }
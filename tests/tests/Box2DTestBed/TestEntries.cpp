@@ -43,6 +43,7 @@ using namespace std;
 #include "Tests/EdgeShapes.h"
 #include "Tests/EdgeTest.h"
 #include "Tests/Gears.h"
+#include "Tests/ManyIslands.h"
 #include "Tests/OneSidedPlatform.h"
 #include "Tests/Pinball.h"
 #include "Tests/PolyCollision.h"
@@ -52,6 +53,7 @@ using namespace std;
 #include "Tests/Pyramid.h"
 #include "Tests/RayCast.h"
 #include "Tests/Revolute.h"
+#include "Tests/Rollback.h"
 //#include "Tests/Rope.h"
 #include "Tests/RopeJoint.h"
 #include "Tests/SensorTest.h"
@@ -114,6 +116,8 @@ TestEntry g_testEntries[] =
 	{"Slider Crank", SliderCrank::Create},
 	{"Varying Friction", VaryingFriction::Create},
 	{"Add Pair Stress Test", AddPair::Create},
+	{"Many Islands", ManyIslands::Create},
+	{"Rollback", Rollback::Create},
 //	{NULL, NULL}
 };
 
@@ -0,0 +1,126 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef MANY_ISLANDS_H
+#define MANY_ISLANDS_H
+
+// 300 separate piles of debris on ledges, so the world has 300 islands to solve.
+// The world alternates between one thread and all the hardware threads
+// every e_period steps and shows the average collide and solve times of both.
+class ManyIslands : public Test
+{
+public:
+
+	enum
+	{
+		e_columns = 20,
+		e_rows = 15,
+		e_pileHeight = 4,
+		e_period = 120
+	};
+
+	ManyIslands()
+	{
+		b2Body* ground = NULL;
+		{
+			b2BodyDef bd;
+			ground = m_world->CreateBody(&bd);
+		}
+
+		b2PolygonShape ledge;
+		b2PolygonShape debris;
+		debris.SetAsBox(0.2f, 0.2f);
+
+		for (int32 i = 0; i < e_columns; ++i)
+		{
+			for (int32 j = 0; j < e_rows; ++j)
+			{
+				b2Vec2 position(-38.0f + 4.0f * i, 2.0f + 3.0f * j);
+
+				ledge.SetAsBox(1.5f, 0.1f, position, 0.0f);
+				ground->CreateFixture(&ledge, 0.0f);
+
+				for (int32 k = 0; k < e_pileHeight; ++k)
+				{
+					b2BodyDef bd;
+					bd.type = b2_dynamicBody;
+					// Keep the islands awake, sleeping piles cost nothing to solve.
+					bd.allowSleep = false;
+					bd.position.Set(position.x + 0.1f * RandomFloat(), position.y + 0.3f + 0.45f * k);
+					b2Body* body = m_world->CreateBody(&bd);
+					body->CreateFixture(&debris, 1.0f);
+				}
+			}
+		}
+
+		// 0 picks the number of hardware threads.
+		m_world->SetThreadCount(0);
+		m_parallelThreadCount = m_world->GetThreadCount();
+		m_world->SetThreadCount(1);
+
+		for (int32 i = 0; i < 2; ++i)
+		{
+			m_collideTime[i] = 0.0f;
+			m_solveTime[i] = 0.0f;
+			m_solveSteps[i] = 0;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		int32 mode = (m_stepCount / e_period) % 2;
+		m_world->SetThreadCount(mode == 0 ? 1 : m_parallelThreadCount);
+
+		Test::Step(settings);
+
+		const b2Profile& p = m_world->GetProfile();
+		m_collideTime[mode] += p.collide;
+		m_solveTime[mode] += p.solve;
+		++m_solveSteps[mode];
+
+		for (int32 i = 0; i < 2; ++i)
+		{
+			float32 scale = m_solveSteps[i] > 0 ? 1.0f / m_solveSteps[i] : 0.0f;
+			m_debugDraw.DrawString(5, m_textLine, "%d thread(s)%s: collide %5.2f ms, solve %5.2f ms [ave]",
+				i == 0 ? 1 : m_parallelThreadCount, i == mode ? " (running)" : "",
+				scale * m_collideTime[i], scale * m_solveTime[i]);
+			m_textLine += 15;
+		}
+
+		m_debugDraw.DrawString(5, m_textLine, "islands = %d", p.islandCount);
+		m_textLine += 15;
+
+		for (int32 i = 0; i < p.threadCount; ++i)
+		{
+			m_debugDraw.DrawString(5, m_textLine, "thread %d: %d islands, %5.2f ms", i, p.threadIslands[i], p.threadSolve[i]);
+			m_textLine += 15;
+		}
+	}
+
+	static Test* Create()
+	{
+		return new ManyIslands;
+	}
+
+	int32 m_parallelThreadCount;
+	float32 m_collideTime[2];
+	float32 m_solveTime[2];
+	int32 m_solveSteps[2];
+};
+
+#endif
@@ -19,12 +19,16 @@
 #ifndef PYRAMID_H
 #define PYRAMID_H
 
+// Also a benchmark of the contact solver: every e_period steps the world switches
+// between the sequential and the batched (SIMD) contact solver and the average
+// velocity and position solve times of both are shown.
 class Pyramid : public Test
 {
 public:
 	enum
 	{
-		e_count = 20
+		e_count = 20,
+		e_period = 120
 	};
 
 	Pyramid()
@@ -56,6 +60,8 @@ public:
 				{
 					b2BodyDef bd;
 					bd.type = b2_dynamicBody;
+					// Keep the stack awake so the solver is timed all along.
+					bd.allowSleep = false;
 					bd.position = y;
 					b2Body* body = m_world->CreateBody(&bd);
 					body->CreateFixture(&shape, 5.0f);
@@ -66,12 +72,36 @@ public:
 				x += deltaX;
 			}
 		}
+
+		for (int32 i = 0; i < 2; ++i)
+		{
+			m_velocityTime[i] = 0.0f;
+			m_positionTime[i] = 0.0f;
+			m_solveSteps[i] = 0;
+		}
 	}
 
 	void Step(Settings* settings)
 	{
+		int32 mode = (m_stepCount / e_period) % 2;
+		m_world->SetSIMDContacts(mode == 1);
+
 		Test::Step(settings);
 
+		const b2Profile& p = m_world->GetProfile();
+		m_velocityTime[mode] += p.solveVelocity;
+		m_positionTime[mode] += p.solvePosition;
+		++m_solveSteps[mode];
+
+		for (int32 i = 0; i < 2; ++i)
+		{
+			float32 scale = m_solveSteps[i] > 0 ? 1.0f / m_solveSteps[i] : 0.0f;
+			m_debugDraw.DrawString(5, m_textLine, "%s%s: velocity %5.2f ms, position %5.2f ms [ave]",
+				i == 0 ? "sequential" : "SIMD", i == mode ? " (running)" : "",
+				scale * m_velocityTime[i], scale * m_positionTime[i]);
+			m_textLine += 15;
+		}
+
 		//b2DynamicTree* tree = &m_world->m_contactManager.m_broadPhase.m_tree;
 
 		//if (m_stepCount == 400)
@@ -84,6 +114,10 @@ public:
 	{
 		return new Pyramid;
 	}
+
+	float32 m_velocityTime[2];
+	float32 m_positionTime[2];
+	int32 m_solveSteps[2];
 };
 
 #endif
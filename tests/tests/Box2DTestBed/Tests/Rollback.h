@@ -0,0 +1,204 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+// After every step the world is rewound e_rewindSteps steps with a snapshot
+// and simulated again, like a networked game does when late input arrives.
+// The resimulated state is compared byte-for-byte with the state before the
+// rewind. Creating or destroying bodies and joints, e.g. with the mouse or a
+// bomb, invalidates the older snapshots, so the history starts over then.
+class Rollback : public Test
+{
+public:
+
+	enum
+	{
+		e_rewindSteps = 8,
+		e_pyramidRows = 12,
+		e_bridgePlanks = 20
+	};
+
+	Rollback()
+	{
+		b2Body* ground = NULL;
+		{
+			b2BodyDef bd;
+			ground = m_world->CreateBody(&bd);
+
+			b2EdgeShape shape;
+			shape.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+			ground->CreateFixture(&shape, 0.0f);
+		}
+
+		{
+			b2PolygonShape shape;
+			shape.SetAsBox(0.5f, 0.5f);
+
+			b2Vec2 x(-20.0f, 0.75f);
+			b2Vec2 deltaX(0.5625f, 1.25f);
+			b2Vec2 deltaY(1.125f, 0.0f);
+
+			for (int32 i = 0; i < e_pyramidRows; ++i)
+			{
+				b2Vec2 y = x;
+
+				for (int32 j = i; j < e_pyramidRows; ++j)
+				{
+					b2BodyDef bd;
+					bd.type = b2_dynamicBody;
+					bd.position = y;
+					b2Body* body = m_world->CreateBody(&bd);
+					body->CreateFixture(&shape, 5.0f);
+
+					y += deltaY;
+				}
+
+				x += deltaX;
+			}
+		}
+
+		{
+			b2PolygonShape shape;
+			shape.SetAsBox(0.5f, 0.125f);
+
+			b2RevoluteJointDef jd;
+
+			b2Body* prevBody = ground;
+			for (int32 i = 0; i < e_bridgePlanks; ++i)
+			{
+				b2BodyDef bd;
+				bd.type = b2_dynamicBody;
+				bd.position.Set(5.5f + 1.0f * i, 10.0f);
+				b2Body* body = m_world->CreateBody(&bd);
+				body->CreateFixture(&shape, 20.0f);
+
+				jd.Initialize(prevBody, body, b2Vec2(5.0f + 1.0f * i, 10.0f));
+				m_world->CreateJoint(&jd);
+
+				prevBody = body;
+			}
+
+			jd.Initialize(prevBody, ground, b2Vec2(5.0f + 1.0f * e_bridgePlanks, 10.0f));
+			m_world->CreateJoint(&jd);
+		}
+
+		{
+			b2CircleShape shape;
+			shape.m_radius = 0.5f;
+
+			for (int32 i = 0; i < 10; ++i)
+			{
+				b2BodyDef bd;
+				bd.type = b2_dynamicBody;
+				bd.position.Set(8.0f + 1.5f * i, 15.0f + 1.0f * i);
+				b2Body* body = m_world->CreateBody(&bd);
+				body->CreateFixture(&shape, 1.0f);
+			}
+		}
+
+		m_recordedSteps = 0;
+		m_rewinds = 0;
+		m_mismatches = 0;
+		m_restoreTime = 0.0f;
+		m_resimulateTime = 0.0f;
+	}
+
+	void Step(Settings* settings)
+	{
+		// m_history[i % e_rewindSteps] holds the state before step i.
+		int32 stepCount = m_stepCount;
+		m_world->SaveSnapshot(m_history + stepCount % e_rewindSteps);
+
+		Test::Step(settings);
+
+		// The resimulation doesn't replay paused steps or the mouse input.
+		if (m_stepCount == stepCount || m_mouseJoint)
+		{
+			m_recordedSteps = 0;
+		}
+		else
+		{
+			++m_recordedSteps;
+		}
+
+		if (m_recordedSteps >= e_rewindSteps)
+		{
+			Rewind(settings);
+		}
+
+		float32 scale = m_rewinds > 0 ? 1.0f / m_rewinds : 0.0f;
+		m_debugDraw.DrawString(5, m_textLine, "rewind %d steps: restore %5.3f ms, resimulate %5.2f ms [ave]",
+			e_rewindSteps, scale * m_restoreTime, scale * m_resimulateTime);
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "snapshot = %d bytes, rewinds = %d, mismatches = %d",
+			m_current.GetSize(), m_rewinds, m_mismatches);
+		m_textLine += 15;
+	}
+
+	void Rewind(Settings* settings)
+	{
+		m_world->SaveSnapshot(&m_current);
+
+		b2Timer timer;
+		if (m_world->RestoreSnapshot(m_history + m_stepCount % e_rewindSteps) == false)
+		{
+			// Bodies or joints were created or destroyed since.
+			m_recordedSteps = 0;
+			return;
+		}
+		m_restoreTime += timer.GetMilliseconds();
+
+		// Test draws the contact points of the real step.
+		m_world->SetContactListener(NULL);
+
+		timer.Reset();
+		float32 timeStep = 1.0f / settings->hz;
+		for (int32 i = 0; i < e_rewindSteps; ++i)
+		{
+			m_world->Step(timeStep, settings->velocityIterations, settings->positionIterations);
+		}
+		m_resimulateTime += timer.GetMilliseconds();
+
+		m_world->SetContactListener(this);
+
+		m_world->SaveSnapshot(&m_resimulated);
+		if (m_resimulated.IsEqual(m_current) == false)
+		{
+			++m_mismatches;
+		}
+		++m_rewinds;
+	}
+
+	static Test* Create()
+	{
+		return new Rollback;
+	}
+
+	b2Snapshot m_history[e_rewindSteps];
+	b2Snapshot m_current;
+	b2Snapshot m_resimulated;
+	int32 m_recordedSteps;
+	int32 m_rewinds;
+	int32 m_mismatches;
+	float32 m_restoreTime;
+	float32 m_resimulateTime;
+};
+
+#endif
@@ -0,0 +1,174 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+ 
+// Benchmark of the spatial indexes on a scene that mixes very large and
+// very small shapes. The same scene is simulated in three spaces: one with
+// the default bounding box trees, one with spatial hashes tuned for the
+// debris and one with spatial hashes at the old default cell size.
+// Only the first one is drawn, the step times of all three are shown.
+ 
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include "chipmunk.h"
+#include "drawSpace.h"
+#include "ChipmunkDemo.h"
+
+#define NUM_SPACES 3
+
+static cpSpace *space;
+static cpSpace *spaces[NUM_SPACES];
+
+// Cell sizes of the spatial hashes, 0 for the trees.
+static const cpFloat cellSizes[NUM_SPACES] = {0.0f, 10.0f, 100.0f};
+
+static clock_t stepClocks[NUM_SPACES];
+static int timedSteps = 0;
+
+// Put the debris that left the screen back on top.
+static void
+eachBody(cpBody *body, void *unused)
+{
+	if(body->p.y < -260 || cpfabs(body->p.x) > 340){
+		body->p = cpv(-0.5f*body->p.x, 260);
+		body->v = cpvzero;
+	}
+}
+
+static void
+update(int ticks)
+{
+	cpFloat dt = 1.0f/60.0f;
+	
+	for(int i=0; i<NUM_SPACES; i++){
+		clock_t start = clock();
+		cpSpaceStep(spaces[i], dt);
+		stepClocks[i] += clock() - start;
+		
+		cpSpaceEachBody(spaces[i], &eachBody, NULL);
+	}
+	
+	if(++timedSteps == 60){
+		cpFloat ms = 1000.0f/(cpFloat)CLOCKS_PER_SEC/(cpFloat)timedSteps;
+		sprintf(messageString,
+			"ms/step - BB tree: %.2f, spatial hash (cells of 10): %.2f, spatial hash (cells of 100): %.2f",
+			stepClocks[0]*ms, stepClocks[1]*ms, stepClocks[2]*ms
+		);
+		
+		for(int i=0; i<NUM_SPACES; i++) stepClocks[i] = 0;
+		timedSteps = 0;
+	}
+}
+
+static void
+addBox(cpSpace *space, cpVect pos, cpFloat width, cpFloat height)
+{
+	cpFloat mass = width*height/100.0f;
+	cpBody *body = cpSpaceAddBody(space, cpBodyNew(mass, cpMomentForBox(mass, width, height)));
+	body->p = pos;
+	
+	cpShape *shape = cpSpaceAddShape(space, cpBoxShapeNew(body, width, height));
+	shape->e = 0.0f; shape->u = 0.7f;
+}
+
+static void
+buildScene(cpSpace *space)
+{
+	// Same shapes in the same order in both spaces.
+	cpResetShapeIdCounter();
+	srand(5);
+	
+	space->iterations = 5;
+	space->gravity = cpv(0, -300);
+	
+	cpBody *body, *staticBody = &space->staticBody;
+	cpShape *shape;
+	
+	// Long terrain segments, each covers a large part of the screen.
+	cpVect terrain[] = {
+		cpv(-320, -100), cpv(-160, -220), cpv(0, -180), cpv(160, -230), cpv(320, -90),
+	};
+	
+	for(int i=0; i<4; i++){
+		shape = cpSpaceAddShape(space, cpSegmentShapeNew(staticBody, terrain[i], terrain[i + 1], 2.0f));
+		shape->e = 0.0f; shape->u = 1.0f;
+		shape->layers = NOT_GRABABLE_MASK;
+	}
+	
+	// Two big static platforms.
+	cpVect platform[] = {cpv(-90,-12), cpv(-90, 12), cpv(90, 12), cpv(90,-12)};
+	for(int i=0; i<2; i++){
+		shape = cpSpaceAddShape(space, cpPolyShapeNew(staticBody, 4, platform, cpv(i*320 - 160, 20 - i*60)));
+		shape->e = 0.0f; shape->u = 1.0f;
+		shape->layers = NOT_GRABABLE_MASK;
+	}
+	
+	// Large boxes of different sizes.
+	for(int i=0; i<8; i++){
+		addBox(space, cpv(i*80 - 280, 150 + (i%2)*120), 40.0f + 100.0f*frand(), 30.0f + 60.0f*frand());
+	}
+	
+	// Lots of tiny debris.
+	for(int i=0; i<600; i++){
+		cpFloat radius = 2.0f + 2.0f*frand();
+		body = cpSpaceAddBody(space, cpBodyNew(1.0f, cpMomentForCircle(1.0f, 0.0f, radius, cpvzero)));
+		body->p = cpv(frand()*640 - 320, frand()*300 + 260);
+		
+		shape = cpSpaceAddShape(space, cpCircleShapeNew(body, radius, cpvzero));
+		shape->e = 0.0f; shape->u = 0.4f;
+	}
+}
+
+static cpSpace *
+init(void)
+{
+	for(int i=0; i<NUM_SPACES; i++){
+		spaces[i] = cpSpaceNew();
+		if(cellSizes[i]) cpSpaceUseSpatialHash(spaces[i], cellSizes[i], 4999);
+		buildScene(spaces[i]);
+		
+		stepClocks[i] = 0;
+	}
+	
+	timedSteps = 0;
+	
+	space = spaces[0];
+	return space;
+}
+
+static void
+destroy(void)
+{
+	for(int i=0; i<NUM_SPACES; i++){
+		cpSpaceFreeChildren(spaces[i]);
+		cpSpaceFree(spaces[i]);
+	}
+}
+
+chipmunkDemo MixedSizes = {
+	"Mixed Sizes",
+	NULL,
+	init,
+	update,
+	destroy,
+};
@@ -0,0 +1,155 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+ 
+// Benchmark of the impulse solvers. The same stacks of boxes and chains of
+// joints are simulated with the serial solver, the batched solver on a
+// single thread and the batched solver on 4 threads. Only the first space
+// is drawn, the step times of all three are shown. They are wall clock
+// times, clock() adds up the time of all the threads on some platforms.
+ 
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "cocos2d.h"
+#include "chipmunk.h"
+#include "drawSpace.h"
+#include "ChipmunkDemo.h"
+
+#define NUM_SPACES 3
+
+static cpSpace *space;
+static cpSpace *spaces[NUM_SPACES];
+
+// Threads of the batched solvers, 0 for the serial solver.
+static const int solverThreads[NUM_SPACES] = {0, 1, 4};
+
+// In microseconds.
+static long stepTimes[NUM_SPACES];
+static int timedSteps = 0;
+
+static void
+update(int ticks)
+{
+	cpFloat dt = 1.0f/60.0f;
+	
+	for(int i=0; i<NUM_SPACES; i++){
+		cocos2d::cc_timeval start, end;
+		cocos2d::CCTime::gettimeofdayCocos2d(&start, NULL);
+		cpSpaceStep(spaces[i], dt);
+		cocos2d::CCTime::gettimeofdayCocos2d(&end, NULL);
+		
+		stepTimes[i] += (end.tv_sec - start.tv_sec)*1000000 + (end.tv_usec - start.tv_usec);
+	}
+	
+	if(++timedSteps == 60){
+		cpFloat ms = 0.001f/(cpFloat)timedSteps;
+		// The threads actually started, the pool falls back to fewer when it can't start them.
+		sprintf(messageString,
+			"ms/step - serial: %.2f, batched: %.2f, batched on %d threads: %.2f",
+			stepTimes[0]*ms, stepTimes[1]*ms, cpSpaceGetSolverThreadCount(spaces[2]), stepTimes[2]*ms
+		);
+		
+		for(int i=0; i<NUM_SPACES; i++) stepTimes[i] = 0;
+		timedSteps = 0;
+	}
+}
+
+static void
+buildScene(cpSpace *space)
+{
+	// Same shapes in the same order in all the spaces.
+	cpResetShapeIdCounter();
+	
+	space->iterations = 10;
+	space->gravity = cpv(0, -300);
+	
+	cpBody *body, *staticBody = &space->staticBody;
+	cpShape *shape;
+	
+	shape = cpSpaceAddShape(space, cpSegmentShapeNew(staticBody, cpv(-320,-240), cpv(320,-240), 0.0f));
+	shape->e = 0.0f; shape->u = 1.0f;
+	shape->layers = NOT_GRABABLE_MASK;
+	
+	// Rows of pyramids, lots of contacts touching the same bodies.
+	for(int p=0; p<4; p++){
+		for(int i=0; i<12; i++){
+			for(int j=0; j<=i; j++){
+				body = cpSpaceAddBody(space, cpBodyNew(1.0f, cpMomentForBox(1.0f, 12.0f, 12.0f)));
+				body->p = cpv(p*160 - 240 + j*13 - i*6.5f, -60 - i*13);
+				
+				shape = cpSpaceAddShape(space, cpBoxShapeNew(body, 12.0f, 12.0f));
+				shape->e = 0.0f; shape->u = 0.8f;
+			}
+		}
+	}
+	
+	// Chains hanging from the top of the screen, to have constraints too.
+	for(int c=0; c<8; c++){
+		cpBody *prev = staticBody;
+		cpVect anchor = cpv(c*80 - 280, 220);
+		
+		for(int i=0; i<12; i++){
+			body = cpSpaceAddBody(space, cpBodyNew(1.0f, cpMomentForCircle(1.0f, 0.0f, 4.0f, cpvzero)));
+			body->p = cpv(anchor.x + (i + 1)*10.0f, anchor.y);
+			
+			shape = cpSpaceAddShape(space, cpCircleShapeNew(body, 4.0f, cpvzero));
+			shape->e = 0.0f; shape->u = 0.5f;
+			
+			cpSpaceAddConstraint(space, cpPivotJointNew(prev, body, cpv(anchor.x + (i + 0.5f)*10.0f, anchor.y)));
+			prev = body;
+		}
+	}
+}
+
+static cpSpace *
+init(void)
+{
+	for(int i=0; i<NUM_SPACES; i++){
+		spaces[i] = cpSpaceNew();
+		if(solverThreads[i]) cpSpaceUseBatchedSolver(spaces[i], solverThreads[i]);
+		buildScene(spaces[i]);
+		
+		stepTimes[i] = 0;
+	}
+	
+	timedSteps = 0;
+	
+	space = spaces[0];
+	return space;
+}
+
+static void
+destroy(void)
+{
+	for(int i=0; i<NUM_SPACES; i++){
+		cpSpaceFreeChildren(spaces[i]);
+		cpSpaceFree(spaces[i]);
+	}
+}
+
+chipmunkDemo SolverThroughput = {
+	"Solver Throughput",
+	NULL,
+	init,
+	update,
+	destroy,
+};
@@ -69,6 +69,8 @@ extern chipmunkDemo Player;
 extern chipmunkDemo Sensors;
 extern chipmunkDemo Joints;
 extern chipmunkDemo Tank;
+extern chipmunkDemo MixedSizes;
+extern chipmunkDemo SolverThroughput;
 
 //extern chipmunkDemo Test;
 
@@ -92,6 +94,8 @@ static chipmunkDemo *demos[] = {
 	&Sensors,
 	&Joints,
 	&Tank,
+	&MixedSizes,
+	&SolverThroughput,
 };
 
 static int maxDemos = sizeof(demos) / sizeof(demos[0]);
@@ -439,8 +439,12 @@ hash_func(cpHashValue x, cpHashValue y, cpHashValue n)
 }
 
 static void
-drawSpatialHash(cpSpaceHash *hash)
+drawSpatialHash(cpSpatialIndex *index)
 {
+	// Nothing to draw for the other index types.
+	cpSpaceHash *hash = cpSpaceHashFromIndex(index);
+	if(!hash) return;
+	
 	cpBB bb = cpBBNew(-320, -240, 320, 240);
 	
 	cpFloat dim = hash->celldim;
@@ -479,15 +483,15 @@ drawSpace(cpSpace *space, drawSpaceOptions *options)
 	
 	glLineWidth(options->lineThickness);
 	if(options->drawShapes){
-		cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)drawObject, space);
-		cpSpaceHashEach(space->staticShapes, (cpSpaceHashIterator)drawObject, space);
+		cpSpatialIndexEach(space->activeShapes, (cpSpatialIndexIterator)drawObject, space);
+		cpSpatialIndexEach(space->staticShapes, (cpSpatialIndexIterator)drawObject, space);
 	}
 	
 	glLineWidth(1.0f);
 	if(options->drawBBs){
 		glColor4f(0.3f, 0.5f, 0.3f,1);
-		cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)drawBB, NULL);
-		cpSpaceHashEach(space->staticShapes, (cpSpaceHashIterator)drawBB, NULL);
+		cpSpatialIndexEach(space->activeShapes, (cpSpatialIndexIterator)drawBB, NULL);
+		cpSpatialIndexEach(space->staticShapes, (cpSpatialIndexIterator)drawBB, NULL);
 	}
 
 	cpArray *constraints = space->constraints;
@@ -1,6 +1,7 @@
 #include "CocosDenshionTest.h"
 #include "cocos2d.h"
 #include "SimpleAudioEngine.h"
+#include "AudioMixer.h"
 
 // android effect only support ogg
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
@@ -46,7 +47,8 @@ m_nSoundId(0)
 		"resume effect",
 		"pause all effects",
 		"resume all effects",
-		"stop all effects"
+		"stop all effects",
+		"mixer benchmark"
 	};
 
 	// add menu items for tests
@@ -180,10 +182,56 @@ void CocosDenshionTest::menuCallback(CCObject * pSender)
 	case 18:
 		SimpleAudioEngine::sharedEngine()->stopAllEffects();
 		break;
+	case 19:
+		mixerBenchmark();
+		break;
 	}
 	
 }
 
+// Mixes 64 voices (half of them pitch shifted, so both the direct and the
+// resampling paths are measured) into a NullAudioSink and logs the throughput.
+void CocosDenshionTest::mixerBenchmark()
+{
+	const unsigned int nVoices = 64;
+	const unsigned int nBlocks = 200;
+
+	AudioMixer mixer(44100);
+	mixer.setSink(new NullAudioSink());
+
+	AudioClip clip;
+	std::string path = CCFileUtils::fullPathFromRelativePath(EFFECT_FILE);
+	if (! clip.initWithWavFile(path.c_str()))
+	{
+		// no wav resource on this platform, mix a generated tone instead
+		float tone[4410];
+		for (unsigned int i = 0; i < sizeof(tone) / sizeof(tone[0]); ++i)
+		{
+			tone[i] = sinf(i * 0.0627f) * 0.5f;
+		}
+		clip.initWithSamples(tone, sizeof(tone) / sizeof(tone[0]), 1, 44100);
+	}
+
+	for (unsigned int i = 0; i < nVoices; ++i)
+	{
+		mixer.play(&clip, true, 0.1f, (i % 3) - 1.0f, (i & 1) ? 1.0f : 0.75f);
+	}
+
+	unsigned int nFrames = mixer.getSampleRate() / 60;
+	struct timeval start, now;
+	gettimeofday(&start, NULL);
+	for (unsigned int i = 0; i < nBlocks; ++i)
+	{
+		mixer.render(nFrames);
+	}
+	gettimeofday(&now, NULL);
+
+	float ms = (now.tv_sec - start.tv_sec) * 1000.0f + (now.tv_usec - start.tv_usec) / 1000.0f;
+	float audioMs = nBlocks * nFrames * 1000.0f / mixer.getSampleRate();
+	CCLog("mixer: %u voices, %.1f ms of audio in %.2f ms, %.1f voices mixed per ms of cpu",
+		nVoices, audioMs, ms, ms > 0.0f ? nVoices * audioMs / ms : 0.0f);
+}
+
 void CocosDenshionTest::ccTouchesBegan(CCSet *pTouches, CCEvent *pEvent)
 {
 	CCSetIterator it = pTouches->begin();
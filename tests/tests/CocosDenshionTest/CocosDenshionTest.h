@@ -14,6 +14,8 @@ public:
 	virtual void ccTouchesBegan(CCSet *pTouches, CCEvent *pEvent);
 	virtual void onExit();
 
+	void mixerBenchmark();
+
 private:
 	CCMenu* m_pItmeMenu;
 	CCPoint m_tBeginPos;
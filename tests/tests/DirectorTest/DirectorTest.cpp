@@ -1,7 +1,7 @@
 #include "DirectorTest.h"
 #include "../testResource.h"
 
-#define MAX_LAYER	1
+#define MAX_LAYER	2
 
 CCLayer* nextDirectorTestCase();
 CCLayer* backDirectorTestCase();
@@ -21,6 +21,13 @@ CCLayer* createTestCaseLayer(int index)
             pRet->autorelease();
             return pRet;
         }
+    case 1:
+        {
+            Director2* pRet = new Director2();
+            pRet->init();
+            pRet->autorelease();
+            return pRet;
+        }
     default:
         return NULL;
     }
@@ -205,6 +212,154 @@ std::string Director1::subtitle()
 	return "Tap screen and see the debug console";
 }
 
+///---------------------------------------
+// 
+// Director2
+// 
+///---------------------------------------
+Director2::Director2()
+: m_pSprite(NULL)
+, m_pStatsLabel(NULL)
+, m_fPrevX(0)
+, m_fCurX(0)
+, m_fSpeed(120)
+, m_bWasFixed(false)
+, m_dOldTickRate(60)
+{
+}
+
+bool Director2::init()
+{
+    bool bRet = false;
+
+    do
+    {
+        CC_BREAK_IF(! DirectorTest::init());
+
+        CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+        bool bPassed = checkAccumulator();
+        CCLabelTTF *result = CCLabelTTF::labelWithString(bPassed ? "accumulator: PASS" : "accumulator: FAIL", "Arial", 20);
+        result->setColor(bPassed ? ccc3(0, 255, 0) : ccc3(255, 0, 0));
+        result->setPosition(ccp(s.width/2, s.height-120));
+        addChild(result);
+
+        m_pSprite = CCSprite::spriteWithFile(s_pPathGrossini);
+        m_fPrevX = m_fCurX = 60;
+        m_pSprite->setPosition(ccp(m_fCurX, s.height/2));
+        addChild(m_pSprite);
+
+        m_pStatsLabel = CCLabelTTF::labelWithString("", "Arial", 16);
+        m_pStatsLabel->setPosition(ccp(s.width/2, 80));
+        addChild(m_pStatsLabel);
+
+        bRet = true;
+    } while (0);
+
+    return bRet;
+}
+
+// Drives a CCFixedTimestep with a manual clock through a scripted run of frames
+bool Director2::checkAccumulator()
+{
+    CCManualFrameClock *pClock = new CCManualFrameClock();
+    CCFixedTimestep *pTimestep = new CCFixedTimestep();
+    pTimestep->initWithClock(pClock);
+    pClock->release();
+    pTimestep->setTickRate(60);
+    pTimestep->setMaxSubsteps(5);
+    pTimestep->setFrameDeadline(1.0 / 60);
+
+    // jittery 60 Hz frames, one skipped vsync and a 250 ms hitch
+    const double frames[] = { 0.0166, 0.0168, 0.0165, 0.0169, 0.0333, 0.0167, 0.25, 0.0167 };
+    const unsigned int expected[] = { 1, 1, 1, 1, 2, 1, 5, 1 };
+
+    bool bPassed = true;
+    for (unsigned int i = 0; i < sizeof(frames) / sizeof(frames[0]); ++i)
+    {
+        pClock->advance(frames[i]);
+        unsigned int uSteps = pTimestep->accumulate(pTimestep->measureFrame());
+        float fAlpha = pTimestep->getInterpolationAlpha();
+        if (uSteps != expected[i] || fAlpha < 0 || fAlpha > 1)
+        {
+            CCLOG("Director2: frame %u took %u steps, alpha %f", i, uSteps, fAlpha);
+            bPassed = false;
+        }
+    }
+
+    const ccFramePacingStats& stats = pTimestep->getStats();
+    // the hitch is worth 15 steps, 10 of them over the clamp
+    bPassed = bPassed && stats.uFrames == 8 && stats.uSteps == 13 && stats.uDroppedSteps == 10;
+    bPassed = bPassed && stats.uMissedDeadlines == 2;
+    bPassed = bPassed && pTimestep->getFrameTimePercentile(50) < 0.018;
+
+    pTimestep->release();
+    return bPassed;
+}
+
+void Director2::onEnter()
+{
+    DirectorTest::onEnter();
+
+    // tick at 30 Hz so the interpolation is visible at 60 fps
+    CCDirector *pDirector = CCDirector::sharedDirector();
+    m_bWasFixed = pDirector->isFixedTimestepEnabled();
+    m_dOldTickRate = pDirector->getFixedTimestep()->getTickRate();
+    pDirector->getFixedTimestep()->setTickRate(30);
+    pDirector->getFixedTimestep()->resetStats();
+    pDirector->setFixedTimestepEnabled(true);
+
+    scheduleUpdate();
+}
+
+void Director2::onExit()
+{
+    CCDirector *pDirector = CCDirector::sharedDirector();
+    pDirector->getFixedTimestep()->setTickRate(m_dOldTickRate);
+    pDirector->setFixedTimestepEnabled(m_bWasFixed);
+
+    DirectorTest::onExit();
+}
+
+void Director2::update(ccTime dt)
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    m_fPrevX = m_fCurX;
+    m_fCurX += m_fSpeed * dt;
+    if (m_fCurX > s.width - 60 || m_fCurX < 60)
+    {
+        m_fSpeed = -m_fSpeed;
+        m_fCurX = m_fPrevX;
+    }
+
+    CCDirector *pDirector = CCDirector::sharedDirector();
+    const ccFramePacingStats& stats = pDirector->getFramePacingStats();
+    char szStats[128];
+    sprintf(szStats, "steps %u  dropped %u  missed %u  p95 %.1f ms",
+        stats.uSteps, stats.uDroppedSteps, stats.uMissedDeadlines,
+        pDirector->getFixedTimestep()->getFrameTimePercentile(95) * 1000);
+    m_pStatsLabel->setString(szStats);
+}
+
+void Director2::visit()
+{
+    float fAlpha = CCDirector::sharedDirector()->getInterpolationAlpha();
+    m_pSprite->setPosition(ccp(m_fPrevX + (m_fCurX - m_fPrevX) * fAlpha, m_pSprite->getPosition().y));
+
+    DirectorTest::visit();
+}
+
+std::string Director2::title()
+{
+    return "Fixed timestep";
+}
+
+std::string Director2::subtitle()
+{
+    return "Ticks at 30 Hz, the sprite is interpolated";
+}
+
 ///---------------------------------------
 // 
 // DirectorTestScene
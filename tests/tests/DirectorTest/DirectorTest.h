@@ -29,6 +29,32 @@ public:
     virtual std::string subtitle();
 };
 
+class Director2 : public DirectorTest
+{
+public:
+    Director2();
+
+    virtual bool init();
+    virtual void onEnter();
+    virtual void onExit();
+    virtual void visit();
+
+    void update(ccTime dt);
+    bool checkAccumulator();
+
+    virtual std::string title();
+    virtual std::string subtitle();
+
+protected:
+    CCSprite*   m_pSprite;
+    CCLabelTTF* m_pStatsLabel;
+    float       m_fPrevX;
+    float       m_fCurX;
+    float       m_fSpeed;
+    bool        m_bWasFixed;
+    double      m_dOldTickRate;
+};
+
 class DirectorTestScene : public TestScene
 {
 public:
@@ -0,0 +1,303 @@
+#include "PerformanceAllocTest.h"
+
+enum
+{
+    TEST_COUNT = 3,
+};
+
+// a bullet hell scene fires a few hundred bullets per frame, each with its own actions
+static const int kBulletsPerFrame = 500;
+
+static int s_nAllocCurCase = 0;
+
+// the pages A and B are only compared with the heap in a build without pooling
+#if CC_ENABLE_POOLED_ALLOCATION
+static const char s_szAllocMode[] = "slabs";
+#else
+static const char s_szAllocMode[] = "heap";
+#endif
+
+static const size_t s_uBlockSizes[] = { sizeof(CCSequence), sizeof(CCMoveBy), sizeof(CCSprite) };
+static const int kBlockSizeCount = sizeof(s_uBlockSizes) / sizeof(s_uBlockSizes[0]);
+
+extern float calculateDeltaTime( struct timeval *lastUpdate );
+
+////////////////////////////////////////////////////////
+//
+// AllocMainScene
+//
+////////////////////////////////////////////////////////
+void AllocMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new AllocActionsTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new AllocSpritesTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 2:
+        pLayer = new AllocSlabVsHeapTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nAllocCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void AllocMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    scheduleUpdate();
+
+    m_plabel = CCLabelBMFont::labelWithString("00.0", "fonts/arial16.fnt");
+    m_plabel->setPosition(ccp(s.width/2, s.height/2));
+    addChild(m_plabel);
+
+    elapsedTime = 0;
+    churnTime = 0;
+    numberOfObjects = 0;
+}
+
+void AllocMainScene::update(ccTime dt)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    numberOfObjects += churn();
+    // the objects autoreleased by churn() are freed when the frame ends, so this only counts the allocations
+    churnTime += calculateDeltaTime(&now);
+
+    elapsedTime += dt;
+    if (elapsedTime > 1.0f)
+    {
+        char str[64] = {0};
+        sprintf(str, "%.1f objects/ms (%s)", churnTime > 0 ? numberOfObjects / (churnTime * 1000.0f) : 0.0f, s_szAllocMode);
+        m_plabel->setString(str);
+
+        CCLog("%s: %d objects in %.3f ms", title().c_str(), numberOfObjects, churnTime * 1000.0f);
+        CCSlabAllocator::dumpAllocators();
+
+        elapsedTime = 0;
+        churnTime = 0;
+        numberOfObjects = 0;
+    }
+}
+
+std::string AllocMainScene::title()
+{
+    return "no title";
+}
+
+std::string AllocMainScene::subtitle()
+{
+    return "";
+}
+
+////////////////////////////////////////////////////////
+//
+// AllocActionsTest
+//
+////////////////////////////////////////////////////////
+int AllocActionsTest::churn()
+{
+    int nObjects = 0;
+
+    for (int i = 0; i < kBulletsPerFrame; ++i)
+    {
+        // what a bullet usually runs, released right away instead of running it
+        CCAction* pAction = CCSequence::actions(
+            CCSpawn::actions(
+                CCMoveBy::actionWithDuration(1.0f, ccp(0, 200)),
+                CCRotateBy::actionWithDuration(1.0f, 360),
+                NULL),
+            CCFadeOut::actionWithDuration(0.2f),
+            CCCallFuncN::actionWithTarget(this, callfuncN_selector(AllocActionsTest::bulletDone)),
+            NULL);
+        CCAction* pCopy = (CCAction*)pAction->copy();
+        pCopy->release();
+
+        // move, rotate, spawn, fade, call and the two sequences chaining them, plus their copies
+        nObjects += 7 * 2;
+    }
+
+    return nObjects;
+}
+
+void AllocActionsTest::bulletDone(CCNode* pSender)
+{
+}
+
+std::string AllocActionsTest::title()
+{
+    return "Actions allocation";
+}
+
+std::string AllocActionsTest::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d bullet actions created and copied per frame", kBulletsPerFrame);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// AllocSpritesTest
+//
+////////////////////////////////////////////////////////
+int AllocSpritesTest::churn()
+{
+    CCTexture2D* pTexture = CCTextureCache::sharedTextureCache()->addImage("Images/grossini_dance_atlas.png");
+
+    for (int i = 0; i < kBulletsPerFrame; ++i)
+    {
+        CCSprite::spriteWithTexture(pTexture, CCRectMake(0, 0, 85, 121));
+    }
+
+    return kBulletsPerFrame;
+}
+
+std::string AllocSpritesTest::title()
+{
+    return "Sprites allocation";
+}
+
+std::string AllocSpritesTest::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d sprites created per frame", kBulletsPerFrame);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// AllocSlabVsHeapTest
+//
+////////////////////////////////////////////////////////
+AllocSlabVsHeapTest::AllocSlabVsHeapTest(bool bControlMenuVisible, int nMaxCases, int nCurCase)
+    : AllocMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    , m_fHeapTime(0)
+{
+    for (int i = 0; i < kBlockSizeCount; ++i)
+    {
+        m_allocators.push_back(new CCSlabAllocator("AllocSlabVsHeapTest", s_uBlockSizes[i], 64));
+    }
+    m_blocks.resize(kBulletsPerFrame);
+}
+
+AllocSlabVsHeapTest::~AllocSlabVsHeapTest()
+{
+    for (int i = 0; i < kBlockSizeCount; ++i)
+    {
+        delete m_allocators[i];
+    }
+}
+
+void AllocSlabVsHeapTest::onEnter()
+{
+    AllocMainScene::onEnter();
+
+    m_fHeapTime = 0;
+}
+
+int AllocSlabVsHeapTest::churn()
+{
+    // a frame of bullets: their blocks are all allocated, then all freed
+    for (int n = 0; n < kBlockSizeCount; ++n)
+    {
+        CCSlabAllocator* pAllocator = m_allocators[n];
+        for (int i = 0; i < kBulletsPerFrame; ++i)
+        {
+            m_blocks[i] = pAllocator->allocate(s_uBlockSizes[n]);
+        }
+        for (int i = 0; i < kBulletsPerFrame; ++i)
+        {
+            pAllocator->deallocate(m_blocks[i], s_uBlockSizes[n]);
+        }
+    }
+
+    return kBulletsPerFrame * kBlockSizeCount;
+}
+
+void AllocSlabVsHeapTest::update(ccTime dt)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    numberOfObjects += churn();
+    churnTime += calculateDeltaTime(&now);
+
+    gettimeofday(&now, NULL);
+    for (int n = 0; n < kBlockSizeCount; ++n)
+    {
+        for (int i = 0; i < kBulletsPerFrame; ++i)
+        {
+            m_blocks[i] = ::operator new(s_uBlockSizes[n]);
+        }
+        for (int i = 0; i < kBulletsPerFrame; ++i)
+        {
+            ::operator delete(m_blocks[i]);
+        }
+    }
+    m_fHeapTime += calculateDeltaTime(&now);
+
+    elapsedTime += dt;
+    if (elapsedTime > 1.0f)
+    {
+        char str[64] = {0};
+        sprintf(str, "slabs %.1f blocks/ms, heap %.1f blocks/ms",
+            churnTime > 0 ? numberOfObjects / (churnTime * 1000.0f) : 0.0f,
+            m_fHeapTime > 0 ? numberOfObjects / (m_fHeapTime * 1000.0f) : 0.0f);
+        m_plabel->setString(str);
+
+        CCLog("%s: %d blocks in %.3f ms from slabs, %.3f ms from the heap", title().c_str(), numberOfObjects, churnTime * 1000.0f, m_fHeapTime * 1000.0f);
+
+        elapsedTime = 0;
+        churnTime = 0;
+        m_fHeapTime = 0;
+        numberOfObjects = 0;
+    }
+}
+
+std::string AllocSlabVsHeapTest::title()
+{
+    return "Slabs vs heap";
+}
+
+std::string AllocSlabVsHeapTest::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d blocks of %d sizes allocated and freed per frame", kBulletsPerFrame, kBlockSizeCount);
+    return str;
+}
+
+void runAllocTest()
+{
+    s_nAllocCurCase = 0;
+    AllocMainScene* pLayer = new AllocActionsTest(true, TEST_COUNT, s_nAllocCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
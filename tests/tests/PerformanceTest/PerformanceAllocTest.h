@@ -0,0 +1,79 @@
+#ifndef __PERFORMANCE_ALLOC_TEST_H__
+#define __PERFORMANCE_ALLOC_TEST_H__
+
+#include "PerformanceTest.h"
+
+class AllocMainScene : public PerformBasicLayer
+{
+public:
+    AllocMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void update(ccTime dt);
+
+    /** create and release one frame's worth of objects, returns how many were created */
+    virtual int churn() = 0;
+
+protected:
+    CCLabelBMFont * m_plabel;
+    int             numberOfObjects;
+    float           churnTime;
+    ccTime          elapsedTime;
+};
+
+class AllocActionsTest : public AllocMainScene
+{
+public:
+    AllocActionsTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : AllocMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual int churn();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    void bulletDone(CCNode* pSender);
+};
+
+class AllocSpritesTest : public AllocMainScene
+{
+public:
+    AllocSpritesTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : AllocMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual int churn();
+    virtual std::string title();
+    virtual std::string subtitle();
+};
+
+// the same block sizes from slab allocators and from the heap, timed in the same frames
+class AllocSlabVsHeapTest : public AllocMainScene
+{
+public:
+    AllocSlabVsHeapTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0);
+    virtual ~AllocSlabVsHeapTest();
+
+    virtual void onEnter();
+    virtual void update(ccTime dt);
+    virtual int churn();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+protected:
+    std::vector<CCSlabAllocator*> m_allocators;
+    std::vector<void*> m_blocks;
+    float m_fHeapTime;
+};
+
+void runAllocTest();
+
+#endif
@@ -0,0 +1,309 @@
+#include "PerformanceBufferTest.h"
+
+enum
+{
+    TEST_COUNT = 2,
+};
+
+// a sprite heavy frame: per sprite 4 vertices and the matrices, 256 bytes once packed
+static const int kSpritesPerFrame = 500;
+static const int kSimulatedFrames = 600;
+static const unsigned int kVertexSize = 24;
+static const unsigned int kConstantsSize = 256;
+static const int kNumberOfSprites = 500;
+
+static int s_nBufferCurCase = 0;
+
+////////////////////////////////////////////////////////
+//
+// SimulatedGPUDevice
+//
+////////////////////////////////////////////////////////
+
+// stands in for the D3D11 device: system memory, and fences the "GPU" passes
+// a fixed number of frames after they were queued
+class SimulatedGPUDevice : public CCBufferRingDevice
+{
+public:
+    SimulatedGPUDevice(unsigned int uLatency)
+        : m_uLatency(uLatency)
+        , m_uFrame(0)
+        , m_uCompletedFence(0)
+    {
+    }
+
+    virtual bool createBuffer(unsigned int uCapacity)
+    {
+        m_memory.resize(uCapacity);
+        return true;
+    }
+
+    virtual void* map(bool bDiscard)
+    {
+        return &m_memory[0];
+    }
+
+    virtual void unmap(void)
+    {
+    }
+
+    virtual bool signalFence(unsigned int uFence)
+    {
+        ccQueuedFence fence = {uFence, m_uFrame};
+        m_fences.push_back(fence);
+        return true;
+    }
+
+    virtual unsigned int getCompletedFence(void)
+    {
+        return m_uCompletedFence;
+    }
+
+    void frameEnded(void)
+    {
+        ++m_uFrame;
+        while (! m_fences.empty() && m_fences.front().uFrame + m_uLatency <= m_uFrame)
+        {
+            m_uCompletedFence = m_fences.front().uFence;
+            m_fences.erase(m_fences.begin());
+        }
+    }
+
+protected:
+    typedef struct _ccQueuedFence
+    {
+        unsigned int uFence;
+        unsigned int uFrame;
+    } ccQueuedFence;
+
+    unsigned int m_uLatency;
+    unsigned int m_uFrame;
+    unsigned int m_uCompletedFence;
+    std::vector<unsigned char> m_memory;
+    std::vector<ccQueuedFence> m_fences;
+};
+
+////////////////////////////////////////////////////////
+//
+// BufferMainScene
+//
+////////////////////////////////////////////////////////
+void BufferMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new BufferSimulatedTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new BufferSpritesTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nBufferCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void BufferMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    performTests();
+}
+
+std::string BufferMainScene::title()
+{
+    return "no title";
+}
+
+std::string BufferMainScene::subtitle()
+{
+    return "";
+}
+
+////////////////////////////////////////////////////////
+//
+// BufferSimulatedTest
+//
+////////////////////////////////////////////////////////
+void BufferSimulatedTest::performTests()
+{
+    CCFrameClock *pClock = new CCFrameClock();
+    std::string strResult;
+
+    CCLog("--------");
+    strResult += performTestsLatency(1, pClock);
+    strResult += performTestsLatency(3, pClock);
+    strResult += performTestsLatency(6, pClock);
+    CCLog("--------");
+
+    pClock->release();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    CCLabelTTF *pLabel = CCLabelTTF::labelWithString(strResult.c_str(), CCSizeMake(s.width - 40, 200), CCTextAlignmentLeft, "Courier New", 14);
+    addChild(pLabel, 1);
+    pLabel->setPosition(ccp(s.width/2, s.height/2 - 20));
+}
+
+std::string BufferSimulatedTest::performTestsLatency(unsigned int uLatency, CCFrameClock* pClock)
+{
+    SimulatedGPUDevice *pGeometryDevice = new SimulatedGPUDevice(uLatency);
+    SimulatedGPUDevice *pConstantDevice = new SimulatedGPUDevice(uLatency);
+    CCBufferRing *pGeometry = new CCBufferRing();
+    CCBufferRing *pConstants = new CCBufferRing();
+    pGeometry->initWithDevice(pGeometryDevice, 64 * 1024);
+    pConstants->initWithDevice(pConstantDevice, 64 * 1024);
+
+    unsigned char vertices[kVertexSize * 4];
+    unsigned char matrices[kConstantsSize];
+    memset(vertices, 0, sizeof(vertices));
+    memset(matrices, 0, sizeof(matrices));
+
+    unsigned int uOffset = 0;
+    double dStart = pClock->now();
+    for (int nFrame = 0; nFrame < kSimulatedFrames; ++nFrame)
+    {
+        for (int i = 0; i < kSpritesPerFrame; ++i)
+        {
+            pGeometry->upload(vertices, sizeof(vertices), 16, &uOffset);
+            pConstants->upload(matrices, sizeof(matrices), kConstantsSize, &uOffset);
+        }
+        pGeometry->frameEnded();
+        pConstants->frameEnded();
+        pGeometryDevice->frameEnded();
+        pConstantDevice->frameEnded();
+    }
+    double dElapsed = pClock->now() - dStart;
+
+    const ccBufferRingStats& geometry = pGeometry->getStats();
+    const ccBufferRingStats& constants = pConstants->getStats();
+    unsigned int uAllocations = geometry.uTotalAllocations + constants.uTotalAllocations;
+    unsigned int uDiscards = geometry.uTotalDiscards + constants.uTotalDiscards;
+
+    // before the rings every draw discarded its vertex and its constant buffer
+    char str[256];
+    sprintf(str, "%u frames late: %u maps, %u discards (were %u), %u wraps, %u grows, %u KB + %u KB, %.2f ms/frame\n",
+        uLatency, uDiscards, uAllocations, uAllocations,
+        geometry.uWraps + constants.uWraps, geometry.uGrows + constants.uGrows,
+        pGeometry->getCapacity() / 1024, pConstants->getCapacity() / 1024,
+        dElapsed * 1000 / kSimulatedFrames);
+    CCLog("%s", str);
+
+    pGeometry->release();
+    pConstants->release();
+    pGeometryDevice->release();
+    pConstantDevice->release();
+
+    return str;
+}
+
+std::string BufferSimulatedTest::title()
+{
+    return "A) ring, simulated GPU";
+}
+
+std::string BufferSimulatedTest::subtitle()
+{
+    char str[128] = {0};
+    sprintf(str, "%d sprites a frame for %d frames, the GPU reads 1 to 6 frames late", kSpritesPerFrame, kSimulatedFrames);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// BufferSpritesTest
+//
+////////////////////////////////////////////////////////
+void BufferSpritesTest::performTests()
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    for (int i = 0; i < kNumberOfSprites; ++i)
+    {
+        CCSprite *pSprite = CCSprite::spriteWithFile("Images/grossinis_sister1.png");
+        pSprite->setScale(0.3f);
+        pSprite->setPosition(ccp((i * 37 % 100) / 100.0f * s.width, (i * 61 % 100) / 100.0f * s.height));
+        pSprite->runAction(CCRepeatForever::actionWithAction(CCRotateBy::actionWithDuration(2, 360)));
+        addChild(pSprite);
+    }
+
+    m_pStatsLabel = CCLabelTTF::labelWithString("", CCSizeMake(s.width - 40, 100), CCTextAlignmentLeft, "Courier New", 14);
+    addChild(m_pStatsLabel, 1);
+    m_pStatsLabel->setPosition(ccp(s.width/2, s.height - 160));
+
+    schedule(schedule_selector(BufferSpritesTest::showStats), 1.0f);
+}
+
+void BufferSpritesTest::showStats(ccTime dt)
+{
+    CCDynamicBuffers *pBuffers = CCDynamicBuffers::sharedDynamicBuffers();
+    const ccBufferRingStats& geometry = pBuffers->getGeometryRing()->getStats();
+
+    char szStats[512];
+    int n = sprintf(szStats, "vertices : %u KB, peak frame %u KB, %u maps, %u discards, %u wraps, %u grows\n",
+        pBuffers->getGeometryRing()->getCapacity() / 1024, geometry.uPeakFrameBytes / 1024,
+        geometry.uTotalAllocations, geometry.uTotalDiscards, geometry.uWraps, geometry.uGrows);
+
+    if (pBuffers->isConstantRangeSupported())
+    {
+        const ccBufferRingStats& constants = pBuffers->getConstantRing()->getStats();
+        sprintf(szStats + n, "constants: %u KB, peak frame %u KB, %u maps, %u discards, %u wraps, %u grows",
+            pBuffers->getConstantRing()->getCapacity() / 1024, constants.uPeakFrameBytes / 1024,
+            constants.uTotalAllocations, constants.uTotalDiscards, constants.uWraps, constants.uGrows);
+    }
+    else
+    {
+        sprintf(szStats + n, "constants: no constant buffer ranges, one discard per draw");
+    }
+    m_pStatsLabel->setString(szStats);
+}
+
+void BufferSpritesTest::onExit()
+{
+    unschedule(schedule_selector(BufferSpritesTest::showStats));
+
+    BufferMainScene::onExit();
+}
+
+std::string BufferSpritesTest::title()
+{
+    return "B) sprites";
+}
+
+std::string BufferSpritesTest::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d rotating sprites, ring counters since start", kNumberOfSprites);
+    return str;
+}
+
+void runBufferTest()
+{
+    s_nBufferCurCase = 0;
+    BufferMainScene* pLayer = new BufferSimulatedTest(true, TEST_COUNT, s_nBufferCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
@@ -0,0 +1,56 @@
+#ifndef __PERFORMANCE_BUFFER_TEST_H__
+#define __PERFORMANCE_BUFFER_TEST_H__
+
+#include "PerformanceTest.h"
+
+class BufferMainScene : public PerformBasicLayer
+{
+public:
+    BufferMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void performTests() = 0;
+};
+
+class BufferSimulatedTest : public BufferMainScene
+{
+public:
+    BufferSimulatedTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : BufferMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+    std::string performTestsLatency(unsigned int uLatency, CCFrameClock* pClock);
+};
+
+class BufferSpritesTest : public BufferMainScene
+{
+public:
+    BufferSpritesTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : BufferMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+        , m_pStatsLabel(NULL)
+    {
+    }
+
+    virtual void performTests();
+    virtual void onExit();
+    virtual std::string title();
+    virtual std::string subtitle();
+    void showStats(ccTime dt);
+
+protected:
+    CCLabelTTF* m_pStatsLabel;
+};
+
+void runBufferTest();
+
+#endif
@@ -0,0 +1,401 @@
+#include "PerformanceGridTest.h"
+#include "../testResource.h"
+#include <math.h>
+#include <stdlib.h>
+
+enum
+{
+    TEST_COUNT = 6,
+};
+
+// the measured grid, 10 pixels between vertices
+static const int kGridWidth = 96;
+static const int kGridHeight = 64;
+static const float kGridStep = 10.0f;
+// each way of deforming runs this many times per measure
+static const int kRepeats = 20;
+
+static const float kCenterX = kGridWidth * kGridStep / 2;
+static const float kCenterY = kGridHeight * kGridStep / 2;
+static const float kRadius = 240.0f;
+static const float kAmplitude = 40.0f;
+
+static int s_nGridCurCase = 0;
+
+////////////////////////////////////////////////////////
+//
+// GridMenuLayer
+//
+////////////////////////////////////////////////////////
+GridMenuLayer::GridMenuLayer(bool bControlMenuVisible, int nMaxCases, int nCurCase)
+    : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    , m_pResultLabel(NULL)
+{
+    m_pClock = new CCFrameClock();
+
+    // the kernels read the originals as x, y and z arrays padded to a multiple of 4
+    unsigned int count = (kGridWidth + 1) * (kGridHeight + 1);
+    unsigned int stride = (count + 3) & ~3;
+    m_originals.resize(stride * 3, 0.0f);
+    m_deformed.resize(count * 3, 0.0f);
+    for (unsigned int i = 0; i < stride; ++i)
+    {
+        unsigned int k = i < count ? i : count - 1;
+        m_originals[i] = (k / (kGridHeight + 1)) * kGridStep;
+        m_originals[stride + i] = (k % (kGridHeight + 1)) * kGridStep;
+    }
+
+    m_vertices.x = &m_originals[0];
+    m_vertices.y = &m_originals[stride];
+    m_vertices.z = &m_originals[stride * 2];
+    m_vertices.count = count;
+    m_vertices.out = &m_deformed[0];
+}
+
+GridMenuLayer::~GridMenuLayer()
+{
+    m_pClock->release();
+}
+
+void GridMenuLayer::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new GridWaves3DTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new GridWavesTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 2:
+        pLayer = new GridRippleTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 3:
+        pLayer = new GridLensTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 4:
+        pLayer = new GridTwirlTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 5:
+        pLayer = new GridShakyTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nGridCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void GridMenuLayer::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // the effect itself, to check the kernel draws what the action did
+    CCNode* pTarget = CCNode::node();
+    CCSprite* pBackground = CCSprite::spriteWithFile(s_back3);
+    pBackground->setPosition(ccp(s.width/2, s.height/2));
+    pTarget->addChild(pBackground);
+    addChild(pTarget, 0);
+    pTarget->runAction(CCRepeatForever::actionWithAction(effect()));
+
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    m_pResultLabel = CCLabelTTF::labelWithString("measuring...", "Arial", 20);
+    addChild(m_pResultLabel, 1);
+    m_pResultLabel->setPosition(ccp(s.width/2, s.height/2));
+
+    schedule(schedule_selector(GridMenuLayer::measure), 1.0f);
+}
+
+void GridMenuLayer::measure(ccTime dt)
+{
+    CC_UNUSED_PARAM(dt);
+
+    double dStart = m_pClock->now();
+    for (int i = 0; i < kRepeats; ++i)
+    {
+        deformScalar(&m_vertices, i * 0.1f);
+    }
+    double dScalar = m_pClock->now() - dStart;
+
+    dStart = m_pClock->now();
+    for (int i = 0; i < kRepeats; ++i)
+    {
+        deformKernel(&m_vertices, i * 0.1f);
+    }
+    double dKernel = m_pClock->now() - dStart;
+
+    // vertices per millisecond
+    double dVertices = (double)m_vertices.count * kRepeats;
+    double dScalarRate = dScalar > 0 ? dVertices / (dScalar * 1000.0) : 0;
+    double dKernelRate = dKernel > 0 ? dVertices / (dKernel * 1000.0) : 0;
+
+    char str[128] = {0};
+    sprintf(str, "per vertex: %.0f vertices/ms, kernel: %.0f vertices/ms (x%.1f)",
+        dScalarRate, dKernelRate, dScalarRate > 0 ? dKernelRate / dScalarRate : 0);
+    m_pResultLabel->setString(str);
+
+    CCLog("%s: per vertex %.0f vertices/ms, kernel %.0f vertices/ms", title().c_str(), dScalarRate, dKernelRate);
+}
+
+std::string GridMenuLayer::title()
+{
+    return "no title";
+}
+
+std::string GridMenuLayer::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d vertices deformed %d times each way every second", (kGridWidth + 1) * (kGridHeight + 1), kRepeats);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// GridWaves3DTest
+//
+////////////////////////////////////////////////////////
+std::string GridWaves3DTest::title()
+{
+    return "A) CCWaves3D";
+}
+
+CCActionInterval* GridWaves3DTest::effect()
+{
+    return CCWaves3D::actionWithWaves(5, kAmplitude, ccg(15, 10), 3.0f);
+}
+
+void GridWaves3DTest::deformScalar(const tGridVertices* psVertices, float fPhase)
+{
+    for (unsigned int i = 0; i < psVertices->count; ++i)
+    {
+        float* v = &psVertices->out[i * 3];
+        v[0] = psVertices->x[i];
+        v[1] = psVertices->y[i];
+        v[2] = psVertices->z[i] + sinf(fPhase + (v[0] + v[1]) * .01f) * kAmplitude;
+    }
+}
+
+void GridWaves3DTest::deformKernel(const tGridVertices* psVertices, float fPhase)
+{
+    ccGridWaves3D(psVertices, fPhase, kAmplitude);
+}
+
+////////////////////////////////////////////////////////
+//
+// GridWavesTest
+//
+////////////////////////////////////////////////////////
+std::string GridWavesTest::title()
+{
+    return "B) CCWaves";
+}
+
+CCActionInterval* GridWavesTest::effect()
+{
+    return CCWaves::actionWithWaves(4, 20, true, true, ccg(16, 12), 3.0f);
+}
+
+void GridWavesTest::deformScalar(const tGridVertices* psVertices, float fPhase)
+{
+    for (unsigned int i = 0; i < psVertices->count; ++i)
+    {
+        float* v = &psVertices->out[i * 3];
+        v[0] = psVertices->x[i] + sinf(fPhase + psVertices->y[i] * .01f) * kAmplitude;
+        v[1] = psVertices->y[i] + sinf(fPhase + v[0] * .01f) * kAmplitude;
+        v[2] = psVertices->z[i];
+    }
+}
+
+void GridWavesTest::deformKernel(const tGridVertices* psVertices, float fPhase)
+{
+    ccGridWaves(psVertices, fPhase, kAmplitude, true, true);
+}
+
+////////////////////////////////////////////////////////
+//
+// GridRippleTest
+//
+////////////////////////////////////////////////////////
+std::string GridRippleTest::title()
+{
+    return "C) CCRipple3D";
+}
+
+CCActionInterval* GridRippleTest::effect()
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    return CCRipple3D::actionWithPosition(ccp(s.width/2, s.height/2), kRadius, 4, 160, ccg(32, 24), 3.0f);
+}
+
+void GridRippleTest::deformScalar(const tGridVertices* psVertices, float fPhase)
+{
+    for (unsigned int i = 0; i < psVertices->count; ++i)
+    {
+        float* v = &psVertices->out[i * 3];
+        v[0] = psVertices->x[i];
+        v[1] = psVertices->y[i];
+        v[2] = psVertices->z[i];
+
+        float r = ccpLength(ccp(kCenterX - v[0], kCenterY - v[1]));
+        if (r < kRadius)
+        {
+            r = kRadius - r;
+            float rate = powf(r / kRadius, 2);
+            v[2] += sinf(fPhase + r * 0.1f) * kAmplitude * rate;
+        }
+    }
+}
+
+void GridRippleTest::deformKernel(const tGridVertices* psVertices, float fPhase)
+{
+    ccGridRipple(psVertices, kCenterX, kCenterY, kRadius, fPhase, kAmplitude);
+}
+
+////////////////////////////////////////////////////////
+//
+// GridLensTest
+//
+////////////////////////////////////////////////////////
+std::string GridLensTest::title()
+{
+    return "D) CCLens3D";
+}
+
+CCActionInterval* GridLensTest::effect()
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    return CCLens3D::actionWithPosition(ccp(s.width/2, s.height/2), kRadius, ccg(15, 10), 3.0f);
+}
+
+void GridLensTest::deformScalar(const tGridVertices* psVertices, float fPhase)
+{
+    CC_UNUSED_PARAM(fPhase);
+
+    for (unsigned int i = 0; i < psVertices->count; ++i)
+    {
+        float* v = &psVertices->out[i * 3];
+        v[0] = psVertices->x[i];
+        v[1] = psVertices->y[i];
+        v[2] = psVertices->z[i];
+
+        CCPoint vect = ccp(kCenterX - v[0], kCenterY - v[1]);
+        float r = ccpLength(vect);
+        if (r < kRadius && r > 0)
+        {
+            float pre_log = (kRadius - r) / kRadius;
+            if (pre_log == 0)
+            {
+                pre_log = 0.001f;
+            }
+            v[2] += expf(logf(pre_log) * 0.7f) * kRadius * 0.7f;
+        }
+    }
+}
+
+void GridLensTest::deformKernel(const tGridVertices* psVertices, float fPhase)
+{
+    CC_UNUSED_PARAM(fPhase);
+    ccGridLens(psVertices, kCenterX, kCenterY, kRadius, 0.7f);
+}
+
+////////////////////////////////////////////////////////
+//
+// GridTwirlTest
+//
+////////////////////////////////////////////////////////
+std::string GridTwirlTest::title()
+{
+    return "E) CCTwirl";
+}
+
+CCActionInterval* GridTwirlTest::effect()
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    return CCTwirl::actionWithPosition(ccp(s.width/2, s.height/2), 1, 2.5f, ccg(12, 8), 3.0f);
+}
+
+void GridTwirlTest::deformScalar(const tGridVertices* psVertices, float fPhase)
+{
+    float angle = cosf(fPhase) * 0.25f;
+
+    for (unsigned int i = 0; i < psVertices->count; ++i)
+    {
+        float* v = &psVertices->out[i * 3];
+        int column = i / (kGridHeight + 1);
+        int row = i % (kGridHeight + 1);
+        float a = ccpLength(ccp(column - kGridWidth / 2.0f, row - kGridHeight / 2.0f)) * angle;
+
+        float dx = psVertices->x[i] - kCenterX;
+        float dy = psVertices->y[i] - kCenterY;
+        v[0] = kCenterX + sinf(a) * dy + cosf(a) * dx;
+        v[1] = kCenterY + cosf(a) * dy - sinf(a) * dx;
+        v[2] = psVertices->z[i];
+    }
+}
+
+void GridTwirlTest::deformKernel(const tGridVertices* psVertices, float fPhase)
+{
+    ccGridTwirl(psVertices, kGridWidth, kGridHeight, kCenterX, kCenterY, cosf(fPhase) * 0.25f);
+}
+
+////////////////////////////////////////////////////////
+//
+// GridShakyTest
+//
+////////////////////////////////////////////////////////
+std::string GridShakyTest::title()
+{
+    return "F) CCShaky3D";
+}
+
+CCActionInterval* GridShakyTest::effect()
+{
+    return CCShaky3D::actionWithRange(5, true, ccg(15, 10), 3.0f);
+}
+
+void GridShakyTest::deformScalar(const tGridVertices* psVertices, float fPhase)
+{
+    CC_UNUSED_PARAM(fPhase);
+
+    for (unsigned int i = 0; i < psVertices->count; ++i)
+    {
+        float* v = &psVertices->out[i * 3];
+        v[0] = psVertices->x[i] + (rand() % 10) - 5;
+        v[1] = psVertices->y[i] + (rand() % 10) - 5;
+        v[2] = psVertices->z[i] + (rand() % 10) - 5;
+    }
+}
+
+void GridShakyTest::deformKernel(const tGridVertices* psVertices, float fPhase)
+{
+    CC_UNUSED_PARAM(fPhase);
+    ccGridShaky(psVertices, 5, true, &m_uSeed);
+}
+
+void runGridTest()
+{
+    s_nGridCurCase = 0;
+    GridMenuLayer* pLayer = new GridWaves3DTest(true, TEST_COUNT, s_nGridCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
@@ -0,0 +1,125 @@
+#ifndef __PERFORMANCE_GRID_TEST_H__
+#define __PERFORMANCE_GRID_TEST_H__
+
+#include "PerformanceTest.h"
+#include "effects/ccGridKernels.h"
+#include <vector>
+
+class GridMenuLayer : public PerformBasicLayer
+{
+public:
+    GridMenuLayer(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0);
+    virtual ~GridMenuLayer();
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    void measure(ccTime dt);
+
+    /** the grid action shown while measuring */
+    virtual CCActionInterval* effect() = 0;
+    /** deforms the vertices one at a time with sinf, as the grid actions did */
+    virtual void deformScalar(const tGridVertices* psVertices, float fPhase) = 0;
+    /** deforms the vertices with the kernel of ccGridKernels.h */
+    virtual void deformKernel(const tGridVertices* psVertices, float fPhase) = 0;
+
+protected:
+    CCFrameClock* m_pClock;
+    CCLabelTTF* m_pResultLabel;
+    std::vector<float> m_originals;
+    std::vector<float> m_deformed;
+    tGridVertices m_vertices;
+};
+
+class GridWaves3DTest : public GridMenuLayer
+{
+public:
+    GridWaves3DTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : GridMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string title();
+    virtual CCActionInterval* effect();
+    virtual void deformScalar(const tGridVertices* psVertices, float fPhase);
+    virtual void deformKernel(const tGridVertices* psVertices, float fPhase);
+};
+
+class GridWavesTest : public GridMenuLayer
+{
+public:
+    GridWavesTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : GridMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string title();
+    virtual CCActionInterval* effect();
+    virtual void deformScalar(const tGridVertices* psVertices, float fPhase);
+    virtual void deformKernel(const tGridVertices* psVertices, float fPhase);
+};
+
+class GridRippleTest : public GridMenuLayer
+{
+public:
+    GridRippleTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : GridMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string title();
+    virtual CCActionInterval* effect();
+    virtual void deformScalar(const tGridVertices* psVertices, float fPhase);
+    virtual void deformKernel(const tGridVertices* psVertices, float fPhase);
+};
+
+class GridLensTest : public GridMenuLayer
+{
+public:
+    GridLensTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : GridMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string title();
+    virtual CCActionInterval* effect();
+    virtual void deformScalar(const tGridVertices* psVertices, float fPhase);
+    virtual void deformKernel(const tGridVertices* psVertices, float fPhase);
+};
+
+class GridTwirlTest : public GridMenuLayer
+{
+public:
+    GridTwirlTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : GridMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string title();
+    virtual CCActionInterval* effect();
+    virtual void deformScalar(const tGridVertices* psVertices, float fPhase);
+    virtual void deformKernel(const tGridVertices* psVertices, float fPhase);
+};
+
+class GridShakyTest : public GridMenuLayer
+{
+public:
+    GridShakyTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : GridMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+        , m_uSeed(1)
+    {
+    }
+
+    virtual std::string title();
+    virtual CCActionInterval* effect();
+    virtual void deformScalar(const tGridVertices* psVertices, float fPhase);
+    virtual void deformKernel(const tGridVertices* psVertices, float fPhase);
+
+protected:
+    unsigned int m_uSeed;
+};
+
+void runGridTest();
+
+#endif
@@ -7,7 +7,7 @@ enum {
 
     kTagBase = 20000,
 
-    TEST_COUNT = 4,
+    TEST_COUNT = 6,
 };
 
 enum {
@@ -50,6 +50,12 @@ void NodeChildrenMenuLayer::showCurrentTest()
     case 3:
         pScene = new ReorderSpriteSheet();
         break;
+    case 4:
+        pScene = new GetChildByTagSpriteSheet();
+        break;
+    case 5:
+        pScene = new GetChildByTagLinearSpriteSheet();
+        break;
     }
     s_nCurCase = m_nCurCase;
 
@@ -553,6 +559,121 @@ std::string ReorderSpriteSheet::profilerName()
     return "reorder sprites";
 }
 
+////////////////////////////////////////////////////////
+//
+// TagLookupSpriteSheet
+//
+////////////////////////////////////////////////////////
+void TagLookupSpriteSheet::updateQuantityOfNodes()
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // increase nodes
+    if( currentQuantityOfNodes < quantityOfNodes )
+    {
+        for (int i = currentQuantityOfNodes; i < quantityOfNodes; i++)
+        {
+            CCSprite *sprite = CCSprite::spriteWithTexture(batchNode->getTexture(), CCRectMake(0, 0, 32, 32));
+            batchNode->addChild(sprite, 0, kTagBase+i);
+            sprite->setPosition(ccp( CCRANDOM_0_1()*s.width, CCRANDOM_0_1()*s.height));
+        }
+    }
+    // decrease nodes
+    else if ( currentQuantityOfNodes > quantityOfNodes )
+    {
+        for (int i = quantityOfNodes; i < currentQuantityOfNodes; i++)
+        {
+            batchNode->removeChildByTag(kTagBase+i, true);
+        }
+    }
+
+    currentQuantityOfNodes = quantityOfNodes;
+}
+
+void TagLookupSpriteSheet::update(ccTime dt)
+{
+    // 15 percent
+    int totalToFind = currentQuantityOfNodes * 0.15f;
+
+    if( totalToFind > 0 )
+    {
+        int *tags = new int[totalToFind];
+
+        // Don't include the random as part of the profiling
+        for(int i=0; i<totalToFind; i++)
+        {
+            tags[i] = kTagBase + (int)(CCRANDOM_0_1() * (currentQuantityOfNodes - 1));
+        }
+
+#if CC_ENABLE_PROFILERS
+        CCProfilingBeginTimingBlock(_profilingTimer);
+#endif
+
+        for( int i=0; i < totalToFind; i++ )
+        {
+            CCNode *pNode = batchNode->getChildByTag(tags[i]);
+            pNode->setIsVisible(! pNode->getIsVisible());
+        }
+
+#if CC_ENABLE_PROFILERS
+        CCProfilingEndTimingBlock(_profilingTimer);
+#endif
+
+        delete [] tags;
+    }
+}
+
+////////////////////////////////////////////////////////
+//
+// GetChildByTagSpriteSheet
+//
+////////////////////////////////////////////////////////
+std::string GetChildByTagSpriteSheet::title()
+{
+    return "F - Get child by tag";
+}
+
+std::string GetChildByTagSpriteSheet::subtitle()
+{
+    return "Find %15 of total sprites by tag, indexed. See console";
+}
+
+std::string GetChildByTagSpriteSheet::profilerName()
+{
+    return "get by tag";
+}
+
+////////////////////////////////////////////////////////
+//
+// GetChildByTagLinearSpriteSheet
+//
+////////////////////////////////////////////////////////
+void GetChildByTagLinearSpriteSheet::updateQuantityOfNodes()
+{
+    // the batch node builds its tag index when children are added, don't let it
+    unsigned int uThreshold = CCNode::getTagIndexThreshold();
+    CCNode::setTagIndexThreshold(0);
+
+    TagLookupSpriteSheet::updateQuantityOfNodes();
+
+    CCNode::setTagIndexThreshold(uThreshold);
+}
+
+std::string GetChildByTagLinearSpriteSheet::title()
+{
+    return "G - Get child by tag, scan";
+}
+
+std::string GetChildByTagLinearSpriteSheet::subtitle()
+{
+    return "Find %15 of total sprites by tag, no index. See console";
+}
+
+std::string GetChildByTagLinearSpriteSheet::profilerName()
+{
+    return "get by tag scan";
+}
+
 void runNodeChildrenTest()
 {
     IterateSpriteSheet* pScene = new IterateSpriteSheetCArray();
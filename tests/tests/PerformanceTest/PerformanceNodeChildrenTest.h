@@ -115,6 +115,31 @@ public:
     virtual std::string profilerName();
 };
 
+class TagLookupSpriteSheet : public AddRemoveSpriteSheet
+{
+public:
+    virtual void updateQuantityOfNodes();
+    virtual void update(ccTime dt);
+};
+
+class GetChildByTagSpriteSheet : public TagLookupSpriteSheet
+{
+public:
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual std::string profilerName();
+};
+
+class GetChildByTagLinearSpriteSheet : public TagLookupSpriteSheet
+{
+public:
+    virtual void updateQuantityOfNodes();
+
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual std::string profilerName();
+};
+
 void runNodeChildrenTest();
 
 #endif // __PERFORMANCE_NODE_CHILDREN_TEST_H__
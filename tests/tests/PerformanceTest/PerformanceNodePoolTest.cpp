@@ -0,0 +1,255 @@
+#include "PerformanceNodePoolTest.h"
+
+enum
+{
+    TEST_COUNT = 2,
+};
+
+// a shooter: every frame some bullets are fired, each one lives about a second
+static const int kSpawnsPerFrame = 20;
+static const unsigned int kLifetimeFrames = 60;
+static const char s_pszBulletImage[] = "Images/ball.png";
+
+static int s_nNodePoolCurCase = 0;
+
+////////////////////////////////////////////////////////
+//
+// NodePoolMainScene
+//
+////////////////////////////////////////////////////////
+NodePoolMainScene::NodePoolMainScene(bool bControlMenuVisible, int nMaxCases, int nCurCase)
+    : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    , m_pStatsLabel(NULL)
+    , m_uFrame(0)
+    , m_uSpawns(0)
+    , m_uFailedSpawns(0)
+    , m_uStatsFrames(0)
+    , m_dSpawnTime(0)
+{
+    m_pClock = new CCFrameClock();
+}
+
+NodePoolMainScene::~NodePoolMainScene()
+{
+    m_pClock->release();
+}
+
+void NodePoolMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new NodePoolCreateTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new NodePoolRecycleTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nNodePoolCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void NodePoolMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    m_pStatsLabel = CCLabelTTF::labelWithString("", CCSizeMake(s.width - 40, 80), CCTextAlignmentLeft, "Courier New", 14);
+    addChild(m_pStatsLabel, 1);
+    m_pStatsLabel->setPosition(ccp(s.width/2, s.height - 140));
+
+    schedule(schedule_selector(NodePoolMainScene::step));
+    schedule(schedule_selector(NodePoolMainScene::showStats), 1.0f);
+}
+
+void NodePoolMainScene::onExit()
+{
+    unschedule(schedule_selector(NodePoolMainScene::step));
+    unschedule(schedule_selector(NodePoolMainScene::showStats));
+
+    PerformBasicLayer::onExit();
+}
+
+void NodePoolMainScene::step(ccTime dt)
+{
+    ++m_uFrame;
+    ++m_uStatsFrames;
+
+    double dStart = m_pClock->now();
+
+    while (! m_liveBullets.empty() && m_liveBullets.front().uFrame + kLifetimeFrames <= m_uFrame)
+    {
+        despawn(m_liveBullets.front().pSprite);
+        m_liveBullets.pop_front();
+    }
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    for (int i = 0; i < kSpawnsPerFrame; ++i)
+    {
+        CCSprite *pSprite = spawn();
+        if (! pSprite)
+        {
+            ++m_uFailedSpawns;
+            continue;
+        }
+
+        // state the pool has to reset when the bullet comes back
+        float y = ((m_uFrame * kSpawnsPerFrame + i) * 37 % 100) / 100.0f * s.height;
+        pSprite->setPosition(ccp(0, y));
+        pSprite->setOpacity(128 + i * 6);
+        pSprite->setColor(ccc3(255, 255 - i * 10, 255 - i * 10));
+        pSprite->runAction(CCMoveBy::actionWithDuration(kLifetimeFrames / 60.0f, ccp(s.width, 0)));
+
+        LiveBullet bullet = {pSprite, m_uFrame};
+        m_liveBullets.push_back(bullet);
+        ++m_uSpawns;
+    }
+
+    m_dSpawnTime += m_pClock->now() - dStart;
+}
+
+void NodePoolMainScene::showStats(ccTime dt)
+{
+    if (! m_uStatsFrames)
+    {
+        return;
+    }
+
+    char szStats[256];
+    sprintf(szStats, "%u bullets alive, spawn + despawn %.3f ms/frame, %.0f spawns/ms, %u failed\n%s",
+        (unsigned int)m_liveBullets.size(), m_dSpawnTime * 1000 / m_uStatsFrames,
+        m_dSpawnTime > 0 ? m_uSpawns / (m_dSpawnTime * 1000) : 0.0, m_uFailedSpawns, poolStats().c_str());
+    m_pStatsLabel->setString(szStats);
+
+    m_uSpawns = 0;
+    m_uFailedSpawns = 0;
+    m_uStatsFrames = 0;
+    m_dSpawnTime = 0;
+}
+
+std::string NodePoolMainScene::poolStats()
+{
+    return "";
+}
+
+std::string NodePoolMainScene::title()
+{
+    return "no title";
+}
+
+std::string NodePoolMainScene::subtitle()
+{
+    char str[128] = {0};
+    sprintf(str, "%d bullets fired a frame, removed after %u frames", kSpawnsPerFrame, kLifetimeFrames);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// NodePoolCreateTest
+//
+////////////////////////////////////////////////////////
+CCSprite* NodePoolCreateTest::spawn()
+{
+    CCSprite *pSprite = CCSprite::spriteWithFile(s_pszBulletImage);
+    addChild(pSprite);
+    return pSprite;
+}
+
+void NodePoolCreateTest::despawn(CCSprite* pSprite)
+{
+    removeChild(pSprite, true);
+}
+
+std::string NodePoolCreateTest::title()
+{
+    return "A) spriteWithFile + removeChild";
+}
+
+////////////////////////////////////////////////////////
+//
+// NodePoolRecycleTest
+//
+////////////////////////////////////////////////////////
+NodePoolRecycleTest::~NodePoolRecycleTest()
+{
+    CC_SAFE_RELEASE(m_pPool);
+}
+
+void NodePoolRecycleTest::onEnter()
+{
+    if (! m_pPool)
+    {
+        // room for the bullets alive at once, and some for the frames that run late
+        unsigned int uAlive = kSpawnsPerFrame * kLifetimeFrames;
+        m_pPool = CCSpritePool::poolWithFile(s_pszBulletImage, uAlive, uAlive * 2);
+        CC_SAFE_RETAIN(m_pPool);
+    }
+
+    NodePoolMainScene::onEnter();
+}
+
+CCSprite* NodePoolRecycleTest::spawn()
+{
+    CCSprite *pSprite = m_pPool ? m_pPool->acquireSprite() : NULL;
+    if (pSprite)
+    {
+        addChild(pSprite);
+    }
+    return pSprite;
+}
+
+void NodePoolRecycleTest::despawn(CCSprite* pSprite)
+{
+    m_pPool->recycle(pSprite);
+}
+
+std::string NodePoolRecycleTest::poolStats()
+{
+    if (! m_pPool)
+    {
+        return "no pool";
+    }
+
+    const ccNodePoolStats& stats = m_pPool->getStats();
+    char str[256];
+    sprintf(str, "pool: %u hits, %u misses, %u refused, %u created, %u in use (peak %u), %u idle",
+        stats.uHits, stats.uMisses, stats.uRefusals, stats.uCreated, stats.uInUse, stats.uPeakInUse, m_pPool->getIdleCount());
+    return str;
+}
+
+std::string NodePoolRecycleTest::title()
+{
+    return "B) CCSpritePool";
+}
+
+void runNodePoolTest()
+{
+    s_nNodePoolCurCase = 0;
+    NodePoolMainScene* pLayer = new NodePoolCreateTest(true, TEST_COUNT, s_nNodePoolCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
@@ -0,0 +1,79 @@
+#ifndef __PERFORMANCE_NODE_POOL_TEST_H__
+#define __PERFORMANCE_NODE_POOL_TEST_H__
+
+#include "PerformanceTest.h"
+#include <deque>
+
+class NodePoolMainScene : public PerformBasicLayer
+{
+public:
+    NodePoolMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0);
+    virtual ~NodePoolMainScene();
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual void onExit();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    // a bullet added to the layer, NULL if none could be spawned
+    virtual CCSprite* spawn() = 0;
+    virtual void despawn(CCSprite* pSprite) = 0;
+    virtual std::string poolStats();
+
+    void step(ccTime dt);
+    void showStats(ccTime dt);
+
+protected:
+    typedef struct _LiveBullet
+    {
+        CCSprite* pSprite;
+        unsigned int uFrame;
+    } LiveBullet;
+
+    std::deque<LiveBullet> m_liveBullets;
+    CCFrameClock* m_pClock;
+    CCLabelTTF* m_pStatsLabel;
+    unsigned int m_uFrame;
+    unsigned int m_uSpawns;
+    unsigned int m_uFailedSpawns;
+    unsigned int m_uStatsFrames;
+    double m_dSpawnTime;
+};
+
+class NodePoolCreateTest : public NodePoolMainScene
+{
+public:
+    NodePoolCreateTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : NodePoolMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual CCSprite* spawn();
+    virtual void despawn(CCSprite* pSprite);
+    virtual std::string title();
+};
+
+class NodePoolRecycleTest : public NodePoolMainScene
+{
+public:
+    NodePoolRecycleTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : NodePoolMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+        , m_pPool(NULL)
+    {
+    }
+    virtual ~NodePoolRecycleTest();
+
+    virtual void onEnter();
+    virtual CCSprite* spawn();
+    virtual void despawn(CCSprite* pSprite);
+    virtual std::string poolStats();
+    virtual std::string title();
+
+protected:
+    CCSpritePool* m_pPool;
+};
+
+void runNodePoolTest();
+
+#endif
@@ -0,0 +1,220 @@
+#include "PerformancePipelineTest.h"
+
+enum
+{
+    TEST_COUNT = 3,
+};
+
+// not batched: every sprite is a draw call to record and to replay
+static const int kNumberOfSprites = 1500;
+// sin/cos evaluations per sprite and frame, stands for the game logic
+static const int kUpdateWork = 20;
+
+static int s_nPipelineCurCase = 0;
+
+////////////////////////////////////////////////////////
+//
+// PipelineMainScene
+//
+////////////////////////////////////////////////////////
+void PipelineMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new PipelineSerialTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new PipelinePipelinedTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 2:
+        pLayer = new PipelineOnScreenTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nPipelineCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void PipelineMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    for (int i = 0; i < kNumberOfSprites; ++i)
+    {
+        CCSprite *sprite = CCSprite::spriteWithFile("Images/grossini_dance_01.png");
+        sprite->setPosition(ccp(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height));
+        sprite->setScale(0.5f);
+        addChild(sprite, 0, i);
+    }
+
+    m_plabel = CCLabelBMFont::labelWithString("00.0", "fonts/arial16.fnt");
+    m_plabel->setPosition(ccp(s.width/2, s.height/2));
+    addChild(m_plabel, 1);
+
+    m_pClock = new CCFrameClock();
+    m_dMeasureStart = m_pClock->now();
+    numberOfFrames = 0;
+    m_fTime = 0;
+
+    setupDirector();
+    CCDirector::sharedDirector()->getRenderPipeline()->resetStats();
+
+    scheduleUpdate();
+}
+
+void PipelineMainScene::onExit()
+{
+    CCDirector* pDirector = CCDirector::sharedDirector();
+    pDirector->setRenderPipelined(false);
+    pDirector->getRenderPipeline()->setBackend(NULL);
+
+    CC_SAFE_RELEASE_NULL(m_pClock);
+
+    PerformBasicLayer::onExit();
+}
+
+void PipelineMainScene::update(ccTime dt)
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    m_fTime += dt;
+    for (int i = 0; i < kNumberOfSprites; ++i)
+    {
+        float x = 0, y = 0;
+        for (int j = 0; j < kUpdateWork; ++j)
+        {
+            float fPhase = m_fTime * (1 + j * 0.1f) + i;
+            x += sinf(fPhase);
+            y += cosf(fPhase * 0.7f);
+        }
+
+        CCNode* pSprite = getChildByTag(i);
+        pSprite->setPosition(ccp(s.width * (0.5f + x / (kUpdateWork * 2)), s.height * (0.5f + y / (kUpdateWork * 2))));
+        pSprite->setRotation(m_fTime * 90 + i);
+    }
+
+    ++numberOfFrames;
+    double dElapsed = m_pClock->now() - m_dMeasureStart;
+    if (dElapsed > 1.0)
+    {
+        const ccRenderPipelineStats& stats = CCDirector::sharedDirector()->getRenderPipeline()->getStats();
+
+        char str[128] = {0};
+        sprintf(str, "%.1f frames/s", numberOfFrames / dElapsed);
+        if (stats.uFramesSubmitted)
+        {
+            sprintf(str + strlen(str), ", wait %.2f ms, replay %.2f ms",
+                stats.dTotalSubmitWait * 1000 / stats.uFramesSubmitted,
+                stats.uFramesExecuted ? stats.dTotalReplayTime * 1000 / stats.uFramesExecuted : 0.0);
+        }
+        m_plabel->setString(str);
+
+        CCLog("%s: %s", title().c_str(), str);
+
+        CCDirector::sharedDirector()->getRenderPipeline()->resetStats();
+        m_dMeasureStart = m_pClock->now();
+        numberOfFrames = 0;
+    }
+}
+
+std::string PipelineMainScene::title()
+{
+    return "no title";
+}
+
+std::string PipelineMainScene::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d sprites, not batched, moved every frame", kNumberOfSprites);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// PipelineSerialTest
+//
+////////////////////////////////////////////////////////
+void PipelineSerialTest::setupDirector()
+{
+    CCDirector* pDirector = CCDirector::sharedDirector();
+    pDirector->setRenderPipelined(false);
+
+    CCRenderBackend* pBackend = new CCHeadlessRenderBackend();
+    pDirector->getRenderPipeline()->setBackend(pBackend);
+    pBackend->release();
+}
+
+std::string PipelineSerialTest::title()
+{
+    return "A) serial, headless";
+}
+
+////////////////////////////////////////////////////////
+//
+// PipelinePipelinedTest
+//
+////////////////////////////////////////////////////////
+void PipelinePipelinedTest::setupDirector()
+{
+    CCDirector* pDirector = CCDirector::sharedDirector();
+
+    CCRenderBackend* pBackend = new CCHeadlessRenderBackend();
+    pDirector->getRenderPipeline()->setBackend(pBackend);
+    pBackend->release();
+
+    pDirector->setRenderPipelined(true);
+}
+
+std::string PipelinePipelinedTest::title()
+{
+    return "B) pipelined, headless";
+}
+
+////////////////////////////////////////////////////////
+//
+// PipelineOnScreenTest
+//
+////////////////////////////////////////////////////////
+void PipelineOnScreenTest::setupDirector()
+{
+    CCDirector* pDirector = CCDirector::sharedDirector();
+    pDirector->getRenderPipeline()->setBackend(NULL);
+    pDirector->setRenderPipelined(true);
+}
+
+std::string PipelineOnScreenTest::title()
+{
+    return "C) pipelined, on screen";
+}
+
+void runPipelineTest()
+{
+    s_nPipelineCurCase = 0;
+    PipelineMainScene* pLayer = new PipelineSerialTest(true, TEST_COUNT, s_nPipelineCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
@@ -0,0 +1,70 @@
+#ifndef __PERFORMANCE_PIPELINE_TEST_H__
+#define __PERFORMANCE_PIPELINE_TEST_H__
+
+#include "PerformanceTest.h"
+
+class PipelineMainScene : public PerformBasicLayer
+{
+public:
+    PipelineMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual void onExit();
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void update(ccTime dt);
+
+    /** put the director in the mode this case measures */
+    virtual void setupDirector() = 0;
+
+protected:
+    CCLabelBMFont *     m_plabel;
+    CCFrameClock *      m_pClock;
+    double              m_dMeasureStart;
+    int                 numberOfFrames;
+    float               m_fTime;
+};
+
+class PipelineSerialTest : public PipelineMainScene
+{
+public:
+    PipelineSerialTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PipelineMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void setupDirector();
+    virtual std::string title();
+};
+
+class PipelinePipelinedTest : public PipelineMainScene
+{
+public:
+    PipelinePipelinedTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PipelineMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void setupDirector();
+    virtual std::string title();
+};
+
+class PipelineOnScreenTest : public PipelineMainScene
+{
+public:
+    PipelineOnScreenTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PipelineMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void setupDirector();
+    virtual std::string title();
+};
+
+void runPipelineTest();
+
+#endif
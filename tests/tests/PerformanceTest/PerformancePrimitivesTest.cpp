@@ -0,0 +1,180 @@
+#include "PerformancePrimitivesTest.h"
+
+enum
+{
+    TEST_COUNT = 2,
+};
+
+// a debug overlay: boxes outlined with lines, circles and a point on each
+static const int kNumberOfShapes = 1000;
+static const int kCircleSegments = 16;
+
+static int s_nPrimitivesCurCase = 0;
+
+////////////////////////////////////////////////////////
+//
+// PrimitivesMainScene
+//
+////////////////////////////////////////////////////////
+PrimitivesMainScene::PrimitivesMainScene(bool bControlMenuVisible, int nMaxCases, int nCurCase)
+    : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+{
+    m_pClock = new CCFrameClock();
+}
+
+PrimitivesMainScene::~PrimitivesMainScene()
+{
+    m_pClock->release();
+}
+
+void PrimitivesMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new PrimitivesEachTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new PrimitivesBatchedTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nPrimitivesCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void PrimitivesMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    m_plabel = CCLabelTTF::labelWithString("measuring...", "Arial", 20);
+    m_plabel->setPosition(ccp(s.width/2, s.height/2));
+    addChild(m_plabel, 1);
+
+    m_dMeasureStart = m_pClock->now();
+    m_dDrawTime = 0;
+    numberOfFrames = 0;
+    m_uFlushCountStart = CCDrawingPrimitive::getFlushCount();
+}
+
+void PrimitivesMainScene::draw()
+{
+    PerformBasicLayer::draw();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    bool bFlushEach = flushEachPrimitive();
+
+    double dStart = m_pClock->now();
+    for (int i = 0; i < kNumberOfShapes; ++i)
+    {
+        // the same shapes every frame, spread over the screen
+        float x = (i * 37 % 100) / 100.0f * s.width;
+        float y = (i * 61 % 100) / 100.0f * s.height;
+        CCPoint box[4] = {ccp(x - 8, y - 8), ccp(x + 8, y - 8), ccp(x + 8, y + 8), ccp(x - 8, y + 8)};
+
+        CCDrawingPrimitive::D3DColor4f(0.5f, 1.0f, 0.5f, 1.0f);
+        ccDrawPoly(box, 4, true);
+        if (bFlushEach)
+        {
+            ccDrawFlush();
+        }
+
+        CCDrawingPrimitive::D3DColor4f(1.0f, 0.5f, 0.5f, 1.0f);
+        ccDrawCircle(ccp(x, y), 12, 0, kCircleSegments, true);
+        if (bFlushEach)
+        {
+            ccDrawFlush();
+        }
+
+        ccDrawPoint(ccp(x, y));
+        if (bFlushEach)
+        {
+            ccDrawFlush();
+        }
+    }
+    ccDrawFlush();
+    m_dDrawTime += m_pClock->now() - dStart;
+
+    ++numberOfFrames;
+    double dElapsed = m_pClock->now() - m_dMeasureStart;
+    if (dElapsed > 1.0)
+    {
+        unsigned int uFlushes = CCDrawingPrimitive::getFlushCount() - m_uFlushCountStart;
+
+        char str[128] = {0};
+        sprintf(str, "%.3f ms/frame, %.0f flushes/frame, %u primitives in the last flush",
+            m_dDrawTime * 1000 / numberOfFrames, (double)uFlushes / numberOfFrames,
+            CCDrawingPrimitive::getLastFlushPrimitives());
+        m_plabel->setString(str);
+
+        CCLog("%s: %s", title().c_str(), str);
+
+        m_dMeasureStart = m_pClock->now();
+        m_dDrawTime = 0;
+        numberOfFrames = 0;
+        m_uFlushCountStart = CCDrawingPrimitive::getFlushCount();
+    }
+}
+
+std::string PrimitivesMainScene::title()
+{
+    return "no title";
+}
+
+std::string PrimitivesMainScene::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d boxes, circles and points drawn every frame", kNumberOfShapes);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// PrimitivesEachTest
+//
+////////////////////////////////////////////////////////
+std::string PrimitivesEachTest::title()
+{
+    return "A) flush after each primitive";
+}
+
+////////////////////////////////////////////////////////
+//
+// PrimitivesBatchedTest
+//
+////////////////////////////////////////////////////////
+std::string PrimitivesBatchedTest::title()
+{
+    return "B) batched";
+}
+
+void runPrimitivesTest()
+{
+    s_nPrimitivesCurCase = 0;
+    PrimitivesMainScene* pLayer = new PrimitivesEachTest(true, TEST_COUNT, s_nPrimitivesCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
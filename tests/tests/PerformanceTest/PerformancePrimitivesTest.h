@@ -0,0 +1,56 @@
+#ifndef __PERFORMANCE_PRIMITIVES_TEST_H__
+#define __PERFORMANCE_PRIMITIVES_TEST_H__
+
+#include "PerformanceTest.h"
+
+class PrimitivesMainScene : public PerformBasicLayer
+{
+public:
+    PrimitivesMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0);
+    virtual ~PrimitivesMainScene();
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void draw();
+
+    /** whether every primitive is flushed on its own, as before the batching */
+    virtual bool flushEachPrimitive() = 0;
+
+protected:
+    CCFrameClock*   m_pClock;
+    CCLabelTTF*     m_plabel;
+    double          m_dMeasureStart;
+    double          m_dDrawTime;
+    int             numberOfFrames;
+    unsigned int    m_uFlushCountStart;
+};
+
+class PrimitivesEachTest : public PrimitivesMainScene
+{
+public:
+    PrimitivesEachTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PrimitivesMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual bool flushEachPrimitive() { return true; }
+    virtual std::string title();
+};
+
+class PrimitivesBatchedTest : public PrimitivesMainScene
+{
+public:
+    PrimitivesBatchedTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PrimitivesMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual bool flushEachPrimitive() { return false; }
+    virtual std::string title();
+};
+
+void runPrimitivesTest();
+
+#endif
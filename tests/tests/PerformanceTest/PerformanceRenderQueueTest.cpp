@@ -0,0 +1,169 @@
+#include "PerformanceRenderQueueTest.h"
+
+enum
+{
+    TEST_COUNT = 2,
+};
+
+static const int kNumberOfSprites = 500;
+
+static int s_nRenderQueueCurCase = 0;
+
+static const char* s_pszRenderQueueStates[kCCRenderStateCount] =
+{
+    "program", "texture", "sampler", "blend", "topology", "vertices", "indices", "vs consts", "ps consts",
+};
+
+////////////////////////////////////////////////////////
+//
+// RenderQueueMainScene
+//
+////////////////////////////////////////////////////////
+void RenderQueueMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new RenderQueueOrderedTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new RenderQueueSortedTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nRenderQueueCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void RenderQueueMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    // the sprites alternate two textures and two blend functions, drawn in
+    // submission order every sprite changes both
+    CCNode *pParent = CCNode::node();
+    pParent->setIsOrderIndependent(isOrderIndependent());
+    addChild(pParent);
+
+    ccBlendFunc additive = {CC_SRC_ALPHA, CC_ONE};
+    for (int i = 0; i < kNumberOfSprites; ++i)
+    {
+        CCSprite *pSprite = CCSprite::spriteWithFile((i % 2) ? "Images/grossinis_sister2.png" : "Images/grossinis_sister1.png");
+        if ((i / 2) % 2)
+        {
+            pSprite->setBlendFunc(additive);
+        }
+        pSprite->setScale(0.3f);
+        pSprite->setPosition(ccp((i * 37 % 100) / 100.0f * s.width, (i * 61 % 100) / 100.0f * s.height));
+        pSprite->runAction(CCRepeatForever::actionWithAction(CCRotateBy::actionWithDuration(2, 360)));
+        pParent->addChild(pSprite);
+    }
+
+    m_pStatsLabel = CCLabelTTF::labelWithString("", CCSizeMake(s.width - 40, 220), CCTextAlignmentLeft, "Courier New", 14);
+    addChild(m_pStatsLabel, 1);
+    m_pStatsLabel->setPosition(ccp(s.width/2, s.height - 200));
+
+    CCRenderQueue::sharedRenderQueue()->resetStats();
+    schedule(schedule_selector(RenderQueueMainScene::showStats), 1.0f);
+}
+
+void RenderQueueMainScene::showStats(ccTime dt)
+{
+    CCRenderQueue *pQueue = CCRenderQueue::sharedRenderQueue();
+    const ccRenderQueueStats& stats = pQueue->getStats();
+
+    unsigned int uChanges = 0;
+    unsigned int uAvoided = 0;
+    char szStats[1024];
+    int n = sprintf(szStats, "%u draws, %u sorted in %u ranges\n", stats.uPackets, stats.uSortedPackets, stats.uSortedRanges);
+    for (int i = 0; i < kCCRenderStateCount; ++i)
+    {
+        n += sprintf(szStats + n, "%-9s: %6u binds, %6u skipped\n", s_pszRenderQueueStates[i], stats.uChanges[i], stats.uAvoided[i]);
+        uChanges += stats.uChanges[i];
+        uAvoided += stats.uAvoided[i];
+    }
+    sprintf(szStats + n, "total    : %6u binds, %6u skipped, in the last second", uChanges, uAvoided);
+    m_pStatsLabel->setString(szStats);
+
+    pQueue->resetStats();
+}
+
+void RenderQueueMainScene::onExit()
+{
+    unschedule(schedule_selector(RenderQueueMainScene::showStats));
+
+    PerformBasicLayer::onExit();
+}
+
+std::string RenderQueueMainScene::title()
+{
+    return "no title";
+}
+
+std::string RenderQueueMainScene::subtitle()
+{
+    char str[128] = {0};
+    sprintf(str, "%d rotating sprites, 2 textures x 2 blend functions, interleaved", kNumberOfSprites);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// RenderQueueOrderedTest
+//
+////////////////////////////////////////////////////////
+bool RenderQueueOrderedTest::isOrderIndependent()
+{
+    return false;
+}
+
+std::string RenderQueueOrderedTest::title()
+{
+    return "A) submission order";
+}
+
+////////////////////////////////////////////////////////
+//
+// RenderQueueSortedTest
+//
+////////////////////////////////////////////////////////
+bool RenderQueueSortedTest::isOrderIndependent()
+{
+    return true;
+}
+
+std::string RenderQueueSortedTest::title()
+{
+    return "B) order independent, sorted";
+}
+
+void runRenderQueueTest()
+{
+    s_nRenderQueueCurCase = 0;
+    RenderQueueMainScene* pLayer = new RenderQueueOrderedTest(true, TEST_COUNT, s_nRenderQueueCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
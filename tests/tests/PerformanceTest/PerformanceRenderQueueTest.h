@@ -0,0 +1,53 @@
+#ifndef __PERFORMANCE_RENDER_QUEUE_TEST_H__
+#define __PERFORMANCE_RENDER_QUEUE_TEST_H__
+
+#include "PerformanceTest.h"
+
+class RenderQueueMainScene : public PerformBasicLayer
+{
+public:
+    RenderQueueMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+        , m_pStatsLabel(NULL)
+    {
+    }
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual void onExit();
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual bool isOrderIndependent() = 0;
+    void showStats(ccTime dt);
+
+protected:
+    CCLabelTTF* m_pStatsLabel;
+};
+
+class RenderQueueOrderedTest : public RenderQueueMainScene
+{
+public:
+    RenderQueueOrderedTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : RenderQueueMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual bool isOrderIndependent();
+    virtual std::string title();
+};
+
+class RenderQueueSortedTest : public RenderQueueMainScene
+{
+public:
+    RenderQueueSortedTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : RenderQueueMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual bool isOrderIndependent();
+    virtual std::string title();
+};
+
+void runRenderQueueTest();
+
+#endif
@@ -0,0 +1,195 @@
+#include "PerformanceRenderTargetTest.h"
+
+enum
+{
+    TEST_COUNT = 2,
+};
+
+// a cross fade takes two full screen render textures when it starts
+static const unsigned int kFramesPerTransition = 30;
+static const unsigned int kLimitedMemory = 4 * 1024 * 1024;
+
+static int s_nRenderTargetCurCase = 0;
+
+////////////////////////////////////////////////////////
+//
+// RenderTargetMainScene
+//
+////////////////////////////////////////////////////////
+void RenderTargetMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new RenderTargetReuseTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new RenderTargetMemoryLimitTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nRenderTargetCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void RenderTargetMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    m_pStatsLabel = CCLabelTTF::labelWithString("", CCSizeMake(s.width - 40, 100), CCTextAlignmentLeft, "Courier New", 14);
+    addChild(m_pStatsLabel, 1);
+    m_pStatsLabel->setPosition(ccp(s.width/2, s.height/2));
+
+    const ccRenderTargetPoolStats& stats = CCRenderTargetPool::sharedRenderTargetPool()->getStats();
+    m_uLastAllocations = stats.uTotalAllocations;
+    m_uLastReuses = stats.uTotalReuses;
+
+    schedule(schedule_selector(RenderTargetMainScene::step));
+    schedule(schedule_selector(RenderTargetMainScene::showStats), 1.0f);
+}
+
+void RenderTargetMainScene::onExit()
+{
+    unschedule(schedule_selector(RenderTargetMainScene::step));
+    unschedule(schedule_selector(RenderTargetMainScene::showStats));
+
+    PerformBasicLayer::onExit();
+}
+
+void RenderTargetMainScene::step(ccTime dt)
+{
+    ++m_uFrame;
+
+    // like a transition starting: the render textures are dropped at the end of the
+    // frame when the autorelease pool is drained, and their targets recycled
+    CCSize size = sizeForFrame(m_uFrame);
+    CCRenderTexture::renderTextureWithWidthAndHeight((int)size.width, (int)size.height);
+    CCRenderTexture::renderTextureWithWidthAndHeight((int)size.width, (int)size.height);
+}
+
+void RenderTargetMainScene::showStats(ccTime dt)
+{
+    CCRenderTargetPool *pPool = CCRenderTargetPool::sharedRenderTargetPool();
+    const ccRenderTargetPoolStats& stats = pPool->getStats();
+
+    unsigned int uAllocations = stats.uTotalAllocations - m_uLastAllocations;
+    unsigned int uReuses = stats.uTotalReuses - m_uLastReuses;
+    m_uLastAllocations = stats.uTotalAllocations;
+    m_uLastReuses = stats.uTotalReuses;
+
+    char szStats[512];
+    sprintf(szStats, "last second: %u targets created (misses), %u reused (hits)\n"
+        "total      : %u created, %u reused, %u evicted\n"
+        "memory     : %u KB idle, %u KB in use, %u KB peak, limit %u KB",
+        uAllocations, uReuses,
+        stats.uTotalAllocations, stats.uTotalReuses, stats.uEvictions,
+        stats.uPooledBytes / 1024, stats.uInUseBytes / 1024, stats.uPeakBytes / 1024, pPool->getMemoryLimit() / 1024);
+    m_pStatsLabel->setString(szStats);
+}
+
+std::string RenderTargetMainScene::title()
+{
+    return "no title";
+}
+
+std::string RenderTargetMainScene::subtitle()
+{
+    return "";
+}
+
+////////////////////////////////////////////////////////
+//
+// RenderTargetReuseTest
+//
+////////////////////////////////////////////////////////
+CCSize RenderTargetReuseTest::sizeForFrame(unsigned int uFrame)
+{
+    // a transition every kFramesPerTransition frames, alternately full and half screen
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    if ((uFrame / kFramesPerTransition) % 2)
+    {
+        return CCSizeMake(s.width / 2, s.height / 2);
+    }
+    return s;
+}
+
+std::string RenderTargetReuseTest::title()
+{
+    return "A) transitions";
+}
+
+std::string RenderTargetReuseTest::subtitle()
+{
+    return "2 render textures a frame, full or half screen";
+}
+
+////////////////////////////////////////////////////////
+//
+// RenderTargetMemoryLimitTest
+//
+////////////////////////////////////////////////////////
+void RenderTargetMemoryLimitTest::onEnter()
+{
+    CCRenderTargetPool *pPool = CCRenderTargetPool::sharedRenderTargetPool();
+    m_uOldMemoryLimit = pPool->getMemoryLimit();
+    pPool->setMemoryLimit(kLimitedMemory);
+
+    RenderTargetMainScene::onEnter();
+}
+
+void RenderTargetMemoryLimitTest::onExit()
+{
+    CCRenderTargetPool::sharedRenderTargetPool()->setMemoryLimit(m_uOldMemoryLimit);
+
+    RenderTargetMainScene::onExit();
+}
+
+CCSize RenderTargetMemoryLimitTest::sizeForFrame(unsigned int uFrame)
+{
+    // 64x64 up to 1024x1024, the idle targets of all sizes don't fit in the limit
+    float fSide = (float)(64 << (uFrame % 5));
+    return CCSizeMake(fSide, fSide);
+}
+
+std::string RenderTargetMemoryLimitTest::title()
+{
+    return "B) memory limit";
+}
+
+std::string RenderTargetMemoryLimitTest::subtitle()
+{
+    char str[128] = {0};
+    sprintf(str, "2 render textures a frame, 64 to 1024 pixels wide, %u KB limit", kLimitedMemory / 1024);
+    return str;
+}
+
+void runRenderTargetTest()
+{
+    s_nRenderTargetCurCase = 0;
+    RenderTargetMainScene* pLayer = new RenderTargetReuseTest(true, TEST_COUNT, s_nRenderTargetCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
@@ -0,0 +1,70 @@
+#ifndef __PERFORMANCE_RENDER_TARGET_TEST_H__
+#define __PERFORMANCE_RENDER_TARGET_TEST_H__
+
+#include "PerformanceTest.h"
+
+class RenderTargetMainScene : public PerformBasicLayer
+{
+public:
+    RenderTargetMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+        , m_pStatsLabel(NULL)
+        , m_uFrame(0)
+        , m_uLastAllocations(0)
+        , m_uLastReuses(0)
+    {
+    }
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual void onExit();
+    virtual std::string title();
+    virtual std::string subtitle();
+    // size of the render texture created in this frame
+    virtual CCSize sizeForFrame(unsigned int uFrame) = 0;
+
+    void step(ccTime dt);
+    void showStats(ccTime dt);
+
+protected:
+    CCLabelTTF* m_pStatsLabel;
+    unsigned int m_uFrame;
+    unsigned int m_uLastAllocations;
+    unsigned int m_uLastReuses;
+};
+
+class RenderTargetReuseTest : public RenderTargetMainScene
+{
+public:
+    RenderTargetReuseTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : RenderTargetMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual CCSize sizeForFrame(unsigned int uFrame);
+    virtual std::string title();
+    virtual std::string subtitle();
+};
+
+class RenderTargetMemoryLimitTest : public RenderTargetMainScene
+{
+public:
+    RenderTargetMemoryLimitTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : RenderTargetMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+        , m_uOldMemoryLimit(0)
+    {
+    }
+
+    virtual void onEnter();
+    virtual void onExit();
+    virtual CCSize sizeForFrame(unsigned int uFrame);
+    virtual std::string title();
+    virtual std::string subtitle();
+
+protected:
+    unsigned int m_uOldMemoryLimit;
+};
+
+void runRenderTargetTest();
+
+#endif
@@ -5,10 +5,19 @@
 #include "PerformanceSpriteTest.h"
 #include "PerformanceTextureTest.h"
 #include "PerformanceTouchesTest.h"
+#include "PerformanceAllocTest.h"
+#include "PerformanceTweenTest.h"
+#include "PerformancePipelineTest.h"
+#include "PerformanceGridTest.h"
+#include "PerformancePrimitivesTest.h"
+#include "PerformanceBufferTest.h"
+#include "PerformanceRenderQueueTest.h"
+#include "PerformanceNodePoolTest.h"
+#include "PerformanceRenderTargetTest.h"
 
 enum
 {
-    MAX_COUNT = 5,
+    MAX_COUNT = 14,
     LINE_SPACE = 40,
     kItemTagBasic = 1000,
 };
@@ -19,7 +28,16 @@ const std::string testsName[MAX_COUNT] =
     "PerformanceParticleTest",
     "PerformanceSpriteTest",
     "PerformanceTextureTest",
-    "PerformanceTouchesTest"
+    "PerformanceTouchesTest",
+    "PerformanceAllocTest",
+    "PerformanceTweenTest",
+    "PerformancePipelineTest",
+    "PerformanceGridTest",
+    "PerformancePrimitivesTest",
+    "PerformanceBufferTest",
+    "PerformanceRenderQueueTest",
+    "PerformanceNodePoolTest",
+    "PerformanceRenderTargetTest"
 };
 
 ////////////////////////////////////////////////////////
@@ -70,6 +88,33 @@ void PerformanceMainLayer::menuCallback(CCObject* pSender)
     case 4:
         runTouchesTest();
         break;
+    case 5:
+        runAllocTest();
+        break;
+    case 6:
+        runTweenTest();
+        break;
+    case 7:
+        runPipelineTest();
+        break;
+    case 8:
+        runGridTest();
+        break;
+    case 9:
+        runPrimitivesTest();
+        break;
+    case 10:
+        runBufferTest();
+        break;
+    case 11:
+        runRenderQueueTest();
+        break;
+    case 12:
+        runNodePoolTest();
+        break;
+    case 13:
+        runRenderTargetTest();
+        break;
     default:
         break;
     }
@@ -1,8 +1,15 @@
 #include "PerformanceTextureTest.h"
+#include "support/image_support/ccBCn.h"
+#include "support/image_support/ccMipmap.h"
+#include "support/image_support/ccTexturePayload.h"
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
 
 enum
 {
-    TEST_COUNT = 1,
+    TEST_COUNT = 6,
 };
 
 static int s_nTexCurCase = 0;
@@ -32,6 +39,21 @@ void TextureMenuLayer::showCurrentTest()
     case 0:
         pScene = TextureTest::scene();
         break;
+    case 1:
+        pScene = TextureCompressTest::scene();
+        break;
+    case 2:
+        pScene = TextureMipmapTest::scene();
+        break;
+    case 3:
+        pScene = TextureAtlasTest::scene();
+        break;
+    case 4:
+        pScene = TextureResidencyTest::scene();
+        break;
+    case 5:
+        pScene = TextureDecodeCacheTest::scene();
+        break;
     }
     s_nTexCurCase = m_nCurCase;
 
@@ -345,7 +367,664 @@ std::string TextureTest::subtitle()
 CCScene* TextureTest::scene()
 {
     CCScene *pScene = CCScene::node();
-    TextureTest *layer = new TextureTest(false, TEST_COUNT, s_nTexCurCase);
+    TextureTest *layer = new TextureTest(true, TEST_COUNT, s_nTexCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextureCompressTest
+//
+////////////////////////////////////////////////////////
+static std::string formatResult(const char* pszName, CCTexture2D* texture, double dCreate)
+{
+    unsigned int uBytes = texture->getMemorySize();
+    unsigned int uPixels = texture->getPixelsWide() * texture->getPixelsHigh();
+    char szLine[128];
+
+    // the bandwidth is what the upload moved, sampling the whole texture once reads as much
+    sprintf(szLine, "%-10s %5u KB %4.1f bpp  create %7.2f ms %6.0f MB/s", pszName, uBytes / 1024,
+        uBytes * 8.0f / uPixels, dCreate * 1000.0, dCreate > 0 ? uBytes / dCreate / (1024.0 * 1024.0) : 0.0);
+    return szLine;
+}
+
+std::string TextureCompressTest::performTestsFormats(const char* filename)
+{
+    std::string strResult = std::string(filename) + "\n";
+
+    CCImage image;
+    if (! image.initWithImageFile(CCFileUtils::fullPathFromRelativePath(filename)))
+    {
+        CCLog(" ERROR\n");
+        return strResult;
+    }
+
+    // the encoder wants RGBA8888, CCImage keeps the opaque images in RGB888
+    unsigned int uWidth = image.getWidth();
+    unsigned int uHeight = image.getHeight();
+    unsigned int uPixels = uWidth * uHeight;
+    unsigned char *pRGBA = new unsigned char[uPixels * 4];
+    if (image.hasAlpha())
+    {
+        memcpy(pRGBA, image.getData(), uPixels * 4);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < uPixels; ++i)
+        {
+            memcpy(pRGBA + i * 4, image.getData() + i * 3, 3);
+            pRGBA[i * 4 + 3] = 255;
+        }
+    }
+
+    CCFrameClock *pClock = new CCFrameClock();
+    CCTexture2D *texture;
+    double dStart;
+
+    // uncompressed formats, converted by CCTexture2D
+    static const CCTexture2DPixelFormat s_eFormats[] = {
+        kCCTexture2DPixelFormat_RGBA8888, kCCTexture2DPixelFormat_RGBA4444, kCCTexture2DPixelFormat_RGB565,
+    };
+    static const char* s_pszFormatNames[] = { "RGBA 8888", "RGBA 4444", "RGB 565" };
+
+    CCTexture2DPixelFormat eOldFormat = CCTexture2D::defaultAlphaPixelFormat();
+    for (unsigned int i = 0; i < sizeof(s_eFormats) / sizeof(s_eFormats[0]); ++i)
+    {
+        CCTexture2D::setDefaultAlphaPixelFormat(s_eFormats[i]);
+        texture = new CCTexture2D();
+        dStart = pClock->now();
+        texture->initWithImage(&image);
+        std::string strLine = formatResult(s_pszFormatNames[i], texture, pClock->now() - dStart);
+        texture->release();
+
+        CCLog("%s", strLine.c_str());
+        strResult += strLine + "\n";
+    }
+    CCTexture2D::setDefaultAlphaPixelFormat(eOldFormat);
+
+    // block compressed formats, encoded here and decoded back on the CPU to measure the error
+    static const ccBCnFormat s_eBCnFormats[] = { kCCBCnFormat_BC1, kCCBCnFormat_BC3 };
+    static const CCTexture2DPixelFormat s_eBCnPixelFormats[] = { kCCTexture2DPixelFormat_BC1, kCCTexture2DPixelFormat_BC3 };
+    static const char* s_pszBCnNames[] = { "BC1", "BC3" };
+
+    unsigned char *pDecoded = new unsigned char[uPixels * 4];
+    for (unsigned int i = 0; i < sizeof(s_eBCnFormats) / sizeof(s_eBCnFormats[0]); ++i)
+    {
+        ccBCnFormat eFormat = s_eBCnFormats[i];
+        unsigned int uHeaderBytes = ccDDSHeaderBytes(eFormat);
+        unsigned int uFileBytes = uHeaderBytes + ccBCnLevelBytes(eFormat, uWidth, uHeight);
+        unsigned char *pFile = new unsigned char[uFileBytes];
+
+        ccDDSWriteHeader(eFormat, uWidth, uHeight, 1, image.isPremultipliedAlpha(), pFile);
+        dStart = pClock->now();
+        ccBCnEncode(eFormat, pRGBA, uWidth, uHeight, pFile + uHeaderBytes);
+        double dEncode = pClock->now() - dStart;
+
+        tDDSInfo info;
+        bool bParsed = ccDDSParse(pFile, uFileBytes, &info);
+        CCAssert(bParsed && info.format == eFormat && info.width == uWidth && info.mipmapCount == 1, "the DDS header doesn't round trip");
+
+        texture = new CCTexture2D();
+        dStart = pClock->now();
+        texture->initWithData(info.data, s_eBCnPixelFormats[i], uWidth, uHeight, CCSizeMake((float)uWidth, (float)uHeight));
+        std::string strLine = formatResult(s_pszBCnNames[i], texture, pClock->now() - dStart);
+        texture->release();
+
+        // PSNR of the CPU decoded pixels against the source
+        double dError = 0;
+        ccBCnDecode(eFormat, info.data, uWidth, uHeight, pDecoded);
+        for (unsigned int j = 0; j < uPixels * 4; ++j)
+        {
+            double d = (double)pRGBA[j] - pDecoded[j];
+            dError += d * d;
+        }
+        dError /= uPixels * 4;
+
+        char szQuality[64];
+        sprintf(szQuality, "  encode %7.2f ms  PSNR %4.1f dB", dEncode * 1000.0, dError > 0 ? 10.0 * log10(255.0 * 255.0 / dError) : 99.0);
+        strLine += szQuality;
+
+        CCLog("%s", strLine.c_str());
+        strResult += strLine + "\n";
+
+        delete [] pFile;
+    }
+
+    delete [] pDecoded;
+    delete [] pRGBA;
+    pClock->release();
+
+    return strResult;
+}
+
+void TextureCompressTest::performTests()
+{
+    CCLog("\n\n--------\n\n");
+
+    std::string strResult;
+    strResult += performTestsFormats("Images/test_image.png");
+    strResult += performTestsFormats("Images/landscape-1024x1024.png");
+    strResult += performTestsFormats("Images/PlanetCute-1024x1024.png");
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    CCLabelTTF *label = CCLabelTTF::labelWithString(strResult.c_str(), CCSizeMake(s.width - 40, s.height - 160), CCTextAlignmentLeft, "Courier New", 12);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height/2));
+}
+
+std::string TextureCompressTest::title()
+{
+    return "Texture Compression Test";
+}
+
+std::string TextureCompressTest::subtitle()
+{
+    return "GPU memory and upload rate per format";
+}
+
+CCScene* TextureCompressTest::scene()
+{
+    CCScene *pScene = CCScene::node();
+    TextureCompressTest *layer = new TextureCompressTest(true, TEST_COUNT, s_nTexCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextureMipmapTest
+//
+////////////////////////////////////////////////////////
+static const char* s_pszMipmapImages[] = {
+    "Images/test_image.png", "Images/landscape-1024x1024.png", "Images/PlanetCute-1024x1024.png",
+};
+
+TextureMipmapTest::TextureMipmapTest(bool bControlMenuVisible, int nMaxCases, int nCurCase)
+: TextureMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+, m_dAsyncStart(0)
+, m_pAsyncLabel(NULL)
+{
+    m_pClock = new CCFrameClock();
+}
+
+TextureMipmapTest::~TextureMipmapTest()
+{
+    m_pClock->release();
+}
+
+std::string TextureMipmapTest::performTestsFilters(const char* filename)
+{
+    std::string strResult = std::string(filename) + "\n";
+
+    CCImage image;
+    if (! image.initWithImageFile(CCFileUtils::fullPathFromRelativePath(filename)))
+    {
+        CCLog(" ERROR\n");
+        return strResult;
+    }
+
+    CCSize imageSize = CCSizeMake((float)image.getWidth(), (float)image.getHeight());
+    unsigned int uWide, uHigh;
+    CCTexture2D::textureSizeForImageSize(image.getWidth(), image.getHeight(), &uWide, &uHigh);
+
+    char szLine[160];
+    CCTexture2D *texture = new CCTexture2D();
+    double dStart = m_pClock->now();
+    texture->initWithImage(&image);
+    double dUpload = m_pClock->now() - dStart;
+    sprintf(szLine, "%-8s %5u KB %2u levels  upload %6.2f ms", "no mips", texture->getMemorySize() / 1024, texture->getMipmapCount(), dUpload * 1000.0);
+    texture->release();
+
+    CCLog("%s", szLine);
+    strResult += std::string(szLine) + "\n";
+
+    static const ccMipmapFilter s_eFilters[] = { kCCMipmapFilter_Box, kCCMipmapFilter_Kaiser };
+    static const char* s_pszFilterNames[] = { "box", "Kaiser" };
+    std::string strCachePath = CCFileUtils::getWriteablePath() + "PerformanceTextureTest.mips";
+
+    for (unsigned int i = 0; i < sizeof(s_eFilters) / sizeof(s_eFilters[0]); ++i)
+    {
+        tMipmapChain chain, cached;
+        ccMipmapChainInit(&chain, image.getData(), image.hasAlpha() ? 4 : 3, image.getWidth(), image.getHeight(), uWide, uHigh, image.isPremultipliedAlpha());
+        ccMipmapChainInit(&cached, image.getData(), image.hasAlpha() ? 4 : 3, image.getWidth(), image.getHeight(), uWide, uHigh, image.isPremultipliedAlpha());
+
+        dStart = m_pClock->now();
+        ccMipmapChainGenerate(&chain, s_eFilters[i]);
+        double dBuild = m_pClock->now() - dStart;
+
+        // what CCTextureCache does with the disk cache enabled, the read includes checking the top level
+        dStart = m_pClock->now();
+        ccMipmapChainWrite(&chain, s_eFilters[i], strCachePath.c_str());
+        double dWrite = m_pClock->now() - dStart;
+
+        dStart = m_pClock->now();
+        bool bRead = ccMipmapChainRead(&cached, s_eFilters[i], strCachePath.c_str());
+        double dRead = m_pClock->now() - dStart;
+        CCAssert(bRead && cached.levelCount == chain.levelCount, "the mip chain doesn't round trip through the disk cache");
+
+        texture = new CCTexture2D();
+        dStart = m_pClock->now();
+        texture->initWithMipmapChain(&chain, image.hasAlpha(), imageSize);
+        dUpload = m_pClock->now() - dStart;
+
+        sprintf(szLine, "%-8s %5u KB %2u levels  upload %6.2f ms  build %7.2f ms  cache write %6.2f ms read %6.2f ms",
+            s_pszFilterNames[i], texture->getMemorySize() / 1024, texture->getMipmapCount(), dUpload * 1000.0,
+            dBuild * 1000.0, dWrite * 1000.0, dRead * 1000.0);
+        texture->release();
+
+        ccMipmapChainDestroy(&chain);
+        ccMipmapChainDestroy(&cached);
+
+        CCLog("%s", szLine);
+        strResult += std::string(szLine) + "\n";
+    }
+
+    remove(strCachePath.c_str());
+
+    return strResult;
+}
+
+void TextureMipmapTest::performTests()
+{
+    CCLog("\n\n--------\n\n");
+
+    std::string strResult;
+    for (unsigned int i = 0; i < sizeof(s_pszMipmapImages) / sizeof(s_pszMipmapImages[0]); ++i)
+    {
+        strResult += performTestsFilters(s_pszMipmapImages[i]);
+    }
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    CCLabelTTF *label = CCLabelTTF::labelWithString(strResult.c_str(), CCSizeMake(s.width - 40, s.height - 260), CCTextAlignmentLeft, "Courier New", 12);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height/2 + 50));
+
+    // the same images again, the mip levels built by the loading threads
+    m_strAsyncResult = "addImageAsync with mipmaps\n";
+    m_pAsyncLabel = CCLabelTTF::labelWithString(m_strAsyncResult.c_str(), CCSizeMake(s.width - 40, 100), CCTextAlignmentLeft, "Courier New", 12);
+    addChild(m_pAsyncLabel, 1);
+    m_pAsyncLabel->setPosition(ccp(s.width/2, 100));
+
+    CCTextureCache *cache = CCTextureCache::sharedTextureCache();
+    m_dAsyncStart = m_pClock->now();
+    for (unsigned int i = 0; i < sizeof(s_pszMipmapImages) / sizeof(s_pszMipmapImages[0]); ++i)
+    {
+        cache->removeTextureForKey(s_pszMipmapImages[i]);
+        cache->addImageAsync(s_pszMipmapImages[i], this, callfuncO_selector(TextureMipmapTest::imageLoaded), true);
+    }
+}
+
+void TextureMipmapTest::imageLoaded(CCObject* pObj)
+{
+    CCTexture2D *texture = (CCTexture2D*)pObj;
+
+    char szLine[128];
+    sprintf(szLine, "%4u x %-4u %2u levels  ready after %7.2f ms", texture->getPixelsWide(), texture->getPixelsHigh(),
+        texture->getMipmapCount(), (m_pClock->now() - m_dAsyncStart) * 1000.0);
+    CCLog("%s", szLine);
+
+    m_strAsyncResult += std::string(szLine) + "\n";
+    m_pAsyncLabel->setString(m_strAsyncResult.c_str());
+}
+
+std::string TextureMipmapTest::title()
+{
+    return "Texture Mipmap Test";
+}
+
+std::string TextureMipmapTest::subtitle()
+{
+    return "mip chain build, upload and disk cache per filter";
+}
+
+CCScene* TextureMipmapTest::scene()
+{
+    CCScene *pScene = CCScene::node();
+    TextureMipmapTest *layer = new TextureMipmapTest(true, TEST_COUNT, s_nTexCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextureAtlasTest
+//
+////////////////////////////////////////////////////////
+static const char* s_pszAtlasImages[] = {
+    "Images/grossini_dance_01.png", "Images/grossini_dance_02.png", "Images/grossini_dance_03.png",
+    "Images/grossini_dance_04.png", "Images/grossini_dance_05.png", "Images/grossini_dance_06.png",
+    "Images/grossini_dance_07.png", "Images/grossini_dance_08.png", "Images/grossini_dance_09.png",
+    "Images/grossini_dance_10.png", "Images/grossini_dance_11.png", "Images/grossini_dance_12.png",
+    "Images/grossini_dance_13.png", "Images/grossini_dance_14.png", "Images/grossini.png",
+    "Images/grossinis_sister1.png", "Images/grossinis_sister2.png", "Images/b1.png", "Images/b2.png",
+    "Images/r1.png", "Images/r2.png", "Images/f1.png", "Images/f2.png", "Images/ball.png",
+    "Images/paddle.png", "Images/close.png", "Images/Pea.png", "Images/snow.png", "Images/fire.png",
+    "Images/Icon.png", "Images/blocks.png",
+};
+
+static unsigned int countTextures(const std::vector<CCTexture2D*>& textures)
+{
+    std::vector<CCTexture2D*> unique(textures);
+    std::sort(unique.begin(), unique.end());
+    return std::unique(unique.begin(), unique.end()) - unique.begin();
+}
+
+void TextureAtlasTest::performTests()
+{
+    CCLog("\n\n--------\n\n");
+
+    const unsigned int uImages = sizeof(s_pszAtlasImages) / sizeof(s_pszAtlasImages[0]);
+    CCTextureCache *cache = CCTextureCache::sharedTextureCache();
+    CCDynamicAtlas *atlas = CCDynamicAtlas::sharedDynamicAtlas();
+    CCFrameClock *pClock = new CCFrameClock();
+    char szLine[160];
+    std::string strResult;
+
+    // one texture per image
+    std::vector<CCTexture2D*> textures;
+    unsigned int uSeparateBytes = 0;
+    double dStart = pClock->now();
+    for (unsigned int i = 0; i < uImages; ++i)
+    {
+        cache->removeTextureForKey(s_pszAtlasImages[i]);
+        CCTexture2D *texture = cache->addImage(s_pszAtlasImages[i]);
+        if (texture)
+        {
+            textures.push_back(texture);
+            uSeparateBytes += texture->getMemorySize();
+        }
+    }
+    double dSeparate = pClock->now() - dStart;
+
+    sprintf(szLine, "CCTextureCache  %2u images  %2u textures  %5u KB  load %7.2f ms", uImages, countTextures(textures),
+        uSeparateBytes / 1024, dSeparate * 1000.0);
+    CCLog("%s", szLine);
+    strResult += std::string(szLine) + "\n";
+
+    for (unsigned int i = 0; i < uImages; ++i)
+    {
+        cache->removeTextureForKey(s_pszAtlasImages[i]);
+    }
+
+    // the same images packed on 512 x 512 pages, so that several are needed
+    atlas->removeAllImages();
+    atlas->setPageSize(512);
+
+    std::vector<CCSpriteFrame*> frames;
+    textures.clear();
+    dStart = pClock->now();
+    for (unsigned int i = 0; i < uImages; ++i)
+    {
+        CCSpriteFrame *frame = atlas->addImage(s_pszAtlasImages[i]);
+        if (frame)
+        {
+            frames.push_back(frame);
+            textures.push_back(frame->getTexture());
+        }
+    }
+    double dAtlas = pClock->now() - dStart;
+    pClock->release();
+
+    const ccDynamicAtlasStats& stats = atlas->getStats();
+    sprintf(szLine, "CCDynamicAtlas  %2u images  %2u textures  %5u KB  load %7.2f ms", uImages, countTextures(textures),
+        stats.uPageBytes / 1024, dAtlas * 1000.0);
+    CCLog("%s", szLine);
+    strResult += std::string(szLine) + "\n";
+
+    sprintf(szLine, "%u pages  %.1f%% packed  %u fallbacks", stats.uPages, stats.fEfficiency * 100.0f, stats.uFallbacks);
+    CCLog("%s", szLine);
+    strResult += std::string(szLine) + "\n";
+    atlas->dumpStats();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    CCLabelTTF *label = CCLabelTTF::labelWithString(strResult.c_str(), CCSizeMake(s.width - 40, 80), CCTextAlignmentLeft, "Courier New", 12);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height - 140));
+
+    // the sprites switch texture once per page instead of once per image
+    float x = 40;
+    float y = s.height - 240;
+    for (unsigned int i = 0; i < frames.size(); ++i)
+    {
+        CCSprite *sprite = CCSprite::spriteWithSpriteFrame(frames[i]);
+        sprite->setScale(0.5f);
+        sprite->setPosition(ccp(x, y));
+        addChild(sprite);
+
+        x += 70;
+        if (x > s.width - 40)
+        {
+            x = 40;
+            y -= 90;
+        }
+    }
+    atlas->setPageSize(1024);
+}
+
+std::string TextureAtlasTest::title()
+{
+    return "Texture Dynamic Atlas Test";
+}
+
+std::string TextureAtlasTest::subtitle()
+{
+    return "loose images packed on shared pages at runtime";
+}
+
+CCScene* TextureAtlasTest::scene()
+{
+    CCScene *pScene = CCScene::node();
+    TextureAtlasTest *layer = new TextureAtlasTest(true, TEST_COUNT, s_nTexCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextureResidencyTest
+//
+////////////////////////////////////////////////////////
+static const char* s_pszResidencyImages[] = {
+    "Images/texture1024x1024.png", "Images/landscape-1024x1024.png", "Images/PlanetCute-1024x1024.png",
+    "Images/texture512x512.png", "Images/background1.png", "Images/background2.png", "Images/background3.png",
+};
+
+// about two of the 1024 x 1024 textures
+#define kResidencyBudget (9 * 1024 * 1024)
+
+void TextureResidencyTest::performTests()
+{
+    CCTextureCache *cache = CCTextureCache::sharedTextureCache();
+    cache->setMemoryBudget(kResidencyBudget);
+    cache->resetResidencyStats();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    m_pStatsLabel = CCLabelTTF::labelWithString("", CCSizeMake(s.width - 40, 100), CCTextAlignmentLeft, "Courier New", 14);
+    addChild(m_pStatsLabel, 1);
+    m_pStatsLabel->setPosition(ccp(s.width/2, s.height - 160));
+
+    // one image shown at a time, the previous ones become unused and are evicted once over the budget
+    schedule(schedule_selector(TextureResidencyTest::showNextImage), 0.5f);
+}
+
+void TextureResidencyTest::showNextImage(ccTime dt)
+{
+    const int nImages = sizeof(s_pszResidencyImages) / sizeof(s_pszResidencyImages[0]);
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    if (m_pSprite)
+    {
+        removeChild(m_pSprite, true);
+    }
+    m_pSprite = CCSprite::spriteWithFile(s_pszResidencyImages[m_nImage]);
+    m_pSprite->setScale(0.25f);
+    m_pSprite->setPosition(ccp(s.width/2, s.height/2 - 60));
+    addChild(m_pSprite);
+    m_nImage = (m_nImage + 1) % nImages;
+
+    const ccTextureResidencyStats& stats = CCTextureCache::sharedTextureCache()->getResidencyStats();
+    char szStats[256];
+    sprintf(szStats, "budget %5u KB  current %5u KB  peak %5u KB\n%u evictions for %u KB  %u reloads  %u frames over budget",
+        kResidencyBudget / 1024, stats.uCurrentBytes / 1024, stats.uPeakBytes / 1024,
+        stats.uEvictions, stats.uEvictedBytes / 1024, stats.uReloads, stats.uOverBudgetFrames);
+    m_pStatsLabel->setString(szStats);
+}
+
+void TextureResidencyTest::onExit()
+{
+    unschedule(schedule_selector(TextureResidencyTest::showNextImage));
+    CCTextureCache::sharedTextureCache()->dumpCachedTextureInfo();
+    CCTextureCache::sharedTextureCache()->setMemoryBudget(0);
+
+    TextureMenuLayer::onExit();
+}
+
+std::string TextureResidencyTest::title()
+{
+    return "Texture Residency Test";
+}
+
+std::string TextureResidencyTest::subtitle()
+{
+    return "unused textures evicted, least recently drawn first";
+}
+
+CCScene* TextureResidencyTest::scene()
+{
+    CCScene *pScene = CCScene::node();
+    TextureResidencyTest *layer = new TextureResidencyTest(true, TEST_COUNT, s_nTexCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextureDecodeCacheTest
+//
+////////////////////////////////////////////////////////
+std::string TextureDecodeCacheTest::performTestsStartup(const char* filename, CCFrameClock* pClock)
+{
+    std::string strResult = std::string(filename) + "\n";
+    std::string strPath = CCFileUtils::fullPathFromRelativePath(filename);
+    std::string strCachePath = CCFileUtils::getWriteablePath() + "payload_test.cctex";
+    unsigned int uKey = ccTexturePayloadKey(strPath.c_str(), 0);
+    char szLine[160];
+
+    // what the first launch does: decode, convert, upload, and save the payload
+    double dStart = pClock->now();
+    CCImage image;
+    if (! image.initWithImageFile(strPath.c_str()))
+    {
+        CCLog(" ERROR\n");
+        return strResult;
+    }
+    double dDecode = pClock->now() - dStart;
+
+    tTexturePayload payload;
+    dStart = pClock->now();
+    CCTexture2D::payloadForImage(&image, &payload);
+    double dConvert = pClock->now() - dStart;
+
+    CCTexture2D *texture = new CCTexture2D();
+    dStart = pClock->now();
+    texture->initWithPayload(&payload);
+    double dUpload = pClock->now() - dStart;
+    texture->release();
+
+    sprintf(szLine, "decoded     %5u KB  decode %7.2f ms  convert %6.2f ms  upload %6.2f ms",
+        payload.levelBytes[0] / 1024, dDecode * 1000.0, dConvert * 1000.0, dUpload * 1000.0);
+    CCLog("%s", szLine);
+    strResult += std::string(szLine) + "\n";
+
+    // the next launches, the file was just written so it is read from the OS cache
+    for (int i = 0; i < 2; ++i)
+    {
+        bool bCompress = i == 1;
+        dStart = pClock->now();
+        ccTexturePayloadWrite(&payload, uKey, bCompress, strCachePath.c_str());
+        double dWrite = pClock->now() - dStart;
+
+        tTexturePayload cached;
+        ccTexturePayloadInit(&cached);
+        dStart = pClock->now();
+        bool bRead = ccTexturePayloadRead(&cached, uKey, strCachePath.c_str());
+        double dRead = pClock->now() - dStart;
+        CCAssert(bRead && cached.levelBytes[0] == payload.levelBytes[0], "the payload doesn't round trip through the disk cache");
+
+        texture = new CCTexture2D();
+        dStart = pClock->now();
+        texture->initWithPayload(&cached);
+        dUpload = pClock->now() - dStart;
+        texture->release();
+
+        FILE *fp = fopen(strCachePath.c_str(), "rb");
+        long lFileBytes = 0;
+        if (fp)
+        {
+            fseek(fp, 0, SEEK_END);
+            lFileBytes = ftell(fp);
+            fclose(fp);
+        }
+
+        sprintf(szLine, "%-11s %5ld KB  read %9.2f ms  upload %6.2f ms  write %6.2f ms",
+            bCompress ? "cached zlib" : "cached", lFileBytes / 1024, dRead * 1000.0, dUpload * 1000.0, dWrite * 1000.0);
+        ccTexturePayloadDestroy(&cached);
+
+        CCLog("%s", szLine);
+        strResult += std::string(szLine) + "\n";
+    }
+
+    ccTexturePayloadDestroy(&payload);
+    remove(strCachePath.c_str());
+
+    return strResult;
+}
+
+void TextureDecodeCacheTest::performTests()
+{
+    CCLog("\n\n--------\n\n");
+
+    CCFrameClock *pClock = new CCFrameClock();
+
+    std::string strResult;
+    strResult += performTestsStartup("Images/test_image.png", pClock);
+    strResult += performTestsStartup("Images/landscape-1024x1024.png", pClock);
+    strResult += performTestsStartup("Images/PlanetCute-1024x1024.png", pClock);
+    strResult += performTestsStartup("Images/bugs/RetinaDisplay.jpg", pClock);
+
+    pClock->release();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    CCLabelTTF *label = CCLabelTTF::labelWithString(strResult.c_str(), CCSizeMake(s.width - 40, s.height - 160), CCTextAlignmentLeft, "Courier New", 12);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height/2));
+}
+
+std::string TextureDecodeCacheTest::title()
+{
+    return "Decoded Image Cache Test";
+}
+
+std::string TextureDecodeCacheTest::subtitle()
+{
+    return "first launch decode vs cached payload, see the console";
+}
+
+CCScene* TextureDecodeCacheTest::scene()
+{
+    CCScene *pScene = CCScene::node();
+    TextureDecodeCacheTest *layer = new TextureDecodeCacheTest(true, TEST_COUNT, s_nTexCurCase);
     pScene->addChild(layer);
     layer->release();
 
@@ -35,6 +35,99 @@ public:
     static CCScene* scene();
 };
 
+class TextureCompressTest : public TextureMenuLayer
+{
+public:
+    TextureCompressTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :TextureMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+    std::string performTestsFormats(const char* filename);
+
+    static CCScene* scene();
+};
+
+class TextureMipmapTest : public TextureMenuLayer
+{
+public:
+    TextureMipmapTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0);
+    virtual ~TextureMipmapTest();
+
+    virtual void performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+    std::string performTestsFilters(const char* filename);
+    void imageLoaded(CCObject* pObj);
+
+    static CCScene* scene();
+
+protected:
+    CCFrameClock* m_pClock;
+    double m_dAsyncStart;
+    std::string m_strAsyncResult;
+    CCLabelTTF* m_pAsyncLabel;
+};
+
+class TextureAtlasTest : public TextureMenuLayer
+{
+public:
+    TextureAtlasTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :TextureMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+class TextureResidencyTest : public TextureMenuLayer
+{
+public:
+    TextureResidencyTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :TextureMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+        ,m_nImage(0)
+        ,m_pSprite(NULL)
+        ,m_pStatsLabel(NULL)
+    {
+    }
+
+    virtual void performTests();
+    virtual void onExit();
+    virtual std::string title();
+    virtual std::string subtitle();
+    void showNextImage(ccTime dt);
+
+    static CCScene* scene();
+
+protected:
+    int m_nImage;
+    CCSprite* m_pSprite;
+    CCLabelTTF* m_pStatsLabel;
+};
+
+class TextureDecodeCacheTest : public TextureMenuLayer
+{
+public:
+    TextureDecodeCacheTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :TextureMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+    std::string performTestsStartup(const char* filename, CCFrameClock* pClock);
+
+    static CCScene* scene();
+};
+
 void runTextureTest();
 
 #endif
@@ -1,8 +1,16 @@
 #include "PerformanceTouchesTest.h"
+#include "../testResource.h"
 
 enum
 {
-    TEST_COUNT = 2,
+    TEST_COUNT = 4,
+};
+
+enum
+{
+    kButtonRows = 20,
+    kButtonColumns = 20,
+    kTouchesPerFrame = 50,
 };
 
 static int s_nTouchCurCase = 0;
@@ -23,6 +31,12 @@ void TouchesMainScene::showCurrentTest()
     case 1:
         pLayer = new TouchesPerformTest2(true, TEST_COUNT, m_nCurCase);
         break;
+    case 2:
+        pLayer = new TouchesPerformTest3(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 3:
+        pLayer = new TouchesPerformTest4(true, TEST_COUNT, m_nCurCase);
+        break;
     }
     s_nTouchCurCase = m_nCurCase;
 
@@ -163,6 +177,126 @@ void TouchesPerformTest2::ccTouchesCancelled(CCSet* touches, CCEvent* event)
     numberOfTouchesC += touches->count();
 }
 
+////////////////////////////////////////////////////////
+//
+// TouchesPerformTest3
+//
+////////////////////////////////////////////////////////
+TouchesPerformTest3::TouchesPerformTest3(bool bControlMenuVisible, int nMaxCases, int nCurCase)
+: TouchesMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+{
+    m_pClock = new CCFrameClock();
+    m_pTouch = new CCTouch();
+    m_pTouches = new CCSet();
+    m_pTouches->addObject(m_pTouch);
+}
+
+TouchesPerformTest3::~TouchesPerformTest3()
+{
+    CC_SAFE_RELEASE(m_pTouches);
+    CC_SAFE_RELEASE(m_pTouch);
+    CC_SAFE_RELEASE(m_pClock);
+}
+
+void TouchesPerformTest3::onEnter()
+{
+    TouchesMainScene::onEnter();
+
+    CCTouchDispatcher::sharedDispatcher()->setHitTestIndexEnabled(usesHitTestIndex());
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+    m_plabel->setPosition(ccp(s.width/2, s.height-90));
+
+    // a grid of one button menus, each of them is a targeted delegate
+    m_tButtonsArea = CCRectMake(s.width*0.1f, s.height*0.2f, s.width*0.8f, s.height*0.55f);
+    float fCellWidth = m_tButtonsArea.size.width / kButtonColumns;
+    float fCellHeight = m_tButtonsArea.size.height / kButtonRows;
+
+    for (int i = 0; i < kButtonRows; i++)
+    {
+        for (int j = 0; j < kButtonColumns; j++)
+        {
+            CCMenuItemImage *pItem = CCMenuItemImage::itemFromNormalImage(s_pPathB1, s_pPathB2, this, menu_selector(TouchesPerformTest3::onButton));
+            CCSize size = pItem->getContentSize();
+            pItem->setScale(0.8f * MIN(fCellWidth / size.width, fCellHeight / size.height));
+
+            CCMenu *pMenu = CCMenu::menuWithItem(pItem);
+            pMenu->setPosition(ccp(m_tButtonsArea.origin.x + (j + 0.5f) * fCellWidth, m_tButtonsArea.origin.y + (i + 0.5f) * fCellHeight));
+            addChild(pMenu);
+        }
+    }
+
+    // a sprite turning every frame, the menus that didn't move keep their place in the index
+    CCSprite *pSprite = CCSprite::spriteWithFile(s_pPathGrossini);
+    pSprite->setPosition(ccp(s.width/2, s.height*0.1f));
+    pSprite->runAction(CCRepeatForever::actionWithAction(CCRotateBy::actionWithDuration(2, 360)));
+    addChild(pSprite);
+
+    m_dDispatchTime = 0;
+    m_nDispatches = 0;
+}
+
+void TouchesPerformTest3::onExit()
+{
+    CCTouchDispatcher::sharedDispatcher()->setHitTestIndexEnabled(false);
+
+    TouchesMainScene::onExit();
+}
+
+std::string TouchesPerformTest3::title()
+{
+    return "Tap 400 menus, scan";
+}
+
+void TouchesPerformTest3::update(ccTime dt)
+{
+    // tap random points of the buttons area, the taps falling between buttons go through every handler
+    CCTouchDispatcher *pDispatcher = CCTouchDispatcher::sharedDispatcher();
+    double dStart = m_pClock->now();
+
+    for (int i = 0; i < kTouchesPerFrame; i++)
+    {
+        CCPoint tPoint = ccp(m_tButtonsArea.origin.x + CCRANDOM_0_1() * m_tButtonsArea.size.width,
+                             m_tButtonsArea.origin.y + CCRANDOM_0_1() * m_tButtonsArea.size.height);
+        tPoint = CCDirector::sharedDirector()->convertToUI(tPoint);
+        m_pTouch->SetTouchInfo(tPoint.x, tPoint.y);
+
+        pDispatcher->touchesBegan(m_pTouches, NULL);
+        pDispatcher->touchesEnded(m_pTouches, NULL);
+    }
+
+    m_dDispatchTime += m_pClock->now() - dStart;
+    m_nDispatches += kTouchesPerFrame;
+    elapsedTime += dt;
+
+    if (elapsedTime > 1.0f)
+    {
+        char str[64] = {0};
+        sprintf(str, "%.2f us per tap, %d hits", m_dDispatchTime * 1000000 / m_nDispatches, numberOfTouchesE);
+        m_plabel->setString(str);
+
+        elapsedTime = 0;
+        m_dDispatchTime = 0;
+        m_nDispatches = 0;
+        numberOfTouchesE = 0;
+    }
+}
+
+void TouchesPerformTest3::onButton(CCObject* pSender)
+{
+    numberOfTouchesE++;
+}
+
+////////////////////////////////////////////////////////
+//
+// TouchesPerformTest4
+//
+////////////////////////////////////////////////////////
+std::string TouchesPerformTest4::title()
+{
+    return "Tap 400 menus, hit test index";
+}
+
 void runTouchesTest()
 {
     s_nTouchCurCase = 0;
@@ -61,6 +61,44 @@ public:
     virtual void ccTouchesCancelled(CCSet* touches, CCEvent* event);
 };
 
+class TouchesPerformTest3 : public TouchesMainScene
+{
+public:
+    TouchesPerformTest3(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0);
+    ~TouchesPerformTest3();
+
+    virtual void onEnter();
+    virtual void onExit();
+    virtual std::string title();
+    virtual void update(ccTime dt);
+
+    void onButton(CCObject* pSender);
+
+protected:
+    virtual bool usesHitTestIndex() { return false; }
+
+    CCFrameClock    *m_pClock;
+    CCTouch         *m_pTouch;
+    CCSet           *m_pTouches;
+    CCRect          m_tButtonsArea;
+    double          m_dDispatchTime;
+    int             m_nDispatches;
+};
+
+class TouchesPerformTest4 : public TouchesPerformTest3
+{
+public:
+    TouchesPerformTest4(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : TouchesPerformTest3(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string title();
+
+protected:
+    virtual bool usesHitTestIndex() { return true; }
+};
+
 void runTouchesTest();
 
 #endif
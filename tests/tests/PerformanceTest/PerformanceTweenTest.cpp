@@ -0,0 +1,226 @@
+#include "PerformanceTweenTest.h"
+
+enum
+{
+    TEST_COUNT = 3,
+};
+
+static const int kNumberOfSprites = 3000;
+// the animations are started again after this many seconds
+static const float kAnimationDuration = 2.0f;
+
+static int s_nTweenCurCase = 0;
+
+extern float calculateDeltaTime( struct timeval *lastUpdate );
+
+// updated after the action and tween managers (priority 0), ends the measure
+class TweenUpdateEnd : public CCNode
+{
+public:
+    TweenUpdateEnd(TweenMainScene* pScene) : m_pScene(pScene) {}
+
+    virtual void update(ccTime dt)
+    {
+        m_pScene->managersUpdated();
+    }
+
+protected:
+    TweenMainScene* m_pScene;
+};
+
+////////////////////////////////////////////////////////
+//
+// TweenMainScene
+//
+////////////////////////////////////////////////////////
+void TweenMainScene::showCurrentTest()
+{
+    CCLayer* pLayer = NULL;
+    switch (m_nCurCase)
+    {
+    case 0:
+        pLayer = new TweenActionsTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 1:
+        pLayer = new TweenRunActionTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    case 2:
+        pLayer = new TweenDirectTest(true, TEST_COUNT, m_nCurCase);
+        break;
+    }
+    s_nTweenCurCase = m_nCurCase;
+
+    if (pLayer)
+    {
+        CCScene* pScene = CCScene::node();
+        pScene->addChild(pLayer);
+        pLayer->release();
+
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void TweenMainScene::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // add title
+    CCLabelTTF *label = CCLabelTTF::labelWithString(title().c_str(), "Arial", 32);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-50));
+
+    CCLabelTTF *sub = CCLabelTTF::labelWithString(subtitle().c_str(), "Thonburi", 16);
+    addChild(sub, 1);
+    sub->setPosition(ccp(s.width/2, s.height-80));
+
+    m_pBatchNode = CCSpriteBatchNode::batchNodeWithFile("Images/spritesheet1.png");
+    addChild(m_pBatchNode);
+    for (int i = 0; i < kNumberOfSprites; ++i)
+    {
+        CCSprite *sprite = CCSprite::spriteWithTexture(m_pBatchNode->getTexture(), CCRectMake(0, 0, 32, 32));
+        sprite->setPosition(ccp(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height));
+        m_pBatchNode->addChild(sprite);
+    }
+
+    m_plabel = CCLabelBMFont::labelWithString("00.0", "fonts/arial16.fnt");
+    m_plabel->setPosition(ccp(s.width/2, s.height/2));
+    addChild(m_plabel, 1);
+
+    // the measure starts before the managers are updated and ends after
+    scheduleUpdateWithPriority(INT_MIN);
+    TweenUpdateEnd* pEnd = new TweenUpdateEnd(this);
+    addChild(pEnd);
+    pEnd->release();
+    pEnd->scheduleUpdateWithPriority(INT_MAX);
+
+    elapsedTime = 0;
+    animationTime = kAnimationDuration;
+    updateTime = 0;
+    numberOfFrames = 0;
+}
+
+void TweenMainScene::update(ccTime dt)
+{
+    elapsedTime += dt;
+    animationTime += dt;
+    if (animationTime >= kAnimationDuration)
+    {
+        animationTime = 0;
+
+        CCSize s = CCDirector::sharedDirector()->getWinSize();
+        CCArray* pChildren = m_pBatchNode->getChildren();
+        for (unsigned int i = 0; i < pChildren->count(); ++i)
+        {
+            CCSprite* pSprite = (CCSprite*)pChildren->objectAtIndex(i);
+            animate(pSprite,
+                ccp(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height),
+                0.5f + CCRANDOM_0_1(),
+                (CCubyte)(128 + CCRANDOM_0_1() * 127));
+        }
+    }
+
+    gettimeofday(&m_tUpdateStart, NULL);
+}
+
+void TweenMainScene::managersUpdated()
+{
+    updateTime += calculateDeltaTime(&m_tUpdateStart);
+    ++numberOfFrames;
+
+    if (elapsedTime > 1.0f)
+    {
+        char str[64] = {0};
+        sprintf(str, "%.3f ms/frame", updateTime * 1000.0f / numberOfFrames);
+        m_plabel->setString(str);
+
+        CCLog("%s: %d frames, %.3f ms/frame", title().c_str(), numberOfFrames, updateTime * 1000.0f / numberOfFrames);
+
+        elapsedTime = 0;
+        updateTime = 0;
+        numberOfFrames = 0;
+    }
+}
+
+std::string TweenMainScene::title()
+{
+    return "no title";
+}
+
+std::string TweenMainScene::subtitle()
+{
+    char str[64] = {0};
+    sprintf(str, "%d sprites moved, scaled and faded with an ease curve", kNumberOfSprites);
+    return str;
+}
+
+////////////////////////////////////////////////////////
+//
+// TweenActionsTest
+//
+////////////////////////////////////////////////////////
+void TweenActionsTest::animate(CCSprite* pSprite, const CCPoint& position, float fScale, CCubyte opacity)
+{
+    pSprite->stopAllActions();
+    pSprite->runAction(CCEaseSineInOut::actionWithAction(CCMoveTo::actionWithDuration(kAnimationDuration, position)));
+    pSprite->runAction(CCEaseOut::actionWithAction(CCScaleTo::actionWithDuration(kAnimationDuration, fScale), 2.0f));
+    pSprite->runAction(CCFadeTo::actionWithDuration(kAnimationDuration, opacity));
+}
+
+std::string TweenActionsTest::title()
+{
+    return "A) CCActionManager";
+}
+
+////////////////////////////////////////////////////////
+//
+// TweenRunActionTest
+//
+////////////////////////////////////////////////////////
+void TweenRunActionTest::animate(CCSprite* pSprite, const CCPoint& position, float fScale, CCubyte opacity)
+{
+    CCTweenManager* pTweens = CCTweenManager::sharedManager();
+
+    pSprite->stopAllActions();
+    pTweens->runAction(CCEaseSineInOut::actionWithAction(CCMoveTo::actionWithDuration(kAnimationDuration, position)), pSprite);
+    pTweens->runAction(CCEaseOut::actionWithAction(CCScaleTo::actionWithDuration(kAnimationDuration, fScale), 2.0f), pSprite);
+    pTweens->runAction(CCFadeTo::actionWithDuration(kAnimationDuration, opacity), pSprite);
+}
+
+std::string TweenRunActionTest::title()
+{
+    return "B) CCTweenManager::runAction";
+}
+
+////////////////////////////////////////////////////////
+//
+// TweenDirectTest
+//
+////////////////////////////////////////////////////////
+void TweenDirectTest::animate(CCSprite* pSprite, const CCPoint& position, float fScale, CCubyte opacity)
+{
+    CCTweenManager* pTweens = CCTweenManager::sharedManager();
+
+    pSprite->stopAllActions();
+    pTweens->moveTo(pSprite, kAnimationDuration, position, kCCTweenEaseSineInOut);
+    pTweens->scaleTo(pSprite, kAnimationDuration, fScale, fScale, kCCTweenEaseOut, 2.0f);
+    pTweens->fadeTo(pSprite, kAnimationDuration, opacity);
+}
+
+std::string TweenDirectTest::title()
+{
+    return "C) CCTweenManager tweens";
+}
+
+void runTweenTest()
+{
+    s_nTweenCurCase = 0;
+    TweenMainScene* pLayer = new TweenActionsTest(true, TEST_COUNT, s_nTweenCurCase);
+
+    CCScene* pScene = CCScene::node();
+    pScene->addChild(pLayer);
+    pLayer->release();
+
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
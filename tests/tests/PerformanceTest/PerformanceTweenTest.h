@@ -0,0 +1,74 @@
+#ifndef __PERFORMANCE_TWEEN_TEST_H__
+#define __PERFORMANCE_TWEEN_TEST_H__
+
+#include "PerformanceTest.h"
+
+class TweenMainScene : public PerformBasicLayer
+{
+public:
+    TweenMainScene(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void showCurrentTest();
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void update(ccTime dt);
+
+    /** called after the action and tween managers were updated */
+    void managersUpdated();
+
+    /** start the move, scale and fade of one sprite */
+    virtual void animate(CCSprite* pSprite, const CCPoint& position, float fScale, CCubyte opacity) = 0;
+
+protected:
+    CCSpriteBatchNode * m_pBatchNode;
+    CCLabelBMFont *     m_plabel;
+    struct timeval      m_tUpdateStart;
+    float               updateTime;
+    int                 numberOfFrames;
+    ccTime              elapsedTime;
+    ccTime              animationTime;
+};
+
+class TweenActionsTest : public TweenMainScene
+{
+public:
+    TweenActionsTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : TweenMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void animate(CCSprite* pSprite, const CCPoint& position, float fScale, CCubyte opacity);
+    virtual std::string title();
+};
+
+class TweenRunActionTest : public TweenMainScene
+{
+public:
+    TweenRunActionTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : TweenMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void animate(CCSprite* pSprite, const CCPoint& position, float fScale, CCubyte opacity);
+    virtual std::string title();
+};
+
+class TweenDirectTest : public TweenMainScene
+{
+public:
+    TweenDirectTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        : TweenMainScene(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void animate(CCSprite* pSprite, const CCPoint& position, float fScale, CCubyte opacity);
+    virtual std::string title();
+};
+
+void runTweenTest();
+
+#endif
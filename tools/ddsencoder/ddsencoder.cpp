@@ -0,0 +1,221 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+/*
+	ddsencoder: converts PNG images into BC1 / BC2 / BC3 DDS textures for CCTextureCache.
+
+	It builds with the engine's codec and libpng, outside of the engine:
+		g++ -O2 -I../../cocos2dx/support/image_support ddsencoder.cpp ../../cocos2dx/support/image_support/ccBCn.cpp ../../cocos2dx/support/image_support/ccMipmap.cpp -lpng -o ddsencoder
+
+	usage: ddsencoder [-f bc1|bc2|bc3] [-m] [-k] [-s] input.png output.dds
+		-f	format, by default BC1 for opaque images and BC3 for the others
+		-m	writes the mip chain down to 1x1
+		-k	builds the mip levels with the Kaiser filter instead of the box one
+		-s	keeps the alpha straight; by default the colors are premultiplied
+			like CCImage does for PNG files, and the file is flagged so
+*/
+
+#include <png.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "ccBCn.h"
+#include "ccMipmap.h"
+
+using namespace cocos2d;
+
+static bool loadPNG(const char *pszFilename, std::vector<unsigned char>& pixels, unsigned int& width, unsigned int& height)
+{
+	png_image image;
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+
+	if (! png_image_begin_read_from_file(&image, pszFilename))
+	{
+		fprintf(stderr, "ddsencoder: %s: %s\n", pszFilename, image.message);
+		return false;
+	}
+
+	image.format = PNG_FORMAT_RGBA;
+	width = image.width;
+	height = image.height;
+	pixels.resize(PNG_IMAGE_SIZE(image));
+
+	if (! png_image_finish_read(&image, NULL, &pixels[0], 0, NULL))
+	{
+		fprintf(stderr, "ddsencoder: %s: %s\n", pszFilename, image.message);
+		return false;
+	}
+
+	return true;
+}
+
+static bool hasTranslucentPixels(const std::vector<unsigned char>& pixels)
+{
+	for (size_t i = 3; i < pixels.size(); i += 4)
+	{
+		if (pixels[i] != 255)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void premultiplyAlpha(std::vector<unsigned char>& pixels)
+{
+	for (size_t i = 0; i < pixels.size(); i += 4)
+	{
+		unsigned int alpha = pixels[i + 3];
+		for (int c = 0; c < 3; ++c)
+		{
+			pixels[i + c] = (unsigned char)((pixels[i + c] * alpha + 127) / 255);
+		}
+	}
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: ddsencoder [-f bc1|bc2|bc3] [-m] [-k] [-s] input.png output.dds\n");
+}
+
+int main(int argc, char **argv)
+{
+	ccBCnFormat format = kCCBCnFormat_Invalid;
+	bool bMipmaps = false;
+	ccMipmapFilter filter = kCCMipmapFilter_Box;
+	bool bPremultiply = true;
+	int i = 1;
+
+	for (; i < argc && argv[i][0] == '-'; ++i)
+	{
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+		{
+			const char *name = argv[++i];
+			if (strcmp(name, "bc1") == 0 || strcmp(name, "dxt1") == 0)
+			{
+				format = kCCBCnFormat_BC1;
+			}
+			else if (strcmp(name, "bc2") == 0 || strcmp(name, "dxt3") == 0)
+			{
+				format = kCCBCnFormat_BC2;
+			}
+			else if (strcmp(name, "bc3") == 0 || strcmp(name, "dxt5") == 0)
+			{
+				format = kCCBCnFormat_BC3;
+			}
+			else
+			{
+				fprintf(stderr, "ddsencoder: unsupported format %s\n", name);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-m") == 0)
+		{
+			bMipmaps = true;
+		}
+		else if (strcmp(argv[i], "-k") == 0)
+		{
+			filter = kCCMipmapFilter_Kaiser;
+		}
+		else if (strcmp(argv[i], "-s") == 0)
+		{
+			bPremultiply = false;
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	if (argc - i != 2)
+	{
+		usage();
+		return 1;
+	}
+
+	std::vector<unsigned char> pixels;
+	unsigned int width, height;
+	if (! loadPNG(argv[i], pixels, width, height))
+	{
+		return 1;
+	}
+
+	bool bTranslucent = hasTranslucentPixels(pixels);
+	if (format == kCCBCnFormat_Invalid)
+	{
+		format = bTranslucent ? kCCBCnFormat_BC3 : kCCBCnFormat_BC1;
+	}
+
+	// the flag only matters for the formats keeping the alpha
+	bool bPremultiplied = bPremultiply && bTranslucent && format != kCCBCnFormat_BC1;
+	if (bPremultiply && bTranslucent)
+	{
+		premultiplyAlpha(pixels);
+	}
+
+	unsigned int mipmapCount = bMipmaps ? ccMipmapLevelCount(width, height) : 1;
+
+	std::vector<unsigned char> file(ccDDSHeaderBytes(format));
+	ccDDSWriteHeader(format, width, height, mipmapCount, bPremultiplied, &file[0]);
+
+	std::vector<unsigned char> level;
+	for (unsigned int mip = 0; mip < mipmapCount; ++mip)
+	{
+		if (mip > 0)
+		{
+			unsigned int levelWidth = width > 1 ? width / 2 : 1;
+			unsigned int levelHeight = height > 1 ? height / 2 : 1;
+			level.resize(levelWidth * levelHeight * 4);
+			// opaque images are the same either way
+			ccMipmapDownsample(filter, &pixels[0], width, height, bPremultiply || ! bTranslucent, &level[0]);
+			pixels.swap(level);
+			width = levelWidth;
+			height = levelHeight;
+		}
+
+		size_t offset = file.size();
+		file.resize(offset + ccBCnLevelBytes(format, width, height));
+		ccBCnEncode(format, &pixels[0], width, height, &file[offset]);
+	}
+
+	FILE *fp = fopen(argv[i + 1], "wb");
+	if (! fp || fwrite(&file[0], 1, file.size(), fp) != file.size())
+	{
+		fprintf(stderr, "ddsencoder: can't write %s\n", argv[i + 1]);
+		if (fp)
+		{
+			fclose(fp);
+		}
+		return 1;
+	}
+	fclose(fp);
+
+	return 0;
+}